@@ -0,0 +1,1065 @@
+/**
+ * @file sb_bench.c
+ * @brief Benchmarks of the host library's hot paths.
+ *
+ * Each stage of the receive and send paths is timed on its own, at several
+ * traffic mixes:
+ *
+ * | Benchmark          | Work per iteration                                        |
+ * |--------------------|-----------------------------------------------------------|
+ * | BM_FrameScan       | Split the mix into frames, fed in 64-byte USB packets     |
+ * | BM_CobsDecode      | COBS-decode every frame                                   |
+ * | BM_ChecksumValidate| Validate every decoded packet (length, checksum, board)   |
+ * | BM_Dispatch        | Call the typed callbacks of every packet                  |
+ * | BM_Reader          | All of the above through @ref sb_reader_feed              |
+ * | BM_OutputDiff      | List the outputs that differ from the board               |
+ * | BM_BulkEncode      | Encode those outputs as back-to-back frames               |
+ * | BM_WritePerFrame   | Encode and write() each output frame on its own           |
+ * | BM_WriteCoalesced  | The same frames through an @ref sb_writer_t: one write    |
+ *
+ * Inbound mixes are generated from a fixed seed, with the command shares of
+ * a panel in use: @c keypad (keys and encoders), @c axes (ADC events),
+ * @c delta (the same inputs in delta report mode), @c diagnostics (echo,
+ * error and task status responses) and @c mixed. A raw capture of the CDC
+ * stream (e.g. @c cat /dev/ttyACM0 > capture.bin) adds a @c recorded mix.
+ * Outbound mixes: @c annunciators (a few LED columns), @c displays (digit
+ * updates) and @c full_panel (every output, as after a board reset). The
+ * write benchmarks write to /dev/null, so they time the syscalls, not a USB
+ * link.
+ *
+ * Flags and output follow Google Benchmark, so its tools/compare.py can
+ * track results across versions:
+ *
+ *     sb_bench [--benchmark_filter=SUBSTRING] [--benchmark_min_time=SECONDS]
+ *              [--benchmark_format=console|json] [--benchmark_out=FILE]
+ *              [--benchmark_list_tests] [--benchmark_traffic=CAPTURE]
+ *
+ * @c --benchmark_out always writes JSON. The filter is a plain substring
+ * rather than a regular expression.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sb_outputs.h"
+#include "sb_protocol.h"
+#include "sb_reader.h"
+#include "sb_writer.h"
+
+/** Packets per generated inbound mix. */
+#define BENCH_PACKETS 1024U
+/** Bytes handed to the reader at a time (one USB full-speed bulk packet). */
+#define BENCH_CHUNK 64U
+/** Board ID of the generated traffic. */
+#define BENCH_BOARD 1U
+/** Default shortest measurement per benchmark (s). */
+#define BENCH_DEFAULT_MIN_TIME 0.5
+/** Iteration cap, as in Google Benchmark. */
+#define BENCH_MAX_ITERATIONS 1000000000ULL
+/** Largest benchmark name. */
+#define BENCH_NAME_SIZE 64U
+/** Largest number of benchmarks. */
+#define BENCH_MAX_RESULTS 64U
+
+/**
+ * @brief Share of each inbound packet kind in a mix (any scale).
+ */
+typedef struct bench_weights_t {
+	uint32_t key;         /**< Keypad events */
+	uint32_t rotary;      /**< Encoder detents */
+	uint32_t adc;         /**< ADC events */
+	uint32_t delta_keys;  /**< Key delta frames */
+	uint32_t delta_axes;  /**< Axis delta frames */
+	uint32_t echo;        /**< Echo responses */
+	uint32_t error;       /**< Error status responses */
+	uint32_t task;        /**< Task status responses */
+} bench_weights_t;
+
+/**
+ * @brief A named inbound mix.
+ */
+typedef struct bench_inbound_mix_t {
+	const char *name;        /**< Mix name */
+	bench_weights_t weights; /**< Packet shares */
+} bench_inbound_mix_t;
+
+/**
+ * @brief Inbound traffic prepared for every stage.
+ */
+typedef struct bench_traffic_t {
+	const char *name;       /**< Mix name */
+	uint8_t *wire;          /**< Byte stream */
+	size_t wire_length;     /**< Bytes in @ref wire */
+	size_t frames;          /**< Frames in the stream */
+	size_t *frame_offset;   /**< Start of each frame in @ref wire */
+	uint8_t *frame_length;  /**< Encoded length of each frame */
+	uint8_t *raw;           /**< Decoded frames, @ref SB_MAX_ENCODED bytes apart */
+	uint8_t *raw_length;    /**< Decoded length of each frame */
+	sb_packet_t *packets;   /**< Valid packets */
+	size_t packet_count;    /**< Entries in @ref packets */
+} bench_traffic_t;
+
+/**
+ * @brief Outbound state prepared for the output benchmarks.
+ */
+typedef struct bench_panel_t {
+	const char *name;                                  /**< Mix name */
+	sb_outputs_t outputs;                              /**< Cache with pending changes */
+	sb_output_state_t sent;                            /**< Board state to restore between encodes */
+	sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES]; /**< Pending changes */
+	size_t count;                                      /**< Entries in @ref changes */
+	uint8_t wire[SB_OUTPUT_MAX_CHANGES * SB_MAX_WIRE]; /**< Encode target */
+} bench_panel_t;
+
+/**
+ * @brief One measured benchmark.
+ */
+typedef struct bench_result_t {
+	char name[BENCH_NAME_SIZE]; /**< Benchmark name */
+	uint32_t family;            /**< Family index */
+	uint32_t instance;          /**< Index within the family */
+	uint64_t iterations;        /**< Iterations of the reported run */
+	double real_ns;             /**< Wall time per iteration */
+	double cpu_ns;              /**< CPU time per iteration */
+	double bytes_per_second;    /**< Bytes processed per CPU second (0 = none) */
+	double items_per_second;    /**< Packets or outputs per CPU second */
+} bench_result_t;
+
+/** Benchmark body: run the stage @p iterations times. */
+typedef void (*bench_body_t)(void *data, uint64_t iterations);
+
+/**
+ * @brief A benchmark family: one stage, run at every mix.
+ */
+typedef struct bench_family_t {
+	const char *name;  /**< Family name */
+	bench_body_t body; /**< Stage */
+	bool outbound;     /**< Runs at the outbound mixes */
+} bench_family_t;
+
+static const bench_inbound_mix_t inbound_mixes[] = {
+	{ "keypad", { .key = 70U, .rotary = 30U } },
+	{ "axes", { .adc = 100U } },
+	{ "delta", { .rotary = 15U, .delta_keys = 35U, .delta_axes = 50U } },
+	{ "diagnostics", { .echo = 40U, .error = 40U, .task = 20U } },
+	{ "mixed", { .key = 25U, .rotary = 15U, .adc = 50U, .echo = 6U, .error = 3U, .task = 1U } },
+};
+
+#define INBOUND_MIX_COUNT (sizeof(inbound_mixes) / sizeof(inbound_mixes[0]))
+
+/** Accumulates results so the compiler keeps the measured work. */
+static volatile uint64_t bench_sink;
+/** Target of the write benchmarks. */
+static int bench_null_fd = -1;
+
+static uint32_t bench_random(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+static double now_seconds(clockid_t clock)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(clock, &ts);
+
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/*
+ * Traffic generation
+ */
+
+static uint8_t make_key_delta(uint8_t keys[8], uint32_t *random, uint8_t payload[SB_MAX_PAYLOAD])
+{
+	uint8_t changed[8] = { 0U };
+	const uint32_t flips = 1U + (bench_random(random) % 3U);
+	uint8_t length = 2U;
+	uint8_t present = 0U;
+	uint8_t state_bits = 0U;
+	uint8_t bit_count = 0U;
+
+	for (uint32_t i = 0U; i < flips; i++)
+	{
+		const uint32_t key = bench_random(random) % 64U;
+		changed[key / 8U] ^= (uint8_t)(1U << (key % 8U));
+	}
+
+	payload[0] = 0x00U;
+	for (uint8_t n = 0U; n < 8U; n++)
+	{
+		if (0U != changed[n])
+		{
+			present |= (uint8_t)(1U << n);
+			payload[length] = changed[n];
+			length++;
+		}
+	}
+	payload[1] = present;
+
+	for (uint8_t n = 0U; n < 8U; n++)
+	{
+		keys[n] ^= changed[n];
+		for (uint8_t b = 0U; b < 8U; b++)
+		{
+			if (0U != ((changed[n] >> b) & 1U))
+			{
+				state_bits |= (uint8_t)(((keys[n] >> b) & 1U) << bit_count);
+				bit_count++;
+			}
+		}
+	}
+	if (0U == present)
+	{
+		// The flips cancelled out: report one key instead
+		payload[1] = 0x01U;
+		payload[2] = 0x01U;
+		keys[0] ^= 0x01U;
+		state_bits = (uint8_t)(keys[0] & 0x01U);
+		length = 3U;
+		bit_count = 1U;
+	}
+	if (0U != bit_count)
+	{
+		payload[length] = state_bits;
+		length++;
+	}
+
+	return length;
+}
+
+static uint8_t make_axis_delta(uint16_t axes[16], uint32_t *random, uint8_t payload[SB_MAX_PAYLOAD])
+{
+	const uint32_t count = 1U + (bench_random(random) % 6U);
+	uint16_t mask = 0U;
+	uint8_t length = 3U;
+	bool high_half = true;
+
+	for (uint32_t i = 0U; i < count; i++)
+	{
+		mask |= (uint16_t)(1U << (bench_random(random) % 16U));
+	}
+
+	payload[0] = 0x01U;
+	payload[1] = (uint8_t)(mask >> 8);
+	payload[2] = (uint8_t)mask;
+	for (uint8_t channel = 0U; channel < 16U; channel++)
+	{
+		if (0U != ((mask >> channel) & 1U))
+		{
+			const uint16_t value = (uint16_t)((axes[channel] + 8U + (bench_random(random) % 64U)) & 0x0FFFU);
+			axes[channel] = value;
+			if (high_half)
+			{
+				payload[length] = (uint8_t)(value >> 4);
+				payload[length + 1U] = (uint8_t)((value & 0x0FU) << 4);
+				length += 2U;
+			}
+			else
+			{
+				payload[length - 1U] |= (uint8_t)(value >> 8);
+				payload[length] = (uint8_t)value;
+				length++;
+			}
+			high_half = !high_half;
+		}
+	}
+
+	return length;
+}
+
+/**
+ * @brief One packet of a mix, chosen by weight.
+ */
+static size_t make_packet(const bench_weights_t *w, uint32_t *random, uint8_t keys[8], uint16_t axes[16], uint8_t *wire)
+{
+	const uint32_t total = w->key + w->rotary + w->adc + w->delta_keys + w->delta_axes + w->echo + w->error + w->task;
+	uint32_t pick = bench_random(random) % total;
+	uint8_t payload[SB_MAX_PAYLOAD] = { 0U };
+	uint8_t length = 0U;
+	uint8_t command = SB_CMD_KEY;
+
+	if (pick < w->key)
+	{
+		const uint32_t key = bench_random(random) % 64U;
+		keys[key / 8U] ^= (uint8_t)(1U << (key % 8U));
+		payload[0] = (uint8_t)(((key % 8U) << 4) | ((key / 8U) << 1) | ((keys[key / 8U] >> (key % 8U)) & 1U));
+		length = 1U;
+	}
+	else if ((pick -= w->key) < w->rotary)
+	{
+		command = SB_CMD_ROTARY;
+		payload[0] = (uint8_t)((bench_random(random) % 8U) << 4);
+		payload[1] = (uint8_t)(bench_random(random) & 1U);
+		length = 2U;
+	}
+	else if ((pick -= w->rotary) < w->adc)
+	{
+		const uint8_t channel = (uint8_t)(bench_random(random) % 16U);
+		axes[channel] = (uint16_t)((axes[channel] + 8U + (bench_random(random) % 64U)) & 0x0FFFU);
+		command = SB_CMD_AD;
+		payload[0] = channel;
+		payload[1] = (uint8_t)(axes[channel] >> 8);
+		payload[2] = (uint8_t)axes[channel];
+		length = 3U;
+	}
+	else if ((pick -= w->adc) < w->delta_keys)
+	{
+		command = SB_CMD_STATE_DELTA;
+		length = make_key_delta(keys, random, payload);
+	}
+	else if ((pick -= w->delta_keys) < w->delta_axes)
+	{
+		command = SB_CMD_STATE_DELTA;
+		length = make_axis_delta(axes, random, payload);
+	}
+	else if ((pick -= w->delta_axes) < w->echo)
+	{
+		command = SB_CMD_ECHO;
+		length = (uint8_t)(1U + (bench_random(random) % SB_MAX_PAYLOAD));
+		for (uint8_t i = 0U; i < length; i++)
+		{
+			payload[i] = (uint8_t)bench_random(random);
+		}
+	}
+	else if ((pick -= w->echo) < w->error)
+	{
+		const uint32_t value = bench_random(random) % 100000U;
+		command = SB_CMD_ERROR_STATUS;
+		payload[0] = (uint8_t)(bench_random(random) % 26U);
+		payload[1] = (uint8_t)(value >> 24);
+		payload[2] = (uint8_t)(value >> 16);
+		payload[3] = (uint8_t)(value >> 8);
+		payload[4] = (uint8_t)value;
+		length = 5U;
+	}
+	else
+	{
+		command = SB_CMD_TASK_STATUS;
+		payload[0] = (uint8_t)(bench_random(random) % 10U);
+		for (uint8_t i = 1U; i < 13U; i++)
+		{
+			payload[i] = (uint8_t)bench_random(random);
+		}
+		length = 13U;
+	}
+
+	return sb_packet_encode(BENCH_BOARD, command, payload, length, wire);
+}
+
+/**
+ * @brief @ref sb_frame_fn collecting frame positions of a contiguous stream.
+ */
+static void collect_frame(void *context, const uint8_t *frame, size_t length)
+{
+	bench_traffic_t *traffic = (bench_traffic_t *)context;
+
+	traffic->frame_offset[traffic->frames] = (size_t)(frame - traffic->wire);
+	traffic->frame_length[traffic->frames] = (uint8_t)length;
+	traffic->frames++;
+}
+
+/**
+ * @brief Split, decode and parse a stream once, so each stage can start from its own input.
+ */
+static bool prepare_traffic(bench_traffic_t *traffic)
+{
+	const size_t most = (traffic->wire_length / 2U) + 1U;
+	sb_framer_t framer;
+	bool result;
+
+	traffic->frames = 0U;
+	traffic->packet_count = 0U;
+	traffic->frame_offset = malloc(most * sizeof(*traffic->frame_offset));
+	traffic->frame_length = malloc(most);
+	traffic->raw = malloc(most * SB_MAX_ENCODED);
+	traffic->raw_length = malloc(most);
+	traffic->packets = malloc(most * sizeof(*traffic->packets));
+	result = (NULL != traffic->frame_offset) && (NULL != traffic->frame_length) && (NULL != traffic->raw) &&
+	         (NULL != traffic->raw_length) && (NULL != traffic->packets);
+
+	if (result)
+	{
+		sb_framer_reset(&framer);
+		(void)sb_framer_feed(&framer, traffic->wire, traffic->wire_length, collect_frame, traffic);
+
+		for (size_t i = 0U; i < traffic->frames; i++)
+		{
+			uint8_t *raw = &traffic->raw[i * SB_MAX_ENCODED];
+			size_t raw_length = 0U;
+			const sb_status_t status = sb_frame_decode(&traffic->wire[traffic->frame_offset[i]], traffic->frame_length[i],
+			                                           SB_BOARD_ANY, &traffic->packets[traffic->packet_count]);
+
+			(void)sb_cobs_decode(&traffic->wire[traffic->frame_offset[i]], traffic->frame_length[i], raw, &raw_length);
+			traffic->raw_length[i] = (uint8_t)raw_length;
+			if ((SB_OK == status) || (SB_UNKNOWN_COMMAND == status))
+			{
+				traffic->packet_count++;
+			}
+		}
+		result = traffic->packet_count > 0U;
+	}
+
+	return result;
+}
+
+static bool generate_traffic(bench_traffic_t *traffic, const bench_inbound_mix_t *mix, uint32_t seed)
+{
+	uint8_t keys[8] = { 0U };
+	uint16_t axes[16] = { 0U };
+	uint32_t random = seed;
+	bool result = false;
+
+	(void)memset(traffic, 0, sizeof(*traffic));
+	traffic->name = mix->name;
+	traffic->wire = malloc((size_t)BENCH_PACKETS * SB_MAX_WIRE);
+	if (NULL != traffic->wire)
+	{
+		for (uint32_t i = 0U; i < BENCH_PACKETS; i++)
+		{
+			traffic->wire_length += make_packet(&mix->weights, &random, keys, axes, &traffic->wire[traffic->wire_length]);
+		}
+		result = prepare_traffic(traffic);
+	}
+
+	return result;
+}
+
+static bool load_traffic(bench_traffic_t *traffic, const char *path)
+{
+	FILE *file = fopen(path, "rb"); // flawfinder: ignore
+	bool result = false;
+
+	(void)memset(traffic, 0, sizeof(*traffic));
+	traffic->name = "recorded";
+	if (NULL != file)
+	{
+		if ((0 == fseek(file, 0L, SEEK_END)))
+		{
+			const long size = ftell(file);
+			rewind(file);
+			if (size > 0L)
+			{
+				traffic->wire = malloc((size_t)size);
+				if (NULL != traffic->wire)
+				{
+					traffic->wire_length = fread(traffic->wire, 1U, (size_t)size, file);
+					result = (traffic->wire_length == (size_t)size) && prepare_traffic(traffic);
+				}
+			}
+		}
+		(void)fclose(file);
+	}
+
+	return result;
+}
+
+/*
+ * Output panels
+ */
+
+static void random_digits(sb_outputs_t *outputs, uint8_t controller, uint32_t *random)
+{
+	uint8_t digits[SB_DIGITS];
+
+	for (uint8_t i = 0U; i < SB_DIGITS; i++)
+	{
+		digits[i] = (uint8_t)(bench_random(random) % 10U);
+	}
+	(void)sb_outputs_set_digits(outputs, controller, digits, (uint8_t)(bench_random(random) % 9U == 8U ? SB_NO_DOT : bench_random(random) % 8U));
+}
+
+static void random_panel(sb_outputs_t *outputs, uint32_t *random)
+{
+	sb_outputs_set_pwm(outputs, (uint8_t)(1U + (bench_random(random) % 255U)));
+	for (uint8_t c = 1U; c <= SB_CONTROLLERS; c++)
+	{
+		for (uint8_t column = 0U; column < SB_LED_COLUMNS; column++)
+		{
+			(void)sb_outputs_set_led(outputs, c, column, (uint8_t)(1U + (bench_random(random) % 255U)));
+		}
+		random_digits(outputs, c, random);
+		(void)sb_outputs_set_brightness(outputs, c, (uint8_t)(bench_random(random) % 7U));
+	}
+}
+
+static void prepare_panel(bench_panel_t *panel, const char *name, uint32_t seed)
+{
+	uint32_t random = seed;
+	uint8_t scratch[SB_OUTPUT_MAX_CHANGES * SB_MAX_WIRE];
+
+	panel->name = name;
+	sb_outputs_init(&panel->outputs, BENCH_BOARD);
+	random_panel(&panel->outputs, &random);
+
+	if (0 != strcmp(name, "full_panel"))
+	{
+		// Board in sync, then a typical frame's worth of changes
+		(void)sb_outputs_flush(&panel->outputs, scratch, sizeof(scratch));
+		if (0 == strcmp(name, "annunciators"))
+		{
+			for (uint32_t i = 0U; i < 6U; i++)
+			{
+				const uint8_t c = (uint8_t)(1U + (bench_random(&random) % SB_CONTROLLERS));
+				const uint8_t column = (uint8_t)(bench_random(&random) % SB_LED_COLUMNS);
+				(void)sb_outputs_set_led(&panel->outputs, c, column, (uint8_t)(panel->outputs.wanted.led[c - 1U][column] ^ (1U << (i % 8U))));
+			}
+		}
+		else
+		{
+			random_digits(&panel->outputs, 1U, &random);
+			random_digits(&panel->outputs, 2U, &random);
+			(void)sb_outputs_set_brightness(&panel->outputs, 3U, (uint8_t)((panel->outputs.wanted.brightness[2] + 1U) % 8U));
+		}
+	}
+
+	panel->sent = panel->outputs.sent;
+	panel->count = sb_outputs_diff(&panel->outputs, panel->changes);
+}
+
+/*
+ * Benchmark bodies
+ */
+
+static void count_frame(void *context, const uint8_t *frame, size_t length)
+{
+	uint64_t *sum = (uint64_t *)context;
+
+	*sum += length + frame[0];
+}
+
+static void bm_frame_scan(void *data, uint64_t iterations)
+{
+	const bench_traffic_t *traffic = (const bench_traffic_t *)data;
+	sb_framer_t framer;
+	uint64_t sum = 0U;
+
+	sb_framer_reset(&framer);
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		for (size_t pos = 0U; pos < traffic->wire_length; pos += BENCH_CHUNK)
+		{
+			const size_t chunk = ((traffic->wire_length - pos) < BENCH_CHUNK) ? (traffic->wire_length - pos) : BENCH_CHUNK;
+			(void)sb_framer_feed(&framer, &traffic->wire[pos], chunk, count_frame, &sum);
+		}
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_cobs_decode(void *data, uint64_t iterations)
+{
+	const bench_traffic_t *traffic = (const bench_traffic_t *)data;
+	uint8_t raw[SB_MAX_ENCODED];
+	uint64_t sum = 0U;
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		for (size_t i = 0U; i < traffic->frames; i++)
+		{
+			size_t raw_length = 0U;
+			if (sb_cobs_decode(&traffic->wire[traffic->frame_offset[i]], traffic->frame_length[i], raw, &raw_length))
+			{
+				sum += raw_length + raw[0];
+			}
+		}
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_checksum_validate(void *data, uint64_t iterations)
+{
+	const bench_traffic_t *traffic = (const bench_traffic_t *)data;
+	sb_packet_t packet;
+	uint64_t sum = 0U;
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		for (size_t i = 0U; i < traffic->frames; i++)
+		{
+			sum += (uint64_t)sb_packet_parse(&traffic->raw[i * SB_MAX_ENCODED], traffic->raw_length[i], BENCH_BOARD, &packet);
+		}
+	}
+	bench_sink = bench_sink + sum + packet.length;
+}
+
+static void sink_key(void *context, uint16_t board_id, uint8_t column, uint8_t row, bool pressed)
+{
+	*(uint64_t *)context += (uint64_t)board_id + column + row + (pressed ? 1U : 0U);
+}
+
+static void sink_adc(void *context, uint16_t board_id, uint8_t channel, uint16_t value)
+{
+	*(uint64_t *)context += (uint64_t)board_id + channel + value;
+}
+
+static void sink_rotary(void *context, uint16_t board_id, uint8_t encoder, bool clockwise)
+{
+	*(uint64_t *)context += (uint64_t)board_id + encoder + (clockwise ? 1U : 0U);
+}
+
+static void sink_echo(void *context, uint16_t board_id, const uint8_t *payload, uint8_t length)
+{
+	*(uint64_t *)context += (uint64_t)board_id + length + ((length > 0U) ? payload[0] : 0U);
+}
+
+static void sink_error_status(void *context, uint16_t board_id, uint8_t index, uint32_t value)
+{
+	*(uint64_t *)context += (uint64_t)board_id + index + value;
+}
+
+static void sink_task_status(void *context, uint16_t board_id, const sb_task_status_t *status)
+{
+	*(uint64_t *)context += (uint64_t)board_id + status->index + status->runtime + status->watermark;
+}
+
+static void sink_raw(void *context, const sb_packet_t *packet)
+{
+	*(uint64_t *)context += packet->command;
+}
+
+static sb_callbacks_t sink_callbacks(uint64_t *sum)
+{
+	return (sb_callbacks_t){
+		.context = sum,
+		.on_key = sink_key,
+		.on_adc = sink_adc,
+		.on_rotary = sink_rotary,
+		.on_echo = sink_echo,
+		.on_error_status = sink_error_status,
+		.on_task_status = sink_task_status,
+		.on_raw = sink_raw,
+	};
+}
+
+static void bm_dispatch(void *data, uint64_t iterations)
+{
+	const bench_traffic_t *traffic = (const bench_traffic_t *)data;
+	uint64_t sum = 0U;
+	const sb_callbacks_t callbacks = sink_callbacks(&sum);
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		for (size_t i = 0U; i < traffic->packet_count; i++)
+		{
+			(void)sb_dispatch(&traffic->packets[i], &callbacks);
+		}
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_reader(void *data, uint64_t iterations)
+{
+	const bench_traffic_t *traffic = (const bench_traffic_t *)data;
+	uint64_t sum = 0U;
+	const sb_callbacks_t callbacks = sink_callbacks(&sum);
+	static sb_reader_t reader;
+
+	sb_reader_init(&reader, BENCH_BOARD, &callbacks);
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		for (size_t pos = 0U; pos < traffic->wire_length; pos += BENCH_CHUNK)
+		{
+			const size_t chunk = ((traffic->wire_length - pos) < BENCH_CHUNK) ? (traffic->wire_length - pos) : BENCH_CHUNK;
+			(void)sb_reader_feed(&reader, &traffic->wire[pos], chunk);
+		}
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_output_diff(void *data, uint64_t iterations)
+{
+	bench_panel_t *panel = (bench_panel_t *)data;
+	uint64_t sum = 0U;
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		sum += sb_outputs_diff(&panel->outputs, panel->changes);
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_bulk_encode(void *data, uint64_t iterations)
+{
+	bench_panel_t *panel = (bench_panel_t *)data;
+	uint64_t sum = 0U;
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		// Put the board state back so every iteration encodes the same changes
+		panel->outputs.sent = panel->sent;
+		sum += sb_outputs_encode(&panel->outputs, panel->changes, panel->count, panel->wire, sizeof(panel->wire), NULL);
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_write_per_frame(void *data, uint64_t iterations)
+{
+	bench_panel_t *panel = (bench_panel_t *)data;
+	uint64_t sum = 0U;
+
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		panel->outputs.sent = panel->sent;
+		for (size_t i = 0U; i < panel->count; i++)
+		{
+			const size_t length = sb_outputs_encode(&panel->outputs, &panel->changes[i], 1U, panel->wire, sizeof(panel->wire), NULL);
+			sum += (uint64_t)write(bench_null_fd, panel->wire, length);
+		}
+	}
+	bench_sink = bench_sink + sum;
+}
+
+static void bm_write_coalesced(void *data, uint64_t iterations)
+{
+	bench_panel_t *panel = (bench_panel_t *)data;
+	static sb_writer_t writer;
+	const sb_writer_config_t config = { .deadline_us = UINT32_MAX, .threshold = SB_WRITER_CAPACITY };
+
+	sb_writer_init(&writer, bench_null_fd, BENCH_BOARD, &config);
+	for (uint64_t n = 0U; n < iterations; n++)
+	{
+		panel->outputs.sent = panel->sent;
+		for (size_t i = 0U; i < panel->count; i++)
+		{
+			const size_t length = sb_outputs_encode(&panel->outputs, &panel->changes[i], 1U, panel->wire, sizeof(panel->wire), NULL);
+			(void)sb_writer_append(&writer, panel->wire, length, 1U, n);
+		}
+		(void)sb_writer_flush(&writer, n);
+	}
+	bench_sink = bench_sink + writer.stats.bytes;
+}
+
+static const bench_family_t families[] = {
+	{ "BM_FrameScan", bm_frame_scan, false },
+	{ "BM_CobsDecode", bm_cobs_decode, false },
+	{ "BM_ChecksumValidate", bm_checksum_validate, false },
+	{ "BM_Dispatch", bm_dispatch, false },
+	{ "BM_Reader", bm_reader, false },
+	{ "BM_OutputDiff", bm_output_diff, true },
+	{ "BM_BulkEncode", bm_bulk_encode, true },
+	{ "BM_WritePerFrame", bm_write_per_frame, true },
+	{ "BM_WriteCoalesced", bm_write_coalesced, true },
+};
+
+#define FAMILY_COUNT (sizeof(families) / sizeof(families[0]))
+
+static const char *const outbound_mixes[] = { "annunciators", "displays", "full_panel" };
+
+#define OUTBOUND_MIX_COUNT (sizeof(outbound_mixes) / sizeof(outbound_mixes[0]))
+
+/*
+ * Runner
+ */
+
+/**
+ * @brief Grow the iteration count until a run lasts @p min_time, as Google Benchmark does.
+ */
+static void measure(bench_body_t body, void *data, double min_time, bench_result_t *result)
+{
+	uint64_t iterations = 1U;
+
+	for (;;)
+	{
+		const double real_start = now_seconds(CLOCK_MONOTONIC);
+		const double cpu_start = now_seconds(CLOCK_PROCESS_CPUTIME_ID);
+		body(data, iterations);
+		const double cpu = now_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+		const double real = now_seconds(CLOCK_MONOTONIC) - real_start;
+
+		if ((real >= min_time) || (iterations >= BENCH_MAX_ITERATIONS))
+		{
+			result->iterations = iterations;
+			result->real_ns = (real * 1e9) / (double)iterations;
+			result->cpu_ns = (cpu * 1e9) / (double)iterations;
+			break;
+		}
+
+		double multiplier = (min_time * 1.4) / ((real > 1e-9) ? real : 1e-9);
+		if (((real / min_time) <= 0.1) && (multiplier > 10.0))
+		{
+			multiplier = 10.0;
+		}
+		const double next = (double)iterations * multiplier;
+		iterations = (next > (double)(iterations + 1U)) ? (uint64_t)next : (iterations + 1U);
+		if (iterations > BENCH_MAX_ITERATIONS)
+		{
+			iterations = BENCH_MAX_ITERATIONS;
+		}
+	}
+}
+
+static void print_console_header(void)
+{
+	printf("%-40s %13s %15s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+	printf("--------------------------------------------------------------------------------------\n");
+}
+
+static void print_console(const bench_result_t *r)
+{
+	printf("%-40s %10.0f ns %12.0f ns %12" PRIu64, r->name, r->real_ns, r->cpu_ns, r->iterations);
+	if (r->bytes_per_second > 0.0)
+	{
+		printf(" bytes_per_second=%.4gM/s", r->bytes_per_second / 1048576.0);
+	}
+	printf(" items_per_second=%.4gM/s\n", r->items_per_second / 1e6);
+}
+
+static void write_json(FILE *out, const bench_result_t *results, size_t count, const char *executable)
+{
+	char host[256] = "unknown";
+	char date[64] = "";
+	const time_t now = time(NULL);
+	struct tm local;
+
+	(void)gethostname(host, sizeof(host) - 1U);
+	if (NULL != localtime_r(&now, &local))
+	{
+		(void)strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", &local);
+	}
+
+	fprintf(out, "{\n  \"context\": {\n");
+	fprintf(out, "    \"date\": \"%s\",\n", date);
+	fprintf(out, "    \"host_name\": \"%s\",\n", host);
+	fprintf(out, "    \"executable\": \"%s\",\n", executable);
+	fprintf(out, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(out, "    \"mhz_per_cpu\": 0,\n");
+	fprintf(out, "    \"cpu_scaling_enabled\": false,\n");
+	fprintf(out, "    \"caches\": [],\n");
+	fprintf(out, "    \"library_build_type\": \"%s\"\n",
+#ifdef NDEBUG
+	        "release"
+#else
+	        "debug"
+#endif
+	);
+	fprintf(out, "  },\n  \"benchmarks\": [\n");
+	for (size_t i = 0U; i < count; i++)
+	{
+		const bench_result_t *r = &results[i];
+
+		fprintf(out, "    {\n");
+		fprintf(out, "      \"name\": \"%s\",\n", r->name);
+		fprintf(out, "      \"family_index\": %" PRIu32 ",\n", r->family);
+		fprintf(out, "      \"per_family_instance_index\": %" PRIu32 ",\n", r->instance);
+		fprintf(out, "      \"run_name\": \"%s\",\n", r->name);
+		fprintf(out, "      \"run_type\": \"iteration\",\n");
+		fprintf(out, "      \"repetitions\": 1,\n");
+		fprintf(out, "      \"repetition_index\": 0,\n");
+		fprintf(out, "      \"threads\": 1,\n");
+		fprintf(out, "      \"iterations\": %" PRIu64 ",\n", r->iterations);
+		fprintf(out, "      \"real_time\": %.6e,\n", r->real_ns);
+		fprintf(out, "      \"cpu_time\": %.6e,\n", r->cpu_ns);
+		fprintf(out, "      \"time_unit\": \"ns\",\n");
+		if (r->bytes_per_second > 0.0)
+		{
+			fprintf(out, "      \"bytes_per_second\": %.6e,\n", r->bytes_per_second);
+		}
+		fprintf(out, "      \"items_per_second\": %.6e\n", r->items_per_second);
+		fprintf(out, "    }%s\n", ((i + 1U) < count) ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+}
+
+/**
+ * @brief Value of a @c --flag=value argument, or NULL.
+ */
+static const char *flag_value(const char *arg, const char *flag)
+{
+	const size_t length = strlen(flag);
+
+	return ((0 == strncmp(arg, flag, length)) && ('=' == arg[length])) ? &arg[length + 1U] : NULL;
+}
+
+int main(int argc, char **argv)
+{
+	static bench_traffic_t traffic[INBOUND_MIX_COUNT + 1U];
+	static bench_panel_t panels[OUTBOUND_MIX_COUNT];
+	static bench_result_t results[BENCH_MAX_RESULTS];
+	const char *filter = "";
+	const char *out_path = NULL;
+	const char *capture = NULL;
+	double min_time = BENCH_DEFAULT_MIN_TIME;
+	bool json = false;
+	bool list = false;
+	bool valid = true;
+	size_t traffic_count = 0U;
+	size_t count = 0U;
+	int status = 0;
+
+	for (int i = 1; (i < argc) && valid; i++)
+	{
+		const char *value = NULL;
+
+		if (NULL != (value = flag_value(argv[i], "--benchmark_filter")))
+		{
+			filter = value;
+		}
+		else if (NULL != (value = flag_value(argv[i], "--benchmark_min_time")))
+		{
+			char *end = NULL;
+			min_time = strtod(value, &end);
+			valid = (end != value) && (('\0' == *end) || (0 == strcmp(end, "s"))) && (min_time > 0.0);
+		}
+		else if (NULL != (value = flag_value(argv[i], "--benchmark_format")))
+		{
+			json = 0 == strcmp(value, "json");
+			valid = json || (0 == strcmp(value, "console"));
+		}
+		else if (NULL != (value = flag_value(argv[i], "--benchmark_out")))
+		{
+			out_path = value;
+		}
+		else if (NULL != (value = flag_value(argv[i], "--benchmark_traffic")))
+		{
+			capture = value;
+		}
+		else if (0 == strcmp(argv[i], "--benchmark_list_tests"))
+		{
+			list = true;
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+
+	for (size_t m = 0U; valid && (m < INBOUND_MIX_COUNT); m++)
+	{
+		valid = generate_traffic(&traffic[traffic_count], &inbound_mixes[m], 0x5B1D6E00U + (uint32_t)m);
+		traffic_count++;
+	}
+	if (valid && (NULL != capture))
+	{
+		valid = load_traffic(&traffic[traffic_count], capture);
+		if (!valid)
+		{
+			fprintf(stderr, "%s: no valid frames in %s\n", argv[0], capture);
+		}
+		traffic_count++;
+	}
+	for (size_t m = 0U; m < OUTBOUND_MIX_COUNT; m++)
+	{
+		prepare_panel(&panels[m], outbound_mixes[m], 0x0B7E0000U + (uint32_t)m);
+	}
+	bench_null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC); // flawfinder: ignore
+	if (valid && (bench_null_fd < 0))
+	{
+		fprintf(stderr, "%s: cannot open /dev/null\n", argv[0]);
+		valid = false;
+	}
+
+	if (!valid)
+	{
+		fprintf(stderr,
+		        "usage: %s [--benchmark_filter=SUBSTRING] [--benchmark_min_time=SECONDS]\n"
+		        "       [--benchmark_format=console|json] [--benchmark_out=FILE]\n"
+		        "       [--benchmark_list_tests] [--benchmark_traffic=CAPTURE]\n",
+		        argv[0]);
+		status = 2;
+	}
+	else
+	{
+		if (!json && !list)
+		{
+			print_console_header();
+		}
+
+		for (uint32_t f = 0U; f < FAMILY_COUNT; f++)
+		{
+			const size_t mixes = families[f].outbound ? OUTBOUND_MIX_COUNT : traffic_count;
+
+			for (uint32_t m = 0U; (m < mixes) && (count < BENCH_MAX_RESULTS); m++)
+			{
+				bench_result_t *r = &results[count];
+				const char *mix = families[f].outbound ? panels[m].name : traffic[m].name;
+				void *data = families[f].outbound ? (void *)&panels[m] : (void *)&traffic[m];
+
+				(void)snprintf(r->name, sizeof(r->name), "%s/%s", families[f].name, mix);
+				if (NULL == strstr(r->name, filter))
+				{
+					continue;
+				}
+				if (list)
+				{
+					printf("%s\n", r->name);
+					continue;
+				}
+
+				r->family = f;
+				r->instance = m;
+				measure(families[f].body, data, min_time, r);
+
+				// Bytes and items handled by one iteration
+				double bytes = 0.0;
+				double items;
+				if (families[f].outbound)
+				{
+					items = (double)panels[m].count;
+				}
+				else
+				{
+					items = (double)traffic[m].packet_count;
+					bytes = (double)traffic[m].wire_length;
+				}
+				const double cpu_s = (r->cpu_ns > 0.0) ? (r->cpu_ns * 1e-9) : 1e-9;
+				r->items_per_second = items / cpu_s;
+				r->bytes_per_second = bytes / cpu_s;
+
+				if (!json)
+				{
+					print_console(r);
+				}
+				count++;
+			}
+		}
+
+		if (json && !list)
+		{
+			write_json(stdout, results, count, argv[0]);
+		}
+		if ((NULL != out_path) && !list)
+		{
+			FILE *out = fopen(out_path, "w"); // flawfinder: ignore
+			if (NULL == out)
+			{
+				fprintf(stderr, "%s: cannot write %s\n", argv[0], out_path);
+				status = 1;
+			}
+			else
+			{
+				write_json(out, results, count, argv[0]);
+				(void)fclose(out);
+			}
+		}
+	}
+
+	for (size_t m = 0U; m < traffic_count; m++)
+	{
+		free(traffic[m].wire);
+		free(traffic[m].frame_offset);
+		free(traffic[m].frame_length);
+		free(traffic[m].raw);
+		free(traffic[m].raw_length);
+		free(traffic[m].packets);
+	}
+	if (bench_null_fd >= 0)
+	{
+		(void)close(bench_null_fd);
+	}
+
+	return status;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file sb_rt_check.c
+ * @brief Reader thread placement self-test.
+ *
+ * Measures the wakeup-to-callback latency of the reader thread under load
+ * with each placement of @ref sb_rt_self_test and prints the one to use:
+ *
+ *     sb_rt_check [--cpu=N] [--samples=N]
+ *
+ * Run it as the user the application runs as: whether SCHED_FIFO and
+ * memory locking are granted depends on that user's limits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sb_rt.h"
+
+/** Frames measured per placement by default. */
+#define RT_CHECK_DEFAULT_SAMPLES 2000U
+
+static const char *flag_value(const char *arg, const char *flag)
+{
+	const size_t length = strlen(flag);
+
+	return ((0 == strncmp(arg, flag, length)) && ('=' == arg[length])) ? &arg[length + 1U] : NULL;
+}
+
+static void describe(const sb_rt_config_t *config, char *text, size_t size)
+{
+	char cpu[16] = "";
+
+	if (config->cpu >= 0)
+	{
+		(void)snprintf(cpu, sizeof(cpu), "+cpu%d", config->cpu);
+	}
+	(void)snprintf(text, size, "%s%s%s", (config->priority > 0) ? "fifo" : "default", cpu,
+	               config->lock_memory ? "+mlock" : "");
+}
+
+int main(int argc, char **argv)
+{
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int cpu = (cpus > 1) ? (int)(cpus - 1) : 0;
+	unsigned long samples = RT_CHECK_DEFAULT_SAMPLES;
+	int status = 0;
+
+	for (int i = 1; (i < argc) && (0 == status); i++)
+	{
+		const char *value = NULL;
+		char *end = NULL;
+
+		if (NULL != (value = flag_value(argv[i], "--cpu")))
+		{
+			cpu = (int)strtol(value, &end, 10);
+			status = ((end == value) || ('\0' != *end) || (cpu < 0)) ? 2 : 0;
+		}
+		else if (NULL != (value = flag_value(argv[i], "--samples")))
+		{
+			samples = strtoul(value, &end, 10);
+			status = ((end == value) || ('\0' != *end) || (0U == samples) || (samples > 1000000U)) ? 2 : 0;
+		}
+		else
+		{
+			status = 2;
+		}
+	}
+
+	if (0 != status)
+	{
+		fprintf(stderr, "usage: %s [--cpu=N] [--samples=N]\n", argv[0]);
+	}
+	else
+	{
+		sb_rt_report_t report;
+
+		printf("Reader latency under load, %lu frames per placement, %ld busy threads\n\n", samples, cpus);
+		sb_rt_self_test(cpu, (uint32_t)samples, &report);
+
+		printf("%-24s %-16s %8s %8s %8s %8s\n", "Placement", "Applied", "min us", "p50 us", "p99 us", "max us");
+		for (uint32_t i = 0U; i < SB_RT_CANDIDATES; i++)
+		{
+			const sb_latency_t *l = &report.latency[i];
+			char name[48];
+			char applied[32];
+
+			describe(&report.config[i], name, sizeof(name));
+			(void)snprintf(applied, sizeof(applied), "%s%s%s%s", (0U == report.applied[i]) ? "-" : "",
+			               (0U != (report.applied[i] & SB_RT_PINNED)) ? "pin " : "",
+			               (0U != (report.applied[i] & SB_RT_FIFO)) ? "fifo " : "",
+			               (0U != (report.applied[i] & SB_RT_LOCKED)) ? "mlock" : "");
+			printf("%-24s %-16s %8u %8u %8u %8u%s\n", name, applied, l->min_us, l->p50_us, l->p99_us, l->max_us,
+			       (i == report.recommended) ? "  <- recommended" : "");
+		}
+
+		if (0U == report.recommended)
+		{
+			printf("\nNo placement beat the default by a clear margin, or none was permitted.\n"
+			       "SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit; mlockall needs CAP_IPC_LOCK or a memlock limit.\n");
+		}
+	}
+
+	return status;
+}
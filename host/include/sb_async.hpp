@@ -0,0 +1,445 @@
+/**
+ * @file sb_async.hpp
+ * @brief C++20 coroutine interface of the host library.
+ *
+ * Lets an application await board input instead of registering callbacks:
+ *
+ * @code
+ * sb::board board(1U, fd);
+ * // I/O thread: board.feed(bytes, length) for every read
+ *
+ * task handle_panel(sb::board &board)
+ * {
+ *     for (;;)
+ *     {
+ *         const sb::event e = co_await board.next_event();
+ *         if (sb::event_kind::closed == e.kind) { break; }
+ *         ...
+ *     }
+ * }
+ *
+ * const std::optional<sb_packet_t> reply = co_await board.request(SB_CMD_ECHO, payload, 2U);
+ * @endcode
+ *
+ * Each awaiter lives in the awaiting coroutine's frame and is linked into
+ * the board's wait list while suspended, so waiting and delivering never
+ * allocate. A waiting coroutine is resumed on the thread that calls
+ * @ref sb::basic_board::feed, unless an executor is given, in which case
+ * the executor gets the handle. Events that arrive while nobody waits are
+ * kept in a fixed ring of @p Capacity entries; when it is full the oldest
+ * is dropped and counted.
+ *
+ * Replies are matched to requests by command, oldest request first. There
+ * is no timeout: @ref sb::basic_board::close resumes every waiter with a
+ * closed event or an empty reply.
+ */
+
+#ifndef SB_ASYNC_HPP
+#define SB_ASYNC_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+extern "C" {
+#include "sb_protocol.h"
+#include "sb_reader.h"
+#include "sb_writer.h"
+}
+
+namespace sb {
+
+/** Kinds of @ref event. */
+enum class event_kind : std::uint8_t {
+	key,    /**< Key press or release */
+	adc,    /**< ADC value */
+	rotary, /**< Encoder detent */
+	closed  /**< The board was closed; no more events follow */
+};
+
+/** One input event, delta frames already expanded. */
+struct event {
+	event_kind kind = event_kind::closed; /**< What happened */
+	std::uint16_t board_id = 0U;          /**< Sending board */
+	std::uint8_t index = 0U;              /**< Key column, ADC channel or encoder */
+	std::uint8_t row = 0U;                /**< Key row */
+	std::uint16_t value = 0U;             /**< ADC value, or 1 for pressed / clockwise */
+};
+
+/** Hands a ready coroutine to the application's executor. */
+using executor_fn = void (*)(void *context, std::coroutine_handle<> handle);
+
+/**
+ * @brief One board, awaitable.
+ *
+ * @tparam Capacity Events kept while no coroutine waits.
+ */
+template <std::size_t Capacity = 64U>
+class basic_board {
+	static_assert(Capacity > 0U, "the event ring needs at least one entry");
+
+public:
+	/** Awaiter of @ref next_event. */
+	class event_awaiter {
+	public:
+		explicit event_awaiter(basic_board &board) noexcept : board_(board) {}
+
+		bool await_ready() const noexcept { return false; }
+
+		bool await_suspend(std::coroutine_handle<> handle) noexcept
+		{
+			handle_ = handle;
+			return board_.wait_event(*this);
+		}
+
+		event await_resume() const noexcept { return result_; }
+
+	private:
+		friend class basic_board;
+
+		basic_board &board_;
+		std::coroutine_handle<> handle_;
+		event_awaiter *next_ = nullptr;
+		event result_;
+	};
+
+	/** Awaiter of @ref request. */
+	class request_awaiter {
+	public:
+		request_awaiter(basic_board &board, std::uint8_t command, const std::uint8_t *payload,
+		                std::uint8_t length) noexcept
+			: board_(board), command_(command), payload_(payload), length_(length)
+		{
+		}
+
+		bool await_ready() const noexcept { return false; }
+
+		bool await_suspend(std::coroutine_handle<> handle) noexcept
+		{
+			handle_ = handle;
+			return board_.wait_reply(*this);
+		}
+
+		std::optional<sb_packet_t> await_resume() const noexcept { return result_; }
+
+	private:
+		friend class basic_board;
+
+		basic_board &board_;
+		std::uint8_t command_;
+		const std::uint8_t *payload_;
+		std::uint8_t length_;
+		std::coroutine_handle<> handle_;
+		request_awaiter *next_ = nullptr;
+		std::optional<sb_packet_t> result_;
+	};
+
+	/** Counters. */
+	struct stats_t {
+		std::uint64_t events = 0U;    /**< Events delivered or queued */
+		std::uint64_t dropped = 0U;   /**< Queued events overwritten while nobody waited */
+		std::uint64_t replies = 0U;   /**< Replies matched to a request */
+		std::uint64_t unmatched = 0U; /**< Packets neither input nor an awaited reply */
+		std::uint64_t invalid = 0U;   /**< Frames that failed validation or did not fit their command */
+	};
+
+	/**
+	 * @param board_id         Board ID (1 to 0x7FF).
+	 * @param fd               Board tty, for requests.
+	 * @param executor         Runs resumed coroutines; nullptr resumes them inline.
+	 * @param executor_context Passed to @p executor.
+	 */
+	basic_board(std::uint16_t board_id, int fd, executor_fn executor = nullptr,
+	            void *executor_context = nullptr) noexcept
+		: board_id_(board_id), executor_(executor), executor_context_(executor_context)
+	{
+		const sb_writer_config_t config = { 0U, SB_WRITER_CAPACITY };
+
+		sb_framer_reset(&framer_);
+		sb_writer_init(&writer_, fd, board_id, &config);
+		callbacks_.context = this;
+		callbacks_.on_key = on_key;
+		callbacks_.on_adc = on_adc;
+		callbacks_.on_rotary = on_rotary;
+	}
+
+	basic_board(const basic_board &) = delete;
+	basic_board &operator=(const basic_board &) = delete;
+
+	/** Wait for the next input event. */
+	event_awaiter next_event() noexcept { return event_awaiter(*this); }
+
+	/**
+	 * @brief Send a request and wait for the board's reply with the same command.
+	 *
+	 * @param command Command ID.
+	 * @param payload Payload (may be nullptr when @p length is 0); read before the first suspension.
+	 * @param length  Payload length.
+	 *
+	 * @return Reply packet, or empty when the write failed or the board was closed.
+	 */
+	request_awaiter request(std::uint8_t command, const std::uint8_t *payload = nullptr,
+	                        std::uint8_t length = 0U) noexcept
+	{
+		return request_awaiter(*this, command, payload, length);
+	}
+
+	/**
+	 * @brief Frame, validate and deliver bytes read from the board.
+	 *
+	 * Call from one thread only. Coroutines resumed inline run inside this call.
+	 */
+	void feed(const std::uint8_t *bytes, std::size_t length) noexcept
+	{
+		(void)sb_framer_feed(&framer_, bytes, length, on_frame, this);
+	}
+
+	/** Resume every waiter with a closed event or an empty reply. */
+	void close() noexcept
+	{
+		event_awaiter *events = nullptr;
+		request_awaiter *requests = nullptr;
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+			events = event_head_;
+			requests = request_head_;
+			event_head_ = nullptr;
+			event_tail_ = nullptr;
+			request_head_ = nullptr;
+			request_tail_ = nullptr;
+		}
+
+		while (nullptr != events)
+		{
+			event_awaiter *next = events->next_;
+			events->result_ = event{};
+			resume(events->handle_);
+			events = next;
+		}
+		while (nullptr != requests)
+		{
+			request_awaiter *next = requests->next_;
+			requests->result_.reset();
+			resume(requests->handle_);
+			requests = next;
+		}
+	}
+
+	/** Counters; read from the feeding thread or after @ref close. */
+	const stats_t &stats() const noexcept { return stats_; }
+
+private:
+	/** Take a queued event or join the wait list. @return Whether to suspend. */
+	bool wait_event(event_awaiter &awaiter) noexcept
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		bool suspend = false;
+
+		if (count_ > 0U)
+		{
+			awaiter.result_ = ring_[head_];
+			head_ = (head_ + 1U) % Capacity;
+			count_--;
+		}
+		else if (closed_)
+		{
+			awaiter.result_ = event{};
+		}
+		else
+		{
+			awaiter.next_ = nullptr;
+			(nullptr == event_tail_) ? (event_head_ = &awaiter) : (event_tail_->next_ = &awaiter);
+			event_tail_ = &awaiter;
+			suspend = true;
+		}
+
+		return suspend;
+	}
+
+	/** Join the reply wait list, then send. @return Whether to suspend. */
+	bool wait_reply(request_awaiter &awaiter) noexcept
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		bool suspend = !closed_;
+
+		// Listed before the write, so a fast reply cannot miss it
+		if (suspend)
+		{
+			awaiter.next_ = nullptr;
+			(nullptr == request_tail_) ? (request_head_ = &awaiter) : (request_tail_->next_ = &awaiter);
+			request_tail_ = &awaiter;
+		}
+
+		if (suspend && !sb_writer_send_urgent(&writer_, awaiter.command_, awaiter.payload_, awaiter.length_, 0U))
+		{
+			unlink(awaiter);
+			suspend = false;
+		}
+
+		return suspend;
+	}
+
+	void unlink(request_awaiter &awaiter) noexcept
+	{
+		request_awaiter *previous = nullptr;
+
+		for (request_awaiter *node = request_head_; nullptr != node; node = node->next_)
+		{
+			if (&awaiter == node)
+			{
+				(nullptr == previous) ? (request_head_ = node->next_) : (previous->next_ = node->next_);
+				if (request_tail_ == node)
+				{
+					request_tail_ = previous;
+				}
+				break;
+			}
+			previous = node;
+		}
+	}
+
+	void resume(std::coroutine_handle<> handle) noexcept
+	{
+		if (nullptr != executor_)
+		{
+			executor_(executor_context_, handle);
+		}
+		else
+		{
+			handle.resume();
+		}
+	}
+
+	void deliver(const event &e) noexcept
+	{
+		event_awaiter *awaiter = nullptr;
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			stats_.events++;
+			if (nullptr != event_head_)
+			{
+				awaiter = event_head_;
+				event_head_ = awaiter->next_;
+				if (nullptr == event_head_)
+				{
+					event_tail_ = nullptr;
+				}
+			}
+			else
+			{
+				if (Capacity == count_)
+				{
+					head_ = (head_ + 1U) % Capacity;
+					count_--;
+					stats_.dropped++;
+				}
+				ring_[(head_ + count_) % Capacity] = e;
+				count_++;
+			}
+		}
+
+		if (nullptr != awaiter)
+		{
+			awaiter->result_ = e;
+			resume(awaiter->handle_);
+		}
+	}
+
+	/** Hand a reply to the oldest request for its command. @return Whether one waited. */
+	bool reply(const sb_packet_t &packet) noexcept
+	{
+		request_awaiter *awaiter = nullptr;
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			for (request_awaiter *node = request_head_; nullptr != node; node = node->next_)
+			{
+				if (node->command_ == packet.command)
+				{
+					awaiter = node;
+					unlink(*node);
+					break;
+				}
+			}
+		}
+
+		if (nullptr != awaiter)
+		{
+			awaiter->result_ = packet;
+			resume(awaiter->handle_);
+		}
+
+		return nullptr != awaiter;
+	}
+
+	static void on_frame(void *context, const std::uint8_t *frame, std::size_t length)
+	{
+		basic_board *self = static_cast<basic_board *>(context);
+		sb_packet_t packet;
+		const sb_status_t status = sb_frame_decode(frame, length, self->board_id_, &packet);
+
+		if ((SB_OK != status) && (SB_UNKNOWN_COMMAND != status))
+		{
+			self->stats_.invalid++;
+		}
+		else if ((SB_CMD_KEY == packet.command) || (SB_CMD_AD == packet.command) ||
+		         (SB_CMD_ROTARY == packet.command) || ((SB_CMD_STATE_DELTA == packet.command) && (packet.length >= 2U)))
+		{
+			if (!sb_dispatch(&packet, &self->callbacks_))
+			{
+				self->stats_.invalid++;
+			}
+		}
+		else if (self->reply(packet))
+		{
+			self->stats_.replies++;
+		}
+		else
+		{
+			self->stats_.unmatched++;
+		}
+	}
+
+	static void on_key(void *context, std::uint16_t board_id, std::uint8_t column, std::uint8_t row, bool pressed)
+	{
+		static_cast<basic_board *>(context)->deliver(
+			event{ event_kind::key, board_id, column, row, static_cast<std::uint16_t>(pressed ? 1U : 0U) });
+	}
+
+	static void on_adc(void *context, std::uint16_t board_id, std::uint8_t channel, std::uint16_t value)
+	{
+		static_cast<basic_board *>(context)->deliver(event{ event_kind::adc, board_id, channel, 0U, value });
+	}
+
+	static void on_rotary(void *context, std::uint16_t board_id, std::uint8_t encoder, bool clockwise)
+	{
+		static_cast<basic_board *>(context)->deliver(
+			event{ event_kind::rotary, board_id, encoder, 0U, static_cast<std::uint16_t>(clockwise ? 1U : 0U) });
+	}
+
+	std::uint16_t board_id_;
+	executor_fn executor_;
+	void *executor_context_;
+	sb_framer_t framer_;
+	sb_writer_t writer_;
+	sb_callbacks_t callbacks_{};
+	std::mutex mutex_;
+	bool closed_ = false;
+	event_awaiter *event_head_ = nullptr;
+	event_awaiter *event_tail_ = nullptr;
+	request_awaiter *request_head_ = nullptr;
+	request_awaiter *request_tail_ = nullptr;
+	event ring_[Capacity];
+	std::size_t head_ = 0U;
+	std::size_t count_ = 0U;
+	stats_t stats_;
+};
+
+/** Board with the default event ring. */
+using board = basic_board<>;
+
+} // namespace sb
+
+#endif // SB_ASYNC_HPP
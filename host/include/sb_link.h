@@ -0,0 +1,154 @@
+/**
+ * @file sb_link.h
+ * @brief Connection of one board: reconnect, resynchronise, replay (POSIX).
+ *
+ * A link follows a board by its USB serial number. When the board
+ * disappears (cable pulled, board reset, hub power cycle) the link keeps the
+ * output cache and polls for the serial number to come back. On reconnect it
+ * opens the new tty with DTR and RTS asserted and, in the same write, asks
+ * for a state dump. When the dump completes:
+ *
+ * - the application's on_resync runs with the complete input state; outputs
+ *   it sets there go out with the replay;
+ * - if the board's uptime is shorter than the time it was away, it
+ *   restarted and shows defaults, so everything the application wants that is
+ *   not a default is replayed; otherwise only what changed while away;
+ * - the replay is one write of back-to-back frames.
+ *
+ * Outputs the application sets afterwards go through an @ref sb_writer_t,
+ * which coalesces the frames of one step into as few writes as possible.
+ *
+ * Reconnect time is bounded by the poll interval of the caller plus one
+ * request/reply exchange (a few USB frames); polling every 10 ms keeps the
+ * whole resync well under 100 ms.
+ */
+
+#ifndef SB_LINK_H
+#define SB_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sb_outputs.h"
+#include "sb_reader.h"
+#include "sb_writer.h"
+
+/** Longest USB serial number followed. */
+#define SB_LINK_SERIAL_MAX 64U
+/** Time to wait for the state dump before replaying everything anyway. */
+#define SB_LINK_DUMP_TIMEOUT_MS 100U
+/** Uptime margin for the reset test: how late a lost connection may be noticed. */
+#define SB_LINK_RESET_SLACK_MS 50U
+/** First retry delay after a failed open. */
+#define SB_LINK_BACKOFF_MIN_MS 1000U
+/** Longest retry delay after failed opens. */
+#define SB_LINK_BACKOFF_MAX_MS 30000U
+
+/**
+ * @brief Connection state.
+ */
+typedef enum sb_link_state_t {
+	SB_LINK_DISCONNECTED = 0, /**< Waiting for the board to enumerate */
+	SB_LINK_RESYNCING,        /**< Open; waiting for the state dump */
+	SB_LINK_CONNECTED         /**< Open and in sync */
+} sb_link_state_t;
+
+/**
+ * @brief Link counters.
+ */
+typedef struct sb_link_stats_t {
+	uint64_t connects;      /**< Successful opens */
+	uint64_t disconnects;   /**< Connections lost */
+	uint64_t board_resets;  /**< Reconnects where the board had reset */
+	uint64_t dump_timeouts; /**< Reconnects without a state dump reply */
+	uint32_t resync_ms;     /**< Enumeration seen to replay written, last reconnect */
+} sb_link_stats_t;
+
+/**
+ * @brief Connection of one board.
+ */
+typedef struct sb_link_t {
+	char serial[SB_LINK_SERIAL_MAX]; /**< USB serial number followed */
+	uint16_t board_id;               /**< Board ID */
+	int fd;                          /**< Open tty, or -1 */
+	uint8_t state;                   /**< @ref sb_link_state_t */
+	uint8_t tag;                     /**< Tag of the last state dump request */
+	bool ever_connected;             /**< At least one resync done */
+	uint64_t found_ms;               /**< When the board was last seen enumerating */
+	uint64_t lost_ms;                /**< When the connection was lost */
+	uint64_t opened_ms;              /**< When the tty was last opened */
+	uint64_t retry_ms;               /**< Earliest next open after a failure */
+	uint32_t backoff_ms;             /**< Current retry delay */
+	sb_reader_t reader;              /**< Receive path */
+	sb_outputs_t outputs;            /**< Output cache; set outputs here, then call @ref sb_link_flush */
+	sb_output_state_t written;       /**< Board outputs as of the last completed write */
+	sb_writer_t writer;              /**< Send path */
+	sb_link_stats_t stats;           /**< Counters */
+} sb_link_t;
+
+/**
+ * @brief Start a link; nothing is opened until @ref sb_link_poll.
+ *
+ * @param[out] link      Link.
+ * @param[in]  serial    USB serial number of the board.
+ * @param[in]  board_id  Board ID (1 to 0x7FF).
+ * @param[in]  callbacks Application callbacks (copied); on_resync is called after each reconnect.
+ * @param[in]  config    Write coalescing policy, or NULL for the defaults.
+ *
+ * @retval true  Started.
+ * @retval false Serial number too long.
+ */
+bool sb_link_init(sb_link_t *link, const char *serial, uint16_t board_id, const sb_callbacks_t *callbacks,
+                  const sb_writer_config_t *config);
+
+/**
+ * @brief Do whatever the link needs now, without blocking.
+ *
+ * Looks for the board while disconnected, reads and dispatches what arrived
+ * while open, writes queued outputs that are due, and notices when the board
+ * went away. Call it when the tty is readable, when
+ * sb_writer_due_in(&link->writer, ...) expires, and at least every 10 ms
+ * while disconnected.
+ *
+ * @param[in,out] link Link.
+ *
+ * @return State after the call.
+ */
+sb_link_state_t sb_link_poll(sb_link_t *link);
+
+/**
+ * @brief Queue the outputs that differ from the board.
+ *
+ * They are written together with other queued frames when the writer's
+ * deadline or threshold is reached, or at once when @p urgent is set.
+ * While the link is down or resyncing the changes stay in the cache and go
+ * out with the replay.
+ *
+ * @param[in,out] link   Link.
+ * @param[in]     urgent Write now, behind anything already queued.
+ *
+ * @retval true  Sent, or nothing to send.
+ * @retval false Not connected, or the write failed (the link is then closed
+ *               and the changes stay pending).
+ */
+bool sb_link_flush(sb_link_t *link, bool urgent);
+
+/**
+ * @brief Close the tty; the output cache is kept.
+ *
+ * @param[in,out] link Link.
+ */
+void sb_link_close(sb_link_t *link);
+
+/**
+ * @brief Decide whether a board reset while it was away.
+ *
+ * @param[in] uptime_ms  Board uptime from the state dump.
+ * @param[in] offline_ms Time from losing the board to receiving the dump.
+ *
+ * @retval true  The board started after it was lost: outputs are at their defaults.
+ * @retval false The board kept running and kept its outputs.
+ */
+bool sb_link_board_reset(uint32_t uptime_ms, uint64_t offline_ms);
+
+#endif // SB_LINK_H
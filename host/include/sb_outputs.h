@@ -0,0 +1,177 @@
+/**
+ * @file sb_outputs.h
+ * @brief Output state cache of the host library.
+ *
+ * The application sets outputs as often as it likes; the cache remembers
+ * what it wants each output to show and what was last sent to the board.
+ * @ref sb_outputs_diff lists the outputs that differ and
+ * @ref sb_outputs_encode turns them into back-to-back wire frames in one
+ * buffer, so a whole panel update goes out in a single write. Outputs set
+ * back to the value already on the board cost nothing.
+ *
+ * The cache covers the state-carrying commands: PWM duty, LED matrix
+ * columns, display digits and display brightness. Set number and set
+ * target are sent directly, since the board formats those itself.
+ */
+
+#ifndef SB_OUTPUTS_H
+#define SB_OUTPUTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Controller slots (IDs 1 to 8). */
+#define SB_CONTROLLERS 8U
+/** LED matrix columns per controller. */
+#define SB_LED_COLUMNS 8U
+/** Digits per display. */
+#define SB_DIGITS 8U
+/** Dot position meaning no dot. */
+#define SB_NO_DOT 0xFFU
+/** Set digits payload after its header: four BCD pairs and the dot. */
+#define SB_DIGITS_BYTES 5U
+/** Brightness of a display after a board reset. */
+#define SB_DEFAULT_BRIGHTNESS 7U
+/** Largest number of changes @ref sb_outputs_diff can report. */
+#define SB_OUTPUT_MAX_CHANGES (1U + (SB_CONTROLLERS * SB_LED_COLUMNS) + (2U * SB_CONTROLLERS))
+
+/**
+ * @brief Kinds of cached output.
+ */
+typedef enum sb_output_kind_t {
+	SB_OUTPUT_PWM = 0,    /**< Global PWM duty */
+	SB_OUTPUT_LED,        /**< One LED matrix column */
+	SB_OUTPUT_DIGITS,     /**< Digits of one display */
+	SB_OUTPUT_BRIGHTNESS  /**< Brightness of one display */
+} sb_output_kind_t;
+
+/**
+ * @brief One output that differs from the board.
+ */
+typedef struct sb_output_change_t {
+	uint8_t kind;       /**< @ref sb_output_kind_t */
+	uint8_t controller; /**< Controller index, 0-based (unused for PWM) */
+	uint8_t column;     /**< LED column (LED only) */
+} sb_output_change_t;
+
+/**
+ * @brief State of every cached output.
+ */
+typedef struct sb_output_state_t {
+	uint8_t led[SB_CONTROLLERS][SB_LED_COLUMNS];     /**< LED column masks */
+	uint8_t digits[SB_CONTROLLERS][SB_DIGITS_BYTES]; /**< Set digits payload bytes 1-5 */
+	uint8_t brightness[SB_CONTROLLERS];              /**< Display brightness */
+	uint8_t digits_valid;                            /**< Bit N set when display N has known digits */
+	uint8_t pwm;                                     /**< PWM duty */
+} sb_output_state_t;
+
+/**
+ * @brief Output cache of one board.
+ */
+typedef struct sb_outputs_t {
+	uint16_t board_id;       /**< Board the frames are addressed to */
+	sb_output_state_t wanted; /**< What the application set */
+	sb_output_state_t sent;   /**< What the board shows */
+} sb_outputs_t;
+
+/**
+ * @brief Start a cache for a freshly reset board.
+ *
+ * @param[out] outputs  Cache.
+ * @param[in]  board_id Board ID (1 to 0x7FF).
+ */
+void sb_outputs_init(sb_outputs_t *outputs, uint16_t board_id);
+
+/**
+ * @brief Record that the board reset: everything wanted is sent again.
+ *
+ * @param[in,out] outputs Cache.
+ */
+void sb_outputs_forget(sb_outputs_t *outputs);
+
+/**
+ * @brief Set the PWM duty.
+ *
+ * @param[in,out] outputs Cache.
+ * @param[in]     duty    Duty (0-255).
+ */
+void sb_outputs_set_pwm(sb_outputs_t *outputs, uint8_t duty);
+
+/**
+ * @brief Set one LED matrix column.
+ *
+ * @param[in,out] outputs    Cache.
+ * @param[in]     controller Controller ID (1-8).
+ * @param[in]     column     Column (0-7).
+ * @param[in]     mask       LED bitmask.
+ *
+ * @retval true  Set.
+ * @retval false Controller or column out of range.
+ */
+bool sb_outputs_set_led(sb_outputs_t *outputs, uint8_t controller, uint8_t column, uint8_t mask);
+
+/**
+ * @brief Set the digits of a display.
+ *
+ * @param[in,out] outputs    Cache.
+ * @param[in]     controller Controller ID (1-8).
+ * @param[in]     digits     BCD digits, leftmost first (0x0-0xF each).
+ * @param[in]     dot        Dot position (0-7) or @ref SB_NO_DOT.
+ *
+ * @retval true  Set.
+ * @retval false Controller, digit or dot out of range.
+ */
+bool sb_outputs_set_digits(sb_outputs_t *outputs, uint8_t controller, const uint8_t digits[SB_DIGITS], uint8_t dot);
+
+/**
+ * @brief Set the brightness of a display.
+ *
+ * @param[in,out] outputs    Cache.
+ * @param[in]     controller Controller ID (1-8).
+ * @param[in]     brightness Brightness (0 = off, 1-7).
+ *
+ * @retval true  Set.
+ * @retval false Controller or brightness out of range.
+ */
+bool sb_outputs_set_brightness(sb_outputs_t *outputs, uint8_t controller, uint8_t brightness);
+
+/**
+ * @brief List the outputs that differ from the board.
+ *
+ * @param[in]  outputs Cache.
+ * @param[out] changes Changes (@ref SB_OUTPUT_MAX_CHANGES entries).
+ *
+ * @return Number of changes.
+ */
+size_t sb_outputs_diff(const sb_outputs_t *outputs, sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES]);
+
+/**
+ * @brief Encode changes as back-to-back wire frames and mark them sent.
+ *
+ * Stops at the first change whose frame does not fit.
+ *
+ * @param[in,out] outputs Cache.
+ * @param[in]     changes Changes from @ref sb_outputs_diff.
+ * @param[in]     count   Number of changes.
+ * @param[out]    wire    Output buffer.
+ * @param[in]     size    Size of @p wire.
+ * @param[out]    encoded Number of changes encoded (may be NULL).
+ *
+ * @return Bytes written.
+ */
+size_t sb_outputs_encode(sb_outputs_t *outputs, const sb_output_change_t *changes, size_t count,
+                         uint8_t *wire, size_t size, size_t *encoded);
+
+/**
+ * @brief Diff and encode in one call.
+ *
+ * @param[in,out] outputs Cache.
+ * @param[out]    wire    Output buffer.
+ * @param[in]     size    Size of @p wire.
+ *
+ * @return Bytes written; outputs that did not fit stay pending.
+ */
+size_t sb_outputs_flush(sb_outputs_t *outputs, uint8_t *wire, size_t size);
+
+#endif // SB_OUTPUTS_H
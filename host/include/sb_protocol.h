@@ -0,0 +1,159 @@
+/**
+ * @file sb_protocol.h
+ * @brief Packet codec of the host library.
+ *
+ * Builds and validates the packets of docs/SIGNALBRIDGE_HOST_LIB_SPEC.md:
+ *
+ * | Byte  | Content                                                 |
+ * |-------|---------------------------------------------------------|
+ * | 0     | Board ID bits 10-3                                      |
+ * | 1     | Board ID bits 2-0 (bits 7-5), command (bits 4-0)        |
+ * | 2     | Payload length (0 to @ref SB_MAX_PAYLOAD)               |
+ * | 3..   | Payload                                                 |
+ * | last  | XOR of every previous byte                              |
+ *
+ * On the wire each packet is COBS encoded and followed by a 0x00 delimiter.
+ * Everything here works on caller-owned buffers and never allocates.
+ */
+
+#ifndef SB_PROTOCOL_H
+#define SB_PROTOCOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Largest payload of a packet. */
+#define SB_MAX_PAYLOAD 20U
+/** Header bytes before the payload. */
+#define SB_HEADER_SIZE 3U
+/** Largest packet before COBS encoding (header, payload, checksum). */
+#define SB_MAX_RAW (SB_HEADER_SIZE + SB_MAX_PAYLOAD + 1U)
+/** Largest COBS encoded packet, without the delimiter. */
+#define SB_MAX_ENCODED (SB_MAX_RAW + 2U)
+/** Largest packet on the wire, delimiter included. */
+#define SB_MAX_WIRE (SB_MAX_ENCODED + 1U)
+/** Packet delimiter. */
+#define SB_DELIMITER 0x00U
+/** Largest 11-bit board ID. */
+#define SB_BOARD_ID_MAX 0x7FFU
+/** Board ID accepting packets from any board. */
+#define SB_BOARD_ANY 0U
+
+/**
+ * @brief Command IDs (5 bits).
+ */
+typedef enum sb_command_t {
+	SB_CMD_PWM = 0x01,          /**< Global PWM duty */
+	SB_CMD_LED_OUT = 0x02,      /**< LED matrix column */
+	SB_CMD_AD = 0x03,           /**< ADC event */
+	SB_CMD_KEY = 0x04,          /**< Keypad event */
+	SB_CMD_ROTARY = 0x06,       /**< Rotary encoder event */
+	SB_CMD_DISPLAY_CTL = 0x0A,  /**< 7-segment display control */
+	SB_CMD_TIMED_OUTPUT = 0x0D, /**< Output commands applied at a device time */
+	SB_CMD_SCENE = 0x0E,        /**< Stored output scenes */
+	SB_CMD_STATE_DELTA = 0x0F,  /**< Report mode select / state delta frame */
+	SB_CMD_ECHO = 0x14,         /**< Echo */
+	SB_CMD_ERROR_STATUS = 0x17, /**< Error counter query */
+	SB_CMD_TASK_STATUS = 0x18,  /**< Task status query */
+	SB_CMD_USB_STATUS = 0x19,   /**< Flush-to-SOF histogram query */
+	SB_CMD_CONFIG = 0x1D,       /**< Configuration profiles */
+	SB_CMD_STATE_DUMP = 0x1F,   /**< Complete input state in one reply */
+	SB_CMD_MAX = 0x1F           /**< Highest defined command ID */
+} sb_command_t;
+
+/**
+ * @brief Outcome of validating a received packet, in checking order.
+ */
+typedef enum sb_status_t {
+	SB_OK = 0,              /**< Valid packet of a known command */
+	SB_ERR_COBS,            /**< Malformed COBS code bytes */
+	SB_ERR_SHORT,           /**< Fewer than header plus checksum bytes */
+	SB_ERR_LENGTH,          /**< Length field disagrees with the packet size */
+	SB_ERR_TOO_LARGE,       /**< Payload longer than @ref SB_MAX_PAYLOAD */
+	SB_ERR_CHECKSUM,        /**< XOR checksum mismatch */
+	SB_ERR_BOARD,           /**< Packet of another board */
+	SB_UNKNOWN_COMMAND      /**< Valid packet, command not in the table; packet filled */
+} sb_status_t;
+
+/**
+ * @brief A validated packet.
+ */
+typedef struct sb_packet_t {
+	uint16_t board_id;               /**< 11-bit board ID */
+	uint8_t command;                 /**< Command ID */
+	uint8_t length;                  /**< Payload bytes */
+	uint8_t payload[SB_MAX_PAYLOAD]; /**< Payload */
+} sb_packet_t;
+
+/**
+ * @brief XOR of a byte range.
+ *
+ * @param[in] data   Bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return Checksum.
+ */
+uint8_t sb_checksum(const uint8_t *data, size_t length);
+
+/**
+ * @brief Decode one COBS frame, rejecting malformed code bytes.
+ *
+ * @param[in]  frame      Encoded bytes, without the delimiter.
+ * @param[in]  length     Number of encoded bytes.
+ * @param[out] raw        Decoded bytes (room for @p length bytes).
+ * @param[out] raw_length Number of decoded bytes.
+ *
+ * @retval true  Decoded.
+ * @retval false A code byte is zero or points past the end of the frame.
+ */
+bool sb_cobs_decode(const uint8_t *frame, size_t length, uint8_t *raw, size_t *raw_length);
+
+/**
+ * @brief Validate a decoded packet (spec section 4, checks 2 to 7).
+ *
+ * @param[in]  raw      Decoded packet.
+ * @param[in]  length   Decoded length.
+ * @param[in]  board_id Expected board, or @ref SB_BOARD_ANY.
+ * @param[out] packet   Packet, filled for @ref SB_OK and @ref SB_UNKNOWN_COMMAND.
+ *
+ * @return Validation outcome.
+ */
+sb_status_t sb_packet_parse(const uint8_t *raw, size_t length, uint16_t board_id, sb_packet_t *packet);
+
+/**
+ * @brief Decode and validate one COBS frame.
+ *
+ * @param[in]  frame    Encoded bytes, without the delimiter.
+ * @param[in]  length   Number of encoded bytes.
+ * @param[in]  board_id Expected board, or @ref SB_BOARD_ANY.
+ * @param[out] packet   Packet, filled for @ref SB_OK and @ref SB_UNKNOWN_COMMAND.
+ *
+ * @return Validation outcome.
+ */
+sb_status_t sb_frame_decode(const uint8_t *frame, size_t length, uint16_t board_id, sb_packet_t *packet);
+
+/**
+ * @brief Build a packet ready for the wire: COBS encoded, delimiter appended.
+ *
+ * @param[in]  board_id Board ID (1 to @ref SB_BOARD_ID_MAX).
+ * @param[in]  command  Command ID.
+ * @param[in]  payload  Payload (may be NULL when @p length is 0).
+ * @param[in]  length   Payload bytes (up to @ref SB_MAX_PAYLOAD).
+ * @param[out] wire     Output (@ref SB_MAX_WIRE bytes).
+ *
+ * @return Bytes written, 0 when a parameter is out of range.
+ */
+size_t sb_packet_encode(uint16_t board_id, uint8_t command, const uint8_t *payload, uint8_t length, uint8_t *wire);
+
+/**
+ * @brief Whether a command ID is one the firmware implements.
+ *
+ * @param[in] command Command ID.
+ *
+ * @retval true  Implemented command.
+ * @retval false Reserved or out of range.
+ */
+bool sb_command_known(uint8_t command);
+
+#endif // SB_PROTOCOL_H
@@ -0,0 +1,213 @@
+/**
+ * @file sb_reader.h
+ * @brief Receive path of the host library: framing, validation and dispatch.
+ *
+ * Bytes read from the serial port go through three stages:
+ * - @ref sb_framer_feed splits the stream on the 0x00 delimiter. A frame
+ *   that lies entirely inside the bytes handed in is passed on in place;
+ *   only a frame split across two reads is copied.
+ * - @ref sb_frame_decode COBS-decodes and validates it.
+ * - @ref sb_dispatch turns the packet into a typed callback. State delta
+ *   frames are expanded into the regular key and ADC callbacks, so the
+ *   application does not depend on the report mode.
+ *
+ * @ref sb_reader_feed runs all three and keeps the counters of spec
+ * section 9. None of it locks or allocates; one reader belongs to one thread.
+ *
+ * After a reconnect, @ref sb_reader_begin_resync asks the board for its
+ * complete input state. Key, ADC, rotary and delta packets are dropped until
+ * every part of the dump has arrived; the application then gets one
+ * on_resync call with the whole state instead of a burst of events.
+ */
+
+#ifndef SB_READER_H
+#define SB_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sb_protocol.h"
+
+/**
+ * @brief Task status response.
+ */
+typedef struct sb_task_status_t {
+	uint8_t index;      /**< Task index (11 = idle task and heap) */
+	uint32_t runtime;   /**< Runtime counter */
+	uint32_t percent;   /**< Runtime percentage */
+	uint32_t watermark; /**< Stack high watermark, or minimum free heap for the idle entry (bytes) */
+} sb_task_status_t;
+
+/** Frames in a state dump reply. */
+#define SB_DUMP_PARTS 4U
+/** Key bytes in a state dump: one bit per matrix position. */
+#define SB_DUMP_KEY_BYTES 8U
+/** Encoders in a state dump. */
+#define SB_DUMP_ENCODERS 8U
+/** ADC channels in a state dump. */
+#define SB_DUMP_AXES 16U
+/** Snapshot flag: the keypad has been scanned since the board started. */
+#define SB_SNAPSHOT_KEYPAD_SCANNED 0x01U
+/** Snapshot flag: the ADC has been scanned since the board started. */
+#define SB_SNAPSHOT_ADC_SCANNED 0x02U
+
+/**
+ * @brief Complete input state of a board, from a state dump.
+ */
+typedef struct sb_input_snapshot_t {
+	uint32_t uptime_ms;                  /**< Board uptime when the dump was taken */
+	uint8_t flags;                       /**< SB_SNAPSHOT_* flags */
+	uint8_t keys[SB_DUMP_KEY_BYTES];     /**< Pressed keys, bit (row * 8 + column) */
+	int16_t encoders[SB_DUMP_ENCODERS];  /**< Detents since the board started (clockwise positive) */
+	uint16_t axes[SB_DUMP_AXES];         /**< 12-bit value per ADC channel */
+} sb_input_snapshot_t;
+
+/**
+ * @brief Application callbacks. Any of them may be NULL.
+ */
+typedef struct sb_callbacks_t {
+	void *context; /**< Passed to every callback */
+	void (*on_key)(void *context, uint16_t board_id, uint8_t column, uint8_t row, bool pressed);
+	void (*on_adc)(void *context, uint16_t board_id, uint8_t channel, uint16_t value);
+	void (*on_rotary)(void *context, uint16_t board_id, uint8_t encoder, bool clockwise);
+	void (*on_echo)(void *context, uint16_t board_id, const uint8_t *payload, uint8_t length);
+	void (*on_error_status)(void *context, uint16_t board_id, uint8_t index, uint32_t value);
+	void (*on_task_status)(void *context, uint16_t board_id, const sb_task_status_t *status);
+	void (*on_raw)(void *context, const sb_packet_t *packet); /**< Every packet without a typed callback */
+	void (*on_resync)(void *context, uint16_t board_id, const sb_input_snapshot_t *snapshot); /**< State dump complete */
+} sb_callbacks_t;
+
+/**
+ * @brief Called by @ref sb_framer_feed for each complete frame.
+ *
+ * @param[in] context User context.
+ * @param[in] frame   Encoded bytes, without the delimiter; valid during the call only.
+ * @param[in] length  Number of encoded bytes.
+ */
+typedef void (*sb_frame_fn)(void *context, const uint8_t *frame, size_t length);
+
+/**
+ * @brief Frame assembler.
+ */
+typedef struct sb_framer_t {
+	uint8_t buffer[SB_MAX_ENCODED]; /**< Start of a frame split across reads */
+	size_t length;                  /**< Bytes in @ref buffer */
+	bool discarding;                /**< Dropping an oversized frame up to its delimiter */
+	uint64_t overflows;             /**< Frames longer than @ref SB_MAX_ENCODED */
+} sb_framer_t;
+
+/**
+ * @brief Receive counters.
+ */
+typedef struct sb_reader_stats_t {
+	uint64_t bytes;            /**< Bytes fed */
+	uint64_t frames;           /**< Non-empty frames */
+	uint64_t packets;          /**< Packets dispatched */
+	uint64_t cobs_errors;      /**< Malformed COBS */
+	uint64_t length_errors;    /**< Short, inconsistent or oversized packets, and oversized frames */
+	uint64_t checksum_errors;  /**< Checksum mismatches */
+	uint64_t board_mismatches; /**< Packets of another board */
+	uint64_t unknown_commands; /**< Packets passed to on_raw for an unknown command */
+	uint64_t malformed;        /**< Known commands with a payload that does not fit the command */
+	uint64_t suppressed;       /**< Input packets dropped while waiting for a state dump */
+} sb_reader_stats_t;
+
+/**
+ * @brief State dump being collected.
+ */
+typedef struct sb_resync_t {
+	bool active;                  /**< Waiting for dump parts; input packets are dropped */
+	uint8_t tag;                  /**< Tag of the request being answered */
+	uint8_t parts;                /**< Bit N set when part N has arrived */
+	sb_input_snapshot_t snapshot; /**< State assembled so far, then the last complete dump */
+} sb_resync_t;
+
+/**
+ * @brief Receive path of one board connection.
+ */
+typedef struct sb_reader_t {
+	sb_framer_t framer;        /**< Frame assembler */
+	uint16_t board_id;         /**< Expected board, or @ref SB_BOARD_ANY */
+	sb_callbacks_t callbacks;  /**< Application callbacks */
+	sb_reader_stats_t stats;   /**< Counters */
+	sb_resync_t resync;        /**< State dump in progress */
+} sb_reader_t;
+
+/**
+ * @brief Start a framer empty.
+ *
+ * @param[out] framer Framer.
+ */
+void sb_framer_reset(sb_framer_t *framer);
+
+/**
+ * @brief Split bytes into frames.
+ *
+ * @param[in,out] framer   Framer.
+ * @param[in]     bytes    Bytes read.
+ * @param[in]     length   Number of bytes.
+ * @param[in]     on_frame Called for each complete, non-empty frame.
+ * @param[in]     context  Passed to @p on_frame.
+ *
+ * @return Number of frames delivered.
+ */
+size_t sb_framer_feed(sb_framer_t *framer, const uint8_t *bytes, size_t length, sb_frame_fn on_frame, void *context);
+
+/**
+ * @brief Call the typed callback of a packet.
+ *
+ * @param[in] packet    Validated packet.
+ * @param[in] callbacks Application callbacks.
+ *
+ * @retval true  Dispatched (possibly to no callback).
+ * @retval false The payload does not fit the command; nothing was called.
+ */
+bool sb_dispatch(const sb_packet_t *packet, const sb_callbacks_t *callbacks);
+
+/**
+ * @brief Start a reader.
+ *
+ * @param[out] reader    Reader.
+ * @param[in]  board_id  Expected board, or @ref SB_BOARD_ANY.
+ * @param[in]  callbacks Application callbacks (copied).
+ */
+void sb_reader_init(sb_reader_t *reader, uint16_t board_id, const sb_callbacks_t *callbacks);
+
+/**
+ * @brief Frame, validate and dispatch bytes read from the serial port.
+ *
+ * @param[in,out] reader Reader.
+ * @param[in]     bytes  Bytes read.
+ * @param[in]     length Number of bytes.
+ *
+ * @return Number of packets dispatched.
+ */
+size_t sb_reader_feed(sb_reader_t *reader, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Start waiting for a state dump and build its request.
+ *
+ * Until all parts tagged @p tag arrive, input packets are dropped; then
+ * on_resync is called once and normal dispatch resumes. Parts of an older
+ * request are ignored, so use a new tag for each request.
+ *
+ * @param[in,out] reader   Reader.
+ * @param[in]     board_id Board to ask (1 to 0x7FF).
+ * @param[in]     tag      Request tag, echoed by every part.
+ * @param[out]    wire     Request frame, ready to write.
+ *
+ * @return Bytes in @p wire.
+ */
+size_t sb_reader_begin_resync(sb_reader_t *reader, uint16_t board_id, uint8_t tag, uint8_t wire[SB_MAX_WIRE]);
+
+/**
+ * @brief Stop waiting for a state dump without calling on_resync.
+ *
+ * For boards that do not answer the request.
+ *
+ * @param[in,out] reader Reader.
+ */
+void sb_reader_cancel_resync(sb_reader_t *reader);
+
+#endif // SB_READER_H
@@ -0,0 +1,142 @@
+/**
+ * @file sb_rt.h
+ * @brief Real-time placement of the host I/O threads and its self-test (Linux).
+ *
+ * A reader thread in the default scheduling class competes with every other
+ * thread of the application. When a simulator's render threads keep all
+ * cores busy, the reader wakes up late and input is delivered with
+ * milliseconds of jitter. Three settings avoid that, each optional:
+ *
+ * - pinning the thread to one CPU, ideally one the render threads avoid;
+ * - SCHED_FIFO, so the reader preempts normal threads as soon as data
+ *   arrives (needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance);
+ * - mlockall(), so a wakeup never waits for a page fault (process-wide;
+ *   needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK).
+ *
+ * Every setting that cannot be applied is reported rather than treated as
+ * fatal. @ref sb_rt_self_test measures the wakeup-to-callback latency of
+ * the reader thread under synthetic load for several settings and picks the
+ * one worth using on this machine.
+ */
+
+#ifndef SB_RT_H
+#define SB_RT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sb_reader.h"
+
+/** Applied: pinned to the requested CPU. */
+#define SB_RT_PINNED 0x01U
+/** Applied: SCHED_FIFO at the requested priority. */
+#define SB_RT_FIFO 0x02U
+/** Applied: all memory locked. */
+#define SB_RT_LOCKED 0x04U
+/** Settings compared by @ref sb_rt_self_test. */
+#define SB_RT_CANDIDATES 4U
+
+/**
+ * @brief Placement of an I/O thread.
+ */
+typedef struct sb_rt_config_t {
+	int cpu;          /**< CPU to pin to, or -1 for any */
+	int priority;     /**< SCHED_FIFO priority (1-99), or 0 for the default class */
+	bool lock_memory; /**< Lock all current and future memory of the process */
+} sb_rt_config_t;
+
+/**
+ * @brief Reader thread: waits for data and runs @ref sb_reader_feed on it.
+ */
+typedef struct sb_reader_thread_t {
+	pthread_t thread;    /**< The thread */
+	int fd;              /**< Board tty (or any readable fd) */
+	sb_reader_t *reader; /**< Reader fed by the thread; owned by it while running */
+	int wake[2];         /**< Pipe that stops the thread */
+	unsigned applied;    /**< SB_RT_* settings in effect */
+	bool ended;          /**< The fd hung up or failed; the thread has returned */
+} sb_reader_thread_t;
+
+/**
+ * @brief Wakeup-to-callback latency distribution.
+ */
+typedef struct sb_latency_t {
+	uint32_t samples; /**< Frames measured */
+	uint32_t min_us;  /**< Shortest latency */
+	uint32_t p50_us;  /**< Median */
+	uint32_t p99_us;  /**< 99th percentile */
+	uint32_t max_us;  /**< Longest latency */
+} sb_latency_t;
+
+/**
+ * @brief Result of @ref sb_rt_self_test.
+ */
+typedef struct sb_rt_report_t {
+	sb_rt_config_t config[SB_RT_CANDIDATES];  /**< Settings tried, default first */
+	unsigned applied[SB_RT_CANDIDATES];       /**< What each actually got */
+	sb_latency_t latency[SB_RT_CANDIDATES];   /**< What each measured */
+	uint32_t recommended;                     /**< Index of the setting to use */
+} sb_rt_report_t;
+
+/**
+ * @brief Apply a placement to the calling thread.
+ *
+ * @param[in] config Placement.
+ *
+ * @return SB_RT_* settings in effect; requested settings missing from it were refused.
+ */
+unsigned sb_rt_apply(const sb_rt_config_t *config);
+
+/**
+ * @brief Start a reader thread with a placement.
+ *
+ * @param[out] thread Thread state.
+ * @param[in]  fd     Readable fd, non-blocking or not.
+ * @param[in]  reader Reader to feed; its callbacks run on the new thread.
+ * @param[in]  config Placement, or NULL for none.
+ *
+ * @retval true  Running; @ref sb_reader_thread_t::applied says what was applied.
+ * @retval false The thread could not be created.
+ */
+bool sb_reader_thread_start(sb_reader_thread_t *thread, int fd, sb_reader_t *reader, const sb_rt_config_t *config);
+
+/**
+ * @brief Stop a reader thread and wait for it.
+ *
+ * @param[in,out] thread Thread state.
+ */
+void sb_reader_thread_stop(sb_reader_thread_t *thread);
+
+/**
+ * @brief Measure the reader thread's latency with one placement.
+ *
+ * A generator writes timestamped echo frames into a pipe at 1 kHz while
+ * @p load_threads threads spin in the default class; a reader thread
+ * placed per @p config measures the time from write to callback.
+ *
+ * @param[in]  config       Placement of the reader thread.
+ * @param[in]  samples      Frames to measure.
+ * @param[in]  load_threads Busy threads to run meanwhile.
+ * @param[out] latency      Distribution.
+ *
+ * @return SB_RT_* settings in effect during the run.
+ */
+unsigned sb_rt_measure(const sb_rt_config_t *config, uint32_t samples, uint32_t load_threads, sb_latency_t *latency);
+
+/**
+ * @brief Compare placements under load and recommend one.
+ *
+ * Tries the default class, pinning, SCHED_FIFO, and SCHED_FIFO with
+ * pinning and locked memory, with one busy thread per online CPU. The
+ * recommendation is the fully applied setting with the lowest 99th
+ * percentile, keeping the default unless another cuts it by at least a
+ * quarter. Memory locking stays in effect for the process if it was granted.
+ *
+ * @param[in]  cpu     CPU for the pinned settings.
+ * @param[in]  samples Frames per setting.
+ * @param[out] report  Results.
+ */
+void sb_rt_self_test(int cpu, uint32_t samples, sb_rt_report_t *report);
+
+#endif // SB_RT_H
@@ -0,0 +1,50 @@
+/**
+ * @file sb_serial.h
+ * @brief Serial port access of the host library (POSIX).
+ *
+ * Boards are found by their USB serial number rather than by device name:
+ * the tty a board gets (ttyACM0, ttyACM1, ...) can change every time it
+ * enumerates, the serial number does not. The lookup reads sysfs and is
+ * Linux only; the other calls work on any POSIX tty.
+ */
+
+#ifndef SB_SERIAL_H
+#define SB_SERIAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Find the tty of the board with a USB serial number.
+ *
+ * Cheap enough to call every few milliseconds while a board is away.
+ *
+ * @param[in]  serial USB serial number (iSerial string).
+ * @param[out] path   Device path, e.g. "/dev/ttyACM0".
+ * @param[in]  size   Size of @p path.
+ *
+ * @retval true  Found; @p path is set.
+ * @retval false No enumerated board has that serial number.
+ */
+bool sb_serial_find(const char *serial, char *path, size_t size);
+
+/**
+ * @brief Open a board's tty for raw, non-blocking I/O and assert DTR and RTS.
+ *
+ * The firmware only sends while the host holds DTR, so this must run on
+ * every reconnect. Pending input from before the open is discarded.
+ *
+ * @param[in] path Device path.
+ *
+ * @return File descriptor, or -1 with errno set.
+ */
+int sb_serial_open(const char *path);
+
+/**
+ * @brief Close a tty opened with @ref sb_serial_open.
+ *
+ * @param[in] fd File descriptor (ignored when negative).
+ */
+void sb_serial_close(int fd);
+
+#endif // SB_SERIAL_H
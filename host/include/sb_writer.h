@@ -0,0 +1,173 @@
+/**
+ * @file sb_writer.h
+ * @brief Coalescing send path of the host library (POSIX).
+ *
+ * Applications tend to send many small frames per simulation step. One
+ * write() per frame costs a syscall and at least one USB transfer each; the
+ * board gains nothing from receiving them apart. A writer instead collects
+ * the encoded frames of one board in its buffer and writes them together:
+ *
+ * - when the oldest buffered frame has waited the deadline,
+ * - when the buffer reaches the size threshold,
+ * - when the caller flushes, for instance at the end of a step.
+ *
+ * Urgent frames skip the wait: they go out at once behind whatever is
+ * buffered, in one writev(), so frames always leave in the order they were
+ * sent. The writer records how long frames waited, so the added latency is
+ * measured rather than assumed.
+ *
+ * Time is passed in by the caller (CLOCK_MONOTONIC microseconds) so the
+ * caller's loop decides when to look. One writer belongs to one thread.
+ */
+
+#ifndef SB_WRITER_H
+#define SB_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sb_protocol.h"
+
+/** Buffer size of one writer. */
+#define SB_WRITER_CAPACITY 1024U
+/** Default wait of the oldest frame before a flush. */
+#define SB_WRITER_DEFAULT_DEADLINE_US 1000U
+/** Default size flush: one full-speed bulk packet. */
+#define SB_WRITER_DEFAULT_THRESHOLD 64U
+/** Bytes per USB packet, for the transfer estimate. */
+#define SB_WRITER_USB_PACKET 64U
+
+/**
+ * @brief Flush policy.
+ */
+typedef struct sb_writer_config_t {
+	uint32_t deadline_us; /**< Longest wait of a buffered frame; 0 writes every frame at once */
+	size_t threshold;     /**< Buffered bytes that trigger a write (at most @ref SB_WRITER_CAPACITY) */
+} sb_writer_config_t;
+
+/**
+ * @brief Writer counters.
+ */
+typedef struct sb_writer_stats_t {
+	uint64_t frames;           /**< Frames sent */
+	uint64_t urgent;           /**< Of which urgent */
+	uint64_t bytes;            /**< Bytes written */
+	uint64_t writes;           /**< write()/writev() calls that wrote data */
+	uint64_t usb_packets;      /**< USB packets needed, counted per write */
+	uint64_t deadline_flushes; /**< Writes triggered by the deadline */
+	uint64_t size_flushes;     /**< Writes triggered by the threshold or a full buffer */
+	uint64_t errors;           /**< Failed writes */
+	uint64_t wait_total_us;    /**< Sum over frames of the time spent buffered */
+	uint32_t wait_max_us;      /**< Longest time a frame spent buffered */
+} sb_writer_stats_t;
+
+/**
+ * @brief Send path of one board.
+ */
+typedef struct sb_writer_t {
+	int fd;                              /**< Board tty, or -1 */
+	uint16_t board_id;                   /**< Board the frames are addressed to */
+	sb_writer_config_t config;           /**< Flush policy */
+	uint8_t buffer[SB_WRITER_CAPACITY];  /**< Frames not yet written */
+	size_t length;                       /**< Bytes in @ref buffer */
+	uint32_t frames;                     /**< Frames in @ref buffer */
+	uint64_t oldest_us;                  /**< When the first buffered frame was sent */
+	uint64_t sent_sum_us;                /**< Sum of the send times of the buffered frames */
+	sb_writer_stats_t stats;             /**< Counters */
+} sb_writer_t;
+
+/**
+ * @brief Start a writer.
+ *
+ * @param[out] writer   Writer.
+ * @param[in]  fd       Board tty (may be -1 until connected).
+ * @param[in]  board_id Board ID (1 to 0x7FF).
+ * @param[in]  config   Flush policy, or NULL for the defaults.
+ */
+void sb_writer_init(sb_writer_t *writer, int fd, uint16_t board_id, const sb_writer_config_t *config);
+
+/**
+ * @brief Point the writer at a new tty and drop what was buffered.
+ *
+ * @param[in,out] writer Writer.
+ * @param[in]     fd     Board tty, or -1.
+ */
+void sb_writer_attach(sb_writer_t *writer, int fd);
+
+/**
+ * @brief Queue one packet.
+ *
+ * @param[in,out] writer  Writer.
+ * @param[in]     command Command ID.
+ * @param[in]     payload Payload (may be NULL when @p length is 0).
+ * @param[in]     length  Payload length (at most @ref SB_MAX_PAYLOAD).
+ * @param[in]     now_us  Current time.
+ *
+ * @retval true  Queued (and possibly written).
+ * @retval false A write failed; the buffer was dropped.
+ */
+bool sb_writer_send(sb_writer_t *writer, uint8_t command, const uint8_t *payload, uint8_t length, uint64_t now_us);
+
+/**
+ * @brief Write one packet now, behind everything already queued.
+ *
+ * @param[in,out] writer  Writer.
+ * @param[in]     command Command ID.
+ * @param[in]     payload Payload (may be NULL when @p length is 0).
+ * @param[in]     length  Payload length (at most @ref SB_MAX_PAYLOAD).
+ * @param[in]     now_us  Current time.
+ *
+ * @retval true  Written.
+ * @retval false The write failed; the buffer was dropped.
+ */
+bool sb_writer_send_urgent(sb_writer_t *writer, uint8_t command, const uint8_t *payload, uint8_t length, uint64_t now_us);
+
+/**
+ * @brief Queue frames that are already encoded, e.g. from @ref sb_outputs_flush.
+ *
+ * @param[in,out] writer Writer.
+ * @param[in]     wire   Whole frames, delimiters included.
+ * @param[in]     length Bytes in @p wire.
+ * @param[in]     frames Frames in @p wire.
+ * @param[in]     now_us Current time.
+ *
+ * @retval true  Queued (and possibly written).
+ * @retval false A write failed; the buffer was dropped.
+ */
+bool sb_writer_append(sb_writer_t *writer, const uint8_t *wire, size_t length, uint32_t frames, uint64_t now_us);
+
+/**
+ * @brief Write the buffer if its oldest frame has waited the deadline.
+ *
+ * @param[in,out] writer Writer.
+ * @param[in]     now_us Current time.
+ *
+ * @retval true  Nothing due, or written.
+ * @retval false The write failed; the buffer was dropped.
+ */
+bool sb_writer_poll(sb_writer_t *writer, uint64_t now_us);
+
+/**
+ * @brief Write the buffer now.
+ *
+ * @param[in,out] writer Writer.
+ * @param[in]     now_us Current time.
+ *
+ * @retval true  Empty, or written.
+ * @retval false The write failed; the buffer was dropped.
+ */
+bool sb_writer_flush(sb_writer_t *writer, uint64_t now_us);
+
+/**
+ * @brief Time until the buffer is due, for the caller's poll() timeout.
+ *
+ * @param[in] writer Writer.
+ * @param[in] now_us Current time.
+ *
+ * @return Microseconds until @ref sb_writer_poll writes (0 = due now),
+ *         or UINT32_MAX when the buffer is empty.
+ */
+uint32_t sb_writer_due_in(const sb_writer_t *writer, uint64_t now_us);
+
+#endif // SB_WRITER_H
@@ -0,0 +1,273 @@
+/**
+ * @file sb_link.c
+ * @brief Connection of one board: reconnect, resynchronise, replay (POSIX).
+ */
+
+#include "sb_link.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sb_serial.h"
+
+/** Bytes read per read() call. */
+#define SB_LINK_READ_SIZE 512U
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+static void lose(sb_link_t *link, uint64_t now)
+{
+	sb_link_close(link);
+	link->lost_ms = now / 1000U;
+	link->found_ms = 0U;
+	link->stats.disconnects++;
+}
+
+/**
+ * @brief Account for a writer call: on success, what it wrote is on the board.
+ *
+ * @return @p written.
+ */
+static bool settle(sb_link_t *link, bool written, uint64_t now)
+{
+	if (!written)
+	{
+		lose(link, now);
+	}
+	else if (0U == link->writer.length)
+	{
+		link->written = link->outputs.sent;
+	}
+	else
+	{
+		// Still buffered
+	}
+
+	return written;
+}
+
+/**
+ * @brief Queue the outputs that differ from the board.
+ */
+static bool queue_outputs(sb_link_t *link, uint64_t now)
+{
+	uint8_t wire[SB_OUTPUT_MAX_CHANGES * SB_MAX_WIRE];
+	sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES];
+	const size_t count = sb_outputs_diff(&link->outputs, changes);
+	const size_t length = sb_outputs_encode(&link->outputs, changes, count, wire, sizeof(wire), NULL);
+
+	return sb_writer_append(&link->writer, wire, length, (uint32_t)count, now);
+}
+
+/**
+ * @brief Open the board's tty and ask for its state.
+ */
+static void try_open(sb_link_t *link, uint64_t now)
+{
+	const uint64_t now_ms = now / 1000U;
+	char path[64];
+
+	if ((now_ms >= link->retry_ms) && sb_serial_find(link->serial, path, sizeof(path)))
+	{
+		if (0U == link->found_ms)
+		{
+			link->found_ms = now_ms;
+		}
+
+		link->fd = sb_serial_open(path);
+		if (link->fd < 0)
+		{
+			// Typically udev has not yet set the permissions
+			link->retry_ms = now_ms + link->backoff_ms;
+			link->backoff_ms = (link->backoff_ms >= (SB_LINK_BACKOFF_MAX_MS / 2U)) ? SB_LINK_BACKOFF_MAX_MS
+			                                                                       : (link->backoff_ms * 2U);
+		}
+		else
+		{
+			uint8_t request[SB_MAX_WIRE];
+			size_t length;
+
+			link->backoff_ms = SB_LINK_BACKOFF_MIN_MS;
+			link->opened_ms = now_ms;
+			link->stats.connects++;
+			sb_framer_reset(&link->reader.framer);
+			sb_writer_attach(&link->writer, link->fd);
+			link->tag++;
+			length = sb_reader_begin_resync(&link->reader, link->board_id, link->tag, request);
+			link->state = SB_LINK_RESYNCING;
+			(void)settle(link, sb_writer_append(&link->writer, request, length, 1U, now) &&
+			                   sb_writer_flush(&link->writer, now), now);
+		}
+	}
+}
+
+/**
+ * @brief Bring the board's outputs in line once its state is known.
+ */
+static void replay(sb_link_t *link, uint64_t now, bool dumped)
+{
+	const bool reset = !dumped || !link->ever_connected ||
+	                   sb_link_board_reset(link->reader.resync.snapshot.uptime_ms, (now / 1000U) - link->lost_ms);
+
+	if (reset)
+	{
+		sb_outputs_forget(&link->outputs);
+		if (link->ever_connected)
+		{
+			link->stats.board_resets++;
+		}
+	}
+
+	link->state = SB_LINK_CONNECTED;
+	link->ever_connected = true;
+
+	// Everything in one write, without waiting for the deadline
+	if (settle(link, queue_outputs(link, now) && sb_writer_flush(&link->writer, now), now))
+	{
+		link->stats.resync_ms = (uint32_t)((now_us() / 1000U) - link->found_ms);
+	}
+}
+
+/**
+ * @brief Read and dispatch everything available.
+ *
+ * @retval false The board went away.
+ */
+static bool read_available(sb_link_t *link)
+{
+	uint8_t bytes[SB_LINK_READ_SIZE];
+	bool more = true;
+	bool result = true;
+
+	while (more)
+	{
+		const ssize_t got = read(link->fd, bytes, sizeof(bytes));
+
+		if (got > 0)
+		{
+			(void)sb_reader_feed(&link->reader, bytes, (size_t)got);
+		}
+		else if ((got < 0) && (EINTR == errno))
+		{
+			// Retry
+		}
+		else
+		{
+			// Nothing left (EAGAIN), or hung up: end of file, EIO or ENXIO
+			result = (got < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno));
+			more = false;
+		}
+	}
+
+	return result;
+}
+
+bool sb_link_init(sb_link_t *link, const char *serial, uint16_t board_id, const sb_callbacks_t *callbacks,
+                  const sb_writer_config_t *config)
+{
+	const size_t length = strlen(serial);
+	bool result = length < SB_LINK_SERIAL_MAX;
+
+	(void)memset(link, 0, sizeof(*link));
+	link->fd = -1;
+	link->board_id = board_id;
+	link->backoff_ms = SB_LINK_BACKOFF_MIN_MS;
+	if (result)
+	{
+		(void)memcpy(link->serial, serial, length + 1U); // flawfinder: ignore
+	}
+	sb_reader_init(&link->reader, board_id, callbacks);
+	sb_outputs_init(&link->outputs, board_id);
+	sb_writer_init(&link->writer, -1, board_id, config);
+	link->written = link->outputs.sent;
+
+	return result;
+}
+
+sb_link_state_t sb_link_poll(sb_link_t *link)
+{
+	const uint64_t now = now_us();
+
+	if (SB_LINK_DISCONNECTED == link->state)
+	{
+		try_open(link, now);
+	}
+
+	if ((SB_LINK_DISCONNECTED != link->state) && !read_available(link))
+	{
+		lose(link, now);
+	}
+
+	if (SB_LINK_RESYNCING == link->state)
+	{
+		if (!link->reader.resync.active)
+		{
+			replay(link, now, true);
+		}
+		else if (((now / 1000U) - link->opened_ms) >= SB_LINK_DUMP_TIMEOUT_MS)
+		{
+			// Firmware without the state dump: assume the worst
+			sb_reader_cancel_resync(&link->reader);
+			link->stats.dump_timeouts++;
+			replay(link, now, false);
+		}
+		else
+		{
+			// Keep waiting
+		}
+	}
+	else if (SB_LINK_CONNECTED == link->state)
+	{
+		(void)settle(link, sb_writer_poll(&link->writer, now), now);
+	}
+	else
+	{
+		// Disconnected
+	}
+
+	return (sb_link_state_t)link->state;
+}
+
+bool sb_link_flush(sb_link_t *link, bool urgent)
+{
+	const uint64_t now = now_us();
+	bool result = SB_LINK_CONNECTED == link->state;
+
+	if (result)
+	{
+		bool written = queue_outputs(link, now);
+		if (written && urgent)
+		{
+			written = sb_writer_flush(&link->writer, now);
+		}
+		result = settle(link, written, now);
+	}
+
+	return result;
+}
+
+void sb_link_close(sb_link_t *link)
+{
+	sb_serial_close(link->fd);
+	link->fd = -1;
+	link->state = SB_LINK_DISCONNECTED;
+	sb_reader_cancel_resync(&link->reader);
+	sb_writer_attach(&link->writer, -1);
+	// Frames still buffered never left; send them again next time
+	link->outputs.sent = link->written;
+}
+
+bool sb_link_board_reset(uint32_t uptime_ms, uint64_t offline_ms)
+{
+	// A board that kept running has been up at least as long as it was away
+	return (uint64_t)uptime_ms < (offline_ms + SB_LINK_RESET_SLACK_MS);
+}
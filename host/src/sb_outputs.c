@@ -0,0 +1,255 @@
+/**
+ * @file sb_outputs.c
+ * @brief Output state cache of the host library.
+ */
+
+#include "sb_outputs.h"
+
+#include <string.h>
+
+#include "sb_protocol.h"
+
+/** Display control sub-command: set digits. */
+#define SB_DISPLAY_SET_DIGITS 0x00U
+/** Display control sub-command: set brightness. */
+#define SB_DISPLAY_SET_BRIGHTNESS 0x01U
+
+static void reset_state(sb_output_state_t *state)
+{
+	(void)memset(state, 0, sizeof(*state));
+	(void)memset(state->brightness, SB_DEFAULT_BRIGHTNESS, sizeof(state->brightness));
+}
+
+/**
+ * @brief Build the payload of one change.
+ *
+ * @return Command ID.
+ */
+static uint8_t change_payload(const sb_output_state_t *state, const sb_output_change_t *change,
+                              uint8_t payload[SB_MAX_PAYLOAD], uint8_t *length)
+{
+	const uint8_t controller_id = (uint8_t)(change->controller + 1U);
+	uint8_t command = SB_CMD_PWM;
+
+	switch (change->kind)
+	{
+	case SB_OUTPUT_LED:
+		payload[0] = controller_id;
+		payload[1] = change->column;
+		payload[2] = state->led[change->controller][change->column];
+		*length = 3U;
+		command = SB_CMD_LED_OUT;
+		break;
+	case SB_OUTPUT_DIGITS:
+		payload[0] = (uint8_t)((controller_id << 5) | SB_DISPLAY_SET_DIGITS);
+		(void)memcpy(&payload[1], state->digits[change->controller], SB_DIGITS_BYTES); // flawfinder: ignore
+		*length = 1U + SB_DIGITS_BYTES;
+		command = SB_CMD_DISPLAY_CTL;
+		break;
+	case SB_OUTPUT_BRIGHTNESS:
+		payload[0] = (uint8_t)((controller_id << 5) | SB_DISPLAY_SET_BRIGHTNESS);
+		payload[1] = state->brightness[change->controller];
+		*length = 2U;
+		command = SB_CMD_DISPLAY_CTL;
+		break;
+	default:
+		payload[0] = state->pwm;
+		*length = 1U;
+		break;
+	}
+
+	return command;
+}
+
+/**
+ * @brief Record one change as sent.
+ */
+static void mark_sent(sb_outputs_t *outputs, const sb_output_change_t *change)
+{
+	const uint8_t c = change->controller;
+
+	switch (change->kind)
+	{
+	case SB_OUTPUT_LED:
+		outputs->sent.led[c][change->column] = outputs->wanted.led[c][change->column];
+		break;
+	case SB_OUTPUT_DIGITS:
+		(void)memcpy(outputs->sent.digits[c], outputs->wanted.digits[c], SB_DIGITS_BYTES); // flawfinder: ignore
+		outputs->sent.digits_valid |= (uint8_t)(1U << c);
+		break;
+	case SB_OUTPUT_BRIGHTNESS:
+		outputs->sent.brightness[c] = outputs->wanted.brightness[c];
+		break;
+	default:
+		outputs->sent.pwm = outputs->wanted.pwm;
+		break;
+	}
+}
+
+void sb_outputs_init(sb_outputs_t *outputs, uint16_t board_id)
+{
+	outputs->board_id = board_id;
+	reset_state(&outputs->wanted);
+	reset_state(&outputs->sent);
+}
+
+void sb_outputs_forget(sb_outputs_t *outputs)
+{
+	reset_state(&outputs->sent);
+}
+
+void sb_outputs_set_pwm(sb_outputs_t *outputs, uint8_t duty)
+{
+	outputs->wanted.pwm = duty;
+}
+
+bool sb_outputs_set_led(sb_outputs_t *outputs, uint8_t controller, uint8_t column, uint8_t mask)
+{
+	bool result = false;
+
+	if ((controller >= 1U) && (controller <= SB_CONTROLLERS) && (column < SB_LED_COLUMNS))
+	{
+		outputs->wanted.led[controller - 1U][column] = mask;
+		result = true;
+	}
+
+	return result;
+}
+
+bool sb_outputs_set_digits(sb_outputs_t *outputs, uint8_t controller, const uint8_t digits[SB_DIGITS], uint8_t dot)
+{
+	bool result = (controller >= 1U) && (controller <= SB_CONTROLLERS) && ((dot < SB_DIGITS) || (SB_NO_DOT == dot));
+
+	for (uint8_t i = 0U; result && (i < SB_DIGITS); i++)
+	{
+		result = digits[i] <= 0x0FU;
+	}
+
+	if (result)
+	{
+		uint8_t *packed = outputs->wanted.digits[controller - 1U];
+		for (uint8_t i = 0U; i < (SB_DIGITS / 2U); i++)
+		{
+			packed[i] = (uint8_t)((digits[2U * i] << 4) | digits[(2U * i) + 1U]);
+		}
+		packed[SB_DIGITS / 2U] = dot;
+		outputs->wanted.digits_valid |= (uint8_t)(1U << (controller - 1U));
+	}
+
+	return result;
+}
+
+bool sb_outputs_set_brightness(sb_outputs_t *outputs, uint8_t controller, uint8_t brightness)
+{
+	bool result = false;
+
+	if ((controller >= 1U) && (controller <= SB_CONTROLLERS) && (brightness <= 7U))
+	{
+		outputs->wanted.brightness[controller - 1U] = brightness;
+		result = true;
+	}
+
+	return result;
+}
+
+size_t sb_outputs_diff(const sb_outputs_t *outputs, sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES])
+{
+	const sb_output_state_t *wanted = &outputs->wanted;
+	const sb_output_state_t *sent = &outputs->sent;
+	size_t count = 0U;
+
+	if (wanted->pwm != sent->pwm)
+	{
+		changes[count] = (sb_output_change_t){ .kind = SB_OUTPUT_PWM, .controller = 0U, .column = 0U };
+		count++;
+	}
+
+	for (uint8_t c = 0U; c < SB_CONTROLLERS; c++)
+	{
+		uint64_t want_row;
+		uint64_t sent_row;
+
+		// One compare per matrix; most frames touch a few columns of a few matrices
+		(void)memcpy(&want_row, wanted->led[c], sizeof(want_row)); // flawfinder: ignore
+		(void)memcpy(&sent_row, sent->led[c], sizeof(sent_row));   // flawfinder: ignore
+		for (uint64_t differ = want_row ^ sent_row; 0U != differ;)
+		{
+			const uint8_t column = (uint8_t)(__builtin_ctzll(differ) / 8U);
+			changes[count] = (sb_output_change_t){ .kind = SB_OUTPUT_LED, .controller = c, .column = column };
+			count++;
+			differ &= ~((uint64_t)0xFFU << (column * 8U));
+		}
+	}
+
+	for (uint8_t c = 0U; c < SB_CONTROLLERS; c++)
+	{
+		const uint8_t bit = (uint8_t)(1U << c);
+
+		if ((0U != (wanted->digits_valid & bit)) &&
+		    ((0U == (sent->digits_valid & bit)) || (0 != memcmp(wanted->digits[c], sent->digits[c], SB_DIGITS_BYTES))))
+		{
+			changes[count] = (sb_output_change_t){ .kind = SB_OUTPUT_DIGITS, .controller = c, .column = 0U };
+			count++;
+		}
+		if (wanted->brightness[c] != sent->brightness[c])
+		{
+			changes[count] = (sb_output_change_t){ .kind = SB_OUTPUT_BRIGHTNESS, .controller = c, .column = 0U };
+			count++;
+		}
+	}
+
+	return count;
+}
+
+size_t sb_outputs_encode(sb_outputs_t *outputs, const sb_output_change_t *changes, size_t count,
+                         uint8_t *wire, size_t size, size_t *encoded)
+{
+	size_t used = 0U;
+	size_t done = 0U;
+	bool fits = true;
+
+	while (fits && (done < count))
+	{
+		uint8_t payload[SB_MAX_PAYLOAD];
+		uint8_t length = 0U;
+		const uint8_t command = change_payload(&outputs->wanted, &changes[done], payload, &length);
+
+		if ((size - used) >= SB_MAX_WIRE)
+		{
+			used += sb_packet_encode(outputs->board_id, command, payload, length, &wire[used]);
+		}
+		else
+		{
+			// Near the end of the buffer: encode aside and copy only if it fits
+			uint8_t frame[SB_MAX_WIRE];
+			const size_t frame_length = sb_packet_encode(outputs->board_id, command, payload, length, frame);
+			fits = frame_length <= (size - used);
+			if (fits)
+			{
+				(void)memcpy(&wire[used], frame, frame_length); // flawfinder: ignore
+				used += frame_length;
+			}
+		}
+
+		if (fits)
+		{
+			mark_sent(outputs, &changes[done]);
+			done++;
+		}
+	}
+
+	if (NULL != encoded)
+	{
+		*encoded = done;
+	}
+
+	return used;
+}
+
+size_t sb_outputs_flush(sb_outputs_t *outputs, uint8_t *wire, size_t size)
+{
+	sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES];
+	const size_t count = sb_outputs_diff(outputs, changes);
+
+	return sb_outputs_encode(outputs, changes, count, wire, size, NULL);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file sb_protocol.c
+ * @brief Packet codec of the host library.
+ */
+
+#include "sb_protocol.h"
+
+#include <string.h>
+
+#include "cobs.h"
+
+/** Bit N set when command N is implemented by the firmware. */
+#define SB_KNOWN_COMMANDS ((1UL << SB_CMD_PWM) | (1UL << SB_CMD_LED_OUT) | (1UL << SB_CMD_AD) | \
+	                   (1UL << SB_CMD_KEY) | (1UL << SB_CMD_ROTARY) | (1UL << SB_CMD_DISPLAY_CTL) | \
+	                   (1UL << SB_CMD_TIMED_OUTPUT) | (1UL << SB_CMD_SCENE) | (1UL << SB_CMD_STATE_DELTA) | \
+	                   (1UL << SB_CMD_ECHO) | (1UL << SB_CMD_ERROR_STATUS) | (1UL << SB_CMD_TASK_STATUS) | \
+	                   (1UL << SB_CMD_USB_STATUS) | (1UL << SB_CMD_CONFIG) | (1UL << SB_CMD_STATE_DUMP))
+
+uint8_t sb_checksum(const uint8_t *data, size_t length)
+{
+	uint32_t folded = 0U;
+	size_t i = 0U;
+
+	// Four bytes per step, folded at the end: XOR does not care about order
+	for (; (i + 4U) <= length; i += 4U)
+	{
+		uint32_t word;
+		(void)memcpy(&word, &data[i], sizeof(word)); // flawfinder: ignore
+		folded ^= word;
+	}
+	folded ^= folded >> 16;
+	folded ^= folded >> 8;
+
+	uint8_t result = (uint8_t)folded;
+	for (; i < length; i++)
+	{
+		result ^= data[i];
+	}
+
+	return result;
+}
+
+bool sb_cobs_decode(const uint8_t *frame, size_t length, uint8_t *raw, size_t *raw_length)
+{
+	bool result = true;
+	size_t in = 0U;
+	size_t out = 0U;
+
+	while (result && (in < length))
+	{
+		const uint8_t code = frame[in];
+		const size_t end = in + (size_t)code;
+
+		if ((0U == code) || (end > length))
+		{
+			result = false;
+		}
+		else
+		{
+			const size_t block = (size_t)code - 1U;
+			(void)memcpy(&raw[out], &frame[in + 1U], block); // flawfinder: ignore
+			out += block;
+			in = end;
+
+			// Every block but the last and the full ones stands for a zero
+			if ((0xFFU != code) && (in < length))
+			{
+				raw[out] = 0U;
+				out++;
+			}
+		}
+	}
+
+	*raw_length = out;
+
+	return result;
+}
+
+sb_status_t sb_packet_parse(const uint8_t *raw, size_t length, uint16_t board_id, sb_packet_t *packet)
+{
+	sb_status_t result = SB_OK;
+
+	if (length < (SB_HEADER_SIZE + 1U))
+	{
+		result = SB_ERR_SHORT;
+	}
+	else if ((size_t)raw[2] != (length - SB_HEADER_SIZE - 1U))
+	{
+		result = SB_ERR_LENGTH;
+	}
+	else if (raw[2] > SB_MAX_PAYLOAD)
+	{
+		result = SB_ERR_TOO_LARGE;
+	}
+	else if (sb_checksum(raw, length - 1U) != raw[length - 1U])
+	{
+		result = SB_ERR_CHECKSUM;
+	}
+	else
+	{
+		const uint16_t source = (uint16_t)(((uint16_t)raw[0] << 3) | ((raw[1] >> 5) & 0x07U));
+
+		if ((SB_BOARD_ANY != board_id) && (source != board_id))
+		{
+			result = SB_ERR_BOARD;
+		}
+		else
+		{
+			packet->board_id = source;
+			packet->command = (uint8_t)(raw[1] & 0x1FU);
+			packet->length = raw[2];
+			(void)memcpy(packet->payload, &raw[SB_HEADER_SIZE], raw[2]); // flawfinder: ignore
+
+			if (!sb_command_known(packet->command))
+			{
+				result = SB_UNKNOWN_COMMAND;
+			}
+		}
+	}
+
+	return result;
+}
+
+sb_status_t sb_frame_decode(const uint8_t *frame, size_t length, uint16_t board_id, sb_packet_t *packet)
+{
+	sb_status_t result = SB_ERR_COBS;
+	uint8_t raw[SB_MAX_ENCODED];
+	size_t raw_length = 0U;
+
+	// A decoded frame is never longer than the encoded one
+	if ((length <= sizeof(raw)) && sb_cobs_decode(frame, length, raw, &raw_length))
+	{
+		result = sb_packet_parse(raw, raw_length, board_id, packet);
+	}
+
+	return result;
+}
+
+size_t sb_packet_encode(uint16_t board_id, uint8_t command, const uint8_t *payload, uint8_t length, uint8_t *wire)
+{
+	size_t result = 0U;
+
+	if ((board_id >= 1U) && (board_id <= SB_BOARD_ID_MAX) && (command <= 0x1FU) && (length <= SB_MAX_PAYLOAD))
+	{
+		uint8_t raw[SB_MAX_RAW];
+
+		raw[0] = (uint8_t)(board_id >> 3);
+		raw[1] = (uint8_t)(((board_id & 0x07U) << 5) | command);
+		raw[2] = length;
+		if (length > 0U)
+		{
+			(void)memcpy(&raw[SB_HEADER_SIZE], payload, length); // flawfinder: ignore
+		}
+		raw[SB_HEADER_SIZE + length] = sb_checksum(raw, SB_HEADER_SIZE + (size_t)length);
+
+		result = cobs_encode(raw, SB_HEADER_SIZE + (size_t)length + 1U, wire);
+		wire[result] = SB_DELIMITER;
+		result++;
+	}
+
+	return result;
+}
+
+bool sb_command_known(uint8_t command)
+{
+	return (command < 32U) && (0UL != (SB_KNOWN_COMMANDS & (1UL << command)));
+}
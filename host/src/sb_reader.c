@@ -0,0 +1,438 @@
+/**
+ * @file sb_reader.c
+ * @brief Receive path of the host library: framing, validation and dispatch.
+ */
+
+#include "sb_reader.h"
+
+#include <string.h>
+
+/** Section byte of a key delta frame. */
+#define SB_DELTA_KEYS 0x00U
+/** Section byte of an axis delta frame. */
+#define SB_DELTA_AXES 0x01U
+/** Task status payload of an index beyond the task table. */
+#define SB_TASK_STATUS_NONE 0xFFU
+/** Axes in the first axis part of a state dump. */
+#define SB_DUMP_AXES_FIRST 10U
+/** Every part of a state dump received. */
+#define SB_DUMP_COMPLETE ((uint8_t)((1U << SB_DUMP_PARTS) - 1U))
+
+static uint32_t read_be32(const uint8_t *bytes)
+{
+	return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+static bool dispatch_delta_keys(const sb_packet_t *packet, const sb_callbacks_t *callbacks)
+{
+	const uint8_t present = packet->payload[1];
+	uint8_t changed[64];
+	uint8_t count = 0U;
+	uint8_t pos = 2U;
+	bool result = true;
+
+	for (uint8_t n = 0U; result && (n < 8U); n++)
+	{
+		if (0U != (present & (1U << n)))
+		{
+			if (pos >= packet->length)
+			{
+				result = false;
+			}
+			else
+			{
+				uint8_t bits = packet->payload[pos];
+				while (0U != bits)
+				{
+					const uint8_t b = (uint8_t)__builtin_ctz(bits);
+					changed[count] = (uint8_t)((n * 8U) + b);
+					count++;
+					bits &= (uint8_t)(bits - 1U);
+				}
+				pos++;
+			}
+		}
+	}
+
+	if (result && ((size_t)pos + (((size_t)count + 7U) / 8U) > packet->length))
+	{
+		result = false;
+	}
+
+	if (result && (NULL != callbacks->on_key))
+	{
+		for (uint8_t i = 0U; i < count; i++)
+		{
+			const bool pressed = 0U != ((packet->payload[pos + (i / 8U)] >> (i % 8U)) & 1U);
+			callbacks->on_key(callbacks->context, packet->board_id, (uint8_t)(changed[i] % 8U), (uint8_t)(changed[i] / 8U), pressed);
+		}
+	}
+
+	return result;
+}
+
+static bool dispatch_delta_axes(const sb_packet_t *packet, const sb_callbacks_t *callbacks)
+{
+	bool result = packet->length >= 3U;
+
+	if (result)
+	{
+		uint16_t mask = (uint16_t)(((uint16_t)packet->payload[1] << 8) | packet->payload[2]);
+		const uint8_t count = (uint8_t)__builtin_popcount(mask);
+
+		// Two values per three bytes, the last odd one in two
+		result = (3U + ((count / 2U) * 3U) + ((count % 2U) * 2U)) <= packet->length;
+
+		for (uint8_t i = 0U; result && (0U != mask) && (NULL != callbacks->on_adc); i++)
+		{
+			const uint8_t channel = (uint8_t)__builtin_ctz(mask);
+			const uint8_t *p = &packet->payload[3U + ((i / 2U) * 3U)];
+			const uint16_t value = (0U == (i % 2U))
+			                       ? (uint16_t)(((uint16_t)p[0] << 4) | (p[1] >> 4))
+			                       : (uint16_t)((((uint16_t)p[1] & 0x0FU) << 8) | p[2]);
+
+			callbacks->on_adc(callbacks->context, packet->board_id, channel, value);
+			mask &= (uint16_t)(mask - 1U);
+		}
+	}
+
+	return result;
+}
+
+static uint16_t unpack_axis(const uint8_t *values, uint8_t index)
+{
+	const uint8_t *p = &values[(index / 2U) * 3U];
+
+	return (0U == (index % 2U)) ? (uint16_t)(((uint16_t)p[0] << 4) | (p[1] >> 4))
+	                            : (uint16_t)((((uint16_t)p[1] & 0x0FU) << 8) | p[2]);
+}
+
+/**
+ * @brief Copy one state dump part into the snapshot.
+ *
+ * @retval true  Part stored (or ignored as stale).
+ * @retval false The payload does not fit its part.
+ */
+static bool collect_dump_part(sb_resync_t *resync, const sb_packet_t *packet)
+{
+	const uint8_t *payload = packet->payload;
+	sb_input_snapshot_t *snapshot = &resync->snapshot;
+	const uint8_t part = (uint8_t)(payload[1] >> 4);
+	bool result = true;
+
+	if (!resync->active || (payload[0] != resync->tag))
+	{
+		// Reply to an older request, or nobody asked
+	}
+	else if ((0U == part) && (packet->length >= (7U + SB_DUMP_KEY_BYTES)))
+	{
+		snapshot->flags = payload[2];
+		snapshot->uptime_ms = read_be32(&payload[3]);
+		(void)memcpy(snapshot->keys, &payload[7], SB_DUMP_KEY_BYTES); // flawfinder: ignore
+	}
+	else if ((1U == part) && (packet->length >= (2U + (2U * SB_DUMP_ENCODERS))))
+	{
+		for (uint8_t i = 0U; i < SB_DUMP_ENCODERS; i++)
+		{
+			snapshot->encoders[i] = (int16_t)(((uint16_t)payload[2U + (2U * i)] << 8) | payload[3U + (2U * i)]);
+		}
+	}
+	else if ((2U == part) && (packet->length >= (2U + ((SB_DUMP_AXES_FIRST / 2U) * 3U))))
+	{
+		for (uint8_t i = 0U; i < SB_DUMP_AXES_FIRST; i++)
+		{
+			snapshot->axes[i] = unpack_axis(&payload[2], i);
+		}
+	}
+	else if ((3U == part) && (packet->length >= (2U + (((SB_DUMP_AXES - SB_DUMP_AXES_FIRST) / 2U) * 3U))))
+	{
+		for (uint8_t i = 0U; i < (SB_DUMP_AXES - SB_DUMP_AXES_FIRST); i++)
+		{
+			snapshot->axes[SB_DUMP_AXES_FIRST + i] = unpack_axis(&payload[2], i);
+		}
+	}
+	else
+	{
+		result = false;
+	}
+
+	if (result && resync->active && (payload[0] == resync->tag))
+	{
+		resync->parts |= (uint8_t)(1U << part);
+	}
+
+	return result;
+}
+
+void sb_framer_reset(sb_framer_t *framer)
+{
+	(void)memset(framer, 0, sizeof(*framer));
+}
+
+size_t sb_framer_feed(sb_framer_t *framer, const uint8_t *bytes, size_t length, sb_frame_fn on_frame, void *context)
+{
+	size_t frames = 0U;
+	size_t pos = 0U;
+
+	while (pos < length)
+	{
+		const uint8_t *marker = (const uint8_t *)memchr(&bytes[pos], SB_DELIMITER, length - pos);
+		const size_t span = (NULL != marker) ? (size_t)(marker - &bytes[pos]) : (length - pos);
+
+		if (framer->discarding)
+		{
+			// Oversized frame: skip to its delimiter
+		}
+		else if ((framer->length + span) > SB_MAX_ENCODED)
+		{
+			framer->discarding = true;
+			framer->length = 0U;
+			framer->overflows++;
+		}
+		else if (NULL == marker)
+		{
+			(void)memcpy(&framer->buffer[framer->length], &bytes[pos], span); // flawfinder: ignore
+			framer->length += span;
+		}
+		else if (0U == framer->length)
+		{
+			// Whole frame in this read: hand it over in place
+			if (span > 0U)
+			{
+				on_frame(context, &bytes[pos], span);
+				frames++;
+			}
+		}
+		else
+		{
+			(void)memcpy(&framer->buffer[framer->length], &bytes[pos], span); // flawfinder: ignore
+			on_frame(context, framer->buffer, framer->length + span);
+			framer->length = 0U;
+			frames++;
+		}
+
+		if (NULL != marker)
+		{
+			framer->discarding = false;
+			pos += span + 1U;
+		}
+		else
+		{
+			pos = length;
+		}
+	}
+
+	return frames;
+}
+
+bool sb_dispatch(const sb_packet_t *packet, const sb_callbacks_t *callbacks)
+{
+	const uint8_t *payload = packet->payload;
+	bool result = true;
+	bool typed = false;
+
+	switch (packet->command)
+	{
+	case SB_CMD_KEY:
+		result = packet->length >= 1U;
+		if (result && (NULL != callbacks->on_key))
+		{
+			callbacks->on_key(callbacks->context, packet->board_id, (uint8_t)((payload[0] >> 4) & 0x0FU),
+			                  (uint8_t)((payload[0] >> 1) & 0x07U), 0U != (payload[0] & 0x01U));
+		}
+		typed = true;
+		break;
+
+	case SB_CMD_AD:
+		result = packet->length >= 3U;
+		if (result && (NULL != callbacks->on_adc))
+		{
+			callbacks->on_adc(callbacks->context, packet->board_id, payload[0],
+			                  (uint16_t)(((uint16_t)payload[1] << 8) | payload[2]));
+		}
+		typed = true;
+		break;
+
+	case SB_CMD_ROTARY:
+		result = packet->length >= 2U;
+		if (result && (NULL != callbacks->on_rotary))
+		{
+			callbacks->on_rotary(callbacks->context, packet->board_id, (uint8_t)((payload[0] >> 4) & 0x0FU), 0U != payload[1]);
+		}
+		typed = true;
+		break;
+
+	case SB_CMD_STATE_DELTA:
+		// A one-byte payload is the mode acknowledgement, not a frame
+		if (packet->length >= 2U)
+		{
+			result = (SB_DELTA_KEYS == payload[0]) ? dispatch_delta_keys(packet, callbacks)
+			         : (SB_DELTA_AXES == payload[0]) ? dispatch_delta_axes(packet, callbacks)
+			         : false;
+			typed = true;
+		}
+		break;
+
+	case SB_CMD_ECHO:
+		if (NULL != callbacks->on_echo)
+		{
+			callbacks->on_echo(callbacks->context, packet->board_id, payload, packet->length);
+		}
+		typed = true;
+		break;
+
+	case SB_CMD_ERROR_STATUS:
+		// One-byte payloads are our own requests looped back; leave them to on_raw
+		if (packet->length >= 5U)
+		{
+			if (NULL != callbacks->on_error_status)
+			{
+				callbacks->on_error_status(callbacks->context, packet->board_id, payload[0], read_be32(&payload[1]));
+			}
+			typed = true;
+		}
+		break;
+
+	case SB_CMD_TASK_STATUS:
+		if ((packet->length >= 13U) && (SB_TASK_STATUS_NONE != payload[0]))
+		{
+			if (NULL != callbacks->on_task_status)
+			{
+				const sb_task_status_t status = {
+					.index = payload[0],
+					.runtime = read_be32(&payload[1]),
+					.percent = read_be32(&payload[5]),
+					.watermark = read_be32(&payload[9]),
+				};
+				callbacks->on_task_status(callbacks->context, packet->board_id, &status);
+			}
+			typed = true;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (!typed && (NULL != callbacks->on_raw))
+	{
+		callbacks->on_raw(callbacks->context, packet);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Handle a state dump packet; report the snapshot once complete.
+ */
+static void resync_frame(sb_reader_t *reader, const sb_packet_t *packet)
+{
+	sb_resync_t *resync = &reader->resync;
+
+	if ((packet->length < 2U) || !collect_dump_part(resync, packet))
+	{
+		reader->stats.malformed++;
+	}
+	else
+	{
+		reader->stats.packets++;
+		if (resync->active && (SB_DUMP_COMPLETE == resync->parts))
+		{
+			resync->active = false;
+			if (NULL != reader->callbacks.on_resync)
+			{
+				reader->callbacks.on_resync(reader->callbacks.context, packet->board_id, &resync->snapshot);
+			}
+		}
+	}
+}
+
+/**
+ * @brief @ref sb_frame_fn of a reader: validate, count and dispatch.
+ */
+static void reader_frame(void *context, const uint8_t *frame, size_t length)
+{
+	sb_reader_t *reader = (sb_reader_t *)context;
+	sb_packet_t packet;
+	const sb_status_t status = sb_frame_decode(frame, length, reader->board_id, &packet);
+
+	reader->stats.frames++;
+
+	switch (status)
+	{
+	case SB_OK:
+	case SB_UNKNOWN_COMMAND:
+		if (SB_UNKNOWN_COMMAND == status)
+		{
+			reader->stats.unknown_commands++;
+		}
+		if (SB_CMD_STATE_DUMP == packet.command)
+		{
+			resync_frame(reader, &packet);
+		}
+		else if (reader->resync.active && ((SB_CMD_KEY == packet.command) || (SB_CMD_AD == packet.command) ||
+		                                   (SB_CMD_ROTARY == packet.command) ||
+		                                   ((SB_CMD_STATE_DELTA == packet.command) && (packet.length >= 2U))))
+		{
+			// The dump will carry the state these events lead to
+			reader->stats.suppressed++;
+		}
+		else if (sb_dispatch(&packet, &reader->callbacks))
+		{
+			reader->stats.packets++;
+		}
+		else
+		{
+			reader->stats.malformed++;
+		}
+		break;
+	case SB_ERR_COBS:
+		reader->stats.cobs_errors++;
+		break;
+	case SB_ERR_CHECKSUM:
+		reader->stats.checksum_errors++;
+		break;
+	case SB_ERR_BOARD:
+		reader->stats.board_mismatches++;
+		break;
+	default:
+		reader->stats.length_errors++;
+		break;
+	}
+}
+
+void sb_reader_init(sb_reader_t *reader, uint16_t board_id, const sb_callbacks_t *callbacks)
+{
+	(void)memset(reader, 0, sizeof(*reader));
+	reader->board_id = board_id;
+	if (NULL != callbacks)
+	{
+		reader->callbacks = *callbacks;
+	}
+}
+
+size_t sb_reader_feed(sb_reader_t *reader, const uint8_t *bytes, size_t length)
+{
+	const uint64_t before = reader->stats.packets;
+	const uint64_t overflows = reader->framer.overflows;
+
+	reader->stats.bytes += length;
+	(void)sb_framer_feed(&reader->framer, bytes, length, reader_frame, reader);
+	reader->stats.length_errors += reader->framer.overflows - overflows;
+
+	return (size_t)(reader->stats.packets - before);
+}
+
+size_t sb_reader_begin_resync(sb_reader_t *reader, uint16_t board_id, uint8_t tag, uint8_t wire[SB_MAX_WIRE])
+{
+	(void)memset(&reader->resync, 0, sizeof(reader->resync));
+	reader->resync.active = true;
+	reader->resync.tag = tag;
+
+	return sb_packet_encode(board_id, SB_CMD_STATE_DUMP, &tag, 1U, wire);
+}
+
+void sb_reader_cancel_resync(sb_reader_t *reader)
+{
+	reader->resync.active = false;
+}
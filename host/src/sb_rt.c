@@ -0,0 +1,335 @@
+/**
+ * @file sb_rt.c
+ * @brief Real-time placement of the host I/O threads and its self-test (Linux).
+ */
+
+#include "sb_rt.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Reader thread buffer. */
+#define SB_RT_READ_SIZE 512U
+/** Interval between self-test frames. */
+#define SB_RT_INTERVAL_NS 1000000L
+/** Priority of the self-test SCHED_FIFO settings: above most audio and desktop threads. */
+#define SB_RT_TEST_PRIORITY 80
+/** A placement must cut the default 99th percentile to this share to be recommended (of 4). */
+#define SB_RT_BETTER_QUARTERS 3U
+
+/**
+ * @brief Latency samples collected by the self-test's echo callback.
+ */
+typedef struct sb_rt_samples_t {
+	uint32_t *latency_us;  /**< One entry per frame */
+	uint32_t capacity;     /**< Entries in @ref latency_us */
+	atomic_uint count;     /**< Entries filled */
+} sb_rt_samples_t;
+
+/**
+ * @brief Busy thread of the self-test.
+ */
+typedef struct sb_rt_load_t {
+	pthread_t thread;     /**< The thread */
+	atomic_bool *stop;    /**< Set to end the spin */
+} sb_rt_load_t;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Apply pinning and scheduling to a thread; memory locking is per process.
+ */
+static unsigned apply_to(pthread_t thread, const sb_rt_config_t *config)
+{
+	unsigned applied = 0U;
+
+	if (config->cpu >= 0)
+	{
+		cpu_set_t set;
+
+		CPU_ZERO(&set);
+		CPU_SET((size_t)config->cpu, &set);
+		if (0 == pthread_setaffinity_np(thread, sizeof(set), &set))
+		{
+			applied |= SB_RT_PINNED;
+		}
+	}
+
+	if (config->priority > 0)
+	{
+		const struct sched_param param = { .sched_priority = config->priority };
+
+		if (0 == pthread_setschedparam(thread, SCHED_FIFO, &param))
+		{
+			applied |= SB_RT_FIFO;
+		}
+	}
+
+	if (config->lock_memory && (0 == mlockall(MCL_CURRENT | MCL_FUTURE)))
+	{
+		applied |= SB_RT_LOCKED;
+	}
+
+	return applied;
+}
+
+static void *reader_main(void *argument)
+{
+	sb_reader_thread_t *thread = (sb_reader_thread_t *)argument;
+	uint8_t bytes[SB_RT_READ_SIZE];
+	bool running = true;
+
+	while (running)
+	{
+		struct pollfd fds[2] = {
+			{ .fd = thread->fd, .events = POLLIN, .revents = 0 },
+			{ .fd = thread->wake[0], .events = POLLIN, .revents = 0 },
+		};
+
+		if (poll(fds, 2U, -1) < 0)
+		{
+			running = EINTR == errno;
+		}
+		else if (0 != fds[1].revents)
+		{
+			running = false;
+		}
+		else if (0 != fds[0].revents)
+		{
+			const ssize_t got = read(thread->fd, bytes, sizeof(bytes));
+
+			if (got > 0)
+			{
+				(void)sb_reader_feed(thread->reader, bytes, (size_t)got);
+			}
+			else if ((got < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)))
+			{
+				// Spurious wakeup
+			}
+			else
+			{
+				// Hung up: the board went away
+				thread->ended = true;
+				running = false;
+			}
+		}
+		else
+		{
+			// Timeout cannot happen
+		}
+	}
+
+	return NULL;
+}
+
+static void *load_main(void *argument)
+{
+	const sb_rt_load_t *load = (const sb_rt_load_t *)argument;
+	volatile uint64_t spin = 0U;
+
+	while (!atomic_load_explicit(load->stop, memory_order_relaxed))
+	{
+		spin = spin + 1U;
+	}
+
+	return NULL;
+}
+
+static void record_echo(void *context, uint16_t board_id, const uint8_t *payload, uint8_t length)
+{
+	sb_rt_samples_t *samples = (sb_rt_samples_t *)context;
+	const uint64_t now = now_ns();
+	uint64_t sent = 0U;
+
+	(void)board_id;
+	if (length >= sizeof(sent))
+	{
+		(void)memcpy(&sent, payload, sizeof(sent)); // flawfinder: ignore
+		const unsigned index = atomic_load_explicit(&samples->count, memory_order_relaxed);
+		if (index < samples->capacity)
+		{
+			samples->latency_us[index] = (uint32_t)((now - sent) / 1000U);
+			atomic_store_explicit(&samples->count, index + 1U, memory_order_release);
+		}
+	}
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+	const uint32_t x = *(const uint32_t *)a;
+	const uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+unsigned sb_rt_apply(const sb_rt_config_t *config)
+{
+	return apply_to(pthread_self(), config);
+}
+
+bool sb_reader_thread_start(sb_reader_thread_t *thread, int fd, sb_reader_t *reader, const sb_rt_config_t *config)
+{
+	bool result = 0 == pipe(thread->wake);
+
+	thread->fd = fd;
+	thread->reader = reader;
+	thread->applied = 0U;
+	thread->ended = false;
+
+	if (result && (0 != pthread_create(&thread->thread, NULL, reader_main, thread)))
+	{
+		(void)close(thread->wake[0]);
+		(void)close(thread->wake[1]);
+		result = false;
+	}
+
+	if (result && (NULL != config))
+	{
+		// Placed from outside so the caller knows the outcome on return
+		thread->applied = apply_to(thread->thread, config);
+	}
+
+	return result;
+}
+
+void sb_reader_thread_stop(sb_reader_thread_t *thread)
+{
+	const uint8_t stop = 1U;
+
+	(void)write(thread->wake[1], &stop, 1U);
+	(void)pthread_join(thread->thread, NULL);
+	(void)close(thread->wake[0]);
+	(void)close(thread->wake[1]);
+}
+
+unsigned sb_rt_measure(const sb_rt_config_t *config, uint32_t samples, uint32_t load_threads, sb_latency_t *latency)
+{
+	sb_rt_samples_t collected = { .latency_us = calloc(samples, sizeof(uint32_t)), .capacity = samples };
+	sb_rt_load_t *loads = calloc(load_threads, sizeof(sb_rt_load_t));
+	atomic_bool stop = false;
+	sb_reader_thread_t thread;
+	sb_reader_t reader;
+	uint32_t started = 0U;
+	unsigned applied = 0U;
+	int fds[2] = { -1, -1 };
+
+	(void)memset(latency, 0, sizeof(*latency));
+	atomic_init(&collected.count, 0U);
+
+	const sb_callbacks_t callbacks = { .context = &collected, .on_echo = record_echo };
+	sb_reader_init(&reader, SB_BOARD_ANY, &callbacks);
+
+	if ((NULL != collected.latency_us) && (NULL != loads) && (0 == pipe(fds)) &&
+	    sb_reader_thread_start(&thread, fds[0], &reader, config))
+	{
+		applied = thread.applied;
+
+		for (uint32_t i = 0U; i < load_threads; i++)
+		{
+			loads[i].stop = &stop;
+			if (0 == pthread_create(&loads[i].thread, NULL, load_main, &loads[i]))
+			{
+				started++;
+			}
+		}
+
+		for (uint32_t n = 0U; n < samples; n++)
+		{
+			const struct timespec interval = { .tv_sec = 0, .tv_nsec = SB_RT_INTERVAL_NS };
+			uint8_t wire[SB_MAX_WIRE];
+			uint8_t payload[sizeof(uint64_t)];
+			const uint64_t sent = now_ns();
+
+			(void)memcpy(payload, &sent, sizeof(sent)); // flawfinder: ignore
+			const size_t length = sb_packet_encode(1U, SB_CMD_ECHO, payload, sizeof(payload), wire);
+			(void)write(fds[1], wire, length);
+			(void)nanosleep(&interval, NULL);
+		}
+
+		// Let the last frame through before stopping
+		for (uint32_t wait = 0U; (wait < 100U) && (atomic_load_explicit(&collected.count, memory_order_acquire) < samples); wait++)
+		{
+			const struct timespec tick = { .tv_sec = 0, .tv_nsec = SB_RT_INTERVAL_NS };
+			(void)nanosleep(&tick, NULL);
+		}
+
+		atomic_store(&stop, true);
+		for (uint32_t i = 0U; i < started; i++)
+		{
+			(void)pthread_join(loads[i].thread, NULL);
+		}
+		sb_reader_thread_stop(&thread);
+
+		const uint32_t count = atomic_load_explicit(&collected.count, memory_order_acquire);
+		if (count > 0U)
+		{
+			qsort(collected.latency_us, count, sizeof(uint32_t), compare_u32);
+			latency->samples = count;
+			latency->min_us = collected.latency_us[0];
+			latency->p50_us = collected.latency_us[count / 2U];
+			latency->p99_us = collected.latency_us[((uint64_t)count * 99U) / 100U];
+			latency->max_us = collected.latency_us[count - 1U];
+		}
+	}
+
+	if (fds[0] >= 0)
+	{
+		(void)close(fds[0]);
+		(void)close(fds[1]);
+	}
+	free(loads);
+	free(collected.latency_us);
+
+	return applied;
+}
+
+void sb_rt_self_test(int cpu, uint32_t samples, sb_rt_report_t *report)
+{
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	const uint32_t load_threads = (cpus > 0) ? (uint32_t)cpus : 1U;
+	const sb_rt_config_t candidates[SB_RT_CANDIDATES] = {
+		{ .cpu = -1, .priority = 0, .lock_memory = false },
+		{ .cpu = cpu, .priority = 0, .lock_memory = false },
+		{ .cpu = -1, .priority = SB_RT_TEST_PRIORITY, .lock_memory = false },
+		{ .cpu = cpu, .priority = SB_RT_TEST_PRIORITY, .lock_memory = true },
+	};
+	const unsigned wanted[SB_RT_CANDIDATES] = { 0U, SB_RT_PINNED, SB_RT_FIFO, SB_RT_PINNED | SB_RT_FIFO | SB_RT_LOCKED };
+
+	(void)memset(report, 0, sizeof(*report));
+	for (uint32_t i = 0U; i < SB_RT_CANDIDATES; i++)
+	{
+		report->config[i] = candidates[i];
+		report->applied[i] = sb_rt_measure(&candidates[i], samples, load_threads, &report->latency[i]);
+	}
+
+	uint32_t best = 0U;
+	for (uint32_t i = 1U; i < SB_RT_CANDIDATES; i++)
+	{
+		const bool complete = (report->applied[i] == wanted[i]) && (report->latency[i].samples == samples);
+		if (complete && (report->latency[i].p99_us < report->latency[best].p99_us))
+		{
+			best = i;
+		}
+	}
+
+	// Only worth the privileges when it clearly helps
+	if ((0U != best) && ((report->latency[best].p99_us * 4U) > (report->latency[0].p99_us * SB_RT_BETTER_QUARTERS)))
+	{
+		best = 0U;
+	}
+	report->recommended = best;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file sb_serial.c
+ * @brief Serial port access of the host library (POSIX).
+ */
+
+#include "sb_serial.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+/** Where Linux lists ttys. */
+#define SB_SYSFS_TTY "/sys/class/tty"
+
+/**
+ * @brief Read the USB serial number of a tty.
+ *
+ * The tty's device link points at the CDC interface; its parent is the USB
+ * device, which holds the serial number.
+ */
+static bool read_usb_serial(const char *tty, char *serial, size_t size)
+{
+	char path[128];
+	bool result = false;
+
+	if (snprintf(path, sizeof(path), SB_SYSFS_TTY "/%s/device/../serial", tty) < (int)sizeof(path))
+	{
+		FILE *file = fopen(path, "r"); // flawfinder: ignore
+		if (NULL != file)
+		{
+			if (NULL != fgets(serial, (int)size, file))
+			{
+				serial[strcspn(serial, "\r\n")] = '\0';
+				result = true;
+			}
+			(void)fclose(file);
+		}
+	}
+
+	return result;
+}
+
+bool sb_serial_find(const char *serial, char *path, size_t size)
+{
+	DIR *dir = opendir(SB_SYSFS_TTY);
+	bool result = false;
+
+	if (NULL != dir)
+	{
+		const struct dirent *entry;
+		while (!result && (NULL != (entry = readdir(dir))))
+		{
+			char found[64];
+
+			if ((0 == strncmp(entry->d_name, "ttyACM", 6U)) &&
+			    read_usb_serial(entry->d_name, found, sizeof(found)) && (0 == strcmp(found, serial)))
+			{
+				result = snprintf(path, size, "/dev/%s", entry->d_name) < (int)size;
+			}
+		}
+		(void)closedir(dir);
+	}
+
+	return result;
+}
+
+int sb_serial_open(const char *path)
+{
+	int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC); // flawfinder: ignore
+
+	if (fd >= 0)
+	{
+		struct termios tio;
+		bool raw = 0 == tcgetattr(fd, &tio);
+
+		if (raw)
+		{
+			cfmakeraw(&tio);
+			tio.c_cflag |= CLOCAL | CREAD;
+			tio.c_cc[VMIN] = 0;
+			tio.c_cc[VTIME] = 0;
+			raw = 0 == tcsetattr(fd, TCSANOW, &tio);
+		}
+		if (!raw)
+		{
+			const int saved = errno;
+			(void)close(fd);
+			errno = saved;
+			fd = -1;
+		}
+	}
+
+	if (fd >= 0)
+	{
+		const int lines = TIOCM_DTR | TIOCM_RTS;
+
+		// Ptys have no modem lines; a real CDC port always accepts this
+		(void)ioctl(fd, TIOCMBIS, &lines);
+		(void)tcflush(fd, TCIFLUSH);
+	}
+
+	return fd;
+}
+
+void sb_serial_close(int fd)
+{
+	if (fd >= 0)
+	{
+		(void)close(fd);
+	}
+}
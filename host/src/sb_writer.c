@@ -0,0 +1,232 @@
+/**
+ * @file sb_writer.c
+ * @brief Coalescing send path of the host library (POSIX).
+ */
+
+#include "sb_writer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/** Longest wait for room in the tty buffer during one write. */
+#define SB_WRITER_WAIT_MS 10
+
+/**
+ * @brief Write every byte of up to two pieces, in order.
+ */
+static bool write_vectors(int fd, struct iovec *iov, int count)
+{
+	bool result = fd >= 0;
+
+	while (result && (count > 0))
+	{
+		const ssize_t written = writev(fd, iov, count);
+
+		if (written >= 0)
+		{
+			size_t left = (size_t)written;
+			while ((count > 0) && (left >= iov[0].iov_len))
+			{
+				left -= iov[0].iov_len;
+				iov++;
+				count--;
+			}
+			if (count > 0)
+			{
+				iov[0].iov_base = (uint8_t *)iov[0].iov_base + left;
+				iov[0].iov_len -= left;
+			}
+		}
+		else if ((EAGAIN == errno) || (EWOULDBLOCK == errno))
+		{
+			struct pollfd pfd = { .fd = fd, .events = POLLOUT, .revents = 0 };
+			result = poll(&pfd, 1U, SB_WRITER_WAIT_MS) > 0;
+		}
+		else
+		{
+			result = EINTR == errno;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * @brief Write the buffer, then @p extra (may be empty), as one writev().
+ */
+static bool write_out(sb_writer_t *writer, const uint8_t *extra, size_t extra_length, uint64_t now_us)
+{
+	struct iovec iov[2];
+	int count = 0;
+	const size_t total = writer->length + extra_length;
+	bool result = true;
+
+	if (writer->length > 0U)
+	{
+		iov[count] = (struct iovec){ .iov_base = writer->buffer, .iov_len = writer->length };
+		count++;
+	}
+	if (extra_length > 0U)
+	{
+		iov[count] = (struct iovec){ .iov_base = (void *)(uintptr_t)extra, .iov_len = extra_length };
+		count++;
+	}
+
+	if (count > 0)
+	{
+		result = write_vectors(writer->fd, iov, count);
+		if (result)
+		{
+			const uint64_t waited = (uint64_t)writer->frames * now_us - writer->sent_sum_us;
+			const uint64_t longest = now_us - writer->oldest_us;
+
+			writer->stats.frames += writer->frames;
+			writer->stats.bytes += total;
+			writer->stats.writes++;
+			writer->stats.usb_packets += (total + SB_WRITER_USB_PACKET - 1U) / SB_WRITER_USB_PACKET;
+			writer->stats.wait_total_us += waited;
+			if ((writer->frames > 0U) && (longest > writer->stats.wait_max_us))
+			{
+				writer->stats.wait_max_us = (uint32_t)longest;
+			}
+		}
+		else
+		{
+			writer->stats.errors++;
+		}
+	}
+
+	writer->length = 0U;
+	writer->frames = 0U;
+	writer->sent_sum_us = 0U;
+
+	return result;
+}
+
+/**
+ * @brief Copy frames into the buffer, writing first when they do not fit.
+ */
+static bool queue(sb_writer_t *writer, const uint8_t *wire, size_t length, uint32_t frames, uint64_t now_us)
+{
+	bool result = true;
+
+	if ((writer->length > 0U) && ((writer->length + length) > sizeof(writer->buffer)))
+	{
+		writer->stats.size_flushes++;
+		result = write_out(writer, NULL, 0U, now_us);
+	}
+
+	if (length > sizeof(writer->buffer))
+	{
+		// Larger than the whole buffer: straight out
+		writer->stats.size_flushes++;
+		result = write_out(writer, wire, length, now_us) && result;
+		writer->stats.frames += frames;
+	}
+	else
+	{
+		if (0U == writer->frames)
+		{
+			writer->oldest_us = now_us;
+		}
+		(void)memcpy(&writer->buffer[writer->length], wire, length); // flawfinder: ignore
+		writer->length += length;
+		writer->frames += frames;
+		writer->sent_sum_us += (uint64_t)frames * now_us;
+
+		if ((writer->length >= writer->config.threshold) || (0U == writer->config.deadline_us))
+		{
+			writer->stats.size_flushes++;
+			result = write_out(writer, NULL, 0U, now_us) && result;
+		}
+	}
+
+	return result;
+}
+
+void sb_writer_init(sb_writer_t *writer, int fd, uint16_t board_id, const sb_writer_config_t *config)
+{
+	(void)memset(writer, 0, sizeof(*writer));
+	writer->fd = fd;
+	writer->board_id = board_id;
+	writer->config.deadline_us = SB_WRITER_DEFAULT_DEADLINE_US;
+	writer->config.threshold = SB_WRITER_DEFAULT_THRESHOLD;
+	if (NULL != config)
+	{
+		writer->config = *config;
+	}
+	if ((0U == writer->config.threshold) || (writer->config.threshold > SB_WRITER_CAPACITY))
+	{
+		writer->config.threshold = SB_WRITER_CAPACITY;
+	}
+}
+
+void sb_writer_attach(sb_writer_t *writer, int fd)
+{
+	writer->fd = fd;
+	writer->length = 0U;
+	writer->frames = 0U;
+	writer->sent_sum_us = 0U;
+}
+
+bool sb_writer_send(sb_writer_t *writer, uint8_t command, const uint8_t *payload, uint8_t length, uint64_t now_us)
+{
+	uint8_t frame[SB_MAX_WIRE];
+	const size_t frame_length = sb_packet_encode(writer->board_id, command, payload, length, frame);
+
+	return queue(writer, frame, frame_length, 1U, now_us);
+}
+
+bool sb_writer_send_urgent(sb_writer_t *writer, uint8_t command, const uint8_t *payload, uint8_t length, uint64_t now_us)
+{
+	uint8_t frame[SB_MAX_WIRE];
+	const size_t frame_length = sb_packet_encode(writer->board_id, command, payload, length, frame);
+	const bool result = write_out(writer, frame, frame_length, now_us);
+
+	if (result)
+	{
+		writer->stats.frames++;
+		writer->stats.urgent++;
+	}
+
+	return result;
+}
+
+bool sb_writer_append(sb_writer_t *writer, const uint8_t *wire, size_t length, uint32_t frames, uint64_t now_us)
+{
+	return (0U == length) || queue(writer, wire, length, frames, now_us);
+}
+
+bool sb_writer_poll(sb_writer_t *writer, uint64_t now_us)
+{
+	bool result = true;
+
+	if ((writer->frames > 0U) && ((now_us - writer->oldest_us) >= writer->config.deadline_us))
+	{
+		writer->stats.deadline_flushes++;
+		result = write_out(writer, NULL, 0U, now_us);
+	}
+
+	return result;
+}
+
+bool sb_writer_flush(sb_writer_t *writer, uint64_t now_us)
+{
+	return write_out(writer, NULL, 0U, now_us);
+}
+
+uint32_t sb_writer_due_in(const sb_writer_t *writer, uint64_t now_us)
+{
+	uint32_t result = UINT32_MAX;
+
+	if (writer->frames > 0U)
+	{
+		const uint64_t waited = now_us - writer->oldest_us;
+		result = (waited >= writer->config.deadline_us) ? 0U : (uint32_t)(writer->config.deadline_us - waited);
+	}
+
+	return result;
+}
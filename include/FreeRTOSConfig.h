@@ -108,7 +108,7 @@ extern uint32_t ulPortGetRunTime( void );
 #define configUSE_CORE_AFFINITY                 1
 #define configTICK_CORE                         0
 #define configRUN_MULTIPLE_PRIORITIES           1
-#define configUSE_PASSIVE_IDLE_HOOK             0
+#define configUSE_PASSIVE_IDLE_HOOK             1
 
 // RP2040 specific
 #define configSUPPORT_PICO_SYNC_INTEROP         1
@@ -124,6 +124,7 @@ extern uint32_t ulPortGetRunTime( void );
 
 // PERFORMANCE TUNING for larger stacks
 #define configUSE_TASK_NOTIFICATIONS            1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2 // index 1 wakes timer wheel owners
 #define configUSE_MUTEXES                       1
 #define configUSE_RECURSIVE_MUTEXES             1
 #define configUSE_COUNTING_SEMAPHORES           1
@@ -153,5 +154,11 @@ extern uint32_t ulPortGetRunTime( void );
 
 // A header file that defines trace macro can be included here.
 
+// Per-core idle time is accounted at every context switch (see idle_work.h)
+#ifndef __ASSEMBLER__
+void app_trace_task_switched_in(void);
+#endif
+#define traceTASK_SWITCHED_IN()                 app_trace_task_switched_in()
+
 #endif // FREERTOS_CONFIG_H
 
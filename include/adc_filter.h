@@ -0,0 +1,39 @@
+/**
+ * @file adc_filter.h
+ * @brief Moving-average filter of the ADC axes.
+ *
+ * Each channel keeps its last @ref ADC_NUM_TAPS oversampled readings and
+ * reports their mean. The first reading of a channel fills the whole window,
+ * so the first value reflects the axis instead of ramping up from zero. Pure
+ * logic: multiplexer selection and sampling live in app_inputs.c.
+ */
+
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+#include <stdint.h>
+
+#include "app_inputs.h"
+
+/**
+ * @brief Forget every reading; the next one of each channel primes its window.
+ *
+ * @param[out] states Filter state.
+ */
+void adc_filter_reset(adc_states_t *states);
+
+/**
+ * @brief Add a reading to a channel's window.
+ *
+ * Priming also sets @ref adc_states_t::adc_previous_value, so a primed
+ * channel is only reported once it moves.
+ *
+ * @param[in,out] states  Filter state.
+ * @param[in]     channel Channel index (below @ref ADC_CHANNELS).
+ * @param[in]     raw     Oversampled reading.
+ *
+ * @return Filtered value.
+ */
+uint16_t adc_filter_update(adc_states_t *states, uint8_t channel, uint16_t raw);
+
+#endif // ADC_FILTER_H
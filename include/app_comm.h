@@ -16,6 +16,48 @@
  */
 #define INVALID_TASK_INDEX 0xFFU
 
+/**
+ * @brief Sentinel value indicating an invalid SOF histogram bucket in a
+ *        USB status response.
+ */
+#define INVALID_SOF_BUCKET 0xFFU
+
+/**
+ * @brief Sentinel value indicating an unknown or missing black box item in a
+ *        debug data response.
+ */
+#define INVALID_BLACK_BOX_ITEM 0xFFU
+
+/**
+ * @enum black_box_section_t
+ * @brief Black box items that the host reads with @ref PC_DEBUG_CMD.
+ */
+typedef enum black_box_section_t {
+	BLACK_BOX_SECTION_SUMMARY = 0, /**< Previous run found, snapshot found, boot count, records */
+	BLACK_BOX_SECTION_TRACE,       /**< One trace record, oldest first */
+	BLACK_BOX_SECTION_QUEUES,      /**< Snapshot time and queue depths */
+	BLACK_BOX_SECTION_HEARTBEAT,   /**< Heartbeat of one task */
+	BLACK_BOX_SECTION_SLACK,       /**< One USB slack histogram bucket */
+} black_box_section_t;
+
+/**
+ * @brief Sentinel value indicating an unknown bus profile item in a bus
+ *        profile response.
+ */
+#define INVALID_BUS_PROFILE_ITEM 0xFFU
+
+/**
+ * @enum bus_profile_section_t
+ * @brief Bus lock profile items that the host reads with @ref PC_DEBUG_CTL1_CMD.
+ */
+typedef enum bus_profile_section_t {
+	BUS_PROFILE_SECTION_SUMMARY = 0, /**< Locks, contended locks and timeouts of one entry */
+	BUS_PROFILE_SECTION_MAXIMA,      /**< Longest wait and hold of one entry */
+	BUS_PROFILE_SECTION_WAIT,        /**< One wait histogram bucket of one entry */
+	BUS_PROFILE_SECTION_HOLD,        /**< One hold histogram bucket of one entry */
+	BUS_PROFILE_SECTION_RESET,       /**< Clear every entry */
+} bus_profile_section_t;
+
 /**
  * @struct cdc_packet_t
  * @brief Holds CDC output queue packets.
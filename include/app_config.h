@@ -93,8 +93,7 @@
  *
  * The TinyUSB @c tud_cdc_rx_cb callback wakes the task as soon as bytes are
  * available.  This timeout provides a fallback so the task still services
- * the FIFO, updates its stack watermark and feeds the watchdog even if a
- * notification is ever missed.
+ * the FIFO and feeds the watchdog even if a notification is ever missed.
  */
 #define UART_EVENT_TASK_WAIT_MS 1000U
 
@@ -104,11 +103,46 @@
  *
  * With @c CFG_TUSB_OS=OPT_OS_FREERTOS, @c tud_task_ext() sleeps on a kernel
  * queue and is woken by the USB IRQ.  The bounded wait ensures the task
- * still pets the watchdog and refreshes its stack watermark when no USB
- * activity is happening.
+ * still pets the watchdog when no USB activity is happening.
  */
 #define CDC_TASK_SAFETY_TIMEOUT_MS 1000U
 
+/**
+ * @brief Upper bound on how long @ref cdc_write_task waits for its flush
+ *        alarm (milliseconds).
+ *
+ * The alarm normally fires in under one USB frame; the bound only matters
+ * if the alarm pool is exhausted or the notification is lost.
+ */
+#define CDC_FLUSH_WAIT_TIMEOUT_MS 2U
+
+/**
+ * @brief Safety timeout used by @ref display_refresh_task while no display
+ *        is animating (milliseconds).
+ *
+ * The frame timer wakes the task only while a slot moves; the bounded wait
+ * keeps its heartbeat going when nothing does.
+ */
+#define DISPLAY_REFRESH_IDLE_WAIT_MS 1000U
+
+/**
+ * @brief Payloads each output bus worker can hold (@ref output_post).
+ */
+#define OUTPUT_BUS_QUEUE_SIZE 16U
+
+/**
+ * @brief Longest wait for room in a full output bus queue (milliseconds).
+ *
+ * Bounds how long a backlogged bus can hold up the decode task.
+ */
+#define OUTPUT_BUS_POST_TIMEOUT_MS 20U
+
+/**
+ * @brief Safety timeout used by the output bus workers while their queue is
+ *        empty (milliseconds).
+ */
+#define OUTPUT_BUS_IDLE_WAIT_MS 1000U
+
 /**
  * @brief Marker indicating the end of a COBS packet.
  */
@@ -125,7 +159,10 @@
  * Communication tasks run above input scanning so that USB CDC traffic is
  * not preempted by keypad / ADC scans during bursts. The TinyUSB device task
  * must stay above the CDC writer to avoid same-priority re-entrancy into the
- * device stack under time slicing.
+ * device stack under time slicing. The display refresh task commits timed
+ * outputs, so it sits above the scan tasks it shares core 1 with. The
+ * output bus workers share the decode task's priority, so queued transfers
+ * and newly decoded frames are time sliced.
  */
 #define mainCDC_TASK_PRIORITY           (tskIDLE_PRIORITY + ( UBaseType_t ) 3U)
 #define mainCDC_WRITE_TASK_PRIORITY     (tskIDLE_PRIORITY + ( UBaseType_t ) 2U)
@@ -135,6 +172,8 @@
 #define mainPROCESS_QUEUE_TASK_PRIORITY (tskIDLE_PRIORITY + ( UBaseType_t ) 1U)
 #define mainADC_TASK_PRIORITY           (tskIDLE_PRIORITY + ( UBaseType_t ) 1U)
 #define mainKEY_TASK_PRIORITY           (tskIDLE_PRIORITY + ( UBaseType_t ) 1U)
+#define mainDISPLAY_REFRESH_TASK_PRIORITY (tskIDLE_PRIORITY + ( UBaseType_t ) 2U)
+#define mainOUTPUT_BUS_TASK_PRIORITY    (tskIDLE_PRIORITY + ( UBaseType_t ) 2U)
 
 /**
  * @brief FreeRTOS stack sizes for the tasks.
@@ -146,6 +185,8 @@
 #define PROCESS_OUTBOUND_STACK_SIZE (3U * configMINIMAL_STACK_SIZE)
 #define ADC_READ_STACK_SIZE         (4U * configMINIMAL_STACK_SIZE)
 #define KEYPAD_STACK_SIZE           (5U * configMINIMAL_STACK_SIZE)
+#define DISPLAY_REFRESH_STACK_SIZE  (2U * configMINIMAL_STACK_SIZE)
+#define OUTPUT_BUS_STACK_SIZE       (3U * configMINIMAL_STACK_SIZE)
 
 /**
  * @brief Task core affinity masks.
@@ -163,6 +204,8 @@
 #define PROCESS_OUTBOUND_TASK_CORE_AFFINITY CORE_1_AFFINITY
 #define ADC_READ_TASK_CORE_AFFINITY         CORE_1_AFFINITY
 #define KEYPAD_TASK_CORE_AFFINITY           CORE_1_AFFINITY
+#define DISPLAY_REFRESH_TASK_CORE_AFFINITY  CORE_1_AFFINITY
+#define OUTPUT_BUS_TASK_CORE_AFFINITY       CORE_1_AFFINITY
 
 /**
  * @enum task_enum_t
@@ -177,6 +220,9 @@ typedef enum task_enum_t {
 	ADC_READ_TASK,         /**< ADC reader task */
 	KEYPAD_TASK,           /**< Keypad polling + rotary encoder task */
 	LED_STATUS_TASK,       /**< System status LED task */
+	DISPLAY_REFRESH_TASK,  /**< Animated display refresh task */
+	OUTPUT_SPI0_TASK,      /**< Output worker for slots on spi0 */
+	OUTPUT_SPI1_TASK,      /**< Output worker for slots on spi1 */
 	NUM_TASKS              /**< Number of tasks in the system */
 } task_enum_t;
 
@@ -20,6 +20,8 @@
 #include "queue.h"
 #include "task.h"
 
+#include "data_event.h"
+
 /**
  * @defgroup input_subsystem Input subsystem
  * @brief Configuration values and task entry points for input scanning.
@@ -43,17 +45,15 @@
 #define KEYPAD_MAX_COLS 8U
 /** Upper bound for the keypad row count accepted by @ref input_init(). */
 #define KEYPAD_MAX_ROWS 8U
-/** Number of consecutive samples used to determine a stable key state. */
+/** Samples of the former sampled debouncer; sets the debounce window (see @ref keypad_matrix_debounce_frames). */
 #define KEYPAD_STABILITY_BITS 3U
-/** Bit-mask composed from @ref KEYPAD_STABILITY_BITS used for debouncing. */
-#define KEYPAD_STABILITY_MASK ((1U << KEYPAD_STABILITY_BITS) - 1U)
 /** GPIO identifier for the keypad column multiplexer bit 0. */
 #define KEYPAD_COL_MUX_A 0U
 /** GPIO identifier for the keypad column multiplexer bit 1. */
 #define KEYPAD_COL_MUX_B 1U
 /** GPIO identifier for the keypad column multiplexer bit 2. */
 #define KEYPAD_COL_MUX_C 2U
-/** Chip-select GPIO for the keypad column multiplexer (active low). */
+/** Chip-select GPIO for the keypad column multiplexer (active high). */
 #define KEYPAD_COL_MUX_CS 17U
 /** GPIO identifier for the keypad row input used for sampling. */
 #define KEYPAD_ROW_INPUT 9U
@@ -65,16 +65,28 @@
 #define KEYPAD_ROW_MUX_C 3U
 /** Chip-select GPIO for the keypad row multiplexer (active low). */
 #define KEYPAD_ROW_MUX_CS 8U
-/** Debounce mask indicating a stable pressed state. */
-#define KEY_PRESSED_MASK 0x03U
-/** Debounce mask indicating a stable released state. */
-#define KEY_RELEASED_MASK 0x04U
 /** Encoded state value for a pressed key. */
 #define KEY_PRESSED 1U
 /** Encoded state value for a released key. */
 #define KEY_RELEASED 0U
 /** @} */
 
+/**
+ * @name Direct inputs
+ * Latency-critical buttons wired to their own GPIOs (active low) instead of
+ * the matrix. Edges are handled in the GPIO interrupt, see @ref direct_input.h.
+ * @{
+ */
+/** Number of direct inputs. */
+#define DIRECT_INPUT_COUNT 2U
+/** GPIO of each direct input (the pins left free by the matrix and SPI fabric). */
+#define DIRECT_INPUT_PINS {4U, 5U}
+/** Keypad column reported for direct inputs (outside the matrix); the row is the input index. */
+#define DIRECT_INPUT_COLUMN 8U
+/** Edges ignored after a reported edge while the contact bounces (µs). */
+#define DIRECT_INPUT_LOCKOUT_US 5000U
+/** @} */
+
 /**
  * @name ADC multiplexer configuration
  * @{
@@ -137,7 +149,7 @@ typedef struct input_config_t
 {
 	uint8_t rows;                             /**< Number of keypad rows to scan. */
 	uint8_t columns;                          /**< Number of keypad columns to scan. */
-	uint16_t key_settling_time_ms;            /**< Scan-cycle interval (ms); debounce window = key_settling_time_ms * required samples. */
+	uint16_t key_settling_time_ms;            /**< Keypad task publish interval (ms); debounce window = key_settling_time_ms * (@ref KEYPAD_STABILITY_BITS - 1). */
 	uint8_t adc_channels;                     /**< Number of ADC channels populated on the board (lower the count to scan only the active axes). */
 	uint16_t adc_settling_us;                 /**< Delay (µs) between ADC mux selection and the first sample. */
 	uint8_t adc_oversample;                   /**< Raw samples averaged per channel per scan (>= 1). */
@@ -146,8 +158,8 @@ typedef struct input_config_t
 	QueueHandle_t input_event_queue;          /**< Destination queue for generated events. */
 	encoder_map_t encoder_map[MAX_NUM_ENCODERS]; /**< Per-encoder position mappings. */
 	uint8_t num_encoders;                     /**< Number of configured encoder entries. */
-	uint16_t col_mux_settling_us;             /**< 74HC138 column decoder propagation settling delay (µs). */
-	uint16_t row_mux_settling_us;             /**< 74HC4051 row MUX enable settling delay (µs). */
+	uint16_t col_mux_settling_us;             /**< 74HC138 column decoder propagation settling delay (µs), before every sample. */
+	uint16_t row_mux_settling_us;             /**< 74HC4051 row MUX select settling delay (µs), added where the scan moves to the next row. */
 	uint16_t adc_channel_mask;                /**< Bitmask of enabled ADC channels: bit N enables channel N. Channels whose bits are clear are skipped during scanning. */
 } input_config_t;
 
@@ -161,6 +173,47 @@ typedef enum input_result_t {
 	INPUT_QUEUE_FULL = 3      /**< Event queue did not accept new data. */
 } input_result_t;
 
+/**
+ * @name Input configuration field identifiers
+ * Used by @ref input_config_set_field() to edit a configuration one scalar at
+ * a time.
+ * @{
+ */
+#define INPUT_FIELD_ROWS                 0x00U /**< @ref input_config_t::rows */
+#define INPUT_FIELD_COLUMNS              0x01U /**< @ref input_config_t::columns */
+#define INPUT_FIELD_KEY_SETTLING_TIME_MS 0x02U /**< @ref input_config_t::key_settling_time_ms */
+#define INPUT_FIELD_ADC_CHANNELS         0x03U /**< @ref input_config_t::adc_channels */
+#define INPUT_FIELD_ADC_SETTLING_US      0x04U /**< @ref input_config_t::adc_settling_us */
+#define INPUT_FIELD_ADC_OVERSAMPLE       0x05U /**< @ref input_config_t::adc_oversample */
+#define INPUT_FIELD_ADC_HYSTERESIS       0x06U /**< @ref input_config_t::adc_hysteresis */
+#define INPUT_FIELD_ADC_SCAN_INTERVAL_MS 0x07U /**< @ref input_config_t::adc_scan_interval_ms */
+#define INPUT_FIELD_NUM_ENCODERS         0x08U /**< @ref input_config_t::num_encoders */
+#define INPUT_FIELD_COL_MUX_SETTLING_US  0x09U /**< @ref input_config_t::col_mux_settling_us */
+#define INPUT_FIELD_ROW_MUX_SETTLING_US  0x0AU /**< @ref input_config_t::row_mux_settling_us */
+#define INPUT_FIELD_ADC_CHANNEL_MASK     0x0BU /**< @ref input_config_t::adc_channel_mask */
+/** @} */
+
+/**
+ * @name Input report modes
+ * Selected with @ref input_set_report_mode().
+ * @{
+ */
+#define INPUT_REPORT_EVENTS 0x00U /**< One frame per key, encoder or axis change. */
+#define INPUT_REPORT_DELTA  0x01U /**< Keys and axes batched into one @ref PC_STATE_DELTA_CMD frame per scan. */
+/** @} */
+
+/**
+ * @brief Input configuration together with the tables derived from it.
+ *
+ * The scan tasks only ever see a prepared profile through a single pointer,
+ * so switching profiles swaps the configuration and its lookup tables at once.
+ */
+typedef struct input_profile_t
+{
+	input_config_t config;                            /**< Scan configuration. */
+	bool encoder_skip[KEYPAD_ROWS][KEYPAD_COLUMNS];   /**< Matrix positions owned by encoders. */
+} input_profile_t;
+
 /**
  * @brief Bookkeeping data for ADC channels.
  */
@@ -170,6 +223,7 @@ typedef struct adc_states_t
 	uint32_t adc_sum_values[ADC_CHANNELS];                /**< Accumulator used by the moving average filter. */
 	uint16_t adc_sample_value[ADC_CHANNELS][ADC_NUM_TAPS];/**< Circular buffer with recent samples. */
 	uint16_t samples_index[ADC_CHANNELS];                 /**< Cursor into @ref adc_sample_value. */
+	bool primed[ADC_CHANNELS];                            /**< Window filled from a first reading. */
 } adc_states_t;
 
 /**
@@ -188,8 +242,8 @@ typedef struct encoder_states_t
  *
  * The function validates the provided configuration and primes the internal
  * state machines.  On success, the calling code can start the keypad and ADC
- * tasks which will make use of the cached settings.  Rotary encoder sampling
- * is performed inline by @ref keypad_task so there is no separate encoder task.
+ * tasks which will make use of the cached settings.  Rotary encoders are
+ * decoded from the keypad scan frames so there is no separate encoder task.
  *
  * @retval INPUT_OK             Configuration accepted and hardware initialised.
  * @retval INPUT_INVALID_CONFIG One or more parameters are outside the
@@ -198,7 +252,13 @@ typedef struct encoder_states_t
 input_result_t input_init(void);
 
 /**
- * @brief FreeRTOS task that scans the keypad matrix and generates key events.
+ * @brief FreeRTOS task that runs the keypad matrix scan.
+ *
+ * Starts the PIO scanner (see keypad_scan.h) on its own core; the scan DMA
+ * interrupt then debounces every frame and queues key and encoder events.
+ * The task loads profile changes into the scanner and, every
+ * @ref input_config_t::key_settling_time_ms, publishes the debounced state
+ * and sends delta frames.
  *
  * @param[in,out] pvParameters Pointer to the owning @ref task_props_t instance.
  */
@@ -211,9 +271,71 @@ void keypad_task(void *pvParameters);
  */
 void adc_read_task(void *pvParameters);
 
+/**
+ * @brief Compile-time default input configuration.
+ *
+ * @return Pointer to the read-only default configuration.
+ */
+const input_config_t *input_default_config(void);
+
+/**
+ * @brief Change one scalar field of an input configuration.
+ *
+ * The configuration is not validated here; run @ref input_prepare_profile()
+ * once all fields are set.
+ *
+ * @param[in,out] config Configuration to edit.
+ * @param[in]     field  Field identifier (INPUT_FIELD_*).
+ * @param[in]     value  New value.
+ *
+ * @retval INPUT_OK             The field was updated.
+ * @retval INPUT_INVALID_CONFIG Unknown field or value wider than the field.
+ */
+input_result_t input_config_set_field(input_config_t *config, uint8_t field, uint16_t value);
+
+/**
+ * @brief Validate a profile configuration and build its derived tables.
+ *
+ * @param[in,out] profile Profile to prepare. Must not be the active profile.
+ *
+ * @retval INPUT_OK             The profile can be activated.
+ * @retval INPUT_INVALID_CONFIG The configuration is out of range.
+ */
+input_result_t input_prepare_profile(input_profile_t *profile);
+
+/**
+ * @brief Make a prepared profile the one used by the scan tasks.
+ *
+ * Only a pointer is swapped. The keypad and ADC tasks latch it at the start
+ * of each scan cycle, so a switch never lands in the middle of a scan and
+ * the per-key debounce state restarts with the new matrix layout.
+ *
+ * @param[in] profile Prepared profile. It must stay valid and unmodified
+ *                    while it is active.
+ *
+ * @retval INPUT_OK             The profile is now active.
+ * @retval INPUT_INVALID_CONFIG @p profile is NULL.
+ */
+input_result_t input_set_active_profile(const input_profile_t *profile);
+
+/**
+ * @brief Check whether a profile may still be read by the scan tasks.
+ *
+ * A profile stays in use after a switch until both tasks have started a scan
+ * with the new one. Profiles in use must not be modified.
+ *
+ * @param[in] profile Profile to check.
+ *
+ * @retval true  The profile is active or latched by a running scan.
+ * @retval false The profile can be edited.
+ */
+bool input_profile_in_use(const input_profile_t *profile);
+
 /**
  * @brief Query whether a keypad matrix position is mapped to an encoder.
  *
+ * The answer reflects the active profile.
+ *
  * @param[in] row Row index to check.
  * @param[in] col Column index to check.
  *
@@ -223,6 +345,55 @@ void adc_read_task(void *pvParameters);
  */
 bool input_is_encoder_position(uint8_t row, uint8_t col);
 
+/**
+ * @brief Select how key and axis changes are reported to the host.
+ *
+ * Each scan task picks up the mode at the start of its next scan. Entering
+ * @ref INPUT_REPORT_DELTA reports every pressed key and every enabled axis
+ * once, so the host starts from the complete state. Encoders always report
+ * one event per detent.
+ *
+ * @param[in] mode @ref INPUT_REPORT_EVENTS or @ref INPUT_REPORT_DELTA.
+ *
+ * @retval INPUT_OK             The mode was selected.
+ * @retval INPUT_INVALID_CONFIG Unknown mode.
+ */
+input_result_t input_set_report_mode(uint8_t mode);
+
+/**
+ * @brief Report mode currently selected.
+ *
+ * @return @ref INPUT_REPORT_EVENTS or @ref INPUT_REPORT_DELTA.
+ */
+uint8_t input_report_mode(void);
+
+/**
+ * @brief Account for a data event handed to the host link.
+ *
+ * Called by the outbound task for every event it dequeues. Direct input
+ * events jump the event queue only while no earlier direct event is still
+ * queued, which keeps each button's press and release in order.
+ *
+ * @param[in] event Event just dequeued.
+ */
+void input_event_dequeued(const data_events_t *event);
+
+/**
+ * @brief Take the raw reading of one ADC channel.
+ *
+ * Routes @p channel through the multiplexer, waits @p settling_us for the
+ * multiplexer output and sample-and-hold capacitor to settle, then averages
+ * @p oversample conversions. This is what @ref adc_read_task does for every
+ * enabled channel before filtering.
+ *
+ * @param[in] channel     Multiplexer channel.
+ * @param[in] settling_us Settling delay (µs).
+ * @param[in] oversample  Conversions averaged; 0 counts as 1.
+ *
+ * @return Mean raw reading.
+ */
+uint16_t adc_sample_channel(uint8_t channel, uint16_t settling_us, uint8_t oversample);
+
 /**
  * @brief Decide whether a new ADC reading is significant enough to emit.
  *
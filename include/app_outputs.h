@@ -18,6 +18,8 @@
 
 #include <hardware/spi.h>
 
+#include "bus_profile.h"
+
 /**
  * @defgroup outputs Outputs subsystem
  * @brief Configuration constants and APIs for driving panel outputs.
@@ -36,6 +38,22 @@
 #define NUM_GPIO 30U
 /** @} */
 
+/**
+ * @name Per-slot bus timing
+ * @{
+ */
+/** Default SPI clock of a slot (kHz), matching @ref SPI_FREQUENCY. */
+#define OUTPUT_TIMING_DEFAULT_SPI_KHZ (SPI_FREQUENCY / 1000U)
+/** Default multiplexer settle time after selecting or releasing a slot (µs). */
+#define OUTPUT_TIMING_DEFAULT_SETTLE_US 1U
+/** Default TM1637 bit-bang half clock period (µs). */
+#define OUTPUT_TIMING_DEFAULT_TM1637_US 3U
+/** Lowest SPI clock a slot can be given (kHz). */
+#define OUTPUT_TIMING_MIN_SPI_KHZ 10U
+/** Highest SPI clock a slot can be given (kHz). */
+#define OUTPUT_TIMING_MAX_SPI_KHZ 4000U
+/** @} */
+
 /**
  * @name Multiplexer GPIO assignments
  * @{
@@ -50,6 +68,41 @@
 #define SPI_MUX_CS 27U
 /** @} */
 
+/**
+ * @name Output SPI buses
+ *
+ * Slots can be split over the two hardware SPI blocks. Each bus has its own
+ * clock and data pins, slot multiplexer, lock and worker task. Host display
+ * and LED payloads are queued to the worker of their slot's bus
+ * (@ref output_post), so a backlog on one bus never holds up updates for the
+ * other. The stock board has no free GPIOs for the second bus: its pins are
+ * left unassigned and every slot sits on spi0.
+ * @{
+ */
+/** Number of hardware SPI buses output slots can be wired to. */
+#define OUTPUT_SPI_BUS_COUNT 2U
+/** Bus index of spi0 (SCK/TX on the Pico default SPI pins, @ref SPI_MUX_A_PIN multiplexer). */
+#define OUTPUT_BUS_SPI0 0U
+/** Bus index of spi1 (SPI1_* pins and multiplexer). */
+#define OUTPUT_BUS_SPI1 1U
+/** Marks a bus pin that is not wired on this board. */
+#define OUTPUT_PIN_NONE 0xFFU
+/** spi1 clock pin (GPIO 10, 14 or 26 when fitted). */
+#define SPI1_SCK_PIN OUTPUT_PIN_NONE
+/** spi1 data pin (GPIO 11, 15 or 27 when fitted). */
+#define SPI1_TX_PIN OUTPUT_PIN_NONE
+/** spi1 multiplexer select bit 0. */
+#define SPI1_MUX_A_PIN OUTPUT_PIN_NONE
+/** spi1 multiplexer select bit 1. */
+#define SPI1_MUX_B_PIN OUTPUT_PIN_NONE
+/** spi1 multiplexer select bit 2. */
+#define SPI1_MUX_C_PIN OUTPUT_PIN_NONE
+/** spi1 multiplexer enable pin (active high). */
+#define SPI1_MUX_CS OUTPUT_PIN_NONE
+/** Longest @ref display_out or @ref led_out payload a bus worker keeps (bytes). */
+#define OUTPUT_BUS_COMMAND_MAX 9U
+/** @} */
+
 /**
  * @name PWM configuration
  * @{
@@ -100,6 +153,24 @@
 #define DISPLAY_CMD_SET_DIGITS 0x00U
 /** Command value for updating brightness (0 = off, 1-7 = on). */
 #define DISPLAY_CMD_SET_BRIGHTNESS 0x01U
+/** Command value for a binary number formatted on the device (see @ref display_format.h). */
+#define DISPLAY_CMD_SET_NUMBER 0x02U
+/** Command value for a target the device rolls the display to (see @ref display_anim.h). */
+#define DISPLAY_CMD_SET_TARGET 0x03U
+/** @} */
+
+/**
+ * @name Output image helpers
+ * @{
+ */
+/** Number of data bytes held per slot image (digits or LED columns). */
+#define OUTPUT_IMAGE_SIZE 8U
+/** Dot position value used by images that do not light a decimal point. */
+#define OUTPUT_NO_DECIMAL_POINT 0xFFU
+/** Digit code for an unlit digit (outside the 4-bit host digit range). */
+#define OUTPUT_DIGIT_BLANK 0x10U
+/** Digit code for a minus sign (outside the 4-bit host digit range). */
+#define OUTPUT_DIGIT_MINUS 0x11U
 /** @} */
 
 /**
@@ -120,6 +191,24 @@
 		DEVICE_NONE  /* Device 7 */ \
 }
 
+/**
+ * @brief Compile-time bus assignment for each controller slot.
+ *
+ * Indexed like @ref DEVICE_CONFIG. A slot's multiplexer output is the slot
+ * index on its bus's multiplexer. Every bus that carries a fitted slot must
+ * have all of its pins assigned.
+ */
+#define OUTPUT_BUS_CONFIG { \
+		OUTPUT_BUS_SPI0, /* Device 0 */ \
+		OUTPUT_BUS_SPI0, /* Device 1 */ \
+		OUTPUT_BUS_SPI0, /* Device 2 */ \
+		OUTPUT_BUS_SPI0, /* Device 3 */ \
+		OUTPUT_BUS_SPI0, /* Device 4 */ \
+		OUTPUT_BUS_SPI0, /* Device 5 */ \
+		OUTPUT_BUS_SPI0, /* Device 6 */ \
+		OUTPUT_BUS_SPI0  /* Device 7 */ \
+}
+
 /**
  * @brief Result codes returned by output helpers.
  */
@@ -128,7 +217,8 @@ typedef enum output_result_t {
 	OUTPUT_ERR_INIT = 1,       /**< Hardware initialisation failed. */
 	OUTPUT_ERR_DISPLAY_OUT = 2,/**< Display or LED driver rejected the payload. */
 	OUTPUT_ERR_INVALID_PARAM = 3, /**< Payload validation failed. */
-	OUTPUT_ERR_SEMAPHORE = 4   /**< Failed to acquire the SPI mutex. */
+	OUTPUT_ERR_SEMAPHORE = 4,  /**< Failed to acquire the SPI mutex. */
+	OUTPUT_ERR_QUEUE_FULL = 5  /**< The bus worker queue stayed full. */
 } output_result_t;
 
 /**
@@ -146,9 +236,11 @@ struct output_driver_t {
 	output_result_t (*set_digits)(output_driver_t *config, const uint8_t *digits, size_t length, uint8_t dot_position); /**< Digit update callback. */
 	output_result_t (*set_leds)(output_driver_t *config, uint8_t leds, uint8_t ledstate); /**< LED update callback. */
 	output_result_t (*set_brightness)(output_driver_t *config, uint8_t brightness); /**< Brightness update callback (0-7). */
+	output_result_t (*set_led_columns)(output_driver_t *config, const uint8_t *columns, size_t count); /**< Bulk LED update callback (single flush). */
 	spi_inst_t *spi; /**< SPI instance used by the device (if applicable). */
 	uint8_t dio_pin; /**< GPIO pin used as DIO for TM1637 bit-banging. */
 	uint8_t clk_pin; /**< GPIO pin used as CLK for TM1637 bit-banging. */
+	uint8_t bit_delay_us; /**< TM1637 half clock period (µs). */
 	uint8_t active_buffer[16]; /**< Snapshot of the last committed frame. */
 	uint8_t prep_buffer[16];   /**< Staging buffer used before flushing to hardware. */
 	bool buffer_modified;      /**< Indicates that @ref prep_buffer needs flushing. */
@@ -163,14 +255,76 @@ typedef struct output_drivers_t {
 	output_driver_t *driver_handles[MAX_SPI_INTERFACES]; /**< Pointer table indexed by chip ID. */
 } output_drivers_t;
 
+/**
+ * @brief Complete output state for one controller slot.
+ *
+ * Digit slots interpret @ref data as unpacked BCD digits, LED slots as one
+ * bitmask per matrix column (same layout as @ref led_out).
+ */
+typedef struct output_slot_image_t {
+	uint8_t data[OUTPUT_IMAGE_SIZE]; /**< BCD digits or LED column masks. */
+	uint8_t dot_position;            /**< Decimal point index or @ref OUTPUT_NO_DECIMAL_POINT. */
+	uint8_t brightness;              /**< Brightness level (0 = off, 1-7 = on). */
+} output_slot_image_t;
+
+/**
+ * @brief Bus timing applied whenever a slot is selected.
+ *
+ * Lets short, clean runs go faster than the defaults and long or noisy
+ * harnesses slower, one slot at a time.
+ */
+typedef struct output_slot_timing_t {
+	uint16_t spi_khz;              /**< SPI clock while the slot is selected (kHz). */
+	uint8_t select_settle_us;      /**< Settle time after the multiplexer switches (µs). */
+	uint8_t tm1637_half_period_us; /**< TM1637 half clock period (µs, at least 1). */
+} output_slot_timing_t;
+
+/**
+ * @brief Output half of a configuration bank, switched as a whole.
+ *
+ * Each bus latches the active bank when its lock is taken, so a transfer
+ * never mixes the slot set of one bank with the timing of another.
+ */
+typedef struct output_bank_t {
+	uint8_t device_map[MAX_SPI_INTERFACES];          /**< Per-slot device type, @ref DEVICE_NONE disables the slot. */
+	output_slot_timing_t timing[MAX_SPI_INTERFACES]; /**< Per-slot SPI clock, settle time and TM1637 half period. */
+} output_bank_t;
+
+/**
+ * @brief Operations that take a bus lock, profiled separately.
+ */
+typedef enum output_bus_op_t {
+	OUTPUT_BUS_OP_DISPLAY, /**< @ref display_out */
+	OUTPUT_BUS_OP_LED,     /**< @ref led_out */
+	OUTPUT_BUS_OP_SCENE,   /**< @ref output_apply_images */
+	OUTPUT_BUS_OP_REFRESH, /**< @ref output_refresh_displays */
+	OUTPUT_BUS_OPS         /**< Number of operations */
+} output_bus_op_t;
+
+/**
+ * @name Bus lock profile entries
+ *
+ * Every lock is counted twice: under the slot it was taken for, or under its
+ * bus when it covers several slots, and under its operation.
+ * @{
+ */
+/** Entry of a whole-bus lock (scenes, refresh). */
+#define OUTPUT_PROFILE_BUS_ENTRY(bus) (MAX_SPI_INTERFACES + (bus))
+/** Entry of an operation (@ref output_bus_op_t). */
+#define OUTPUT_PROFILE_OP_ENTRY(op) (MAX_SPI_INTERFACES + OUTPUT_SPI_BUS_COUNT + (op))
+/** Number of entries: slots, then buses, then operations. */
+#define OUTPUT_PROFILE_ENTRIES (MAX_SPI_INTERFACES + OUTPUT_SPI_BUS_COUNT + OUTPUT_BUS_OPS)
+/** @} */
+
 /** @} */
 
 /**
- * @brief Initialise the SPI bus, PWM slice and driver backends.
+ * @brief Initialise the SPI buses, PWM slice and driver backends.
  *
- * Configures the SPI fabric, routes the multiplexer control GPIOs, initialises
- * the PWM brightness channel and creates the low-level driver instances defined
- * by @ref DEVICE_CONFIG.
+ * Configures every SPI bus that carries a fitted slot, routes its multiplexer
+ * control GPIOs, initialises the PWM brightness channel and creates the
+ * low-level driver instances defined by @ref DEVICE_CONFIG and
+ * @ref OUTPUT_BUS_CONFIG.
  *
  * @retval OUTPUT_OK         The subsystem is ready to accept payloads.
  * @retval OUTPUT_ERR_INIT   At least one hardware block failed to initialise.
@@ -191,6 +345,20 @@ output_result_t output_init(void);
  * When DISPLAY_CMD_SET_BRIGHTNESS is used, Byte 1 holds the brightness level
  * (0 = off, 1-7 = on).
  *
+ * When DISPLAY_CMD_SET_NUMBER is used:
+ * Byte 1: Format descriptor (DISPLAY_FORMAT_* bits)
+ * Byte 2: Digits after the decimal point (0 = none)
+ * Byte 3-6: Value, 1 to 4 bytes big-endian (sign-extended when signed)
+ *
+ * When DISPLAY_CMD_SET_TARGET is used:
+ * Byte 1: Format descriptor (DISPLAY_FORMAT_* bits)
+ * Byte 2: Digits after the decimal point (0 = none)
+ * Byte 3-4: Slew, big-endian: duration in ms, or rate in units per second
+ *           when bit 15 (@ref DISPLAY_ANIM_SLEW_RATE) is set
+ * Byte 5-8: Target, 1 to 4 bytes big-endian (sign-extended when signed)
+ *
+ * Digits written by any other command stop the slot's animation.
+ *
  * @param[in] payload Encoded display payload received from the host.
  * @param[in] length  Number of bytes available in @p payload.
  *
@@ -214,6 +382,164 @@ output_result_t display_out(const uint8_t *payload, uint8_t length);
  */
 output_result_t led_out(const uint8_t *payload, uint8_t length);
 
+/**
+ * @brief Queue a display or LED payload for the worker of its slot's bus.
+ *
+ * Only the slot ID is checked here; the payload is copied and the transfer
+ * runs later in the bus worker (@ref output_spi0_task, @ref output_spi1_task),
+ * which counts a failure in DISPLAY_OUT_ERROR or LED_OUT_ERROR. Payloads for
+ * one bus are applied in the order they were queued.
+ *
+ * @param[in] op      @ref OUTPUT_BUS_OP_DISPLAY for a @ref display_out
+ *                    payload, @ref OUTPUT_BUS_OP_LED for a @ref led_out one.
+ * @param[in] payload Payload as received from the host.
+ * @param[in] length  Number of bytes available in @p payload.
+ *
+ * @retval OUTPUT_OK                The payload is queued.
+ * @retval OUTPUT_ERR_INVALID_PARAM Unsupported @p op, empty payload or slot
+ *                                  ID out of range.
+ * @retval OUTPUT_ERR_QUEUE_FULL    The bus queue stayed full for
+ *                                  @ref OUTPUT_BUS_POST_TIMEOUT_MS, or the bus
+ *                                  was never brought up.
+ */
+output_result_t output_post(output_bus_op_t op, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Apply the next payload queued for a bus with @ref output_post.
+ *
+ * @param[in] bus     Bus index.
+ * @param[in] wait_ms Longest wait for a payload (ms).
+ *
+ * @return `true` when a payload was applied, whatever its result.
+ */
+bool output_bus_service(uint8_t bus, uint32_t wait_ms);
+
+/**
+ * @brief Worker task applying the payloads queued for spi0.
+ *
+ * @param[in,out] pvParameters Pointer to the owning task properties structure.
+ */
+void output_spi0_task(void *pvParameters);
+
+/**
+ * @brief Worker task applying the payloads queued for spi1.
+ *
+ * @param[in,out] pvParameters Pointer to the owning task properties structure.
+ */
+void output_spi1_task(void *pvParameters);
+
+/**
+ * @brief Commit complete images to several controller slots in one bus pass.
+ *
+ * Payloads already queued with @ref output_post are applied first, so a
+ * scene lands after the updates the host sent before it. Each bus lock is taken once for the selected slots on that bus, and
+ * released before the next bus is locked. Each selected slot receives
+ * a single flush of its digits or LED columns; the brightness command is only
+ * sent when it differs from the level already programmed in the driver.
+ * Slots without a driver are skipped and reported through the return value.
+ *
+ * @param[in] images    Array of @ref MAX_SPI_INTERFACES images indexed by
+ *                      physical slot (controller ID - 1).
+ * @param[in] slot_mask Bit @c n selects slot @c n for update.
+ *
+ * @retval OUTPUT_OK            Every selected slot was updated.
+ * @retval OUTPUT_ERR_INVALID_PARAM @p images is NULL.
+ * @retval OUTPUT_ERR_DISPLAY_OUT   At least one slot rejected its image.
+ * @retval OUTPUT_ERR_SEMAPHORE     SPI bus could not be locked.
+ */
+output_result_t output_apply_images(const output_slot_image_t *images, uint8_t slot_mask);
+
+/**
+ * @brief Step every animated display slot by one refresh period.
+ *
+ * Slots started by @ref DISPLAY_CMD_SET_TARGET are advanced and written only
+ * when their digits changed. Buses with no moving slot are not locked. Free
+ * buses are refreshed first, so a long transfer on one bus does not hold up
+ * the animations on the other. A slot whose driver fails stops animating.
+ *
+ * @retval OUTPUT_OK            Every moving slot is up to date.
+ * @retval OUTPUT_ERR_DISPLAY_OUT   At least one slot rejected its digits.
+ * @retval OUTPUT_ERR_SEMAPHORE     A bus was busy for the whole period.
+ */
+output_result_t output_refresh_displays(void);
+
+/**
+ * @brief Task that refreshes animated displays every @ref DISPLAY_ANIM_PERIOD_MS.
+ *
+ * Driven by a timer wheel timer that is armed only while a slot animates.
+ * Also commits the output commands staged for a device time
+ * (@ref output_commit.h) when their alarm fires.
+ *
+ * @param[in,out] pvParameters Pointer to the owning task properties structure.
+ */
+void display_refresh_task(void *pvParameters);
+
+/**
+ * @brief Switch to another output bank.
+ *
+ * Publishes @p bank with a single pointer store. Transfers already running
+ * finish with the bank they latched. Slots the bank disables reject
+ * @ref display_out and @ref led_out payloads and are skipped by
+ * @ref output_apply_images. The bank built from @ref DEVICE_CONFIG and the
+ * default timing is active after boot.
+ *
+ * @param[in] bank Bank to use; must stay unchanged while
+ *                 @ref output_bank_in_use() reports it.
+ *
+ * @retval OUTPUT_OK                @p bank is active.
+ * @retval OUTPUT_ERR_INVALID_PARAM @p bank is NULL, claims a device that is
+ *                                  not fitted or has a timing rejected by
+ *                                  @ref output_slot_timing_valid().
+ */
+output_result_t output_set_active_bank(const output_bank_t *bank);
+
+/**
+ * @brief Check whether a bank may still be read by the outputs.
+ *
+ * @param[in] bank Bank to check.
+ *
+ * @return `true` when @p bank is active or latched by a bus.
+ */
+bool output_bank_in_use(const output_bank_t *bank);
+
+/**
+ * @brief Device type fitted in a slot.
+ *
+ * The only copy of @ref DEVICE_CONFIG: scenes and profiles check slots here.
+ *
+ * @param[in] slot         Physical slot index (0-7).
+ * @param[in] enabled_only Report @ref DEVICE_NONE for slots the active
+ *                         profile disables.
+ *
+ * @return The device type, or @ref DEVICE_NONE for an empty, disabled or
+ *         out of range slot.
+ */
+uint8_t output_slot_device(uint8_t slot, bool enabled_only);
+
+/**
+ * @brief Check a slot timing against the supported ranges.
+ *
+ * @param[in] timing Timing to check.
+ *
+ * @return `true` when @p timing can be applied.
+ */
+bool output_slot_timing_valid(const output_slot_timing_t *timing);
+
+/**
+ * @brief Copy one bus lock profile entry.
+ *
+ * @param[in]  entry   Entry index (0 to @ref OUTPUT_PROFILE_ENTRIES - 1).
+ * @param[out] profile Copy of the entry.
+ *
+ * @return `false` for an invalid entry.
+ */
+bool output_bus_profile(uint8_t entry, bus_profile_t *profile);
+
+/**
+ * @brief Clear every bus lock profile entry.
+ */
+void output_bus_profile_reset(void);
+
 /**
  * @brief Update the PWM duty cycle that controls the LED brightness rail.
  *
@@ -0,0 +1,190 @@
+/**
+ * @file app_profiles.h
+ * @brief Configuration banks switched with a single host command.
+ *
+ * Each bank holds a complete input configuration with its derived lookup
+ * tables and the set of output slots the profile drives. Banks are edited
+ * while inactive, optionally saved to flash, and activated with one
+ * @ref PC_CONFIG_CMD frame. Activation swaps a pointer that the scan tasks
+ * latch between scans, and one that the output buses latch with their lock,
+ * so inputs and outputs each change between two scans or transfers.
+ */
+
+#ifndef APP_PROFILES_H
+#define APP_PROFILES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_inputs.h"
+#include "app_outputs.h"
+
+/** Number of configuration banks held by the device. */
+#define PROFILE_BANK_COUNT 4U
+/** Layout version of the bank table persisted in flash. */
+#define PROFILE_STORAGE_VERSION 2U
+
+/**
+ * @name Profile sub-commands (payload[0] of PC_CONFIG_CMD)
+ * @{
+ */
+/** Activate a bank. */
+#define PROFILE_CMD_SELECT 0x00U
+/** Copy one bank over another. */
+#define PROFILE_CMD_COPY 0x01U
+/** Set one scalar input configuration field. */
+#define PROFILE_CMD_SET_FIELD 0x02U
+/** Set one encoder mapping. */
+#define PROFILE_CMD_SET_ENCODER 0x03U
+/** Set the output slot device map. */
+#define PROFILE_CMD_SET_OUTPUTS 0x04U
+/** Persist every bank and the active selection to flash. */
+#define PROFILE_CMD_SAVE 0x05U
+/** Set the bus timing of one output slot. */
+#define PROFILE_CMD_SET_TIMING 0x06U
+/** @} */
+
+/**
+ * @brief Result codes returned by the profile helpers.
+ */
+typedef enum profile_result_t {
+	PROFILE_OK = 0,                 /**< Operation completed successfully. */
+	PROFILE_ERR_INVALID_PARAM = 1,  /**< Bank, field or payload rejected. */
+	PROFILE_ERR_INVALID_CONFIG = 2, /**< The bank cannot be activated as configured. */
+	PROFILE_ERR_BUSY = 3,           /**< The bank is active or still read by a scan. */
+	PROFILE_ERR_STORAGE = 4         /**< The bank table could not be saved. */
+} profile_result_t;
+
+/**
+ * @brief One complete configuration bank.
+ */
+typedef struct profile_bank_t {
+	input_profile_t input;                                  /**< Input configuration and derived tables. */
+	output_bank_t output;                                   /**< Enabled slots and their bus timing. */
+	bool prepared;                                          /**< @ref input_profile_t tables match the configuration. */
+} profile_bank_t;
+
+/**
+ * @brief Load the banks from flash and activate the stored selection.
+ *
+ * Every bank starts from the compile-time defaults when nothing is stored.
+ * Must run after @ref input_init() and @ref output_init().
+ */
+void profile_init(void);
+
+/**
+ * @brief Index of the active bank.
+ *
+ * @return Active bank index.
+ */
+uint8_t profile_active_bank(void);
+
+/**
+ * @brief Activate a bank.
+ *
+ * The bank is validated first; nothing changes when it is rejected.
+ *
+ * @param[in] bank Bank index.
+ *
+ * @retval PROFILE_OK                 The bank is active.
+ * @retval PROFILE_ERR_INVALID_PARAM  @p bank is out of range.
+ * @retval PROFILE_ERR_INVALID_CONFIG The bank configuration is invalid.
+ */
+profile_result_t profile_select(uint8_t bank);
+
+/**
+ * @brief Copy one bank over another.
+ *
+ * @param[in] source      Bank to copy from.
+ * @param[in] destination Bank to overwrite.
+ *
+ * @retval PROFILE_OK                The destination now matches the source.
+ * @retval PROFILE_ERR_INVALID_PARAM A bank index is out of range.
+ * @retval PROFILE_ERR_BUSY          The destination is in use.
+ */
+profile_result_t profile_copy(uint8_t source, uint8_t destination);
+
+/**
+ * @brief Set one scalar input configuration field of a bank.
+ *
+ * @param[in] bank  Bank index.
+ * @param[in] field Field identifier (INPUT_FIELD_*).
+ * @param[in] value New value.
+ *
+ * @retval PROFILE_OK                The field was updated.
+ * @retval PROFILE_ERR_INVALID_PARAM Bad bank, field or value width.
+ * @retval PROFILE_ERR_BUSY          The bank is in use.
+ */
+profile_result_t profile_set_field(uint8_t bank, uint8_t field, uint16_t value);
+
+/**
+ * @brief Set one encoder mapping of a bank.
+ *
+ * @param[in] bank    Bank index.
+ * @param[in] index   Encoder index (0 to @ref MAX_NUM_ENCODERS - 1).
+ * @param[in] mapping New mapping.
+ *
+ * @retval PROFILE_OK                The mapping was updated.
+ * @retval PROFILE_ERR_INVALID_PARAM Bad bank, index or mapping pointer.
+ * @retval PROFILE_ERR_BUSY          The bank is in use.
+ */
+profile_result_t profile_set_encoder(uint8_t bank, uint8_t index, const encoder_map_t *mapping);
+
+/**
+ * @brief Set the output slot device map of a bank.
+ *
+ * Each entry must be @ref DEVICE_NONE or the device fitted in that slot by
+ * @ref DEVICE_CONFIG; a profile can disable slots but not change hardware.
+ *
+ * @param[in] bank Bank index.
+ * @param[in] map  @ref MAX_SPI_INTERFACES device types.
+ *
+ * @retval PROFILE_OK                The map was updated.
+ * @retval PROFILE_ERR_INVALID_PARAM Bad bank or map entry.
+ * @retval PROFILE_ERR_BUSY          The bank is in use.
+ */
+profile_result_t profile_set_output_map(uint8_t bank, const uint8_t *map);
+
+/**
+ * @brief Set the bus timing of one output slot in a bank.
+ *
+ * @param[in] bank   Bank index.
+ * @param[in] slot   Physical output slot (0 to @ref MAX_SPI_INTERFACES - 1).
+ * @param[in] timing New timing, checked with @ref output_slot_timing_valid().
+ *
+ * @retval PROFILE_OK                The timing was updated.
+ * @retval PROFILE_ERR_INVALID_PARAM Bad bank, slot or timing.
+ * @retval PROFILE_ERR_BUSY          The bank is in use.
+ */
+profile_result_t profile_set_slot_timing(uint8_t bank, uint8_t slot, const output_slot_timing_t *timing);
+
+/**
+ * @brief Persist every bank and the active selection to flash.
+ *
+ * @retval PROFILE_OK          The table was written.
+ * @retval PROFILE_ERR_STORAGE The flash write failed.
+ */
+profile_result_t profile_save(void);
+
+/**
+ * @brief Decode and execute a @ref PC_CONFIG_CMD profile payload.
+ *
+ * Payload structure (byte 0 is the sub-command):
+ * - @ref PROFILE_CMD_SELECT:      bank
+ * - @ref PROFILE_CMD_COPY:        source bank, destination bank
+ * - @ref PROFILE_CMD_SET_FIELD:   bank, field, value (16-bit big-endian)
+ * - @ref PROFILE_CMD_SET_ENCODER: bank, encoder index, row, column, enabled
+ * - @ref PROFILE_CMD_SET_OUTPUTS: bank, 8 device types
+ * - @ref PROFILE_CMD_SAVE:        no arguments
+ * - @ref PROFILE_CMD_SET_TIMING:  bank, slot, SPI clock in kHz (16-bit
+ *   big-endian), settle time (µs), TM1637 half period (µs)
+ *
+ * @param[in] payload Decoded payload received from the host.
+ * @param[in] length  Number of bytes available in @p payload.
+ *
+ * @return Result of the executed sub-command, or
+ *         @ref PROFILE_ERR_INVALID_PARAM for malformed payloads.
+ */
+profile_result_t profile_process_command(const uint8_t *payload, uint8_t length);
+
+#endif // APP_PROFILES_H
@@ -0,0 +1,131 @@
+/**
+ * @file app_scenes.h
+ * @brief Stored output scenes recalled with a single host command.
+ *
+ * A scene holds complete images (digits or LED columns plus brightness) for
+ * any subset of the output slots. Scenes are uploaded once, optionally saved
+ * to flash, and applied with one short @ref PC_SCENE_CMD frame that updates
+ * every slot in a single bus pass.
+ */
+
+#ifndef APP_SCENES_H
+#define APP_SCENES_H
+
+#include <stdint.h>
+
+#include "app_outputs.h"
+
+/** Number of scenes held by the device. */
+#define SCENE_MAX_COUNT 8U
+/** Layout version of the scene table persisted in flash. */
+#define SCENE_STORAGE_VERSION 1U
+
+/**
+ * @name Scene sub-commands (payload[0] of PC_SCENE_CMD)
+ * @{
+ */
+/** Store one slot image in a scene. */
+#define SCENE_CMD_UPLOAD 0x00U
+/** Remove every slot from a scene. */
+#define SCENE_CMD_CLEAR 0x01U
+/** Apply a scene to the outputs. */
+#define SCENE_CMD_APPLY 0x02U
+/** Persist the whole scene table to flash. */
+#define SCENE_CMD_SAVE 0x03U
+/** @} */
+
+/** Payload length of @ref SCENE_CMD_UPLOAD (op, scene, controller, brightness, dot, data). */
+#define SCENE_UPLOAD_PAYLOAD_SIZE (5U + OUTPUT_IMAGE_SIZE)
+
+/**
+ * @brief Result codes returned by the scene helpers.
+ */
+typedef enum scene_result_t {
+	SCENE_OK = 0,                /**< Operation completed successfully. */
+	SCENE_ERR_INVALID_PARAM = 1, /**< Scene, slot or payload rejected. */
+	SCENE_ERR_EMPTY = 2,         /**< The scene holds no slot images. */
+	SCENE_ERR_OUTPUT = 3,        /**< At least one slot failed to update. */
+	SCENE_ERR_STORAGE = 4        /**< The scene table could not be saved. */
+} scene_result_t;
+
+/**
+ * @brief Images for every output slot plus the set of slots in use.
+ */
+typedef struct output_scene_t {
+	output_slot_image_t slots[MAX_SPI_INTERFACES]; /**< Images indexed by physical slot. */
+	uint8_t slot_mask;                             /**< Bit @c n set when slot @c n is part of the scene. */
+} output_scene_t;
+
+/**
+ * @brief Load the scene table from flash, starting empty when none is stored.
+ */
+void scene_init(void);
+
+/**
+ * @brief Store an image for one slot of a scene.
+ *
+ * @param[in] scene_id      Scene index (0 to @ref SCENE_MAX_COUNT - 1).
+ * @param[in] controller_id 1-based controller identifier.
+ * @param[in] image         Image to copy into the scene.
+ *
+ * @retval SCENE_OK                The slot image was stored.
+ * @retval SCENE_ERR_INVALID_PARAM Invalid scene, controller or image, or a
+ *                                 slot the active profile disables.
+ */
+scene_result_t scene_store_slot(uint8_t scene_id, uint8_t controller_id, const output_slot_image_t *image);
+
+/**
+ * @brief Remove every slot image from a scene.
+ *
+ * @param[in] scene_id Scene index.
+ *
+ * @retval SCENE_OK                The scene is now empty.
+ * @retval SCENE_ERR_INVALID_PARAM @p scene_id is out of range.
+ */
+scene_result_t scene_clear(uint8_t scene_id);
+
+/**
+ * @brief Apply a scene to the outputs in a single bus pass.
+ *
+ * Slots the active profile disables are left out.
+ *
+ * @param[in] scene_id Scene index.
+ *
+ * @retval SCENE_OK                Every enabled slot of the scene was updated.
+ * @retval SCENE_ERR_INVALID_PARAM @p scene_id is out of range.
+ * @retval SCENE_ERR_EMPTY         The scene holds no image for an enabled slot.
+ * @retval SCENE_ERR_OUTPUT        The outputs rejected at least one image.
+ */
+scene_result_t scene_apply(uint8_t scene_id);
+
+/**
+ * @brief Persist the scene table to flash.
+ *
+ * @retval SCENE_OK          The table was written.
+ * @retval SCENE_ERR_STORAGE The flash write failed.
+ */
+scene_result_t scene_save(void);
+
+/**
+ * @brief Decode and execute a @ref PC_SCENE_CMD payload.
+ *
+ * Payload structure:
+ * Byte 0: sub-command (@ref SCENE_CMD_UPLOAD, @ref SCENE_CMD_CLEAR,
+ *         @ref SCENE_CMD_APPLY or @ref SCENE_CMD_SAVE)
+ * Byte 1: scene index (not used by @ref SCENE_CMD_SAVE)
+ *
+ * @ref SCENE_CMD_UPLOAD continues with:
+ * Byte 2: controller ID (1-8)
+ * Byte 3: brightness (0 = off, 1-7 = on)
+ * Byte 4: decimal point position (0-7, 0xFF for none)
+ * Byte 5-12: digits (one BCD value per byte) or LED column masks
+ *
+ * @param[in] payload Decoded payload received from the host.
+ * @param[in] length  Number of bytes available in @p payload.
+ *
+ * @return Result of the executed sub-command, or
+ *         @ref SCENE_ERR_INVALID_PARAM for malformed payloads.
+ */
+scene_result_t scene_process_command(const uint8_t *payload, uint8_t length);
+
+#endif // APP_SCENES_H
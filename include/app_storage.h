@@ -0,0 +1,97 @@
+/**
+ * @file app_storage.h
+ * @brief CRC-protected configuration records kept in on-board flash.
+ *
+ * Each storage region owns one flash sector at the end of the device image.
+ * A record is a @ref storage_header_t followed by the raw payload; it is only
+ * accepted on load when the magic, layout version, length and CRC-32 all
+ * match, so an erased sector or a torn write simply reads back as empty.
+ */
+
+#ifndef APP_STORAGE_H
+#define APP_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Magic word identifying a storage record ("SBCF"). */
+#define STORAGE_MAGIC 0x53424346U
+/** Time allowed for the other core to park before a flash write (ms). */
+#define STORAGE_SAFE_EXECUTE_TIMEOUT_MS 100U
+
+/**
+ * @brief Flash regions available to the application.
+ *
+ * Region @c n lives in sector @c n counted backwards from the end of flash, so
+ * appending regions never moves the ones already deployed.
+ */
+typedef enum storage_region_t {
+	STORAGE_REGION_SCENES = 0, /**< Stored output scenes. */
+	STORAGE_REGION_PROFILES,   /**< Configuration banks. */
+	NUM_STORAGE_REGIONS        /**< Number of storage regions. */
+} storage_region_t;
+
+/**
+ * @brief Result codes returned by the storage helpers.
+ */
+typedef enum storage_result_t {
+	STORAGE_OK = 0,                /**< Operation completed successfully. */
+	STORAGE_ERR_INVALID_PARAM = 1, /**< Region, buffer or length rejected. */
+	STORAGE_ERR_EMPTY = 2,         /**< No valid record for the requested layout. */
+	STORAGE_ERR_FLASH = 3,         /**< Flash could not be written safely. */
+	STORAGE_ERR_NO_MEMORY = 4      /**< Staging buffer allocation failed. */
+} storage_result_t;
+
+/**
+ * @brief Header stored in front of every record.
+ */
+typedef struct storage_header_t {
+	uint32_t magic;   /**< Always @ref STORAGE_MAGIC. */
+	uint16_t version; /**< Caller-defined layout version. */
+	uint16_t length;  /**< Payload length in bytes. */
+	uint32_t crc;     /**< CRC-32 of the payload. */
+} storage_header_t;
+
+/**
+ * @brief Compute the IEEE 802.3 CRC-32 of a buffer.
+ *
+ * @param[in] data   Bytes to checksum.
+ * @param[in] length Number of bytes in @p data.
+ * @return CRC-32 value (0 when @p data is NULL).
+ */
+uint32_t storage_crc32(const uint8_t *data, size_t length);
+
+/**
+ * @brief Read a record from flash into @p data.
+ *
+ * @param[in]  region  Region to read.
+ * @param[in]  version Expected layout version.
+ * @param[out] data    Destination buffer, left untouched unless the record is valid.
+ * @param[in]  length  Expected payload length.
+ *
+ * @retval STORAGE_OK                The record was copied into @p data.
+ * @retval STORAGE_ERR_INVALID_PARAM Invalid region, buffer or length.
+ * @retval STORAGE_ERR_EMPTY         No record matching @p version and @p length.
+ */
+storage_result_t storage_load(storage_region_t region, uint16_t version, void *data, size_t length);
+
+/**
+ * @brief Replace the record held in @p region.
+ *
+ * Erases and programs the region sector through @c flash_safe_execute() so
+ * the other core and interrupts stay off the XIP bus. Must be called from a
+ * task once the scheduler is running.
+ *
+ * @param[in] region  Region to write.
+ * @param[in] version Layout version recorded with the payload.
+ * @param[in] data    Payload to persist.
+ * @param[in] length  Payload length in bytes.
+ *
+ * @retval STORAGE_OK                The record was written.
+ * @retval STORAGE_ERR_INVALID_PARAM Invalid region, buffer or length.
+ * @retval STORAGE_ERR_NO_MEMORY     No heap left for the staging buffer.
+ * @retval STORAGE_ERR_FLASH         The flash operation could not run.
+ */
+storage_result_t storage_save(storage_region_t region, uint16_t version, const void *data, size_t length);
+
+#endif // APP_STORAGE_H
@@ -0,0 +1,228 @@
+/**
+ * @file black_box.h
+ * @brief Crash-surviving record of what the pipeline was doing before a reset.
+ *
+ * The black box lives in RAM that the C runtime does not clear, so after a
+ * watchdog or software reset it still holds the state of the previous run:
+ *
+ * - the last @ref BLACK_BOX_TRACE_DEPTH trace records of each core;
+ * - the latest snapshot of the queue depths, the per-task heartbeats and the
+ *   USB flush slack histogram, refreshed by the status LED task.
+ *
+ * Every part carries its own CRC-32 (@ref storage_crc32()), so a record or snapshot torn by the
+ * reset is dropped on its own instead of invalidating the rest. Snapshots
+ * alternate between two slots, so the older one survives a torn write of the
+ * newer one. Each core writes only its own trace ring, with interrupts
+ * masked for the few stores of one record, so tracing needs no lock between
+ * the cores.
+ *
+ * @ref black_box_boot() checks the region once at startup, keeps the valid
+ * parts of the previous run for the host (@ref PC_DEBUG_CMD) and clears the
+ * region for the new run. After a power-on the region holds noise, fails the
+ * header check and counts as a cold boot.
+ *
+ * The functions taking a @ref black_box_t work on any region and only do
+ * arithmetic, so they can be exercised on the host.
+ */
+
+#ifndef BLACK_BOX_H
+#define BLACK_BOX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usb_sof.h"
+
+/** Header magic, changed whenever the layout of @ref black_box_t changes. */
+#define BLACK_BOX_MAGIC 0x53424231U
+/** Cores writing a trace ring. */
+#define BLACK_BOX_CORES 2U
+/** Trace records kept per core. */
+#define BLACK_BOX_TRACE_DEPTH 32U
+/** Trace records of all cores. */
+#define BLACK_BOX_RECORDS (BLACK_BOX_CORES * BLACK_BOX_TRACE_DEPTH)
+/** Snapshot slots, written alternately. */
+#define BLACK_BOX_SNAPSHOT_SLOTS 2U
+/** Task heartbeats in a snapshot (at least @ref NUM_TASKS). */
+#define BLACK_BOX_TASKS 12U
+
+/**
+ * @enum black_box_queue_t
+ * @brief Queues whose depth is kept in a snapshot.
+ */
+typedef enum black_box_queue_t {
+	BLACK_BOX_QUEUE_ENCODED,      /**< Inbound frames waiting to be decoded */
+	BLACK_BOX_QUEUE_CDC_TRANSMIT, /**< Encoded packets waiting for the USB writer */
+	BLACK_BOX_QUEUE_DATA_EVENT,   /**< Input events waiting to be sent */
+	BLACK_BOX_QUEUES              /**< Number of queues */
+} black_box_queue_t;
+
+/**
+ * @enum black_box_event_t
+ * @brief Trace record types.
+ */
+typedef enum black_box_event_t {
+	BLACK_BOX_EVENT_NONE = 0,  /**< Unused slot */
+	BLACK_BOX_EVENT_BOOT,      /**< Start of a run; arg 1 after a watchdog reset, value boot count */
+	BLACK_BOX_EVENT_RX_PACKET, /**< Host packet handled; arg command, value payload length */
+	BLACK_BOX_EVENT_TX_EVENT,  /**< Input event sent; arg command, value events still queued */
+	BLACK_BOX_EVENT_TX_FLUSH,  /**< USB flush; value packets in the batch */
+	BLACK_BOX_EVENT_ERROR,     /**< Error counted; arg @ref statistics_counter_enum_t index */
+	BLACK_BOX_EVENT_FATAL,     /**< Fatal halt; arg @ref error_type_t */
+} black_box_event_t;
+
+/**
+ * @struct black_box_record_t
+ * @brief One trace record.
+ */
+typedef struct black_box_record_t {
+	uint32_t sequence; /**< Record number on its core, from 1; 0 marks an empty slot */
+	uint32_t time_us;  /**< Time of the record (µs) */
+	uint8_t event;     /**< @ref black_box_event_t */
+	uint8_t arg;       /**< Event argument */
+	uint16_t value;    /**< Event value */
+	uint32_t crc;      /**< CRC-32 of the fields above */
+} black_box_record_t;
+
+/**
+ * @struct black_box_snapshot_t
+ * @brief Periodic snapshot of the pipeline load.
+ */
+typedef struct black_box_snapshot_t {
+	uint32_t sequence;                               /**< Snapshot number, from 1 */
+	uint32_t uptime_ms;                              /**< Time of the snapshot (ms) */
+	uint16_t queue_depth[BLACK_BOX_QUEUES];          /**< Items waiting in each queue */
+	uint16_t reserved;                               /**< Padding, always 0 */
+	uint32_t heartbeat[BLACK_BOX_TASKS];             /**< Loop iterations of each task */
+	uint32_t slack_histogram[USB_SOF_SLACK_BUCKETS]; /**< USB flush-to-SOF slack counts */
+	uint32_t crc;                                    /**< CRC-32 of the fields above */
+} black_box_snapshot_t;
+
+/**
+ * @struct black_box_t
+ * @brief Layout of the region kept across resets.
+ */
+typedef struct black_box_t {
+	uint32_t magic;                                                   /**< @ref BLACK_BOX_MAGIC */
+	uint32_t boot_count;                                              /**< Runs since the last cold boot */
+	uint32_t crc;                                                     /**< CRC-32 of the magic and boot count */
+	uint32_t next_sequence[BLACK_BOX_CORES];                          /**< Next record number of each core */
+	uint32_t next_snapshot;                                           /**< Next snapshot number */
+	black_box_record_t trace[BLACK_BOX_CORES][BLACK_BOX_TRACE_DEPTH]; /**< Trace ring of each core */
+	black_box_snapshot_t snapshot[BLACK_BOX_SNAPSHOT_SLOTS];          /**< Snapshots, written alternately */
+} black_box_t;
+
+/**
+ * @struct black_box_report_t
+ * @brief What survived from the previous run.
+ */
+typedef struct black_box_report_t {
+	bool valid;                                  /**< The region held a previous run */
+	bool snapshot_valid;                         /**< @ref snapshot holds a checked snapshot */
+	uint32_t boot_count;                         /**< Runs since the last cold boot, including this one */
+	uint8_t records;                             /**< Checked trace records in @ref trace */
+	black_box_record_t trace[BLACK_BOX_RECORDS]; /**< Trace records of both cores, oldest first */
+	black_box_snapshot_t snapshot;               /**< Latest checked snapshot */
+} black_box_report_t;
+
+/**
+ * @brief Clear a region and write a fresh header.
+ *
+ * @param[out] box        Region to clear.
+ * @param[in]  boot_count Boot count stored in the header.
+ */
+void black_box_format(black_box_t *box, uint32_t boot_count);
+
+/**
+ * @brief Check the header of a region.
+ *
+ * @param[in] box Region to check.
+ *
+ * @return true when the magic and the header CRC match.
+ */
+bool black_box_is_valid(const black_box_t *box);
+
+/**
+ * @brief Append a trace record to the ring of one core.
+ *
+ * The caller makes sure nothing else writes the same ring meanwhile.
+ *
+ * @param[in,out] box     Region.
+ * @param[in]     core    Core whose ring receives the record.
+ * @param[in]     time_us Time of the record (µs).
+ * @param[in]     event   Record type.
+ * @param[in]     arg     Event argument.
+ * @param[in]     value   Event value.
+ */
+void black_box_append(black_box_t *box, uint8_t core, uint32_t time_us, black_box_event_t event, uint8_t arg,
+                      uint16_t value);
+
+/**
+ * @brief Store a snapshot in the older slot.
+ *
+ * Fills in the sequence number and the CRC.
+ *
+ * @param[in,out] box      Region.
+ * @param[in,out] snapshot Snapshot to store.
+ */
+void black_box_store_snapshot(black_box_t *box, black_box_snapshot_t *snapshot);
+
+/**
+ * @brief Find the newest snapshot that passes its CRC.
+ *
+ * @param[in]  box      Region.
+ * @param[out] snapshot Newest checked snapshot.
+ *
+ * @return true when a snapshot was found.
+ */
+bool black_box_find_snapshot(const black_box_t *box, black_box_snapshot_t *snapshot);
+
+/**
+ * @brief Gather the trace records that pass their CRC, oldest first.
+ *
+ * Records of both cores are merged by timestamp.
+ *
+ * @param[in]  box     Region.
+ * @param[out] records Checked records.
+ *
+ * @return Number of records written to @p records.
+ */
+uint8_t black_box_collect(const black_box_t *box, black_box_record_t records[BLACK_BOX_RECORDS]);
+
+/**
+ * @brief Recover the previous run and start recording the new one.
+ *
+ * Called once at startup, before any task runs.
+ *
+ * @param[in] watchdog_reset The watchdog caused this boot.
+ */
+void black_box_boot(bool watchdog_reset);
+
+/**
+ * @brief Append a trace record for the calling core.
+ *
+ * Safe from tasks and interrupts on either core.
+ *
+ * @param[in] event Record type.
+ * @param[in] arg   Event argument.
+ * @param[in] value Event value.
+ */
+void black_box_trace(black_box_event_t event, uint8_t arg, uint16_t value);
+
+/**
+ * @brief Store a pipeline snapshot for the current run.
+ *
+ * Only the status LED task calls it.
+ *
+ * @param[in,out] snapshot Snapshot to store; sequence and CRC are filled in.
+ */
+void black_box_snapshot(black_box_snapshot_t *snapshot);
+
+/**
+ * @brief What survived from the previous run, as found by @ref black_box_boot().
+ *
+ * @return Report of the previous run.
+ */
+const black_box_report_t *black_box_previous(void);
+
+#endif // BLACK_BOX_H
@@ -0,0 +1,86 @@
+/**
+ * @file bus_profile.h
+ * @brief Wait and hold time profile of an output bus lock.
+ *
+ * Every output bus transfer runs under the bus mutex, and the only failure
+ * the callers report is a timed-out take. A profile counts, for one slot or
+ * one kind of operation, how often the lock was taken, how often the taker
+ * found it held by someone else, how often it gave up, and two histograms:
+ * how long the taker waited for the lock and how long it then held it.
+ *
+ * Histogram buckets grow by a factor of four from @ref BUS_PROFILE_FIRST_US:
+ * bucket 0 counts times under 16 µs, bucket 1 under 64 µs and so on; the
+ * last bucket also counts longer times.
+ *
+ * The module only does arithmetic on times passed by the caller, so it can
+ * be exercised on the host.
+ */
+
+#ifndef BUS_PROFILE_H
+#define BUS_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Buckets of each histogram. */
+#define BUS_PROFILE_BUCKETS 8U
+/** Upper bound of bucket 0 (µs). */
+#define BUS_PROFILE_FIRST_US 16U
+/** log2 of the growth between bucket bounds. */
+#define BUS_PROFILE_BUCKET_SHIFT 2U
+
+/**
+ * @struct bus_profile_t
+ * @brief Lock statistics of one slot or operation; all counters wrap.
+ */
+typedef struct bus_profile_t {
+	uint32_t locks;                     /**< Successful takes */
+	uint32_t contended;                 /**< Takes that found the lock held */
+	uint32_t timeouts;                  /**< Takes that gave up */
+	uint32_t wait_max_us;               /**< Longest successful wait (µs) */
+	uint32_t hold_max_us;               /**< Longest hold (µs) */
+	uint32_t wait[BUS_PROFILE_BUCKETS]; /**< Wait time histogram */
+	uint32_t hold[BUS_PROFILE_BUCKETS]; /**< Hold time histogram */
+} bus_profile_t;
+
+/**
+ * @brief Histogram bucket of a time.
+ *
+ * @param[in] time_us Time (µs).
+ *
+ * @return Bucket index (0 to @ref BUS_PROFILE_BUCKETS - 1).
+ */
+uint8_t bus_profile_bucket(uint32_t time_us);
+
+/**
+ * @brief Clear a profile.
+ *
+ * @param[out] profile Profile to clear.
+ */
+void bus_profile_reset(bus_profile_t *profile);
+
+/**
+ * @brief Count a successful take.
+ *
+ * @param[in,out] profile   Profile.
+ * @param[in]     wait_us   Time spent waiting for the lock (µs).
+ * @param[in]     contended The lock was held by someone else when asked for.
+ */
+void bus_profile_record_lock(bus_profile_t *profile, uint32_t wait_us, bool contended);
+
+/**
+ * @brief Count a take that gave up.
+ *
+ * @param[in,out] profile Profile.
+ */
+void bus_profile_record_timeout(bus_profile_t *profile);
+
+/**
+ * @brief Count a release.
+ *
+ * @param[in,out] profile Profile.
+ * @param[in]     hold_us Time the lock was held (µs).
+ */
+void bus_profile_record_hold(bus_profile_t *profile, uint32_t hold_us);
+
+#endif // BUS_PROFILE_H
@@ -27,11 +27,13 @@ typedef enum pc_commands_t {
 	PC_DPYCTL_CMD,            /**< Display control command */
 	PC_TCAS_CMD,              /**< TCAS indicator update */
 	PC_FCU_CMD,               /**< Flight Control Unit update */
-	PC_SETVALUE_CMD,          /**< Generic set-value command */
+	PC_TIMED_OUTPUT_CMD,      /**< Output commands applied at a device time */
+	PC_SCENE_CMD,             /**< Stored output scene management */
+	PC_STATE_DELTA_CMD,       /**< Scan-synchronous key/axis state delta */
 
 	// System commands
 	PC_DEBUG_CMD = 16,        /**< Debug data */
-	PC_DEBUG_CTL1_CMD,        /**< Debug control channel 1 */
+	PC_DEBUG_CTL1_CMD,        /**< Debug control channel 1: output bus lock profile */
 	PC_DEBUG_CTL2_CMD,        /**< Debug control channel 2 */
 	PC_DEBUG_CTL3_CMD,        /**< Debug control channel 3 */
 	PC_ECHO_CMD,              /**< Echo request */
@@ -44,7 +46,8 @@ typedef enum pc_commands_t {
 	PC_ID_CONFIRM,            /**< Confirmation response */
 	PC_ID_REQUEST,            /**< Identification request */
 	PC_CONFIG_CMD,            /**< Configuration update */
-	PC_ENUMERATE_CMD          /**< Enumeration trigger */
+	PC_ENUMERATE_CMD,         /**< Enumeration trigger */
+	PC_STATE_DUMP_CMD         /**< Complete input state in one reply */
 } pc_commands_t;
 
 #endif // COMMAND_LIB_DEFINES
@@ -10,8 +10,10 @@
 
 /**
  * @brief Maximum payload size of a single data event.
+ *
+ * Sized for the largest state-delta frame (see @ref input_delta.h).
  */
-#define MAX_DATA_SIZE 10U
+#define MAX_DATA_SIZE 18U
 
 /**
  * @struct data_events_t
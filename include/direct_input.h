@@ -0,0 +1,81 @@
+/**
+ * @file direct_input.h
+ * @brief Interrupt-side debounce for direct GPIO inputs.
+ *
+ * The first edge after a quiet period is reported at once, timestamped in the
+ * GPIO interrupt, and opens a lockout window of @ref DIRECT_INPUT_LOCKOUT_US
+ * during which contact bounce is ignored. When the window closes the pin is
+ * sampled again, so a release that happened inside the window is still
+ * reported. Pure logic: the interrupt and alarm glue lives in app_inputs.c.
+ */
+
+#ifndef DIRECT_INPUT_H
+#define DIRECT_INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_inputs.h"
+
+/**
+ * @brief Debounce state of one direct input.
+ */
+typedef struct direct_input_state_t {
+	uint32_t edge_us; /**< Timestamp of the last reported edge. */
+	bool pressed;     /**< Last reported state. */
+	bool locked;      /**< Inside the lockout window of the last reported edge. */
+} direct_input_state_t;
+
+/**
+ * @brief Handle an edge seen by the GPIO interrupt.
+ *
+ * An edge inside the lockout window is ignored; so is one that does not
+ * change the reported state. A window older than @ref DIRECT_INPUT_LOCKOUT_US
+ * counts as closed even if its alarm did not run.
+ *
+ * @param[in,out] state   Input state.
+ * @param[in]     pressed Pin level after the edge (true = pressed).
+ * @param[in]     now_us  Edge timestamp.
+ *
+ * @retval true  Report @p pressed now and arm the lockout alarm.
+ * @retval false Nothing to report.
+ */
+bool direct_input_edge(direct_input_state_t *state, bool pressed, uint32_t now_us);
+
+/**
+ * @brief Close the lockout window and resample the pin.
+ *
+ * @param[in,out] state   Input state.
+ * @param[in]     pressed Current pin level (true = pressed).
+ * @param[in]     now_us  Current time.
+ *
+ * @retval true  The level changed inside the window: report @p pressed and
+ *               re-arm the lockout alarm.
+ * @retval false The reported state is still current.
+ */
+bool direct_input_lockout_end(direct_input_state_t *state, bool pressed, uint32_t now_us);
+
+/**
+ * @brief Build the @ref PC_KEY_CMD payload byte for a direct input.
+ *
+ * Same layout as matrix keys, at column @ref DIRECT_INPUT_COLUMN and row
+ * @p index.
+ *
+ * @param[in] index   Direct input index (below @ref DIRECT_INPUT_COUNT).
+ * @param[in] pressed New state.
+ *
+ * @return Key event byte.
+ */
+uint8_t direct_input_key_code(uint8_t index, bool pressed);
+
+/**
+ * @brief Check whether a key event byte belongs to a direct input.
+ *
+ * @param[in] code Key event byte.
+ *
+ * @retval true  @p code was built by @ref direct_input_key_code.
+ * @retval false @p code is a matrix key.
+ */
+bool direct_input_is_key_code(uint8_t code);
+
+#endif // DIRECT_INPUT_H
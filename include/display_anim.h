@@ -0,0 +1,103 @@
+/**
+ * @file display_anim.h
+ * @brief Device-side interpolation of numeric display values.
+ *
+ * Used by @ref DISPLAY_CMD_SET_TARGET so the host can send an occasional
+ * target value with a slew rate or duration instead of streaming every
+ * intermediate value. The display task steps each animated slot every
+ * @ref DISPLAY_ANIM_PERIOD_MS and only writes a slot whose digits changed.
+ */
+
+#ifndef DISPLAY_ANIM_H
+#define DISPLAY_ANIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_outputs.h"
+
+/** Display refresh period while a value is moving (50 Hz). */
+#define DISPLAY_ANIM_PERIOD_MS 20U
+
+/**
+ * @name Slew field
+ * @{
+ */
+/** Slew field holds a rate in units per second instead of a duration in ms. */
+#define DISPLAY_ANIM_SLEW_RATE 0x8000U
+/** Duration (ms) or rate (units/s) carried in the slew field. */
+#define DISPLAY_ANIM_SLEW_MASK 0x7FFFU
+/** @} */
+
+/**
+ * @brief Interpolation state for one digit slot.
+ */
+typedef struct display_anim_t {
+	int32_t current;                     /**< Value shown at the last step. */
+	int32_t target;                      /**< Value the slot is moving to. */
+	uint16_t rate;                       /**< Units per second (rate mode), 0 in duration mode. */
+	uint16_t rate_accum;                 /**< Fractional progress in units * 1/1000. */
+	uint16_t remaining_steps;            /**< Steps left to reach @ref target (duration mode). */
+	uint8_t format;                      /**< Format descriptor (DISPLAY_FORMAT_* bits). */
+	uint8_t decimals;                    /**< Digits after the decimal point. */
+	bool active;                         /**< A step is pending. */
+	bool shown_valid;                    /**< @ref shown holds what the display shows. */
+	uint8_t shown[OUTPUT_IMAGE_SIZE];    /**< Digits last written to the display. */
+	uint8_t shown_dot;                   /**< Dot position last written to the display. */
+} display_anim_t;
+
+/**
+ * @brief Forget any animation and the digits last written.
+ *
+ * Called when the slot is written by other means, so the next target starts
+ * from its own value and its first step always reaches the display.
+ *
+ * @param[out] anim Slot state.
+ */
+void display_anim_reset(display_anim_t *anim);
+
+/**
+ * @brief Start moving towards a new target.
+ *
+ * A slot that already shows a value of this animation starts from the value
+ * currently displayed, so retargeting mid-way stays continuous. A zero
+ * duration or rate jumps on the next step.
+ *
+ * @param[in,out] anim     Slot state.
+ * @param[in]     target   Target value (sign-extended already when signed).
+ * @param[in]     format   Format descriptor (DISPLAY_FORMAT_* bits).
+ * @param[in]     decimals Digits after the decimal point.
+ * @param[in]     slew     Duration in ms, or rate in units per second with
+ *                         @ref DISPLAY_ANIM_SLEW_RATE set.
+ *
+ * @retval true  The animation was started.
+ * @retval false @p format or @p decimals is invalid; @p anim is unchanged.
+ */
+bool display_anim_start(display_anim_t *anim, uint32_t target, uint8_t format,
+                        uint8_t decimals, uint16_t slew);
+
+/**
+ * @brief Advance one refresh period and format the value.
+ *
+ * @param[in,out] anim         Slot state.
+ * @param[out]    digits       @ref OUTPUT_IMAGE_SIZE digit codes to write.
+ * @param[out]    dot_position Decimal point position to write.
+ *
+ * @return Bitmask of digits that differ from the display (bit @c n = digit
+ *         @c n); 0 when nothing needs writing. A moved decimal point marks
+ *         both digits involved.
+ */
+uint8_t display_anim_step(display_anim_t *anim, uint8_t digits[OUTPUT_IMAGE_SIZE],
+                          uint8_t *dot_position);
+
+/**
+ * @brief Check whether the slot still needs steps.
+ *
+ * @param[in] anim Slot state.
+ *
+ * @retval true  Call @ref display_anim_step on the next period.
+ * @retval false The display shows the target.
+ */
+bool display_anim_active(const display_anim_t *anim);
+
+#endif // DISPLAY_ANIM_H
@@ -0,0 +1,68 @@
+/**
+ * @file display_format.h
+ * @brief Device-side formatting of binary numbers for 7-segment displays.
+ *
+ * Used by @ref DISPLAY_CMD_SET_NUMBER so the host can send a binary value
+ * with a format descriptor instead of pre-formatted BCD digits. The field is
+ * right-aligned on the 8-digit display; digits left of it are blank.
+ */
+
+#ifndef DISPLAY_FORMAT_H
+#define DISPLAY_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_outputs.h"
+
+/**
+ * @name Format descriptor bits
+ * @{
+ */
+/** Field width minus one (bits 2-0, 1 to 8 digits including the sign). */
+#define DISPLAY_FORMAT_WIDTH_MASK 0x07U
+/** Pad the field with leading zeros instead of blanks. */
+#define DISPLAY_FORMAT_LEADING_ZEROS 0x08U
+/** Value is a two's complement signed number. */
+#define DISPLAY_FORMAT_SIGNED 0x10U
+/** Blank the whole field when the value is zero. */
+#define DISPLAY_FORMAT_BLANK_ZERO 0x20U
+/** Bits that must be clear. */
+#define DISPLAY_FORMAT_RESERVED_MASK 0xC0U
+/** @} */
+
+/** Largest magnitude that fits the display (8 digits). */
+#define DISPLAY_FORMAT_MAX_MAGNITUDE 99999999UL
+
+/**
+ * @brief Convert a binary value to packed BCD without division.
+ *
+ * Shift-and-add-3 (double dabble), with every nibble corrected in parallel.
+ *
+ * @param[in] value Value up to @ref DISPLAY_FORMAT_MAX_MAGNITUDE.
+ *
+ * @return Eight BCD digits, most significant in bits 31-28.
+ */
+uint32_t display_format_to_bcd(uint32_t value);
+
+/**
+ * @brief Format a binary value into display digits.
+ *
+ * A value that does not fit the field fills it with minus signs.
+ *
+ * @param[in]  value        Raw value (sign-extended already when signed).
+ * @param[in]  format       Format descriptor (DISPLAY_FORMAT_* bits).
+ * @param[in]  decimals     Digits after the decimal point (0 = no point).
+ * @param[out] digits       @ref OUTPUT_IMAGE_SIZE digit codes, leftmost first
+ *                          (0-9, @ref OUTPUT_DIGIT_BLANK, @ref OUTPUT_DIGIT_MINUS).
+ * @param[out] dot_position Digit carrying the decimal point or
+ *                          @ref OUTPUT_NO_DECIMAL_POINT.
+ *
+ * @retval true  @p digits and @p dot_position were written.
+ * @retval false Reserved format bits set, or @p decimals does not leave room
+ *               for a digit before the point.
+ */
+bool display_format_number(uint32_t value, uint8_t format, uint8_t decimals,
+                           uint8_t digits[OUTPUT_IMAGE_SIZE], uint8_t *dot_position);
+
+#endif // DISPLAY_FORMAT_H
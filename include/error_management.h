@@ -79,6 +79,16 @@ typedef enum statistics_counter_enum_t {
 	INPUT_INIT_ERROR,
 	INPUT_HYSTERESIS_SUPPRESSED,
 
+	// Scene and persistent storage error enums
+	SCENE_ERROR,
+	STORAGE_ERROR,
+
+	// Configuration profile error enums
+	PROFILE_ERROR,
+
+	// Timed output error enums
+	TIMED_OUTPUT_ERROR,
+
 	NUM_STATISTICS_COUNTERS /**< Number of statistics counters */
 } statistics_counter_enum_t;
 
@@ -17,10 +17,23 @@
 void vApplicationMallocFailedHook(void);
 
 /**
- * @brief Executed when the scheduler is idle.
+ * @brief Executed on every pass of the active idle task; runs deferred work.
  */
 void vApplicationIdleHook(void);
 
+/**
+ * @brief Executed on every pass of the passive idle task; runs deferred work.
+ */
+void vApplicationPassiveIdleHook(void);
+
+/**
+ * @brief Account idle time when a core switches task.
+ *
+ * Expanded from @c traceTASK_SWITCHED_IN in FreeRTOSConfig.h, so it runs in
+ * the kernel's context switch and must stay short.
+ */
+void app_trace_task_switched_in(void);
+
 /**
  * @brief Called when FreeRTOS detects a stack overflow.
  *
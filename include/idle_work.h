@@ -0,0 +1,117 @@
+/**
+ * @file idle_work.h
+ * @brief Housekeeping deferred to idle time, and per-core idle accounting.
+ *
+ * Slow housekeeping such as the stack watermark scan is posted as an
+ * @ref idle_job_t and run by the FreeRTOS idle hooks, one job per idle pass,
+ * so it only ever uses time no scan or USB task wanted. Work that must happen
+ * even under overload (the black box snapshot) stays in its task.
+ *
+ * Each core has its own ring of pending jobs. A job is queued on the ring of
+ * the core that posts it and runs in that core's idle time. Every access to a
+ * ring happens on its own core with interrupts masked for a few stores, so
+ * the rings need neither a lock nor an atomic between the cores. A job that
+ * is still pending is not queued twice, so periodic work can be posted every
+ * period without filling the ring.
+ *
+ * Idle time is accounted at every context switch: the time a core spends in
+ * an idle task is added to that core's counter when the core switches to
+ * another task. Both idle tasks may run on either core, so the counters follow
+ * the core, not the task.
+ *
+ * The module only does bookkeeping on values passed by the caller, so it can
+ * be exercised on the host.
+ */
+
+#ifndef IDLE_WORK_H
+#define IDLE_WORK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Cores with an idle ring and an idle counter. */
+#define IDLE_WORK_CORES 2U
+/** Jobs that can be pending on each core. */
+#define IDLE_WORK_QUEUE_DEPTH 8U
+
+/**
+ * @brief Deferred job body.
+ *
+ * @param[in,out] context Job context.
+ */
+typedef void (*idle_job_fn_t)(void *context);
+
+/**
+ * @struct idle_job_t
+ * @brief A unit of deferred work, owned by the poster and never freed.
+ */
+typedef struct idle_job_t {
+	idle_job_fn_t function; /**< Job body */
+	void *context;          /**< Passed to @ref function */
+	volatile bool pending;  /**< Queued and not started yet */
+} idle_job_t;
+
+/**
+ * @struct idle_work_stats_t
+ * @brief Idle time and deferred work counters of one core.
+ */
+typedef struct idle_work_stats_t {
+	uint32_t idle_us; /**< Time spent in an idle task (µs, wraps) */
+	uint32_t passes;  /**< Idle hook calls */
+	uint32_t run;     /**< Jobs run */
+	uint32_t dropped; /**< Posts refused because the ring was full */
+} idle_work_stats_t;
+
+/**
+ * @brief Forget pending jobs and clear the counters.
+ *
+ * Called before the scheduler starts.
+ */
+void idle_work_reset(void);
+
+/**
+ * @brief Queue a job for the idle time of the calling core.
+ *
+ * Safe from tasks and interrupts. Posting a job that is still pending does
+ * nothing. Jobs must tolerate running once more than posted: two cores
+ * posting the same job at the same instant may both queue it.
+ *
+ * @param[in,out] job Job to queue.
+ *
+ * @return false when the ring of the calling core is full.
+ */
+bool idle_work_post(idle_job_t *job);
+
+/**
+ * @brief Run the oldest job of the calling core, if any.
+ *
+ * Called from the idle hooks. The idle task may move to the other core
+ * between two calls, so the core is read with interrupts masked.
+ *
+ * @return true when a job ran.
+ */
+bool idle_work_run(void);
+
+/**
+ * @brief Account the time of the task leaving a core.
+ *
+ * Called at every context switch, after the incoming task was chosen.
+ *
+ * @param[in] core    Core switching task.
+ * @param[in] to_idle The incoming task is an idle task.
+ * @param[in] now_us  Current time (µs).
+ */
+void idle_work_task_switched(uint8_t core, bool to_idle, uint32_t now_us);
+
+/**
+ * @brief Read the counters of a core.
+ *
+ * An idle period still in progress is included up to @p now_us.
+ *
+ * @param[in]  core   Core to read.
+ * @param[in]  now_us Current time (µs).
+ * @param[out] stats  Counters of @p core.
+ */
+void idle_work_stats(uint8_t core, uint32_t now_us, idle_work_stats_t *stats);
+
+#endif // IDLE_WORK_H
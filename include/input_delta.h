@@ -0,0 +1,77 @@
+/**
+ * @file input_delta.h
+ * @brief Packing of scan-synchronous state-delta frames.
+ *
+ * In delta report mode the keypad and ADC tasks send at most one
+ * @ref PC_STATE_DELTA_CMD frame per scan instead of one frame per key or
+ * axis change. Key frame payload:
+ *
+ * | Byte    | Content                                                        |
+ * |---------|----------------------------------------------------------------|
+ * | 0       | @ref INPUT_DELTA_SECTION_KEYS                                  |
+ * | 1       | Bit N set when byte N of the changed-key bitmap follows        |
+ * | 2..     | Non-zero bytes of the changed-key bitmap (layout of @ref input_state_t::keys) |
+ * | then    | New state of each changed key, one bit each, LSB first         |
+ *
+ * Axis frame payload:
+ *
+ * | Byte    | Content                                                        |
+ * |---------|----------------------------------------------------------------|
+ * | 0       | @ref INPUT_DELTA_SECTION_AXES                                  |
+ * | 1..2    | Changed-channel bitmap (big-endian, bit N = channel N)         |
+ * | 3..     | 12-bit values of those channels in ascending order, packed two per three bytes (big-endian nibbles) |
+ *
+ * The functions only work on caller-owned buffers so they can be exercised
+ * on the host.
+ */
+
+#ifndef INPUT_DELTA_H
+#define INPUT_DELTA_H
+
+#include <stdint.h>
+
+#include "input_state.h"
+
+/** Section identifier of a key delta frame. */
+#define INPUT_DELTA_SECTION_KEYS 0x00U
+/** Section identifier of an axis delta frame. */
+#define INPUT_DELTA_SECTION_AXES 0x01U
+
+/** Largest key or axis delta payload (all keys changed). */
+#define INPUT_DELTA_MAX_PAYLOAD (2U + (2U * INPUT_STATE_KEY_BYTES))
+/** Axes carried by one frame; further changed channels go in the next scan. */
+#define INPUT_DELTA_AXES_PER_FRAME (((INPUT_DELTA_MAX_PAYLOAD - 3U) * 2U) / 3U)
+/** Mask applied to axis values before packing. */
+#define INPUT_DELTA_AXIS_MASK 0x0FFFU
+
+/**
+ * @brief Build a key delta frame.
+ *
+ * @param[in,out] reported Key bitmap last reported to the host; updated to
+ *                         @p current when a frame is produced.
+ * @param[in]     current  Key bitmap of the scan just completed.
+ * @param[out]    out      Payload buffer (@ref INPUT_DELTA_MAX_PAYLOAD bytes).
+ *
+ * @return Payload length, or 0 when no key changed.
+ */
+uint8_t input_delta_encode_keys(uint8_t reported[INPUT_STATE_KEY_BYTES],
+                                const uint8_t current[INPUT_STATE_KEY_BYTES],
+                                uint8_t out[INPUT_DELTA_MAX_PAYLOAD]);
+
+/**
+ * @brief Build an axis delta frame from the pending channels.
+ *
+ * At most @ref INPUT_DELTA_AXES_PER_FRAME channels are packed, lowest
+ * first; their bits are cleared from @p pending and the rest stay pending.
+ *
+ * @param[in,out] pending Channels whose value still has to be reported.
+ * @param[in]     values  Current filtered value of every channel.
+ * @param[out]    out     Payload buffer (@ref INPUT_DELTA_MAX_PAYLOAD bytes).
+ *
+ * @return Payload length, or 0 when nothing is pending.
+ */
+uint8_t input_delta_encode_axes(uint16_t *pending,
+                                const uint16_t values[ADC_CHANNELS],
+                                uint8_t out[INPUT_DELTA_MAX_PAYLOAD]);
+
+#endif // INPUT_DELTA_H
@@ -0,0 +1,53 @@
+/**
+ * @file input_dump.h
+ * @brief Packing of the state dump sent for @ref PC_STATE_DUMP_CMD.
+ *
+ * A host that reconnects asks for the complete input state in one request
+ * instead of waiting for events. The reply is @ref INPUT_DUMP_PARTS frames
+ * sent back to back, each starting with the request tag and a part byte
+ * (part number in the high nibble, part count in the low nibble):
+ *
+ * | Part | Bytes 2..                                                          |
+ * |------|--------------------------------------------------------------------|
+ * | 0    | Flags (@ref INPUT_DUMP_KEYPAD_SCANNED, @ref INPUT_DUMP_ADC_SCANNED), uptime in ms (big-endian, 4 bytes), key bitmap (layout of @ref input_state_t::keys) |
+ * | 1    | Detents of each encoder, low 16 bits, big-endian                   |
+ * | 2    | Axes 0 to 9, 12 bits each, two per three bytes (`AA AB BB`)        |
+ * | 3    | Axes 10 to 15, packed the same way                                 |
+ *
+ * Pure packing of a snapshot from @ref input_state_read(), so it can be
+ * exercised on the host.
+ */
+
+#ifndef INPUT_DUMP_H
+#define INPUT_DUMP_H
+
+#include <stdint.h>
+
+#include "input_state.h"
+
+/** Frames in one dump. */
+#define INPUT_DUMP_PARTS 4U
+/** Axes in the first axis part. */
+#define INPUT_DUMP_AXES_FIRST 10U
+/** Largest part payload (the encoder part). */
+#define INPUT_DUMP_MAX_PAYLOAD (2U + (2U * MAX_NUM_ENCODERS))
+/** Part 0 flag: the keypad task has published a scan since boot. */
+#define INPUT_DUMP_KEYPAD_SCANNED 0x01U
+/** Part 0 flag: the ADC task has published a scan since boot. */
+#define INPUT_DUMP_ADC_SCANNED 0x02U
+
+/**
+ * @brief Build one part of a state dump.
+ *
+ * @param[in]  state     Snapshot from @ref input_state_read().
+ * @param[in]  uptime_ms Time since boot (ms), lets the host tell a reset from a cable bump.
+ * @param[in]  tag       Tag of the request, echoed in every part.
+ * @param[in]  part      Part number (below @ref INPUT_DUMP_PARTS).
+ * @param[out] out       Payload buffer (@ref INPUT_DUMP_MAX_PAYLOAD bytes).
+ *
+ * @return Payload length, or 0 when @p part is out of range.
+ */
+uint8_t input_dump_encode(const input_state_t *state, uint32_t uptime_ms, uint8_t tag, uint8_t part,
+                          uint8_t out[INPUT_DUMP_MAX_PAYLOAD]);
+
+#endif // INPUT_DUMP_H
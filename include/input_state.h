@@ -0,0 +1,121 @@
+/**
+ * @file input_state.h
+ * @brief Snapshot of the current input state published by the scan tasks.
+ *
+ * The keypad and ADC tasks only report changes as events. This module keeps
+ * a copy of the complete state they scanned last, so diagnostics and report
+ * builders can read it without rebuilding it from the event stream.
+ *
+ * Each producer publishes its section at the end of a scan through a
+ * double-buffered sequence lock (latch): the writer updates one copy while
+ * readers use the other. A reader therefore never waits for a writer that
+ * was preempted mid-update, and it only retries when a publish completed
+ * during its own copy. Neither side takes a lock or disables interrupts.
+ */
+
+#ifndef INPUT_STATE_H
+#define INPUT_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_inputs.h"
+
+/** Bytes in the key bitmap (one bit per matrix position). */
+#define INPUT_STATE_KEY_BYTES ((KEYPAD_ROWS * KEYPAD_COLUMNS + 7U) / 8U)
+
+/**
+ * @brief Consistent copy of the input state.
+ *
+ * The keypad part (keys, encoders) and the ADC part (axes) each come from a
+ * single scan of their task; the two parts are scanned independently.
+ */
+typedef struct input_state_t
+{
+	uint32_t keypad_sequence;              /**< Keypad scans published so far. */
+	uint32_t keypad_scan_us;               /**< Time the keypad scan completed (µs). */
+	uint32_t adc_sequence;                 /**< ADC scans published so far. */
+	uint32_t adc_scan_us;                  /**< Time the ADC scan completed (µs). */
+	uint8_t keys[INPUT_STATE_KEY_BYTES];   /**< Debounced key states, bit (row * @ref KEYPAD_COLUMNS + column) set when pressed. */
+	int32_t encoders[MAX_NUM_ENCODERS];    /**< Detents accumulated per encoder (clockwise positive). */
+	uint16_t axes[ADC_CHANNELS];           /**< Filtered value per ADC channel (0 for skipped channels). */
+} input_state_t;
+
+/**
+ * @brief Clear both sections and their sequence counters.
+ *
+ * Must not run concurrently with a publish.
+ */
+void input_state_reset(void);
+
+/**
+ * @brief Publish the keypad section at the end of a keypad scan.
+ *
+ * Only called by the keypad task.
+ *
+ * @param[in] keys     Key bitmap (@ref INPUT_STATE_KEY_BYTES bytes).
+ * @param[in] encoders Accumulated detents (@ref MAX_NUM_ENCODERS entries).
+ * @param[in] now_us   Scan completion time (µs).
+ */
+void input_state_publish_keypad(const uint8_t keys[INPUT_STATE_KEY_BYTES],
+                                const int32_t encoders[MAX_NUM_ENCODERS],
+                                uint32_t now_us);
+
+/**
+ * @brief Publish the ADC section at the end of an ADC scan.
+ *
+ * Only called by the ADC task.
+ *
+ * @param[in] axes   Filtered channel values (@ref ADC_CHANNELS entries).
+ * @param[in] now_us Scan completion time (µs).
+ */
+void input_state_publish_adc(const uint16_t axes[ADC_CHANNELS], uint32_t now_us);
+
+/**
+ * @brief Copy the last published input state.
+ *
+ * Safe from any task on either core.
+ *
+ * @param[out] state Destination for the snapshot.
+ */
+void input_state_read(input_state_t *state);
+
+/**
+ * @brief Set or clear one key in a bitmap laid out as in @ref input_state_t::keys.
+ *
+ * @param[in,out] keys    Key bitmap.
+ * @param[in]     row     Matrix row.
+ * @param[in]     column  Matrix column.
+ * @param[in]     pressed New key state.
+ */
+static inline void input_state_set_key(uint8_t keys[INPUT_STATE_KEY_BYTES], uint8_t row, uint8_t column, bool pressed)
+{
+	const uint32_t bit = ((uint32_t)row * KEYPAD_COLUMNS) + column;
+	const uint8_t mask = (uint8_t)(1U << (bit & 7U));
+
+	if (pressed)
+	{
+		keys[bit >> 3U] |= mask;
+	}
+	else
+	{
+		keys[bit >> 3U] &= (uint8_t)~mask;
+	}
+}
+
+/**
+ * @brief Check one key in a snapshot.
+ *
+ * @param[in] state  Snapshot from @ref input_state_read().
+ * @param[in] row    Matrix row.
+ * @param[in] column Matrix column.
+ *
+ * @return `true` when the key was pressed at the last keypad scan.
+ */
+static inline bool input_state_key_pressed(const input_state_t *state, uint8_t row, uint8_t column)
+{
+	const uint32_t bit = ((uint32_t)row * KEYPAD_COLUMNS) + column;
+	return 0U != (state->keys[bit >> 3U] & (1U << (bit & 7U)));
+}
+
+#endif // INPUT_STATE_H
@@ -0,0 +1,157 @@
+/**
+ * @file keypad_matrix.h
+ * @brief Scan table, bitmap diff and debounce for the PIO keypad scanner.
+ *
+ * The keypad matrix is scanned by a PIO state machine (see keypad_scan.h):
+ * it steps through a table of multiplexer select words and samples the row
+ * line once per matrix position, so every scan frame arrives as a 64-bit
+ * bitmap with bit (row * @ref KEYPAD_COLUMNS + column) per position, the
+ * layout of @ref input_state_t::keys.
+ *
+ * This module holds everything the CPU does with those frames. A frame is
+ * diffed against the debounced key bitmap; a key changes state once its new
+ * level held for @ref keypad_matrix_t::debounce_frames consecutive frames.
+ * Rotary encoders wired into the matrix are decoded from the same frames.
+ * The functions only work on caller-owned state so they can be exercised on
+ * the host with recorded frames.
+ */
+
+#ifndef KEYPAD_MATRIX_H
+#define KEYPAD_MATRIX_H
+
+#include <stdint.h>
+
+#include "app_inputs.h"
+#include "input_state.h"
+
+/**
+ * @name Keypad scan frame
+ * @{
+ */
+/** Matrix positions sampled per frame. */
+#define KEYPAD_MATRIX_POSITIONS (KEYPAD_ROWS * KEYPAD_COLUMNS)
+/** 32-bit words pushed by the PIO per frame. */
+#define KEYPAD_SCAN_FRAME_WORDS (KEYPAD_MATRIX_POSITIONS / 32U)
+/** Frame period (µs): the PIO idles after a scan until the period is over. */
+#define KEYPAD_SCAN_FRAME_US 250U
+/** PIO state machine clock in cycles per µs. */
+#define KEYPAD_SCAN_CYCLES_PER_US 10U
+/** First GPIO driven by a scan word (column select bit 0). */
+#define KEYPAD_SCAN_OUT_BASE KEYPAD_COL_MUX_A
+/** GPIOs driven by a scan word, from @ref KEYPAD_SCAN_OUT_BASE. */
+#define KEYPAD_SCAN_OUT_COUNT 9U
+/** Position of the settle delay in a scan word. */
+#define KEYPAD_SCAN_SETTLE_SHIFT KEYPAD_SCAN_OUT_COUNT
+/** Largest settle delay a scan word holds (PIO cycles). */
+#define KEYPAD_SCAN_SETTLE_MAX ((1UL << (32U - KEYPAD_SCAN_SETTLE_SHIFT)) - 1UL)
+/** PIO cycles per position besides the settle loop. */
+#define KEYPAD_SCAN_FIXED_CYCLES 4U
+/** Upper bound for @ref keypad_matrix_t::debounce_frames. */
+#define KEYPAD_MATRIX_MAX_DEBOUNCE_FRAMES 255U
+/** @} */
+
+/**
+ * @brief Debounce and encoder state fed by the scan frames.
+ */
+typedef struct keypad_matrix_t
+{
+	uint64_t enabled;                                  /**< Positions debounced as keys. */
+	uint64_t stable;                                   /**< Debounced key states (set = pressed). */
+	uint64_t pending;                                  /**< Keys whose level differed from @c stable in the last frame. */
+	uint8_t count[KEYPAD_MATRIX_POSITIONS];            /**< Consecutive frames each pending key held its new level. */
+	uint8_t debounce_frames;                           /**< Frames a new level must hold before it is reported. */
+	uint8_t num_encoders;                              /**< Entries used in @c encoders. */
+	encoder_map_t encoders[MAX_NUM_ENCODERS];          /**< Encoder positions (copied from the profile). */
+	encoder_states_t encoder_state[MAX_NUM_ENCODERS];  /**< Quadrature state per encoder. */
+	int32_t detents[MAX_NUM_ENCODERS];                 /**< Detents accumulated per encoder (clockwise positive). */
+} keypad_matrix_t;
+
+/**
+ * @brief Bit of a matrix position in a frame or key bitmap.
+ *
+ * @param[in] row    Matrix row.
+ * @param[in] column Matrix column.
+ *
+ * @return Bit index.
+ */
+static inline uint8_t keypad_matrix_position(uint8_t row, uint8_t column)
+{
+	return (uint8_t)((row * KEYPAD_COLUMNS) + column);
+}
+
+/**
+ * @brief Start over with all keys released and encoders at rest.
+ *
+ * Copies what the frames are decoded with from @p profile, so the profile
+ * is not referenced afterwards.
+ *
+ * @param[out] matrix   State to reset.
+ * @param[in]  profile  Prepared profile (matrix size, encoder positions, key settling time).
+ * @param[in]  frame_us Scan frame period (µs).
+ */
+void keypad_matrix_reset(keypad_matrix_t *matrix, const input_profile_t *profile, uint32_t frame_us);
+
+/**
+ * @brief Frames a new key level must hold before it is reported.
+ *
+ * Keeps the window of the sampled debouncer this replaced: the
+ * @ref KEYPAD_STABILITY_BITS - 1 stable samples it required, each
+ * @p key_settling_time_ms apart.
+ *
+ * @param[in] key_settling_time_ms Configured key settling time (ms).
+ * @param[in] frame_us             Scan frame period (µs).
+ *
+ * @return Frame count, between 1 and @ref KEYPAD_MATRIX_MAX_DEBOUNCE_FRAMES.
+ */
+uint8_t keypad_matrix_debounce_frames(uint16_t key_settling_time_ms, uint32_t frame_us);
+
+/**
+ * @brief Convert the words pushed by the PIO into a pressed-key bitmap.
+ *
+ * @param[in] frame Sampled row line levels, LSB first (low = pressed).
+ *
+ * @return Bitmap with a bit set for every position that read pressed.
+ */
+uint64_t keypad_matrix_pressed(const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS]);
+
+/**
+ * @brief Feed one scan frame.
+ *
+ * Positions that match the debounced state cost nothing beyond the diff.
+ *
+ * @param[in,out] matrix  Debounce and encoder state.
+ * @param[in]     pressed Bitmap from @ref keypad_matrix_pressed.
+ * @param[out]    steps   Per encoder: +1 or -1 when a detent completed in
+ *                        this frame, else 0 (@ref MAX_NUM_ENCODERS entries).
+ *
+ * @return Keys whose debounced state changed; their new state is in
+ *         @ref keypad_matrix_t::stable.
+ */
+uint64_t keypad_matrix_update(keypad_matrix_t *matrix, uint64_t pressed, int8_t steps[MAX_NUM_ENCODERS]);
+
+/**
+ * @brief Copy a key bitmap into the byte layout of @ref input_state_t::keys.
+ *
+ * @param[in]  keys   Key bitmap.
+ * @param[out] bitmap Destination bitmap.
+ */
+void keypad_matrix_to_bytes(uint64_t keys, uint8_t bitmap[INPUT_STATE_KEY_BYTES]);
+
+/**
+ * @brief Build the table the PIO steps through for one frame.
+ *
+ * Positions are visited row by row. Each word drives the select GPIOs from
+ * @ref KEYPAD_SCAN_OUT_BASE with the row multiplexer enabled and holds the
+ * settle delay before the sample: the column settling time, plus the row
+ * settling time where the row changes. Time left in the frame period is
+ * added to the first position.
+ *
+ * @param[out] table         Scan words (@ref KEYPAD_MATRIX_POSITIONS entries).
+ * @param[in]  col_settle_us Column decoder settling time (µs).
+ * @param[in]  row_settle_us Row multiplexer settling time (µs).
+ * @param[in]  frame_us      Frame period (µs).
+ */
+void keypad_matrix_build_scan(uint32_t table[KEYPAD_MATRIX_POSITIONS], uint16_t col_settle_us,
+                              uint16_t row_settle_us, uint32_t frame_us);
+
+#endif // KEYPAD_MATRIX_H
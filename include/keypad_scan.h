@@ -0,0 +1,53 @@
+/**
+ * @file keypad_scan.h
+ * @brief PIO and DMA driven keypad matrix scanning.
+ *
+ * A PIO state machine steps the column decoder and row multiplexer selects
+ * through a scan table, waits the settle time and samples the row line for
+ * every matrix position. One DMA channel feeds it the table and a second one
+ * rewinds the first after every frame, so scanning runs without the CPU. Two
+ * more channels, chained to each other, store alternate frames in a double
+ * buffer and raise DMA_IRQ_0 when a frame is complete. The interrupt hands
+ * the finished buffer to the callback while the next frame fills the other
+ * one.
+ *
+ * Claims a free state machine on pio0 and four DMA channels.
+ */
+
+#ifndef KEYPAD_SCAN_H
+#define KEYPAD_SCAN_H
+
+#include <stdint.h>
+
+#include "keypad_matrix.h"
+
+/**
+ * @brief Called from the DMA interrupt with each completed frame.
+ *
+ * @param[in] frame Row line levels, LSB first; valid until the callback returns.
+ */
+typedef void (*keypad_scan_frame_cb_t)(const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS]);
+
+/**
+ * @brief Rebuild the scan table for new multiplexer settling times.
+ *
+ * Can be called while scanning; the frame being scanned may use a mix of the
+ * old and new times.
+ *
+ * @param[in] col_settle_us Column decoder settling time (µs).
+ * @param[in] row_settle_us Row multiplexer settling time (µs).
+ */
+void keypad_scan_set_timing(uint16_t col_settle_us, uint16_t row_settle_us);
+
+/**
+ * @brief Hand the keypad select lines to the PIO and start scanning.
+ *
+ * The DMA interrupt is enabled on the calling core, so the callback runs on
+ * it. Call @ref keypad_scan_set_timing() first. Panics if no state machine or
+ * DMA channel is free.
+ *
+ * @param[in] callback Frame consumer.
+ */
+void keypad_scan_start(keypad_scan_frame_cb_t callback);
+
+#endif // KEYPAD_SCAN_H
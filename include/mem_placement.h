@@ -0,0 +1,54 @@
+/**
+ * @file mem_placement.h
+ * @brief Core-aware SRAM bank placement for hot data.
+ *
+ * The RP2040 main SRAM is striped word by word over four banks that both
+ * cores and the DMA share. SCRATCH_X and SCRATCH_Y are two more 4 KB banks
+ * on their own bus ports; the Pico SDK puts the core 1 stack in SCRATCH_X and
+ * the core 0 stack in SCRATCH_Y. Data that only one core touches is placed in
+ * that core's scratch bank, so its accesses never wait behind the other core
+ * or a DMA transfer. Data shared between the cores, and every DMA buffer,
+ * stays in main SRAM.
+ *
+ * Each placement is paired with a static assertion on the task affinities it
+ * relies on, and `scripts/check_placement.py --rules` checks the linked
+ * image after every firmware build. Host builds place nothing.
+ *
+ * Data that must outlive a reset goes in main SRAM that the C runtime
+ * neither copies nor clears at startup; a watchdog or software reset leaves
+ * it as it was.
+ */
+
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#include <pico/platform.h>
+
+/**
+ * @brief Place a variable in SCRATCH_X, next to the core 1 stack.
+ *
+ * @param group Section suffix, unique per variable.
+ */
+#define CORE1_PRIVATE_DATA(group) __scratch_x(group)
+
+/**
+ * @brief Place a variable in SCRATCH_Y, next to the core 0 stack.
+ *
+ * @param group Section suffix, unique per variable.
+ */
+#define CORE0_PRIVATE_DATA(group) __scratch_y(group)
+
+/**
+ * @brief Place a variable in main SRAM that startup does not initialise.
+ *
+ * @param group Section suffix, unique per variable.
+ */
+#define NOINIT_DATA(group) __uninitialized_ram(group)
+#else
+#define CORE1_PRIVATE_DATA(group)
+#define CORE0_PRIVATE_DATA(group)
+#define NOINIT_DATA(group)
+#endif
+
+#endif // MEM_PLACEMENT_H
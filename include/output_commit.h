@@ -0,0 +1,183 @@
+/**
+ * @file output_commit.h
+ * @brief Output commands staged for a device time and committed together.
+ *
+ * Display, LED and PWM updates are normally applied as their frames arrive,
+ * so an update spread over several frames, slots or boards shows up piece by
+ * piece. A @ref PC_TIMED_OUTPUT_CMD frame instead carries an output command
+ * and the device time (@c time_us_32()) at which to apply it. The command is
+ * staged, and every command due at that time is committed in one pass of
+ * @ref display_refresh_task, in the order the frames arrived. With the device
+ * clock read through @ref TIMED_CMD_CLOCK, a host can give several boards the
+ * same apply time.
+ *
+ * Only the display refresh task arms the commit alarm: staging a command
+ * that is due earlier than the alarm wakes the task, which then re-arms it.
+ * The alarm callback only notifies the task, on the notification index its
+ * timer wheel timers use.
+ *
+ * The functions taking an @ref output_commit_queue_t only do bookkeeping on
+ * values passed by the caller, so they can be exercised on the host.
+ */
+
+#ifndef OUTPUT_COMMIT_H
+#define OUTPUT_COMMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_config.h"
+
+/** Commands that can be staged at once. */
+#define OUTPUT_COMMIT_DEPTH 16U
+/** Header of a staged command: sub-command, apply time (4) and command. */
+#define OUTPUT_COMMIT_HEADER_SIZE 6U
+/** Largest payload of a staged command. */
+#define OUTPUT_COMMIT_MAX_PAYLOAD (DATA_BUFFER_SIZE - OUTPUT_COMMIT_HEADER_SIZE)
+/** Furthest ahead a command can be staged (µs). */
+#define OUTPUT_COMMIT_MAX_LEAD_US 1000000U
+/** A commit taken this long after its apply time counts as late (µs, one tick). */
+#define OUTPUT_COMMIT_LATE_US 500U
+
+/**
+ * @name Timed output sub-commands (payload[0] of PC_TIMED_OUTPUT_CMD)
+ * @{
+ */
+/** Reply with the device clock and the commit counters. */
+#define TIMED_CMD_CLOCK 0x00U
+/** Stage an output command for a device time. */
+#define TIMED_CMD_STAGE 0x01U
+/** Drop every staged command. */
+#define TIMED_CMD_CANCEL 0x02U
+/** @} */
+
+/**
+ * @brief Result codes returned by the commit helpers.
+ */
+typedef enum output_commit_result_t {
+	OUTPUT_COMMIT_OK = 0,            /**< Operation completed successfully. */
+	OUTPUT_COMMIT_ERR_INVALID = 1,   /**< Command, length or sub-command rejected. */
+	OUTPUT_COMMIT_ERR_TOO_FAR = 2,   /**< Apply time beyond @ref OUTPUT_COMMIT_MAX_LEAD_US. */
+	OUTPUT_COMMIT_ERR_FULL = 3       /**< @ref OUTPUT_COMMIT_DEPTH commands already staged. */
+} output_commit_result_t;
+
+/**
+ * @struct output_commit_entry_t
+ * @brief One staged output command.
+ */
+typedef struct output_commit_entry_t {
+	uint32_t apply_us;                          /**< Device time to apply at (µs, wraps) */
+	uint8_t command;                            /**< @ref PC_DPYCTL_CMD, @ref PC_LEDOUT_CMD or @ref PC_PWM_CMD */
+	uint8_t length;                             /**< Bytes used in @ref payload */
+	uint8_t payload[OUTPUT_COMMIT_MAX_PAYLOAD]; /**< Payload as sent untimed */
+} output_commit_entry_t;
+
+/**
+ * @struct output_commit_queue_t
+ * @brief Staged commands in arrival order, and counters.
+ */
+typedef struct output_commit_queue_t {
+	output_commit_entry_t entries[OUTPUT_COMMIT_DEPTH]; /**< Staged commands, oldest first */
+	uint8_t count;                                      /**< Staged commands */
+	uint32_t committed;                                 /**< Commands taken for commit */
+	uint32_t late;                                      /**< Commands taken late (@ref OUTPUT_COMMIT_LATE_US) */
+} output_commit_queue_t;
+
+/**
+ * @brief Empty a queue and clear its counters.
+ *
+ * @param[out] queue Queue to clear.
+ */
+void output_commit_queue_init(output_commit_queue_t *queue);
+
+/**
+ * @brief Stage a command.
+ *
+ * An apply time already past is committed at the next pass.
+ *
+ * @param[in,out] queue    Queue.
+ * @param[in]     now_us   Current device time (µs).
+ * @param[in]     apply_us Device time to apply at (µs).
+ * @param[in]     command  Output command.
+ * @param[in]     payload  Payload of @p command.
+ * @param[in]     length   Bytes in @p payload.
+ *
+ * @retval OUTPUT_COMMIT_OK          The command is staged.
+ * @retval OUTPUT_COMMIT_ERR_INVALID Unsupported command or bad length.
+ * @retval OUTPUT_COMMIT_ERR_TOO_FAR @p apply_us is too far ahead.
+ * @retval OUTPUT_COMMIT_ERR_FULL    No room left.
+ */
+output_commit_result_t output_commit_queue_stage(output_commit_queue_t *queue, uint32_t now_us, uint32_t apply_us,
+                                                 uint8_t command, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Take every command due at @p now_us, in arrival order.
+ *
+ * @param[in,out] queue  Queue.
+ * @param[in]     now_us Current device time (µs).
+ * @param[out]    due    Room for @ref OUTPUT_COMMIT_DEPTH commands.
+ *
+ * @return Number of commands copied to @p due.
+ */
+uint8_t output_commit_queue_take_due(output_commit_queue_t *queue, uint32_t now_us, output_commit_entry_t *due);
+
+/**
+ * @brief Find the earliest apply time still staged.
+ *
+ * @param[in]  queue    Queue.
+ * @param[in]  now_us   Current device time (µs).
+ * @param[out] apply_us Earliest apply time.
+ *
+ * @return false when nothing is staged.
+ */
+bool output_commit_queue_next(const output_commit_queue_t *queue, uint32_t now_us, uint32_t *apply_us);
+
+/**
+ * @brief Empty the system queue.
+ *
+ * Called once at startup, before the scheduler runs.
+ */
+void output_commit_setup(void);
+
+/**
+ * @brief Decode and execute a @ref PC_TIMED_OUTPUT_CMD payload.
+ *
+ * Payload structure:
+ * Byte 0: sub-command (@ref TIMED_CMD_STAGE or @ref TIMED_CMD_CANCEL)
+ *
+ * @ref TIMED_CMD_STAGE continues with:
+ * Byte 1-4: apply time, device µs, big-endian
+ * Byte 5:   output command (@ref PC_DPYCTL_CMD, @ref PC_LEDOUT_CMD or
+ *           @ref PC_PWM_CMD)
+ * Byte 6..: payload of that command, as sent untimed
+ *
+ * @ref TIMED_CMD_CLOCK is answered by the caller, with
+ * @ref output_commit_counters().
+ *
+ * @param[in] payload Payload received from the host.
+ * @param[in] length  Number of bytes in @p payload.
+ *
+ * @return Result of staging or cancelling.
+ */
+output_commit_result_t output_commit_process_command(const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Read the counters reported by @ref TIMED_CMD_CLOCK.
+ *
+ * @param[out] staged Commands staged now.
+ * @param[out] late   Commands committed more than @ref OUTPUT_COMMIT_LATE_US
+ *                    after their apply time.
+ */
+void output_commit_counters(uint8_t *staged, uint32_t *late);
+
+/**
+ * @brief Commit every staged command that is due and re-arm the alarm.
+ *
+ * Runs in @ref display_refresh_task each time it wakes.
+ *
+ * @return false when a command is still staged but no alarm could be armed,
+ *         so the caller must poll.
+ */
+bool output_commit_run(void);
+
+#endif // OUTPUT_COMMIT_H
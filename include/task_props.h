@@ -16,7 +16,8 @@
 typedef struct task_props_t
 {
 	TaskHandle_t task_handle; /**< Task handle assigned by the scheduler. */
-	uint32_t high_watermark;  /**< Minimum remaining stack depth recorded. */
+	uint32_t high_watermark;  /**< Minimum remaining stack depth, sampled in idle time. */
+	uint32_t heartbeat;       /**< Loop iterations, kept in the black box snapshot. */
 } task_props_t;
 
 #endif // TASK_PROPS_H
@@ -0,0 +1,203 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel for many short-lived device-side timers.
+ *
+ * FreeRTOS software timers go through the timer task's command queue, which
+ * holds @c configTIMER_QUEUE_LENGTH commands and costs a queue round trip per
+ * start or stop. The wheel keeps its timers in intrusive lists instead, so
+ * starting and cancelling a timer is a constant number of pointer stores and
+ * hundreds of them cost nothing until they expire.
+ *
+ * The wheel has @ref TIMER_WHEEL_LEVELS levels of @ref TIMER_WHEEL_SLOTS
+ * slots. Level 0 holds timers due within @ref TIMER_WHEEL_SLOTS ticks, one
+ * slot per tick; each higher level covers @ref TIMER_WHEEL_SLOTS times the
+ * span of the level below. When level 0 wraps, the next slot of level 1 is
+ * spread over level 0, and so on up. Timers further out than the top level
+ * wait in its last slot and are placed again when it comes round.
+ *
+ * The kernel tick advances the system wheel from @c vApplicationTickHook().
+ * Expired timers are not run in the interrupt: they are moved to the list of
+ * the task that owns them, and that task is woken once per tick through
+ * notification index @ref TIMER_WHEEL_NOTIFY_INDEX, however many of its timers
+ * expired. The task then runs the whole batch with @ref timer_wheel_dispatch().
+ *
+ * The functions taking a @ref timer_wheel_t only do list and tick arithmetic,
+ * so they can be exercised on the host.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_config.h"
+
+/** Slots per level (power of two). */
+#define TIMER_WHEEL_SLOTS 64U
+/** Bits of a tick count selecting a slot within a level. */
+#define TIMER_WHEEL_SLOT_BITS 6U
+/** Levels; the wheel spans 2^18 ticks (131 s at 2 kHz) before clamping. */
+#define TIMER_WHEEL_LEVELS 3U
+/** Owners with an expired list, one per task. */
+#define TIMER_WHEEL_OWNERS NUM_TASKS
+/** Task notification index used to wake an owner. */
+#define TIMER_WHEEL_NOTIFY_INDEX 1U
+
+_Static_assert((1U << TIMER_WHEEL_SLOT_BITS) == TIMER_WHEEL_SLOTS, "Slot bits must match the slot count");
+
+typedef struct timer_wheel_timer_t timer_wheel_timer_t;
+
+/**
+ * @brief Expiry handler, run in the owner task.
+ *
+ * @param[in,out] timer The expired timer; it may be started again.
+ */
+typedef void (*timer_wheel_fn_t)(timer_wheel_timer_t *timer);
+
+/**
+ * @struct timer_wheel_timer_t
+ * @brief A timer, owned by the caller and never freed while armed.
+ */
+struct timer_wheel_timer_t {
+	timer_wheel_timer_t *next;   /**< Next timer in the same list */
+	timer_wheel_timer_t **pprev; /**< Link pointing at this timer; NULL when not armed */
+	uint32_t expires;            /**< Tick at which the timer is due */
+	timer_wheel_fn_t function;   /**< Expiry handler */
+	void *context;               /**< Free for the handler */
+	uint8_t owner;               /**< @ref task_enum_t running the handler */
+};
+
+/**
+ * @struct timer_wheel_t
+ * @brief Slots and expired lists of a wheel.
+ */
+typedef struct timer_wheel_t {
+	uint32_t now;                                                     /**< Last tick processed */
+	timer_wheel_timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; /**< Armed timers */
+	timer_wheel_timer_t *expired[TIMER_WHEEL_OWNERS];                 /**< Expired timers of each owner */
+} timer_wheel_t;
+
+/**
+ * @brief Empty a wheel.
+ *
+ * @param[out] wheel Wheel to clear.
+ * @param[in]  now   Current tick.
+ */
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Arm a timer for an absolute tick, moving it if already armed.
+ *
+ * A tick that is already due expires at the next advance.
+ *
+ * @param[in,out] wheel   Wheel.
+ * @param[in,out] timer   Timer with function and owner set.
+ * @param[in]     expires Tick at which the timer is due.
+ */
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_timer_t *timer, uint32_t expires);
+
+/**
+ * @brief Disarm a timer, whether still pending or already expired.
+ *
+ * @param[in,out] timer Timer to disarm.
+ *
+ * @return true when the timer was armed.
+ */
+bool timer_wheel_remove(timer_wheel_timer_t *timer);
+
+/**
+ * @brief Process every tick up to @p now.
+ *
+ * @param[in,out] wheel Wheel.
+ * @param[in]     now   Current tick.
+ *
+ * @return Bit n set when owner n got newly expired timers.
+ */
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Take one expired timer of an owner.
+ *
+ * The timer is disarmed before it is returned.
+ *
+ * @param[in,out] wheel Wheel.
+ * @param[in]     owner Owner whose list is read.
+ *
+ * @return The timer, or NULL when the owner has none.
+ */
+timer_wheel_timer_t *timer_wheel_pop_expired(timer_wheel_t *wheel, uint8_t owner);
+
+/**
+ * @brief Check whether a timer is armed or waiting for dispatch.
+ *
+ * @param[in] timer Timer.
+ *
+ * @return true while the timer is in the wheel.
+ */
+static inline bool timer_wheel_is_armed(const timer_wheel_timer_t *timer)
+{
+	return NULL != timer->pprev;
+}
+
+/**
+ * @brief Empty the system wheel.
+ *
+ * Called once at startup, before the scheduler runs.
+ */
+void timer_wheel_setup(void);
+
+/**
+ * @brief Arm a system timer unless it is already armed.
+ *
+ * Safe from tasks on either core.
+ *
+ * @param[in,out] timer       Timer with function and owner set.
+ * @param[in]     delay_ticks Ticks from now.
+ *
+ * @return true when the timer was armed by this call.
+ */
+bool timer_wheel_start(timer_wheel_timer_t *timer, uint32_t delay_ticks);
+
+/**
+ * @brief Arm a system timer for an absolute tick, moving it if already armed.
+ *
+ * Periodic handlers pass their own @ref timer_wheel_timer_t::expires plus the
+ * period, so late dispatch does not shift the cadence.
+ *
+ * @param[in,out] timer   Timer with function and owner set.
+ * @param[in]     expires Tick at which the timer is due.
+ */
+void timer_wheel_reschedule(timer_wheel_timer_t *timer, uint32_t expires);
+
+/**
+ * @brief Disarm a system timer.
+ *
+ * A handler that the owner has already taken from the wheel still runs.
+ *
+ * @param[in,out] timer Timer to disarm.
+ *
+ * @return true when the timer was armed.
+ */
+bool timer_wheel_cancel(timer_wheel_timer_t *timer);
+
+/**
+ * @brief Advance the system wheel to the current tick and wake the owners.
+ *
+ * Called from @c vApplicationTickHook().
+ */
+void timer_wheel_tick(void);
+
+/**
+ * @brief Run the expired timers of the calling task.
+ *
+ * Called by an owner after it was notified on @ref TIMER_WHEEL_NOTIFY_INDEX.
+ *
+ * @param[in] owner Task calling.
+ *
+ * @return Number of handlers run.
+ */
+uint32_t timer_wheel_dispatch(task_enum_t owner);
+
+#endif // TIMER_WHEEL_H
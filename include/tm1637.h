@@ -122,6 +122,20 @@ output_result_t tm1637_set_digits(output_driver_t *config,
  */
 output_result_t tm1637_set_leds(output_driver_t *config, const uint8_t leds, const uint8_t ledstate);
 
+/**
+ * @brief Update several LED registers with a single bus flush.
+ *
+ * @param[in,out] config  Driver handle obtained from @ref tm1637_init().
+ * @param[in]     columns Segment patterns starting at register 0.
+ * @param[in]     count   Number of entries in @p columns; entries beyond
+ *                        @ref TM1637_DISPLAY_BUFFER_SIZE are ignored.
+ *
+ * @retval OUTPUT_OK              Register contents were committed to hardware.
+ * @retval OUTPUT_ERR_INVALID_PARAM @p config or @p columns is NULL.
+ * @retval OUTPUT_ERR_DISPLAY_OUT  Communication with the controller failed.
+ */
+output_result_t tm1637_set_led_columns(output_driver_t *config, const uint8_t *columns, size_t count);
+
 /**
  * @brief Clear the TM1637 display and internal buffers.
  *
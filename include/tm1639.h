@@ -156,4 +156,21 @@ output_result_t tm1639_set_brightness(output_driver_t *config, uint8_t level);
  */
 output_result_t tm1639_set_leds(output_driver_t *config, const uint8_t leds, const uint8_t ledstate);
 
+/**
+ * @brief Update several LED matrix columns with a single bus flush.
+ *
+ * Applies the same nibble split as @ref tm1639_set_leds() to each entry of
+ * @p columns, then commits the staged buffer once. Entries beyond
+ * @ref TM1639_DIGIT_COUNT are ignored.
+ *
+ * @param[in,out] config  Driver handle obtained from @ref tm1639_init().
+ * @param[in]     columns Column bitmasks starting at column 0.
+ * @param[in]     count   Number of entries available in @p columns.
+ *
+ * @retval OUTPUT_OK              Matrix state was committed to hardware.
+ * @retval OUTPUT_ERR_INVALID_PARAM @p config or @p columns is NULL.
+ * @retval OUTPUT_ERR_DISPLAY_OUT  Communication with the controller failed.
+ */
+output_result_t tm1639_set_led_columns(output_driver_t *config, const uint8_t *columns, size_t count);
+
 #endif // TM1639_H
@@ -0,0 +1,88 @@
+/**
+ * @file usb_sof.h
+ * @brief USB start-of-frame tracking used to time outbound CDC flushes.
+ *
+ * The host polls the bulk IN endpoint once the frame that follows each SOF
+ * begins. The CDC writer therefore batches packets in the TinyUSB FIFO and
+ * flushes them shortly before the next expected SOF. Each flush is then
+ * ready for the first IN poll of that frame instead of waiting for a later
+ * one. The time left between a flush and the following SOF is recorded in
+ * a histogram so the lead time can be tuned on real hosts.
+ *
+ * The module only does arithmetic on timestamps passed by the caller, so it
+ * can be exercised on the host.
+ */
+
+#ifndef USB_SOF_H
+#define USB_SOF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Full-speed USB frame period (µs). */
+#define USB_SOF_PERIOD_US 1000U
+/** Flush this long before the expected SOF to absorb callback latency (µs). */
+#define USB_SOF_FLUSH_LEAD_US 150U
+/** SOF timing is considered lost when no SOF arrived for this long (µs). */
+#define USB_SOF_LOCK_TIMEOUT_US (3U * USB_SOF_PERIOD_US)
+/** log2 of the slack histogram bucket width (128 µs buckets). */
+#define USB_SOF_SLACK_BUCKET_SHIFT 7U
+/** Number of slack histogram buckets; the last one also counts longer slack. */
+#define USB_SOF_SLACK_BUCKETS 8U
+
+/**
+ * @brief Forget the SOF phase and clear the slack histogram.
+ */
+void usb_sof_reset(void);
+
+/**
+ * @brief Record a start-of-frame.
+ *
+ * Called from the TinyUSB SOF callback. Closes the slack measurement of the
+ * last flush issued since the previous SOF.
+ *
+ * @param[in] now_us Current time (µs, free-running 32-bit counter).
+ */
+void usb_sof_on_frame(uint32_t now_us);
+
+/**
+ * @brief Record that the CDC writer armed the IN endpoint.
+ *
+ * @param[in] now_us Current time (µs).
+ */
+void usb_sof_on_flush(uint32_t now_us);
+
+/**
+ * @brief Time the writer should keep batching before it flushes.
+ *
+ * @param[in] now_us Current time (µs).
+ *
+ * @return Microseconds until the flush point ahead of the next SOF, or 0 to
+ *         flush now (point already reached or SOF timing unknown).
+ */
+uint32_t usb_sof_flush_delay_us(uint32_t now_us);
+
+/**
+ * @brief Check whether recent SOFs give a usable frame phase.
+ *
+ * @param[in] now_us Current time (µs).
+ *
+ * @retval true  A SOF was seen within @ref USB_SOF_LOCK_TIMEOUT_US.
+ * @retval false No SOF yet, or the bus is suspended.
+ */
+bool usb_sof_is_locked(uint32_t now_us);
+
+/**
+ * @brief Read one slack histogram bucket.
+ *
+ * Bucket @c n counts flushes issued between
+ * @c n << @ref USB_SOF_SLACK_BUCKET_SHIFT and
+ * (@c n + 1) << @ref USB_SOF_SLACK_BUCKET_SHIFT µs before the next SOF.
+ *
+ * @param[in] bucket Bucket index (0 to @ref USB_SOF_SLACK_BUCKETS - 1).
+ *
+ * @return Number of flushes in the bucket, 0 for an invalid index.
+ */
+uint32_t usb_sof_slack_count(uint8_t bucket);
+
+#endif // USB_SOF_H
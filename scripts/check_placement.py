@@ -96,11 +96,11 @@ class MemoryAnalyzer:
             problems.append("  → Required for atomic operations in SMP")
             problems.append("  → Solution: Add __attribute__((aligned(4)))")
         
-        # Check 3: In scratch regions (bad for SMP)
+        # Check 3: In scratch regions (private to one core by convention)
         if self.SCRATCH_X_START <= var.address < self.SCRATCH_Y_END:
             problems.append(f"WARNING: Variable '{var.name}' in scratch RAM (0x{var.address:08x})")
-            problems.append("  → Scratch regions have special multicore behavior")
-            problems.append("  → May cause cache coherency issues")
+            problems.append("  → Scratch banks hold data private to one core (see mem_placement.h)")
+            problems.append("  → Make sure it is listed in PLACEMENT_RULES if the other core never touches it")
         
         return problems
     
@@ -254,9 +254,94 @@ class MemoryAnalyzer:
             print("   // Access with atomic operations:")
             print(f"   uint32_t val = __atomic_load_n(&{var_name}, __ATOMIC_SEQ_CST);")
 
+    def region_of(self, address: int) -> str:
+        """Name the RAM region holding an address"""
+        if self.SCRATCH_X_START <= address < self.SCRATCH_X_END:
+            return "scratch_x"
+        if self.SCRATCH_Y_START <= address < self.SCRATCH_Y_END:
+            return "scratch_y"
+        if self.STRIPED_RAM_START <= address < self.STRIPED_RAM_END:
+            return "main"
+        return "other"
+
+    def load_symbols(self) -> dict:
+        """Map symbol names to addresses, folding GCC's '.N' suffix on function statics"""
+        symbols = {}
+        for line in self.run_command(['arm-none-eabi-nm', self.elf_file]).splitlines():
+            parts = line.split()
+            if len(parts) >= 3:
+                name = re.sub(r'\.\d+$', '', parts[2])
+                symbols.setdefault(name, int(parts[0], 16))
+        return symbols
+
+    def check_rules(self) -> int:
+        """Check every PLACEMENT_RULES entry and the scratch bank headroom"""
+        symbols = self.load_symbols()
+        failures = 0
+
+        print(f"Placement rules: {self.elf_file}")
+        for name, expected in PLACEMENT_RULES:
+            address = symbols.get(name)
+            if address is None:
+                print(f"  MISSING  {name} (expected in {expected})")
+                failures += 1
+                continue
+            region = self.region_of(address)
+            status = "ok" if region == expected else "WRONG"
+            if region != expected:
+                failures += 1
+            print(f"  {status:8} {name:28} 0x{address:08x} {region} (expected {expected})")
+
+        # Scratch data grows up from the bank start, the core stack down from its end
+        for bank, data_end, stack_bottom in (("scratch_x", "__scratch_x_end__", "__StackOneBottom"),
+                                             ("scratch_y", "__scratch_y_end__", "__StackBottom")):
+            if data_end in symbols and stack_bottom in symbols:
+                headroom = symbols[stack_bottom] - symbols[data_end]
+                print(f"  {bank}: {headroom} bytes between data and stack")
+                if headroom < 0:
+                    failures += 1
+
+        print(f"{failures} placement violation(s)")
+        return failures
+
+
+# Where each hot variable must live. Core-private data sits in its core's
+# scratch bank (core 1: scratch_x, core 0: scratch_y); data shared between
+# the cores and every DMA buffer stays in striped main SRAM.
+PLACEMENT_RULES = [
+    # Core 1: keypad, ADC and output tasks
+    ("keypad_matrix", "scratch_x"),
+    ("keypad_matrix_loaded", "scratch_x"),
+    ("adc_states", "scratch_x"),
+    ("adc_channel_primed", "scratch_x"),
+    ("adc_axes", "scratch_x"),
+    ("output_buses", "scratch_x"),
+    ("output_drivers", "scratch_x"),
+    ("display_anims", "scratch_x"),
+    ("default_output_bank", "scratch_x"),
+    # Core 0: direct input interrupts and the TinyUSB device task
+    ("direct_inputs", "scratch_y"),
+    # Shared between the cores
+    ("statistics_counters", "main"),
+    ("keypad_copies", "main"),
+    ("adc_copies", "main"),
+    ("direct_events_queued", "main"),
+    ("direct_events_dequeued", "main"),
+    ("slack_histogram", "main"),
+    # Kept across resets, in main SRAM outside .bss
+    ("black_box", "main"),
+    # DMA buffers
+    ("scan_table", "main"),
+    ("scan_frames", "main"),
+]
+
 def main():
+    if len(sys.argv) == 3 and sys.argv[1] == "--rules":
+        sys.exit(1 if MemoryAnalyzer(sys.argv[2]).check_rules() else 0)
+
     if len(sys.argv) != 3:
         print("Usage: python3 check_placement.py <elf_file> <variable_name>")
+        print("       python3 check_placement.py --rules <elf_file>")
         sys.exit(1)
     
     elf_file = sys.argv[1]
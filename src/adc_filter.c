@@ -0,0 +1,46 @@
+/**
+ * @file adc_filter.c
+ * @brief Moving-average filter of the ADC axes.
+ */
+
+#include "adc_filter.h"
+
+#include <string.h>
+
+// Keep the mask/shift optimisation below valid: tap count must be a power of two.
+_Static_assert((ADC_NUM_TAPS & (ADC_NUM_TAPS - 1U)) == 0U,
+               "ADC_NUM_TAPS must be a power of two for the mask/shift filter");
+_Static_assert((1U << ADC_NUM_TAPS_SHIFT) == ADC_NUM_TAPS,
+               "ADC_NUM_TAPS_SHIFT must equal log2(ADC_NUM_TAPS)");
+
+void adc_filter_reset(adc_states_t *states)
+{
+	(void)memset(states, 0, sizeof(*states));
+}
+
+uint16_t adc_filter_update(adc_states_t *states, uint8_t channel, uint16_t raw)
+{
+	uint16_t *samples = states->adc_sample_value[channel];
+
+	if (!states->primed[channel])
+	{
+		for (uint8_t j = 0U; j < ADC_NUM_TAPS; j++)
+		{
+			samples[j] = raw;
+		}
+		states->adc_sum_values[channel] = (uint32_t)raw * (uint32_t)ADC_NUM_TAPS;
+		states->samples_index[channel] = 0U;
+		states->adc_previous_value[channel] = raw;
+		states->primed[channel] = true;
+	}
+
+	// Remove old sample and add the new one to the sum
+	states->adc_sum_values[channel] -= samples[states->samples_index[channel]];
+	states->adc_sum_values[channel] += raw;
+	samples[states->samples_index[channel]] = raw;
+
+	// Advance the circular index with a bitmask (Cortex-M0+ lacks HW divide).
+	states->samples_index[channel] = (uint16_t)((states->samples_index[channel] + 1U) & (ADC_NUM_TAPS - 1U));
+
+	return (uint16_t)(states->adc_sum_values[channel] >> ADC_NUM_TAPS_SHIFT);
+}
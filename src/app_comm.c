@@ -12,10 +12,21 @@
 #include "queue.h"
 #include "task.h"
 
+#include <pico/time.h>
+
 #include "cobs.h"
 #include "commands.h"
 #include "error_management.h"
+#include "app_inputs.h"
 #include "app_outputs.h"
+#include "app_profiles.h"
+#include "app_scenes.h"
+#include "black_box.h"
+#include "idle_work.h"
+#include "input_dump.h"
+#include "input_state.h"
+#include "output_commit.h"
+#include "usb_sof.h"
 
 #include "app_config.h"
 #include "app_context.h"
@@ -33,6 +44,21 @@ void tud_cdc_line_state_cb(uint8_t itf, bool dtr, bool rts)
 	app_context_set_line_state(dtr, rts);
 }
 
+/**
+ * @brief Callback invoked by the TinyUSB device stack on every start-of-frame.
+ *
+ * Enabled with @c tud_sof_cb_enable() and, like @ref tud_cdc_rx_cb, runs in
+ * the context of @ref cdc_task, which is the highest priority task on its
+ * core, so the timestamp trails the SOF interrupt by the task switch only.
+ *
+ * @param[in] frame_count USB frame number (unused).
+ */
+void tud_sof_cb(uint32_t frame_count)
+{
+	(void)frame_count;
+	usb_sof_on_frame(time_us_32());
+}
+
 /**
  * @brief Callback invoked by the TinyUSB device stack when new CDC bytes are
  *        available in the RX FIFO.
@@ -99,6 +125,218 @@ static inline void send_status(uint8_t index)
 	app_comm_send_packet(BOARD_ID, PC_ERROR_STATUS_CMD, data, sizeof(data));
 }
 
+/**
+ * @brief Send one bucket of the flush-to-SOF slack histogram to the host.
+ *
+ * @param[in] bucket Histogram bucket index.
+ */
+static void send_sof_status(uint8_t bucket)
+{
+	uint8_t data[5] = {0U, 0U, 0U, 0U, 0U};
+
+	if (bucket >= (uint8_t)USB_SOF_SLACK_BUCKETS)
+	{
+		data[0] = INVALID_SOF_BUCKET;
+		app_comm_send_packet(BOARD_ID, PC_USBSTATUS_CMD, data, 1U);
+	}
+	else
+	{
+		const uint32_t count = usb_sof_slack_count(bucket);
+		data[0] = bucket;
+		data[1] = (uint8_t)((count >> 24U) & 0xFFU);
+		data[2] = (uint8_t)((count >> 16U) & 0xFFU);
+		data[3] = (uint8_t)((count >> 8U) & 0xFFU);
+		data[4] = (uint8_t)(count & 0xFFU);
+		app_comm_send_packet(BOARD_ID, PC_USBSTATUS_CMD, data, sizeof(data));
+	}
+}
+
+/**
+ * @brief Store a 32-bit value big-endian.
+ */
+static inline void put_u32(uint8_t *out, uint32_t value)
+{
+	out[0] = (uint8_t)((value >> 24U) & 0xFFU);
+	out[1] = (uint8_t)((value >> 16U) & 0xFFU);
+	out[2] = (uint8_t)((value >> 8U) & 0xFFU);
+	out[3] = (uint8_t)(value & 0xFFU);
+}
+
+/**
+ * @brief Send one item of the black box left by the previous run.
+ *
+ * @param[in] section Item kind (@ref black_box_section_t).
+ * @param[in] index   Item index within the section.
+ */
+static void send_black_box(uint8_t section, uint8_t index)
+{
+	const black_box_report_t *report = black_box_previous();
+	const black_box_snapshot_t *snapshot = &report->snapshot;
+	uint8_t data[12] = {0};
+	uint8_t length = 0U;
+
+	data[0] = section;
+	data[1] = index;
+	switch (section)
+	{
+	case BLACK_BOX_SECTION_SUMMARY:
+		data[1] = (uint8_t)((report->valid ? 0x01U : 0x00U) | (report->snapshot_valid ? 0x02U : 0x00U));
+		put_u32(&data[2], report->boot_count);
+		data[6] = report->records;
+		length = 7U;
+		break;
+	case BLACK_BOX_SECTION_TRACE:
+		if (index < report->records)
+		{
+			const black_box_record_t *record = &report->trace[index];
+			put_u32(&data[2], record->time_us);
+			data[6] = record->event;
+			data[7] = record->arg;
+			data[8] = (uint8_t)(record->value >> 8U);
+			data[9] = (uint8_t)(record->value & 0xFFU);
+			length = 10U;
+		}
+		break;
+	case BLACK_BOX_SECTION_QUEUES:
+		if (report->snapshot_valid && (0U == index))
+		{
+			put_u32(&data[2], snapshot->uptime_ms);
+			for (uint8_t q = 0U; q < (uint8_t)BLACK_BOX_QUEUES; q++)
+			{
+				data[6U + (2U * q)] = (uint8_t)(snapshot->queue_depth[q] >> 8U);
+				data[7U + (2U * q)] = (uint8_t)(snapshot->queue_depth[q] & 0xFFU);
+			}
+			length = 12U;
+		}
+		break;
+	case BLACK_BOX_SECTION_HEARTBEAT:
+		if (report->snapshot_valid && (index < (uint8_t)NUM_TASKS))
+		{
+			put_u32(&data[2], snapshot->heartbeat[index]);
+			length = 6U;
+		}
+		break;
+	case BLACK_BOX_SECTION_SLACK:
+		if (report->snapshot_valid && (index < (uint8_t)USB_SOF_SLACK_BUCKETS))
+		{
+			put_u32(&data[2], snapshot->slack_histogram[index]);
+			length = 6U;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (0U == length)
+	{
+		data[0] = INVALID_BLACK_BOX_ITEM;
+		length = 1U;
+	}
+	app_comm_send_packet(BOARD_ID, PC_DEBUG_CMD, data, length);
+}
+
+/**
+ * @brief Send one item of the output bus lock profile.
+ *
+ * @param[in] section Item kind (@ref bus_profile_section_t).
+ * @param[in] entry   Profile entry (slot, bus or operation).
+ * @param[in] index   Histogram bucket for the histogram sections.
+ */
+static void send_bus_profile(uint8_t section, uint8_t entry, uint8_t index)
+{
+	bus_profile_t profile;
+	uint8_t data[14] = {0};
+	uint8_t length = 0U;
+	const bool valid = output_bus_profile(entry, &profile);
+
+	data[0] = section;
+	data[1] = entry;
+	switch (section)
+	{
+	case BUS_PROFILE_SECTION_SUMMARY:
+		if (valid)
+		{
+			put_u32(&data[2], profile.locks);
+			put_u32(&data[6], profile.contended);
+			put_u32(&data[10], profile.timeouts);
+			length = 14U;
+		}
+		break;
+	case BUS_PROFILE_SECTION_MAXIMA:
+		if (valid)
+		{
+			put_u32(&data[2], profile.wait_max_us);
+			put_u32(&data[6], profile.hold_max_us);
+			length = 10U;
+		}
+		break;
+	case BUS_PROFILE_SECTION_WAIT:
+	case BUS_PROFILE_SECTION_HOLD:
+		if (valid && (index < (uint8_t)BUS_PROFILE_BUCKETS))
+		{
+			data[2] = index;
+			put_u32(&data[3], (BUS_PROFILE_SECTION_WAIT == section) ? profile.wait[index] : profile.hold[index]);
+			length = 7U;
+		}
+		break;
+	case BUS_PROFILE_SECTION_RESET:
+		output_bus_profile_reset();
+		length = 2U;
+		break;
+	default:
+		break;
+	}
+
+	if (0U == length)
+	{
+		data[0] = INVALID_BUS_PROFILE_ITEM;
+		length = 1U;
+	}
+	app_comm_send_packet(BOARD_ID, PC_DEBUG_CTL1_CMD, data, length);
+}
+
+/**
+ * @brief Send the device clock and the timed output counters.
+ *
+ * Sent as close as possible to the request, so the host can pair the clock
+ * with half the round trip.
+ */
+static void send_commit_clock(void)
+{
+	uint8_t data[10] = {0};
+	uint8_t staged = 0U;
+	uint32_t late = 0U;
+
+	output_commit_counters(&staged, &late);
+	data[0] = TIMED_CMD_CLOCK;
+	put_u32(&data[1], time_us_32());
+	data[5] = staged;
+	put_u32(&data[6], late);
+	app_comm_send_packet(BOARD_ID, PC_TIMED_OUTPUT_CMD, data, (uint8_t)sizeof(data));
+}
+
+/**
+ * @brief Send the complete input state as back-to-back dump frames.
+ *
+ * All parts are queued from one snapshot, so they describe the same scans
+ * and leave in the same USB flush.
+ *
+ * @param[in] tag Request tag, echoed in every part.
+ */
+static void send_state_dump(uint8_t tag)
+{
+	input_state_t state;
+	uint8_t data[INPUT_DUMP_MAX_PAYLOAD];
+	const uint32_t uptime_ms = (uint32_t)(((uint64_t)xTaskGetTickCount() * 1000U) / configTICK_RATE_HZ);
+
+	input_state_read(&state);
+	for (uint8_t part = 0U; part < (uint8_t)INPUT_DUMP_PARTS; part++)
+	{
+		const uint8_t length = input_dump_encode(&state, uptime_ms, tag, part, data);
+		app_comm_send_packet(BOARD_ID, PC_STATE_DUMP_CMD, data, length);
+	}
+}
+
 /**
  * @brief Sends the heap usage (high watermark) of each task to the host.
  *
@@ -109,7 +347,7 @@ static void send_heap_status(uint8_t index)
 	uint8_t data[13] = {0};
 	bool done = false;
 
-	if (index > (uint8_t)NUM_TASKS)
+	if (index > (uint8_t)(NUM_TASKS + IDLE_WORK_CORES))
 	{
 		data[0] = INVALID_TASK_INDEX;
 		app_comm_send_packet(BOARD_ID, PC_TASK_STATUS_CMD, data, 1U);
@@ -143,6 +381,20 @@ static void send_heap_status(uint8_t index)
 
 			app_comm_send_packet(BOARD_ID, PC_TASK_STATUS_CMD, data, sizeof(data));
 		}
+		else if (index > (uint8_t)NUM_TASKS)
+		{
+			// Idle time of one core; the host divides the idle delta by the time delta
+			idle_work_stats_t stats = {0};
+			const uint32_t now_us = time_us_32();
+			idle_work_stats((uint8_t)(index - NUM_TASKS - 1U), now_us, &stats);
+
+			data[0] = index;
+			put_u32(&data[1], now_us);
+			put_u32(&data[5], stats.idle_us);
+			put_u32(&data[9], stats.passes);
+
+			app_comm_send_packet(BOARD_ID, PC_TASK_STATUS_CMD, data, sizeof(data));
+		}
 		else
 		{
 			data[0] = index;
@@ -287,10 +539,12 @@ void app_comm_process_inbound(const uint8_t *rx_buffer, size_t length)
 
 	if (!done)
 	{
+		black_box_trace(BLACK_BOX_EVENT_RX_PACKET, cmd, len);
+
 		switch (cmd)
 		{
 		case PC_LEDOUT_CMD:
-			if (led_out(decoded_data, len) != OUTPUT_OK)
+			if (output_post(OUTPUT_BUS_OP_LED, decoded_data, len) != OUTPUT_OK)
 			{
 				statistics_increment_counter(LED_OUT_ERROR);
 			}
@@ -302,7 +556,7 @@ void app_comm_process_inbound(const uint8_t *rx_buffer, size_t length)
 
 		case PC_DPYCTL_CMD:
 		{
-			const output_result_t result = display_out(decoded_data, len);
+			const output_result_t result = output_post(OUTPUT_BUS_OP_DISPLAY, decoded_data, len);
 			if (result != OUTPUT_OK)
 			{
 				statistics_increment_counter(DISPLAY_OUT_ERROR);
@@ -310,6 +564,38 @@ void app_comm_process_inbound(const uint8_t *rx_buffer, size_t length)
 		}
 		break;
 
+		case PC_SCENE_CMD:
+			if (scene_process_command(decoded_data, len) != SCENE_OK)
+			{
+				statistics_increment_counter(SCENE_ERROR);
+			}
+			break;
+
+		case PC_TIMED_OUTPUT_CMD:
+			if ((len >= 1U) && (TIMED_CMD_CLOCK == decoded_data[0]))
+			{
+				send_commit_clock();
+			}
+			else if (output_commit_process_command(decoded_data, len) != OUTPUT_COMMIT_OK)
+			{
+				statistics_increment_counter(TIMED_OUTPUT_ERROR);
+			}
+			break;
+
+		case PC_CONFIG_CMD:
+			if (profile_process_command(decoded_data, len) != PROFILE_OK)
+			{
+				statistics_increment_counter(PROFILE_ERROR);
+			}
+			break;
+
+		case PC_STATE_DELTA_CMD:
+			if ((len < 1U) || (input_set_report_mode(decoded_data[0]) != INPUT_OK))
+			{
+				statistics_increment_counter(MSG_MALFORMED_ERROR);
+			}
+			break;
+
 		case PC_ECHO_CMD:
 			app_comm_send_packet(rxID, cmd, decoded_data, len);
 			break;
@@ -322,6 +608,44 @@ void app_comm_process_inbound(const uint8_t *rx_buffer, size_t length)
 			send_heap_status(decoded_data[0]);
 			break;
 
+		case PC_USBSTATUS_CMD:
+			send_sof_status(decoded_data[0]);
+			break;
+
+		case PC_DEBUG_CMD:
+			if (len < 2U)
+			{
+				statistics_increment_counter(MSG_MALFORMED_ERROR);
+			}
+			else
+			{
+				send_black_box(decoded_data[0], decoded_data[1]);
+			}
+			break;
+
+		case PC_DEBUG_CTL1_CMD:
+			if (len < 2U)
+			{
+				statistics_increment_counter(MSG_MALFORMED_ERROR);
+			}
+			else
+			{
+				// The bucket byte is optional; the buffer is zero-filled
+				send_bus_profile(decoded_data[0], decoded_data[1], decoded_data[2]);
+			}
+			break;
+
+		case PC_STATE_DUMP_CMD:
+			if (len < 1U)
+			{
+				statistics_increment_counter(MSG_MALFORMED_ERROR);
+			}
+			else
+			{
+				send_state_dump(decoded_data[0]);
+			}
+			break;
+
 		default:
 			statistics_increment_counter(UNKNOWN_CMD_ERROR);
 			break;
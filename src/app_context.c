@@ -72,6 +72,7 @@ void app_context_reset_task_props(void)
 	for (uint32_t i = 0; i < (uint32_t)NUM_TASKS; i++)
 	{
 		s_app_context.task_props[i].high_watermark = 0U;
+		s_app_context.task_props[i].heartbeat = 0U;
 		s_app_context.task_props[i].task_handle = NULL;
 	}
 }
@@ -12,20 +12,32 @@
  *   (c) 2020-2025 Carlos Mazzei. All rights reserved.
  */
 
+#include <stdatomic.h>
 #include <string.h>
 
+#include "adc_filter.h"
 #include "app_inputs.h"
 #include "commands.h"
 #include "data_event.h"
 #include "error_management.h"
 #include <hardware/watchdog.h>
+#include <pico/stdlib.h>
 #include "task_props.h"
 #include "app_context.h"
+#include "direct_input.h"
+#include "input_delta.h"
+#include "input_state.h"
+#include "keypad_matrix.h"
+#include "keypad_scan.h"
+#include "mem_placement.h"
+
+_Static_assert((KEYPAD_TASK_CORE_AFFINITY == CORE_1_AFFINITY) && (ADC_READ_TASK_CORE_AFFINITY == CORE_1_AFFINITY),
+               "keypad and ADC state is placed in the core 1 scratch bank");
 
 /**
- * @brief Input configuration instance (module scope).
+ * @brief Compile-time default input configuration.
  */
-static input_config_t input_config = {
+static const input_config_t input_config_defaults = {
 	.columns                  = 8,
 	.rows                     = 8,
 	.key_settling_time_ms     = 2,
@@ -47,34 +59,252 @@ static input_config_t input_config = {
 };
 
 /**
- * @brief State array for each key in the keypad matrix.
+ * @brief Profile built from @ref input_config_defaults by @ref input_init().
+ */
+static input_profile_t default_profile;
+
+/**
+ * @brief Profile read by the scan tasks.
+ *
+ * Only published once fully prepared; each task latches it at the start of
+ * a scan cycle.
+ */
+static _Atomic(const input_profile_t *) active_profile = &default_profile;
+
+/**
+ * @brief Profiles latched by the keypad and ADC tasks for their current scan.
+ */
+static _Atomic(const input_profile_t *) keypad_scan_profile = NULL;
+static _Atomic(const input_profile_t *) adc_scan_profile = NULL;
+
+/**
+ * @brief Latch the active profile for one scan cycle.
+ *
+ * The latched pointer is published before it is used and the active pointer
+ * is re-read afterwards, so @ref input_profile_in_use() never misses a
+ * profile a task is about to read.
+ *
+ * @param[out] scan_profile Per-task latch slot.
+ *
+ * @return Profile to use for the whole scan cycle.
+ */
+static const input_profile_t *latch_active_profile(_Atomic(const input_profile_t *) *scan_profile)
+{
+	const input_profile_t *profile = atomic_load(&active_profile);
+	atomic_store(scan_profile, profile);
+
+	while (profile != atomic_load(&active_profile))
+	{
+		profile = atomic_load(&active_profile);
+		atomic_store(scan_profile, profile);
+	}
+
+	return profile;
+}
+
+/**
+ * @brief Report mode selected by the host (@ref INPUT_REPORT_EVENTS or @ref INPUT_REPORT_DELTA).
+ */
+static _Atomic uint8_t report_mode = INPUT_REPORT_EVENTS;
+
+/**
+ * @brief GPIO of each direct input.
+ */
+static const uint8_t direct_input_pins[DIRECT_INPUT_COUNT] = DIRECT_INPUT_PINS;
+
+/**
+ * @brief Debounce state of the direct inputs (GPIO and alarm interrupts on core 0).
+ */
+static direct_input_state_t direct_inputs[DIRECT_INPUT_COUNT] CORE0_PRIVATE_DATA(direct_inputs);
+
+/**
+ * @brief Direct input events queued so far (written by the GPIO/alarm interrupts only).
+ */
+static volatile uint32_t direct_events_queued = 0U;
+
+/**
+ * @brief Direct input events dequeued so far (written by the outbound task only).
  */
-static uint8_t keypad_state[KEYPAD_ROWS * KEYPAD_COLUMNS];
+static volatile uint32_t direct_events_dequeued = 0U;
+
+/**
+ * @brief Debounce and encoder state fed by the keypad scan frames.
+ *
+ * Updated by the scan DMA interrupt, which runs on the keypad task's core;
+ * the keypad task resets and reads it inside critical sections.
+ */
+static keypad_matrix_t keypad_matrix CORE1_PRIVATE_DATA(keypad_matrix);
+
+/**
+ * @brief Set once the keypad task has loaded @ref keypad_matrix from a profile.
+ */
+static bool keypad_matrix_loaded CORE1_PRIVATE_DATA(keypad_matrix_loaded) = false;
+
+/**
+ * @brief Populate the encoder skip table of a profile from its encoder map.
+ *
+ * @param[in,out] profile Profile whose @ref input_profile_t::encoder_skip is rebuilt.
+ */
+static void build_encoder_skip(input_profile_t *profile)
+{
+	const input_config_t *config = &profile->config;
+
+	(void)memset(profile->encoder_skip, 0, sizeof(profile->encoder_skip));
+	for (uint8_t i = 0U; i < config->num_encoders; i++)
+	{
+		if (config->encoder_map[i].enabled)
+		{
+			uint8_t r = config->encoder_map[i].row;
+			uint8_t c = config->encoder_map[i].col;
+			profile->encoder_skip[r][c] = true;
+			profile->encoder_skip[r][c + 1U] = true;
+		}
+	}
+}
+
+/**
+ * @brief Queue a direct input event from interrupt context.
+ *
+ * The event goes to the front of the data event queue, ahead of bulk ADC
+ * traffic, unless an earlier direct event is still queued: then it goes to
+ * the back so a press is never overtaken by its own release.
+ *
+ * @param[in]     index   Direct input index.
+ * @param[in]     pressed New state.
+ * @param[in,out] woken   Set when a higher-priority task was unblocked.
+ */
+static void direct_input_post(uint8_t index, bool pressed, BaseType_t *woken)
+{
+	QueueHandle_t queue = app_context_get_data_event_queue();
+
+	if (NULL != queue)
+	{
+		data_events_t key_event;
+		key_event.command = PC_KEY_CMD;
+		key_event.data[0] = direct_input_key_code(index, pressed);
+		key_event.data_length = 1U;
+
+		const BaseType_t queued = (direct_events_queued == direct_events_dequeued) ?
+		                          xQueueSendToFrontFromISR(queue, &key_event, woken) :
+		                          xQueueSendToBackFromISR(queue, &key_event, woken);
+		if (pdPASS == queued)
+		{
+			direct_events_queued++;
+		}
+		else
+		{
+			statistics_increment_counter(INPUT_QUEUE_FULL_ERROR);
+		}
+	}
+}
 
 /**
- * @brief Per-position lookup indicating which matrix cells are mapped to encoders.
+ * @brief Alarm callback that closes a direct input's lockout window.
  *
- * Built by @ref build_encoder_skip() from @ref input_config during @ref input_init().
- * The keypad task consults this array to skip encoder-mapped positions.
+ * @param[in] id        Alarm identifier (unused).
+ * @param[in] user_data Direct input index.
+ *
+ * @return Lockout period to run again when a change was reported, else 0.
  */
-static bool encoder_skip[KEYPAD_ROWS][KEYPAD_COLUMNS];
+static int64_t direct_input_lockout_cb(alarm_id_t id, void *user_data)
+{
+	(void)id;
+	const uint8_t index = (uint8_t)(uintptr_t)user_data;
+	const bool pressed = !gpio_get(direct_input_pins[index]); // Active low pin
+	BaseType_t woken = pdFALSE;
+	int64_t reschedule_us = 0;
+
+	if (direct_input_lockout_end(&direct_inputs[index], pressed, time_us_32()))
+	{
+		direct_input_post(index, pressed, &woken);
+		reschedule_us = (int64_t)DIRECT_INPUT_LOCKOUT_US;
+	}
+
+	portYIELD_FROM_ISR(woken);
+	return reschedule_us;
+}
 
 /**
- * @brief Populate @ref encoder_skip from the current encoder map configuration.
+ * @brief GPIO interrupt handler for the direct inputs.
+ *
+ * Timestamps the edge first; the event is queued before returning.
+ *
+ * @param[in] gpio   Pin that raised the interrupt.
+ * @param[in] events GPIO_IRQ_EDGE_* flags latched for @p gpio.
  */
-static void build_encoder_skip(void)
+static void direct_input_irq(uint gpio, uint32_t events)
 {
-	(void)memset(encoder_skip, 0, sizeof(encoder_skip));
-	for (uint8_t i = 0U; i < input_config.num_encoders; i++)
+	const uint32_t now_us = time_us_32();
+	BaseType_t woken = pdFALSE;
+
+	for (uint8_t i = 0U; i < (uint8_t)DIRECT_INPUT_COUNT; i++)
 	{
-		if (input_config.encoder_map[i].enabled)
+		if (gpio != direct_input_pins[i])
 		{
-			uint8_t r = input_config.encoder_map[i].row;
-			uint8_t c = input_config.encoder_map[i].col;
-			encoder_skip[r][c] = true;
-			encoder_skip[r][c + 1U] = true;
+			continue;
+		}
+
+		// A single latched edge tells the new level; with both, read the pin
+		bool pressed = (0U != (events & GPIO_IRQ_EDGE_FALL));
+		if ((0U != (events & GPIO_IRQ_EDGE_FALL)) && (0U != (events & GPIO_IRQ_EDGE_RISE)))
+		{
+			pressed = !gpio_get(gpio);
+		}
+
+		if (direct_input_edge(&direct_inputs[i], pressed, now_us))
+		{
+			direct_input_post(i, pressed, &woken);
+			// Without the alarm the window still closes at the next edge
+			(void)add_alarm_in_us(DIRECT_INPUT_LOCKOUT_US, direct_input_lockout_cb, (void *)(uintptr_t)i, true);
 		}
 	}
+
+	portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Configure the direct input pins and enable their edge interrupts.
+ *
+ * Every input starts inside a lockout window, so a button held at boot is
+ * reported as pressed once the window closes.
+ */
+static void direct_input_init(void)
+{
+	const uint32_t now_us = time_us_32();
+
+	for (uint8_t i = 0U; i < (uint8_t)DIRECT_INPUT_COUNT; i++)
+	{
+		gpio_set_irq_enabled(direct_input_pins[i], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, false);
+	}
+
+	// The event queue was just created empty
+	direct_events_queued = 0U;
+	direct_events_dequeued = 0U;
+
+	for (uint8_t i = 0U; i < (uint8_t)DIRECT_INPUT_COUNT; i++)
+	{
+		const uint8_t pin = direct_input_pins[i];
+
+		gpio_init(pin);
+		gpio_set_dir(pin, false);
+		gpio_pull_up(pin);
+
+		direct_inputs[i].pressed = false;
+		direct_inputs[i].edge_us = now_us;
+		direct_inputs[i].locked = true;
+		(void)add_alarm_in_us(DIRECT_INPUT_LOCKOUT_US, direct_input_lockout_cb, (void *)(uintptr_t)i, true);
+
+		// One callback per core serves every pin; runs on the core calling input_init()
+		gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &direct_input_irq);
+	}
+}
+
+void input_event_dequeued(const data_events_t *event)
+{
+	if ((PC_KEY_CMD == event->command) && direct_input_is_key_code(event->data[0]))
+	{
+		direct_events_dequeued++;
+	}
 }
 
 /**
@@ -156,15 +386,15 @@ input_result_t input_init(void)
 	}
 	app_context_set_data_event_queue(data_queue);
 
-	if (!check_config_params(&input_config))
+	default_profile.config = input_config_defaults;
+	if (INPUT_OK != input_prepare_profile(&default_profile))
 	{
 		result = INPUT_INVALID_CONFIG;
 	}
 	else
 	{
-		// Initialize keypad configuration
-		(void)memset(keypad_state, 0, sizeof(keypad_state));
-		build_encoder_skip();
+		atomic_store(&active_profile, &default_profile);
+		input_state_reset();
 
 		// Setup IO pins using gpio_init_mask to configure multiple pins at once
 		uint32_t gpio_mask = ((1UL << KEYPAD_COL_MUX_A) |
@@ -188,83 +418,157 @@ input_result_t input_init(void)
 
 		adc_init(); // ADC init
 		adc_gpio_init(26); // Make sure GPIO is high-impedance, no pullups etc
+
+		direct_input_init();
 	}
 
 	return result;
 }
 
-bool input_is_encoder_position(uint8_t row, uint8_t col)
+const input_config_t *input_default_config(void)
 {
-	return encoder_skip[row][col];
+	return &input_config_defaults;
 }
 
-/**
- * @brief Control the chip select (CS) for the keypad row multiplexer.
- *
- * @param[in] select `true` to enable the row bank (active low).
- */
-static inline void keypad_cs_rows(bool select)
+input_result_t input_config_set_field(input_config_t *config, uint8_t field, uint16_t value)
 {
-	gpio_put(KEYPAD_ROW_MUX_CS, !select); // Active low pin
+	input_result_t result = INPUT_OK;
+	const bool fits_byte = (value <= UINT8_MAX);
+
+	if (NULL == config)
+	{
+		result = INPUT_INVALID_CONFIG;
+	}
+	else
+	{
+		switch (field)
+		{
+		case INPUT_FIELD_ROWS:
+			config->rows = (uint8_t)value;
+			result = fits_byte ? INPUT_OK : INPUT_INVALID_CONFIG;
+			break;
+		case INPUT_FIELD_COLUMNS:
+			config->columns = (uint8_t)value;
+			result = fits_byte ? INPUT_OK : INPUT_INVALID_CONFIG;
+			break;
+		case INPUT_FIELD_KEY_SETTLING_TIME_MS:
+			config->key_settling_time_ms = value;
+			break;
+		case INPUT_FIELD_ADC_CHANNELS:
+			config->adc_channels = (uint8_t)value;
+			result = fits_byte ? INPUT_OK : INPUT_INVALID_CONFIG;
+			break;
+		case INPUT_FIELD_ADC_SETTLING_US:
+			config->adc_settling_us = value;
+			break;
+		case INPUT_FIELD_ADC_OVERSAMPLE:
+			config->adc_oversample = (uint8_t)value;
+			result = fits_byte ? INPUT_OK : INPUT_INVALID_CONFIG;
+			break;
+		case INPUT_FIELD_ADC_HYSTERESIS:
+			config->adc_hysteresis = value;
+			break;
+		case INPUT_FIELD_ADC_SCAN_INTERVAL_MS:
+			config->adc_scan_interval_ms = value;
+			break;
+		case INPUT_FIELD_NUM_ENCODERS:
+			config->num_encoders = (uint8_t)value;
+			result = fits_byte ? INPUT_OK : INPUT_INVALID_CONFIG;
+			break;
+		case INPUT_FIELD_COL_MUX_SETTLING_US:
+			config->col_mux_settling_us = value;
+			break;
+		case INPUT_FIELD_ROW_MUX_SETTLING_US:
+			config->row_mux_settling_us = value;
+			break;
+		case INPUT_FIELD_ADC_CHANNEL_MASK:
+			config->adc_channel_mask = value;
+			break;
+		default:
+			result = INPUT_INVALID_CONFIG;
+			break;
+		}
+	}
+
+	return result;
 }
 
-/**
- * @brief Control the chip select (CS) for the keypad column multiplexer.
- *
- * @param[in] select `true` to enable the column bank (active high).
- */
-static inline void keypad_cs_columns(bool select)
+input_result_t input_prepare_profile(input_profile_t *profile)
+{
+	input_result_t result = INPUT_OK;
+
+	if ((NULL == profile) || !check_config_params(&profile->config))
+	{
+		result = INPUT_INVALID_CONFIG;
+	}
+	else
+	{
+		build_encoder_skip(profile);
+	}
+
+	return result;
+}
+
+input_result_t input_set_active_profile(const input_profile_t *profile)
 {
-	gpio_put(KEYPAD_COL_MUX_CS, select); // Active high pin
+	input_result_t result = INPUT_OK;
+
+	if (NULL == profile)
+	{
+		result = INPUT_INVALID_CONFIG;
+	}
+	else
+	{
+		atomic_store(&active_profile, profile);
+	}
+
+	return result;
 }
 
-/**
- * @brief Convert keypad row/column coordinates into a 1D index.
- *
- * @param[in] row    Row index to encode.
- * @param[in] column Column index to encode.
- *
- * @return Linear index into @ref keypad_state.
- */
-static inline uint8_t keypad_index(uint8_t row, uint8_t column)
+bool input_profile_in_use(const input_profile_t *profile)
 {
-	return (uint8_t)(column * input_config.rows) + row;
+	return (profile == atomic_load(&active_profile)) ||
+	       (profile == atomic_load(&keypad_scan_profile)) ||
+	       (profile == atomic_load(&adc_scan_profile));
 }
 
-/**
- * @brief Update the active column selection on the keypad multiplexer.
- *
- * @param[in] columns Column index to present on the multiplexer outputs.
- */
-static void keypad_set_columns(uint8_t columns)
+input_result_t input_set_report_mode(uint8_t mode)
 {
-	// Set the columns of the keypad (multiplexer control)
-	gpio_put(KEYPAD_COL_MUX_A, (columns & 0x01U) != 0U);
-	gpio_put(KEYPAD_COL_MUX_B, (columns & 0x02U) != 0U);
-	gpio_put(KEYPAD_COL_MUX_C, (columns & 0x04U) != 0U);
+	input_result_t result = INPUT_OK;
+
+	if ((INPUT_REPORT_EVENTS == mode) || (INPUT_REPORT_DELTA == mode))
+	{
+		atomic_store(&report_mode, mode);
+	}
+	else
+	{
+		result = INPUT_INVALID_CONFIG;
+	}
+
+	return result;
 }
 
-/**
- * @brief Update the active row selection on the keypad multiplexer.
- *
- * @param[in] rows Row index to present on the multiplexer outputs.
- */
-static void keypad_set_rows(uint8_t rows)
+uint8_t input_report_mode(void)
+{
+	return atomic_load(&report_mode);
+}
+
+bool input_is_encoder_position(uint8_t row, uint8_t col)
 {
-	// Set the rows of the keypad (multiplexer control)
-	gpio_put(KEYPAD_ROW_MUX_A, (rows & 0x01U) != 0U);
-	gpio_put(KEYPAD_ROW_MUX_B, (rows & 0x02U) != 0U);
-	gpio_put(KEYPAD_ROW_MUX_C, (rows & 0x04U) != 0U);
+	return atomic_load(&active_profile)->encoder_skip[row][col];
 }
 
 /**
  * @brief Enqueue a keypad event describing the transition of a single key.
  *
- * @param[in] row    Keypad row index that changed state.
- * @param[in] column Keypad column index that changed state.
- * @param[in] state  New key state, see @ref KEY_PRESSED and @ref KEY_RELEASED.
+ * Called from the keypad scan DMA interrupt.
+ *
+ * @param[in]     row    Keypad row index that changed state.
+ * @param[in]     column Keypad column index that changed state.
+ * @param[in]     state  New key state, see @ref KEY_PRESSED and @ref KEY_RELEASED.
+ * @param[in,out] woken  Set when a higher-priority task was unblocked.
  */
-static void keypad_generate_event(uint8_t row, uint8_t column, uint8_t state)
+static void keypad_generate_event(uint8_t row, uint8_t column, uint8_t state, BaseType_t *woken)
 {
 	if (NULL != app_context_get_data_event_queue())
 	{
@@ -273,7 +577,7 @@ static void keypad_generate_event(uint8_t row, uint8_t column, uint8_t state)
 		key_event.data[0] = ((column << 4U) | (row << 1U)) & 0xFEU;
 		key_event.data[0] |= state;
 		key_event.data_length = 1;
-		if (pdPASS != xQueueSend(app_context_get_data_event_queue(), &key_event, pdMS_TO_TICKS(INPUT_QUEUE_SEND_TIMEOUT_MS)))
+		if (pdPASS != xQueueSendFromISR(app_context_get_data_event_queue(), &key_event, woken))
 		{
 			statistics_increment_counter(INPUT_QUEUE_FULL_ERROR);
 		}
@@ -283,10 +587,13 @@ static void keypad_generate_event(uint8_t row, uint8_t column, uint8_t state)
 /**
  * @brief Enqueue a rotary encoder event with the detected direction.
  *
- * @param[in] rotary Encoder identifier (0-based index).
- * @param[in] direction Direction flag (`1` clockwise, `0` counter-clockwise).
+ * Called from the keypad scan DMA interrupt.
+ *
+ * @param[in]     rotary    Encoder identifier (0-based index).
+ * @param[in]     direction Direction flag (`1` clockwise, `0` counter-clockwise).
+ * @param[in,out] woken     Set when a higher-priority task was unblocked.
  */
-static void encoder_generate_event(uint8_t rotary, uint16_t direction)
+static void encoder_generate_event(uint8_t rotary, uint16_t direction, BaseType_t *woken)
 {
 	if (NULL != app_context_get_data_event_queue())
 	{
@@ -297,7 +604,7 @@ static void encoder_generate_event(uint8_t rotary, uint16_t direction)
 		encoder_event.data[0] |= rotary << 4;
 		encoder_event.data[1] |= direction;
 		encoder_event.data_length = 2;
-		if (pdPASS != xQueueSend(app_context_get_data_event_queue(), &encoder_event, pdMS_TO_TICKS(INPUT_QUEUE_SEND_TIMEOUT_MS)))
+		if (pdPASS != xQueueSendFromISR(app_context_get_data_event_queue(), &encoder_event, woken))
 		{
 			statistics_increment_counter(INPUT_QUEUE_FULL_ERROR);
 		}
@@ -305,134 +612,138 @@ static void encoder_generate_event(uint8_t rotary, uint16_t direction)
 }
 
 /**
- * @brief Quadrature lookup table used by the encoder state machine.
+ * @brief Enqueue a state-delta frame built by @ref input_delta.h.
  *
- * The four LSBs encode the previous and current A/B samples. Each entry
- * provides the detent delta (-1, 0, or +1) for that transition.
+ * @param[in] payload Frame payload.
+ * @param[in] length  Payload length (at most @ref INPUT_DELTA_MAX_PAYLOAD).
  */
-static const int8_t encoder_lut[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+static void delta_generate_event(const uint8_t *payload, uint8_t length)
+{
+	if (NULL != app_context_get_data_event_queue())
+	{
+		data_events_t delta_event;
+		delta_event.command = PC_STATE_DELTA_CMD;
+		(void)memcpy(delta_event.data, payload, length); // flawfinder: ignore
+		delta_event.data_length = length;
+		if (pdPASS != xQueueSend(app_context_get_data_event_queue(), &delta_event, pdMS_TO_TICKS(INPUT_QUEUE_SEND_TIMEOUT_MS)))
+		{
+			statistics_increment_counter(INPUT_QUEUE_FULL_ERROR);
+		}
+	}
+}
 
 /**
- * @brief Sample all enabled rotary encoders and emit rotation events.
+ * @brief Decode one keypad scan frame (DMA interrupt, see @ref keypad_scan.h).
  *
- * Called from within @ref keypad_task so keypad scanning and encoder sampling
- * share the same GPIO mux bus without contention.
+ * Debounces the keys and steps the encoders, then queues their events. Key
+ * events are only queued in @ref INPUT_REPORT_EVENTS mode; in delta mode the
+ * keypad task reports the debounced bitmap instead.
  *
- * @param[in,out] encoder_state Per-encoder quadrature state array.
+ * @param[in] frame Row line levels of every matrix position.
  */
-static void scan_encoders(encoder_states_t encoder_state[MAX_NUM_ENCODERS])
+static void keypad_scan_frame(const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS])
 {
-	for (uint8_t i = 0U; i < input_config.num_encoders; i++)
+	const uint64_t pressed = keypad_matrix_pressed(frame);
+	int8_t steps[MAX_NUM_ENCODERS] = {0};
+	uint64_t changed = 0U;
+	uint64_t keys = 0U;
+	BaseType_t woken = pdFALSE;
+
+	// The matrix is only shared with keypad_task on this core: masking it is enough
+	const uint32_t status = save_and_disable_interrupts();
+	if (keypad_matrix_loaded)
 	{
-		if (!input_config.encoder_map[i].enabled)
-		{
-			continue;
-		}
-
-		uint8_t r = input_config.encoder_map[i].row;
-		uint8_t c = input_config.encoder_map[i].col;
-
-		/* Select row */
-		keypad_cs_rows(true);
-		keypad_set_rows(r);
-		busy_wait_us_32(input_config.row_mux_settling_us);
-
-		/* Read channel A */
-		keypad_cs_columns(true);
-		keypad_set_columns(c);
-		busy_wait_us_32(input_config.col_mux_settling_us);
-		bool ch_a = !gpio_get(KEYPAD_ROW_INPUT); /* Active low pin */
-
-		/* Read channel B */
-		keypad_set_columns(c + 1U);
-		busy_wait_us_32(input_config.col_mux_settling_us);
-		bool ch_b = !gpio_get(KEYPAD_ROW_INPUT); /* Active low pin */
-
-		keypad_cs_columns(false);
-		keypad_cs_rows(false);
-
-		/* Quadrature state machine: shift previous state, OR in new sample */
-		encoder_state[i].old_encoder <<= 2U;
-		encoder_state[i].old_encoder |= (uint8_t)(ch_a ? 1U : 0U);
-		encoder_state[i].old_encoder |= (uint8_t)((uint8_t)(ch_b ? 1U : 0U) << 1U) & 0x03U;
-		encoder_state[i].count_encoder += encoder_lut[encoder_state[i].old_encoder & 0x0FU];
+		changed = keypad_matrix_update(&keypad_matrix, pressed, steps);
+		keys = keypad_matrix.stable;
+	}
+	restore_interrupts(status);
 
-		if (4 == encoder_state[i].count_encoder)
+	if (INPUT_REPORT_EVENTS == atomic_load(&report_mode))
+	{
+		while (0U != changed)
 		{
-			encoder_generate_event(i, 1U);
-			encoder_state[i].count_encoder = 0;
+			const uint8_t bit = (uint8_t)__builtin_ctzll(changed);
+			const uint8_t state = (0U != ((keys >> bit) & 1U)) ? KEY_PRESSED : KEY_RELEASED;
+			keypad_generate_event(bit / KEYPAD_COLUMNS, bit % KEYPAD_COLUMNS, state, &woken);
+			changed &= changed - 1U;
 		}
-		if (-4 == encoder_state[i].count_encoder)
+	}
+
+	for (uint8_t i = 0U; i < MAX_NUM_ENCODERS; i++)
+	{
+		if (0 != steps[i])
 		{
-			encoder_generate_event(i, 0U);
-			encoder_state[i].count_encoder = 0;
+			encoder_generate_event(i, (steps[i] > 0) ? 1U : 0U, &woken);
 		}
 	}
+
+	portYIELD_FROM_ISR(woken);
 }
 
 void keypad_task(void *pvParameters)
 {
 	task_props_t * task_props = (task_props_t*) pvParameters;
-	encoder_states_t encoder_state[MAX_NUM_ENCODERS];
-
-	for (uint8_t i = 0U; i < MAX_NUM_ENCODERS; i++)
-	{
-		encoder_state[i].old_encoder = 0;
-		encoder_state[i].count_encoder = 0;
-	}
+	const input_profile_t *scan_profile = NULL;
+	uint8_t key_bitmap[INPUT_STATE_KEY_BYTES];
+	int32_t detents[MAX_NUM_ENCODERS];
+	uint8_t scan_mode = INPUT_REPORT_EVENTS;
+	uint8_t reported_keys[INPUT_STATE_KEY_BYTES];
+	uint8_t delta_frame[INPUT_DELTA_MAX_PAYLOAD];
 
 	while (true)
 	{
-		for (uint8_t c = 0; c < input_config.columns; c++)
-		{
-			// Select the column
-			keypad_set_columns(c);
-			keypad_cs_columns(true);
-
-			// 74HC138 propagation settling
-			busy_wait_us_32(input_config.col_mux_settling_us);
+		// Latch the profile once per cycle so a switch never splits a scan
+		const input_profile_t *profile = latch_active_profile(&keypad_scan_profile);
+		const input_config_t *config = &profile->config;
 
-			for (uint8_t r = 0; r < input_config.rows; r++)
+		if (profile != scan_profile)
+		{
+			// Matrix layout may differ: restart debounce and quadrature tracking
+			// Only the scan interrupt of this core shares the matrix: no kernel lock needed
+			const uint32_t status = save_and_disable_interrupts();
+			keypad_matrix_reset(&keypad_matrix, profile, KEYPAD_SCAN_FRAME_US);
+			keypad_matrix_loaded = true;
+			restore_interrupts(status);
+
+			keypad_scan_set_timing(config->col_mux_settling_us, config->row_mux_settling_us);
+			if (NULL == scan_profile)
 			{
-				if (encoder_skip[r][c])
-				{
-					continue; /* Skip position mapped to an encoder */
-				}
-
-				keypad_set_rows(r); // Also set the ADC channels
-				keypad_cs_rows(true);
+				// Frames are decoded in the DMA interrupt of this task's core
+				keypad_scan_start(&keypad_scan_frame);
+			}
+			scan_profile = profile;
+		}
 
-				// 74HC4051 enable settling before reading
-				busy_wait_us_32(input_config.row_mux_settling_us);
+		const uint8_t mode = atomic_load(&report_mode);
+		if (mode != scan_mode)
+		{
+			// Delta reporting starts from "all released" so held keys are reported
+			(void)memset(reported_keys, 0, sizeof(reported_keys));
+			scan_mode = mode;
+		}
 
-				uint8_t keycode = keypad_index(r, c);
-				bool pressed = !gpio_get(KEYPAD_ROW_INPUT); // Active low pin
-				keypad_state[keycode] = ((keypad_state[keycode] << 1U) & 0xFEU) | (pressed ? 1U : 0U);
+		const uint32_t status = save_and_disable_interrupts();
+		const uint64_t keys = keypad_matrix.stable;
+		(void)memcpy(detents, keypad_matrix.detents, sizeof(detents)); // flawfinder: ignore
+		restore_interrupts(status);
+		keypad_matrix_to_bytes(keys, key_bitmap);
 
-				if (KEY_PRESSED_MASK == (keypad_state[keycode] & KEYPAD_STABILITY_MASK))
-				{
-					keypad_generate_event(r, c, KEY_PRESSED);
-				}
-				if (KEY_RELEASED_MASK == (keypad_state[keycode] & KEYPAD_STABILITY_MASK))
-				{
-					keypad_generate_event(r, c, KEY_RELEASED);
-				}
-				keypad_cs_rows(false);
+		if (INPUT_REPORT_DELTA == scan_mode)
+		{
+			const uint8_t length = input_delta_encode_keys(reported_keys, key_bitmap, delta_frame);
+			if (0U != length)
+			{
+				delta_generate_event(delta_frame, length);
 			}
-
-			keypad_cs_columns(false);
-
-			/* Sample encoders between columns to keep polling rate high
-			 * (~columns / key_settling_time_ms Hz) while sharing the MUX
-			 * bus with the keypad scan without contention. */
-			scan_encoders(encoder_state);
 		}
 
-		task_props->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		input_state_publish_keypad(key_bitmap, detents, time_us_32());
+
+		task_props->heartbeat++;
 		watchdog_update();
 
-		// Scan-cycle interval: controls debounce window (window = key_settling_time_ms * required samples)
-		vTaskDelay(pdMS_TO_TICKS(input_config.key_settling_time_ms));
+		// Publish interval: frames are debounced by the interrupt as they arrive
+		vTaskDelay(pdMS_TO_TICKS(config->key_settling_time_ms));
 	}
 }
 
@@ -464,36 +775,6 @@ static void adc_generate_event(uint8_t channel, uint16_t value)
 	}
 }
 
-/**
- * @brief Calculate the moving average for an ADC channel.
- * @param[in]     channel     ADC channel index.
- * @param[in]     new_sample  New ADC sample value.
- * @param[in,out] samples     Pointer to the sample buffer for the channel.
- * @param[in,out] padc_states Pointer to the ADC states structure.
- *
- * @return The moving average value for the specified channel.
- */
-static uint16_t adc_moving_average(uint16_t channel, uint16_t new_sample, uint16_t *samples, adc_states_t *padc_states)
-{
-	// Keep the mask/shift optimisation below valid: tap count must be a power of two.
-	_Static_assert((ADC_NUM_TAPS & (ADC_NUM_TAPS - 1U)) == 0U,
-	               "ADC_NUM_TAPS must be a power of two for the mask/shift filter");
-	_Static_assert((1U << ADC_NUM_TAPS_SHIFT) == ADC_NUM_TAPS,
-	               "ADC_NUM_TAPS_SHIFT must equal log2(ADC_NUM_TAPS)");
-
-	// Remove old sample and add the new one to the sum
-	padc_states->adc_sum_values[channel] -= samples[padc_states->samples_index[channel]];
-	padc_states->adc_sum_values[channel] += new_sample;
-	samples[padc_states->samples_index[channel]] = new_sample;
-
-	// Advance the circular index with a bitmask (Cortex-M0+ lacks HW divide).
-	padc_states->samples_index[channel] =
-		(uint16_t)((padc_states->samples_index[channel] + 1U) & (ADC_NUM_TAPS - 1U));
-
-	// Return the moving average
-	return (uint16_t)(padc_states->adc_sum_values[channel] >> ADC_NUM_TAPS_SHIFT);
-}
-
 /**
  * @brief Present a new channel selection on the ADC multiplexer.
  *
@@ -528,6 +809,17 @@ static uint16_t adc_read_oversampled(uint8_t samples)
 	return (uint16_t)(sum / (uint32_t)count);
 }
 
+uint16_t adc_sample_channel(uint8_t channel, uint16_t settling_us, uint8_t oversample)
+{
+	// Select the ADC to read from
+	adc_mux_select(channel);
+
+	// Settle the mux/sample-and-hold capacitor before sampling
+	busy_wait_us_32(settling_us);
+
+	return adc_read_oversampled(oversample);
+}
+
 bool adc_should_emit(uint16_t previous, uint16_t current, uint16_t hysteresis)
 {
 	if (0U == hysteresis)
@@ -545,24 +837,16 @@ void adc_read_task(void *pvParameters)
 	/**
 	 * @brief ADC filter state exported for use by the ADC task.
 	 */
-	static adc_states_t adc_states;
-	static bool adc_channel_primed[ADC_CHANNELS];
+	static adc_states_t adc_states CORE1_PRIVATE_DATA(adc_states);
+	static uint16_t adc_axes[ADC_CHANNELS] CORE1_PRIVATE_DATA(adc_axes);
+	uint8_t scan_mode = INPUT_REPORT_EVENTS;
+	uint16_t pending_axes = 0U;
+	uint8_t delta_frame[INPUT_DELTA_MAX_PAYLOAD];
 
 	task_props_t * task_props = (task_props_t*) pvParameters;
 
 	// Initialize the ADC states
-	for (uint8_t i = 0; i < ADC_CHANNELS; i++)
-	{
-		adc_states.adc_previous_value[i] = 0;
-		adc_states.adc_sum_values[i] = 0;
-		adc_states.samples_index[i] = 0;
-		adc_channel_primed[i] = false;
-
-		for (uint8_t j = 0; j < ADC_NUM_TAPS; j++)
-		{
-			adc_states.adc_sample_value[i][j] = 0;
-		}
-	}
+	adc_filter_reset(&adc_states);
 
 	// The external 74HC4067 mux always routes the selected channel into the
 	// RP2040's ADC0 pin; the internal ADC input never changes during runtime.
@@ -570,42 +854,45 @@ void adc_read_task(void *pvParameters)
 
 	while (true)
 	{
-		for (uint8_t chan = 0; chan < input_config.adc_channels; chan++)
+		const input_config_t *config = &latch_active_profile(&adc_scan_profile)->config;
+
+		// Channels skipped by this configuration read as 0 in the snapshot
+		(void)memset(adc_axes, 0, sizeof(adc_axes));
+
+		const uint16_t scanned_axes = (uint16_t)(config->adc_channel_mask & ((1UL << config->adc_channels) - 1UL));
+		const uint8_t mode = atomic_load(&report_mode);
+		if (mode != scan_mode)
 		{
-			if (0U == ((input_config.adc_channel_mask >> chan) & 1U))
+			// Entering delta mode reports every scanned axis once
+			pending_axes = (INPUT_REPORT_DELTA == mode) ? scanned_axes : 0U;
+			scan_mode = mode;
+		}
+		const bool delta = (INPUT_REPORT_DELTA == scan_mode);
+
+		for (uint8_t chan = 0; chan < config->adc_channels; chan++)
+		{
+			if (0U == ((config->adc_channel_mask >> chan) & 1U))
 			{
 				continue;
 			}
 
-			// Select the ADC to read from
-			adc_mux_select(chan);
-
-			// Settle the mux/sample-and-hold capacitor before sampling
-			busy_wait_us_32(input_config.adc_settling_us);
+			uint16_t adc_raw = adc_sample_channel(chan, config->adc_settling_us, config->adc_oversample);
 
-			uint16_t adc_raw = adc_read_oversampled(input_config.adc_oversample);
+			// The first reading of a channel primes its window (see adc_filter.h)
+			uint16_t filtered_value = adc_filter_update(&adc_states, chan, adc_raw);
+			adc_axes[chan] = filtered_value;
 
-			// Prime the moving-average buffer on the first scan so the initial
-			// emitted value reflects reality instead of ramping from zero.
-			if (!adc_channel_primed[chan])
+			if (adc_should_emit(adc_states.adc_previous_value[chan], filtered_value, config->adc_hysteresis))
 			{
-				for (uint8_t j = 0; j < ADC_NUM_TAPS; j++)
+				if (delta)
 				{
-					adc_states.adc_sample_value[chan][j] = adc_raw;
+					pending_axes |= (uint16_t)(1U << chan);
+				}
+				else
+				{
+					adc_generate_event(chan, filtered_value);
+					adc_states.adc_previous_value[chan] = filtered_value;
 				}
-				adc_states.adc_sum_values[chan] = (uint32_t)adc_raw * (uint32_t)ADC_NUM_TAPS;
-				adc_states.samples_index[chan] = 0;
-				adc_states.adc_previous_value[chan] = adc_raw;
-				adc_channel_primed[chan] = true;
-			}
-
-			uint16_t filtered_value =
-				adc_moving_average(chan, adc_raw, adc_states.adc_sample_value[chan], &adc_states);
-
-			if (adc_should_emit(adc_states.adc_previous_value[chan], filtered_value, input_config.adc_hysteresis))
-			{
-				adc_generate_event(chan, filtered_value);
-				adc_states.adc_previous_value[chan] = filtered_value;
 			}
 			else
 			{
@@ -617,32 +904,34 @@ void adc_read_task(void *pvParameters)
 		// idle ADC line while same-priority tasks run.
 		adc_mux_select(0);
 
-		task_props->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		if (delta)
+		{
+			// A profile switch may have dropped channels flagged earlier
+			pending_axes &= scanned_axes;
+			const uint16_t flagged = pending_axes;
+			const uint8_t length = input_delta_encode_axes(&pending_axes, adc_axes, delta_frame);
+			if (0U != length)
+			{
+				delta_generate_event(delta_frame, length);
+			}
+
+			// Channels that did not fit stay pending for the next scan
+			const uint16_t reported = (uint16_t)(flagged & (uint16_t)~pending_axes);
+			for (uint8_t chan = 0U; chan < ADC_CHANNELS; chan++)
+			{
+				if (0U != ((reported >> chan) & 1U))
+				{
+					adc_states.adc_previous_value[chan] = adc_axes[chan];
+				}
+			}
+		}
+
+		input_state_publish_adc(adc_axes, time_us_32());
+
+		task_props->heartbeat++;
 		watchdog_update();
 
 		// Cooperative yield: lets same-priority tasks (keypad) run between scans
-		vTaskDelay(pdMS_TO_TICKS(input_config.adc_scan_interval_ms));
-	}
-}
-
-/**
- * @brief Set encoder enable mask (reserved for future use)
- *
- * This function is currently unused but reserved for dynamic encoder
- * enable/disable functionality. Potential use cases:
- * - Runtime configuration of active encoders
- * - Power-saving mode (disable unused encoders)
- * - Diagnostic mode (test individual encoders)
- *
- * @param[in] mask Bitmask indicating which encoders to enable (bit N = encoder N)
- *
- * @note Currently static. Can be exposed via app_inputs.h if needed.
- */
-static void encoder_set_mask(uint8_t mask)
-{
-	for (uint8_t i = 0U; i < input_config.num_encoders; i++)
-	{
-		input_config.encoder_map[i].enabled = ((mask & (1U << i)) != 0U);
+		vTaskDelay(pdMS_TO_TICKS(config->adc_scan_interval_ms));
 	}
-	build_encoder_skip();
 }
@@ -13,20 +13,35 @@
  * (c) 2020-2025 Carlos Mazzei. All rights reserved.
  */
 
+#include <stdatomic.h>
 #include <string.h>
 
 #include <hardware/pwm.h>
 #include <hardware/spi.h>
+#include <hardware/watchdog.h>
 #include <pico/binary_info.h>
 #include <pico/stdlib.h>
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
 #include "tm1639.h"
 #include "tm1637.h"
+#include "app_config.h"
 #include "app_outputs.h"
+#include "display_anim.h"
+#include "display_format.h"
 #include "error_management.h"
+#include "mem_placement.h"
+#include "output_commit.h"
+#include "task_props.h"
+#include "timer_wheel.h"
+
+_Static_assert((DECODE_RECEPTION_TASK_CORE_AFFINITY == CORE_1_AFFINITY) &&
+               (DISPLAY_REFRESH_TASK_CORE_AFFINITY == CORE_1_AFFINITY) &&
+               (OUTPUT_BUS_TASK_CORE_AFFINITY == CORE_1_AFFINITY),
+               "output driver state is placed in the core 1 scratch bank");
 
 /**
  * @brief Device configuration map for all SPI interfaces.
@@ -37,52 +52,287 @@
 static const uint8_t device_config_map[MAX_SPI_INTERFACES] = DEVICE_CONFIG;
 
 /**
- * @brief Mutex for synchronizing access to SPI operations.
+ * @brief Bus each slot is wired to, mirrors @ref OUTPUT_BUS_CONFIG.
+ */
+static const uint8_t bus_config_map[MAX_SPI_INTERFACES] = OUTPUT_BUS_CONFIG;
+
+/**
+ * @brief Payload queued for a bus worker by @ref output_post().
+ */
+typedef struct output_bus_command_t {
+	uint8_t op;                              /**< @ref OUTPUT_BUS_OP_DISPLAY or @ref OUTPUT_BUS_OP_LED. */
+	uint8_t length;                          /**< Payload length as received. */
+	uint8_t payload[OUTPUT_BUS_COMMAND_MAX]; /**< Leading payload bytes. */
+} output_bus_command_t;
+
+/**
+ * @brief One output SPI bus with its slot multiplexer, lock and worker queue.
+ */
+typedef struct output_bus_t {
+	spi_inst_t *spi;            /**< Hardware SPI block, set by @ref output_init(). */
+	uint8_t sck_pin;            /**< SPI clock GPIO. */
+	uint8_t tx_pin;             /**< SPI data GPIO. */
+	uint8_t mux_a_pin;          /**< Multiplexer select bit 0. */
+	uint8_t mux_b_pin;          /**< Multiplexer select bit 1. */
+	uint8_t mux_c_pin;          /**< Multiplexer select bit 2. */
+	uint8_t mux_cs_pin;         /**< Multiplexer enable (active high). */
+	SemaphoreHandle_t mutex;    /**< Serialises every transfer on the bus. */
+	uint16_t spi_clock_khz;     /**< SPI clock currently programmed (kHz), guarded by @ref mutex. */
+	_Atomic uint8_t anim_slots; /**< Animated slots on this bus (bit n = slot n). */
+	volatile bool held;         /**< @ref mutex is taken; read unguarded to spot contention. */
+	uint32_t locked_at_us;      /**< When @ref mutex was taken (µs), guarded by it. */
+	uint8_t profile_entry;      /**< Profile entry of the holder, guarded by @ref mutex. */
+	uint8_t profile_op;         /**< @ref output_bus_op_t of the holder, guarded by @ref mutex. */
+	_Atomic(const output_bank_t *) bank; /**< Bank latched with @ref mutex, NULL while free. */
+	QueueHandle_t queue;        /**< Payloads for the bus worker, see @ref output_post(). */
+	_Atomic uint8_t queued;     /**< Payloads posted and not yet applied by the worker. */
+} output_bus_t;
+
+/**
+ * @brief Output buses (module scope).
  *
- * This semaphore ensures that only one task accesses the SPI bus at a time.
+ * @ref output_bus_t::anim_slots is only written with the bus mutex held and
+ * read without it so an idle refresh does not touch the bus lock.
  */
-static SemaphoreHandle_t spi_mutex = NULL;
+static output_bus_t output_buses[OUTPUT_SPI_BUS_COUNT] CORE1_PRIVATE_DATA(output_buses) = {
+	{
+		.sck_pin = PICO_DEFAULT_SPI_SCK_PIN,
+		.tx_pin = PICO_DEFAULT_SPI_TX_PIN,
+		.mux_a_pin = SPI_MUX_A_PIN,
+		.mux_b_pin = SPI_MUX_B_PIN,
+		.mux_c_pin = SPI_MUX_C_PIN,
+		.mux_cs_pin = SPI_MUX_CS,
+	},
+	{
+		.sck_pin = SPI1_SCK_PIN,
+		.tx_pin = SPI1_TX_PIN,
+		.mux_a_pin = SPI1_MUX_A_PIN,
+		.mux_b_pin = SPI1_MUX_B_PIN,
+		.mux_c_pin = SPI1_MUX_C_PIN,
+		.mux_cs_pin = SPI1_MUX_CS,
+	},
+};
 
 /**
  * @brief Structure holding all output driver handles (module scope).
  */
-static output_drivers_t output_drivers;
+static output_drivers_t output_drivers CORE1_PRIVATE_DATA(output_drivers);
+
+/**
+ * @brief Bank built from @ref DEVICE_CONFIG, timing set by @ref output_init().
+ */
+static output_bank_t default_output_bank CORE1_PRIVATE_DATA(default_output_bank) = {
+	.device_map = DEVICE_CONFIG,
+};
+
+/**
+ * @brief Bank read by the bus users, latched with each bus lock.
+ */
+static _Atomic(const output_bank_t *) active_output_bank = &default_output_bank;
+
+/**
+ * @brief Interpolation state per slot, guarded by the slot's bus mutex.
+ */
+static display_anim_t display_anims[MAX_SPI_INTERFACES] CORE1_PRIVATE_DATA(display_anims);
+
+static void display_frame_due(timer_wheel_timer_t *timer);
+
+/**
+ * @brief Steps the animated slots every @ref DISPLAY_ANIM_PERIOD_MS, armed
+ *        only while one of them moves.
+ */
+static timer_wheel_timer_t display_frame_timer = {
+	.function = display_frame_due,
+	.owner = (uint8_t)DISPLAY_REFRESH_TASK,
+};
+
+/**
+ * @brief Lock profile per slot, bus and operation (@ref OUTPUT_PROFILE_ENTRIES).
+ *
+ * Updated by both bus users on core 1, so every access holds the kernel lock.
+ */
+static bus_profile_t bus_profiles[OUTPUT_PROFILE_ENTRIES];
+
+/**
+ * @brief Bus a slot is wired to.
+ *
+ * @param[in] slot Physical slot index (0-7).
+ *
+ * @return The slot's bus.
+ */
+static inline output_bus_t *slot_bus(uint8_t slot)
+{
+	return &output_buses[bus_config_map[slot]];
+}
+
+/**
+ * @brief Take a bus lock and profile the wait.
+ *
+ * A failed take with no wait is a probe, not a timeout, and is not counted.
+ *
+ * @param[in] bus   Bus to lock.
+ * @param[in] wait  Longest wait in ticks.
+ * @param[in] entry Profile entry: the slot, or @ref OUTPUT_PROFILE_BUS_ENTRY.
+ * @param[in] op    Operation taking the lock.
+ *
+ * @return `true` when the lock is held; `false` on timeout or when the bus
+ *         was never brought up.
+ */
+static bool bus_lock(output_bus_t *bus, TickType_t wait, uint8_t entry, output_bus_op_t op)
+{
+	bool locked = false;
+
+	if (NULL != bus->mutex)
+	{
+		const bool contended = bus->held;
+		const uint32_t asked_us = time_us_32();
+
+		locked = (pdTRUE == xSemaphoreTake(bus->mutex, wait));
+		if (locked)
+		{
+			// Published before use and checked again, like the input scan latch, so
+			// output_bank_in_use() never misses a bank this transfer is about to read
+			const output_bank_t *bank = atomic_load(&active_output_bank);
+			atomic_store(&bus->bank, bank);
+			while (bank != atomic_load(&active_output_bank))
+			{
+				bank = atomic_load(&active_output_bank);
+				atomic_store(&bus->bank, bank);
+			}
+
+			bus->held = true;
+			bus->locked_at_us = time_us_32();
+			bus->profile_entry = entry;
+			bus->profile_op = (uint8_t)op;
+
+			taskENTER_CRITICAL();
+			bus_profile_record_lock(&bus_profiles[entry], bus->locked_at_us - asked_us, contended);
+			bus_profile_record_lock(&bus_profiles[OUTPUT_PROFILE_OP_ENTRY(op)], bus->locked_at_us - asked_us,
+			                        contended);
+			taskEXIT_CRITICAL();
+		}
+		else if (0U != wait)
+		{
+			taskENTER_CRITICAL();
+			bus_profile_record_timeout(&bus_profiles[entry]);
+			bus_profile_record_timeout(&bus_profiles[OUTPUT_PROFILE_OP_ENTRY(op)]);
+			taskEXIT_CRITICAL();
+		}
+	}
+
+	return locked;
+}
+
+/**
+ * @brief Release a bus lock taken with @ref bus_lock() and profile the hold.
+ *
+ * @param[in] bus Bus to unlock.
+ *
+ * @return `true` when the lock was released.
+ */
+static bool bus_unlock(output_bus_t *bus)
+{
+	const uint32_t hold_us = time_us_32() - bus->locked_at_us;
+
+	taskENTER_CRITICAL();
+	bus_profile_record_hold(&bus_profiles[bus->profile_entry], hold_us);
+	bus_profile_record_hold(&bus_profiles[OUTPUT_PROFILE_OP_ENTRY(bus->profile_op)], hold_us);
+	taskEXIT_CRITICAL();
+
+	bus->held = false;
+	atomic_store(&bus->bank, NULL);
+	return pdTRUE == xSemaphoreGive(bus->mutex);
+}
+
+/**
+ * @brief Slots wired to a bus.
+ *
+ * @param[in] bus         Bus index.
+ * @param[in] fitted_only Leave out slots set to @ref DEVICE_NONE in @ref DEVICE_CONFIG.
+ *
+ * @return Bit n set when slot n is wired to @p bus.
+ */
+static uint8_t bus_slot_mask(uint8_t bus, bool fitted_only)
+{
+	uint8_t mask = 0U;
+
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+	{
+		if ((bus == bus_config_map[slot]) &&
+		    (!fitted_only || ((uint8_t)DEVICE_NONE != device_config_map[slot])))
+		{
+			mask |= (uint8_t)(1U << slot);
+		}
+	}
+
+	return mask;
+}
+
+/**
+ * @brief Bank a bus user reads.
+ *
+ * @param[in] bus Bus whose lock the caller holds.
+ *
+ * @return The bank latched with the lock, or the active one when the bus
+ *         is not locked.
+ */
+static inline const output_bank_t *bus_bank(const output_bus_t *bus)
+{
+	const output_bank_t *bank = atomic_load(&bus->bank);
+
+	return (NULL != bank) ? bank : atomic_load(&active_output_bank);
+}
+
+/**
+ * @brief Check whether a bank enables a slot.
+ *
+ * @param[in] bank Bank to check against.
+ * @param[in] slot Physical slot index (0-7).
+ *
+ * @return `true` when the slot accepts updates.
+ */
+static inline bool slot_enabled(const output_bank_t *bank, uint8_t slot)
+{
+	return (uint8_t)DEVICE_NONE != bank->device_map[slot];
+}
 
 /**
- * @brief Initialise GPIO used by the SPI multiplexer.
+ * @brief Initialise GPIO used by a bus multiplexer.
+ *
+ * @param[in] bus Bus whose multiplexer is configured.
  *
  * @retval OUTPUT_OK        GPIOs configured successfully.
  * @retval OUTPUT_ERR_INIT  One or more GPIOs failed the post-configuration check.
  */
-static output_result_t init_mux(void)
+static output_result_t init_mux(const output_bus_t *bus)
 {
 	tm1639_result_t result = TM1639_OK;
 
 	// Initialize multiplexer pins
-	gpio_init(SPI_MUX_CS);
-	gpio_init(SPI_MUX_A_PIN);
-	gpio_init(SPI_MUX_B_PIN);
-	gpio_init(SPI_MUX_C_PIN);
+	gpio_init(bus->mux_cs_pin);
+	gpio_init(bus->mux_a_pin);
+	gpio_init(bus->mux_b_pin);
+	gpio_init(bus->mux_c_pin);
 
 	// Check for errors in GPIO initialization
-	if ((gpio_get_function(SPI_MUX_A_PIN) != GPIO_FUNC_SIO) ||
-	    (gpio_get_function(SPI_MUX_B_PIN) != GPIO_FUNC_SIO) ||
-	    (gpio_get_function(SPI_MUX_C_PIN) != GPIO_FUNC_SIO) ||
-	    (gpio_get_function(SPI_MUX_CS) != GPIO_FUNC_SIO))
+	if ((gpio_get_function(bus->mux_a_pin) != GPIO_FUNC_SIO) ||
+	    (gpio_get_function(bus->mux_b_pin) != GPIO_FUNC_SIO) ||
+	    (gpio_get_function(bus->mux_c_pin) != GPIO_FUNC_SIO) ||
+	    (gpio_get_function(bus->mux_cs_pin) != GPIO_FUNC_SIO))
 	{
 		result = TM1639_ERR_GPIO_INIT;
 	}
 
-	gpio_set_dir(SPI_MUX_A_PIN, GPIO_OUT);
-	gpio_set_dir(SPI_MUX_B_PIN, GPIO_OUT);
-	gpio_set_dir(SPI_MUX_C_PIN, GPIO_OUT);
-	gpio_set_dir(SPI_MUX_CS, GPIO_OUT);
+	gpio_set_dir(bus->mux_a_pin, GPIO_OUT);
+	gpio_set_dir(bus->mux_b_pin, GPIO_OUT);
+	gpio_set_dir(bus->mux_c_pin, GPIO_OUT);
+	gpio_set_dir(bus->mux_cs_pin, GPIO_OUT);
 
 	// Default state (all high, no chip selected)
-	gpio_put(SPI_MUX_CS, 0);
-	gpio_put(SPI_MUX_A_PIN, 1);
-	gpio_put(SPI_MUX_B_PIN, 1);
-	gpio_put(SPI_MUX_C_PIN, 1);
+	gpio_put(bus->mux_cs_pin, 0);
+	gpio_put(bus->mux_a_pin, 1);
+	gpio_put(bus->mux_b_pin, 1);
+	gpio_put(bus->mux_c_pin, 1);
 
 	output_result_t output_result  = OUTPUT_OK;
 	if (result != TM1639_OK)
@@ -98,9 +348,84 @@ static output_result_t init_mux(void)
 	return output_result;
 }
 
+/**
+ * @brief Bring up one SPI bus: lock, worker queue, multiplexer and SPI block.
+ *
+ * @param[in,out] bus Bus to initialise; @ref output_bus_t::spi must be set.
+ *
+ * @retval OUTPUT_OK        The bus is ready.
+ * @retval OUTPUT_ERR_INIT  A pin is unassigned, the lock or queue could not be
+ *                          created or a GPIO failed its check.
+ */
+static output_result_t init_bus(output_bus_t *bus)
+{
+	output_result_t result = OUTPUT_OK;
+
+	if ((OUTPUT_PIN_NONE == bus->sck_pin) || (OUTPUT_PIN_NONE == bus->tx_pin) ||
+	    (OUTPUT_PIN_NONE == bus->mux_a_pin) || (OUTPUT_PIN_NONE == bus->mux_b_pin) ||
+	    (OUTPUT_PIN_NONE == bus->mux_c_pin) || (OUTPUT_PIN_NONE == bus->mux_cs_pin))
+	{
+		// Slots were assigned to a bus this board does not wire
+		statistics_increment_counter(OUTPUT_INIT_ERROR);
+		return OUTPUT_ERR_INIT;
+	}
+
+	// Create mutex
+	if (!bus->mutex)
+	{
+		bus->mutex = xSemaphoreCreateMutex();
+		// Error returning mutex
+		if (!bus->mutex)
+		{
+			result = OUTPUT_ERR_INIT;
+			statistics_increment_counter(OUTPUT_INIT_ERROR);
+		}
+	}
+
+	// Create the worker queue
+	if (!bus->queue)
+	{
+		bus->queue = xQueueCreate(OUTPUT_BUS_QUEUE_SIZE, sizeof(output_bus_command_t));
+		if (!bus->queue)
+		{
+			result = OUTPUT_ERR_INIT;
+			statistics_increment_counter(OUTPUT_INIT_ERROR);
+		}
+	}
+
+	// Initialize multiplexer
+	output_result_t result_mux = init_mux(bus);
+	if (result_mux != OUTPUT_OK)
+	{
+		statistics_increment_counter(OUTPUT_INIT_ERROR);
+	}
+
+	// Initialize SPI
+	spi_init(bus->spi, SPI_FREQUENCY);
+	spi_set_format(bus->spi, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+	bus->spi_clock_khz = (uint16_t)OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+
+	gpio_set_function(bus->sck_pin, GPIO_FUNC_SPI);
+	gpio_set_function(bus->tx_pin, GPIO_FUNC_SPI);
+
+	// Verify SPI pin configuration
+	if ((gpio_get_function(bus->sck_pin) != GPIO_FUNC_SPI) ||
+	    (gpio_get_function(bus->tx_pin) != GPIO_FUNC_SPI))
+	{
+		statistics_increment_counter(OUTPUT_INIT_ERROR);
+		result =  OUTPUT_ERR_INIT;
+	}
+
+	return result;
+}
+
 /**
  * @brief Toggle the multiplexer lines for the requested device.
  *
+ * Selecting a slot also switches its bus clock to the slot's timing when it
+ * differs from the one programmed. Both edges wait the slot's settle time.
+ * Caller holds the slot's bus mutex.
+ *
  * @param[in] chip_select Chip select number (0-7).
  * @param[in] select      `true` to assert the strobe, `false` to release it.
  *
@@ -118,27 +443,153 @@ static output_result_t select_interface(uint8_t chip_select, bool select)
 		return OUTPUT_ERR_INVALID_PARAM;
 	}
 
+	output_bus_t *bus = slot_bus(chip_select);
+	const output_slot_timing_t *timing = &bus_bank(bus)->timing[chip_select];
+
 	if (select)
 	{
+		if (timing->spi_khz != bus->spi_clock_khz)
+		{
+			(void)spi_set_baudrate(bus->spi, (uint32_t)timing->spi_khz * 1000U);
+			bus->spi_clock_khz = timing->spi_khz;
+		}
+
+		// The TM1637 drivers bit-bang with their own copy of the half period
+		output_driver_t *driver = output_drivers.driver_handles[chip_select];
+		if ((NULL != driver) &&
+		    (((uint8_t)DEVICE_TM1637_DIGIT == device_config_map[chip_select]) ||
+		     ((uint8_t)DEVICE_TM1637_LED == device_config_map[chip_select])))
+		{
+			driver->bit_delay_us = timing->tm1637_half_period_us;
+		}
+
 		// Convert chip number to individual bits for multiplexer control
-		gpio_put(SPI_MUX_A_PIN, (chip_select & (uint8_t)0x01));       // LSB
-		gpio_put(SPI_MUX_B_PIN, (chip_select & (uint8_t)0x02) >> 1);  // middle bit
-		gpio_put(SPI_MUX_C_PIN, (chip_select & (uint8_t)0x04) >> 2);  // MSB
+		gpio_put(bus->mux_a_pin, (chip_select & (uint8_t)0x01));       // LSB
+		gpio_put(bus->mux_b_pin, (chip_select & (uint8_t)0x02) >> 1);  // middle bit
+		gpio_put(bus->mux_c_pin, (chip_select & (uint8_t)0x04) >> 2);  // MSB
 
-		gpio_put(SPI_MUX_CS, 1);
+		gpio_put(bus->mux_cs_pin, 1);
 	}
 	else
 	{
 		// Set multiplexer to no output (all selector pins high)
-		gpio_put(SPI_MUX_CS, 0);
+		gpio_put(bus->mux_cs_pin, 0);
+	}
+
+	// Let the multiplexer outputs settle
+	sleep_us(timing->select_settle_us);
+
+	return result;
+}
+
+/**
+ * @brief Record whether a slot still needs refresh steps.
+ *
+ * Caller holds the slot's bus mutex, which serialises every writer of the
+ * bus mask.
+ *
+ * @param[in] slot   Physical slot index (0-7).
+ * @param[in] moving `true` while the slot is animating.
+ */
+static void set_anim_slot(uint8_t slot, bool moving)
+{
+	output_bus_t *bus = slot_bus(slot);
+	const uint8_t slots = atomic_load_explicit(&bus->anim_slots, memory_order_relaxed);
+	const uint8_t bit = (uint8_t)(1U << slot);
+
+	atomic_store_explicit(&bus->anim_slots,
+	                      moving ? (uint8_t)(slots | bit) : (uint8_t)(slots & (uint8_t)~bit),
+	                      memory_order_release);
+
+	if (moving)
+	{
+		// Set after the mask, so the frame that finds nothing moving cannot miss this slot
+		(void)timer_wheel_start(&display_frame_timer, pdMS_TO_TICKS(DISPLAY_ANIM_PERIOD_MS));
+	}
+}
+
+/**
+ * @brief Stop the animation of a slot that is about to be written directly.
+ *
+ * Caller holds the slot's bus mutex.
+ *
+ * @param[in] slot Physical slot index (0-7).
+ */
+static void stop_anim(uint8_t slot)
+{
+	display_anim_reset(&display_anims[slot]);
+	set_anim_slot(slot, false);
+}
+
+/**
+ * @brief Step one animated slot and write its digits when they changed.
+ *
+ * Caller holds the slot's bus mutex. A driver failure stops the animation.
+ *
+ * @param[in] slot Physical slot index (0-7).
+ *
+ * @retval OUTPUT_OK            The display matches the stepped value.
+ * @retval OUTPUT_ERR_DISPLAY_OUT   The slot has no driver or the driver failed.
+ */
+static output_result_t write_anim_step(uint8_t slot)
+{
+	output_result_t result = OUTPUT_OK;
+	display_anim_t *anim = &display_anims[slot];
+	output_driver_t *handle = output_drivers.driver_handles[slot];
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot_position = OUTPUT_NO_DECIMAL_POINT;
+
+	if (0U != display_anim_step(anim, digits, &dot_position))
+	{
+		if ((handle != NULL) && (handle->set_digits))
+		{
+			result = handle->set_digits(handle, digits, sizeof(digits), dot_position);
+		}
+		else
+		{
+			(void)select_interface(slot, false);
+			result = OUTPUT_ERR_DISPLAY_OUT;
+		}
 	}
 
-	// Small delay to ensure stable signal
-	sleep_us(1);
+	if (OUTPUT_OK != result)
+	{
+		stop_anim(slot);
+	}
+	else
+	{
+		set_anim_slot(slot, display_anim_active(anim));
+	}
 
 	return result;
 }
 
+/**
+ * @brief Decode a 1 to 4 byte big-endian value.
+ *
+ * @param[in] bytes     Value bytes, most significant first.
+ * @param[in] count     Number of bytes (1-4).
+ * @param[in] is_signed Sign-extend from the top bit of @p bytes[0].
+ *
+ * @return The value widened to 32 bits.
+ */
+static uint32_t decode_value(const uint8_t *bytes, uint8_t count, bool is_signed)
+{
+	uint32_t value = 0U;
+
+	// Shorter values are sign-extended from their top bit when signed
+	if (is_signed && (0U != (bytes[0] & 0x80U)))
+	{
+		value = 0xFFFFFFFFUL;
+	}
+	for (uint8_t i = 0U; i < count; i++)
+	{
+		value = (value << 8U) | bytes[i];
+	}
+
+	return value;
+}
+
 /**
  * @brief Instantiate driver back-ends based on @ref device_config_map.
  *
@@ -160,9 +611,9 @@ static output_result_t init_driver(void)
 			// Initialize TM1639 driver
 			output_drivers.driver_handles[i] = tm1639_init(i,
 			                                               &select_interface,
-			                                               spi0,
-			                                               PICO_DEFAULT_SPI_TX_PIN,
-			                                               PICO_DEFAULT_SPI_SCK_PIN);
+			                                               slot_bus(i)->spi,
+			                                               slot_bus(i)->tx_pin,
+			                                               slot_bus(i)->sck_pin);
 			if (NULL == output_drivers.driver_handles[i])
 			{
 				result = OUTPUT_ERR_INIT;
@@ -173,12 +624,12 @@ static output_result_t init_driver(void)
 		else if (((uint8_t)DEVICE_TM1637_DIGIT == device_config_map[i]) ||
 		         ((uint8_t)DEVICE_TM1637_LED == device_config_map[i]))
 		{
-			// Initialize TM1637 driver using same SPI infrastructure as TM1639
+			// Initialize TM1637 driver on the pins of its SPI bus
 			output_drivers.driver_handles[i] = tm1637_init(i,
 			                                               &select_interface,
-			                                               spi0,
-			                                               PICO_DEFAULT_SPI_TX_PIN,
-			                                               PICO_DEFAULT_SPI_SCK_PIN);
+			                                               slot_bus(i)->spi,
+			                                               slot_bus(i)->tx_pin,
+			                                               slot_bus(i)->sck_pin);
 			if (NULL == output_drivers.driver_handles[i])
 			{
 				result = OUTPUT_ERR_INIT;
@@ -230,41 +681,36 @@ output_result_t output_init(void)
 {
 	output_result_t result = OUTPUT_OK;
 
-	// Create mutex
-	if (!spi_mutex)
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
 	{
-		spi_mutex = xSemaphoreCreateMutex();
-		// Error returning mutex
-		if (!spi_mutex)
-		{
-			result = OUTPUT_ERR_INIT;
-			statistics_increment_counter(OUTPUT_INIT_ERROR);
-		}
+		display_anim_reset(&display_anims[slot]);
 	}
 
-	// Initialize multiplexer
-	output_result_t result_mux = init_mux();
-	if (result_mux != OUTPUT_OK)
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
 	{
-		statistics_increment_counter(OUTPUT_INIT_ERROR);
+		default_output_bank.timing[slot].spi_khz = (uint16_t)OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+		default_output_bank.timing[slot].select_settle_us = (uint8_t)OUTPUT_TIMING_DEFAULT_SETTLE_US;
+		default_output_bank.timing[slot].tm1637_half_period_us = (uint8_t)OUTPUT_TIMING_DEFAULT_TM1637_US;
 	}
+	atomic_store(&active_output_bank, &default_output_bank);
 
-	// Initialize SPI
-	spi_init(spi0, SPI_FREQUENCY);
-	spi_set_format(spi0, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
-
-	gpio_set_function(PICO_DEFAULT_SPI_RX_PIN, GPIO_FUNC_SPI);
-	gpio_set_function(PICO_DEFAULT_SPI_SCK_PIN, GPIO_FUNC_SPI);
-	gpio_set_function(PICO_DEFAULT_SPI_TX_PIN, GPIO_FUNC_SPI);
+	output_buses[OUTPUT_BUS_SPI0].spi = spi0;
+	output_buses[OUTPUT_BUS_SPI1].spi = spi1;
 
-	// Verify SPI pin configuration
-	if ((gpio_get_function(PICO_DEFAULT_SPI_SCK_PIN) != GPIO_FUNC_SPI) ||
-	    (gpio_get_function(PICO_DEFAULT_SPI_TX_PIN) != GPIO_FUNC_SPI))
+	// Only buses that carry a fitted slot claim their pins
+	for (uint8_t bus = 0U; bus < (uint8_t)OUTPUT_SPI_BUS_COUNT; bus++)
 	{
-		statistics_increment_counter(OUTPUT_INIT_ERROR);
-		result =  OUTPUT_ERR_INIT;
+		atomic_store(&output_buses[bus].anim_slots, 0U);
+
+		if ((0U != bus_slot_mask(bus, true)) && (OUTPUT_OK != init_bus(&output_buses[bus])))
+		{
+			result = OUTPUT_ERR_INIT;
+		}
 	}
 
+	// spi0 RX stays routed to the SPI block as before
+	gpio_set_function(PICO_DEFAULT_SPI_RX_PIN, GPIO_FUNC_SPI);
+
 	// Make the SPI pins available to picotool
 	bi_decl(bi_4pins_with_func(PICO_DEFAULT_SPI_RX_PIN, PICO_DEFAULT_SPI_TX_PIN, PICO_DEFAULT_SPI_SCK_PIN, PICO_DEFAULT_SPI_CSN_PIN, GPIO_FUNC_SPI))
 
@@ -307,7 +753,7 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 		const uint8_t controller_id = (header >> DISPLAY_CMD_ID_SHIFT) & (uint8_t)0x07U;
 		command = header & DISPLAY_CMD_MASK;
 
-		if (controller_id >= (uint8_t)MAX_SPI_INTERFACES)
+		if ((0U == controller_id) || (controller_id >= (uint8_t)MAX_SPI_INTERFACES))
 		{
 			statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
 			result = OUTPUT_ERR_INVALID_PARAM;
@@ -328,6 +774,18 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 				statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
 				result = OUTPUT_ERR_INVALID_PARAM;
 			}
+			else if ((DISPLAY_CMD_SET_NUMBER == command) &&
+			         ((length < (uint8_t)4) || (length > (uint8_t)7)))
+			{
+				statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+				result = OUTPUT_ERR_INVALID_PARAM;
+			}
+			else if ((DISPLAY_CMD_SET_TARGET == command) &&
+			         ((length < (uint8_t)6) || (length > (uint8_t)9)))
+			{
+				statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+				result = OUTPUT_ERR_INVALID_PARAM;
+			}
 		}
 
 		/**
@@ -346,13 +804,20 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 
 	/**
 	 * @par Mutex acquisition
-	 * Tries to take the SPI mutex if parameters are valid.
+	 * Tries to take the slot's bus mutex if parameters are valid.
 	 */
 	if (OUTPUT_OK == result)
 	{
-		if (pdTRUE == xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(1000)))
+		if (bus_lock(slot_bus(physical_cs), pdMS_TO_TICKS(1000), physical_cs, OUTPUT_BUS_OP_DISPLAY))
 		{
 			mutex_taken = true;
+
+			// Checked against the bank latched with the lock
+			if (!slot_enabled(bus_bank(slot_bus(physical_cs)), physical_cs))
+			{
+				statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
+				result = OUTPUT_ERR_INVALID_PARAM;
+			}
 		}
 		else
 		{
@@ -376,6 +841,7 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 		digits[6] = (payload[4] >> (uint8_t)4) & (uint8_t)0x0F;
 		digits[7] = payload[4] & (uint8_t)0x0F;
 
+		stop_anim(physical_cs);
 		output_driver_t *handle = output_drivers.driver_handles[physical_cs];
 		if ((handle != NULL) && (handle->set_digits))
 		{
@@ -388,14 +854,24 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 			result = OUTPUT_ERR_DISPLAY_OUT;
 		}
 	}
-	else if ((OUTPUT_OK == result) && (DISPLAY_CMD_SET_BRIGHTNESS == command))
+	else if ((OUTPUT_OK == result) && (DISPLAY_CMD_SET_NUMBER == command))
 	{
-		output_driver_t *handle = output_drivers.driver_handles[physical_cs];
-		const uint8_t brightness = payload[1];
+		const uint8_t format = payload[1];
+		const uint32_t value = decode_value(&payload[3], length - (uint8_t)3,
+		                                    0U != (format & DISPLAY_FORMAT_SIGNED));
+		uint8_t digits[OUTPUT_IMAGE_SIZE];
+		uint8_t dot_position = OUTPUT_NO_DECIMAL_POINT;
 
-		if ((handle != NULL) && (handle->set_brightness))
+		output_driver_t *handle = output_drivers.driver_handles[physical_cs];
+		if (!display_format_number(value, format, payload[2], digits, &dot_position))
 		{
-			result = handle->set_brightness(handle, brightness);
+			statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+			result = OUTPUT_ERR_INVALID_PARAM;
+		}
+		else if ((handle != NULL) && (handle->set_digits))
+		{
+			stop_anim(physical_cs);
+			result = handle->set_digits(handle, digits, sizeof(digits), dot_position);
 		}
 		else
 		{
@@ -403,19 +879,52 @@ output_result_t display_out(const uint8_t *payload, uint8_t length)
 			result = OUTPUT_ERR_DISPLAY_OUT;
 		}
 	}
-	else if (OUTPUT_OK == result)
+	else if ((OUTPUT_OK == result) && (DISPLAY_CMD_SET_TARGET == command))
 	{
-		statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
-		result = OUTPUT_ERR_INVALID_PARAM;
-	}
+		const uint8_t format = payload[1];
+		const uint16_t slew = (uint16_t)(((uint16_t)payload[3] << 8U) | payload[4]);
+		const uint32_t target = decode_value(&payload[5], length - (uint8_t)5,
+		                                     0U != (format & DISPLAY_FORMAT_SIGNED));
 
-	/**
-	 * @par Mutex release
-	 * Releases the SPI mutex only when it was successfully acquired.
-	 */
-	if (mutex_taken)
+		if (!display_anim_start(&display_anims[physical_cs], target, format, payload[2], slew))
+		{
+			statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+			result = OUTPUT_ERR_INVALID_PARAM;
+		}
+		else
+		{
+			// First step now; the refresh task takes over from here
+			result = write_anim_step(physical_cs);
+		}
+	}
+	else if ((OUTPUT_OK == result) && (DISPLAY_CMD_SET_BRIGHTNESS == command))
+	{
+		output_driver_t *handle = output_drivers.driver_handles[physical_cs];
+		const uint8_t brightness = payload[1];
+
+		if ((handle != NULL) && (handle->set_brightness))
+		{
+			result = handle->set_brightness(handle, brightness);
+		}
+		else
+		{
+			(void)select_interface(physical_cs, false);
+			result = OUTPUT_ERR_DISPLAY_OUT;
+		}
+	}
+	else if (OUTPUT_OK == result)
+	{
+		statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+		result = OUTPUT_ERR_INVALID_PARAM;
+	}
+
+	/**
+	 * @par Mutex release
+	 * Releases the bus mutex only when it was successfully acquired.
+	 */
+	if (mutex_taken)
 	{
-		if (pdFALSE == xSemaphoreGive(spi_mutex))
+		if (!bus_unlock(slot_bus(physical_cs)))
 		{
 			result = OUTPUT_ERR_SEMAPHORE;
 		}
@@ -464,11 +973,11 @@ output_result_t led_out(const uint8_t *payload, uint8_t length)
 
 	/**
 	 * @par Mutex acquisition
-	 * Tries to take the SPI mutex if parameters are valid.
+	 * Tries to take the slot's bus mutex if parameters are valid.
 	 */
 	if (OUTPUT_OK == result)
 	{
-		if (pdTRUE == xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(1000)))
+		if (bus_lock(slot_bus(physical_cs), pdMS_TO_TICKS(1000), physical_cs, OUTPUT_BUS_OP_LED))
 		{
 			mutex_taken = true;
 
@@ -480,7 +989,13 @@ output_result_t led_out(const uint8_t *payload, uint8_t length)
 			uint8_t ledstate = payload[2];
 
 			output_driver_t *handle = output_drivers.driver_handles[physical_cs];
-			if ((NULL != handle) && (NULL != handle->set_leds))
+			if (!slot_enabled(bus_bank(slot_bus(physical_cs)), physical_cs))
+			{
+				// Checked against the bank latched with the lock
+				statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
+				result = OUTPUT_ERR_INVALID_PARAM;
+			}
+			else if ((NULL != handle) && (NULL != handle->set_leds))
 			{
 				result = handle->set_leds(handle, index, ledstate);
 			}
@@ -498,11 +1013,324 @@ output_result_t led_out(const uint8_t *payload, uint8_t length)
 
 	/**
 	 * @par Mutex release
-	 * Releases the SPI mutex only when it was successfully acquired.
+	 * Releases the bus mutex only when it was successfully acquired.
 	 */
 	if (mutex_taken)
 	{
-		if (pdTRUE != xSemaphoreGive(spi_mutex))
+		if (!bus_unlock(slot_bus(physical_cs)))
+		{
+			result = OUTPUT_ERR_SEMAPHORE;
+		}
+	}
+
+	return result;
+}
+
+output_result_t output_post(output_bus_op_t op, const uint8_t *payload, uint8_t length)
+{
+	output_result_t result = OUTPUT_OK;
+	uint8_t controller_id = 0U;
+
+	if ((NULL != payload) && (0U != length) && (OUTPUT_BUS_OP_DISPLAY == op))
+	{
+		controller_id = (payload[0] >> DISPLAY_CMD_ID_SHIFT) & (uint8_t)0x07U;
+	}
+	else if ((NULL != payload) && (0U != length) && (OUTPUT_BUS_OP_LED == op))
+	{
+		controller_id = payload[0];
+	}
+
+	if ((0U == controller_id) || (controller_id > (uint8_t)MAX_SPI_INTERFACES))
+	{
+		statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
+		result = OUTPUT_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		output_bus_t *bus = slot_bus(controller_id - (uint8_t)1);
+		output_bus_command_t command = {.op = (uint8_t)op, .length = length};
+
+		// Longer payloads only carry bytes the handlers never read
+		(void)memcpy(command.payload, payload, (length < OUTPUT_BUS_COMMAND_MAX) ? length : OUTPUT_BUS_COMMAND_MAX);
+
+		// Counted before the send so a drain never misses a payload the worker already took
+		atomic_fetch_add(&bus->queued, 1U);
+		if ((NULL == bus->queue) ||
+		    (pdTRUE != xQueueSend(bus->queue, &command, pdMS_TO_TICKS(OUTPUT_BUS_POST_TIMEOUT_MS))))
+		{
+			atomic_fetch_sub(&bus->queued, 1U);
+			result = OUTPUT_ERR_QUEUE_FULL;
+		}
+	}
+
+	return result;
+}
+
+bool output_bus_service(uint8_t bus, uint32_t wait_ms)
+{
+	output_bus_command_t command;
+	bool applied = false;
+
+	if ((bus < (uint8_t)OUTPUT_SPI_BUS_COUNT) && (NULL != output_buses[bus].queue) &&
+	    (pdTRUE == xQueueReceive(output_buses[bus].queue, &command, pdMS_TO_TICKS(wait_ms))))
+	{
+		if (OUTPUT_BUS_OP_DISPLAY == command.op)
+		{
+			if (display_out(command.payload, command.length) != OUTPUT_OK)
+			{
+				statistics_increment_counter(DISPLAY_OUT_ERROR);
+			}
+		}
+		else if (led_out(command.payload, command.length) != OUTPUT_OK)
+		{
+			statistics_increment_counter(LED_OUT_ERROR);
+		}
+
+		atomic_fetch_sub(&output_buses[bus].queued, 1U);
+		applied = true;
+	}
+
+	return applied;
+}
+
+/**
+ * @brief Worker loop of one bus.
+ *
+ * @param[in]     bus        Bus index.
+ * @param[in,out] task_props Properties of the calling task.
+ */
+static void bus_worker(uint8_t bus, task_props_t *task_props)
+{
+	while (true)
+	{
+		if (NULL == output_buses[bus].queue)
+		{
+			// No fitted slot on this bus: nothing will ever be queued
+			vTaskDelay(pdMS_TO_TICKS(OUTPUT_BUS_IDLE_WAIT_MS));
+		}
+		else
+		{
+			(void)output_bus_service(bus, OUTPUT_BUS_IDLE_WAIT_MS);
+		}
+
+		task_props->heartbeat++;
+		watchdog_update();
+	}
+}
+
+void output_spi0_task(void *pvParameters)
+{
+	bus_worker(OUTPUT_BUS_SPI0, (task_props_t *)pvParameters);
+}
+
+void output_spi1_task(void *pvParameters)
+{
+	bus_worker(OUTPUT_BUS_SPI1, (task_props_t *)pvParameters);
+}
+
+/**
+ * @brief Wait until the worker of a bus applied every posted payload.
+ *
+ * Must not be called from the worker itself.
+ *
+ * @param[in] bus Bus to drain.
+ */
+static void bus_drain(const output_bus_t *bus)
+{
+	for (TickType_t waited = 0U; (0U != atomic_load(&bus->queued)) && (waited < pdMS_TO_TICKS(1000)); waited++)
+	{
+		vTaskDelay(1U);
+	}
+}
+
+/**
+ * @brief Commit one slot image to its driver while the SPI mutex is held.
+ *
+ * @param[in] slot  Physical slot index (0-7).
+ * @param[in] image Image to render on the slot.
+ *
+ * @retval OUTPUT_OK            The slot now shows @p image.
+ * @retval OUTPUT_ERR_DISPLAY_OUT   The slot has no driver or the driver failed.
+ * @retval OUTPUT_ERR_INVALID_PARAM The image does not fit the device type.
+ */
+static output_result_t apply_slot_image(uint8_t slot, const output_slot_image_t *image)
+{
+	output_result_t result = OUTPUT_OK;
+	output_driver_t *handle = output_drivers.driver_handles[slot];
+	const uint8_t device_type = device_config_map[slot];
+
+	if (NULL == handle)
+	{
+		result = OUTPUT_ERR_DISPLAY_OUT;
+	}
+	else if (((uint8_t)DEVICE_TM1639_DIGIT == device_type) ||
+	         ((uint8_t)DEVICE_TM1637_DIGIT == device_type) ||
+	         ((uint8_t)DEVICE_GENERIC_DIGIT == device_type))
+	{
+		stop_anim(slot);
+		result = (NULL != handle->set_digits) ?
+		         handle->set_digits(handle, image->data, OUTPUT_IMAGE_SIZE, image->dot_position) :
+		         OUTPUT_ERR_DISPLAY_OUT;
+	}
+	else
+	{
+		result = (NULL != handle->set_led_columns) ?
+		         handle->set_led_columns(handle, image->data, OUTPUT_IMAGE_SIZE) :
+		         OUTPUT_ERR_DISPLAY_OUT;
+	}
+
+	// Brightness is a separate bus command, skip it when already programmed
+	if ((OUTPUT_OK == result) &&
+	    (image->brightness != handle->brightness) &&
+	    (NULL != handle->set_brightness))
+	{
+		result = handle->set_brightness(handle, image->brightness);
+	}
+
+	return result;
+}
+
+output_result_t output_apply_images(const output_slot_image_t *images, uint8_t slot_mask)
+{
+	output_result_t result = OUTPUT_OK;
+
+	if (NULL == images)
+	{
+		statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+		result = OUTPUT_ERR_INVALID_PARAM;
+	}
+
+	for (uint8_t bus = 0U; (bus < (uint8_t)OUTPUT_SPI_BUS_COUNT) && (OUTPUT_ERR_INVALID_PARAM != result); bus++)
+	{
+		const uint8_t bus_slots = slot_mask & bus_slot_mask(bus, false);
+
+		if (0U == bus_slots)
+		{
+			continue;
+		}
+
+		// Updates the host sent before the scene land first
+		bus_drain(&output_buses[bus]);
+
+		if (!bus_lock(&output_buses[bus], pdMS_TO_TICKS(1000), OUTPUT_PROFILE_BUS_ENTRY(bus), OUTPUT_BUS_OP_SCENE))
+		{
+			result = OUTPUT_ERR_SEMAPHORE;
+			continue;
+		}
+
+		for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+		{
+			// Slots disabled by the active profile are left untouched
+			if ((0U == (bus_slots & (uint8_t)(1U << slot))) || !slot_enabled(bus_bank(&output_buses[bus]), slot))
+			{
+				continue;
+			}
+
+			// Keep going so one faulty slot does not block the rest of the scene
+			if (OUTPUT_OK != apply_slot_image(slot, &images[slot]))
+			{
+				statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
+				if (OUTPUT_OK == result)
+				{
+					result = OUTPUT_ERR_DISPLAY_OUT;
+				}
+			}
+		}
+
+		if (!bus_unlock(&output_buses[bus]))
+		{
+			result = OUTPUT_ERR_SEMAPHORE;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * @brief Step the animated slots of one bus, with its lock held.
+ *
+ * @param[in] bus Bus index.
+ *
+ * @retval OUTPUT_OK            Every moving slot on the bus is up to date.
+ * @retval OUTPUT_ERR_DISPLAY_OUT   At least one slot rejected its digits.
+ */
+static output_result_t refresh_bus(uint8_t bus)
+{
+	output_result_t result = OUTPUT_OK;
+	const uint8_t slots = atomic_load_explicit(&output_buses[bus].anim_slots, memory_order_relaxed);
+
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+	{
+		if (0U == (slots & (uint8_t)(1U << slot)))
+		{
+			continue;
+		}
+
+		if (!slot_enabled(bus_bank(&output_buses[bus]), slot))
+		{
+			// Disabled by a profile switch
+			stop_anim(slot);
+		}
+		else if (OUTPUT_OK != write_anim_step(slot))
+		{
+			statistics_increment_counter(OUTPUT_CONTROLLER_ID_ERROR);
+			result = OUTPUT_ERR_DISPLAY_OUT;
+		}
+	}
+
+	return result;
+}
+
+output_result_t output_refresh_displays(void)
+{
+	output_result_t result = OUTPUT_OK;
+	uint8_t waiting = 0U;
+
+	// First pass: buses that are free right now
+	for (uint8_t bus = 0U; bus < (uint8_t)OUTPUT_SPI_BUS_COUNT; bus++)
+	{
+		if (0U == atomic_load_explicit(&output_buses[bus].anim_slots, memory_order_acquire))
+		{
+			// Nothing moving: leave the bus alone
+		}
+		else if (!bus_lock(&output_buses[bus], 0U, OUTPUT_PROFILE_BUS_ENTRY(bus), OUTPUT_BUS_OP_REFRESH))
+		{
+			waiting |= (uint8_t)(1U << bus);
+		}
+		else
+		{
+			if (OUTPUT_OK != refresh_bus(bus))
+			{
+				result = OUTPUT_ERR_DISPLAY_OUT;
+			}
+			if (!bus_unlock(&output_buses[bus]))
+			{
+				result = OUTPUT_ERR_SEMAPHORE;
+			}
+		}
+	}
+
+	// Second pass: wait for the busy ones
+	for (uint8_t bus = 0U; bus < (uint8_t)OUTPUT_SPI_BUS_COUNT; bus++)
+	{
+		if (0U == (waiting & (uint8_t)(1U << bus)))
+		{
+			continue;
+		}
+
+		if (!bus_lock(&output_buses[bus], pdMS_TO_TICKS(DISPLAY_ANIM_PERIOD_MS), OUTPUT_PROFILE_BUS_ENTRY(bus),
+		              OUTPUT_BUS_OP_REFRESH))
+		{
+			// Bus busy for a whole period: skip this frame, the next one catches up
+			result = OUTPUT_ERR_SEMAPHORE;
+			continue;
+		}
+
+		if ((OUTPUT_OK != refresh_bus(bus)) && (OUTPUT_OK == result))
+		{
+			result = OUTPUT_ERR_DISPLAY_OUT;
+		}
+		if (!bus_unlock(&output_buses[bus]))
 		{
 			result = OUTPUT_ERR_SEMAPHORE;
 		}
@@ -511,6 +1339,135 @@ output_result_t led_out(const uint8_t *payload, uint8_t length)
 	return result;
 }
 
+/**
+ * @brief Frame timer handler: step the moving slots and keep the cadence.
+ *
+ * Runs in @ref display_refresh_task.
+ *
+ * @param[in,out] timer @ref display_frame_timer.
+ */
+static void display_frame_due(timer_wheel_timer_t *timer)
+{
+	bool moving = false;
+	// The refresh may restart the disarmed timer from now: keep the cadence from its due tick
+	const uint32_t due = timer->expires;
+
+	(void)output_refresh_displays();
+
+	for (uint8_t bus = 0U; bus < (uint8_t)OUTPUT_SPI_BUS_COUNT; bus++)
+	{
+		moving = moving || (0U != atomic_load_explicit(&output_buses[bus].anim_slots, memory_order_acquire));
+	}
+
+	if (moving)
+	{
+		// Fixed cadence so slew rates and durations hold regardless of bus load
+		timer_wheel_reschedule(timer, due + pdMS_TO_TICKS(DISPLAY_ANIM_PERIOD_MS));
+	}
+}
+
+void display_refresh_task(void *pvParameters)
+{
+	task_props_t *task_props = (task_props_t *)pvParameters;
+	TickType_t wait = pdMS_TO_TICKS(DISPLAY_REFRESH_IDLE_WAIT_MS);
+
+	while (true)
+	{
+		// Woken by the frame timer while a slot moves, by the commit alarm, by the timeout otherwise
+		(void)ulTaskNotifyTakeIndexed(TIMER_WHEEL_NOTIFY_INDEX, pdTRUE, wait);
+
+		// Commits first: they are the ones with a deadline. Poll every tick
+		// while a staged command has no alarm (alarm pool exhausted)
+		wait = output_commit_run() ? pdMS_TO_TICKS(DISPLAY_REFRESH_IDLE_WAIT_MS) : 1U;
+		(void)timer_wheel_dispatch(DISPLAY_REFRESH_TASK);
+
+		task_props->heartbeat++;
+		watchdog_update();
+	}
+}
+
+output_result_t output_set_active_bank(const output_bank_t *bank)
+{
+	output_result_t result = (NULL != bank) ? OUTPUT_OK : OUTPUT_ERR_INVALID_PARAM;
+
+	for (uint8_t slot = 0U; (slot < (uint8_t)MAX_SPI_INTERFACES) && (OUTPUT_OK == result); slot++)
+	{
+		// A bank can disable slots but not change hardware
+		if (!output_slot_timing_valid(&bank->timing[slot]) ||
+		    (((uint8_t)DEVICE_NONE != bank->device_map[slot]) && (device_config_map[slot] != bank->device_map[slot])))
+		{
+			result = OUTPUT_ERR_INVALID_PARAM;
+		}
+	}
+
+	if (OUTPUT_OK == result)
+	{
+		atomic_store(&active_output_bank, bank);
+	}
+	else
+	{
+		statistics_increment_counter(OUTPUT_INVALID_PARAM_ERROR);
+	}
+
+	return result;
+}
+
+bool output_bank_in_use(const output_bank_t *bank)
+{
+	bool in_use = (bank == atomic_load(&active_output_bank));
+
+	for (uint8_t bus = 0U; bus < (uint8_t)OUTPUT_SPI_BUS_COUNT; bus++)
+	{
+		in_use = in_use || (bank == atomic_load(&output_buses[bus].bank));
+	}
+
+	return in_use;
+}
+
+uint8_t output_slot_device(uint8_t slot, bool enabled_only)
+{
+	uint8_t device = (uint8_t)DEVICE_NONE;
+
+	if ((slot < (uint8_t)MAX_SPI_INTERFACES) && (!enabled_only || slot_enabled(atomic_load(&active_output_bank), slot)))
+	{
+		device = device_config_map[slot];
+	}
+
+	return device;
+}
+
+bool output_slot_timing_valid(const output_slot_timing_t *timing)
+{
+	return (NULL != timing) &&
+	       (timing->spi_khz >= (uint16_t)OUTPUT_TIMING_MIN_SPI_KHZ) &&
+	       (timing->spi_khz <= (uint16_t)OUTPUT_TIMING_MAX_SPI_KHZ) &&
+	       (0U != timing->tm1637_half_period_us);
+}
+
+bool output_bus_profile(uint8_t entry, bus_profile_t *profile)
+{
+	const bool valid = entry < (uint8_t)OUTPUT_PROFILE_ENTRIES;
+
+	if (valid)
+	{
+		taskENTER_CRITICAL();
+		*profile = bus_profiles[entry];
+		taskEXIT_CRITICAL();
+	}
+
+	return valid;
+}
+
+void output_bus_profile_reset(void)
+{
+	for (uint8_t entry = 0U; entry < (uint8_t)OUTPUT_PROFILE_ENTRIES; entry++)
+	{
+		taskENTER_CRITICAL();
+		bus_profile_reset(&bus_profiles[entry]);
+		taskEXIT_CRITICAL();
+	}
+}
+
 void set_pwm_duty(uint8_t duty)
 {
 	// Square the fade value to make the LED's brightness appear more linear
@@ -0,0 +1,353 @@
+/**
+ * @file app_profiles.c
+ * @brief Configuration banks switched with a single host command.
+ *
+ * Profile commands are decoded by the inbound processing task, so edits and
+ * switches are serialised with each other. The scan tasks and the output
+ * buses only read the active bank, and edits are refused while a bank may
+ * still be read.
+ */
+
+#include "app_profiles.h"
+
+#include <string.h>
+
+#include "app_storage.h"
+
+/**
+ * @brief Bank table and active selection (persisted as a single record).
+ */
+typedef struct profile_table_t {
+	profile_bank_t banks[PROFILE_BANK_COUNT]; /**< Configuration banks. */
+	uint8_t active_bank;                      /**< Bank selected at boot. */
+} profile_table_t;
+
+/**
+ * @brief Bank table (module scope).
+ */
+static profile_table_t profiles;
+
+/**
+ * @brief Check whether a bank may be modified.
+ *
+ * @param[in] bank Bank index (already range-checked).
+ *
+ * @return `true` when neither the scan tasks, the output buses nor the
+ *         selection use the bank.
+ */
+static bool bank_is_editable(uint8_t bank)
+{
+	return (bank != profiles.active_bank) && !input_profile_in_use(&profiles.banks[bank].input) &&
+	       !output_bank_in_use(&profiles.banks[bank].output);
+}
+
+/**
+ * @brief Reset a bank to the compile-time input and output configuration.
+ *
+ * @param[out] bank Bank to reset.
+ */
+static void bank_set_defaults(profile_bank_t *bank)
+{
+	(void)memset(bank, 0, sizeof(*bank));
+	bank->input.config = *input_default_config();
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+	{
+		bank->output.device_map[slot] = output_slot_device(slot, false);
+		bank->output.timing[slot].spi_khz = (uint16_t)OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+		bank->output.timing[slot].select_settle_us = (uint8_t)OUTPUT_TIMING_DEFAULT_SETTLE_US;
+		bank->output.timing[slot].tm1637_half_period_us = (uint8_t)OUTPUT_TIMING_DEFAULT_TM1637_US;
+	}
+	bank->prepared = false;
+}
+
+/**
+ * @brief Make a bank the one used by the inputs and outputs.
+ *
+ * @param[in] bank Bank index (already range-checked).
+ *
+ * @retval PROFILE_OK                 The bank is active.
+ * @retval PROFILE_ERR_INVALID_CONFIG The input configuration or the output
+ *                                    timing was rejected.
+ */
+static profile_result_t activate_bank(uint8_t bank)
+{
+	profile_result_t result = PROFILE_OK;
+	profile_bank_t *entry = &profiles.banks[bank];
+
+	// The derived tables are rebuilt here, never on the active bank
+	if (!entry->prepared)
+	{
+		if (INPUT_OK == input_prepare_profile(&entry->input))
+		{
+			entry->prepared = true;
+		}
+		else
+		{
+			result = PROFILE_ERR_INVALID_CONFIG;
+		}
+	}
+
+	// Outputs go first: a bank whose output part is rejected is not activated.
+	// Each side then switches with one pointer store, latched between transfers
+	// and scans, so neither mixes two banks.
+	if ((PROFILE_OK == result) && (OUTPUT_OK != output_set_active_bank(&entry->output)))
+	{
+		result = PROFILE_ERR_INVALID_CONFIG;
+	}
+
+	if (PROFILE_OK == result)
+	{
+		(void)input_set_active_profile(&entry->input);
+		profiles.active_bank = bank;
+	}
+
+	return result;
+}
+
+void profile_init(void)
+{
+	bool loaded = (STORAGE_OK == storage_load(STORAGE_REGION_PROFILES, PROFILE_STORAGE_VERSION, &profiles, sizeof(profiles)));
+
+	if (loaded)
+	{
+		// Derived tables are rebuilt from the stored configuration on activation
+		for (uint8_t bank = 0U; bank < (uint8_t)PROFILE_BANK_COUNT; bank++)
+		{
+			profiles.banks[bank].input.config.input_event_queue = NULL;
+			profiles.banks[bank].prepared = false;
+		}
+
+		loaded = (profiles.active_bank < (uint8_t)PROFILE_BANK_COUNT) &&
+		         (PROFILE_OK == activate_bank(profiles.active_bank));
+	}
+
+	if (!loaded)
+	{
+		for (uint8_t bank = 0U; bank < (uint8_t)PROFILE_BANK_COUNT; bank++)
+		{
+			bank_set_defaults(&profiles.banks[bank]);
+		}
+		(void)activate_bank(0U);
+	}
+}
+
+uint8_t profile_active_bank(void)
+{
+	return profiles.active_bank;
+}
+
+profile_result_t profile_select(uint8_t bank)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if (bank >= (uint8_t)PROFILE_BANK_COUNT)
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else if (bank != profiles.active_bank)
+	{
+		result = activate_bank(bank);
+	}
+
+	return result;
+}
+
+profile_result_t profile_copy(uint8_t source, uint8_t destination)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if ((source >= (uint8_t)PROFILE_BANK_COUNT) || (destination >= (uint8_t)PROFILE_BANK_COUNT))
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else if (!bank_is_editable(destination))
+	{
+		result = PROFILE_ERR_BUSY;
+	}
+	else if (source != destination)
+	{
+		profiles.banks[destination] = profiles.banks[source];
+	}
+
+	return result;
+}
+
+profile_result_t profile_set_field(uint8_t bank, uint8_t field, uint16_t value)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if (bank >= (uint8_t)PROFILE_BANK_COUNT)
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else if (!bank_is_editable(bank))
+	{
+		result = PROFILE_ERR_BUSY;
+	}
+	else if (INPUT_OK != input_config_set_field(&profiles.banks[bank].input.config, field, value))
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		profiles.banks[bank].prepared = false;
+	}
+
+	return result;
+}
+
+profile_result_t profile_set_encoder(uint8_t bank, uint8_t index, const encoder_map_t *mapping)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if ((bank >= (uint8_t)PROFILE_BANK_COUNT) || (index >= (uint8_t)MAX_NUM_ENCODERS) || (NULL == mapping))
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else if (!bank_is_editable(bank))
+	{
+		result = PROFILE_ERR_BUSY;
+	}
+	else
+	{
+		profiles.banks[bank].input.config.encoder_map[index] = *mapping;
+		profiles.banks[bank].prepared = false;
+	}
+
+	return result;
+}
+
+profile_result_t profile_set_output_map(uint8_t bank, const uint8_t *map)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if ((bank >= (uint8_t)PROFILE_BANK_COUNT) || (NULL == map))
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+
+	for (uint8_t slot = 0U; (slot < (uint8_t)MAX_SPI_INTERFACES) && (PROFILE_OK == result); slot++)
+	{
+		if (((uint8_t)DEVICE_NONE != map[slot]) && (output_slot_device(slot, false) != map[slot]))
+		{
+			result = PROFILE_ERR_INVALID_PARAM;
+		}
+	}
+
+	if ((PROFILE_OK == result) && !bank_is_editable(bank))
+	{
+		result = PROFILE_ERR_BUSY;
+	}
+
+	if (PROFILE_OK == result)
+	{
+		(void)memcpy(profiles.banks[bank].output.device_map, map, sizeof(profiles.banks[bank].output.device_map)); // flawfinder: ignore
+	}
+
+	return result;
+}
+
+profile_result_t profile_set_slot_timing(uint8_t bank, uint8_t slot, const output_slot_timing_t *timing)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if ((bank >= (uint8_t)PROFILE_BANK_COUNT) || (slot >= (uint8_t)MAX_SPI_INTERFACES) ||
+	    !output_slot_timing_valid(timing))
+	{
+		result = PROFILE_ERR_INVALID_PARAM;
+	}
+	else if (!bank_is_editable(bank))
+	{
+		result = PROFILE_ERR_BUSY;
+	}
+	else
+	{
+		profiles.banks[bank].output.timing[slot] = *timing;
+	}
+
+	return result;
+}
+
+profile_result_t profile_save(void)
+{
+	profile_result_t result = PROFILE_OK;
+
+	if (STORAGE_OK != storage_save(STORAGE_REGION_PROFILES, PROFILE_STORAGE_VERSION, &profiles, sizeof(profiles)))
+	{
+		result = PROFILE_ERR_STORAGE;
+	}
+
+	return result;
+}
+
+profile_result_t profile_process_command(const uint8_t *payload, uint8_t length)
+{
+	profile_result_t result = PROFILE_ERR_INVALID_PARAM;
+	const uint8_t sub_command = ((NULL != payload) && (0U != length)) ? payload[0] : 0xFFU;
+
+	switch (sub_command)
+	{
+	case PROFILE_CMD_SELECT:
+		if (length >= 2U)
+		{
+			result = profile_select(payload[1]);
+		}
+		break;
+
+	case PROFILE_CMD_COPY:
+		if (length >= 3U)
+		{
+			result = profile_copy(payload[1], payload[2]);
+		}
+		break;
+
+	case PROFILE_CMD_SET_FIELD:
+		if (length >= 5U)
+		{
+			const uint16_t value = (uint16_t)(((uint16_t)payload[3] << 8U) | payload[4]);
+			result = profile_set_field(payload[1], payload[2], value);
+		}
+		break;
+
+	case PROFILE_CMD_SET_ENCODER:
+		if (length >= 6U)
+		{
+			const encoder_map_t mapping = {
+				.row = payload[3],
+				.col = payload[4],
+				.enabled = (0U != payload[5])
+			};
+			result = profile_set_encoder(payload[1], payload[2], &mapping);
+		}
+		break;
+
+	case PROFILE_CMD_SET_OUTPUTS:
+		if (length >= (2U + MAX_SPI_INTERFACES))
+		{
+			result = profile_set_output_map(payload[1], &payload[2]);
+		}
+		break;
+
+	case PROFILE_CMD_SAVE:
+		result = profile_save();
+		break;
+
+	case PROFILE_CMD_SET_TIMING:
+		if (length >= 7U)
+		{
+			const output_slot_timing_t timing = {
+				.spi_khz = (uint16_t)(((uint16_t)payload[3] << 8U) | payload[4]),
+				.select_settle_us = payload[5],
+				.tm1637_half_period_us = payload[6]
+			};
+			result = profile_set_slot_timing(payload[1], payload[2], &timing);
+		}
+		break;
+
+	default:
+		// Empty payload or unknown sub-command
+		break;
+	}
+
+	return result;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file app_scenes.c
+ * @brief Stored output scenes recalled with a single host command.
+ *
+ * Scene commands are decoded by the inbound processing task, so uploads and
+ * applies are naturally serialised and the table needs no extra locking.
+ */
+
+#include "app_scenes.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "app_storage.h"
+
+/**
+ * @brief Scene table (module scope, persisted as a single storage record).
+ */
+static output_scene_t scenes[SCENE_MAX_COUNT];
+
+void scene_init(void)
+{
+	if (STORAGE_OK != storage_load(STORAGE_REGION_SCENES, SCENE_STORAGE_VERSION, scenes, sizeof(scenes)))
+	{
+		(void)memset(scenes, 0, sizeof(scenes));
+	}
+}
+
+scene_result_t scene_store_slot(uint8_t scene_id, uint8_t controller_id, const output_slot_image_t *image)
+{
+	scene_result_t result = SCENE_OK;
+
+	if ((scene_id >= (uint8_t)SCENE_MAX_COUNT) ||
+	    (NULL == image) ||
+	    (0U == controller_id) ||
+	    (controller_id > (uint8_t)MAX_SPI_INTERFACES) ||
+	    ((image->dot_position >= (uint8_t)OUTPUT_IMAGE_SIZE) && ((uint8_t)OUTPUT_NO_DECIMAL_POINT != image->dot_position)))
+	{
+		result = SCENE_ERR_INVALID_PARAM;
+	}
+	else if ((uint8_t)DEVICE_NONE == output_slot_device(controller_id - 1U, true))
+	{
+		result = SCENE_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		const uint8_t slot = controller_id - (uint8_t)1;
+		scenes[scene_id].slots[slot] = *image;
+		scenes[scene_id].slot_mask |= (uint8_t)(1U << slot);
+	}
+
+	return result;
+}
+
+scene_result_t scene_clear(uint8_t scene_id)
+{
+	scene_result_t result = SCENE_OK;
+
+	if (scene_id >= (uint8_t)SCENE_MAX_COUNT)
+	{
+		result = SCENE_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		(void)memset(&scenes[scene_id], 0, sizeof(scenes[scene_id]));
+	}
+
+	return result;
+}
+
+scene_result_t scene_apply(uint8_t scene_id)
+{
+	scene_result_t result = SCENE_OK;
+	uint8_t slot_mask = 0U;
+
+	if (scene_id >= (uint8_t)SCENE_MAX_COUNT)
+	{
+		result = SCENE_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		// Only the slots the active profile drives; the scene may predate it
+		for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+		{
+			if ((0U != (scenes[scene_id].slot_mask & (uint8_t)(1U << slot))) &&
+			    ((uint8_t)DEVICE_NONE != output_slot_device(slot, true)))
+			{
+				slot_mask |= (uint8_t)(1U << slot);
+			}
+		}
+	}
+
+	if ((SCENE_OK == result) && (0U == slot_mask))
+	{
+		result = SCENE_ERR_EMPTY;
+	}
+	else if ((SCENE_OK == result) && (OUTPUT_OK != output_apply_images(scenes[scene_id].slots, slot_mask)))
+	{
+		result = SCENE_ERR_OUTPUT;
+	}
+
+	return result;
+}
+
+scene_result_t scene_save(void)
+{
+	scene_result_t result = SCENE_OK;
+
+	if (STORAGE_OK != storage_save(STORAGE_REGION_SCENES, SCENE_STORAGE_VERSION, scenes, sizeof(scenes)))
+	{
+		result = SCENE_ERR_STORAGE;
+	}
+
+	return result;
+}
+
+scene_result_t scene_process_command(const uint8_t *payload, uint8_t length)
+{
+	scene_result_t result = SCENE_ERR_INVALID_PARAM;
+	const uint8_t sub_command = ((NULL != payload) && (0U != length)) ? payload[0] : 0xFFU;
+
+	switch (sub_command)
+	{
+	case SCENE_CMD_UPLOAD:
+		if (length >= (uint8_t)SCENE_UPLOAD_PAYLOAD_SIZE)
+		{
+			output_slot_image_t image;
+			image.brightness = payload[3];
+			image.dot_position = payload[4];
+			(void)memcpy(image.data, &payload[5], sizeof(image.data)); // flawfinder: ignore
+			result = scene_store_slot(payload[1], payload[2], &image);
+		}
+		break;
+
+	case SCENE_CMD_CLEAR:
+		if (length >= 2U)
+		{
+			result = scene_clear(payload[1]);
+		}
+		break;
+
+	case SCENE_CMD_APPLY:
+		if (length >= 2U)
+		{
+			result = scene_apply(payload[1]);
+		}
+		break;
+
+	case SCENE_CMD_SAVE:
+		result = scene_save();
+		break;
+
+	default:
+		// Empty payload or unknown sub-command
+		break;
+	}
+
+	return result;
+}
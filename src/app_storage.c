@@ -0,0 +1,174 @@
+/**
+ * @file app_storage.c
+ * @brief CRC-protected configuration records kept in on-board flash.
+ */
+
+#include "app_storage.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <hardware/flash.h>
+#include <pico/flash.h>
+
+#include "FreeRTOS.h"
+
+#include "error_management.h"
+
+/** Largest payload that fits in a region sector next to its header. */
+#define STORAGE_MAX_PAYLOAD (FLASH_SECTOR_SIZE - sizeof(storage_header_t))
+
+/**
+ * @brief Parameters handed to @ref storage_write_sector().
+ */
+typedef struct storage_write_request_t {
+	uint32_t offset;       /**< Flash offset of the region sector. */
+	const uint8_t *buffer; /**< Page-padded record image. */
+	size_t length;         /**< Record image length (multiple of FLASH_PAGE_SIZE). */
+} storage_write_request_t;
+
+/**
+ * @brief Flash offset of the sector owned by @p region.
+ *
+ * @param[in] region Storage region.
+ * @return Offset from the start of flash.
+ */
+static inline uint32_t storage_region_offset(storage_region_t region)
+{
+	return (uint32_t)PICO_FLASH_SIZE_BYTES - (((uint32_t)region + 1U) * (uint32_t)FLASH_SECTOR_SIZE);
+}
+
+/**
+ * @brief Erase and program one region sector.
+ *
+ * Runs with the other core parked and interrupts disabled, as required while
+ * the XIP cache is unavailable.
+ *
+ * @param[in] param Pointer to a @ref storage_write_request_t.
+ */
+static void storage_write_sector(void *param)
+{
+	const storage_write_request_t *request = (const storage_write_request_t *)param;
+
+	flash_range_erase(request->offset, FLASH_SECTOR_SIZE);
+	flash_range_program(request->offset, request->buffer, request->length);
+}
+
+uint32_t storage_crc32(const uint8_t *data, size_t length)
+{
+	// Nibble table keeps the flash footprint at 64 bytes
+	static const uint32_t crc_nibble_table[16] = {
+		0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+		0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+		0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+		0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+	};
+
+	uint32_t crc = 0xFFFFFFFFU;
+
+	if (NULL == data)
+	{
+		return 0U;
+	}
+
+	for (size_t i = 0U; i < length; i++)
+	{
+		crc ^= data[i];
+		crc = (crc >> 4U) ^ crc_nibble_table[crc & 0x0FU];
+		crc = (crc >> 4U) ^ crc_nibble_table[crc & 0x0FU];
+	}
+
+	return crc ^ 0xFFFFFFFFU;
+}
+
+storage_result_t storage_load(storage_region_t region, uint16_t version, void *data, size_t length)
+{
+	storage_result_t result = STORAGE_OK;
+
+	if ((region >= NUM_STORAGE_REGIONS) || (NULL == data) ||
+	    (0U == length) || (length > STORAGE_MAX_PAYLOAD))
+	{
+		result = STORAGE_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		const uint8_t *record = (const uint8_t *)(uintptr_t)(XIP_BASE + storage_region_offset(region));
+		storage_header_t header;
+		(void)memcpy(&header, record, sizeof(header)); // flawfinder: ignore
+
+		if ((STORAGE_MAGIC != header.magic) ||
+		    (version != header.version) ||
+		    (length != (size_t)header.length) ||
+		    (header.crc != storage_crc32(&record[sizeof(header)], length)))
+		{
+			result = STORAGE_ERR_EMPTY;
+		}
+		else
+		{
+			(void)memcpy(data, &record[sizeof(header)], length); // flawfinder: ignore
+		}
+	}
+
+	return result;
+}
+
+storage_result_t storage_save(storage_region_t region, uint16_t version, const void *data, size_t length)
+{
+	storage_result_t result = STORAGE_OK;
+	uint8_t *buffer = NULL;
+	size_t image_length = 0U;
+
+	if ((region >= NUM_STORAGE_REGIONS) || (NULL == data) ||
+	    (0U == length) || (length > STORAGE_MAX_PAYLOAD))
+	{
+		result = STORAGE_ERR_INVALID_PARAM;
+	}
+
+	if (STORAGE_OK == result)
+	{
+		// flash_range_program() only accepts whole pages
+		image_length = (sizeof(storage_header_t) + length + (FLASH_PAGE_SIZE - 1U)) & ~((size_t)FLASH_PAGE_SIZE - 1U);
+		buffer = (uint8_t *)pvPortMalloc(image_length);
+		if (NULL == buffer)
+		{
+			result = STORAGE_ERR_NO_MEMORY;
+		}
+	}
+
+	if (STORAGE_OK == result)
+	{
+		const storage_header_t header = {
+			.magic = STORAGE_MAGIC,
+			.version = version,
+			.length = (uint16_t)length,
+			.crc = storage_crc32((const uint8_t *)data, length)
+		};
+
+		(void)memset(buffer, 0xFF, image_length);
+		(void)memcpy(buffer, &header, sizeof(header)); // flawfinder: ignore
+		(void)memcpy(&buffer[sizeof(header)], data, length); // flawfinder: ignore
+
+		storage_write_request_t request = {
+			.offset = storage_region_offset(region),
+			.buffer = buffer,
+			.length = image_length
+		};
+
+		if (PICO_OK != flash_safe_execute(storage_write_sector, &request, STORAGE_SAFE_EXECUTE_TIMEOUT_MS))
+		{
+			result = STORAGE_ERR_FLASH;
+		}
+	}
+
+	if (NULL != buffer)
+	{
+		vPortFree(buffer);
+	}
+
+	if ((STORAGE_OK != result) && (STORAGE_ERR_INVALID_PARAM != result))
+	{
+		statistics_increment_counter(STORAGE_ERROR);
+	}
+
+	return result;
+}
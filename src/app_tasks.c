@@ -21,9 +21,13 @@
 #include "app_config.h"
 #include "app_context.h"
 #include "app_inputs.h"
+#include "app_outputs.h"
+#include "black_box.h"
 #include "data_event.h"
 #include "encoded_framer.h"
 #include "error_management.h"
+#include "idle_work.h"
+#include "usb_sof.h"
 
 static void uart_event_task(void *pvParameters);
 static void cdc_task(void *pvParameters);
@@ -120,6 +124,7 @@ static void delete_task_if_exists(task_enum_t task_id)
 		props->task_handle = NULL;
 	}
 	props->high_watermark = 0U;
+	props->heartbeat = 0U;
 }
 
 bool app_tasks_create_application(void)
@@ -174,6 +179,42 @@ bool app_tasks_create_application(void)
 		                                    ERROR_RESOURCE_ALLOCATION);
 	}
 
+	if (success)
+	{
+		success = create_task_with_affinity(display_refresh_task,
+		                                    "display_refresh_task",
+		                                    DISPLAY_REFRESH_STACK_SIZE,
+		                                    (void *)app_context_task_props(DISPLAY_REFRESH_TASK),
+		                                    mainDISPLAY_REFRESH_TASK_PRIORITY,
+		                                    DISPLAY_REFRESH_TASK,
+		                                    DISPLAY_REFRESH_TASK_CORE_AFFINITY,
+		                                    ERROR_RESOURCE_ALLOCATION);
+	}
+
+	if (success)
+	{
+		success = create_task_with_affinity(output_spi0_task,
+		                                    "output_spi0_task",
+		                                    OUTPUT_BUS_STACK_SIZE,
+		                                    (void *)app_context_task_props(OUTPUT_SPI0_TASK),
+		                                    mainOUTPUT_BUS_TASK_PRIORITY,
+		                                    OUTPUT_SPI0_TASK,
+		                                    OUTPUT_BUS_TASK_CORE_AFFINITY,
+		                                    ERROR_RESOURCE_ALLOCATION);
+	}
+
+	if (success)
+	{
+		success = create_task_with_affinity(output_spi1_task,
+		                                    "output_spi1_task",
+		                                    OUTPUT_BUS_STACK_SIZE,
+		                                    (void *)app_context_task_props(OUTPUT_SPI1_TASK),
+		                                    mainOUTPUT_BUS_TASK_PRIORITY,
+		                                    OUTPUT_SPI1_TASK,
+		                                    OUTPUT_BUS_TASK_CORE_AFFINITY,
+		                                    ERROR_RESOURCE_ALLOCATION);
+	}
+
 	return success;
 }
 
@@ -272,6 +313,9 @@ void app_tasks_cleanup_application(void)
 	delete_task_if_exists(ADC_READ_TASK);
 	delete_task_if_exists(KEYPAD_TASK);
 	delete_task_if_exists(LED_STATUS_TASK);
+	delete_task_if_exists(DISPLAY_REFRESH_TASK);
+	delete_task_if_exists(OUTPUT_SPI0_TASK);
+	delete_task_if_exists(OUTPUT_SPI1_TASK);
 }
 
 static void cleanup_comm_subsystem(void)
@@ -327,7 +371,7 @@ static void uart_event_task(void *pvParameters)
 
 	for (;;)
 	{
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 		watchdog_update();
 
 		QueueHandle_t queue = app_context_get_encoded_queue();
@@ -383,8 +427,8 @@ static void uart_event_task(void *pvParameters)
 		}
 
 		/* Block until tud_cdc_rx_cb notifies us or the safety timeout
-		 * elapses.  Timeout keeps the task alive for watchdog /
-		 * watermark updates even when the host is idle. */
+		 * elapses.  Timeout keeps the task alive for watchdog
+		 * updates even when the host is idle. */
 		(void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UART_EVENT_TASK_WAIT_MS));
 	}
 }
@@ -395,8 +439,8 @@ static void uart_event_task(void *pvParameters)
  * With CFG_TUSB_OS=OPT_OS_FREERTOS, tud_task_ext() blocks on the TinyUSB
  * event queue until an IRQ posts work, so this task consumes no CPU while
  * the bus is idle.  A bounded timeout is used instead of WAIT_FOREVER so
- * the task still wakes periodically to pet the watchdog and refresh the
- * stack watermark when the link is quiet.
+ * the task still wakes periodically to pet the watchdog when the link is
+ * quiet.
  *
  * @param[in,out] pvParameters Pointer to the owning task properties structure.
  */
@@ -406,7 +450,7 @@ static void cdc_task(void *pvParameters)
 	for (;;)
 	{
 		tud_task_ext(CDC_TASK_SAFETY_TIMEOUT_MS, false);
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 		watchdog_update();
 	}
 }
@@ -424,7 +468,7 @@ static void decode_reception_task(void *pvParameters)
 
 	for (;;)
 	{
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 		watchdog_update();
 
 		// Get queue handle and wait if not created yet
@@ -471,7 +515,7 @@ static void process_outbound_task(void *pvParameters)
 
 	for (;;)
 	{
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 		watchdog_update();
 
 		QueueHandle_t data_queue = app_context_get_data_event_queue();
@@ -486,14 +530,89 @@ static void process_outbound_task(void *pvParameters)
 		BaseType_t result = xQueueReceive(data_queue, (void *)&data_event, portMAX_DELAY);
 		if (pdPASS == result)
 		{
+			input_event_dequeued(&data_event);
+			black_box_trace(BLACK_BOX_EVENT_TX_EVENT, data_event.command, (uint16_t)uxQueueMessagesWaiting(data_queue));
 			app_comm_send_packet(BOARD_ID, data_event.command, data_event.data, data_event.data_length);
 		}
 	}
 }
 
+/**
+ * @brief Copy one encoded packet into the TinyUSB CDC TX FIFO.
+ *
+ * TinyUSB arms the endpoint on its own once a full bulk packet is buffered;
+ * anything shorter stays in the FIFO until the next explicit flush.
+ *
+ * @param[in] packet Packet to write.
+ */
+static void cdc_write_packet(const cdc_packet_t *packet)
+{
+	size_t total_written = 0U;
+	while (total_written < packet->length)
+	{
+		const uint32_t available = tud_cdc_n_write_available(0);
+		const uint32_t remaining = (uint32_t)packet->length - (uint32_t)total_written;
+		const uint32_t to_write = (available < remaining) ? available : remaining;
+
+		if (to_write > 0U)
+		{
+			uint32_t written = tud_cdc_n_write(0, &packet->data[total_written], to_write);
+			total_written += written;
+		}
+
+		/* tud_task() is serviced exclusively by cdc_task to avoid
+		 * reentering the TinyUSB device stack from two tasks. */
+		taskYIELD();
+	}
+
+	statistics_add_to_counter(BYTES_SENT, (uint32_t)total_written);
+}
+
+/**
+ * @brief Hardware alarm callback that wakes @ref cdc_write_task at its flush point.
+ *
+ * @param[in] id        Alarm identifier (unused).
+ * @param[in] user_data Handle of the task to notify.
+ *
+ * @return 0 so the alarm is not rescheduled.
+ */
+static int64_t cdc_flush_alarm_cb(alarm_id_t id, void *user_data)
+{
+	(void)id;
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	vTaskNotifyGiveFromISR((TaskHandle_t)user_data, &higher_priority_task_woken);
+	portYIELD_FROM_ISR(higher_priority_task_woken);
+	return 0;
+}
+
+/**
+ * @brief Block the calling task for a sub-tick delay.
+ *
+ * The kernel tick is as long as a USB frame, so the wake-up comes from a
+ * one-shot hardware alarm instead of @c vTaskDelay(). The notification wait
+ * is bounded so a lost alarm costs at most a couple of frames.
+ *
+ * @param[in] delay_us Delay in microseconds.
+ */
+static void cdc_write_wait_us(uint32_t delay_us)
+{
+	(void)ulTaskNotifyTake(pdTRUE, 0U); // drop a stale wake-up from an earlier alarm
+
+	// A zero id means the flush point already passed: flush straight away
+	if (add_alarm_in_us(delay_us, cdc_flush_alarm_cb, xTaskGetCurrentTaskHandle(), false) > 0)
+	{
+		(void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CDC_FLUSH_WAIT_TIMEOUT_MS));
+	}
+}
+
 /**
  * @brief Task that transmits encoded packets over USB CDC.
  *
+ * Packets are batched in the TinyUSB FIFO and flushed shortly before the
+ * next expected start-of-frame (see @ref usb_sof.h), so each flush is ready
+ * for the first IN poll of the next frame. Without SOF timing (no host yet,
+ * or bus suspended) every batch is flushed immediately.
+ *
  * @param[in,out] pvParameters Pointer to the owning task properties structure.
  */
 static void cdc_write_task(void *pvParameters)
@@ -511,35 +630,107 @@ static void cdc_write_task(void *pvParameters)
 				vTaskDelay(pdMS_TO_TICKS(QUEUE_RETRY_DELAY_MS));
 			}
 
-			size_t total_written = 0U;
-			while (total_written < packet.length)
-			{
-				const uint32_t available = tud_cdc_n_write_available(0);
-				const uint32_t remaining = (uint32_t)packet.length - (uint32_t)total_written;
-				const uint32_t to_write = (available < remaining) ? available : remaining;
+			cdc_write_packet(&packet);
+			uint16_t batched = 1U;
 
-				if (to_write > 0U)
-				{
-					uint32_t written = tud_cdc_n_write(0, &packet.data[total_written], to_write);
-					total_written += written;
-				}
+			const uint32_t delay_us = usb_sof_flush_delay_us(time_us_32());
+			if (delay_us > 0U)
+			{
+				cdc_write_wait_us(delay_us);
+			}
 
-				/* tud_task() is serviced exclusively by cdc_task to avoid
-				 * reentering the TinyUSB device stack from two tasks. */
-				taskYIELD();
+			// Everything queued while waiting joins the same flush
+			while (pdTRUE == xQueueReceive(queue, &packet, 0U))
+			{
+				cdc_write_packet(&packet);
+				batched++;
 			}
 
 			(void)tud_cdc_write_flush();
-			statistics_add_to_counter(BYTES_SENT, (uint32_t)total_written);
+			usb_sof_on_flush(time_us_32());
+			black_box_trace(BLACK_BOX_EVENT_TX_FLUSH, 0U, batched);
 		}
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 		watchdog_update();
 	}
 }
 
+/**
+ * @brief Items waiting in a queue, or 0 before it exists.
+ *
+ * @param[in] queue Queue handle, may be `NULL`.
+ * @return Number of items waiting, saturated to 16 bits.
+ */
+static uint16_t queue_depth(QueueHandle_t queue)
+{
+	uint16_t depth = 0U;
+
+	if (NULL != queue)
+	{
+		const UBaseType_t waiting = uxQueueMessagesWaiting(queue);
+		depth = (waiting > 0xFFFFU) ? 0xFFFFU : (uint16_t)waiting;
+	}
+
+	return depth;
+}
+
+/**
+ * @brief Store the queue depths, task heartbeats and USB slack histogram in the black box.
+ */
+static void black_box_record_load(void)
+{
+	black_box_snapshot_t snapshot = {0};
+
+	snapshot.uptime_ms = (uint32_t)(((uint64_t)xTaskGetTickCount() * 1000U) / configTICK_RATE_HZ);
+	snapshot.queue_depth[BLACK_BOX_QUEUE_ENCODED] = queue_depth(app_context_get_encoded_queue());
+	snapshot.queue_depth[BLACK_BOX_QUEUE_CDC_TRANSMIT] = queue_depth(app_context_get_cdc_transmit_queue());
+	snapshot.queue_depth[BLACK_BOX_QUEUE_DATA_EVENT] = queue_depth(app_context_get_data_event_queue());
+	for (uint8_t i = 0U; i < (uint8_t)NUM_TASKS; i++)
+	{
+		snapshot.heartbeat[i] = app_context_task_props((task_enum_t)i)->heartbeat;
+	}
+	for (uint8_t bucket = 0U; bucket < (uint8_t)USB_SOF_SLACK_BUCKETS; bucket++)
+	{
+		snapshot.slack_histogram[bucket] = usb_sof_slack_count(bucket);
+	}
+
+	black_box_snapshot(&snapshot);
+}
+
+/**
+ * @brief Sample the stack high watermark of every task.
+ *
+ * Each sample scans the unused part of a stack, so it runs as an idle job
+ * instead of in every task loop.
+ *
+ * @param[in] context Unused.
+ */
+static void sample_stack_watermarks(void *context)
+{
+	(void)context;
+
+	for (uint8_t i = 0U; i < (uint8_t)NUM_TASKS; i++)
+	{
+		task_props_t *const props = app_context_task_props((task_enum_t)i);
+		const TaskHandle_t handle = props->task_handle;
+		if (NULL != handle)
+		{
+			props->high_watermark = uxTaskGetStackHighWaterMark(handle);
+		}
+	}
+}
+
+/** Idle job refreshing the stack watermarks. */
+static idle_job_t watermark_job = { .function = sample_stack_watermarks, .context = NULL, .pending = false };
+
 /**
  * @brief Task that drives the status LED based on system state.
  *
+ * Each pass also refreshes the black box snapshot, so after a reset it shows
+ * the load of the pipeline at most one pass before the stall. The snapshot
+ * stays here rather than in idle time, which an overload starves. The stack
+ * watermark scan is posted to the idle time of this core.
+ *
  * @param[in,out] pvParameters Pointer to the owning task properties structure.
  */
 static void led_status_task(void *pvParameters)
@@ -580,8 +771,10 @@ static void led_status_task(void *pvParameters)
 			vTaskDelay(pdMS_TO_TICKS(LED_POLL_INTERVAL_MS));
 		}
 
+		black_box_record_load();
+		(void)idle_work_post(&watermark_job);
 		watchdog_update();
-		task_prop->high_watermark = uxTaskGetStackHighWaterMark(NULL);
+		task_prop->heartbeat++;
 	}
 }
 
@@ -0,0 +1,221 @@
+/**
+ * @file black_box.c
+ * @brief Crash-surviving record of what the pipeline was doing before a reset.
+ */
+
+#include "black_box.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <pico/stdlib.h>
+
+#include "app_config.h"
+#include "app_storage.h"
+#include "mem_placement.h"
+
+_Static_assert(NUM_TASKS <= BLACK_BOX_TASKS, "Snapshot heartbeats must cover every task");
+
+/** Bytes of a trace record covered by its CRC. */
+#define RECORD_CRC_BYTES offsetof(black_box_record_t, crc)
+/** Bytes of a snapshot covered by its CRC. */
+#define SNAPSHOT_CRC_BYTES offsetof(black_box_snapshot_t, crc)
+/** Bytes of the header covered by its CRC. */
+#define HEADER_CRC_BYTES offsetof(black_box_t, crc)
+
+/**
+ * @brief Black box of the current run.
+ *
+ * Not initialised at startup, so it still holds the previous run when
+ * @ref black_box_boot() looks at it.
+ */
+static black_box_t black_box NOINIT_DATA(black_box);
+
+/** What @ref black_box_boot() recovered from the previous run. */
+static black_box_report_t previous_run;
+
+/** Set once @ref black_box_boot() has cleared the region for this run. */
+static volatile bool recording = false;
+
+/**
+ * @brief CRC-32 of the leading bytes of a record, snapshot or header.
+ */
+static inline uint32_t region_crc(const void *data, size_t length)
+{
+	return storage_crc32((const uint8_t *)data, length);
+}
+
+void black_box_format(black_box_t *box, uint32_t boot_count)
+{
+	(void)memset(box, 0, sizeof(*box));
+	box->magic = BLACK_BOX_MAGIC;
+	box->boot_count = boot_count;
+	box->crc = region_crc(box, HEADER_CRC_BYTES);
+	box->next_snapshot = 1U;
+	for (uint8_t core = 0U; core < (uint8_t)BLACK_BOX_CORES; core++)
+	{
+		box->next_sequence[core] = 1U;
+	}
+}
+
+bool black_box_is_valid(const black_box_t *box)
+{
+	return (BLACK_BOX_MAGIC == box->magic) && (region_crc(box, HEADER_CRC_BYTES) == box->crc);
+}
+
+void black_box_append(black_box_t *box, uint8_t core, uint32_t time_us, black_box_event_t event, uint8_t arg,
+                      uint16_t value)
+{
+	if (core < (uint8_t)BLACK_BOX_CORES)
+	{
+		const uint32_t sequence = box->next_sequence[core];
+		black_box_record_t record = {
+			.sequence = sequence,
+			.time_us = time_us,
+			.event = (uint8_t)event,
+			.arg = arg,
+			.value = value,
+			.crc = 0U,
+		};
+
+		record.crc = region_crc(&record, RECORD_CRC_BYTES);
+		box->trace[core][sequence % BLACK_BOX_TRACE_DEPTH] = record;
+		box->next_sequence[core] = sequence + 1U;
+	}
+}
+
+/**
+ * @brief Check the CRC of a stored snapshot.
+ */
+static bool snapshot_is_valid(const black_box_snapshot_t *snapshot)
+{
+	return (0U != snapshot->sequence) && (region_crc(snapshot, SNAPSHOT_CRC_BYTES) == snapshot->crc);
+}
+
+void black_box_store_snapshot(black_box_t *box, black_box_snapshot_t *snapshot)
+{
+	snapshot->sequence = box->next_snapshot;
+	snapshot->reserved = 0U;
+	snapshot->crc = region_crc(snapshot, SNAPSHOT_CRC_BYTES);
+
+	// Overwrites the older slot, so the newer one survives a torn copy
+	box->snapshot[snapshot->sequence % BLACK_BOX_SNAPSHOT_SLOTS] = *snapshot;
+	box->next_snapshot = snapshot->sequence + 1U;
+}
+
+bool black_box_find_snapshot(const black_box_t *box, black_box_snapshot_t *snapshot)
+{
+	const black_box_snapshot_t *newest = NULL;
+
+	for (uint8_t slot = 0U; slot < (uint8_t)BLACK_BOX_SNAPSHOT_SLOTS; slot++)
+	{
+		const black_box_snapshot_t *candidate = &box->snapshot[slot];
+		if (snapshot_is_valid(candidate) &&
+		    ((NULL == newest) || ((int32_t)(candidate->sequence - newest->sequence) > 0)))
+		{
+			newest = candidate;
+		}
+	}
+
+	if (NULL != newest)
+	{
+		*snapshot = *newest;
+	}
+
+	return NULL != newest;
+}
+
+/**
+ * @brief Check the CRC of a trace record and that it sits in its own slot.
+ */
+static bool record_is_valid(const black_box_record_t *record, uint8_t slot)
+{
+	return (0U != record->sequence) && ((record->sequence % BLACK_BOX_TRACE_DEPTH) == slot) &&
+	       (region_crc(record, RECORD_CRC_BYTES) == record->crc);
+}
+
+uint8_t black_box_collect(const black_box_t *box, black_box_record_t records[BLACK_BOX_RECORDS])
+{
+	uint8_t count = 0U;
+	uint32_t newest_us = 0U;
+	bool any = false;
+
+	for (uint8_t core = 0U; core < (uint8_t)BLACK_BOX_CORES; core++)
+	{
+		for (uint8_t slot = 0U; slot < (uint8_t)BLACK_BOX_TRACE_DEPTH; slot++)
+		{
+			const black_box_record_t *record = &box->trace[core][slot];
+			if (record_is_valid(record, slot))
+			{
+				records[count] = *record;
+				count++;
+				if ((!any) || ((int32_t)(record->time_us - newest_us) > 0))
+				{
+					newest_us = record->time_us;
+					any = true;
+				}
+			}
+		}
+	}
+
+	// Insertion sort by age, oldest first; the timer may wrap within the trace
+	for (uint8_t i = 1U; i < count; i++)
+	{
+		const black_box_record_t record = records[i];
+		const uint32_t age = newest_us - record.time_us;
+		uint8_t j = i;
+
+		while ((j > 0U) && ((newest_us - records[j - 1U].time_us) < age))
+		{
+			records[j] = records[j - 1U];
+			j--;
+		}
+		records[j] = record;
+	}
+
+	return count;
+}
+
+void black_box_boot(bool watchdog_reset)
+{
+	uint32_t boot_count = 0U;
+
+	(void)memset(&previous_run, 0, sizeof(previous_run));
+	if (black_box_is_valid(&black_box))
+	{
+		boot_count = black_box.boot_count + 1U;
+		previous_run.valid = true;
+		previous_run.records = black_box_collect(&black_box, previous_run.trace);
+		previous_run.snapshot_valid = black_box_find_snapshot(&black_box, &previous_run.snapshot);
+	}
+	previous_run.boot_count = boot_count;
+
+	black_box_format(&black_box, boot_count);
+	recording = true;
+	black_box_trace(BLACK_BOX_EVENT_BOOT, watchdog_reset ? 1U : 0U, (uint16_t)boot_count);
+}
+
+void black_box_trace(black_box_event_t event, uint8_t arg, uint16_t value)
+{
+	// Before boot the region still holds the previous run
+	if (recording)
+	{
+		// Masking interrupts keeps the ring of this core to one writer at a time
+		const uint32_t status = save_and_disable_interrupts();
+		black_box_append(&black_box, (uint8_t)get_core_num(), time_us_32(), event, arg, value);
+		restore_interrupts(status);
+	}
+}
+
+void black_box_snapshot(black_box_snapshot_t *snapshot)
+{
+	if (recording)
+	{
+		black_box_store_snapshot(&black_box, snapshot);
+	}
+}
+
+const black_box_report_t *black_box_previous(void)
+{
+	return &previous_run;
+}
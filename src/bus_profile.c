@@ -0,0 +1,55 @@
+/**
+ * @file bus_profile.c
+ * @brief Wait and hold time profile of an output bus lock.
+ */
+
+#include "bus_profile.h"
+
+#include <string.h>
+
+uint8_t bus_profile_bucket(uint32_t time_us)
+{
+	uint8_t bucket = 0U;
+	uint32_t bound = BUS_PROFILE_FIRST_US;
+
+	while ((bucket < (uint8_t)(BUS_PROFILE_BUCKETS - 1U)) && (time_us >= bound))
+	{
+		bucket++;
+		bound <<= BUS_PROFILE_BUCKET_SHIFT;
+	}
+
+	return bucket;
+}
+
+void bus_profile_reset(bus_profile_t *profile)
+{
+	(void)memset(profile, 0, sizeof(*profile));
+}
+
+void bus_profile_record_lock(bus_profile_t *profile, uint32_t wait_us, bool contended)
+{
+	profile->locks++;
+	if (contended)
+	{
+		profile->contended++;
+	}
+	if (wait_us > profile->wait_max_us)
+	{
+		profile->wait_max_us = wait_us;
+	}
+	profile->wait[bus_profile_bucket(wait_us)]++;
+}
+
+void bus_profile_record_timeout(bus_profile_t *profile)
+{
+	profile->timeouts++;
+}
+
+void bus_profile_record_hold(bus_profile_t *profile, uint32_t hold_us)
+{
+	if (hold_us > profile->hold_max_us)
+	{
+		profile->hold_max_us = hold_us;
+	}
+	profile->hold[bus_profile_bucket(hold_us)]++;
+}
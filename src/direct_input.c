@@ -0,0 +1,45 @@
+/**
+ * @file direct_input.c
+ * @brief Interrupt-side debounce for direct GPIO inputs.
+ */
+
+#include "direct_input.h"
+
+bool direct_input_edge(direct_input_state_t *state, bool pressed, uint32_t now_us)
+{
+	bool report = false;
+
+	// Unsigned difference stays correct across the 32-bit wrap
+	if (state->locked && ((uint32_t)(now_us - state->edge_us) >= DIRECT_INPUT_LOCKOUT_US))
+	{
+		state->locked = false;
+	}
+
+	if (!state->locked && (pressed != state->pressed))
+	{
+		state->pressed = pressed;
+		state->edge_us = now_us;
+		state->locked = true;
+		report = true;
+	}
+
+	return report;
+}
+
+bool direct_input_lockout_end(direct_input_state_t *state, bool pressed, uint32_t now_us)
+{
+	state->locked = false;
+
+	// A change that settled inside the window starts a new one
+	return direct_input_edge(state, pressed, now_us);
+}
+
+uint8_t direct_input_key_code(uint8_t index, bool pressed)
+{
+	return (uint8_t)((DIRECT_INPUT_COLUMN << 4U) | ((uint32_t)index << 1U) | (pressed ? KEY_PRESSED : KEY_RELEASED));
+}
+
+bool direct_input_is_key_code(uint8_t code)
+{
+	return DIRECT_INPUT_COLUMN == (code >> 4U);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file display_anim.c
+ * @brief Device-side interpolation of numeric display values.
+ */
+
+#include "display_anim.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "display_format.h"
+
+/** Rate accumulator scale: rate (units/s) * period (ms) / 1000 = units per step. */
+#define DISPLAY_ANIM_RATE_SCALE 1000U
+
+/**
+ * @brief Interpret a raw value and clamp it just past the displayable range.
+ *
+ * Anything beyond @ref DISPLAY_FORMAT_MAX_MAGNITUDE shows dashes anyway, and
+ * the clamp keeps every difference between two values within int32_t.
+ *
+ * @param[in] value  Raw value (sign-extended already when signed).
+ * @param[in] format Format descriptor (DISPLAY_FORMAT_* bits).
+ *
+ * @return Value in [-(MAX + 1), MAX + 1].
+ */
+static int32_t clamp_value(uint32_t value, uint8_t format)
+{
+	const int32_t limit = (int32_t)DISPLAY_FORMAT_MAX_MAGNITUDE + 1;
+	int32_t result;
+
+	if (0U != (format & DISPLAY_FORMAT_SIGNED))
+	{
+		const int32_t signed_value = (int32_t)value;
+		result = (signed_value > limit) ? limit : ((signed_value < -limit) ? -limit : signed_value);
+	}
+	else
+	{
+		result = (value > (uint32_t)limit) ? limit : (int32_t)value;
+	}
+
+	return result;
+}
+
+void display_anim_reset(display_anim_t *anim)
+{
+	(void)memset(anim, 0, sizeof(*anim));
+	anim->shown_dot = OUTPUT_NO_DECIMAL_POINT;
+}
+
+bool display_anim_start(display_anim_t *anim, uint32_t target, uint8_t format,
+                        uint8_t decimals, uint16_t slew)
+{
+	const uint8_t width = (uint8_t)((format & DISPLAY_FORMAT_WIDTH_MASK) + 1U);
+	const bool valid = (0U == (format & DISPLAY_FORMAT_RESERVED_MASK)) && (decimals < width);
+
+	if (valid)
+	{
+		const int32_t value = clamp_value(target, format);
+		const uint16_t amount = (uint16_t)(slew & DISPLAY_ANIM_SLEW_MASK);
+
+		// Keep rolling from the displayed value unless the field layout changed
+		if (!anim->shown_valid || (anim->format != format) || (anim->decimals != decimals))
+		{
+			anim->current = value;
+		}
+
+		anim->target = value;
+		anim->format = format;
+		anim->decimals = decimals;
+		anim->rate_accum = 0U;
+
+		if (0U != (slew & DISPLAY_ANIM_SLEW_RATE))
+		{
+			anim->rate = amount;
+			anim->remaining_steps = 0U;
+		}
+		else
+		{
+			anim->rate = 0U;
+			anim->remaining_steps = (uint16_t)((amount + DISPLAY_ANIM_PERIOD_MS - 1U) / DISPLAY_ANIM_PERIOD_MS);
+		}
+
+		if (0U == amount)
+		{
+			anim->current = value;
+		}
+
+		anim->active = true;
+	}
+
+	return valid;
+}
+
+uint8_t display_anim_step(display_anim_t *anim, uint8_t digits[OUTPUT_IMAGE_SIZE],
+                          uint8_t *dot_position)
+{
+	uint8_t changed = 0U;
+
+	if (anim->current != anim->target)
+	{
+		if (0U != anim->rate)
+		{
+			// Whole units covered this period; the remainder carries over
+			const uint32_t progress = (uint32_t)anim->rate_accum + ((uint32_t)anim->rate * DISPLAY_ANIM_PERIOD_MS);
+			const uint32_t units = progress / DISPLAY_ANIM_RATE_SCALE;
+			const bool rising = anim->target > anim->current;
+			const uint32_t distance = rising ? (uint32_t)(anim->target - anim->current) :
+			                          (uint32_t)(anim->current - anim->target);
+
+			anim->rate_accum = (uint16_t)(progress % DISPLAY_ANIM_RATE_SCALE);
+
+			if (units >= distance)
+			{
+				anim->current = anim->target;
+			}
+			else
+			{
+				anim->current = rising ? (anim->current + (int32_t)units) : (anim->current - (int32_t)units);
+			}
+		}
+		else if (anim->remaining_steps > 1U)
+		{
+			// Even share of what is left, so the last step lands on the target
+			anim->current += (anim->target - anim->current) / (int32_t)anim->remaining_steps;
+			anim->remaining_steps--;
+		}
+		else
+		{
+			anim->current = anim->target;
+			anim->remaining_steps = 0U;
+		}
+	}
+
+	(void)display_format_number((uint32_t)anim->current, anim->format, anim->decimals, digits, dot_position);
+
+	for (uint8_t i = 0U; i < (uint8_t)OUTPUT_IMAGE_SIZE; i++)
+	{
+		if (!anim->shown_valid || (digits[i] != anim->shown[i]))
+		{
+			changed |= (uint8_t)(1U << i);
+		}
+	}
+
+	if (anim->shown_valid && (*dot_position != anim->shown_dot))
+	{
+		if (*dot_position < (uint8_t)OUTPUT_IMAGE_SIZE)
+		{
+			changed |= (uint8_t)(1U << *dot_position);
+		}
+		if (anim->shown_dot < (uint8_t)OUTPUT_IMAGE_SIZE)
+		{
+			changed |= (uint8_t)(1U << anim->shown_dot);
+		}
+	}
+
+	(void)memcpy(anim->shown, digits, sizeof(anim->shown)); // flawfinder: ignore
+	anim->shown_dot = *dot_position;
+	anim->shown_valid = true;
+	anim->active = (anim->current != anim->target);
+
+	return changed;
+}
+
+bool display_anim_active(const display_anim_t *anim)
+{
+	return anim->active;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file display_format.c
+ * @brief Device-side formatting of binary numbers for 7-segment displays.
+ */
+
+#include "display_format.h"
+
+#include <stddef.h>
+
+/** Bits needed to represent @ref DISPLAY_FORMAT_MAX_MAGNITUDE. */
+#define DISPLAY_FORMAT_VALUE_BITS 27U
+
+uint32_t display_format_to_bcd(uint32_t value)
+{
+	uint32_t bcd = 0U;
+
+	for (uint8_t i = 0U; i < (uint8_t)DISPLAY_FORMAT_VALUE_BITS; i++)
+	{
+		// Add 3 to every nibble >= 5 before the shift (nibbles never carry)
+		const uint32_t adjust = (bcd + 0x33333333UL) & 0x88888888UL;
+		bcd += (adjust >> 2U) | (adjust >> 3U);
+		bcd = (bcd << 1U) | ((value >> (DISPLAY_FORMAT_VALUE_BITS - 1U - i)) & 1U);
+	}
+
+	return bcd;
+}
+
+bool display_format_number(uint32_t value, uint8_t format, uint8_t decimals,
+                           uint8_t digits[OUTPUT_IMAGE_SIZE], uint8_t *dot_position)
+{
+	const uint8_t width = (uint8_t)((format & DISPLAY_FORMAT_WIDTH_MASK) + 1U);
+	const bool valid = (0U == (format & DISPLAY_FORMAT_RESERVED_MASK)) && (decimals < width);
+
+	if (valid)
+	{
+		const bool negative = (0U != (format & DISPLAY_FORMAT_SIGNED)) && (0U != (value & 0x80000000UL));
+		const uint32_t magnitude = negative ? (0U - value) : value;
+		const uint8_t sign_digits = negative ? 1U : 0U;
+		const uint8_t field_start = (uint8_t)(OUTPUT_IMAGE_SIZE - width);
+
+		for (uint8_t i = 0U; i < (uint8_t)OUTPUT_IMAGE_SIZE; i++)
+		{
+			digits[i] = OUTPUT_DIGIT_BLANK;
+		}
+		*dot_position = OUTPUT_NO_DECIMAL_POINT;
+
+		if ((0U != magnitude) || (0U == (format & DISPLAY_FORMAT_BLANK_ZERO)))
+		{
+			const uint32_t bcd = (magnitude <= DISPLAY_FORMAT_MAX_MAGNITUDE) ? display_format_to_bcd(magnitude) : 0U;
+
+			// Significant digits, keeping one before the decimal point
+			uint8_t count = (uint8_t)(decimals + 1U);
+			for (uint8_t i = count; i < (uint8_t)OUTPUT_IMAGE_SIZE; i++)
+			{
+				if (0U != (bcd >> (4U * i)))
+				{
+					count = (uint8_t)(i + 1U);
+				}
+			}
+
+			if ((magnitude > DISPLAY_FORMAT_MAX_MAGNITUDE) || ((count + sign_digits) > width))
+			{
+				// Does not fit: dashes across the field
+				for (uint8_t i = field_start; i < (uint8_t)OUTPUT_IMAGE_SIZE; i++)
+				{
+					digits[i] = OUTPUT_DIGIT_MINUS;
+				}
+			}
+			else
+			{
+				if (0U != (format & DISPLAY_FORMAT_LEADING_ZEROS))
+				{
+					count = (uint8_t)(width - sign_digits);
+				}
+
+				for (uint8_t i = 0U; i < count; i++)
+				{
+					digits[OUTPUT_IMAGE_SIZE - 1U - i] = (uint8_t)((bcd >> (4U * i)) & 0x0FU);
+				}
+
+				if (negative)
+				{
+					digits[OUTPUT_IMAGE_SIZE - 1U - count] = OUTPUT_DIGIT_MINUS;
+				}
+
+				if (0U != decimals)
+				{
+					*dot_position = (uint8_t)(OUTPUT_IMAGE_SIZE - 1U - decimals);
+				}
+			}
+		}
+	}
+
+	return valid;
+}
@@ -19,6 +19,7 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "black_box.h"
 #include "error_management.h"
 
 /**
@@ -55,6 +56,11 @@ void statistics_increment_counter(statistics_counter_enum_t index)
 {
 	statistics_counters.counters[index]++;
 
+	// Suppressed ADC jitter is routine and would flush the trace
+	if (INPUT_HYSTERESIS_SUPPRESSED != index)
+	{
+		black_box_trace(BLACK_BOX_EVENT_ERROR, (uint8_t)index, (uint16_t)statistics_counters.counters[index]);
+	}
 }
 
 void statistics_add_to_counter(statistics_counter_enum_t index, uint32_t value)
@@ -145,8 +151,9 @@ void setup_watchdog_with_error_detection(uint32_t timeout_ms)
 	gpio_set_dir(ERROR_LED_PIN, GPIO_OUT);
 	gpio_put(ERROR_LED_PIN, 0);
 
+	const bool watchdog_reset = watchdog_caused_reboot();
 	uint32_t watchdog_resets = watchdog_hw->scratch[WATCHDOG_ERROR_COUNT_REG];
-	if (watchdog_caused_reboot())
+	if (watchdog_reset)
 	{
 		watchdog_resets++;
 	}
@@ -158,6 +165,9 @@ void setup_watchdog_with_error_detection(uint32_t timeout_ms)
 	watchdog_hw->scratch[WATCHDOG_ERROR_COUNT_REG] = watchdog_resets;
 	statistics_set_counter(WATCHDOG_ERROR, watchdog_resets);
 
+	// Keep what the previous run left in the black box before anything traces
+	black_box_boot(watchdog_reset);
+
 	// Enable watchdog
 	watchdog_enable(timeout_ms, 1);
 }
@@ -180,6 +190,7 @@ void __attribute__((noreturn)) panic_handler(const char *fmt, ...)
 void __attribute__((noreturn)) fatal_halt(error_type_t type)
 {
 	watchdog_hw->scratch[WATCHDOG_ERROR_LAST_TYPE_REG] = (uint32_t)type;
+	black_box_trace(BLACK_BOX_EVENT_FATAL, (uint8_t)type, 0U);
 	while (true)
 	{
 		show_error_pattern_blocking(type);
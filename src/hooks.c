@@ -10,7 +10,12 @@
  */
 
 #include "hooks.h"
+
+#include <pico/stdlib.h>
+
 #include "error_management.h"
+#include "idle_work.h"
+#include "timer_wheel.h"
 
 //-----------------------------------------------------------
 void vApplicationMallocFailedHook(void)
@@ -39,14 +44,34 @@ void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName) // NOS
 }
 //-----------------------------------------------------------
 
+// Either idle task may run on either core; both drain the ring of the core they run on
 void vApplicationIdleHook(void)
 {
-	static volatile size_t free_heap_size = 0;
-	free_heap_size = xPortGetFreeHeapSize();
+	(void)idle_work_run();
+}
+//-----------------------------------------------------------
+
+void vApplicationPassiveIdleHook(void)
+{
+	(void)idle_work_run();
+}
+//-----------------------------------------------------------
+
+void app_trace_task_switched_in(void)
+{
+	const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	bool to_idle = false;
+
+	for (BaseType_t core = 0; core < (BaseType_t)configNUMBER_OF_CORES; core++)
+	{
+		to_idle = to_idle || (task == xTaskGetIdleTaskHandleForCore(core));
+	}
+
+	idle_work_task_switched((uint8_t)get_core_num(), to_idle, time_us_32());
 }
 //-----------------------------------------------------------
 
 void vApplicationTickHook(void)
 {
-	// Tick hook
+	timer_wheel_tick();
 }
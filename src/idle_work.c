@@ -0,0 +1,127 @@
+/**
+ * @file idle_work.c
+ * @brief Housekeeping deferred to idle time, and per-core idle accounting.
+ */
+
+#include "idle_work.h"
+
+#include <stddef.h>
+
+#include <pico/stdlib.h>
+
+/**
+ * @struct idle_core_t
+ * @brief Ring and counters of one core, only written on that core.
+ */
+typedef struct idle_core_t {
+	idle_job_t *ring[IDLE_WORK_QUEUE_DEPTH]; /**< Pending jobs */
+	uint8_t head;                            /**< Oldest pending job */
+	uint8_t count;                           /**< Pending jobs */
+	volatile bool in_idle;                   /**< An idle task holds the core */
+	volatile uint32_t idle_since_us;         /**< When the idle task got the core */
+	volatile idle_work_stats_t stats;        /**< Counters */
+} idle_core_t;
+
+/** State of each core. */
+static idle_core_t idle_cores[IDLE_WORK_CORES];
+
+void idle_work_reset(void)
+{
+	for (uint8_t core = 0U; core < (uint8_t)IDLE_WORK_CORES; core++)
+	{
+		idle_core_t *state = &idle_cores[core];
+		state->head = 0U;
+		state->count = 0U;
+		state->in_idle = false;
+		state->idle_since_us = 0U;
+		state->stats.idle_us = 0U;
+		state->stats.passes = 0U;
+		state->stats.run = 0U;
+		state->stats.dropped = 0U;
+	}
+}
+
+bool idle_work_post(idle_job_t *job)
+{
+	bool result = true;
+	const uint32_t status = save_and_disable_interrupts();
+	idle_core_t *state = &idle_cores[get_core_num() % IDLE_WORK_CORES];
+
+	if (!job->pending)
+	{
+		if (state->count < (uint8_t)IDLE_WORK_QUEUE_DEPTH)
+		{
+			state->ring[(state->head + state->count) % IDLE_WORK_QUEUE_DEPTH] = job;
+			state->count++;
+			job->pending = true;
+		}
+		else
+		{
+			state->stats.dropped++;
+			result = false;
+		}
+	}
+
+	restore_interrupts(status);
+	return result;
+}
+
+bool idle_work_run(void)
+{
+	idle_job_t *job = NULL;
+	const uint32_t status = save_and_disable_interrupts();
+	idle_core_t *state = &idle_cores[get_core_num() % IDLE_WORK_CORES];
+
+	state->stats.passes++;
+	if (state->count > 0U)
+	{
+		job = state->ring[state->head];
+		state->head = (uint8_t)((state->head + 1U) % IDLE_WORK_QUEUE_DEPTH);
+		state->count--;
+		// Cleared before the body runs, so the job can post itself again
+		job->pending = false;
+		state->stats.run++;
+	}
+	restore_interrupts(status);
+
+	if (NULL != job)
+	{
+		job->function(job->context);
+	}
+
+	return NULL != job;
+}
+
+void idle_work_task_switched(uint8_t core, bool to_idle, uint32_t now_us)
+{
+	if (core < (uint8_t)IDLE_WORK_CORES)
+	{
+		idle_core_t *state = &idle_cores[core];
+
+		if (state->in_idle)
+		{
+			state->stats.idle_us += now_us - state->idle_since_us;
+		}
+		state->idle_since_us = now_us;
+		state->in_idle = to_idle;
+	}
+}
+
+void idle_work_stats(uint8_t core, uint32_t now_us, idle_work_stats_t *stats)
+{
+	if (core < (uint8_t)IDLE_WORK_CORES)
+	{
+		const idle_core_t *state = &idle_cores[core];
+
+		stats->idle_us = state->stats.idle_us;
+		stats->passes = state->stats.passes;
+		stats->run = state->stats.run;
+		stats->dropped = state->stats.dropped;
+
+		// Read from the other core this may straddle a switch and count one period twice
+		if (state->in_idle)
+		{
+			stats->idle_us += now_us - state->idle_since_us;
+		}
+	}
+}
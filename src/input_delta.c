@@ -0,0 +1,126 @@
+/**
+ * @file input_delta.c
+ * @brief Packing of scan-synchronous state-delta frames.
+ */
+
+#include "input_delta.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+uint8_t input_delta_encode_keys(uint8_t reported[INPUT_STATE_KEY_BYTES],
+                                const uint8_t current[INPUT_STATE_KEY_BYTES],
+                                uint8_t out[INPUT_DELTA_MAX_PAYLOAD])
+{
+	uint8_t length = 2U;
+	uint8_t present = 0U;
+
+	out[0] = INPUT_DELTA_SECTION_KEYS;
+
+	// Changed-key bitmap: only its non-zero bytes are sent
+	for (uint8_t i = 0U; i < (uint8_t)INPUT_STATE_KEY_BYTES; i++)
+	{
+		const uint8_t changed = (uint8_t)(reported[i] ^ current[i]);
+		if (0U != changed)
+		{
+			present |= (uint8_t)(1U << i);
+			out[length] = changed;
+			length++;
+		}
+	}
+	out[1] = present;
+
+	if (0U == present)
+	{
+		length = 0U;
+	}
+	else
+	{
+		// New states of the changed keys, in bitmap order
+		uint8_t state_bits = 0U;
+		uint8_t bit_count = 0U;
+
+		for (uint8_t i = 0U; i < (uint8_t)INPUT_STATE_KEY_BYTES; i++)
+		{
+			uint8_t changed = (uint8_t)(reported[i] ^ current[i]);
+			for (uint8_t bit = 0U; 0U != changed; bit++, changed >>= 1U)
+			{
+				if (0U != (changed & 1U))
+				{
+					if (0U != ((current[i] >> bit) & 1U))
+					{
+						state_bits |= (uint8_t)(1U << bit_count);
+					}
+					bit_count++;
+					if (8U == bit_count)
+					{
+						out[length] = state_bits;
+						length++;
+						state_bits = 0U;
+						bit_count = 0U;
+					}
+				}
+			}
+			reported[i] = current[i];
+		}
+
+		if (0U != bit_count)
+		{
+			out[length] = state_bits;
+			length++;
+		}
+	}
+
+	return length;
+}
+
+uint8_t input_delta_encode_axes(uint16_t *pending,
+                                const uint16_t values[ADC_CHANNELS],
+                                uint8_t out[INPUT_DELTA_MAX_PAYLOAD])
+{
+	uint8_t length = 3U;
+	uint16_t included = 0U;
+	uint8_t count = 0U;
+	bool high_half = true;
+
+	out[0] = INPUT_DELTA_SECTION_AXES;
+
+	for (uint8_t chan = 0U; (chan < (uint8_t)ADC_CHANNELS) && (count < (uint8_t)INPUT_DELTA_AXES_PER_FRAME); chan++)
+	{
+		if (0U != ((*pending >> chan) & 1U))
+		{
+			const uint16_t value = (uint16_t)(values[chan] & INPUT_DELTA_AXIS_MASK);
+
+			// Two values per three bytes: AAA BBB -> AA AB BB
+			if (high_half)
+			{
+				out[length] = (uint8_t)(value >> 4U);
+				out[length + 1U] = (uint8_t)((value & 0x0FU) << 4U);
+				length += 2U;
+			}
+			else
+			{
+				out[length - 1U] |= (uint8_t)(value >> 8U);
+				out[length] = (uint8_t)(value & 0xFFU);
+				length++;
+			}
+			high_half = !high_half;
+
+			included |= (uint16_t)(1U << chan);
+			count++;
+		}
+	}
+
+	if (0U == included)
+	{
+		length = 0U;
+	}
+	else
+	{
+		out[1] = (uint8_t)(included >> 8U);
+		out[2] = (uint8_t)(included & 0xFFU);
+		*pending &= (uint16_t)~included;
+	}
+
+	return length;
+}
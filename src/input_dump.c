@@ -0,0 +1,100 @@
+/**
+ * @file input_dump.c
+ * @brief Packing of the state dump sent for @ref PC_STATE_DUMP_CMD.
+ */
+
+#include "input_dump.h"
+
+#include <string.h>
+
+_Static_assert((2U + (((INPUT_DUMP_AXES_FIRST * 3U) + 1U) / 2U)) <= INPUT_DUMP_MAX_PAYLOAD,
+               "first axis part must fit the largest part");
+_Static_assert((7U + INPUT_STATE_KEY_BYTES) <= INPUT_DUMP_MAX_PAYLOAD,
+               "key part must fit the largest part");
+
+/**
+ * @brief Pack axes two per three bytes.
+ *
+ * @return Bytes written.
+ */
+static uint8_t pack_axes(const uint16_t *axes, uint8_t count, uint8_t *out)
+{
+	uint8_t length = 0U;
+
+	for (uint8_t i = 0U; i < count; i++)
+	{
+		const uint16_t value = (uint16_t)(axes[i] & 0x0FFFU);
+
+		if (0U == (i & 1U))
+		{
+			out[length] = (uint8_t)(value >> 4U);
+			out[length + 1U] = (uint8_t)((value & 0x0FU) << 4U);
+			length += 2U;
+		}
+		else
+		{
+			out[length - 1U] |= (uint8_t)(value >> 8U);
+			out[length] = (uint8_t)(value & 0xFFU);
+			length++;
+		}
+	}
+
+	return length;
+}
+
+uint8_t input_dump_encode(const input_state_t *state, uint32_t uptime_ms, uint8_t tag, uint8_t part,
+                          uint8_t out[INPUT_DUMP_MAX_PAYLOAD])
+{
+	uint8_t length = 2U;
+
+	out[0] = tag;
+	out[1] = (uint8_t)((part << 4U) | INPUT_DUMP_PARTS);
+
+	switch (part)
+	{
+	case 0U:
+	{
+		uint8_t flags = 0U;
+		if (0U != state->keypad_sequence)
+		{
+			flags |= INPUT_DUMP_KEYPAD_SCANNED;
+		}
+		if (0U != state->adc_sequence)
+		{
+			flags |= INPUT_DUMP_ADC_SCANNED;
+		}
+		out[2] = flags;
+		out[3] = (uint8_t)(uptime_ms >> 24U);
+		out[4] = (uint8_t)(uptime_ms >> 16U);
+		out[5] = (uint8_t)(uptime_ms >> 8U);
+		out[6] = (uint8_t)(uptime_ms & 0xFFU);
+		(void)memcpy(&out[7], state->keys, INPUT_STATE_KEY_BYTES); // flawfinder: ignore
+		length = (uint8_t)(7U + INPUT_STATE_KEY_BYTES);
+	}
+	break;
+
+	case 1U:
+		for (uint8_t i = 0U; i < (uint8_t)MAX_NUM_ENCODERS; i++)
+		{
+			const uint16_t detents = (uint16_t)state->encoders[i];
+			out[length] = (uint8_t)(detents >> 8U);
+			out[length + 1U] = (uint8_t)(detents & 0xFFU);
+			length += 2U;
+		}
+		break;
+
+	case 2U:
+		length += pack_axes(state->axes, (uint8_t)INPUT_DUMP_AXES_FIRST, &out[2]);
+		break;
+
+	case 3U:
+		length += pack_axes(&state->axes[INPUT_DUMP_AXES_FIRST], (uint8_t)(ADC_CHANNELS - INPUT_DUMP_AXES_FIRST), &out[2]);
+		break;
+
+	default:
+		length = 0U;
+		break;
+	}
+
+	return length;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file input_state.c
+ * @brief Latch-published input state shared with readers on either core.
+ *
+ * Each section has a single writer (its scan task) and a sequence counter.
+ * The writer makes the counter odd, rewrites copy 0, makes it even again and
+ * rewrites copy 1. Readers pick the copy selected by the counter's low bit,
+ * which is never the one being rewritten, and retry only if the counter
+ * moved while they copied.
+ */
+
+#include "input_state.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Keypad task section of the state.
+ */
+typedef struct keypad_section_t
+{
+	uint32_t scan_us;
+	uint8_t keys[INPUT_STATE_KEY_BYTES];
+	int32_t encoders[MAX_NUM_ENCODERS];
+} keypad_section_t;
+
+/**
+ * @brief ADC task section of the state.
+ */
+typedef struct adc_section_t
+{
+	uint32_t scan_us;
+	uint16_t axes[ADC_CHANNELS];
+} adc_section_t;
+
+static atomic_uint_least32_t keypad_sequence = ATOMIC_VAR_INIT(0U);
+static keypad_section_t keypad_copies[2];
+
+static atomic_uint_least32_t adc_sequence = ATOMIC_VAR_INIT(0U);
+static adc_section_t adc_copies[2];
+
+/**
+ * @brief Publish a section through its latch (single writer).
+ *
+ * @param[in,out] sequence Latch sequence counter.
+ * @param[out]    copies   Both copies of the section, laid out back to back.
+ * @param[in]     section  New section contents.
+ * @param[in]     size     Size of one copy in bytes.
+ */
+static void latch_publish(atomic_uint_least32_t *sequence, void *copies, const void *section, size_t size)
+{
+	uint8_t *copy = (uint8_t *)copies;
+	const uint32_t seq = (uint32_t)atomic_load_explicit(sequence, memory_order_relaxed);
+
+	// Odd: readers move to copy 1 while copy 0 is rewritten
+	atomic_store_explicit(sequence, seq + 1U, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	(void)memcpy(copy, section, size); // flawfinder: ignore
+	atomic_thread_fence(memory_order_release);
+
+	// Even: readers move back to copy 0 while copy 1 is rewritten
+	atomic_store_explicit(sequence, seq + 2U, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	(void)memcpy(&copy[size], section, size); // flawfinder: ignore
+}
+
+/**
+ * @brief Copy a section out of its latch.
+ *
+ * @param[in]  sequence Latch sequence counter.
+ * @param[in]  copies   Both copies of the section.
+ * @param[out] section  Destination.
+ * @param[in]  size     Size of one copy in bytes.
+ *
+ * @return Number of publishes the copy reflects.
+ */
+static uint32_t latch_read(atomic_uint_least32_t *sequence, const void *copies, void *section, size_t size)
+{
+	const uint8_t *copy = (const uint8_t *)copies;
+	uint32_t seq;
+
+	do
+	{
+		seq = (uint32_t)atomic_load_explicit(sequence, memory_order_acquire);
+		(void)memcpy(section, &copy[(seq & 1U) * size], size); // flawfinder: ignore
+		atomic_thread_fence(memory_order_acquire);
+	} while (seq != (uint32_t)atomic_load_explicit(sequence, memory_order_relaxed));
+
+	// While odd, copy 1 still holds the previous publish
+	return seq >> 1U;
+}
+
+void input_state_reset(void)
+{
+	(void)memset(keypad_copies, 0, sizeof(keypad_copies));
+	(void)memset(adc_copies, 0, sizeof(adc_copies));
+	atomic_store(&keypad_sequence, 0U);
+	atomic_store(&adc_sequence, 0U);
+}
+
+void input_state_publish_keypad(const uint8_t keys[INPUT_STATE_KEY_BYTES],
+                                const int32_t encoders[MAX_NUM_ENCODERS],
+                                uint32_t now_us)
+{
+	keypad_section_t section;
+
+	section.scan_us = now_us;
+	(void)memcpy(section.keys, keys, sizeof(section.keys)); // flawfinder: ignore
+	(void)memcpy(section.encoders, encoders, sizeof(section.encoders)); // flawfinder: ignore
+
+	latch_publish(&keypad_sequence, keypad_copies, &section, sizeof(section));
+}
+
+void input_state_publish_adc(const uint16_t axes[ADC_CHANNELS], uint32_t now_us)
+{
+	adc_section_t section;
+
+	section.scan_us = now_us;
+	(void)memcpy(section.axes, axes, sizeof(section.axes)); // flawfinder: ignore
+
+	latch_publish(&adc_sequence, adc_copies, &section, sizeof(section));
+}
+
+void input_state_read(input_state_t *state)
+{
+	keypad_section_t keypad;
+	adc_section_t adc;
+
+	state->keypad_sequence = latch_read(&keypad_sequence, keypad_copies, &keypad, sizeof(keypad));
+	state->adc_sequence = latch_read(&adc_sequence, adc_copies, &adc, sizeof(adc));
+
+	state->keypad_scan_us = keypad.scan_us;
+	(void)memcpy(state->keys, keypad.keys, sizeof(state->keys)); // flawfinder: ignore
+	(void)memcpy(state->encoders, keypad.encoders, sizeof(state->encoders)); // flawfinder: ignore
+	state->adc_scan_us = adc.scan_us;
+	(void)memcpy(state->axes, adc.axes, sizeof(state->axes)); // flawfinder: ignore
+}
@@ -0,0 +1,221 @@
+/**
+ * @file keypad_matrix.c
+ * @brief Scan table, bitmap diff and debounce for the PIO keypad scanner.
+ */
+
+#include "keypad_matrix.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// A scan word drives one contiguous GPIO range: every select line must be in it.
+// The direct inputs inside the range are not routed to the PIO and stay unaffected.
+_Static_assert((KEYPAD_COL_MUX_A - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "column select A outside the scan range");
+_Static_assert((KEYPAD_COL_MUX_B - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "column select B outside the scan range");
+_Static_assert((KEYPAD_COL_MUX_C - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "column select C outside the scan range");
+_Static_assert((KEYPAD_ROW_MUX_A - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "row select A outside the scan range");
+_Static_assert((KEYPAD_ROW_MUX_B - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "row select B outside the scan range");
+_Static_assert((KEYPAD_ROW_MUX_C - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "row select C outside the scan range");
+_Static_assert((KEYPAD_ROW_MUX_CS - KEYPAD_SCAN_OUT_BASE) < KEYPAD_SCAN_OUT_COUNT, "row enable outside the scan range");
+_Static_assert(64U == KEYPAD_MATRIX_POSITIONS, "frames are handled as one 64-bit bitmap");
+
+/**
+ * @brief Quadrature lookup table used by the encoder state machine.
+ *
+ * The four LSBs encode the previous and current A/B samples. Each entry
+ * provides the detent delta (-1, 0, or +1) for that transition.
+ */
+static const int8_t encoder_lut[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+
+void keypad_matrix_reset(keypad_matrix_t *matrix, const input_profile_t *profile, uint32_t frame_us)
+{
+	const input_config_t *config = &profile->config;
+
+	(void)memset(matrix, 0, sizeof(*matrix));
+
+	for (uint8_t r = 0U; r < config->rows; r++)
+	{
+		for (uint8_t c = 0U; c < config->columns; c++)
+		{
+			if (!profile->encoder_skip[r][c])
+			{
+				matrix->enabled |= 1ULL << keypad_matrix_position(r, c);
+			}
+		}
+	}
+
+	matrix->debounce_frames = keypad_matrix_debounce_frames(config->key_settling_time_ms, frame_us);
+	matrix->num_encoders = config->num_encoders;
+	(void)memcpy(matrix->encoders, config->encoder_map, sizeof(matrix->encoders)); // flawfinder: ignore
+}
+
+uint8_t keypad_matrix_debounce_frames(uint16_t key_settling_time_ms, uint32_t frame_us)
+{
+	const uint32_t window_us = (uint32_t)key_settling_time_ms * (KEYPAD_STABILITY_BITS - 1U) * 1000U;
+	uint32_t frames = (window_us + frame_us - 1U) / frame_us;
+
+	if (0U == frames)
+	{
+		frames = 1U;
+	}
+	else if (frames > KEYPAD_MATRIX_MAX_DEBOUNCE_FRAMES)
+	{
+		frames = KEYPAD_MATRIX_MAX_DEBOUNCE_FRAMES;
+	}
+
+	return (uint8_t)frames;
+}
+
+uint64_t keypad_matrix_pressed(const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS])
+{
+	const uint64_t levels = ((uint64_t)frame[1] << 32U) | frame[0];
+
+	// Active low row line
+	return ~levels;
+}
+
+uint64_t keypad_matrix_update(keypad_matrix_t *matrix, uint64_t pressed, int8_t steps[MAX_NUM_ENCODERS])
+{
+	const uint64_t diff = (pressed ^ matrix->stable) & matrix->enabled;
+	uint64_t changed = 0U;
+
+	// Keys that bounced back to their debounced level start over
+	uint64_t settled = matrix->pending & ~diff;
+	while (0U != settled)
+	{
+		matrix->count[__builtin_ctzll(settled)] = 0U;
+		settled &= settled - 1U;
+	}
+
+	uint64_t moving = diff;
+	while (0U != moving)
+	{
+		const int bit = __builtin_ctzll(moving);
+		matrix->count[bit]++;
+		if (matrix->count[bit] >= matrix->debounce_frames)
+		{
+			matrix->count[bit] = 0U;
+			changed |= 1ULL << bit;
+		}
+		moving &= moving - 1U;
+	}
+
+	matrix->stable ^= changed;
+	matrix->pending = diff & ~changed;
+
+	(void)memset(steps, 0, MAX_NUM_ENCODERS * sizeof(steps[0]));
+	for (uint8_t i = 0U; i < matrix->num_encoders; i++)
+	{
+		if (!matrix->encoders[i].enabled)
+		{
+			continue;
+		}
+
+		const uint8_t a_bit = keypad_matrix_position(matrix->encoders[i].row, matrix->encoders[i].col);
+		encoder_states_t *state = &matrix->encoder_state[i];
+
+		/* Quadrature state machine: shift previous state, OR in new sample */
+		state->old_encoder <<= 2U;
+		state->old_encoder |= (uint8_t)((pressed >> a_bit) & 1U);
+		state->old_encoder |= (uint8_t)(((pressed >> (a_bit + 1U)) & 1U) << 1U);
+		state->count_encoder += encoder_lut[state->old_encoder & 0x0FU];
+
+		if (4 == state->count_encoder)
+		{
+			state->count_encoder = 0;
+			matrix->detents[i]++;
+			steps[i] = 1;
+		}
+		if (-4 == state->count_encoder)
+		{
+			state->count_encoder = 0;
+			matrix->detents[i]--;
+			steps[i] = -1;
+		}
+	}
+
+	return changed;
+}
+
+void keypad_matrix_to_bytes(uint64_t keys, uint8_t bitmap[INPUT_STATE_KEY_BYTES])
+{
+	for (uint8_t i = 0U; i < (uint8_t)INPUT_STATE_KEY_BYTES; i++)
+	{
+		bitmap[i] = (uint8_t)(keys >> (i * 8U));
+	}
+}
+
+/**
+ * @brief Select GPIO levels for one matrix position, row multiplexer enabled.
+ *
+ * @param[in] row    Matrix row.
+ * @param[in] column Matrix column.
+ *
+ * @return Levels relative to @ref KEYPAD_SCAN_OUT_BASE.
+ */
+static uint32_t scan_select(uint8_t row, uint8_t column)
+{
+	uint32_t levels = 0U;
+
+	levels |= (uint32_t)(column & 0x01U) << KEYPAD_COL_MUX_A;
+	levels |= (uint32_t)((column >> 1U) & 0x01U) << KEYPAD_COL_MUX_B;
+	levels |= (uint32_t)((column >> 2U) & 0x01U) << KEYPAD_COL_MUX_C;
+	levels |= (uint32_t)(row & 0x01U) << KEYPAD_ROW_MUX_A;
+	levels |= (uint32_t)((row >> 1U) & 0x01U) << KEYPAD_ROW_MUX_B;
+	levels |= (uint32_t)((row >> 2U) & 0x01U) << KEYPAD_ROW_MUX_C;
+	// KEYPAD_ROW_MUX_CS stays low: the row multiplexer enable is active low
+
+	return levels >> KEYPAD_SCAN_OUT_BASE;
+}
+
+/**
+ * @brief Settle loop count for a settling time.
+ *
+ * The PIO spends the loop count plus two cycles between driving the selects
+ * and sampling.
+ *
+ * @param[in] settle_us Settling time (µs).
+ *
+ * @return Loop count for the scan word.
+ */
+static uint32_t scan_settle_count(uint32_t settle_us)
+{
+	const uint32_t cycles = settle_us * KEYPAD_SCAN_CYCLES_PER_US;
+
+	return (cycles > 2U) ? (cycles - 2U) : 0U;
+}
+
+void keypad_matrix_build_scan(uint32_t table[KEYPAD_MATRIX_POSITIONS], uint16_t col_settle_us,
+                              uint16_t row_settle_us, uint32_t frame_us)
+{
+	uint32_t settle[KEYPAD_MATRIX_POSITIONS];
+	uint32_t scan_cycles = 0U;
+
+	for (uint8_t r = 0U; r < KEYPAD_ROWS; r++)
+	{
+		for (uint8_t c = 0U; c < KEYPAD_COLUMNS; c++)
+		{
+			const uint8_t position = keypad_matrix_position(r, c);
+			const uint32_t settle_us = (0U == c) ? ((uint32_t)col_settle_us + row_settle_us) : col_settle_us;
+
+			settle[position] = scan_settle_count(settle_us);
+			scan_cycles += settle[position] + KEYPAD_SCAN_FIXED_CYCLES;
+		}
+	}
+
+	// Idle at the first position for the rest of the frame period
+	const uint32_t frame_cycles = frame_us * KEYPAD_SCAN_CYCLES_PER_US;
+	if (frame_cycles > scan_cycles)
+	{
+		settle[0] += frame_cycles - scan_cycles;
+	}
+
+	for (uint8_t position = 0U; position < KEYPAD_MATRIX_POSITIONS; position++)
+	{
+		const uint32_t count = (settle[position] > KEYPAD_SCAN_SETTLE_MAX) ? KEYPAD_SCAN_SETTLE_MAX : settle[position];
+		const uint8_t row = position / KEYPAD_COLUMNS;
+		const uint8_t column = position % KEYPAD_COLUMNS;
+
+		table[position] = scan_select(row, column) | (count << KEYPAD_SCAN_SETTLE_SHIFT);
+	}
+}
@@ -0,0 +1,152 @@
+/**
+ * @file keypad_scan.c
+ * @brief PIO and DMA driven keypad matrix scanning.
+ */
+
+#include "keypad_scan.h"
+
+#include <stdbool.h>
+
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/pio.h>
+
+#include "keypad_scan.pio.h"
+
+_Static_assert(2U == KEYPAD_SCAN_FRAME_WORDS, "the frame write ring is sized for two words");
+
+/** log2 of the frame size in bytes, for the DMA write ring. */
+#define KEYPAD_SCAN_FRAME_RING_BITS 3U
+
+/**
+ * @brief Scan words the PIO steps through for one frame.
+ */
+static uint32_t scan_table[KEYPAD_MATRIX_POSITIONS];
+
+/**
+ * @brief Table start address, copied into the table channel after every frame.
+ */
+static const uint32_t *scan_table_start = scan_table;
+
+/**
+ * @brief Double buffer written by the two frame channels in turn.
+ *
+ * Aligned to the frame size so each channel's write ring rewinds to the
+ * start of its own buffer.
+ */
+static uint32_t scan_frames[2][KEYPAD_SCAN_FRAME_WORDS] __attribute__((aligned(KEYPAD_SCAN_FRAME_WORDS * sizeof(uint32_t))));
+
+/**
+ * @brief DMA channel writing each half of @ref scan_frames.
+ */
+static uint frame_channels[2];
+
+/**
+ * @brief Consumer of completed frames.
+ */
+static keypad_scan_frame_cb_t frame_callback = NULL;
+
+/**
+ * @brief DMA_IRQ_0 handler: pass each completed frame to the callback.
+ *
+ * The other frame channel is filling the other buffer meanwhile; it only
+ * comes back to this one a full frame period later.
+ */
+static void keypad_scan_dma_irq(void)
+{
+	for (uint8_t i = 0U; i < 2U; i++)
+	{
+		if (dma_channel_get_irq0_status(frame_channels[i]))
+		{
+			dma_channel_acknowledge_irq0(frame_channels[i]);
+			frame_callback(scan_frames[i]);
+		}
+	}
+}
+
+void keypad_scan_set_timing(uint16_t col_settle_us, uint16_t row_settle_us)
+{
+	keypad_matrix_build_scan(scan_table, col_settle_us, row_settle_us, KEYPAD_SCAN_FRAME_US);
+}
+
+void keypad_scan_start(keypad_scan_frame_cb_t callback)
+{
+	const PIO pio = pio0;
+	const uint sm = (uint)pio_claim_unused_sm(pio, true);
+	const uint offset = pio_add_program(pio, &keypad_scan_program);
+	const uint table_channel = (uint)dma_claim_unused_channel(true);
+	const uint rewind_channel = (uint)dma_claim_unused_channel(true);
+
+	frame_callback = callback;
+	frame_channels[0] = (uint)dma_claim_unused_channel(true);
+	frame_channels[1] = (uint)dma_claim_unused_channel(true);
+
+	// Only the select lines move to the PIO; the direct inputs inside the range stay on SIO
+	const uint32_t select_mask = ((1UL << KEYPAD_COL_MUX_A) |
+	                              (1UL << KEYPAD_COL_MUX_B) |
+	                              (1UL << KEYPAD_COL_MUX_C) |
+	                              (1UL << KEYPAD_ROW_MUX_A) |
+	                              (1UL << KEYPAD_ROW_MUX_B) |
+	                              (1UL << KEYPAD_ROW_MUX_C) |
+	                              (1UL << KEYPAD_ROW_MUX_CS));
+
+	pio_sm_set_pins_with_mask(pio, sm, 1UL << KEYPAD_ROW_MUX_CS, select_mask); // Row MUX disabled until the first word
+	pio_sm_set_pindirs_with_mask(pio, sm, select_mask, select_mask);
+	for (uint pin = 0U; pin < 32U; pin++)
+	{
+		if (0U != (select_mask & (1UL << pin)))
+		{
+			pio_gpio_init(pio, pin);
+		}
+	}
+
+	// The column decoder stays enabled while the PIO scans (active high pin)
+	gpio_put(KEYPAD_COL_MUX_CS, true);
+
+	pio_sm_config sm_config = keypad_scan_program_get_default_config(offset);
+	sm_config_set_out_pins(&sm_config, KEYPAD_SCAN_OUT_BASE, KEYPAD_SCAN_OUT_COUNT);
+	sm_config_set_in_pins(&sm_config, KEYPAD_ROW_INPUT);
+	sm_config_set_out_shift(&sm_config, true, true, 32U);
+	sm_config_set_in_shift(&sm_config, true, true, 32U);
+	sm_config_set_clkdiv(&sm_config, (float)clock_get_hz(clk_sys) / ((float)KEYPAD_SCAN_CYCLES_PER_US * 1000000.0f));
+	pio_sm_init(pio, sm, offset, &sm_config);
+
+	// Frame channels: one frame each, then trigger the other one
+	for (uint8_t i = 0U; i < 2U; i++)
+	{
+		dma_channel_config config = dma_channel_get_default_config(frame_channels[i]);
+		channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+		channel_config_set_read_increment(&config, false);
+		channel_config_set_write_increment(&config, true);
+		channel_config_set_ring(&config, true, KEYPAD_SCAN_FRAME_RING_BITS);
+		channel_config_set_dreq(&config, pio_get_dreq(pio, sm, false));
+		channel_config_set_chain_to(&config, frame_channels[i ^ 1U]);
+		dma_channel_configure(frame_channels[i], &config, scan_frames[i], &pio->rxf[sm], KEYPAD_SCAN_FRAME_WORDS, false);
+		dma_channel_set_irq0_enabled(frame_channels[i], true);
+	}
+
+	// Table channel: one frame of scan words, then the rewind channel
+	dma_channel_config table_config = dma_channel_get_default_config(table_channel);
+	channel_config_set_transfer_data_size(&table_config, DMA_SIZE_32);
+	channel_config_set_read_increment(&table_config, true);
+	channel_config_set_write_increment(&table_config, false);
+	channel_config_set_dreq(&table_config, pio_get_dreq(pio, sm, true));
+	channel_config_set_chain_to(&table_config, rewind_channel);
+	dma_channel_configure(table_channel, &table_config, &pio->txf[sm], scan_table, KEYPAD_MATRIX_POSITIONS, false);
+
+	// Rewind channel: writing the table start to the trigger alias restarts the table channel
+	dma_channel_config rewind_config = dma_channel_get_default_config(rewind_channel);
+	channel_config_set_transfer_data_size(&rewind_config, DMA_SIZE_32);
+	channel_config_set_read_increment(&rewind_config, false);
+	channel_config_set_write_increment(&rewind_config, false);
+	dma_channel_configure(rewind_channel, &rewind_config, &dma_hw->ch[table_channel].al3_read_addr_trig,
+	                      &scan_table_start, 1U, false);
+
+	irq_add_shared_handler(DMA_IRQ_0, keypad_scan_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_0, true);
+
+	dma_channel_start(frame_channels[0]);
+	dma_channel_start(table_channel);
+	pio_sm_set_enabled(pio, sm, true);
+}
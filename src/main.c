@@ -19,7 +19,13 @@
 #include "app_inputs.h"
 #include "app_tasks.h"
 #include "app_outputs.h"
+#include "app_profiles.h"
+#include "app_scenes.h"
 #include "error_management.h"
+#include "idle_work.h"
+#include "output_commit.h"
+#include "timer_wheel.h"
+#include "usb_sof.h"
 
 /**
  * @brief Application entry point initialising hardware and starting FreeRTOS.
@@ -34,6 +40,9 @@ int main(void)
 	app_context_reset_line_state();
 	app_context_reset_task_props();
 	statistics_reset_all_counters();
+	idle_work_reset();
+	timer_wheel_setup();
+	output_commit_setup();
 
 	setup_watchdog_with_error_detection(WATCHDOG_GRACE_PERIOD_MS);
 
@@ -43,6 +52,10 @@ int main(void)
 		fatal_halt(ERROR_USB_INIT);
 	}
 
+	// SOF timestamps let the CDC writer flush just ahead of the host's IN polls
+	usb_sof_reset();
+	tud_sof_cb_enable(true);
+
 	// Initialize communication subsystem
 	if (!app_tasks_create_comm())
 	{
@@ -56,6 +69,9 @@ int main(void)
 		statistics_increment_counter(OUTPUT_INIT_ERROR);
 	}
 
+	// Restore stored output scenes
+	scene_init();
+
 	// Initialize inputs
 	const input_result_t input_status = input_init();
 	if (input_status != INPUT_OK)
@@ -63,6 +79,9 @@ int main(void)
 		statistics_increment_counter(INPUT_INIT_ERROR);
 	}
 
+	// Activate the stored configuration bank
+	profile_init();
+
 	// Initialize application tasks
 	(void)app_tasks_create_application();
 
@@ -0,0 +1,298 @@
+/**
+ * @file output_commit.c
+ * @brief Output commands staged for a device time and committed together.
+ */
+
+#include "output_commit.h"
+
+#include <string.h>
+
+#include <pico/stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_context.h"
+#include "app_outputs.h"
+#include "commands.h"
+#include "error_management.h"
+#include "timer_wheel.h"
+
+/** System queue, staged by the decode task and committed by the refresh task. */
+static output_commit_queue_t commit_queue;
+
+/** Commands of the pass in progress; only used by the refresh task. */
+static output_commit_entry_t commit_batch[OUTPUT_COMMIT_DEPTH];
+
+/** Pending commit alarm, or 0; only used by the refresh task. */
+static alarm_id_t commit_alarm = 0;
+
+/** The refresh task will wake by @ref commit_alarm_us at the latest. */
+static bool commit_alarm_armed = false;
+
+/** Apply time the refresh task is next woken for. */
+static uint32_t commit_alarm_us = 0U;
+
+void output_commit_queue_init(output_commit_queue_t *queue)
+{
+	(void)memset(queue, 0, sizeof(*queue));
+}
+
+output_commit_result_t output_commit_queue_stage(output_commit_queue_t *queue, uint32_t now_us, uint32_t apply_us,
+                                                 uint8_t command, const uint8_t *payload, uint8_t length)
+{
+	output_commit_result_t result = OUTPUT_COMMIT_OK;
+
+	if (((uint8_t)PC_DPYCTL_CMD != command) && ((uint8_t)PC_LEDOUT_CMD != command) && ((uint8_t)PC_PWM_CMD != command))
+	{
+		result = OUTPUT_COMMIT_ERR_INVALID;
+	}
+	else if ((NULL == payload) || (0U == length) || (length > (uint8_t)OUTPUT_COMMIT_MAX_PAYLOAD))
+	{
+		result = OUTPUT_COMMIT_ERR_INVALID;
+	}
+	else if ((int32_t)(apply_us - now_us) > (int32_t)OUTPUT_COMMIT_MAX_LEAD_US)
+	{
+		result = OUTPUT_COMMIT_ERR_TOO_FAR;
+	}
+	else if (queue->count >= (uint8_t)OUTPUT_COMMIT_DEPTH)
+	{
+		result = OUTPUT_COMMIT_ERR_FULL;
+	}
+	else
+	{
+		output_commit_entry_t *entry = &queue->entries[queue->count];
+		entry->apply_us = apply_us;
+		entry->command = command;
+		entry->length = length;
+		(void)memcpy(entry->payload, payload, length); // flawfinder: ignore
+		queue->count++;
+	}
+
+	return result;
+}
+
+uint8_t output_commit_queue_take_due(output_commit_queue_t *queue, uint32_t now_us, output_commit_entry_t *due)
+{
+	uint8_t taken = 0U;
+	uint8_t kept = 0U;
+
+	for (uint8_t i = 0U; i < queue->count; i++)
+	{
+		const int32_t overdue = (int32_t)(now_us - queue->entries[i].apply_us);
+
+		if (overdue >= 0)
+		{
+			due[taken] = queue->entries[i];
+			taken++;
+			if (overdue > (int32_t)OUTPUT_COMMIT_LATE_US)
+			{
+				queue->late++;
+			}
+		}
+		else
+		{
+			// Keep the remaining commands in arrival order
+			if (kept != i)
+			{
+				queue->entries[kept] = queue->entries[i];
+			}
+			kept++;
+		}
+	}
+
+	queue->count = kept;
+	queue->committed += taken;
+
+	return taken;
+}
+
+bool output_commit_queue_next(const output_commit_queue_t *queue, uint32_t now_us, uint32_t *apply_us)
+{
+	int32_t earliest = INT32_MAX;
+
+	for (uint8_t i = 0U; i < queue->count; i++)
+	{
+		const int32_t delta = (int32_t)(queue->entries[i].apply_us - now_us);
+		if (delta < earliest)
+		{
+			earliest = delta;
+			*apply_us = queue->entries[i].apply_us;
+		}
+	}
+
+	return 0U != queue->count;
+}
+
+void output_commit_setup(void)
+{
+	output_commit_queue_init(&commit_queue);
+	commit_alarm = 0;
+	commit_alarm_armed = false;
+}
+
+/**
+ * @brief Wake @ref display_refresh_task to commit or re-arm the alarm.
+ */
+static void wake_committer(void)
+{
+	const task_props_t *const props = app_context_task_props(DISPLAY_REFRESH_TASK);
+
+	if ((NULL != props) && (NULL != props->task_handle))
+	{
+		(void)xTaskNotifyGiveIndexed(props->task_handle, TIMER_WHEEL_NOTIFY_INDEX);
+	}
+}
+
+output_commit_result_t output_commit_process_command(const uint8_t *payload, uint8_t length)
+{
+	output_commit_result_t result = OUTPUT_COMMIT_ERR_INVALID;
+	const uint8_t sub_command = ((NULL != payload) && (0U != length)) ? payload[0] : 0xFFU;
+
+	switch (sub_command)
+	{
+	case TIMED_CMD_STAGE:
+		if (length > (uint8_t)OUTPUT_COMMIT_HEADER_SIZE)
+		{
+			const uint32_t apply_us = ((uint32_t)payload[1] << 24U) | ((uint32_t)payload[2] << 16U) |
+			                          ((uint32_t)payload[3] << 8U) | (uint32_t)payload[4];
+			bool wake = false;
+
+			taskENTER_CRITICAL();
+			result = output_commit_queue_stage(&commit_queue, time_us_32(), apply_us, payload[5],
+			                                   &payload[OUTPUT_COMMIT_HEADER_SIZE],
+			                                   (uint8_t)(length - OUTPUT_COMMIT_HEADER_SIZE));
+			// Frames of one update share an apply time: only the first wakes the task
+			if ((OUTPUT_COMMIT_OK == result) &&
+			    (!commit_alarm_armed || ((int32_t)(apply_us - commit_alarm_us) < 0)))
+			{
+				commit_alarm_armed = true;
+				commit_alarm_us = apply_us;
+				wake = true;
+			}
+			taskEXIT_CRITICAL();
+
+			if (wake)
+			{
+				wake_committer();
+			}
+		}
+		break;
+
+	case TIMED_CMD_CANCEL:
+		taskENTER_CRITICAL();
+		commit_queue.count = 0U;
+		taskEXIT_CRITICAL();
+		result = OUTPUT_COMMIT_OK;
+		break;
+
+	default:
+		// Empty payload or unknown sub-command
+		break;
+	}
+
+	return result;
+}
+
+void output_commit_counters(uint8_t *staged, uint32_t *late)
+{
+	taskENTER_CRITICAL();
+	*staged = commit_queue.count;
+	*late = commit_queue.late;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Apply one staged command as if its frame had just arrived.
+ *
+ * @param[in] entry Command to apply.
+ */
+static void commit_one(const output_commit_entry_t *entry)
+{
+	switch (entry->command)
+	{
+	case PC_DPYCTL_CMD:
+		if (display_out(entry->payload, entry->length) != OUTPUT_OK)
+		{
+			statistics_increment_counter(DISPLAY_OUT_ERROR);
+		}
+		break;
+
+	case PC_LEDOUT_CMD:
+		if (led_out(entry->payload, entry->length) != OUTPUT_OK)
+		{
+			statistics_increment_counter(LED_OUT_ERROR);
+		}
+		break;
+
+	case PC_PWM_CMD:
+		set_pwm_duty(entry->payload[0]);
+		break;
+
+	default:
+		// Rejected when staged
+		break;
+	}
+}
+
+/**
+ * @brief Alarm callback that wakes the refresh task at an apply time.
+ *
+ * @param[in] id        Alarm identifier (unused).
+ * @param[in] user_data Handle of the task to notify.
+ *
+ * @return 0 so the alarm is not rescheduled.
+ */
+static int64_t commit_alarm_cb(alarm_id_t id, void *user_data)
+{
+	(void)id;
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	vTaskNotifyGiveIndexedFromISR((TaskHandle_t)user_data, TIMER_WHEEL_NOTIFY_INDEX, &higher_priority_task_woken);
+	portYIELD_FROM_ISR(higher_priority_task_woken);
+	return 0;
+}
+
+bool output_commit_run(void)
+{
+	bool pending = false;
+
+	do
+	{
+		uint32_t apply_us = 0U;
+
+		taskENTER_CRITICAL();
+		const uint8_t count = output_commit_queue_take_due(&commit_queue, time_us_32(), commit_batch);
+		taskEXIT_CRITICAL();
+
+		// Back to back, so the outputs of one apply time change together
+		for (uint8_t i = 0U; i < count; i++)
+		{
+			commit_one(&commit_batch[i]);
+		}
+
+		taskENTER_CRITICAL();
+		const uint32_t now_us = time_us_32();
+		pending = output_commit_queue_next(&commit_queue, now_us, &apply_us);
+		commit_alarm_armed = pending;
+		commit_alarm_us = apply_us;
+		taskEXIT_CRITICAL();
+
+		if (commit_alarm > 0)
+		{
+			// Harmless when the alarm already fired
+			(void)cancel_alarm(commit_alarm);
+			commit_alarm = 0;
+		}
+
+		if (pending)
+		{
+			const int32_t delay_us = (int32_t)(apply_us - now_us);
+
+			// A zero id means the apply time passed meanwhile: commit again straight away
+			commit_alarm = add_alarm_in_us((delay_us > 0) ? (uint64_t)delay_us : 0U, commit_alarm_cb,
+			                               xTaskGetCurrentTaskHandle(), false);
+		}
+	} while (pending && (0 == commit_alarm));
+
+	return !pending || (commit_alarm > 0);
+}
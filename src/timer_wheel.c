@@ -0,0 +1,258 @@
+/**
+ * @file timer_wheel.c
+ * @brief Hierarchical timer wheel for many short-lived device-side timers.
+ */
+
+#include "timer_wheel.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_context.h"
+
+/** Selects a slot from a shifted tick count. */
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1U)
+
+/** System wheel, advanced by the kernel tick. */
+static timer_wheel_t system_wheel;
+
+/**
+ * @brief Push a timer at the head of a list.
+ */
+static inline void list_push(timer_wheel_timer_t **head, timer_wheel_timer_t *timer)
+{
+	timer->next = *head;
+	if (NULL != timer->next)
+	{
+		timer->next->pprev = &timer->next;
+	}
+	*head = timer;
+	timer->pprev = head;
+}
+
+/**
+ * @brief Take a timer out of whatever list holds it.
+ */
+static inline void list_unlink(timer_wheel_timer_t *timer)
+{
+	*timer->pprev = timer->next;
+	if (NULL != timer->next)
+	{
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+/**
+ * @brief Shift selecting the slot of a level.
+ */
+static inline uint32_t level_shift(uint8_t level)
+{
+	return TIMER_WHEEL_SLOT_BITS * (uint32_t)level;
+}
+
+/**
+ * @brief Put an unlinked timer in the slot matching its distance from now.
+ *
+ * @param[in] earliest Distance of the first slot still to be processed: 1
+ *                     from outside, 0 while cascading, before level 0 of the
+ *                     current tick is expired.
+ */
+static void place(timer_wheel_t *wheel, timer_wheel_timer_t *timer, int32_t earliest)
+{
+	int32_t delta = (int32_t)(timer->expires - wheel->now);
+	uint32_t due = timer->expires;
+	uint8_t level = 0U;
+
+	if (delta < earliest)
+	{
+		// Already due: the next slot processed picks it up
+		delta = earliest;
+		due = wheel->now + (uint32_t)earliest;
+	}
+
+	while ((level < (uint8_t)TIMER_WHEEL_LEVELS) && ((uint32_t)delta >= (1UL << level_shift(level + 1U))))
+	{
+		level++;
+	}
+
+	if (level == (uint8_t)TIMER_WHEEL_LEVELS)
+	{
+		// Beyond the wheel: wait in the farthest slot and be placed again from there
+		level = (uint8_t)(TIMER_WHEEL_LEVELS - 1U);
+		due = wheel->now + (SLOT_MASK << level_shift(level));
+	}
+
+	list_push(&wheel->slots[level][(due >> level_shift(level)) & SLOT_MASK], timer);
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now)
+{
+	(void)memset(wheel, 0, sizeof(*wheel));
+	wheel->now = now;
+}
+
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_timer_t *timer, uint32_t expires)
+{
+	if (timer->owner < (uint8_t)TIMER_WHEEL_OWNERS)
+	{
+		if (timer_wheel_is_armed(timer))
+		{
+			list_unlink(timer);
+		}
+		timer->expires = expires;
+		place(wheel, timer, 1);
+	}
+}
+
+bool timer_wheel_remove(timer_wheel_timer_t *timer)
+{
+	const bool armed = timer_wheel_is_armed(timer);
+
+	if (armed)
+	{
+		list_unlink(timer);
+	}
+
+	return armed;
+}
+
+/**
+ * @brief Spread one slot of a higher level over the levels below.
+ */
+static void cascade(timer_wheel_t *wheel, uint8_t level)
+{
+	timer_wheel_timer_t **head = &wheel->slots[level][(wheel->now >> level_shift(level)) & SLOT_MASK];
+
+	while (NULL != *head)
+	{
+		timer_wheel_timer_t *timer = *head;
+		list_unlink(timer);
+		place(wheel, timer, 0);
+	}
+}
+
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now)
+{
+	uint32_t owners = 0U;
+
+	while ((int32_t)(now - wheel->now) > 0)
+	{
+		wheel->now++;
+
+		// Highest level first, so its timers can still land in the slots below
+		for (uint8_t level = (uint8_t)(TIMER_WHEEL_LEVELS - 1U); level > 0U; level--)
+		{
+			if (0U == (wheel->now & ((1UL << level_shift(level)) - 1U)))
+			{
+				cascade(wheel, level);
+			}
+		}
+
+		timer_wheel_timer_t **head = &wheel->slots[0][wheel->now & SLOT_MASK];
+		while (NULL != *head)
+		{
+			timer_wheel_timer_t *timer = *head;
+			list_unlink(timer);
+			list_push(&wheel->expired[timer->owner], timer);
+			owners |= (1UL << timer->owner);
+		}
+	}
+
+	return owners;
+}
+
+timer_wheel_timer_t *timer_wheel_pop_expired(timer_wheel_t *wheel, uint8_t owner)
+{
+	timer_wheel_timer_t *timer = NULL;
+
+	if (owner < (uint8_t)TIMER_WHEEL_OWNERS)
+	{
+		timer = wheel->expired[owner];
+		if (NULL != timer)
+		{
+			list_unlink(timer);
+		}
+	}
+
+	return timer;
+}
+
+void timer_wheel_setup(void)
+{
+	timer_wheel_init(&system_wheel, (uint32_t)xTaskGetTickCount());
+}
+
+bool timer_wheel_start(timer_wheel_timer_t *timer, uint32_t delay_ticks)
+{
+	bool result = false;
+
+	// Takes the kernel lock, so the tick on core 0 never sees a half-linked timer
+	taskENTER_CRITICAL();
+	if (!timer_wheel_is_armed(timer))
+	{
+		timer_wheel_insert(&system_wheel, timer, system_wheel.now + delay_ticks);
+		result = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return result;
+}
+
+void timer_wheel_reschedule(timer_wheel_timer_t *timer, uint32_t expires)
+{
+	taskENTER_CRITICAL();
+	timer_wheel_insert(&system_wheel, timer, expires);
+	taskEXIT_CRITICAL();
+}
+
+bool timer_wheel_cancel(timer_wheel_timer_t *timer)
+{
+	taskENTER_CRITICAL();
+	const bool result = timer_wheel_remove(timer);
+	taskEXIT_CRITICAL();
+
+	return result;
+}
+
+void timer_wheel_tick(void)
+{
+	const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+	const uint32_t owners = timer_wheel_advance(&system_wheel, (uint32_t)xTaskGetTickCountFromISR());
+	taskEXIT_CRITICAL_FROM_ISR(saved);
+
+	for (uint8_t owner = 0U; (owner < (uint8_t)TIMER_WHEEL_OWNERS) && ((owners >> owner) != 0U); owner++)
+	{
+		const task_props_t *const props = app_context_task_props((task_enum_t)owner);
+		if ((0U != (owners & (1UL << owner))) && (NULL != props) && (NULL != props->task_handle))
+		{
+			// The tick interrupt switches to the woken task on its way out
+			vTaskNotifyGiveIndexedFromISR(props->task_handle, TIMER_WHEEL_NOTIFY_INDEX, NULL);
+		}
+	}
+}
+
+uint32_t timer_wheel_dispatch(task_enum_t owner)
+{
+	uint32_t count = 0U;
+	timer_wheel_timer_t *timer = NULL;
+
+	do
+	{
+		// One at a time, so a handler may start or cancel any timer
+		taskENTER_CRITICAL();
+		timer = timer_wheel_pop_expired(&system_wheel, (uint8_t)owner);
+		taskEXIT_CRITICAL();
+
+		if (NULL != timer)
+		{
+			timer->function(timer);
+			count++;
+		}
+	} while (NULL != timer);
+
+	return count;
+}
@@ -52,8 +52,6 @@ static output_result_t tm1637_set_brightness_output(output_driver_t *config, uin
 
 // ---- Bit-bang helpers (open-drain emulation) ----
 
-#define TM1637_DELAY_US (3)
-
 /**
  * @brief Configure a TM1637 signal for open-drain high state.
  *
@@ -143,13 +141,13 @@ static inline void tm1637_start(const output_driver_t *config)
 	// Ensure idle high on both lines
 	tm1637_clk_high(config);
 	tm1637_dio_high(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 
 	// Start: DIO goes low while CLK is high, then pull CLK low
 	tm1637_dio_low(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 	tm1637_clk_low(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 }
 
 /**
@@ -161,11 +159,11 @@ static inline void tm1637_stop(const output_driver_t *config)
 {
 	// Ensure DIO low, then release CLK, then release DIO
 	tm1637_dio_low(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 	tm1637_clk_high(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 	tm1637_dio_high(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 
 	// Deselect the chip via multiplexer
 	(void)config->select_interface(config->chip_id, false);
@@ -199,20 +197,20 @@ static inline int tm1637_write_byte(const output_driver_t *config, uint8_t data)
 			tm1637_dio_low(config); // drive low
 		}
 
-		sleep_us(TM1637_DELAY_US);
+		sleep_us(config->bit_delay_us);
 		tm1637_clk_high(config);
-		sleep_us(TM1637_DELAY_US);
+		sleep_us(config->bit_delay_us);
 	}
 
 	// ACK cycle: release DIO and sample while CLK high
 	tm1637_clk_low(config);
 	tm1637_dio_high(config); // release line for ACK from device
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 	tm1637_clk_high(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 	int ack = (0 == gpio_get(config->dio_pin)) ? 1 : 0; // 0 = pulled low by device -> ACK
 	tm1637_clk_low(config);
-	sleep_us(TM1637_DELAY_US);
+	sleep_us(config->bit_delay_us);
 
 	return ack;
 }
@@ -371,6 +369,7 @@ output_driver_t* tm1637_init(uint8_t chip_id,
 		config->spi = spi;
 		config->dio_pin = dio_pin;
 		config->clk_pin = clk_pin;
+		config->bit_delay_us = (uint8_t)OUTPUT_TIMING_DEFAULT_TM1637_US;
 
 		// Initialize buffer and state
 		(void)memset(config->active_buffer, 0, sizeof(config->active_buffer));
@@ -380,6 +379,7 @@ output_driver_t* tm1637_init(uint8_t chip_id,
 		config->display_on = false;
 		config->set_digits = &tm1637_set_digits;
 		config->set_leds = &tm1637_set_leds;
+		config->set_led_columns = &tm1637_set_led_columns;
 		config->set_brightness = &tm1637_set_brightness_output;
 
 		// Clear display on startup
@@ -604,9 +604,16 @@ static tm1637_result_t tm1637_process_digits(output_driver_t *config, const uint
 
 	for (uint8_t i = 0U; (i < TM1637_DIGIT_COUNT); i++)
 	{
-		// Extract BCD digit and get pattern
-		uint8_t bcd_digit = digits[i] & 0x0FU;
-		uint8_t segment_data = tm1637_custom_patterns[bcd_digit];
+		// Digit codes above the 4-bit font: blank and minus (0x0F and 0x0D in the font)
+		uint8_t segment_data = 0x00U;
+		if (digits[i] < 16U)
+		{
+			segment_data = tm1637_custom_patterns[digits[i]];
+		}
+		else if (OUTPUT_DIGIT_MINUS == digits[i])
+		{
+			segment_data = tm1637_custom_patterns[0x0DU];
+		}
 
 		// Add decimal point using conditional expression (no if-statement)
 		segment_data |= (i == dot_position) ? TM1637_DECIMAL_POINT_MASK : 0U;
@@ -698,6 +705,33 @@ output_result_t tm1637_set_leds(output_driver_t *config, const uint8_t leds, con
 	return tm1637_to_output_result(tm_result);
 }
 
+output_result_t tm1637_set_led_columns(output_driver_t *config, const uint8_t *columns, size_t count)
+{
+	tm1637_result_t tm_result = TM1637_OK;
+
+	if ((NULL == config) || (NULL == columns))
+	{
+		tm_result = TM1637_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		const size_t register_count = (count > TM1637_DISPLAY_BUFFER_SIZE) ? TM1637_DISPLAY_BUFFER_SIZE : count;
+
+		// Stage every register first so the bus sees a single flush
+		for (size_t i = 0U; (i < register_count) && (TM1637_OK == tm_result); i++)
+		{
+			tm_result = tm1637_update_buffer(config, (uint8_t)i, columns[i]);
+		}
+
+		if (TM1637_OK == tm_result)
+		{
+			tm_result = tm1637_update(config);
+		}
+	}
+
+	return tm1637_to_output_result(tm_result);
+}
+
 tm1637_result_t tm1637_display_off(output_driver_t *config)
 {
 	tm1637_result_t result = TM1637_OK;
@@ -474,8 +474,15 @@ static tm1639_result_t tm1639_process_digits(output_driver_t *config, const uint
 	// 3. Transpose Logic: Loop through each DIGIT
 	for (uint8_t digit_idx = 0; digit_idx < TM1639_DIGIT_COUNT; digit_idx++)
 	{
-		uint8_t bcd = digits[digit_idx] & 0x0F;
-		uint8_t pattern = standard_patterns[bcd];
+		uint8_t pattern = 0x00; // OUTPUT_DIGIT_BLANK
+		if (digits[digit_idx] < 16U)
+		{
+			pattern = standard_patterns[digits[digit_idx]];
+		}
+		else if (OUTPUT_DIGIT_MINUS == digits[digit_idx])
+		{
+			pattern = 0x40; // Segment g
+		}
 
 		// Add Decimal Point if needed (Standard Pattern uses Bit 7 for DP)
 		if (digit_idx == dot_position)
@@ -568,6 +575,7 @@ output_driver_t* tm1639_init(uint8_t chip_id,
 		config->set_digits = &tm1639_set_digits;
 		config->set_leds = &tm1639_set_leds;
 		config->set_brightness = &tm1639_set_brightness;
+		config->set_led_columns = &tm1639_set_led_columns;
 
 		// Clear display on startup
 		if (TM1639_OK != tm1639_clear(config))
@@ -791,3 +799,36 @@ output_result_t tm1639_set_leds(output_driver_t *config, const uint8_t leds, con
 
 	return tm1639_to_output_result(tm_result);
 }
+
+output_result_t tm1639_set_led_columns(output_driver_t *config, const uint8_t *columns, size_t count)
+{
+	tm1639_result_t tm_result = TM1639_OK;
+
+	if ((NULL == config) || (NULL == columns))
+	{
+		tm_result = TM1639_ERR_INVALID_PARAM;
+	}
+	else
+	{
+		const size_t column_count = (count > TM1639_DIGIT_COUNT) ? TM1639_DIGIT_COUNT : count;
+
+		// Same nibble split as tm1639_set_leds, staged for every column first
+		for (size_t i = 0U; (i < column_count) && (TM1639_OK == tm_result); i++)
+		{
+			const uint8_t addr = (uint8_t)(i * 2U);
+			tm_result = tm1639_update_buffer(config, addr, (uint8_t)(columns[i] & 0x0FU));
+			if (TM1639_OK == tm_result)
+			{
+				tm_result = tm1639_update_buffer(config, (uint8_t)(addr + 1U), (uint8_t)((columns[i] >> 4U) & 0x0FU));
+			}
+		}
+
+		// One flush for the whole matrix
+		if (TM1639_OK == tm_result)
+		{
+			tm_result = tm1639_update(config);
+		}
+	}
+
+	return tm1639_to_output_result(tm_result);
+}
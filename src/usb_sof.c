@@ -0,0 +1,105 @@
+/**
+ * @file usb_sof.c
+ * @brief USB start-of-frame tracking used to time outbound CDC flushes.
+ *
+ * SOF events are recorded by the TinyUSB device task and flushes by the CDC
+ * writer. Each shared value has a single writer and is exchanged through
+ * 32-bit atomics, so no lock is needed between the two tasks.
+ */
+
+#include "usb_sof.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/** Time of the most recent SOF (µs). */
+static atomic_uint_least32_t last_sof_us = ATOMIC_VAR_INIT(0U);
+/** Set once the first SOF has been recorded. */
+static atomic_bool sof_seen = ATOMIC_VAR_INIT(false);
+/** Time of the most recent flush (µs). */
+static atomic_uint_least32_t last_flush_us = ATOMIC_VAR_INIT(0U);
+/** Set by a flush, cleared when the following SOF closes its measurement. */
+static atomic_bool flush_pending = ATOMIC_VAR_INIT(false);
+
+/**
+ * @brief Flush-to-SOF slack histogram (only written by @ref usb_sof_on_frame()).
+ *
+ * Read on core 1 for the black box snapshot, so it stays in main SRAM.
+ */
+static volatile uint32_t slack_histogram[USB_SOF_SLACK_BUCKETS];
+
+void usb_sof_reset(void)
+{
+	atomic_store(&sof_seen, false);
+	atomic_store(&flush_pending, false);
+
+	for (uint8_t i = 0U; i < (uint8_t)USB_SOF_SLACK_BUCKETS; i++)
+	{
+		slack_histogram[i] = 0U;
+	}
+}
+
+void usb_sof_on_frame(uint32_t now_us)
+{
+	// A flush landing between the load and the store loses its sample only
+	if (atomic_load(&flush_pending))
+	{
+		atomic_store(&flush_pending, false);
+
+		const uint32_t slack_us = now_us - (uint32_t)atomic_load(&last_flush_us);
+
+		// Ignore flushes that straddled a suspend or a missed SOF
+		if (slack_us < USB_SOF_LOCK_TIMEOUT_US)
+		{
+			uint32_t bucket = slack_us >> USB_SOF_SLACK_BUCKET_SHIFT;
+			if (bucket >= USB_SOF_SLACK_BUCKETS)
+			{
+				bucket = USB_SOF_SLACK_BUCKETS - 1U;
+			}
+			slack_histogram[bucket]++;
+		}
+	}
+
+	atomic_store(&last_sof_us, now_us);
+	atomic_store(&sof_seen, true);
+}
+
+void usb_sof_on_flush(uint32_t now_us)
+{
+	atomic_store(&last_flush_us, now_us);
+	atomic_store(&flush_pending, true);
+}
+
+bool usb_sof_is_locked(uint32_t now_us)
+{
+	return atomic_load(&sof_seen) &&
+	       ((now_us - (uint32_t)atomic_load(&last_sof_us)) < USB_SOF_LOCK_TIMEOUT_US);
+}
+
+uint32_t usb_sof_flush_delay_us(uint32_t now_us)
+{
+	uint32_t delay_us = 0U;
+
+	if (usb_sof_is_locked(now_us))
+	{
+		// Phase within the current frame; at most a few subtractions while locked
+		uint32_t phase_us = now_us - (uint32_t)atomic_load(&last_sof_us);
+		while (phase_us >= USB_SOF_PERIOD_US)
+		{
+			phase_us -= USB_SOF_PERIOD_US;
+		}
+
+		const uint32_t flush_point_us = USB_SOF_PERIOD_US - USB_SOF_FLUSH_LEAD_US;
+		if (phase_us < flush_point_us)
+		{
+			delay_us = flush_point_us - phase_us;
+		}
+	}
+
+	return delay_us;
+}
+
+uint32_t usb_sof_slack_count(uint8_t bucket)
+{
+	return (bucket < (uint8_t)USB_SOF_SLACK_BUCKETS) ? slack_histogram[bucket] : 0U;
+}
@@ -64,6 +64,9 @@
 #define configTIMER_QUEUE_LENGTH                10
 #define configTIMER_TASK_STACK_DEPTH            2048
 
+// Index 1 wakes timer wheel owners, as on the target
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
+
 // POSIX-specific configuration
 #define configUSE_POSIX_ERRNO                   1
 
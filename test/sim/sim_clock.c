@@ -0,0 +1,163 @@
+/**
+ * @file sim_clock.c
+ * @brief Virtual clock and event queue for deterministic host simulations.
+ */
+
+#include "sim_clock.h"
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief One pending event.
+ */
+typedef struct sim_event_t {
+	uint64_t at_us;    /**< Dispatch time (µs). */
+	uint64_t sequence; /**< Scheduling order, breaks ties between equal times. */
+	sim_event_fn_t fn; /**< Handler. */
+	void *context;     /**< Handler context. */
+	uint32_t arg;      /**< Handler argument. */
+} sim_event_t;
+
+/** Pending events, kept as a binary min-heap on (time, sequence). */
+static sim_event_t events[SIM_CLOCK_MAX_EVENTS];
+/** Number of pending events. */
+static uint32_t event_count = 0U;
+/** Sequence number given to the next scheduled event. */
+static uint64_t next_sequence = 0U;
+/** Current virtual time (µs). */
+static uint64_t now_us = 0U;
+/** Random generator state. */
+static uint64_t random_state = 1U;
+
+/**
+ * @brief Heap order: earlier time first, then earlier scheduling.
+ */
+static bool event_before(const sim_event_t *a, const sim_event_t *b)
+{
+	return (a->at_us < b->at_us) || ((a->at_us == b->at_us) && (a->sequence < b->sequence));
+}
+
+static void event_swap(uint32_t a, uint32_t b)
+{
+	const sim_event_t tmp = events[a];
+	events[a] = events[b];
+	events[b] = tmp;
+}
+
+void sim_clock_reset(uint64_t seed)
+{
+	event_count = 0U;
+	next_sequence = 0U;
+	now_us = 0U;
+	// Splitmix the seed so small seeds still give well-mixed states; zero would lock xorshift
+	random_state = seed + 0x9E3779B97F4A7C15ULL;
+	random_state = (random_state ^ (random_state >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+	random_state = (random_state ^ (random_state >> 27U)) * 0x94D049BB133111EBULL;
+	random_state ^= random_state >> 31U;
+	if (0U == random_state)
+	{
+		random_state = 1U;
+	}
+}
+
+uint64_t sim_clock_now_us(void)
+{
+	return now_us;
+}
+
+uint32_t sim_clock_ticks(void)
+{
+	return (uint32_t)((now_us * (uint64_t)configTICK_RATE_HZ) / 1000000ULL);
+}
+
+bool sim_clock_schedule(uint64_t at_us, sim_event_fn_t fn, void *context, uint32_t arg)
+{
+	bool result = false;
+
+	if ((NULL != fn) && (event_count < SIM_CLOCK_MAX_EVENTS))
+	{
+		uint32_t index = event_count;
+		events[index].at_us = (at_us < now_us) ? now_us : at_us;
+		events[index].sequence = next_sequence;
+		events[index].fn = fn;
+		events[index].context = context;
+		events[index].arg = arg;
+		next_sequence++;
+		event_count++;
+
+		while ((index > 0U) && event_before(&events[index], &events[(index - 1U) / 2U]))
+		{
+			event_swap(index, (index - 1U) / 2U);
+			index = (index - 1U) / 2U;
+		}
+		result = true;
+	}
+
+	return result;
+}
+
+bool sim_clock_run_next(uint64_t end_us)
+{
+	bool result = false;
+
+	if ((event_count > 0U) && (events[0].at_us <= end_us))
+	{
+		const sim_event_t event = events[0];
+		uint32_t index = 0U;
+
+		event_count--;
+		events[0] = events[event_count];
+		for (;;)
+		{
+			const uint32_t left = (2U * index) + 1U;
+			const uint32_t right = left + 1U;
+			uint32_t smallest = index;
+
+			if ((left < event_count) && event_before(&events[left], &events[smallest]))
+			{
+				smallest = left;
+			}
+			if ((right < event_count) && event_before(&events[right], &events[smallest]))
+			{
+				smallest = right;
+			}
+			if (smallest == index)
+			{
+				break;
+			}
+			event_swap(index, smallest);
+			index = smallest;
+		}
+
+		now_us = event.at_us;
+		event.fn(event.context, event.arg);
+		result = true;
+	}
+	else if (end_us > now_us)
+	{
+		now_us = end_us;
+	}
+	else
+	{
+		// Nothing due and the clock is already at the end
+	}
+
+	return result;
+}
+
+uint32_t sim_clock_random(void)
+{
+	// xorshift64*
+	random_state ^= random_state >> 12U;
+	random_state ^= random_state << 25U;
+	random_state ^= random_state >> 27U;
+	return (uint32_t)((random_state * 0x2545F4914F6CDD1DULL) >> 32U);
+}
+
+uint32_t sim_clock_random_interval_us(uint32_t mean_us)
+{
+	const uint32_t span = (mean_us > 0U) ? (2U * mean_us) : 1U;
+	return 1U + (sim_clock_random() % span);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file sim_clock.h
+ * @brief Virtual clock and event queue for deterministic host simulations.
+ *
+ * One 64-bit microsecond clock drives every model in a simulation run: the
+ * @c time_us_32() mock, the FreeRTOS tick count and the virtual USB bus.
+ * Time only moves when the next scheduled event is dispatched, so a run
+ * advances as fast as the host executes it. Events due at the same time are
+ * dispatched in the order they were scheduled, and the random generator is
+ * seeded explicitly, so a run is reproducible for a given seed.
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of events pending at once.
+ */
+#define SIM_CLOCK_MAX_EVENTS 256U
+
+/**
+ * @brief Event handler.
+ *
+ * @param[in,out] context Context given to @ref sim_clock_schedule().
+ * @param[in]     arg     Argument given to @ref sim_clock_schedule().
+ */
+typedef void (*sim_event_fn_t)(void *context, uint32_t arg);
+
+/**
+ * @brief Drop every pending event, rewind the clock to zero and reseed.
+ *
+ * @param[in] seed Random generator seed.
+ */
+void sim_clock_reset(uint64_t seed);
+
+/**
+ * @brief Current virtual time.
+ *
+ * @return Microseconds since @ref sim_clock_reset().
+ */
+uint64_t sim_clock_now_us(void);
+
+/**
+ * @brief Current virtual time as a FreeRTOS tick count.
+ *
+ * @return Ticks at @c configTICK_RATE_HZ since @ref sim_clock_reset().
+ */
+uint32_t sim_clock_ticks(void);
+
+/**
+ * @brief Schedule an event.
+ *
+ * Times in the past are dispatched at the current time.
+ *
+ * @param[in] at_us   Virtual time to dispatch at (µs).
+ * @param[in] fn      Handler.
+ * @param[in] context Handler context.
+ * @param[in] arg     Handler argument.
+ *
+ * @retval true  Event scheduled.
+ * @retval false Event queue full.
+ */
+bool sim_clock_schedule(uint64_t at_us, sim_event_fn_t fn, void *context, uint32_t arg);
+
+/**
+ * @brief Advance to the earliest pending event and dispatch it.
+ *
+ * @param[in] end_us Events after this time are left pending.
+ *
+ * @retval true  An event was dispatched.
+ * @retval false No event is due by @p end_us; the clock is left at @p end_us.
+ */
+bool sim_clock_run_next(uint64_t end_us);
+
+/**
+ * @brief Next value of the seeded random generator.
+ *
+ * @return Uniformly distributed 32-bit value.
+ */
+uint32_t sim_clock_random(void);
+
+/**
+ * @brief Random interval around a mean.
+ *
+ * @param[in] mean_us Mean interval (µs).
+ *
+ * @return Uniformly distributed interval in [1, 2 * @p mean_us] µs.
+ */
+uint32_t sim_clock_random_interval_us(uint32_t mean_us);
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,237 @@
+/**
+ * @file sim_faults.c
+ * @brief Fault schedule and recovery metrics for host simulations.
+ */
+
+#include "sim_faults.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief One scheduled fault.
+ */
+typedef struct sim_fault_t {
+	sim_fault_type_t type; /**< Fault type. */
+	uint64_t start_us;     /**< Start time (µs). */
+	uint64_t end_us;       /**< End time (µs). */
+	bool started;          /**< Start has been processed. */
+	bool ended;            /**< End has been processed. */
+	bool recovered;        /**< Recovery has been recorded. */
+} sim_fault_t;
+
+/** Names accepted by @ref sim_faults_parse(), indexed by type. */
+static const char *const fault_names[SIM_FAULT_TYPE_COUNT] = {
+	"usb-stall",
+	"corrupt",
+	"tm1637-nack",
+	"queue-full",
+};
+
+/** Channel each fault type is judged on. */
+static const sim_fault_channel_t fault_channels[SIM_FAULT_TYPE_COUNT] = {
+	SIM_CHANNEL_MESSAGES,
+	SIM_CHANNEL_MESSAGES,
+	SIM_CHANNEL_DISPLAY,
+	SIM_CHANNEL_MESSAGES,
+};
+
+/** Scheduled faults. */
+static sim_fault_t faults[SIM_FAULTS_MAX];
+/** Number of scheduled faults. */
+static uint32_t fault_count = 0U;
+/** Metrics per fault type. */
+static sim_fault_metrics_t metrics[SIM_FAULT_TYPE_COUNT];
+/** Largest on-time latency (µs). */
+static uint64_t on_time_limit_us = 0U;
+
+void sim_faults_reset(void)
+{
+	(void)memset(faults, 0, sizeof(faults));
+	(void)memset(metrics, 0, sizeof(metrics));
+	fault_count = 0U;
+}
+
+void sim_faults_restart(uint64_t on_time_us)
+{
+	for (uint32_t i = 0U; i < fault_count; i++)
+	{
+		faults[i].started = false;
+		faults[i].ended = false;
+		faults[i].recovered = false;
+	}
+	(void)memset(metrics, 0, sizeof(metrics));
+	on_time_limit_us = on_time_us;
+}
+
+bool sim_faults_add(sim_fault_type_t type, uint64_t start_us, uint64_t duration_us)
+{
+	bool result = false;
+
+	if ((type < SIM_FAULT_TYPE_COUNT) && (fault_count < SIM_FAULTS_MAX))
+	{
+		faults[fault_count].type = type;
+		faults[fault_count].start_us = start_us;
+		faults[fault_count].end_us = start_us + duration_us;
+		fault_count++;
+		result = true;
+	}
+
+	return result;
+}
+
+bool sim_faults_parse(const char *text)
+{
+	bool result = false;
+	const char *at = strchr(text, '@');
+
+	if (NULL != at)
+	{
+		for (uint32_t type = 0U; type < (uint32_t)SIM_FAULT_TYPE_COUNT; type++)
+		{
+			const size_t length = strlen(fault_names[type]);
+
+			if ((length == (size_t)(at - text)) && (0 == strncmp(text, fault_names[type], length)))
+			{
+				char *end = NULL;
+				const unsigned long long start_ms = strtoull(at + 1, &end, 10);
+
+				if ((NULL != end) && ('+' == *end))
+				{
+					const char *duration = end + 1;
+					const unsigned long long duration_ms = strtoull(duration, &end, 10);
+
+					if ((end != duration) && ('\0' == *end))
+					{
+						result = sim_faults_add((sim_fault_type_t)type, start_ms * 1000ULL, duration_ms * 1000ULL);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
+uint32_t sim_faults_update(uint64_t now_us)
+{
+	uint32_t started = 0U;
+
+	for (uint32_t i = 0U; i < fault_count; i++)
+	{
+		if ((!faults[i].started) && (now_us >= faults[i].start_us))
+		{
+			faults[i].started = true;
+			metrics[faults[i].type].injected++;
+			started |= 1UL << (uint32_t)faults[i].type;
+		}
+		if ((!faults[i].ended) && (now_us >= faults[i].end_us))
+		{
+			faults[i].ended = true;
+		}
+	}
+
+	return started;
+}
+
+uint64_t sim_faults_next_change(uint64_t now_us)
+{
+	uint64_t next = UINT64_MAX;
+
+	for (uint32_t i = 0U; i < fault_count; i++)
+	{
+		if ((faults[i].start_us > now_us) && (faults[i].start_us < next))
+		{
+			next = faults[i].start_us;
+		}
+		if ((faults[i].end_us > now_us) && (faults[i].end_us < next))
+		{
+			next = faults[i].end_us;
+		}
+	}
+
+	return next;
+}
+
+bool sim_faults_active(sim_fault_type_t type)
+{
+	bool result = false;
+
+	for (uint32_t i = 0U; (i < fault_count) && !result; i++)
+	{
+		result = (type == faults[i].type) && faults[i].started && !faults[i].ended;
+	}
+
+	return result;
+}
+
+uint64_t sim_faults_remaining_us(sim_fault_type_t type, uint64_t now_us)
+{
+	uint64_t result = 0U;
+
+	for (uint32_t i = 0U; i < fault_count; i++)
+	{
+		if ((type == faults[i].type) && faults[i].started && !faults[i].ended && (faults[i].end_us > now_us) &&
+		    ((faults[i].end_us - now_us) > result))
+		{
+			result = faults[i].end_us - now_us;
+		}
+	}
+
+	return result;
+}
+
+void sim_faults_on_delivery(sim_fault_channel_t channel, uint64_t created_us, uint64_t now_us)
+{
+	const bool on_time = (now_us - created_us) <= on_time_limit_us;
+
+	for (uint32_t i = 0U; (i < fault_count) && on_time; i++)
+	{
+		sim_fault_t *fault = &faults[i];
+
+		if ((channel == fault_channels[fault->type]) && fault->ended && !fault->recovered && (created_us >= fault->end_us))
+		{
+			sim_fault_metrics_t *fault_metrics = &metrics[fault->type];
+			const uint64_t recover_us = now_us - fault->end_us;
+
+			fault->recovered = true;
+			fault_metrics->recovered++;
+			fault_metrics->recover_sum_us += recover_us;
+			if (recover_us > fault_metrics->recover_max_us)
+			{
+				fault_metrics->recover_max_us = recover_us;
+			}
+		}
+	}
+}
+
+void sim_faults_on_loss(sim_fault_channel_t channel, uint64_t count)
+{
+	const sim_fault_t *latest = NULL;
+
+	for (uint32_t i = 0U; i < fault_count; i++)
+	{
+		if ((channel == fault_channels[faults[i].type]) && faults[i].started && !faults[i].recovered &&
+		    ((NULL == latest) || (faults[i].start_us >= latest->start_us)))
+		{
+			latest = &faults[i];
+		}
+	}
+
+	if (NULL != latest)
+	{
+		metrics[latest->type].lost += count;
+	}
+}
+
+const sim_fault_metrics_t *sim_faults_metrics(sim_fault_type_t type)
+{
+	return (type < SIM_FAULT_TYPE_COUNT) ? &metrics[type] : NULL;
+}
+
+const char *sim_faults_name(sim_fault_type_t type)
+{
+	return (type < SIM_FAULT_TYPE_COUNT) ? fault_names[type] : "unknown";
+}
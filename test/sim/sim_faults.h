@@ -0,0 +1,164 @@
+/**
+ * @file sim_faults.h
+ * @brief Fault schedule and recovery metrics for host simulations.
+ *
+ * A simulation registers timed faults, asks whether each one is active while
+ * it runs its models, and reports every delivery and every loss on the
+ * channel it belongs to. A fault has recovered at the first on-time delivery
+ * of something created after the fault ended, and its time-to-recover is
+ * measured from the end of the fault. Losses on a channel are charged to the
+ * most recent fault on that channel that has not yet recovered.
+ */
+
+#ifndef SIM_FAULTS_H
+#define SIM_FAULTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of scheduled faults.
+ */
+#define SIM_FAULTS_MAX 32U
+
+/**
+ * @brief Fault types.
+ */
+typedef enum sim_fault_type_t {
+	SIM_FAULT_USB_STALL = 0, /**< The host stops servicing both bulk endpoints. */
+	SIM_FAULT_CORRUPT_BURST, /**< Every host frame arrives with a flipped byte. */
+	SIM_FAULT_TM1637_NACK,   /**< TM1637 displays stop acknowledging bytes. */
+	SIM_FAULT_QUEUE_FULL,    /**< Core 1 is held busy, so its queues fill up. */
+	SIM_FAULT_TYPE_COUNT
+} sim_fault_type_t;
+
+/**
+ * @brief What a fault's recovery is judged on.
+ */
+typedef enum sim_fault_channel_t {
+	SIM_CHANNEL_MESSAGES = 0, /**< Messages between host and device. */
+	SIM_CHANNEL_DISPLAY,      /**< Display updates. */
+	SIM_CHANNEL_COUNT
+} sim_fault_channel_t;
+
+/**
+ * @brief Results per fault type.
+ */
+typedef struct sim_fault_metrics_t {
+	uint32_t injected;       /**< Faults that started. */
+	uint32_t recovered;      /**< Faults followed by an on-time delivery. */
+	uint64_t recover_sum_us; /**< Sum of the times to recover (µs). */
+	uint64_t recover_max_us; /**< Longest time to recover (µs). */
+	uint64_t lost;           /**< Items lost while a fault of this type was unrecovered. */
+} sim_fault_metrics_t;
+
+/**
+ * @brief Clear the schedule and the metrics.
+ */
+void sim_faults_reset(void);
+
+/**
+ * @brief Keep the schedule but clear the metrics, ready for a run.
+ *
+ * @param[in] on_time_us Largest latency that counts as an on-time delivery (µs).
+ */
+void sim_faults_restart(uint64_t on_time_us);
+
+/**
+ * @brief Add a fault to the schedule.
+ *
+ * @param[in] type        Fault type.
+ * @param[in] start_us    Start time (µs).
+ * @param[in] duration_us Duration (µs).
+ *
+ * @retval true  Fault added.
+ * @retval false Schedule full or type out of range.
+ */
+bool sim_faults_add(sim_fault_type_t type, uint64_t start_us, uint64_t duration_us);
+
+/**
+ * @brief Parse a fault given as @c type@start_ms+duration_ms.
+ *
+ * Types: @c usb-stall, @c corrupt, @c tm1637-nack, @c queue-full.
+ *
+ * @param[in] text Fault description.
+ *
+ * @retval true  Fault added.
+ * @retval false Malformed description or schedule full.
+ */
+bool sim_faults_parse(const char *text);
+
+/**
+ * @brief Start and end faults due at the current virtual time.
+ *
+ * @param[in] now_us Current time (µs).
+ *
+ * @return Bit n set when a fault of type n started at this call.
+ */
+uint32_t sim_faults_update(uint64_t now_us);
+
+/**
+ * @brief Earliest fault start or end after a time.
+ *
+ * @param[in] now_us Current time (µs).
+ *
+ * @return Next transition time (µs), or UINT64_MAX when none is left.
+ */
+uint64_t sim_faults_next_change(uint64_t now_us);
+
+/**
+ * @brief Whether a fault of a type is in effect.
+ *
+ * @param[in] type Fault type.
+ *
+ * @retval true  In effect.
+ * @retval false Not in effect.
+ */
+bool sim_faults_active(sim_fault_type_t type);
+
+/**
+ * @brief Time left on the active fault of a type.
+ *
+ * @param[in] type   Fault type.
+ * @param[in] now_us Current time (µs).
+ *
+ * @return Time until the fault ends (µs), 0 when not active.
+ */
+uint64_t sim_faults_remaining_us(sim_fault_type_t type, uint64_t now_us);
+
+/**
+ * @brief Report a delivery.
+ *
+ * @param[in] channel    Channel delivered on.
+ * @param[in] created_us Creation time of the item (µs).
+ * @param[in] now_us     Delivery time (µs).
+ */
+void sim_faults_on_delivery(sim_fault_channel_t channel, uint64_t created_us, uint64_t now_us);
+
+/**
+ * @brief Report lost items.
+ *
+ * @param[in] channel Channel lost on.
+ * @param[in] count   Number of items.
+ */
+void sim_faults_on_loss(sim_fault_channel_t channel, uint64_t count);
+
+/**
+ * @brief Results for one fault type.
+ *
+ * @param[in] type Fault type.
+ *
+ * @return Metrics, or NULL when @p type is out of range.
+ */
+const sim_fault_metrics_t *sim_faults_metrics(sim_fault_type_t type);
+
+/**
+ * @brief Printable name of a fault type.
+ *
+ * @param[in] type Fault type.
+ *
+ * @return Name as accepted by @ref sim_faults_parse().
+ */
+const char *sim_faults_name(sim_fault_type_t type);
+
+#endif // SIM_FAULTS_H
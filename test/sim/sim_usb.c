@@ -0,0 +1,141 @@
+/**
+ * @file sim_usb.c
+ * @brief Virtual full-speed USB CDC link for host simulations.
+ */
+
+#include "sim_usb.h"
+
+#include <string.h>
+
+static void fifo_init(sim_fifo_t *fifo, uint8_t *data, uint32_t size)
+{
+	fifo->data = data;
+	fifo->size = size;
+	fifo->head = 0U;
+	fifo->count = 0U;
+}
+
+static uint32_t fifo_put(sim_fifo_t *fifo, const uint8_t *data, uint32_t length)
+{
+	const uint32_t room = fifo->size - fifo->count;
+	const uint32_t count = (length < room) ? length : room;
+
+	for (uint32_t i = 0U; i < count; i++)
+	{
+		fifo->data[(fifo->head + fifo->count + i) % fifo->size] = data[i];
+	}
+	fifo->count += count;
+
+	return count;
+}
+
+static uint32_t fifo_get(sim_fifo_t *fifo, uint8_t *buffer, uint32_t length)
+{
+	const uint32_t count = (length < fifo->count) ? length : fifo->count;
+
+	for (uint32_t i = 0U; i < count; i++)
+	{
+		buffer[i] = fifo->data[(fifo->head + i) % fifo->size];
+	}
+	fifo->head = (fifo->head + count) % fifo->size;
+	fifo->count -= count;
+
+	return count;
+}
+
+void sim_usb_init(sim_usb_t *usb, uint32_t bytes_per_frame)
+{
+	(void)memset(usb, 0, sizeof(*usb));
+	fifo_init(&usb->host_out, usb->host_out_data, sizeof(usb->host_out_data));
+	fifo_init(&usb->rx, usb->rx_data, sizeof(usb->rx_data));
+	fifo_init(&usb->tx, usb->tx_data, sizeof(usb->tx_data));
+	usb->bytes_per_frame = bytes_per_frame;
+}
+
+uint32_t sim_usb_host_write(sim_usb_t *usb, const uint8_t *data, uint32_t length)
+{
+	uint32_t result = 0U;
+
+	if ((usb->host_out.size - usb->host_out.count) >= length)
+	{
+		result = fifo_put(&usb->host_out, data, length);
+	}
+
+	return result;
+}
+
+uint32_t sim_usb_read(sim_usb_t *usb, uint8_t *buffer, uint32_t length)
+{
+	return fifo_get(&usb->rx, buffer, length);
+}
+
+uint32_t sim_usb_write_available(const sim_usb_t *usb)
+{
+	return usb->tx.size - usb->tx.count;
+}
+
+uint32_t sim_usb_write(sim_usb_t *usb, const uint8_t *data, uint32_t length)
+{
+	const uint32_t written = fifo_put(&usb->tx, data, length);
+
+	// A full bulk packet arms the endpoint without a flush
+	const uint32_t full_packets = (usb->tx.count / SIM_USB_BULK_PACKET) * SIM_USB_BULK_PACKET;
+	if (full_packets > usb->tx_committed)
+	{
+		usb->tx_committed = full_packets;
+	}
+
+	return written;
+}
+
+void sim_usb_flush(sim_usb_t *usb)
+{
+	usb->tx_committed = usb->tx.count;
+}
+
+bool sim_usb_frame(sim_usb_t *usb, sim_usb_host_rx_fn_t host_rx, void *context)
+{
+	uint8_t chunk[SIM_USB_BULK_PACKET];
+	uint32_t budget = usb->bytes_per_frame;
+	bool received = false;
+
+	usb->frames++;
+	if (usb->stalled)
+	{
+		usb->stalled_frames++;
+		budget = 0U;
+	}
+
+	// OUT: whole packets only, and only while the RX FIFO has room for them
+	while ((budget > 0U) && (usb->host_out.count > 0U))
+	{
+		const uint32_t length = (usb->host_out.count < SIM_USB_BULK_PACKET) ? usb->host_out.count : SIM_USB_BULK_PACKET;
+		if ((usb->rx.size - usb->rx.count) < length)
+		{
+			usb->out_nak_frames++;
+			break;
+		}
+		const uint32_t moved = fifo_get(&usb->host_out, chunk, length);
+		(void)fifo_put(&usb->rx, chunk, moved);
+		usb->out_bytes += moved;
+		budget = (budget > SIM_USB_BULK_PACKET) ? (budget - SIM_USB_BULK_PACKET) : 0U;
+		received = true;
+	}
+
+	// IN: committed bytes, one bulk packet at a time
+	budget = usb->stalled ? 0U : usb->bytes_per_frame;
+	while ((budget > 0U) && (usb->tx_committed > 0U))
+	{
+		const uint32_t length = (usb->tx_committed < SIM_USB_BULK_PACKET) ? usb->tx_committed : SIM_USB_BULK_PACKET;
+		const uint32_t moved = fifo_get(&usb->tx, chunk, length);
+		usb->tx_committed -= moved;
+		usb->in_bytes += moved;
+		if (NULL != host_rx)
+		{
+			host_rx(context, chunk, moved);
+		}
+		budget = (budget > SIM_USB_BULK_PACKET) ? (budget - SIM_USB_BULK_PACKET) : 0U;
+	}
+
+	return received;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file sim_usb.h
+ * @brief Virtual full-speed USB CDC link for host simulations.
+ *
+ * Models the TinyUSB CDC FIFOs on the device side and the bulk transfers the
+ * host schedules once per 1 ms frame. OUT data waits on the host until the
+ * device RX FIFO has room (the device NAKs), so host writes are never lost.
+ * IN data leaves the device TX FIFO only once it is committed, either by a
+ * flush or because a full bulk packet is buffered, which is how TinyUSB arms
+ * the IN endpoint.
+ */
+
+#ifndef SIM_USB_H
+#define SIM_USB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tusb_config.h"
+
+/**
+ * @brief Full-speed bulk packet size (bytes).
+ */
+#define SIM_USB_BULK_PACKET 64U
+
+/**
+ * @brief Default bulk bytes moved per direction per frame.
+ *
+ * Full speed fits up to 19 bulk packets in a frame on an idle bus; the
+ * default assumes a bus shared with other devices.
+ */
+#define SIM_USB_DEFAULT_BYTES_PER_FRAME (8U * SIM_USB_BULK_PACKET)
+
+/**
+ * @brief Bytes the host can hold for the device before its writes stall.
+ */
+#define SIM_USB_HOST_OUT_SIZE 8192U
+
+/**
+ * @brief Byte FIFO.
+ */
+typedef struct sim_fifo_t {
+	uint8_t *data;     /**< Storage. */
+	uint32_t size;     /**< Capacity (bytes). */
+	uint32_t head;     /**< Next byte to read. */
+	uint32_t count;    /**< Bytes stored. */
+} sim_fifo_t;
+
+/**
+ * @brief Receives the IN data delivered in one frame on the host side.
+ *
+ * @param[in,out] context Context given to @ref sim_usb_frame().
+ * @param[in]     data    Bytes received.
+ * @param[in]     length  Number of bytes.
+ */
+typedef void (*sim_usb_host_rx_fn_t)(void *context, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Virtual CDC link.
+ */
+typedef struct sim_usb_t {
+	uint8_t host_out_data[SIM_USB_HOST_OUT_SIZE];  /**< Host-side OUT buffer storage. */
+	uint8_t rx_data[CFG_TUD_CDC_RX_BUFSIZE];       /**< Device RX FIFO storage. */
+	uint8_t tx_data[CFG_TUD_CDC_TX_BUFSIZE];       /**< Device TX FIFO storage. */
+	sim_fifo_t host_out;                           /**< Bytes written by the host, not yet sent. */
+	sim_fifo_t rx;                                 /**< Device RX FIFO (@c tud_cdc_n_read). */
+	sim_fifo_t tx;                                 /**< Device TX FIFO (@c tud_cdc_n_write). */
+	uint32_t tx_committed;                         /**< TX bytes the IN endpoint may send. */
+	uint32_t bytes_per_frame;                      /**< Bulk bytes per direction per frame. */
+	bool stalled;                                  /**< Host is not servicing the endpoints. */
+	uint64_t frames;                               /**< Frames run. */
+	uint64_t out_bytes;                            /**< Bytes moved host to device. */
+	uint64_t in_bytes;                             /**< Bytes moved device to host. */
+	uint64_t out_nak_frames;                       /**< Frames where OUT data waited on a full RX FIFO. */
+	uint64_t stalled_frames;                       /**< Frames with no transfers because of a stall. */
+} sim_usb_t;
+
+/**
+ * @brief Empty every FIFO and set the per-frame bandwidth.
+ *
+ * @param[out] usb             Link.
+ * @param[in]  bytes_per_frame Bulk bytes per direction per frame.
+ */
+void sim_usb_init(sim_usb_t *usb, uint32_t bytes_per_frame);
+
+/**
+ * @brief Queue host data for the device.
+ *
+ * @param[in,out] usb    Link.
+ * @param[in]     data   Bytes to send.
+ * @param[in]     length Number of bytes.
+ *
+ * @return @p length, or 0 when the host buffer cannot take all of it.
+ */
+uint32_t sim_usb_host_write(sim_usb_t *usb, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Device read from the RX FIFO, as @c tud_cdc_n_read().
+ *
+ * @param[in,out] usb    Link.
+ * @param[out]    buffer Destination.
+ * @param[in]     length Buffer size.
+ *
+ * @return Bytes read.
+ */
+uint32_t sim_usb_read(sim_usb_t *usb, uint8_t *buffer, uint32_t length);
+
+/**
+ * @brief Free space in the TX FIFO, as @c tud_cdc_n_write_available().
+ *
+ * @param[in] usb Link.
+ *
+ * @return Bytes that can be written.
+ */
+uint32_t sim_usb_write_available(const sim_usb_t *usb);
+
+/**
+ * @brief Device write to the TX FIFO, as @c tud_cdc_n_write().
+ *
+ * @param[in,out] usb    Link.
+ * @param[in]     data   Bytes to write.
+ * @param[in]     length Number of bytes.
+ *
+ * @return Bytes written.
+ */
+uint32_t sim_usb_write(sim_usb_t *usb, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Commit everything in the TX FIFO, as @c tud_cdc_write_flush().
+ *
+ * @param[in,out] usb Link.
+ */
+void sim_usb_flush(sim_usb_t *usb);
+
+/**
+ * @brief Run the bulk transfers of one frame.
+ *
+ * Nothing moves while @ref sim_usb_t::stalled is set.
+ *
+ * @param[in,out] usb     Link.
+ * @param[in]     host_rx Receives the IN data.
+ * @param[in,out] context Passed to @p host_rx.
+ *
+ * @retval true  New OUT data reached the device RX FIFO.
+ * @retval false No OUT data moved.
+ */
+bool sim_usb_frame(sim_usb_t *usb, sim_usb_host_rx_fn_t host_rx, void *context);
+
+#endif // SIM_USB_H
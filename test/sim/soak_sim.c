@@ -0,0 +1,1118 @@
+/**
+ * @file soak_sim.c
+ * @brief Deterministic virtual-time soak run of the USB communication path.
+ *
+ * Runs the firmware's frame assembler, COBS codec, packet builder, inbound
+ * dispatcher and SOF flush timing against a virtual USB link and a seeded
+ * traffic scenario, all on one virtual clock (@ref sim_clock.h). The host
+ * sends echo requests and the device produces input events; both carry their
+ * creation time, so the host side measures end-to-end latency, and every
+ * queue drop is counted where the firmware counts it.
+ *
+ * The FreeRTOS scheduler is not run: the POSIX port ticks from a host
+ * interval timer, which cannot follow a virtual clock. The tasks on the
+ * communication path are modelled instead as run-to-completion steps with a
+ * fixed CPU cost on their configured core, reading and writing queues sized
+ * as on the device. Firmware code that reads the time sees the virtual clock
+ * through the @c time_us_32() mock and the wrapped @c xTaskGetTickCount().
+ *
+ * Faults from @ref sim_faults.h can be injected with @c --fault: a USB stall,
+ * a burst of corrupted host frames, a TM1637 NACK storm on a display driven
+ * through the real TM1637 driver, or core 1 held busy until its queues fill.
+ * The run then reports the time to recover and the items lost per fault type.
+ *
+ * Usage: soak_sim [--seconds N] [--seed N] [--host-rate HZ] [--event-rate HZ]
+ *                 [--frame-bytes N] [--display-rate HZ] [--on-time-us N]
+ *                 [--fault type@start_ms+duration_ms]... [--check]
+ *
+ * With @c --check the scenario runs twice and the exit status is non-zero if
+ * the two runs differ or a message went missing without being counted. The
+ * exit status is also non-zero if a fault never recovers.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+#include "app_comm.h"
+#include "app_config.h"
+#include "app_context.h"
+#include "cobs.h"
+#include "commands.h"
+#include "encoded_framer.h"
+#include "error_management.h"
+#include "tm1637.h"
+#include "usb_sof.h"
+
+#include "sim_clock.h"
+#include "sim_faults.h"
+#include "sim_usb.h"
+
+/** Default simulated duration (s). */
+#define SOAK_DEFAULT_SECONDS 600U
+/** Default echo requests per second from the host. */
+#define SOAK_DEFAULT_HOST_RATE_HZ 200U
+/** Default input events per second on the device. */
+#define SOAK_DEFAULT_EVENT_RATE_HZ 500U
+/** Default display refreshes per second. */
+#define SOAK_DEFAULT_DISPLAY_RATE_HZ 50U
+/** Default largest latency that counts as recovered (µs). */
+#define SOAK_DEFAULT_ON_TIME_US 5000U
+/** Time allowed after the traffic stops for in-flight messages to arrive (µs). */
+#define SOAK_DRAIN_US 1000000U
+/** TM1637 data pin of the simulated display. */
+#define SOAK_TM1637_DIO_PIN 19U
+/** TM1637 clock pin of the simulated display. */
+#define SOAK_TM1637_CLK_PIN 18U
+
+/** CPU cost of one uart_event_task wake-up (µs). */
+#define SOAK_UART_EVENT_COST_US 4U
+/** Bytes the uart_event_task assembles per extra microsecond. */
+#define SOAK_UART_EVENT_BYTES_PER_US 16U
+/** CPU cost of decoding and dispatching one inbound frame (µs). */
+#define SOAK_DECODE_COST_US 12U
+/** CPU cost of building one outbound packet (µs). */
+#define SOAK_OUTBOUND_COST_US 10U
+/** CPU cost of copying one packet into the TX FIFO (µs). */
+#define SOAK_CDC_WRITE_COST_US 3U
+/** CPU cost of one bit-banged TM1637 digit update at the default half period (µs). */
+#define SOAK_DISPLAY_COST_US 400U
+
+/** Latency histogram bucket width (µs). */
+#define SOAK_LATENCY_BUCKET_US 50U
+/** Latency histogram buckets; the last one collects everything longer. */
+#define SOAK_LATENCY_BUCKETS 4000U
+
+/** Payload carried by every scenario message: sequence number and creation time. */
+#define SOAK_PAYLOAD_SIZE 12U
+
+_Static_assert(SOAK_PAYLOAD_SIZE <= DATA_BUFFER_SIZE, "scenario payload must fit a message");
+
+/**
+ * @brief Scenario parameters.
+ */
+typedef struct soak_config_t {
+	uint64_t seconds;          /**< Traffic duration (s). */
+	uint64_t seed;             /**< Random seed. */
+	uint32_t host_rate_hz;     /**< Echo requests per second. */
+	uint32_t event_rate_hz;    /**< Input events per second. */
+	uint32_t frame_bytes;      /**< Bulk bytes per direction per USB frame. */
+	uint32_t display_rate_hz;  /**< Display refreshes per second. */
+	uint64_t on_time_us;       /**< Largest latency that counts as recovered (µs). */
+} soak_config_t;
+
+/**
+ * @brief Latency distribution of one message flow.
+ */
+typedef struct soak_latency_t {
+	uint64_t count;                             /**< Samples. */
+	uint64_t sum_us;                            /**< Sum of samples (µs). */
+	uint64_t max_us;                            /**< Largest sample (µs). */
+	uint64_t buckets[SOAK_LATENCY_BUCKETS];     /**< Histogram. */
+} soak_latency_t;
+
+/**
+ * @brief Everything a run reports; compared byte for byte by @c --check.
+ */
+typedef struct soak_results_t {
+	uint64_t echo_sent;               /**< Echo requests written by the host. */
+	uint64_t echo_host_stalled;       /**< Echo requests the host could not write. */
+	uint64_t echo_delivered;          /**< Echo replies received by the host. */
+	uint64_t echo_dropped;            /**< Echo requests or replies dropped on a full queue. */
+	uint64_t echo_corrupted;          /**< Echo requests corrupted by a fault. */
+	uint64_t event_sent;              /**< Input events produced. */
+	uint64_t event_delivered;         /**< Input events received by the host. */
+	uint64_t event_dropped;           /**< Input events dropped on a full queue. */
+	uint64_t display_updates;         /**< Display updates written. */
+	uint64_t display_failed;          /**< Display updates the TM1637 did not acknowledge. */
+	uint64_t flushes;                 /**< CDC flushes. */
+	uint64_t out_nak_frames;          /**< Frames where host data waited on the device. */
+	uint64_t stalled_frames;          /**< USB frames lost to a stall. */
+	uint64_t core_busy_us[2];         /**< CPU time used per core (µs). */
+	uint32_t counters[NUM_STATISTICS_COUNTERS]; /**< Firmware statistics at the end. */
+	soak_latency_t echo_latency;      /**< Host request to host reply. */
+	soak_latency_t event_latency;     /**< Device event to host receipt. */
+	sim_fault_metrics_t faults[SIM_FAULT_TYPE_COUNT]; /**< Recovery per fault type. */
+} soak_results_t;
+
+/**
+ * @brief Modelled firmware task.
+ */
+typedef enum soak_task_t {
+	SOAK_UART_EVENT = 0, /**< Assembles frames from the RX FIFO (core 0). */
+	SOAK_DECODE,         /**< Decodes and dispatches frames (core 1). */
+	SOAK_OUTBOUND,       /**< Turns input events into packets (core 1). */
+	SOAK_CDC_WRITE,      /**< Fills and flushes the TX FIFO (core 0). */
+	SOAK_DISPLAY,        /**< Writes the TM1637 display (core 1). */
+	SOAK_TASK_COUNT
+} soak_task_t;
+
+/**
+ * @brief Input event waiting in the data event queue.
+ */
+typedef struct soak_event_t {
+	uint32_t sequence;   /**< Event number. */
+	uint64_t created_us; /**< Creation time (µs). */
+} soak_event_t;
+
+/**
+ * @brief Simulation state.
+ */
+typedef struct soak_t {
+	soak_config_t config;                               /**< Scenario. */
+	soak_results_t results;                             /**< Measurements. */
+	sim_usb_t usb;                                      /**< Virtual CDC link. */
+	encoded_framer_t device_framer;                     /**< uart_event_task framer. */
+	encoded_framer_t host_framer;                       /**< Host-side framer. */
+	encoded_frame_t encoded_queue[ENCODED_QUEUE_SIZE];  /**< Encoded frame queue. */
+	uint32_t encoded_head;                              /**< Oldest queued frame. */
+	uint32_t encoded_count;                             /**< Queued frames. */
+	cdc_packet_t cdc_queue[CDC_TRANSMIT_QUEUE_SIZE];    /**< CDC transmit queue. */
+	uint32_t cdc_head;                                  /**< Oldest queued packet. */
+	uint32_t cdc_count;                                 /**< Queued packets. */
+	soak_event_t event_queue[DATA_EVENT_QUEUE_SIZE];    /**< Data event queue. */
+	uint32_t event_head;                                /**< Oldest queued event. */
+	uint32_t event_count;                               /**< Queued events. */
+	uint64_t core_free_us[2];                           /**< Time each core finishes its current step. */
+	bool task_pending[SOAK_TASK_COUNT];                 /**< Task has a run scheduled. */
+	bool cdc_partial;                                   /**< Head packet partly written. */
+	uint32_t cdc_written;                               /**< Bytes of the head packet written. */
+	bool flush_armed;                                   /**< cdc_write_task is waiting for its flush point. */
+	bool sending_echo;                                  /**< The packet being built is an echo reply. */
+	bool traffic_on;                                    /**< Scenario still generating traffic. */
+	uint32_t echo_sequence;                             /**< Next echo number. */
+	uint32_t event_sequence;                            /**< Next event number. */
+	output_driver_t *display;                           /**< TM1637 display driver. */
+	uint64_t display_due_us;                            /**< Time of the refresh being written. */
+} soak_t;
+
+/** Stand-in handle for the CDC transmit queue seen by app_comm. */
+static uint8_t cdc_queue_tag;
+
+/** State of the run in progress (large, so not on the stack). */
+static soak_t soak;
+
+/** Results of the first run, kept for @c --check. */
+static soak_results_t first_results;
+
+/** Core each modelled task runs on. */
+static const uint8_t task_core[SOAK_TASK_COUNT] = {0U, 1U, 1U, 0U, 1U};
+
+/** CPU cost of each modelled step (µs), before per-byte work. */
+static const uint32_t task_cost_us[SOAK_TASK_COUNT] = {
+	SOAK_UART_EVENT_COST_US,
+	SOAK_DECODE_COST_US,
+	SOAK_OUTBOUND_COST_US,
+	SOAK_CDC_WRITE_COST_US,
+	SOAK_DISPLAY_COST_US,
+};
+
+static void task_run(void *context, uint32_t task);
+static void wake_task(soak_task_t task);
+
+BaseType_t __wrap_xQueueGenericSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait, BaseType_t xCopyPosition);
+TickType_t __wrap_xTaskGetTickCount(void);
+void mock_time_set_source(uint64_t (*source)(void));
+void mock_gpio_set_get_hook(bool (*hook)(uint32_t gpio));
+
+/**
+ * @brief Count a message lost on a full queue against its flow and any open fault.
+ */
+static void message_dropped(bool echo)
+{
+	if (echo)
+	{
+		soak.results.echo_dropped++;
+	}
+	else
+	{
+		soak.results.event_dropped++;
+	}
+	sim_faults_on_loss(SIM_CHANNEL_MESSAGES, 1U);
+}
+
+/**
+ * @brief CDC transmit queue send: the only queue app_comm writes to.
+ */
+BaseType_t __wrap_xQueueGenericSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait, BaseType_t xCopyPosition)
+{
+	(void)xTicksToWait;
+	(void)xCopyPosition;
+	BaseType_t result = pdFALSE;
+
+	if (((QueueHandle_t)&cdc_queue_tag == xQueue) && (soak.cdc_count < CDC_TRANSMIT_QUEUE_SIZE))
+	{
+		const uint32_t tail = (soak.cdc_head + soak.cdc_count) % CDC_TRANSMIT_QUEUE_SIZE;
+		(void)memcpy(&soak.cdc_queue[tail], pvItemToQueue, sizeof(cdc_packet_t)); // flawfinder: ignore
+		soak.cdc_count++;
+		wake_task(SOAK_CDC_WRITE);
+		result = pdTRUE;
+	}
+	else
+	{
+		message_dropped(soak.sending_echo);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Kernel tick count, read from the virtual clock.
+ */
+TickType_t __wrap_xTaskGetTickCount(void)
+{
+	return (TickType_t)sim_clock_ticks();
+}
+
+/**
+ * @brief GPIO input levels: the TM1637 leaves DIO high (no ACK) during a NACK storm.
+ */
+static bool gpio_level(uint32_t gpio)
+{
+	return (SOAK_TM1637_DIO_PIN == gpio) && sim_faults_active(SIM_FAULT_TM1637_NACK);
+}
+
+/**
+ * @brief Bus select callback of the simulated display; it has the bus to itself.
+ */
+static output_result_t display_select(uint8_t chip_id, bool select)
+{
+	(void)chip_id;
+	(void)select;
+	return OUTPUT_OK;
+}
+
+static void put_payload(uint8_t payload[SOAK_PAYLOAD_SIZE], uint32_t sequence, uint64_t created_us)
+{
+	for (uint8_t i = 0U; i < 4U; i++)
+	{
+		payload[i] = (uint8_t)(sequence >> (8U * i));
+	}
+	for (uint8_t i = 0U; i < 8U; i++)
+	{
+		payload[4U + i] = (uint8_t)(created_us >> (8U * i));
+	}
+}
+
+static uint64_t get_created_us(const uint8_t payload[SOAK_PAYLOAD_SIZE])
+{
+	uint64_t created_us = 0U;
+
+	for (uint8_t i = 0U; i < 8U; i++)
+	{
+		created_us |= (uint64_t)payload[4U + i] << (8U * i);
+	}
+
+	return created_us;
+}
+
+static void record_latency(soak_latency_t *latency, uint64_t sample_us)
+{
+	uint64_t bucket = sample_us / SOAK_LATENCY_BUCKET_US;
+
+	if (bucket >= SOAK_LATENCY_BUCKETS)
+	{
+		bucket = SOAK_LATENCY_BUCKETS - 1U;
+	}
+	latency->buckets[bucket]++;
+	latency->count++;
+	latency->sum_us += sample_us;
+	if (sample_us > latency->max_us)
+	{
+		latency->max_us = sample_us;
+	}
+}
+
+/**
+ * @brief Upper bound of the bucket holding a percentile.
+ *
+ * @param[in] latency    Distribution.
+ * @param[in] per_mille  Percentile in tenths of a percent.
+ *
+ * @return Latency bound (µs); 0 without samples.
+ */
+static uint64_t latency_percentile_us(const soak_latency_t *latency, uint32_t per_mille)
+{
+	const uint64_t target = ((latency->count * per_mille) + 999U) / 1000U;
+	uint64_t seen = 0U;
+	uint64_t result = 0U;
+
+	for (uint32_t i = 0U; (i < SOAK_LATENCY_BUCKETS) && (latency->count > 0U); i++)
+	{
+		seen += latency->buckets[i];
+		if (seen >= target)
+		{
+			// The last bucket is open-ended: only the maximum bounds it
+			result = ((SOAK_LATENCY_BUCKETS - 1U) == i) ? latency->max_us : ((uint64_t)(i + 1U) * SOAK_LATENCY_BUCKET_US);
+			break;
+		}
+	}
+
+	return (result > latency->max_us) ? latency->max_us : result;
+}
+
+/**
+ * @brief Host side: one complete frame received from the device.
+ */
+static void host_frame(const encoded_frame_t *frame)
+{
+	uint8_t message[MESSAGE_SIZE + 2U];
+	const size_t length = cobs_decode(frame->data, frame->length, message);
+
+	if ((length == (HEADER_SIZE + SOAK_PAYLOAD_SIZE + CHECKSUM_SIZE)) && (SOAK_PAYLOAD_SIZE == message[2]))
+	{
+		const uint8_t command = message[1] & 0x1FU;
+		const uint64_t created_us = get_created_us(&message[HEADER_SIZE]);
+		const uint64_t latency_us = sim_clock_now_us() - created_us;
+
+		sim_faults_on_delivery(SIM_CHANNEL_MESSAGES, created_us, sim_clock_now_us());
+
+		if ((uint8_t)PC_ECHO_CMD == command)
+		{
+			soak.results.echo_delivered++;
+			record_latency(&soak.results.echo_latency, latency_us);
+		}
+		else if ((uint8_t)PC_KEY_CMD == command)
+		{
+			soak.results.event_delivered++;
+			record_latency(&soak.results.event_latency, latency_us);
+		}
+		else
+		{
+			// Not scenario traffic
+		}
+	}
+}
+
+/**
+ * @brief Host side: IN data delivered in one USB frame.
+ */
+static void host_rx(void *context, const uint8_t *data, uint32_t length)
+{
+	(void)context;
+	encoded_frame_t frame;
+
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		if (FRAMER_FRAME_READY == encoded_framer_push_byte(&soak.host_framer, data[i], &frame))
+		{
+			host_frame(&frame);
+		}
+	}
+}
+
+/**
+ * @brief Schedule a modelled task to run once its core is free.
+ */
+static void wake_task(soak_task_t task)
+{
+	if (!soak.task_pending[task])
+	{
+		const uint64_t now_us = sim_clock_now_us();
+		const uint64_t free_us = soak.core_free_us[task_core[task]];
+
+		soak.task_pending[task] = true;
+		(void)sim_clock_schedule((free_us > now_us) ? free_us : now_us, task_run, NULL, (uint32_t)task);
+	}
+}
+
+/**
+ * @brief Mark a core busy for a step that starts now or once the core is free.
+ */
+static void core_use(uint8_t core, uint32_t cost_us)
+{
+	const uint64_t now_us = sim_clock_now_us();
+	const uint64_t start_us = (soak.core_free_us[core] > now_us) ? soak.core_free_us[core] : now_us;
+
+	soak.core_free_us[core] = start_us + cost_us;
+	soak.results.core_busy_us[core] += cost_us;
+}
+
+/**
+ * @brief uart_event_task: drain the RX FIFO through the frame assembler.
+ */
+static uint32_t run_uart_event(void)
+{
+	uint8_t receive_buffer[CDC_READ_CHUNK_SIZE];
+	encoded_frame_t frame;
+	uint32_t total = 0U;
+	uint32_t count = 0U;
+
+	do
+	{
+		count = sim_usb_read(&soak.usb, receive_buffer, sizeof(receive_buffer));
+		total += count;
+		statistics_add_to_counter(BYTES_RECEIVED, count);
+
+		for (uint32_t i = 0U; i < count; i++)
+		{
+			switch (encoded_framer_push_byte(&soak.device_framer, receive_buffer[i], &frame))
+			{
+			case FRAMER_FRAME_READY:
+				if (soak.encoded_count < ENCODED_QUEUE_SIZE)
+				{
+					soak.encoded_queue[(soak.encoded_head + soak.encoded_count) % ENCODED_QUEUE_SIZE] = frame;
+					soak.encoded_count++;
+					wake_task(SOAK_DECODE);
+				}
+				else
+				{
+					statistics_increment_counter(QUEUE_SEND_ERROR);
+					message_dropped(true);
+				}
+				break;
+			case FRAMER_EMPTY_FRAME:
+				statistics_increment_counter(COBS_DECODE_ERROR);
+				break;
+			case FRAMER_OVERFLOW:
+				statistics_increment_counter(RECEIVE_BUFFER_OVERFLOW_ERROR);
+				break;
+			case FRAMER_NEED_MORE_DATA:
+			default:
+				break;
+			}
+		}
+	} while (count > 0U);
+
+	return total / SOAK_UART_EVENT_BYTES_PER_US;
+}
+
+/**
+ * @brief decode_reception_task: decode one frame and hand it to app_comm.
+ */
+static void run_decode(void)
+{
+	uint8_t decode_buffer[MAX_ENCODED_BUFFER_SIZE];
+	const encoded_frame_t *frame = &soak.encoded_queue[soak.encoded_head];
+
+	soak.encoded_head = (soak.encoded_head + 1U) % ENCODED_QUEUE_SIZE;
+	soak.encoded_count--;
+
+	const size_t num_decoded = cobs_decode(frame->data, frame->length, decode_buffer);
+	if (num_decoded > 0U)
+	{
+		soak.sending_echo = true;
+		app_comm_process_inbound(decode_buffer, num_decoded);
+	}
+	else
+	{
+		statistics_increment_counter(COBS_DECODE_ERROR);
+	}
+
+	if (soak.encoded_count > 0U)
+	{
+		wake_task(SOAK_DECODE);
+	}
+}
+
+/**
+ * @brief process_outbound_task: send one input event to the host.
+ */
+static void run_outbound(void)
+{
+	uint8_t payload[SOAK_PAYLOAD_SIZE];
+	const soak_event_t *event = &soak.event_queue[soak.event_head];
+
+	soak.event_head = (soak.event_head + 1U) % DATA_EVENT_QUEUE_SIZE;
+	soak.event_count--;
+
+	put_payload(payload, event->sequence, event->created_us);
+	soak.sending_echo = false;
+	app_comm_send_packet(BOARD_ID, PC_KEY_CMD, payload, SOAK_PAYLOAD_SIZE);
+
+	if (soak.event_count > 0U)
+	{
+		wake_task(SOAK_OUTBOUND);
+	}
+}
+
+/**
+ * @brief Copy queued packets into the TX FIFO until it is full.
+ *
+ * @return Packets copied completely.
+ */
+static uint32_t cdc_fill(bool drain)
+{
+	uint32_t packets = 0U;
+
+	while (soak.cdc_count > 0U)
+	{
+		const cdc_packet_t *packet = &soak.cdc_queue[soak.cdc_head];
+		soak.cdc_written += sim_usb_write(&soak.usb, &packet->data[soak.cdc_written], packet->length - soak.cdc_written);
+		if (soak.cdc_written < packet->length)
+		{
+			soak.cdc_partial = true;
+			break;
+		}
+
+		statistics_add_to_counter(BYTES_SENT, packet->length);
+		soak.cdc_partial = false;
+		soak.cdc_written = 0U;
+		soak.cdc_head = (soak.cdc_head + 1U) % CDC_TRANSMIT_QUEUE_SIZE;
+		soak.cdc_count--;
+		packets++;
+
+		if (!drain)
+		{
+			break;
+		}
+	}
+
+	return packets;
+}
+
+/**
+ * @brief Flush point reached: batch what queued meanwhile and commit the FIFO.
+ */
+static void cdc_flush(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+
+	const uint32_t packets = cdc_fill(true);
+	core_use(task_core[SOAK_CDC_WRITE], packets * SOAK_CDC_WRITE_COST_US);
+	sim_usb_flush(&soak.usb);
+	usb_sof_on_flush((uint32_t)sim_clock_now_us());
+	soak.results.flushes++;
+	soak.flush_armed = false;
+
+	if (soak.cdc_count > 0U)
+	{
+		wake_task(SOAK_CDC_WRITE);
+	}
+}
+
+/**
+ * @brief cdc_write_task: write one packet, then wait for the flush point.
+ */
+static void run_cdc_write(void)
+{
+	if ((!soak.flush_armed) && (soak.cdc_count > 0U))
+	{
+		(void)cdc_fill(false);
+		if (soak.cdc_partial)
+		{
+			// TX FIFO full: the task yields until the next frame empties it
+		}
+		else
+		{
+			const uint32_t delay_us = usb_sof_flush_delay_us((uint32_t)sim_clock_now_us());
+			soak.flush_armed = true;
+			(void)sim_clock_schedule(sim_clock_now_us() + delay_us, cdc_flush, NULL, 0U);
+		}
+	}
+}
+
+/**
+ * @brief display_refresh_task: write the display once through the TM1637 driver.
+ */
+static void run_display(void)
+{
+	const uint8_t digits[TM1637_DIGIT_COUNT] = {
+		(uint8_t)((soak.display_due_us / 1000U) % 10U),
+		(uint8_t)((soak.display_due_us / 10000U) % 10U),
+		(uint8_t)((soak.display_due_us / 100000U) % 10U),
+		(uint8_t)((soak.display_due_us / 1000000U) % 10U),
+	};
+
+	if (OUTPUT_OK == tm1637_set_digits(soak.display, digits, sizeof(digits), TM1637_NO_DECIMAL_POINT))
+	{
+		soak.results.display_updates++;
+		sim_faults_on_delivery(SIM_CHANNEL_DISPLAY, soak.display_due_us, sim_clock_now_us());
+	}
+	else
+	{
+		soak.results.display_failed++;
+		sim_faults_on_loss(SIM_CHANNEL_DISPLAY, 1U);
+	}
+}
+
+static void task_run(void *context, uint32_t task)
+{
+	(void)context;
+	uint32_t extra_us = 0U;
+
+	soak.task_pending[task] = false;
+
+	switch ((soak_task_t)task)
+	{
+	case SOAK_UART_EVENT:
+		extra_us = run_uart_event();
+		break;
+	case SOAK_DECODE:
+		if (soak.encoded_count > 0U)
+		{
+			run_decode();
+		}
+		break;
+	case SOAK_OUTBOUND:
+		if (soak.event_count > 0U)
+		{
+			run_outbound();
+		}
+		break;
+	case SOAK_CDC_WRITE:
+		run_cdc_write();
+		break;
+	case SOAK_DISPLAY:
+		if (NULL != soak.display)
+		{
+			run_display();
+		}
+		break;
+	case SOAK_TASK_COUNT:
+	default:
+		break;
+	}
+
+	core_use(task_core[task], task_cost_us[task] + extra_us);
+}
+
+/**
+ * @brief USB start-of-frame: SOF callback, then the frame's bulk transfers.
+ */
+static void usb_frame(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+
+	soak.usb.stalled = sim_faults_active(SIM_FAULT_USB_STALL);
+	if (!soak.usb.stalled)
+	{
+		usb_sof_on_frame((uint32_t)sim_clock_now_us()); // no SOF callbacks while the host is gone
+	}
+	if (sim_usb_frame(&soak.usb, host_rx, NULL))
+	{
+		wake_task(SOAK_UART_EVENT); // tud_cdc_rx_cb
+	}
+	if (soak.cdc_partial)
+	{
+		wake_task(SOAK_CDC_WRITE);
+	}
+
+	(void)sim_clock_schedule(sim_clock_now_us() + USB_SOF_PERIOD_US, usb_frame, NULL, 0U);
+}
+
+/**
+ * @brief Host application: write one echo request.
+ */
+static void host_send(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+	uint8_t message[MESSAGE_SIZE];
+	uint8_t encoded[MAX_ENCODED_BUFFER_SIZE];
+	const uint16_t panel_id = (uint16_t)(BOARD_ID << 5U);
+	uint8_t checksum = 0U;
+
+	if (soak.traffic_on)
+	{
+		message[0] = (uint8_t)(panel_id >> 8U);
+		message[1] = (uint8_t)((panel_id & 0xE0U) | ((uint8_t)PC_ECHO_CMD & 0x1FU));
+		message[2] = SOAK_PAYLOAD_SIZE;
+		put_payload(&message[HEADER_SIZE], soak.echo_sequence, sim_clock_now_us());
+		for (uint8_t i = 0U; i < (HEADER_SIZE + SOAK_PAYLOAD_SIZE); i++)
+		{
+			checksum ^= message[i];
+		}
+		message[HEADER_SIZE + SOAK_PAYLOAD_SIZE] = checksum;
+
+		const bool corrupt = sim_faults_active(SIM_FAULT_CORRUPT_BURST);
+		if (corrupt)
+		{
+			// One flipped bit in the payload: the frame still decodes but fails its checksum
+			message[HEADER_SIZE + (sim_clock_random() % SOAK_PAYLOAD_SIZE)] ^= (uint8_t)(1U << (sim_clock_random() % 8U));
+		}
+
+		size_t length = cobs_encode(message, HEADER_SIZE + SOAK_PAYLOAD_SIZE + CHECKSUM_SIZE, encoded);
+		encoded[length] = PACKET_MARKER;
+		length++;
+
+		soak.echo_sequence++;
+		if (sim_usb_host_write(&soak.usb, encoded, (uint32_t)length) == length)
+		{
+			soak.results.echo_sent++;
+			if (corrupt)
+			{
+				soak.results.echo_corrupted++;
+				sim_faults_on_loss(SIM_CHANNEL_MESSAGES, 1U);
+			}
+		}
+		else
+		{
+			// Host buffer full: the request is never written, so it is not in flight
+			soak.results.echo_host_stalled++;
+			sim_faults_on_loss(SIM_CHANNEL_MESSAGES, 1U);
+		}
+
+		(void)sim_clock_schedule(sim_clock_now_us() + sim_clock_random_interval_us(1000000U / soak.config.host_rate_hz),
+		                         host_send, NULL, 0U);
+	}
+}
+
+/**
+ * @brief Device input: one key event into the data event queue.
+ */
+static void input_event(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+
+	if (soak.traffic_on)
+	{
+		soak.results.event_sent++;
+		if (soak.event_count < DATA_EVENT_QUEUE_SIZE)
+		{
+			soak_event_t *event = &soak.event_queue[(soak.event_head + soak.event_count) % DATA_EVENT_QUEUE_SIZE];
+			event->sequence = soak.event_sequence;
+			event->created_us = sim_clock_now_us();
+			soak.event_count++;
+			wake_task(SOAK_OUTBOUND);
+		}
+		else
+		{
+			statistics_increment_counter(QUEUE_SEND_ERROR);
+			message_dropped(false);
+		}
+		soak.event_sequence++;
+
+		(void)sim_clock_schedule(sim_clock_now_us() + sim_clock_random_interval_us(1000000U / soak.config.event_rate_hz),
+		                         input_event, NULL, 0U);
+	}
+}
+
+/**
+ * @brief display_refresh_task period: refresh the display.
+ */
+static void display_tick(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+
+	if (soak.traffic_on)
+	{
+		soak.display_due_us = sim_clock_now_us();
+		wake_task(SOAK_DISPLAY);
+		(void)sim_clock_schedule(sim_clock_now_us() + (1000000U / soak.config.display_rate_hz), display_tick, NULL, 0U);
+	}
+}
+
+/**
+ * @brief A fault starts or ends.
+ */
+static void fault_change(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+	const uint64_t now_us = sim_clock_now_us();
+	const uint32_t started = sim_faults_update(now_us);
+
+	if (0U != (started & (1UL << (uint32_t)SIM_FAULT_QUEUE_FULL)))
+	{
+		// A runaway higher-priority task holds core 1 for the whole fault
+		core_use(task_core[SOAK_DECODE], (uint32_t)sim_faults_remaining_us(SIM_FAULT_QUEUE_FULL, now_us));
+	}
+
+	const uint64_t next_us = sim_faults_next_change(now_us);
+	if (UINT64_MAX != next_us)
+	{
+		(void)sim_clock_schedule(next_us, fault_change, NULL, 0U);
+	}
+}
+
+/**
+ * @brief Stop generating traffic; in-flight messages keep moving.
+ */
+static void traffic_stop(void *context, uint32_t arg)
+{
+	(void)context;
+	(void)arg;
+	soak.traffic_on = false;
+}
+
+/**
+ * @brief Run one scenario from a clean state.
+ */
+static void soak_run(const soak_config_t *config)
+{
+	const uint64_t traffic_us = config->seconds * 1000000ULL;
+
+	(void)memset(&soak, 0, sizeof(soak));
+	soak.config = *config;
+	soak.traffic_on = true;
+	sim_clock_reset(config->seed);
+	sim_usb_init(&soak.usb, config->frame_bytes);
+	encoded_framer_reset(&soak.device_framer);
+	encoded_framer_reset(&soak.host_framer);
+	statistics_reset_all_counters();
+	usb_sof_reset();
+	mock_time_set_source(sim_clock_now_us);
+	mock_gpio_set_get_hook(gpio_level);
+	app_context_set_cdc_transmit_queue((QueueHandle_t)&cdc_queue_tag);
+	app_context_set_line_state(true, true);
+	sim_faults_restart(config->on_time_us);
+	if (config->display_rate_hz > 0U)
+	{
+		soak.display = tm1637_init(0U, display_select, spi0, SOAK_TM1637_DIO_PIN, SOAK_TM1637_CLK_PIN);
+	}
+
+	(void)sim_clock_schedule(USB_SOF_PERIOD_US, usb_frame, NULL, 0U);
+	if (config->host_rate_hz > 0U)
+	{
+		(void)sim_clock_schedule(sim_clock_random_interval_us(1000000U / config->host_rate_hz), host_send, NULL, 0U);
+	}
+	if (config->event_rate_hz > 0U)
+	{
+		(void)sim_clock_schedule(sim_clock_random_interval_us(1000000U / config->event_rate_hz), input_event, NULL, 0U);
+	}
+	if (NULL != soak.display)
+	{
+		(void)sim_clock_schedule(0U, display_tick, NULL, 0U);
+	}
+	(void)sim_clock_schedule(0U, fault_change, NULL, 0U);
+	(void)sim_clock_schedule(traffic_us, traffic_stop, NULL, 0U);
+
+	while (sim_clock_run_next(traffic_us + SOAK_DRAIN_US))
+	{
+	}
+
+	soak.results.out_nak_frames = soak.usb.out_nak_frames;
+	soak.results.stalled_frames = soak.usb.stalled_frames;
+	for (uint32_t i = 0U; i < (uint32_t)SIM_FAULT_TYPE_COUNT; i++)
+	{
+		soak.results.faults[i] = *sim_faults_metrics((sim_fault_type_t)i);
+	}
+	if (NULL != soak.display)
+	{
+		vPortFree(soak.display);
+		soak.display = NULL;
+	}
+	mock_gpio_set_get_hook(NULL);
+	for (uint32_t i = 0U; i < (uint32_t)NUM_STATISTICS_COUNTERS; i++)
+	{
+		soak.results.counters[i] = statistics_get_counter((statistics_counter_enum_t)i);
+	}
+	mock_time_set_source(NULL);
+}
+
+static void print_latency(const char *name, const soak_latency_t *latency)
+{
+	const uint64_t mean_us = (latency->count > 0U) ? (latency->sum_us / latency->count) : 0U;
+
+	printf("%-6s latency (us): mean %" PRIu64 "  p50 <=%" PRIu64 "  p99 <=%" PRIu64 "  p99.9 <=%" PRIu64 "  max %" PRIu64 "\n",
+	       name,
+	       mean_us,
+	       latency_percentile_us(latency, 500U),
+	       latency_percentile_us(latency, 990U),
+	       latency_percentile_us(latency, 999U),
+	       latency->max_us);
+}
+
+static void print_faults(const soak_results_t *results)
+{
+	for (uint32_t i = 0U; i < (uint32_t)SIM_FAULT_TYPE_COUNT; i++)
+	{
+		const sim_fault_metrics_t *fault = &results->faults[i];
+
+		if (fault->injected > 0U)
+		{
+			const uint64_t mean_us = (fault->recovered > 0U) ? (fault->recover_sum_us / fault->recovered) : 0U;
+
+			printf("fault %-12s injected %" PRIu32 "  recovered %" PRIu32 "  recover mean %" PRIu64 " us  max %" PRIu64
+			       " us  lost %" PRIu64 "\n",
+			       sim_faults_name((sim_fault_type_t)i), fault->injected, fault->recovered, mean_us, fault->recover_max_us,
+			       fault->lost);
+		}
+	}
+}
+
+/**
+ * @brief Every injected fault was followed by an on-time delivery.
+ */
+static bool faults_recovered(const soak_results_t *results)
+{
+	bool result = true;
+
+	for (uint32_t i = 0U; i < (uint32_t)SIM_FAULT_TYPE_COUNT; i++)
+	{
+		result = result && (results->faults[i].recovered == results->faults[i].injected);
+	}
+
+	return result;
+}
+
+static void print_results(const soak_config_t *config, const soak_results_t *results)
+{
+	const uint64_t run_us = (config->seconds * 1000000ULL) + SOAK_DRAIN_US;
+
+	printf("soak: %" PRIu64 " s simulated, seed %" PRIu64 ", %" PRIu32 " echo/s, %" PRIu32 " events/s, %" PRIu32 " B/frame\n",
+	       config->seconds, config->seed, config->host_rate_hz, config->event_rate_hz, config->frame_bytes);
+	printf("echo:  sent %" PRIu64 "  delivered %" PRIu64 "  dropped %" PRIu64 "  host stalled %" PRIu64 "\n",
+	       results->echo_sent, results->echo_delivered, results->echo_dropped, results->echo_host_stalled);
+	printf("event: sent %" PRIu64 "  delivered %" PRIu64 "  dropped %" PRIu64 "\n",
+	       results->event_sent, results->event_delivered, results->event_dropped);
+	print_latency("echo", &results->echo_latency);
+	print_latency("event", &results->event_latency);
+	printf("usb:   %" PRIu64 " flushes, %" PRIu64 " OUT NAK frames, %" PRIu64 " stalled frames\n",
+	       results->flushes, results->out_nak_frames, results->stalled_frames);
+	if (config->display_rate_hz > 0U)
+	{
+		printf("display: %" PRIu64 " updates, %" PRIu64 " not acknowledged\n", results->display_updates, results->display_failed);
+	}
+	printf("cpu:   core 0 %" PRIu64 ".%02" PRIu64 " %%, core 1 %" PRIu64 ".%02" PRIu64 " %%\n",
+	       (results->core_busy_us[0] * 100U) / run_us, ((results->core_busy_us[0] * 10000U) / run_us) % 100U,
+	       (results->core_busy_us[1] * 100U) / run_us, ((results->core_busy_us[1] * 10000U) / run_us) % 100U);
+	printf("counters: queue send %" PRIu32 ", cdc queue send %" PRIu32 ", cobs %" PRIu32 ", checksum %" PRIu32 ", malformed %" PRIu32 "\n",
+	       results->counters[QUEUE_SEND_ERROR], results->counters[CDC_QUEUE_SEND_ERROR],
+	       results->counters[COBS_DECODE_ERROR], results->counters[CHECKSUM_ERROR], results->counters[MSG_MALFORMED_ERROR]);
+	if (results->echo_corrupted > 0U)
+	{
+		printf("corrupt: %" PRIu64 " echo requests corrupted\n", results->echo_corrupted);
+	}
+	print_faults(results);
+}
+
+/**
+ * @brief Every message sent is either delivered or counted as dropped.
+ */
+static bool results_balanced(const soak_results_t *results)
+{
+	return ((results->echo_delivered + results->echo_dropped + results->echo_corrupted) == results->echo_sent) &&
+	       ((results->event_delivered + results->event_dropped) == results->event_sent);
+}
+
+static bool parse_u64(const char *text, uint64_t *value)
+{
+	char *end = NULL;
+	const unsigned long long parsed = strtoull(text, &end, 0);
+	const bool result = (NULL != end) && ('\0' == *end) && (end != text);
+
+	if (result)
+	{
+		*value = (uint64_t)parsed;
+	}
+
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	soak_config_t config = {
+		.seconds = SOAK_DEFAULT_SECONDS,
+		.seed = 1U,
+		.host_rate_hz = SOAK_DEFAULT_HOST_RATE_HZ,
+		.event_rate_hz = SOAK_DEFAULT_EVENT_RATE_HZ,
+		.frame_bytes = SIM_USB_DEFAULT_BYTES_PER_FRAME,
+		.display_rate_hz = SOAK_DEFAULT_DISPLAY_RATE_HZ,
+		.on_time_us = SOAK_DEFAULT_ON_TIME_US,
+	};
+	bool check = false;
+	bool valid = true;
+	int status = 0;
+
+	sim_faults_reset();
+	for (int i = 1; (i < argc) && valid; i++)
+	{
+		uint64_t value = 0U;
+
+		if (0 == strcmp(argv[i], "--check"))
+		{
+			check = true;
+		}
+		else if ((0 == strcmp(argv[i], "--fault")) && ((i + 1) < argc))
+		{
+			valid = sim_faults_parse(argv[i + 1]);
+			i++;
+		}
+		else if (((i + 1) < argc) && parse_u64(argv[i + 1], &value))
+		{
+			if (0 == strcmp(argv[i], "--seconds"))
+			{
+				config.seconds = value;
+			}
+			else if (0 == strcmp(argv[i], "--seed"))
+			{
+				config.seed = value;
+			}
+			else if ((0 == strcmp(argv[i], "--host-rate")) && (value <= 1000000U))
+			{
+				config.host_rate_hz = (uint32_t)value;
+			}
+			else if ((0 == strcmp(argv[i], "--event-rate")) && (value <= 1000000U))
+			{
+				config.event_rate_hz = (uint32_t)value;
+			}
+			else if ((0 == strcmp(argv[i], "--frame-bytes")) && (value >= SIM_USB_BULK_PACKET) && (value <= 0xFFFFU))
+			{
+				config.frame_bytes = (uint32_t)value;
+			}
+			else if ((0 == strcmp(argv[i], "--display-rate")) && (value <= 10000U))
+			{
+				config.display_rate_hz = (uint32_t)value;
+			}
+			else if (0 == strcmp(argv[i], "--on-time-us"))
+			{
+				config.on_time_us = value;
+			}
+			else
+			{
+				valid = false;
+			}
+			i++;
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+
+	if (!valid)
+	{
+		fprintf(stderr,
+		        "usage: %s [--seconds N] [--seed N] [--host-rate HZ] [--event-rate HZ] [--frame-bytes N]\n"
+		        "       [--display-rate HZ] [--on-time-us N] [--fault type@start_ms+duration_ms]... [--check]\n"
+		        "fault types: usb-stall, corrupt, tm1637-nack, queue-full\n",
+		        argv[0]);
+		status = 2;
+	}
+	else
+	{
+		soak_run(&config);
+		print_results(&config, &soak.results);
+
+		if (!results_balanced(&soak.results))
+		{
+			printf("FAIL: messages lost without being counted\n");
+			status = 1;
+		}
+		if (!faults_recovered(&soak.results))
+		{
+			printf("FAIL: a fault never recovered\n");
+			status = 1;
+		}
+
+		if (check)
+		{
+			(void)memcpy(&first_results, &soak.results, sizeof(first_results)); // flawfinder: ignore
+			soak_run(&config);
+			if (0 != memcmp(&first_results, &soak.results, sizeof(first_results)))
+			{
+				printf("FAIL: second run with the same seed differs\n");
+				status = 1;
+			}
+			else
+			{
+				printf("deterministic: second run identical\n");
+			}
+		}
+	}
+
+	return status;
+}
@@ -7,7 +7,10 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <string.h>
+#include "hardware/flash.h"
 #include "hardware/pwm.h"
+#include "pico/flash.h"
 
 // Pico SDK mock types and functions
 typedef struct {
@@ -27,16 +30,28 @@ void mock_watchdog_set_reboot_flag(bool flag)
 // GPIO functions
 void gpio_init(uint32_t gpio) { (void)gpio; }
 void gpio_set_dir(uint32_t gpio, bool out) { (void)gpio; (void)out; }
-void gpio_put(uint32_t gpio, bool value) { (void)gpio; (void)value; }
-bool gpio_get(uint32_t gpio) { (void)gpio; return false; }
+static void (*mock_gpio_put_hook)(uint32_t gpio, bool value) = NULL;
+void gpio_put(uint32_t gpio, bool value) { if (mock_gpio_put_hook != NULL) { mock_gpio_put_hook(gpio, value); } }
+// Let a test observe output levels, e.g. multiplexer selects (NULL ignores them again)
+void mock_gpio_set_put_hook(void (*hook)(uint32_t gpio, bool value)) { mock_gpio_put_hook = hook; }
+static bool (*mock_gpio_get_hook)(uint32_t gpio) = NULL;
+bool gpio_get(uint32_t gpio) { return (mock_gpio_get_hook != NULL) ? mock_gpio_get_hook(gpio) : false; }
+// Let a test drive input levels, e.g. to withhold TM1637 ACKs (NULL restores all-low)
+void mock_gpio_set_get_hook(bool (*hook)(uint32_t gpio)) { mock_gpio_get_hook = hook; }
 void gpio_init_mask(uint32_t gpio_mask) { (void)gpio_mask; }
 void gpio_set_dir_masked(uint32_t gpio_mask, uint32_t value) { (void)gpio_mask; (void)value; }
 void gpio_put_masked(uint32_t gpio_mask, uint32_t value) { (void)gpio_mask; (void)value; }
 void gpio_deinit(uint32_t gpio) { (void)gpio; }
+void gpio_set_irq_enabled(uint32_t gpio, uint32_t event_mask, bool enabled) { (void)gpio; (void)event_mask; (void)enabled; }
+void gpio_set_irq_enabled_with_callback(uint32_t gpio, uint32_t event_mask, bool enabled, void (*callback)(uint32_t, uint32_t))
+{
+    (void)gpio; (void)event_mask; (void)enabled; (void)callback;
+}
 
 // Time functions
 static uint32_t mock_time_current = 0;
 static uint32_t mock_time_step = 0;
+static uint64_t (*mock_time_source)(void) = NULL;
 
 void mock_time_config(uint32_t initial_value, uint32_t step)
 {
@@ -44,10 +59,33 @@ void mock_time_config(uint32_t initial_value, uint32_t step)
     mock_time_step = step;
 }
 
+// Read time from a virtual clock instead (NULL restores the stepped counter)
+void mock_time_set_source(uint64_t (*source)(void))
+{
+    mock_time_source = source;
+}
+
 void busy_wait_ms(uint32_t ms) { (void)ms; }
-void busy_wait_us_32(uint32_t delay_us) { (void)delay_us; }
+static void (*mock_busy_wait_hook)(uint32_t delay_us) = NULL;
+void busy_wait_us_32(uint32_t delay_us) { if (mock_busy_wait_hook != NULL) { mock_busy_wait_hook(delay_us); } }
+// Let a test advance its clock by the time spent busy-waiting (NULL returns at once again)
+void mock_busy_wait_set_hook(void (*hook)(uint32_t delay_us)) { mock_busy_wait_hook = hook; }
+int32_t add_alarm_in_us(uint64_t us, int64_t (*callback)(int32_t, void *), void *user_data, bool fire_if_past)
+{
+    (void)us; (void)callback; (void)user_data; (void)fire_if_past;
+    return 1;
+}
+bool cancel_alarm(int32_t alarm_id)
+{
+    (void)alarm_id;
+    return true;
+}
 uint32_t time_us_32(void)
 {
+    if (mock_time_source != NULL)
+    {
+        return (uint32_t)mock_time_source();
+    }
     uint32_t now = mock_time_current;
     mock_time_current += mock_time_step;
     return now;
@@ -64,12 +102,16 @@ bool watchdog_caused_reboot(void)
 // Interrupt functions
 uint32_t save_and_disable_interrupts(void) { return 0; }
 void restore_interrupts(uint32_t status) { (void)status; }
+uint get_core_num(void) { return 0U; }
 
 // ADC functions  
 void adc_init(void) {}
 void adc_gpio_init(uint32_t gpio) { (void)gpio; }
 void adc_select_input(uint32_t input) { (void)input; }
-uint16_t adc_read(void) { return 0; }
+static uint16_t (*mock_adc_read_hook)(void) = NULL;
+uint16_t adc_read(void) { return (mock_adc_read_hook != NULL) ? mock_adc_read_hook() : 0U; }
+// Let a test supply conversions, e.g. from a stimulus model (NULL restores 0)
+void mock_adc_set_read_hook(uint16_t (*hook)(void)) { mock_adc_read_hook = hook; }
 
 // PWM functions
 uint32_t pwm_gpio_to_slice_num(uint32_t gpio) { (void)gpio; return 0; }
@@ -90,14 +132,57 @@ typedef struct spi_inst {
 } spi_inst_t;
 static spi_inst_t mock_spi_inst = {0};
 spi_inst_t *spi0 = &mock_spi_inst;
+static spi_inst_t mock_spi1_inst = {0};
+spi_inst_t *spi1 = &mock_spi1_inst;
 
 uint32_t spi_init(spi_inst_t *spi, uint32_t baudrate) { (void)spi; return baudrate; }
+uint32_t spi_set_baudrate(spi_inst_t *spi, uint32_t baudrate) { (void)spi; return baudrate; }
 void spi_set_format(spi_inst_t *spi, uint32_t data_bits, uint32_t cpol, uint32_t cpha, uint32_t order) {
     (void)spi; (void)data_bits; (void)cpol; (void)cpha; (void)order;
 }
 void gpio_set_function(uint32_t gpio, uint32_t fn) { (void)gpio; (void)fn; }
 int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) { (void)spi; (void)src; return (int)len; }
 
+// Flash functions (RAM image so storage records can round-trip)
+uint8_t mock_flash_image[PICO_FLASH_SIZE_BYTES];
+static int mock_flash_safe_execute_result = PICO_OK;
+
+void mock_flash_set_safe_execute_result(int result)
+{
+    mock_flash_safe_execute_result = result;
+}
+
+void mock_flash_erase_all(void)
+{
+    memset(mock_flash_image, 0xFF, sizeof(mock_flash_image));
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    if ((flash_offs + count) <= sizeof(mock_flash_image)) {
+        memset(&mock_flash_image[flash_offs], 0xFF, count);
+    }
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    if ((flash_offs + count) <= sizeof(mock_flash_image)) {
+        // Programming can only clear bits, like the real NOR flash
+        for (size_t i = 0; i < count; i++) {
+            mock_flash_image[flash_offs + i] &= data[i];
+        }
+    }
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+    (void)enter_exit_timeout_ms;
+    if (mock_flash_safe_execute_result == PICO_OK) {
+        func(param);
+    }
+    return mock_flash_safe_execute_result;
+}
+
 // FreeRTOS real implementation now used - no more mocks needed
 size_t xPortGetMinimumEverFreeHeapSize(void)
 {
@@ -120,3 +205,7 @@ static uart_inst_t mock_uart_inst_uart0 = {0};
 uart_inst_t *uart0 = &mock_uart_inst_uart0;
 void uart_init(uart_inst_t *uart, uint32_t baudrate) { (void)uart; (void)baudrate; }
 void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled) { (void)uart; (void)enabled; }
+
+// Keypad scanner: PIO and DMA do not exist on the host, so no frames arrive
+void keypad_scan_set_timing(uint16_t col_settle_us, uint16_t row_settle_us) { (void)col_settle_us; (void)row_settle_us; }
+void keypad_scan_start(void (*callback)(const uint32_t *)) { (void)callback; }
@@ -0,0 +1,421 @@
+/**
+ * @file input_stimulus.c
+ * @brief Physically modelled input signals for host tests.
+ */
+
+#include "input_stimulus.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+// Hooks provided by hardware_mocks.c
+void mock_time_set_source(uint64_t (*source)(void));
+void mock_gpio_set_get_hook(bool (*hook)(uint32_t gpio));
+void mock_gpio_set_put_hook(void (*hook)(uint32_t gpio, bool value));
+void mock_adc_set_read_hook(uint16_t (*hook)(void));
+void mock_busy_wait_set_hook(void (*hook)(uint32_t delay_us));
+
+/** Quadrature levels after each edge, clockwise: B closes first. */
+static const uint8_t phase_clockwise[STIM_ENCODER_EDGES_PER_DETENT] = {0U, 2U, 3U, 1U};
+/** Quadrature levels after each edge, counter-clockwise. */
+static const uint8_t phase_counter_clockwise[STIM_ENCODER_EDGES_PER_DETENT] = {0U, 1U, 3U, 2U};
+
+/** GPIO of each direct input. */
+static const uint8_t direct_pins[DIRECT_INPUT_COUNT] = DIRECT_INPUT_PINS;
+
+/** Multiplexer attached to the mocks. */
+static stim_mux_t *bench_mux = NULL;
+/** Direct input contacts attached to the mocks. */
+static const stim_contact_t *bench_direct = NULL;
+/** Virtual clock of the bench (µs). */
+static uint64_t bench_now_us = 0U;
+/** Levels last driven on the ADC select pins, bit 0 = @ref ADC_MUX_A. */
+static uint8_t bench_select = 0U;
+
+/**
+ * @brief Stateless hash for bounce and jitter patterns (splitmix64 finaliser).
+ */
+static uint32_t stim_hash(uint32_t seed, uint64_t a, uint64_t b)
+{
+	uint64_t x = ((uint64_t)seed << 32U) ^ a ^ (b * 0x9E3779B97F4A7C15ULL);
+
+	x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+	x ^= x >> 31U;
+
+	return (uint32_t)x;
+}
+
+/**
+ * @brief Level of a contact inside or after the bounce of one transition.
+ *
+ * The bounce is cut into chatter slots. The first slot always reads the new
+ * level (the contacts just touched or parted); after that each slot reads it
+ * with a probability that rises linearly to 1 in the last slot.
+ */
+static bool transition_level(const stim_contact_t *contact, uint64_t transition_us, uint64_t now_us, bool new_level)
+{
+	const uint64_t elapsed_us = now_us - transition_us;
+	bool level = new_level;
+
+	if ((contact->bounce_us > 0U) && (elapsed_us < contact->bounce_us))
+	{
+		const uint32_t chatter_us = (0U == contact->chatter_us) ? 1U : contact->chatter_us;
+		const uint32_t slots = (contact->bounce_us + chatter_us - 1U) / chatter_us;
+		const uint32_t slot = (uint32_t)(elapsed_us / chatter_us);
+
+		if ((slot > 0U) && ((stim_hash(contact->seed, transition_us, slot) % slots) > slot))
+		{
+			level = !new_level;
+		}
+	}
+
+	return level;
+}
+
+bool stim_contact_closed(const stim_contact_t *contact, uint64_t now_us)
+{
+	bool closed = false;
+
+	if (now_us >= contact->press_us)
+	{
+		if (now_us < contact->release_us)
+		{
+			closed = transition_level(contact, contact->press_us, now_us, true);
+		}
+		else
+		{
+			closed = transition_level(contact, contact->release_us, now_us, false);
+		}
+	}
+
+	return closed;
+}
+
+/**
+ * @brief First slot boundary of one transition after a time.
+ */
+static uint64_t transition_boundary_after(const stim_contact_t *contact, uint64_t transition_us, uint64_t after_us)
+{
+	uint64_t boundary = UINT64_MAX;
+
+	if (UINT64_MAX == transition_us)
+	{
+		// Transition never happens
+	}
+	else if (after_us < transition_us)
+	{
+		boundary = transition_us;
+	}
+	else
+	{
+		const uint32_t chatter_us = (0U == contact->chatter_us) ? 1U : contact->chatter_us;
+		const uint64_t elapsed_us = after_us - transition_us;
+
+		if (elapsed_us < contact->bounce_us)
+		{
+			const uint64_t next_us = ((elapsed_us / chatter_us) + 1U) * chatter_us;
+			boundary = transition_us + ((next_us < contact->bounce_us) ? next_us : contact->bounce_us);
+		}
+	}
+
+	return boundary;
+}
+
+uint64_t stim_contact_next_edge(const stim_contact_t *contact, uint64_t after_us)
+{
+	const bool level = stim_contact_closed(contact, after_us);
+	uint64_t t_us = after_us;
+	uint64_t edge_us = UINT64_MAX;
+
+	while (UINT64_MAX == edge_us)
+	{
+		const uint64_t press_us = transition_boundary_after(contact, contact->press_us, t_us);
+		const uint64_t release_us = transition_boundary_after(contact, contact->release_us, t_us);
+
+		t_us = (press_us < release_us) ? press_us : release_us;
+		if (UINT64_MAX == t_us)
+		{
+			break;
+		}
+		if (stim_contact_closed(contact, t_us) != level)
+		{
+			edge_us = t_us;
+		}
+	}
+
+	return edge_us;
+}
+
+/**
+ * @brief Time between two quadrature edges (ns), 0 when the encoder does not turn.
+ */
+static uint64_t edge_interval_ns(const stim_encoder_t *encoder)
+{
+	const uint64_t speed = (uint64_t)((encoder->rpm < 0) ? -(int64_t)encoder->rpm : (int64_t)encoder->rpm);
+	const uint64_t edges_per_minute = speed * encoder->detents_per_rev * STIM_ENCODER_EDGES_PER_DETENT;
+
+	return (0U == edges_per_minute) ? 0U : (60000000000ULL / edges_per_minute);
+}
+
+/**
+ * @brief Time of edge @p k (k >= 1) after the start, jitter included (ns).
+ */
+static uint64_t edge_time_ns(const stim_encoder_t *encoder, uint64_t interval_ns, uint64_t k)
+{
+	const uint8_t jitter_pct = (encoder->jitter_pct > STIM_ENCODER_MAX_JITTER_PCT) ? STIM_ENCODER_MAX_JITTER_PCT : encoder->jitter_pct;
+	// Each edge moves by up to half the jitter either way, so neighbours never swap
+	const uint64_t spread_ns = (interval_ns * jitter_pct) / 200U;
+	int64_t jitter_ns = 0;
+
+	if (spread_ns > 0U)
+	{
+		jitter_ns = (int64_t)(stim_hash(encoder->seed, k, 0U) % ((2U * spread_ns) + 1U)) - (int64_t)spread_ns;
+	}
+
+	return (uint64_t)((int64_t)(k * interval_ns) + jitter_ns);
+}
+
+uint32_t stim_encoder_edges(const stim_encoder_t *encoder, uint64_t now_us)
+{
+	const uint64_t interval_ns = edge_interval_ns(encoder);
+	const uint64_t t_us = (now_us < encoder->stop_us) ? now_us : encoder->stop_us;
+	uint64_t edges = 0U;
+
+	if ((interval_ns > 0U) && (t_us > encoder->start_us))
+	{
+		const uint64_t elapsed_ns = (t_us - encoder->start_us) * 1000U;
+		const uint64_t k = elapsed_ns / interval_ns;
+
+		edges = k;
+		if ((k >= 1U) && (edge_time_ns(encoder, interval_ns, k) > elapsed_ns))
+		{
+			edges = k - 1U;
+		}
+		else if (edge_time_ns(encoder, interval_ns, k + 1U) <= elapsed_ns)
+		{
+			edges = k + 1U;
+		}
+	}
+
+	return (edges > UINT32_MAX) ? UINT32_MAX : (uint32_t)edges;
+}
+
+uint8_t stim_encoder_phase(const stim_encoder_t *encoder, uint64_t now_us)
+{
+	const uint32_t step = stim_encoder_edges(encoder, now_us) % STIM_ENCODER_EDGES_PER_DETENT;
+
+	return (encoder->rpm < 0) ? phase_counter_clockwise[step] : phase_clockwise[step];
+}
+
+int32_t stim_encoder_detents(const stim_encoder_t *encoder, uint64_t now_us)
+{
+	const int32_t detents = (int32_t)(stim_encoder_edges(encoder, now_us) / STIM_ENCODER_EDGES_PER_DETENT);
+
+	return (encoder->rpm < 0) ? -detents : detents;
+}
+
+void stim_matrix_frame(const stim_matrix_t *matrix, uint64_t now_us, uint32_t frame[KEYPAD_SCAN_FRAME_WORDS])
+{
+	uint64_t closed = 0U;
+
+	for (uint8_t position = 0U; position < KEYPAD_MATRIX_POSITIONS; position++)
+	{
+		if ((NULL != matrix->keys[position]) && stim_contact_closed(matrix->keys[position], now_us))
+		{
+			closed |= 1ULL << position;
+		}
+	}
+
+	for (uint8_t i = 0U; i < MAX_NUM_ENCODERS; i++)
+	{
+		if (NULL != matrix->encoders[i])
+		{
+			const uint8_t phase = stim_encoder_phase(matrix->encoders[i], now_us);
+			const uint8_t a_bit = keypad_matrix_position(matrix->encoder_map[i].row, matrix->encoder_map[i].col);
+
+			closed |= (uint64_t)(phase & 0x01U) << a_bit;
+			closed |= (uint64_t)((phase >> 1U) & 0x01U) << (a_bit + 1U);
+		}
+	}
+
+	// Row line is pulled up and reads low through a closed contact
+	frame[0] = (uint32_t)~closed;
+	frame[1] = (uint32_t)(~closed >> 32U);
+}
+
+void stim_mux_init(stim_mux_t *mux, uint32_t tau_ns, uint16_t noise_lsb, uint32_t seed)
+{
+	(void)memset(mux, 0, sizeof(*mux));
+	mux->tau_ns = tau_ns;
+	mux->noise_lsb = noise_lsb;
+	mux->random = (0U == seed) ? 1U : seed;
+}
+
+/**
+ * @brief Voltage of the output node (LSB).
+ */
+static double mux_node(const stim_mux_t *mux, uint64_t now_us)
+{
+	double node = (double)mux->target;
+
+	if ((mux->tau_ns > 0U) && (now_us >= mux->start_us))
+	{
+		const double elapsed_ns = (double)(now_us - mux->start_us) * 1000.0;
+		node += (mux->start_lsb - (double)mux->target) * exp(-elapsed_ns / (double)mux->tau_ns);
+	}
+
+	return node;
+}
+
+/**
+ * @brief Start settling from the present node voltage towards the selected channel.
+ */
+static void mux_resettle(stim_mux_t *mux, uint64_t now_us)
+{
+	mux->start_lsb = mux_node(mux, now_us);
+	mux->start_us = now_us;
+	mux->target = mux->level[mux->channel];
+}
+
+void stim_mux_select(stim_mux_t *mux, uint8_t channel, uint64_t now_us)
+{
+	mux->channel = (uint8_t)(channel % ADC_CHANNELS);
+	mux_resettle(mux, now_us);
+}
+
+/**
+ * @brief Standard normal sample (sum of twelve uniforms, xorshift32 source).
+ */
+static double mux_gaussian(stim_mux_t *mux)
+{
+	double sum = 0.0;
+
+	for (uint8_t i = 0U; i < 12U; i++)
+	{
+		mux->random ^= mux->random << 13U;
+		mux->random ^= mux->random >> 17U;
+		mux->random ^= mux->random << 5U;
+		sum += (double)mux->random / 4294967296.0;
+	}
+
+	return sum - 6.0;
+}
+
+uint16_t stim_mux_sample(stim_mux_t *mux, uint64_t now_us)
+{
+	if (mux->level[mux->channel] != mux->target)
+	{
+		// The source moved: settle from where the node is now
+		mux_resettle(mux, now_us);
+	}
+
+	double reading = mux_node(mux, now_us);
+	if (mux->noise_lsb > 0U)
+	{
+		reading += mux_gaussian(mux) * (double)mux->noise_lsb;
+	}
+	mux->conversions++;
+
+	reading = floor(reading + 0.5);
+	if (reading < 0.0)
+	{
+		reading = 0.0;
+	}
+	else if (reading > (double)STIM_ADC_FULL_SCALE)
+	{
+		reading = (double)STIM_ADC_FULL_SCALE;
+	}
+
+	return (uint16_t)reading;
+}
+
+static uint64_t bench_time(void)
+{
+	return bench_now_us;
+}
+
+static void bench_busy_wait(uint32_t delay_us)
+{
+	bench_now_us += delay_us;
+}
+
+static void bench_gpio_put(uint32_t gpio, bool value)
+{
+	static const uint8_t select_pins[4] = {ADC_MUX_A, ADC_MUX_B, ADC_MUX_C, ADC_MUX_D};
+
+	for (uint8_t bit = 0U; bit < 4U; bit++)
+	{
+		if (gpio == select_pins[bit])
+		{
+			const uint8_t select = value ? (uint8_t)(bench_select | (1U << bit)) : (uint8_t)(bench_select & ~(1U << bit));
+
+			if ((select != bench_select) && (NULL != bench_mux))
+			{
+				stim_mux_select(bench_mux, select, bench_now_us);
+			}
+			bench_select = select;
+		}
+	}
+}
+
+static bool bench_gpio_get(uint32_t gpio)
+{
+	bool level = false;
+
+	for (uint8_t i = 0U; (i < DIRECT_INPUT_COUNT) && (NULL != bench_direct); i++)
+	{
+		if (gpio == direct_pins[i])
+		{
+			// Pulled up, reads low through the closed contact
+			level = !stim_contact_closed(&bench_direct[i], bench_now_us);
+		}
+	}
+
+	return level;
+}
+
+static uint16_t bench_adc_read(void)
+{
+	const uint16_t reading = (NULL != bench_mux) ? stim_mux_sample(bench_mux, bench_now_us) : 0U;
+
+	bench_now_us += STIM_ADC_CONVERSION_US;
+
+	return reading;
+}
+
+void stim_bench_attach(stim_mux_t *mux, const stim_contact_t *direct, uint64_t now_us)
+{
+	bench_mux = mux;
+	bench_direct = direct;
+	bench_now_us = now_us;
+	bench_select = (NULL != mux) ? mux->channel : 0U;
+
+	mock_time_set_source(bench_time);
+	mock_busy_wait_set_hook(bench_busy_wait);
+	mock_gpio_set_put_hook(bench_gpio_put);
+	mock_gpio_set_get_hook(bench_gpio_get);
+	mock_adc_set_read_hook(bench_adc_read);
+}
+
+void stim_bench_detach(void)
+{
+	mock_time_set_source(NULL);
+	mock_busy_wait_set_hook(NULL);
+	mock_gpio_set_put_hook(NULL);
+	mock_gpio_set_get_hook(NULL);
+	mock_adc_set_read_hook(NULL);
+	bench_mux = NULL;
+	bench_direct = NULL;
+}
+
+uint64_t stim_bench_now_us(void)
+{
+	return bench_now_us;
+}
+
+void stim_bench_advance_us(uint64_t delta_us)
+{
+	bench_now_us += delta_us;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file input_stimulus.h
+ * @brief Physically modelled input signals for host tests.
+ *
+ * Three models, each deterministic for a given seed:
+ * - a contact that bounces for a while after every press and release, the
+ *   chance of reading the new level rising as it settles;
+ * - a quadrature encoder turned at a given speed, with every edge displaced
+ *   by random timing jitter;
+ * - an analogue multiplexer whose output node settles towards the selected
+ *   channel through an RC time constant, read with Gaussian noise.
+ *
+ * Contacts and encoders are functions of time and can be sampled at any
+ * instant, or turned into keypad scan frames with @ref stim_matrix_frame.
+ * @ref stim_bench_attach routes the hardware mocks through the models, so
+ * firmware code that calls gpio_get(), gpio_put(), adc_read() and
+ * busy_wait_us_32() sees the modelled signals on a virtual clock.
+ */
+
+#ifndef INPUT_STIMULUS_H
+#define INPUT_STIMULUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_inputs.h"
+#include "keypad_matrix.h"
+
+/** Quadrature edges per detent, as counted by the matrix encoder decoder. */
+#define STIM_ENCODER_EDGES_PER_DETENT 4U
+/** Largest edge jitter (percent of an edge interval) that keeps edges in order. */
+#define STIM_ENCODER_MAX_JITTER_PCT 90U
+/** Largest ADC reading. */
+#define STIM_ADC_FULL_SCALE 4095U
+/** Time one ADC conversion takes on the virtual clock (µs, 96 cycles at 48 MHz). */
+#define STIM_ADC_CONVERSION_US 2U
+
+/**
+ * @brief A contact closed by an actuator once.
+ */
+typedef struct stim_contact_t {
+	uint64_t press_us;   /**< Actuator closes the contact (UINT64_MAX = never). */
+	uint64_t release_us; /**< Actuator lets go (UINT64_MAX = held). */
+	uint32_t bounce_us;  /**< Bounce after each transition. */
+	uint32_t chatter_us; /**< Shortest time between two bounce edges (>= 1). */
+	uint32_t seed;       /**< Bounce pattern. */
+} stim_contact_t;
+
+/**
+ * @brief A quadrature encoder turned at constant speed.
+ *
+ * Channel A and B are contacts to ground; clockwise rotation closes B first,
+ * the order the matrix decoder counts as positive.
+ */
+typedef struct stim_encoder_t {
+	uint64_t start_us;        /**< Rotation starts from a detent. */
+	uint64_t stop_us;         /**< Rotation stops (UINT64_MAX = never). */
+	int32_t rpm;              /**< Shaft speed, positive clockwise. */
+	uint16_t detents_per_rev; /**< Detents per revolution. */
+	uint8_t jitter_pct;       /**< Edge jitter, percent of an edge interval (up to @ref STIM_ENCODER_MAX_JITTER_PCT). */
+	uint32_t seed;            /**< Jitter pattern. */
+} stim_encoder_t;
+
+/**
+ * @brief Contacts and encoders wired into the keypad matrix.
+ */
+typedef struct stim_matrix_t {
+	const stim_contact_t *keys[KEYPAD_MATRIX_POSITIONS]; /**< Contact at each position (NULL = open). */
+	const stim_encoder_t *encoders[MAX_NUM_ENCODERS];    /**< Encoder at each map entry (NULL = none). */
+	encoder_map_t encoder_map[MAX_NUM_ENCODERS];         /**< Encoder positions, as in the profile. */
+} stim_matrix_t;
+
+/**
+ * @brief Analogue multiplexer in front of the ADC.
+ */
+typedef struct stim_mux_t {
+	uint16_t level[ADC_CHANNELS]; /**< Settled reading of each channel (LSB); may change at any time. */
+	uint32_t tau_ns;              /**< RC time constant of the output node (source resistance x hold capacitance). */
+	uint16_t noise_lsb;           /**< Standard deviation of the conversion noise (LSB). */
+	uint8_t channel;              /**< Selected channel. */
+	uint16_t target;              /**< Level the node is settling towards. */
+	double start_lsb;             /**< Node voltage when it started settling (LSB). */
+	uint64_t start_us;            /**< Time it started settling. */
+	uint32_t random;              /**< Noise generator state. */
+	uint64_t conversions;         /**< Conversions taken. */
+} stim_mux_t;
+
+/**
+ * @brief Whether a contact is closed.
+ *
+ * @param[in] contact Contact.
+ * @param[in] now_us  Time.
+ *
+ * @retval true  Closed.
+ * @retval false Open.
+ */
+bool stim_contact_closed(const stim_contact_t *contact, uint64_t now_us);
+
+/**
+ * @brief Next time a contact changes level.
+ *
+ * Lets a test deliver the edges an interrupt would see.
+ *
+ * @param[in] contact  Contact.
+ * @param[in] after_us Time to search from (exclusive).
+ *
+ * @return Time of the next edge, UINT64_MAX when the contact is settled for good.
+ */
+uint64_t stim_contact_next_edge(const stim_contact_t *contact, uint64_t after_us);
+
+/**
+ * @brief Quadrature edges an encoder produced so far.
+ *
+ * @param[in] encoder Encoder.
+ * @param[in] now_us  Time.
+ *
+ * @return Edge count.
+ */
+uint32_t stim_encoder_edges(const stim_encoder_t *encoder, uint64_t now_us);
+
+/**
+ * @brief Channel levels of an encoder.
+ *
+ * @param[in] encoder Encoder.
+ * @param[in] now_us  Time.
+ *
+ * @return Bit 0 set when channel A is closed, bit 1 when channel B is closed.
+ */
+uint8_t stim_encoder_phase(const stim_encoder_t *encoder, uint64_t now_us);
+
+/**
+ * @brief Detents an encoder actually turned, the reference for missed detents.
+ *
+ * @param[in] encoder Encoder.
+ * @param[in] now_us  Time.
+ *
+ * @return Whole detents turned, clockwise positive.
+ */
+int32_t stim_encoder_detents(const stim_encoder_t *encoder, uint64_t now_us);
+
+/**
+ * @brief Record a keypad scan frame as the PIO would.
+ *
+ * Every position is sampled at @p now_us; the real scan spreads them over
+ * about a hundred microseconds.
+ *
+ * @param[in]  matrix Matrix wiring.
+ * @param[in]  now_us Sample time.
+ * @param[out] frame  Row line levels (low = closed).
+ */
+void stim_matrix_frame(const stim_matrix_t *matrix, uint64_t now_us, uint32_t frame[KEYPAD_SCAN_FRAME_WORDS]);
+
+/**
+ * @brief Start a multiplexer with every channel at 0 and channel 0 selected.
+ *
+ * @param[out] mux       Multiplexer.
+ * @param[in]  tau_ns    RC time constant of the output node (ns).
+ * @param[in]  noise_lsb Conversion noise standard deviation (LSB).
+ * @param[in]  seed      Noise pattern.
+ */
+void stim_mux_init(stim_mux_t *mux, uint32_t tau_ns, uint16_t noise_lsb, uint32_t seed);
+
+/**
+ * @brief Route a channel to the output node.
+ *
+ * @param[in,out] mux     Multiplexer.
+ * @param[in]     channel Channel (below @ref ADC_CHANNELS).
+ * @param[in]     now_us  Time of the switch.
+ */
+void stim_mux_select(stim_mux_t *mux, uint8_t channel, uint64_t now_us);
+
+/**
+ * @brief Take one conversion of the output node.
+ *
+ * @param[in,out] mux    Multiplexer.
+ * @param[in]     now_us Sample time.
+ *
+ * @return Reading, 0 to @ref STIM_ADC_FULL_SCALE.
+ */
+uint16_t stim_mux_sample(stim_mux_t *mux, uint64_t now_us);
+
+/**
+ * @brief Route the hardware mocks through the models on a virtual clock.
+ *
+ * time_us_32() reads the clock, busy_wait_us_32() advances it, gpio_put() on
+ * the ADC select pins switches @p mux, adc_read() converts the selected
+ * channel and advances the clock by @ref STIM_ADC_CONVERSION_US, and
+ * gpio_get() on a direct input pin reads its contact (active low).
+ *
+ * @param[in,out] mux    Multiplexer, or NULL.
+ * @param[in]     direct Contacts of the direct inputs (@ref DIRECT_INPUT_COUNT entries), or NULL.
+ * @param[in]     now_us Clock start.
+ */
+void stim_bench_attach(stim_mux_t *mux, const stim_contact_t *direct, uint64_t now_us);
+
+/**
+ * @brief Restore the default hardware mocks.
+ */
+void stim_bench_detach(void);
+
+/**
+ * @brief Virtual clock of the attached bench.
+ *
+ * @return Time (µs).
+ */
+uint64_t stim_bench_now_us(void);
+
+/**
+ * @brief Move the virtual clock forward, e.g. for the time between scans.
+ *
+ * @param[in] delta_us Time to add (µs).
+ */
+void stim_bench_advance_us(uint64_t delta_us);
+
+#endif // INPUT_STIMULUS_H
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Mock hardware/flash.h: flash is emulated by a RAM image in hardware_mocks.c
+#define FLASH_PAGE_SIZE (1U << 8)
+#define FLASH_SECTOR_SIZE (1U << 12)
+#define PICO_FLASH_SIZE_BYTES (64U * 1024U)
+
+extern uint8_t mock_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)mock_flash_image)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
@@ -17,6 +17,13 @@ uint gpio_get_function(uint pin);
 void gpio_pull_up(uint pin);
 void gpio_pull_down(uint pin);
 void gpio_deinit(uint pin);
+
+// GPIO interrupts
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
 void adc_gpio_init(uint pin);
 
 // Additional ADC functions
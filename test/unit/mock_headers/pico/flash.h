@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+// Mock pico/flash.h
+#ifndef PICO_OK
+#define PICO_OK 0
+#endif
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+// Test helpers implemented in hardware_mocks.c
+void mock_flash_set_safe_execute_result(int result);
+void mock_flash_erase_all(void);
@@ -39,6 +39,8 @@ extern struct spi_inst_t *spi0;
 // Additional functions
 void busy_wait_ms(uint32_t ms);
 uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+uint get_core_num(void);
 void adc_init(void);
 
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // Mock Pico time functions
@@ -7,6 +8,12 @@ uint32_t time_us_32(void);
 void sleep_us(uint64_t us);
 void busy_wait_us_32(uint32_t delay_us);
 
+// Mock alarms (never fire on the host)
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+
 #ifndef pdMS_TO_TICKS
 #define pdMS_TO_TICKS(ms) (ms)  // Simple mapping for tests
 #endif
@@ -15,8 +15,10 @@
 
 #include "app_comm.h"
 #include "app_context.h"
+#include "cobs.h"
 #include "commands.h"
 #include "error_management.h"
+#include "input_state.h"
 
 static QueueHandle_t mock_queue_handle = (QueueHandle_t)0xCAFEU;
 static BaseType_t mock_queue_result = pdTRUE;
@@ -83,11 +85,76 @@ static void test_send_packet_rejects_oversized_payload(void **state)
 	assert_int_equal(statistics_get_counter(BUFFER_OVERFLOW_ERROR), 1);
 }
 
+static void test_state_dump_replies_with_every_part(void **state)
+{
+	(void)state;
+	// Header, tag 0x42, then room for the XOR checksum
+	const uint8_t request[] = {(uint8_t)(BOARD_ID >> 3U), (uint8_t)(((BOARD_ID & 0x07U) << 5U) | PC_STATE_DUMP_CMD), 1U, 0x42U, 0x00U};
+	uint8_t frame[sizeof(request)];
+
+	(void)memcpy(frame, request, sizeof(request)); // flawfinder: ignore
+	for (size_t i = 0U; i < (sizeof(frame) - 1U); i++)
+	{
+		frame[sizeof(frame) - 1U] ^= frame[i];
+	}
+
+	input_state_reset();
+	app_comm_process_inbound(frame, sizeof(frame));
+
+	assert_int_equal(mock_queue_send_calls, 4);
+	assert_int_equal(statistics_get_counter(MSG_MALFORMED_ERROR), 0);
+	assert_int_equal(statistics_get_counter(UNKNOWN_CMD_ERROR), 0);
+}
+
+/**
+ * @brief Decode the captured reply and return its payload length.
+ */
+static uint8_t captured_payload(uint8_t payload[DATA_BUFFER_SIZE])
+{
+	uint8_t decoded[MAX_ENCODED_BUFFER_SIZE];
+	const size_t length = cobs_decode(captured_packet.data, (size_t)captured_packet.length - 1U, decoded);
+
+	assert_true(length >= (HEADER_SIZE + CHECKSUM_SIZE));
+	assert_int_equal(PC_DEBUG_CMD, decoded[1] & 0x1FU);
+	(void)memcpy(payload, &decoded[HEADER_SIZE], decoded[2]); // flawfinder: ignore
+	return decoded[2];
+}
+
+static void test_black_box_reports_cold_boot(void **state)
+{
+	(void)state;
+	// Summary request, then the first trace record
+	uint8_t frame[] = {(uint8_t)(BOARD_ID >> 3U), (uint8_t)(((BOARD_ID & 0x07U) << 5U) | PC_DEBUG_CMD), 2U,
+	                   BLACK_BOX_SECTION_SUMMARY, 0x00U, 0x00U};
+	uint8_t payload[DATA_BUFFER_SIZE];
+	const uint8_t summary[] = {BLACK_BOX_SECTION_SUMMARY, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U};
+
+	for (size_t i = 0U; i < (sizeof(frame) - 1U); i++)
+	{
+		frame[sizeof(frame) - 1U] ^= frame[i];
+	}
+	app_comm_process_inbound(frame, sizeof(frame));
+	assert_int_equal(mock_queue_send_calls, 1);
+	assert_int_equal(sizeof(summary), captured_payload(payload));
+	assert_memory_equal(summary, payload, sizeof(summary));
+
+	// Nothing survived, so there is no record to read
+	frame[3] = BLACK_BOX_SECTION_TRACE;
+	frame[sizeof(frame) - 1U] ^= (uint8_t)(BLACK_BOX_SECTION_SUMMARY ^ BLACK_BOX_SECTION_TRACE);
+	app_comm_process_inbound(frame, sizeof(frame));
+	assert_int_equal(mock_queue_send_calls, 2);
+	assert_int_equal(1U, captured_payload(payload));
+	assert_int_equal(INVALID_BLACK_BOX_ITEM, payload[0]);
+	assert_int_equal(statistics_get_counter(MSG_MALFORMED_ERROR), 0);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test_setup(test_send_packet_accepts_max_payload, setup_test),
 		cmocka_unit_test_setup(test_send_packet_rejects_oversized_payload, setup_test),
+		cmocka_unit_test_setup(test_state_dump_replies_with_every_part, setup_test),
+		cmocka_unit_test_setup(test_black_box_reports_cold_boot, setup_test),
 	};
 
 	return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,154 @@
+/**
+ * @file test_black_box.c
+ * @brief Unit tests for the crash-surviving black box
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "black_box.h"
+
+extern void mock_time_config(uint32_t initial_value, uint32_t step);
+
+static void test_reset_keeps_previous_run(void **state)
+{
+	(void)state;
+	black_box_snapshot_t snapshot;
+
+	// Host statics start zeroed, like noise: a cold boot
+	mock_time_config(1000U, 10U);
+	black_box_boot(false);
+	assert_false(black_box_previous()->valid);
+	assert_int_equal(0U, black_box_previous()->boot_count);
+
+	black_box_trace(BLACK_BOX_EVENT_RX_PACKET, 0x02U, 3U);
+	black_box_trace(BLACK_BOX_EVENT_ERROR, 4U, 1U);
+	(void)memset(&snapshot, 0, sizeof(snapshot));
+	snapshot.uptime_ms = 500U;
+	snapshot.queue_depth[BLACK_BOX_QUEUE_CDC_TRANSMIT] = 2048U;
+	snapshot.heartbeat[3] = 77U;
+	black_box_snapshot(&snapshot);
+
+	// Soft reset: the region was not cleared
+	black_box_boot(true);
+	const black_box_report_t *report = black_box_previous();
+	assert_true(report->valid);
+	assert_int_equal(1U, report->boot_count);
+	assert_int_equal(3U, report->records);
+	assert_int_equal(BLACK_BOX_EVENT_BOOT, report->trace[0].event);
+	assert_int_equal(BLACK_BOX_EVENT_RX_PACKET, report->trace[1].event);
+	assert_int_equal(0x02U, report->trace[1].arg);
+	assert_int_equal(3U, report->trace[1].value);
+	assert_int_equal(BLACK_BOX_EVENT_ERROR, report->trace[2].event);
+	assert_true(report->snapshot_valid);
+	assert_int_equal(500U, report->snapshot.uptime_ms);
+	assert_int_equal(2048U, report->snapshot.queue_depth[BLACK_BOX_QUEUE_CDC_TRANSMIT]);
+	assert_int_equal(77U, report->snapshot.heartbeat[3]);
+
+	// The new run starts from an empty trace with its own boot record
+	black_box_boot(false);
+	assert_int_equal(2U, black_box_previous()->boot_count);
+	assert_int_equal(1U, black_box_previous()->records);
+	assert_int_equal(1U, black_box_previous()->trace[0].arg);
+	assert_false(black_box_previous()->snapshot_valid);
+}
+
+static void test_collect_merges_cores_and_drops_torn_records(void **state)
+{
+	(void)state;
+	static black_box_t box;
+	black_box_record_t records[BLACK_BOX_RECORDS];
+
+	black_box_format(&box, 0U);
+	black_box_append(&box, 0U, 0xFFFFFF00U, BLACK_BOX_EVENT_TX_EVENT, 1U, 0U);
+	black_box_append(&box, 1U, 0xFFFFFF80U, BLACK_BOX_EVENT_TX_FLUSH, 0U, 1U);
+	black_box_append(&box, 0U, 0x00000010U, BLACK_BOX_EVENT_TX_EVENT, 2U, 0U); // timer wrapped
+	black_box_append(&box, 1U, 0x00000020U, BLACK_BOX_EVENT_TX_FLUSH, 0U, 2U);
+	black_box_append(&box, 0U, 0x00000030U, BLACK_BOX_EVENT_FATAL, 2U, 0U);
+
+	assert_int_equal(5U, black_box_collect(&box, records));
+	assert_int_equal(0xFFFFFF00U, records[0].time_us);
+	assert_int_equal(0xFFFFFF80U, records[1].time_us);
+	assert_int_equal(0x00000010U, records[2].time_us);
+	assert_int_equal(0x00000020U, records[3].time_us);
+	assert_int_equal(BLACK_BOX_EVENT_FATAL, records[4].event);
+
+	// A record half-written when the reset hit
+	box.trace[1][2].value = 0xDEADU;
+	assert_int_equal(4U, black_box_collect(&box, records));
+	assert_int_equal(0x00000010U, records[2].time_us);
+	assert_int_equal(0x00000030U, records[3].time_us);
+}
+
+static void test_ring_keeps_latest_records(void **state)
+{
+	(void)state;
+	static black_box_t box;
+	black_box_record_t records[BLACK_BOX_RECORDS];
+
+	black_box_format(&box, 0U);
+	for (uint32_t i = 0U; i < (BLACK_BOX_TRACE_DEPTH + 5U); i++)
+	{
+		black_box_append(&box, 0U, i, BLACK_BOX_EVENT_RX_PACKET, 0U, (uint16_t)i);
+	}
+
+	assert_int_equal(BLACK_BOX_TRACE_DEPTH, black_box_collect(&box, records));
+	assert_int_equal(5U, records[0].value);
+	assert_int_equal(BLACK_BOX_TRACE_DEPTH + 4U, records[BLACK_BOX_TRACE_DEPTH - 1U].value);
+}
+
+static void test_torn_snapshot_falls_back_to_older_slot(void **state)
+{
+	(void)state;
+	static black_box_t box;
+	black_box_snapshot_t snapshot;
+	black_box_snapshot_t found;
+
+	black_box_format(&box, 0U);
+	assert_false(black_box_find_snapshot(&box, &found));
+
+	(void)memset(&snapshot, 0, sizeof(snapshot));
+	snapshot.uptime_ms = 100U;
+	black_box_store_snapshot(&box, &snapshot);
+	snapshot.uptime_ms = 200U;
+	black_box_store_snapshot(&box, &snapshot);
+	assert_true(black_box_find_snapshot(&box, &found));
+	assert_int_equal(200U, found.uptime_ms);
+
+	box.snapshot[found.sequence % BLACK_BOX_SNAPSHOT_SLOTS].heartbeat[0]++;
+	assert_true(black_box_find_snapshot(&box, &found));
+	assert_int_equal(100U, found.uptime_ms);
+}
+
+static void test_corrupt_header_is_rejected(void **state)
+{
+	(void)state;
+	static black_box_t box;
+
+	black_box_format(&box, 7U);
+	assert_true(black_box_is_valid(&box));
+
+	box.boot_count++;
+	assert_false(black_box_is_valid(&box));
+
+	black_box_format(&box, 7U);
+	box.magic ^= 1U;
+	assert_false(black_box_is_valid(&box));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_reset_keeps_previous_run),
+		cmocka_unit_test(test_collect_merges_cores_and_drops_torn_records),
+		cmocka_unit_test(test_ring_keeps_latest_records),
+		cmocka_unit_test(test_torn_snapshot_falls_back_to_older_slot),
+		cmocka_unit_test(test_corrupt_header_is_rejected),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
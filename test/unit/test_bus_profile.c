@@ -0,0 +1,69 @@
+/**
+ * @file test_bus_profile.c
+ * @brief Unit tests for the output bus lock profile
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "bus_profile.h"
+
+static void test_buckets_grow_by_four(void **state)
+{
+	(void)state;
+
+	assert_int_equal(0U, bus_profile_bucket(0U));
+	assert_int_equal(0U, bus_profile_bucket(15U));
+	assert_int_equal(1U, bus_profile_bucket(16U));
+	assert_int_equal(1U, bus_profile_bucket(63U));
+	assert_int_equal(2U, bus_profile_bucket(64U));
+	assert_int_equal(3U, bus_profile_bucket(256U));
+	assert_int_equal(4U, bus_profile_bucket(1024U));
+	assert_int_equal(6U, bus_profile_bucket(65535U));
+
+	// The last bucket also counts longer times
+	assert_int_equal(7U, bus_profile_bucket(65536U));
+	assert_int_equal(BUS_PROFILE_BUCKETS - 1U, bus_profile_bucket(UINT32_MAX));
+}
+
+static void test_locks_and_holds_are_counted(void **state)
+{
+	(void)state;
+	bus_profile_t profile;
+
+	bus_profile_reset(&profile);
+	bus_profile_record_lock(&profile, 3U, false);
+	bus_profile_record_lock(&profile, 900U, true);
+	bus_profile_record_lock(&profile, 20U, true);
+	bus_profile_record_timeout(&profile);
+	bus_profile_record_hold(&profile, 2500U);
+	bus_profile_record_hold(&profile, 40U);
+
+	assert_int_equal(3U, profile.locks);
+	assert_int_equal(2U, profile.contended);
+	assert_int_equal(1U, profile.timeouts);
+	assert_int_equal(900U, profile.wait_max_us);
+	assert_int_equal(2500U, profile.hold_max_us);
+	assert_int_equal(1U, profile.wait[0]);
+	assert_int_equal(1U, profile.wait[1]);
+	assert_int_equal(1U, profile.wait[3]);
+	assert_int_equal(1U, profile.hold[1]);
+	assert_int_equal(1U, profile.hold[4]);
+
+	bus_profile_reset(&profile);
+	assert_int_equal(0U, profile.locks);
+	assert_int_equal(0U, profile.hold[4]);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_buckets_grow_by_four),
+		cmocka_unit_test(test_locks_and_holds_are_counted),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
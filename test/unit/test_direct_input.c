@@ -0,0 +1,101 @@
+/**
+ * @file test_direct_input.c
+ * @brief Unit tests for the direct input lockout debounce
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "direct_input.h"
+
+static void test_first_edge_reported_immediately(void **state)
+{
+	(void)state;
+	direct_input_state_t input = {0};
+
+	assert_true(direct_input_edge(&input, true, 1000U));
+	assert_true(input.pressed);
+	assert_true(input.locked);
+	assert_int_equal(1000U, input.edge_us);
+}
+
+static void test_bounce_ignored_inside_lockout(void **state)
+{
+	(void)state;
+	direct_input_state_t input = {0};
+
+	assert_true(direct_input_edge(&input, true, 0U));
+
+	// Contact bounce right after the press
+	assert_false(direct_input_edge(&input, false, 40U));
+	assert_false(direct_input_edge(&input, true, 90U));
+	assert_false(direct_input_edge(&input, false, DIRECT_INPUT_LOCKOUT_US - 1U));
+	assert_true(input.pressed);
+
+	// Window over, settled pressed: nothing new
+	assert_false(direct_input_lockout_end(&input, true, DIRECT_INPUT_LOCKOUT_US));
+	assert_false(input.locked);
+
+	// Release is reported at its first edge
+	assert_true(direct_input_edge(&input, false, 20000U));
+	assert_false(input.pressed);
+}
+
+static void test_change_inside_lockout_reported_at_end(void **state)
+{
+	(void)state;
+	direct_input_state_t input = {0};
+
+	// A tap shorter than the window
+	assert_true(direct_input_edge(&input, true, 0U));
+	assert_false(direct_input_edge(&input, false, 1500U));
+
+	// The release is picked up when the window closes and opens a new one
+	assert_true(direct_input_lockout_end(&input, false, DIRECT_INPUT_LOCKOUT_US));
+	assert_false(input.pressed);
+	assert_true(input.locked);
+	assert_int_equal(DIRECT_INPUT_LOCKOUT_US, input.edge_us);
+}
+
+static void test_stale_lockout_expires_without_alarm(void **state)
+{
+	(void)state;
+	direct_input_state_t input = {0};
+
+	// Edge timestamps close to the 32-bit wrap
+	assert_true(direct_input_edge(&input, true, 0xFFFFFF00UL));
+	assert_false(direct_input_edge(&input, false, 0x00000010UL));
+	assert_true(direct_input_edge(&input, false, (uint32_t)(0xFFFFFF00UL + DIRECT_INPUT_LOCKOUT_US)));
+}
+
+static void test_key_code_outside_matrix(void **state)
+{
+	(void)state;
+
+	// Rows are three bits in the key event byte
+	assert_true(DIRECT_INPUT_COUNT <= KEYPAD_MAX_ROWS);
+	assert_true(DIRECT_INPUT_COLUMN >= KEYPAD_MAX_COLS);
+
+	assert_int_equal(0x83U, direct_input_key_code(1U, true));
+	assert_int_equal(0x80U, direct_input_key_code(0U, false));
+	assert_true(direct_input_is_key_code(direct_input_key_code(1U, false)));
+
+	// Matrix keys never use the column
+	assert_false(direct_input_is_key_code((uint8_t)(((KEYPAD_MAX_COLS - 1U) << 4U) | (7U << 1U) | 1U)));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_first_edge_reported_immediately),
+		cmocka_unit_test(test_bounce_ignored_inside_lockout),
+		cmocka_unit_test(test_change_inside_lockout_reported_at_end),
+		cmocka_unit_test(test_stale_lockout_expires_without_alarm),
+		cmocka_unit_test(test_key_code_outside_matrix),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
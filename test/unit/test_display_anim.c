@@ -0,0 +1,215 @@
+/**
+ * @file test_display_anim.c
+ * @brief Unit tests for device-side display value interpolation
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "display_anim.h"
+#include "display_format.h"
+
+#define B OUTPUT_DIGIT_BLANK
+
+/** Width 5, blank padded, unsigned. */
+#define FORMAT_5 (5U - 1U)
+
+/** Step until idle, returning the number of steps taken. */
+static uint32_t run_to_target(display_anim_t *anim, uint32_t *writes)
+{
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	uint32_t steps = 0U;
+
+	while (display_anim_active(anim) && (steps < 10000U))
+	{
+		if (0U != display_anim_step(anim, digits, &dot))
+		{
+			(*writes)++;
+		}
+		steps++;
+	}
+
+	return steps;
+}
+
+static void test_first_target_jumps(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t expected[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, 2, 5, 0};
+
+	display_anim_reset(&anim);
+	assert_false(display_anim_active(&anim));
+
+	// Nothing shown yet, so there is nothing to roll from
+	assert_true(display_anim_start(&anim, 250U, FORMAT_5, 0U, 1000U));
+	assert_int_equal(0xFFU, display_anim_step(&anim, digits, &dot));
+	assert_memory_equal(expected, digits, sizeof(expected));
+	assert_false(display_anim_active(&anim));
+}
+
+static void test_duration_lands_on_target(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	uint32_t writes = 0U;
+
+	display_anim_reset(&anim);
+	assert_true(display_anim_start(&anim, 1000U, FORMAT_5, 0U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+
+	// 1000 -> 2000 over 200 ms: ten refresh periods, each one moving 100 (hundreds digit only)
+	assert_true(display_anim_start(&anim, 2000U, FORMAT_5, 0U, 200U));
+	assert_int_equal(0x20U, display_anim_step(&anim, digits, &dot));
+	assert_int_equal(1100, anim.current);
+	assert_int_equal(9U, run_to_target(&anim, &writes));
+	assert_int_equal(9U, writes);
+	assert_int_equal(2000, anim.current);
+
+	// A duration that is not a whole number of periods rounds up
+	assert_true(display_anim_start(&anim, 1990U, FORMAT_5, 0U, 30U));
+	writes = 0U;
+	assert_int_equal(2U, run_to_target(&anim, &writes));
+	assert_int_equal(1990, anim.current);
+}
+
+static void test_rate_carries_fraction(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	uint32_t writes = 0U;
+
+	display_anim_reset(&anim);
+	assert_true(display_anim_start(&anim, 0U, FORMAT_5, 0U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+
+	// 10 units per second is 0.2 per period: one unit every fifth step
+	assert_true(display_anim_start(&anim, 10U, FORMAT_5, 0U, (uint16_t)(DISPLAY_ANIM_SLEW_RATE | 10U)));
+	for (uint8_t i = 0U; i < 4U; i++)
+	{
+		assert_int_equal(0U, display_anim_step(&anim, digits, &dot));
+	}
+	assert_int_equal(0x80U, display_anim_step(&anim, digits, &dot));
+	assert_int_equal(1, anim.current);
+
+	// 50 steps per second at this rate means one second for the whole move
+	assert_int_equal(45U, run_to_target(&anim, &writes));
+	assert_int_equal(9U, writes);
+	assert_int_equal(10, anim.current);
+}
+
+static void test_only_changed_digits_reported(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+
+	display_anim_reset(&anim);
+	assert_true(display_anim_start(&anim, 1998U, FORMAT_5, 0U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+
+	// One unit per period
+	assert_true(display_anim_start(&anim, 2001U, FORMAT_5, 0U, (uint16_t)(DISPLAY_ANIM_SLEW_RATE | 50U)));
+	assert_int_equal(0x80U, display_anim_step(&anim, digits, &dot)); // 1999
+	assert_int_equal(0xF0U, display_anim_step(&anim, digits, &dot)); // 2000 rolls four digits
+	assert_int_equal(0x80U, display_anim_step(&anim, digits, &dot)); // 2001
+	assert_false(display_anim_active(&anim));
+
+	// Settled: nothing to write
+	assert_int_equal(0U, display_anim_step(&anim, digits, &dot));
+}
+
+static void test_retarget_continues_from_shown_value(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+
+	display_anim_reset(&anim);
+	assert_true(display_anim_start(&anim, 0U, FORMAT_5, 0U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+
+	assert_true(display_anim_start(&anim, 1000U, FORMAT_5, 0U, 100U));
+	(void)display_anim_step(&anim, digits, &dot);
+	(void)display_anim_step(&anim, digits, &dot);
+	assert_int_equal(400, anim.current);
+
+	// Reverse mid-way without jumping
+	assert_true(display_anim_start(&anim, 0U, FORMAT_5, 0U, 100U));
+	(void)display_anim_step(&anim, digits, &dot);
+	assert_int_equal(320, anim.current);
+
+	// A new field layout starts from the target instead
+	assert_true(display_anim_start(&anim, 77U, (uint8_t)(FORMAT_5 | DISPLAY_FORMAT_LEADING_ZEROS), 0U, 100U));
+	(void)display_anim_step(&anim, digits, &dot);
+	assert_int_equal(77, anim.current);
+}
+
+static void test_signed_values_cross_zero(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	uint32_t writes = 0U;
+	const uint8_t format = (uint8_t)(FORMAT_5 | DISPLAY_FORMAT_SIGNED);
+	const uint8_t expected[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, B, 1, 5};
+
+	// Vertical speed -1.5 -> +1.5 with one decimal
+	display_anim_reset(&anim);
+	assert_true(display_anim_start(&anim, (uint32_t)-15, format, 1U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+	assert_int_equal(OUTPUT_DIGIT_MINUS, digits[5]);
+
+	assert_true(display_anim_start(&anim, 15U, format, 1U, 60U));
+	(void)run_to_target(&anim, &writes);
+	assert_int_equal(3U, writes);
+	assert_memory_equal(expected, anim.shown, sizeof(expected));
+	assert_int_equal(6U, anim.shown_dot);
+}
+
+static void test_invalid_and_out_of_range(void **state)
+{
+	(void)state;
+	display_anim_t anim;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+
+	display_anim_reset(&anim);
+	assert_false(display_anim_start(&anim, 1U, (uint8_t)(FORMAT_5 | 0x40U), 0U, 0U));
+	assert_false(display_anim_start(&anim, 1U, FORMAT_5, 5U, 0U));
+	assert_false(display_anim_active(&anim));
+
+	// Huge targets are clamped just past the display range and show dashes
+	assert_true(display_anim_start(&anim, 0xFFFFFFFFUL, FORMAT_5, 0U, 0U));
+	(void)display_anim_step(&anim, digits, &dot);
+	assert_int_equal((int32_t)DISPLAY_FORMAT_MAX_MAGNITUDE + 1, anim.current);
+	assert_int_equal(OUTPUT_DIGIT_MINUS, digits[7]);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_first_target_jumps),
+		cmocka_unit_test(test_duration_lands_on_target),
+		cmocka_unit_test(test_rate_carries_fraction),
+		cmocka_unit_test(test_only_changed_digits_reported),
+		cmocka_unit_test(test_retarget_continues_from_shown_value),
+		cmocka_unit_test(test_signed_values_cross_zero),
+		cmocka_unit_test(test_invalid_and_out_of_range),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_display_format.c
+ * @brief Unit tests for device-side numeric display formatting
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#include "display_format.h"
+
+#define B OUTPUT_DIGIT_BLANK
+#define M OUTPUT_DIGIT_MINUS
+
+/** Build a format descriptor for a field of @p width digits. */
+static uint8_t fmt(uint8_t width, uint8_t flags)
+{
+	return (uint8_t)((width - 1U) | flags);
+}
+
+static void test_bcd_conversion_matches_decimal(void **state)
+{
+	(void)state;
+	const uint32_t samples[] = {0U, 5U, 9U, 10U, 99U, 100U, 1234U, 65535U, 1000000U, 12345678U, 99999999U};
+
+	for (size_t i = 0U; i < (sizeof(samples) / sizeof(samples[0])); i++)
+	{
+		char text[12];
+		uint32_t expected = 0U;
+		(void)snprintf(text, sizeof(text), "%lu", (unsigned long)samples[i]);
+		for (size_t c = 0U; text[c] != '\0'; c++)
+		{
+			expected = (expected << 4U) | (uint32_t)(text[c] - '0');
+		}
+		assert_int_equal(expected, display_format_to_bcd(samples[i]));
+	}
+}
+
+static void test_unsigned_right_aligned(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t expected[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, 2, 5, 0};
+
+	assert_true(display_format_number(250U, fmt(5U, 0U), 0U, digits, &dot));
+	assert_memory_equal(expected, digits, sizeof(expected));
+	assert_int_equal(OUTPUT_NO_DECIMAL_POINT, dot);
+}
+
+static void test_leading_zeros_and_sign(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t zero_padded[OUTPUT_IMAGE_SIZE] = {B, B, B, B, 0, 0, 4, 2};
+	const uint8_t negative[OUTPUT_IMAGE_SIZE] = {B, B, B, B, M, 0, 4, 2};
+	const uint8_t negative_blank[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, M, 4, 2};
+
+	assert_true(display_format_number(42U, fmt(4U, DISPLAY_FORMAT_LEADING_ZEROS), 0U, digits, &dot));
+	assert_memory_equal(zero_padded, digits, sizeof(zero_padded));
+
+	assert_true(display_format_number((uint32_t)-42, fmt(4U, DISPLAY_FORMAT_LEADING_ZEROS | DISPLAY_FORMAT_SIGNED), 0U, digits, &dot));
+	assert_memory_equal(negative, digits, sizeof(negative));
+
+	assert_true(display_format_number((uint32_t)-42, fmt(4U, DISPLAY_FORMAT_SIGNED), 0U, digits, &dot));
+	assert_memory_equal(negative_blank, digits, sizeof(negative_blank));
+}
+
+static void test_fixed_point_keeps_units_digit(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t expected[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, 0, 0, 5};
+	const uint8_t qnh[OUTPUT_IMAGE_SIZE] = {B, B, B, B, 2, 9, 9, 2};
+
+	// 0.05 with two decimals
+	assert_true(display_format_number(5U, fmt(4U, 0U), 2U, digits, &dot));
+	assert_memory_equal(expected, digits, sizeof(expected));
+	assert_int_equal(5U, dot);
+
+	// 29.92
+	assert_true(display_format_number(2992U, fmt(4U, 0U), 2U, digits, &dot));
+	assert_memory_equal(qnh, digits, sizeof(qnh));
+	assert_int_equal(5U, dot);
+}
+
+static void test_blank_on_zero(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t blank[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, B, B, B};
+	const uint8_t zero[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, B, B, 0};
+
+	assert_true(display_format_number(0U, fmt(3U, DISPLAY_FORMAT_BLANK_ZERO), 1U, digits, &dot));
+	assert_memory_equal(blank, digits, sizeof(blank));
+	assert_int_equal(OUTPUT_NO_DECIMAL_POINT, dot);
+
+	assert_true(display_format_number(0U, fmt(3U, 0U), 0U, digits, &dot));
+	assert_memory_equal(zero, digits, sizeof(zero));
+}
+
+static void test_overflow_shows_dashes(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+	const uint8_t dashes[OUTPUT_IMAGE_SIZE] = {B, B, B, B, B, M, M, M};
+	const uint8_t full_dashes[OUTPUT_IMAGE_SIZE] = {M, M, M, M, M, M, M, M};
+
+	assert_true(display_format_number(1000U, fmt(3U, 0U), 0U, digits, &dot));
+	assert_memory_equal(dashes, digits, sizeof(dashes));
+
+	// The sign needs a digit too
+	assert_true(display_format_number((uint32_t)-100, fmt(3U, DISPLAY_FORMAT_SIGNED), 0U, digits, &dot));
+	assert_memory_equal(dashes, digits, sizeof(dashes));
+
+	assert_true(display_format_number(100000000U, fmt(8U, 0U), 0U, digits, &dot));
+	assert_memory_equal(full_dashes, digits, sizeof(full_dashes));
+	assert_true(display_format_number(0x80000000UL, fmt(8U, DISPLAY_FORMAT_SIGNED), 0U, digits, &dot));
+	assert_memory_equal(full_dashes, digits, sizeof(full_dashes));
+}
+
+static void test_invalid_descriptor_rejected(void **state)
+{
+	(void)state;
+	uint8_t digits[OUTPUT_IMAGE_SIZE];
+	uint8_t dot = 0U;
+
+	assert_false(display_format_number(1U, (uint8_t)(fmt(4U, 0U) | 0x40U), 0U, digits, &dot));
+	assert_false(display_format_number(1U, fmt(4U, 0U), 4U, digits, &dot));
+	assert_true(display_format_number(1U, fmt(8U, 0U), 7U, digits, &dot));
+	assert_int_equal(0U, dot);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_bcd_conversion_matches_decimal),
+		cmocka_unit_test(test_unsigned_right_aligned),
+		cmocka_unit_test(test_leading_zeros_and_sign),
+		cmocka_unit_test(test_fixed_point_keeps_units_digit),
+		cmocka_unit_test(test_blank_on_zero),
+		cmocka_unit_test(test_overflow_shows_dashes),
+		cmocka_unit_test(test_invalid_descriptor_rejected),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
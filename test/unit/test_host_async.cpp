@@ -0,0 +1,208 @@
+/**
+ * @file test_host_async.cpp
+ * @brief Unit tests for the coroutine interface of the host library
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <exception>
+#include <new>
+
+extern "C" {
+#include <cmocka.h>
+}
+
+#include "sb_async.hpp"
+
+/** Heap allocations made through operator new. */
+static size_t allocations = 0U;
+
+void *operator new(size_t size)
+{
+	allocations++;
+	void *memory = std::malloc((0U != size) ? size : 1U);
+	if (nullptr == memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, size_t size) noexcept
+{
+	(void)size;
+	std::free(memory);
+}
+
+/** Fire-and-forget coroutine. */
+struct task {
+	struct promise_type {
+		task get_return_object() noexcept { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+/** What the test coroutines saw. */
+struct seen_t {
+	uint32_t events = 0U;
+	sb::event last;
+	bool closed = false;
+	bool replied = false;
+	sb_packet_t reply;
+};
+
+static task consume_events(sb::board &board, seen_t &seen)
+{
+	for (;;)
+	{
+		const sb::event e = co_await board.next_event();
+		if (sb::event_kind::closed == e.kind)
+		{
+			seen.closed = true;
+			break;
+		}
+		seen.last = e;
+		seen.events++;
+	}
+}
+
+static task ask(sb::board &board, const uint8_t *payload, uint8_t length, seen_t &seen)
+{
+	const std::optional<sb_packet_t> reply = co_await board.request(SB_CMD_ECHO, payload, length);
+	seen.replied = reply.has_value();
+	if (reply)
+	{
+		seen.reply = *reply;
+	}
+}
+
+static void feed_packet(sb::board &board, uint8_t command, const uint8_t *payload, uint8_t length)
+{
+	uint8_t wire[SB_MAX_WIRE];
+	const size_t wire_length = sb_packet_encode(1U, command, payload, length, wire);
+
+	board.feed(wire, wire_length);
+}
+
+static void test_events_resume_waiter_without_allocating(void **state)
+{
+	(void)state;
+	sb::board board(1U, -1);
+	seen_t seen;
+	const uint8_t key = 0x51U;
+	const uint8_t adc[] = {0x03U, 0x0AU, 0xBCU};
+
+	// Queued before anyone waits, then taken without suspending
+	feed_packet(board, SB_CMD_KEY, &key, 1U);
+	consume_events(board, seen);
+	assert_int_equal(1U, seen.events);
+	assert_true(sb::event_kind::key == seen.last.kind);
+	assert_int_equal(5U, seen.last.index);
+	assert_int_equal(1U, seen.last.value);
+
+	// Delivered straight to the suspended coroutine
+	const size_t before = allocations;
+	for (uint32_t i = 0U; i < 100U; i++)
+	{
+		feed_packet(board, SB_CMD_AD, adc, sizeof(adc));
+	}
+	assert_int_equal(before, allocations);
+	assert_int_equal(101U, seen.events);
+	assert_true(sb::event_kind::adc == seen.last.kind);
+	assert_int_equal(3U, seen.last.index);
+	assert_int_equal(0x0ABCU, seen.last.value);
+
+	board.close();
+	assert_true(seen.closed);
+	assert_int_equal(0U, board.stats().dropped);
+}
+
+static void test_request_matches_reply(void **state)
+{
+	(void)state;
+	const uint8_t payload[] = {0xAAU, 0x55U};
+	uint8_t expected[SB_MAX_WIRE];
+	uint8_t written[SB_MAX_WIRE];
+	seen_t seen;
+	int fds[2];
+
+	assert_int_equal(0, pipe(fds));
+	sb::board board(1U, fds[1]);
+	ask(board, payload, sizeof(payload), seen);
+	assert_false(seen.replied);
+
+	// The request went out at once
+	const size_t length = sb_packet_encode(1U, SB_CMD_ECHO, payload, sizeof(payload), expected);
+	assert_int_equal((ssize_t)length, read(fds[0], written, sizeof(written)));
+	assert_memory_equal(expected, written, length);
+
+	// A packet of another command is not the reply
+	const uint8_t pwm = 0x10U;
+	feed_packet(board, SB_CMD_PWM, &pwm, 1U);
+	assert_false(seen.replied);
+
+	feed_packet(board, SB_CMD_ECHO, payload, sizeof(payload));
+	assert_true(seen.replied);
+	assert_int_equal(SB_CMD_ECHO, seen.reply.command);
+	assert_memory_equal(payload, seen.reply.payload, sizeof(payload));
+	assert_int_equal(1U, board.stats().replies);
+	assert_int_equal(1U, board.stats().unmatched);
+
+	(void)close(fds[0]);
+	(void)close(fds[1]);
+}
+
+/** Executor that parks the handle for the test to resume. */
+static void park(void *context, std::coroutine_handle<> handle)
+{
+	*static_cast<std::coroutine_handle<> *>(context) = handle;
+}
+
+static void test_executor_receives_ready_coroutine(void **state)
+{
+	(void)state;
+	std::coroutine_handle<> parked;
+	sb::board board(1U, -1, park, &parked);
+	seen_t seen;
+	const uint8_t rotary[] = {0x20U, 0x01U};
+
+	consume_events(board, seen);
+	feed_packet(board, SB_CMD_ROTARY, rotary, sizeof(rotary));
+	assert_int_equal(0U, seen.events);
+	assert_true(static_cast<bool>(parked));
+
+	parked.resume();
+	assert_int_equal(1U, seen.events);
+	assert_true(sb::event_kind::rotary == seen.last.kind);
+	assert_int_equal(2U, seen.last.index);
+
+	parked = nullptr;
+	board.close();
+	parked.resume();
+	assert_true(seen.closed);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_events_resume_waiter_without_allocating),
+		cmocka_unit_test(test_request_matches_reply),
+		cmocka_unit_test(test_executor_receives_ready_coroutine),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
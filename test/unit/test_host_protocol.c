@@ -0,0 +1,521 @@
+/**
+ * @file test_host_protocol.c
+ * @brief Unit tests for the host library codec, reader and output cache
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+#include "sb_link.h"
+#include "sb_outputs.h"
+#include "sb_protocol.h"
+#include "sb_reader.h"
+#include "sb_rt.h"
+#include "sb_writer.h"
+
+/** Events seen by the recording callbacks. */
+typedef struct recorder_t {
+	uint32_t keys;
+	uint8_t key_column[64];
+	uint8_t key_row[64];
+	bool key_pressed[64];
+	uint32_t adcs;
+	uint8_t adc_channel[16];
+	uint16_t adc_value[16];
+	uint32_t rotaries;
+	uint32_t errors;
+	uint32_t error_value;
+	uint32_t raws;
+	uint8_t raw_command;
+	uint32_t resyncs;
+	sb_input_snapshot_t snapshot;
+} recorder_t;
+
+static void record_key(void *context, uint16_t board_id, uint8_t column, uint8_t row, bool pressed)
+{
+	recorder_t *r = (recorder_t *)context;
+	(void)board_id;
+	r->key_column[r->keys] = column;
+	r->key_row[r->keys] = row;
+	r->key_pressed[r->keys] = pressed;
+	r->keys++;
+}
+
+static void record_adc(void *context, uint16_t board_id, uint8_t channel, uint16_t value)
+{
+	recorder_t *r = (recorder_t *)context;
+	(void)board_id;
+	r->adc_channel[r->adcs] = channel;
+	r->adc_value[r->adcs] = value;
+	r->adcs++;
+}
+
+static void record_rotary(void *context, uint16_t board_id, uint8_t encoder, bool clockwise)
+{
+	(void)board_id;
+	(void)encoder;
+	(void)clockwise;
+	((recorder_t *)context)->rotaries++;
+}
+
+static void record_error(void *context, uint16_t board_id, uint8_t index, uint32_t value)
+{
+	recorder_t *r = (recorder_t *)context;
+	(void)board_id;
+	(void)index;
+	r->error_value = value;
+	r->errors++;
+}
+
+static void record_raw(void *context, const sb_packet_t *packet)
+{
+	recorder_t *r = (recorder_t *)context;
+	r->raw_command = packet->command;
+	r->raws++;
+}
+
+static void record_resync(void *context, uint16_t board_id, const sb_input_snapshot_t *snapshot)
+{
+	recorder_t *r = (recorder_t *)context;
+	(void)board_id;
+	r->snapshot = *snapshot;
+	r->resyncs++;
+}
+
+static sb_callbacks_t recorder_callbacks(recorder_t *r)
+{
+	(void)memset(r, 0, sizeof(*r));
+	return (sb_callbacks_t){
+		.context = r,
+		.on_key = record_key,
+		.on_adc = record_adc,
+		.on_rotary = record_rotary,
+		.on_error_status = record_error,
+		.on_raw = record_raw,
+		.on_resync = record_resync,
+	};
+}
+
+/**
+ * @brief Wire frames of a state dump: key (0, 5) pressed, encoder 1 at -3,
+ * axis 0 at 0xABC and axis 15 at 0x123.
+ */
+static size_t dump_frames(uint8_t tag, uint8_t *wire)
+{
+	uint8_t keys[] = {tag, 0x04U, 0x03U, 0x00U, 0x00U, 0x30U, 0x39U, 0x20U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+	uint8_t encoders[18] = {tag, 0x14U, 0x00U, 0x00U, 0xFFU, 0xFDU};
+	uint8_t axes_low[17] = {tag, 0x24U, 0xABU, 0xC0U};
+	uint8_t axes_high[11] = {tag, 0x34U};
+	size_t length = 0U;
+
+	axes_high[9] = 0x01U;
+	axes_high[10] = 0x23U;
+	length += sb_packet_encode(1U, SB_CMD_STATE_DUMP, keys, sizeof(keys), &wire[length]);
+	length += sb_packet_encode(1U, SB_CMD_STATE_DUMP, encoders, sizeof(encoders), &wire[length]);
+	length += sb_packet_encode(1U, SB_CMD_STATE_DUMP, axes_low, sizeof(axes_low), &wire[length]);
+	length += sb_packet_encode(1U, SB_CMD_STATE_DUMP, axes_high, sizeof(axes_high), &wire[length]);
+
+	return length;
+}
+
+static void test_pwm_example_wire_bytes(void **state)
+{
+	(void)state;
+	const uint8_t duty = 0x80U;
+	const uint8_t expected[] = {0x01U, 0x05U, 0x21U, 0x01U, 0x80U, 0xA0U, 0x00U};
+	uint8_t wire[SB_MAX_WIRE];
+
+	assert_int_equal(sizeof(expected), sb_packet_encode(1U, SB_CMD_PWM, &duty, 1U, wire));
+	assert_memory_equal(expected, wire, sizeof(expected));
+}
+
+static void test_checksum_matches_examples(void **state)
+{
+	(void)state;
+	const uint8_t led[] = {0x00U, 0x22U, 0x03U, 0x01U, 0x03U, 0xFFU};
+	const uint8_t key[] = {0x00U, 0x24U, 0x01U, 0x11U};
+
+	assert_int_equal(0xDCU, sb_checksum(led, sizeof(led)));
+	assert_int_equal(0x34U, sb_checksum(key, sizeof(key)));
+}
+
+static void test_key_example_parses(void **state)
+{
+	(void)state;
+	const uint8_t raw[] = {0x00U, 0x24U, 0x01U, 0x11U, 0x34U};
+	sb_packet_t packet;
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+
+	assert_int_equal(SB_OK, sb_packet_parse(raw, sizeof(raw), 1U, &packet));
+	assert_int_equal(1U, packet.board_id);
+	assert_int_equal(SB_CMD_KEY, packet.command);
+	assert_true(sb_dispatch(&packet, &callbacks));
+	assert_int_equal(1U, r.keys);
+	assert_int_equal(1U, r.key_column[0]);
+	assert_int_equal(0U, r.key_row[0]);
+	assert_true(r.key_pressed[0]);
+}
+
+static void test_parse_rejects_in_order(void **state)
+{
+	(void)state;
+	uint8_t raw[] = {0x00U, 0x24U, 0x01U, 0x11U, 0x34U};
+	const uint8_t oversized[] = {0x00U, 0x24U, 21U, 0x00U};
+	sb_packet_t packet;
+
+	assert_int_equal(SB_ERR_SHORT, sb_packet_parse(raw, 3U, 1U, &packet));
+	assert_int_equal(SB_ERR_LENGTH, sb_packet_parse(raw, 4U, 1U, &packet));
+	assert_int_equal(SB_ERR_LENGTH, sb_packet_parse(oversized, sizeof(oversized), 1U, &packet));
+	assert_int_equal(SB_ERR_BOARD, sb_packet_parse(raw, sizeof(raw), 2U, &packet));
+	assert_int_equal(SB_OK, sb_packet_parse(raw, sizeof(raw), SB_BOARD_ANY, &packet));
+	raw[3] = 0x13U;
+	assert_int_equal(SB_ERR_CHECKSUM, sb_packet_parse(raw, sizeof(raw), 1U, &packet));
+}
+
+static void test_unknown_command_goes_to_raw(void **state)
+{
+	(void)state;
+	uint8_t wire[SB_MAX_WIRE];
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+	sb_reader_t reader;
+	const size_t length = sb_packet_encode(1U, 0x10U, NULL, 0U, wire);
+
+	sb_reader_init(&reader, 1U, &callbacks);
+	assert_int_equal(1U, sb_reader_feed(&reader, wire, length));
+	assert_int_equal(1U, r.raws);
+	assert_int_equal(0x10U, r.raw_command);
+	assert_int_equal(1U, reader.stats.unknown_commands);
+}
+
+static void test_malformed_cobs_rejected(void **state)
+{
+	(void)state;
+	const uint8_t frame[] = {0x05U, 0x21U, 0x01U};
+	uint8_t raw[sizeof(frame)];
+	size_t raw_length = 0U;
+	sb_packet_t packet;
+
+	assert_false(sb_cobs_decode(frame, sizeof(frame), raw, &raw_length));
+	assert_int_equal(SB_ERR_COBS, sb_frame_decode(frame, sizeof(frame), 1U, &packet));
+}
+
+static void test_reader_reassembles_split_frames(void **state)
+{
+	(void)state;
+	uint8_t wire[4U * SB_MAX_WIRE];
+	const uint8_t adc[] = {0x03U, 0x0AU, 0xBCU};
+	const uint8_t rotary[] = {0x20U, 0x01U};
+	const uint8_t value[] = {0x09U, 0x00U, 0x00U, 0x00U, 0x2AU};
+	size_t length = 0U;
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+	sb_reader_t reader;
+
+	length += sb_packet_encode(1U, SB_CMD_AD, adc, sizeof(adc), &wire[length]);
+	length += sb_packet_encode(1U, SB_CMD_ROTARY, rotary, sizeof(rotary), &wire[length]);
+	length += sb_packet_encode(1U, SB_CMD_ERROR_STATUS, value, sizeof(value), &wire[length]);
+
+	// One byte at a time: every frame crosses a read boundary
+	sb_reader_init(&reader, 1U, &callbacks);
+	for (size_t i = 0U; i < length; i++)
+	{
+		(void)sb_reader_feed(&reader, &wire[i], 1U);
+	}
+
+	assert_int_equal(3U, reader.stats.packets);
+	assert_int_equal(1U, r.adcs);
+	assert_int_equal(3U, r.adc_channel[0]);
+	assert_int_equal(2748U, r.adc_value[0]);
+	assert_int_equal(1U, r.rotaries);
+	assert_int_equal(1U, r.errors);
+	assert_int_equal(42U, r.error_value);
+}
+
+static void test_reader_drops_oversized_frame(void **state)
+{
+	(void)state;
+	uint8_t wire[64U];
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+	sb_reader_t reader;
+	const uint8_t key = 0x11U;
+
+	// 40 bytes of noise, then a delimiter and a valid frame
+	(void)memset(wire, 0x11U, 40U);
+	wire[40] = SB_DELIMITER;
+	const size_t length = 41U + sb_packet_encode(1U, SB_CMD_KEY, &key, 1U, &wire[41]);
+
+	sb_reader_init(&reader, 1U, &callbacks);
+	assert_int_equal(0U, sb_reader_feed(&reader, wire, 20U));
+	assert_int_equal(1U, sb_reader_feed(&reader, &wire[20], length - 20U));
+	assert_int_equal(1U, reader.stats.length_errors);
+	assert_int_equal(1U, r.keys);
+}
+
+static void test_delta_frames_expand_to_events(void **state)
+{
+	(void)state;
+	sb_packet_t keys = {.board_id = 1U, .command = SB_CMD_STATE_DELTA, .length = 5U,
+	                    .payload = {0x00U, 0x05U, 0x02U, 0x81U, 0x05U}};
+	sb_packet_t axes = {.board_id = 1U, .command = SB_CMD_STATE_DELTA, .length = 8U,
+	                    .payload = {0x01U, 0x80U, 0x05U, 0x12U, 0x34U, 0x56U, 0xFFU, 0xF0U}};
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+
+	// Keys (0,1), (2,0) and (2,7): states 1, 0, 1
+	assert_true(sb_dispatch(&keys, &callbacks));
+	assert_int_equal(3U, r.keys);
+	assert_int_equal(1U, r.key_column[0]);
+	assert_int_equal(0U, r.key_row[0]);
+	assert_true(r.key_pressed[0]);
+	assert_int_equal(0U, r.key_column[1]);
+	assert_int_equal(2U, r.key_row[1]);
+	assert_false(r.key_pressed[1]);
+	assert_int_equal(7U, r.key_column[2]);
+	assert_true(r.key_pressed[2]);
+
+	// Channels 0, 2 and 15
+	assert_true(sb_dispatch(&axes, &callbacks));
+	assert_int_equal(3U, r.adcs);
+	assert_int_equal(0U, r.adc_channel[0]);
+	assert_int_equal(0x123U, r.adc_value[0]);
+	assert_int_equal(2U, r.adc_channel[1]);
+	assert_int_equal(0x456U, r.adc_value[1]);
+	assert_int_equal(15U, r.adc_channel[2]);
+	assert_int_equal(0xFFFU, r.adc_value[2]);
+
+	// A frame cut short is rejected without events
+	axes.length = 6U;
+	r.adcs = 0U;
+	assert_false(sb_dispatch(&axes, &callbacks));
+	assert_int_equal(0U, r.adcs);
+}
+
+static void test_outputs_send_only_changes(void **state)
+{
+	(void)state;
+	sb_outputs_t outputs;
+	sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES];
+	uint8_t wire[SB_OUTPUT_MAX_CHANGES * SB_MAX_WIRE];
+	const uint8_t digits[SB_DIGITS] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+	sb_packet_t packet;
+
+	sb_outputs_init(&outputs, 1U);
+	assert_int_equal(0U, sb_outputs_diff(&outputs, changes));
+
+	// Setting the reset state again is not a change
+	assert_true(sb_outputs_set_led(&outputs, 1U, 3U, 0x00U));
+	assert_true(sb_outputs_set_brightness(&outputs, 1U, SB_DEFAULT_BRIGHTNESS));
+	assert_int_equal(0U, sb_outputs_diff(&outputs, changes));
+
+	assert_true(sb_outputs_set_led(&outputs, 1U, 3U, 0xFFU));
+	assert_true(sb_outputs_set_digits(&outputs, 1U, digits, 2U));
+	assert_false(sb_outputs_set_led(&outputs, 9U, 0U, 0xFFU));
+	assert_int_equal(2U, sb_outputs_diff(&outputs, changes));
+
+	// Both frames back to back, matching the spec examples
+	const size_t length = sb_outputs_flush(&outputs, wire, sizeof(wire));
+	const uint8_t *second = (const uint8_t *)memchr(wire, SB_DELIMITER, length) + 1;
+	assert_int_equal(SB_OK, sb_frame_decode(wire, (size_t)(second - wire) - 1U, 1U, &packet));
+	assert_int_equal(SB_CMD_LED_OUT, packet.command);
+	assert_memory_equal(((const uint8_t[]){0x01U, 0x03U, 0xFFU}), packet.payload, 3U);
+	assert_int_equal(SB_OK, sb_frame_decode(second, length - (size_t)(second - wire) - 1U, 1U, &packet));
+	assert_int_equal(SB_CMD_DISPLAY_CTL, packet.command);
+	assert_memory_equal(((const uint8_t[]){0x20U, 0x12U, 0x34U, 0x56U, 0x78U, 0x02U}), packet.payload, 6U);
+	assert_int_equal(0U, sb_outputs_diff(&outputs, changes));
+
+	// After a board reset everything set is sent again
+	sb_outputs_forget(&outputs);
+	assert_int_equal(2U, sb_outputs_diff(&outputs, changes));
+}
+
+static void test_outputs_encode_stops_when_full(void **state)
+{
+	(void)state;
+	sb_outputs_t outputs;
+	sb_output_change_t changes[SB_OUTPUT_MAX_CHANGES];
+	uint8_t wire[SB_MAX_WIRE + 4U];
+	size_t encoded = 0U;
+
+	sb_outputs_init(&outputs, 1U);
+	sb_outputs_set_pwm(&outputs, 0x80U);
+	assert_true(sb_outputs_set_led(&outputs, 2U, 0U, 0x01U));
+	const size_t count = sb_outputs_diff(&outputs, changes);
+	assert_int_equal(2U, count);
+
+	// The PWM frame fits, the LED frame does not and stays pending
+	assert_int_equal(7U, sb_outputs_encode(&outputs, changes, count, wire, 12U, &encoded));
+	assert_int_equal(1U, encoded);
+	assert_int_equal(1U, sb_outputs_diff(&outputs, changes));
+	assert_int_equal(SB_OUTPUT_LED, changes[0].kind);
+}
+
+static void test_resync_reports_one_snapshot(void **state)
+{
+	(void)state;
+	uint8_t wire[SB_DUMP_PARTS * SB_MAX_WIRE];
+	uint8_t request[SB_MAX_WIRE];
+	recorder_t r;
+	const sb_callbacks_t callbacks = recorder_callbacks(&r);
+	sb_reader_t reader;
+	sb_packet_t packet;
+	const uint8_t key = 0x51U;
+
+	sb_reader_init(&reader, 1U, &callbacks);
+	const size_t request_length = sb_reader_begin_resync(&reader, 1U, 7U, request);
+	assert_int_equal(SB_OK, sb_frame_decode(request, request_length - 1U, 1U, &packet));
+	assert_int_equal(SB_CMD_STATE_DUMP, packet.command);
+	assert_int_equal(1U, packet.length);
+	assert_int_equal(7U, packet.payload[0]);
+
+	// Events racing the request are covered by the dump
+	size_t length = sb_packet_encode(1U, SB_CMD_KEY, &key, 1U, wire);
+	(void)sb_reader_feed(&reader, wire, length);
+	assert_int_equal(0U, r.keys);
+	assert_int_equal(1U, reader.stats.suppressed);
+
+	// A reply to an older request does not complete this one
+	length = dump_frames(6U, wire);
+	(void)sb_reader_feed(&reader, wire, length);
+	assert_int_equal(0U, r.resyncs);
+
+	length = dump_frames(7U, wire);
+	assert_int_equal(SB_DUMP_PARTS, sb_reader_feed(&reader, wire, length));
+	assert_int_equal(1U, r.resyncs);
+	assert_int_equal(12345U, r.snapshot.uptime_ms);
+	assert_int_equal(SB_SNAPSHOT_KEYPAD_SCANNED | SB_SNAPSHOT_ADC_SCANNED, r.snapshot.flags);
+	assert_int_equal(0x20U, r.snapshot.keys[0]);
+	assert_int_equal(-3, r.snapshot.encoders[1]);
+	assert_int_equal(0xABCU, r.snapshot.axes[0]);
+	assert_int_equal(0x123U, r.snapshot.axes[15]);
+	assert_int_equal(0U, reader.stats.malformed);
+
+	// Back to normal dispatch
+	length = sb_packet_encode(1U, SB_CMD_KEY, &key, 1U, wire);
+	(void)sb_reader_feed(&reader, wire, length);
+	assert_int_equal(1U, r.keys);
+}
+
+static void test_reset_detected_from_uptime(void **state)
+{
+	(void)state;
+	// Restarted during a 2 s absence
+	assert_true(sb_link_board_reset(1500U, 2000U));
+	// Restarted as the connection dropped, noticed a little late
+	assert_true(sb_link_board_reset(2020U, 2000U));
+	// Kept running through the absence
+	assert_false(sb_link_board_reset(600000U, 2000U));
+}
+
+static void test_writer_coalesces_until_deadline(void **state)
+{
+	(void)state;
+	const sb_writer_config_t config = { .deadline_us = 1000U, .threshold = SB_WRITER_CAPACITY };
+	uint8_t expected[3U * SB_MAX_WIRE];
+	uint8_t got[3U * SB_MAX_WIRE];
+	size_t length = 0U;
+	sb_writer_t writer;
+	int fds[2];
+
+	assert_int_equal(0, pipe(fds));
+	assert_int_equal(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+	sb_writer_init(&writer, fds[1], 1U, &config);
+
+	for (uint8_t i = 0U; i < 3U; i++)
+	{
+		length += sb_packet_encode(1U, SB_CMD_PWM, &i, 1U, &expected[length]);
+		assert_true(sb_writer_send(&writer, SB_CMD_PWM, &i, 1U, 100U * i));
+	}
+	assert_true(sb_writer_poll(&writer, 999U));
+	assert_int_equal(1U, sb_writer_due_in(&writer, 999U));
+	assert_int_equal(-1, read(fds[0], got, sizeof(got)));
+
+	// One write, frames in order, waits measured
+	assert_true(sb_writer_poll(&writer, 1000U));
+	assert_int_equal(UINT32_MAX, sb_writer_due_in(&writer, 1000U));
+	assert_int_equal((ssize_t)length, read(fds[0], got, sizeof(got)));
+	assert_memory_equal(expected, got, length);
+	assert_int_equal(1U, writer.stats.writes);
+	assert_int_equal(3U, writer.stats.frames);
+	assert_int_equal(1U, writer.stats.deadline_flushes);
+	assert_int_equal(1000U, writer.stats.wait_max_us);
+	assert_int_equal(1000U + 900U + 800U, writer.stats.wait_total_us);
+
+	(void)close(fds[0]);
+	(void)close(fds[1]);
+}
+
+static void test_writer_urgent_keeps_order(void **state)
+{
+	(void)state;
+	uint8_t expected[2U * SB_MAX_WIRE];
+	uint8_t got[2U * SB_MAX_WIRE];
+	const uint8_t duty = 0x40U;
+	const uint8_t echo = 0xAAU;
+	size_t length = 0U;
+	sb_writer_t writer;
+	int fds[2];
+
+	assert_int_equal(0, pipe(fds));
+	sb_writer_init(&writer, fds[1], 1U, NULL);
+
+	length += sb_packet_encode(1U, SB_CMD_PWM, &duty, 1U, &expected[length]);
+	length += sb_packet_encode(1U, SB_CMD_ECHO, &echo, 1U, &expected[length]);
+	assert_true(sb_writer_send(&writer, SB_CMD_PWM, &duty, 1U, 0U));
+	assert_true(sb_writer_send_urgent(&writer, SB_CMD_ECHO, &echo, 1U, 10U));
+
+	assert_int_equal((ssize_t)length, read(fds[0], got, sizeof(got)));
+	assert_memory_equal(expected, got, length);
+	assert_int_equal(1U, writer.stats.writes);
+	assert_int_equal(2U, writer.stats.frames);
+	assert_int_equal(1U, writer.stats.urgent);
+	assert_int_equal(0U, writer.length);
+
+	(void)close(fds[0]);
+	(void)close(fds[1]);
+}
+
+static void test_rt_measure_reports_distribution(void **state)
+{
+	(void)state;
+	const sb_rt_config_t config = { .cpu = -1, .priority = 0, .lock_memory = false };
+	sb_latency_t latency;
+
+	assert_int_equal(0U, sb_rt_measure(&config, 20U, 0U, &latency));
+	assert_int_equal(20U, latency.samples);
+	assert_true(latency.min_us <= latency.p50_us);
+	assert_true(latency.p50_us <= latency.p99_us);
+	assert_true(latency.p99_us <= latency.max_us);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_pwm_example_wire_bytes),
+		cmocka_unit_test(test_checksum_matches_examples),
+		cmocka_unit_test(test_key_example_parses),
+		cmocka_unit_test(test_parse_rejects_in_order),
+		cmocka_unit_test(test_unknown_command_goes_to_raw),
+		cmocka_unit_test(test_malformed_cobs_rejected),
+		cmocka_unit_test(test_reader_reassembles_split_frames),
+		cmocka_unit_test(test_reader_drops_oversized_frame),
+		cmocka_unit_test(test_delta_frames_expand_to_events),
+		cmocka_unit_test(test_outputs_send_only_changes),
+		cmocka_unit_test(test_outputs_encode_stops_when_full),
+		cmocka_unit_test(test_resync_reports_one_snapshot),
+		cmocka_unit_test(test_reset_detected_from_uptime),
+		cmocka_unit_test(test_writer_coalesces_until_deadline),
+		cmocka_unit_test(test_writer_urgent_keeps_order),
+		cmocka_unit_test(test_rt_measure_reports_distribution),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
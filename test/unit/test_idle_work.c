@@ -0,0 +1,174 @@
+/**
+ * @file test_idle_work.c
+ * @brief Unit tests for idle-time jobs and per-core idle accounting
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "idle_work.h"
+
+/** Order in which the jobs ran. */
+static int run_order[IDLE_WORK_QUEUE_DEPTH * 2U];
+static uint8_t run_count;
+
+static void record_job(void *context)
+{
+	run_order[run_count] = *(const int *)context;
+	run_count++;
+}
+
+static void repost_job(void *context)
+{
+	// A periodic job queueing its next run from its own body
+	assert_true(idle_work_post((idle_job_t *)context));
+	run_count++;
+}
+
+static int setup(void **state)
+{
+	(void)state;
+	idle_work_reset();
+	run_count = 0U;
+	return 0;
+}
+
+static void test_jobs_run_in_post_order(void **state)
+{
+	(void)state;
+	int ids[3] = {1, 2, 3};
+	idle_job_t jobs[3] = {
+		{record_job, &ids[0], false},
+		{record_job, &ids[1], false},
+		{record_job, &ids[2], false},
+	};
+
+	assert_false(idle_work_run());
+	for (uint8_t i = 0U; i < 3U; i++)
+	{
+		assert_true(idle_work_post(&jobs[i]));
+	}
+
+	assert_true(idle_work_run());
+	assert_true(idle_work_run());
+	assert_true(idle_work_run());
+	assert_false(idle_work_run());
+	assert_int_equal(3U, run_count);
+	assert_int_equal(1, run_order[0]);
+	assert_int_equal(2, run_order[1]);
+	assert_int_equal(3, run_order[2]);
+
+	idle_work_stats_t stats;
+	idle_work_stats(0U, 0U, &stats);
+	assert_int_equal(5U, stats.passes);
+	assert_int_equal(3U, stats.run);
+	assert_int_equal(0U, stats.dropped);
+}
+
+static void test_pending_job_is_queued_once(void **state)
+{
+	(void)state;
+	int id = 7;
+	idle_job_t job = {record_job, &id, false};
+
+	assert_true(idle_work_post(&job));
+	assert_true(idle_work_post(&job));
+	assert_true(job.pending);
+
+	assert_true(idle_work_run());
+	assert_false(job.pending);
+	assert_false(idle_work_run());
+	assert_int_equal(1U, run_count);
+}
+
+static void test_full_ring_drops_post(void **state)
+{
+	(void)state;
+	int ids[IDLE_WORK_QUEUE_DEPTH + 1U];
+	idle_job_t jobs[IDLE_WORK_QUEUE_DEPTH + 1U];
+
+	for (uint8_t i = 0U; i < (uint8_t)(IDLE_WORK_QUEUE_DEPTH + 1U); i++)
+	{
+		ids[i] = (int)i;
+		jobs[i] = (idle_job_t){record_job, &ids[i], false};
+	}
+	for (uint8_t i = 0U; i < (uint8_t)IDLE_WORK_QUEUE_DEPTH; i++)
+	{
+		assert_true(idle_work_post(&jobs[i]));
+	}
+	assert_false(idle_work_post(&jobs[IDLE_WORK_QUEUE_DEPTH]));
+	assert_false(jobs[IDLE_WORK_QUEUE_DEPTH].pending);
+
+	// Draining wraps the ring; the refused job can be posted again
+	assert_true(idle_work_run());
+	assert_true(idle_work_post(&jobs[IDLE_WORK_QUEUE_DEPTH]));
+	while (idle_work_run())
+	{
+	}
+	assert_int_equal(IDLE_WORK_QUEUE_DEPTH + 1U, run_count);
+	assert_int_equal((int)IDLE_WORK_QUEUE_DEPTH, run_order[IDLE_WORK_QUEUE_DEPTH]);
+
+	idle_work_stats_t stats;
+	idle_work_stats(0U, 0U, &stats);
+	assert_int_equal(1U, stats.dropped);
+}
+
+static void test_job_can_post_itself(void **state)
+{
+	(void)state;
+	idle_job_t job = {repost_job, NULL, false};
+	job.context = &job;
+
+	assert_true(idle_work_post(&job));
+	assert_true(idle_work_run());
+	assert_true(job.pending);
+	assert_true(idle_work_run());
+	assert_int_equal(2U, run_count);
+}
+
+static void test_idle_time_follows_the_core(void **state)
+{
+	(void)state;
+	idle_work_stats_t stats;
+
+	// Core 1: busy until 100, idle 100..250, busy 250..400, idle from 400
+	idle_work_task_switched(1U, true, 100U);
+	idle_work_task_switched(1U, false, 250U);
+	idle_work_task_switched(1U, false, 300U); // task to task
+	idle_work_task_switched(1U, true, 400U);
+
+	idle_work_stats(1U, 450U, &stats);
+	assert_int_equal(200U, stats.idle_us);
+	idle_work_task_switched(1U, false, 500U);
+	idle_work_stats(1U, 900U, &stats);
+	assert_int_equal(250U, stats.idle_us);
+
+	// Core 0 saw none of it
+	idle_work_stats(0U, 900U, &stats);
+	assert_int_equal(0U, stats.idle_us);
+
+	// An idle period across the timer wrap
+	idle_work_task_switched(0U, true, 0xFFFFFFF0U);
+	idle_work_task_switched(0U, false, 0x00000010U);
+	idle_work_stats(0U, 0x00000020U, &stats);
+	assert_int_equal(0x20U, stats.idle_us);
+
+	// Out-of-range core is ignored
+	idle_work_task_switched(IDLE_WORK_CORES, true, 0U);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup(test_jobs_run_in_post_order, setup),
+		cmocka_unit_test_setup(test_pending_job_is_queued_once, setup),
+		cmocka_unit_test_setup(test_full_ring_drops_post, setup),
+		cmocka_unit_test_setup(test_job_can_post_itself, setup),
+		cmocka_unit_test_setup(test_idle_time_follows_the_core, setup),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
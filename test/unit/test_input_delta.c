@@ -0,0 +1,163 @@
+/**
+ * @file test_input_delta.c
+ * @brief Unit tests for the state-delta frame packing
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "commands.h"
+#include "data_event.h"
+#include "input_delta.h"
+
+/**
+ * @brief Unpack the 12-bit value at position @p index of an axis frame.
+ */
+static uint16_t unpack_axis(const uint8_t *frame, uint8_t index)
+{
+	const uint8_t *p = &frame[3U + ((index / 2U) * 3U)];
+	uint16_t value;
+
+	if (0U == (index & 1U))
+	{
+		value = (uint16_t)(((uint16_t)p[0] << 4U) | (p[1] >> 4U));
+	}
+	else
+	{
+		value = (uint16_t)((((uint16_t)p[1] & 0x0FU) << 8U) | p[2]);
+	}
+
+	return value;
+}
+
+static void test_frame_fits_data_event(void **state)
+{
+	(void)state;
+	assert_int_equal(0x0F, PC_STATE_DELTA_CMD);
+	assert_true(INPUT_DELTA_MAX_PAYLOAD <= MAX_DATA_SIZE);
+	assert_int_equal(10U, INPUT_DELTA_AXES_PER_FRAME);
+}
+
+static void test_unchanged_keys_produce_no_frame(void **state)
+{
+	(void)state;
+	uint8_t reported[INPUT_STATE_KEY_BYTES] = {0x10U};
+	const uint8_t current[INPUT_STATE_KEY_BYTES] = {0x10U};
+	uint8_t frame[INPUT_DELTA_MAX_PAYLOAD];
+
+	assert_int_equal(0U, input_delta_encode_keys(reported, current, frame));
+}
+
+static void test_single_key_change(void **state)
+{
+	(void)state;
+	uint8_t reported[INPUT_STATE_KEY_BYTES] = {0};
+	uint8_t current[INPUT_STATE_KEY_BYTES] = {0};
+	uint8_t frame[INPUT_DELTA_MAX_PAYLOAD];
+
+	// Row 2, column 5 pressed
+	input_state_set_key(current, 2U, 5U, true);
+	assert_int_equal(4U, input_delta_encode_keys(reported, current, frame));
+	assert_int_equal(INPUT_DELTA_SECTION_KEYS, frame[0]);
+	assert_int_equal(0x04U, frame[1]);  // bitmap byte 2 present
+	assert_int_equal(0x20U, frame[2]);  // bit 5 of that byte changed
+	assert_int_equal(0x01U, frame[3]);  // now pressed
+	assert_memory_equal(current, reported, sizeof(current));
+
+	// Released again
+	input_state_set_key(current, 2U, 5U, false);
+	assert_int_equal(4U, input_delta_encode_keys(reported, current, frame));
+	assert_int_equal(0x00U, frame[3]);
+}
+
+static void test_all_keys_changed_fit_one_frame(void **state)
+{
+	(void)state;
+	uint8_t reported[INPUT_STATE_KEY_BYTES] = {0};
+	uint8_t current[INPUT_STATE_KEY_BYTES];
+	uint8_t frame[INPUT_DELTA_MAX_PAYLOAD];
+
+	// Alternate bytes pressed so both state values appear
+	(void)memset(current, 0xFF, sizeof(current));
+	for (uint8_t i = 0U; i < INPUT_STATE_KEY_BYTES; i++)
+	{
+		reported[i] = (uint8_t)((0U == (i & 1U)) ? 0x00U : 0xFFU);
+		current[i] = (uint8_t)~reported[i];
+	}
+
+	assert_int_equal(INPUT_DELTA_MAX_PAYLOAD, input_delta_encode_keys(reported, current, frame));
+	assert_int_equal(0xFFU, frame[1]);
+	for (uint8_t i = 0U; i < INPUT_STATE_KEY_BYTES; i++)
+	{
+		assert_int_equal(0xFFU, frame[2U + i]);
+		assert_int_equal(current[i], frame[2U + INPUT_STATE_KEY_BYTES + i]);
+	}
+}
+
+static void test_axes_packed_twelve_bit(void **state)
+{
+	(void)state;
+	uint16_t values[ADC_CHANNELS] = {0};
+	uint16_t pending = (uint16_t)((1U << 1U) | (1U << 4U) | (1U << 15U));
+	uint8_t frame[INPUT_DELTA_MAX_PAYLOAD];
+
+	values[1] = 0x0ABCU;
+	values[4] = 0x0123U;
+	values[15] = 0xFFFFU; // masked to 12 bits
+
+	assert_int_equal(8U, input_delta_encode_axes(&pending, values, frame));
+	assert_int_equal(INPUT_DELTA_SECTION_AXES, frame[0]);
+	assert_int_equal(0x80U, frame[1]);
+	assert_int_equal(0x12U, frame[2]);
+	assert_int_equal(0x0ABCU, unpack_axis(frame, 0U));
+	assert_int_equal(0x0123U, unpack_axis(frame, 1U));
+	assert_int_equal(0x0FFFU, unpack_axis(frame, 2U));
+	assert_int_equal(0U, pending);
+
+	assert_int_equal(0U, input_delta_encode_axes(&pending, values, frame));
+}
+
+static void test_excess_axes_stay_pending(void **state)
+{
+	(void)state;
+	uint16_t values[ADC_CHANNELS];
+	uint16_t pending = 0xFFFFU;
+	uint8_t frame[INPUT_DELTA_MAX_PAYLOAD];
+
+	for (uint8_t i = 0U; i < ADC_CHANNELS; i++)
+	{
+		values[i] = (uint16_t)(i * 0x100U);
+	}
+
+	assert_int_equal(INPUT_DELTA_MAX_PAYLOAD, input_delta_encode_axes(&pending, values, frame));
+	assert_int_equal(0x03U, frame[1]);
+	assert_int_equal(0xFFU, frame[2]);
+	assert_int_equal(0x0900U, unpack_axis(frame, 9U));
+	assert_int_equal(0xFC00U, pending);
+
+	// The remaining six go in the next frame
+	assert_int_equal(12U, input_delta_encode_axes(&pending, values, frame));
+	assert_int_equal(0xFCU, frame[1]);
+	assert_int_equal(0x00U, frame[2]);
+	assert_int_equal(0x0A00U, unpack_axis(frame, 0U));
+	assert_int_equal(0x0F00U, unpack_axis(frame, 5U));
+	assert_int_equal(0U, pending);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_frame_fits_data_event),
+		cmocka_unit_test(test_unchanged_keys_produce_no_frame),
+		cmocka_unit_test(test_single_key_change),
+		cmocka_unit_test(test_all_keys_changed_fit_one_frame),
+		cmocka_unit_test(test_axes_packed_twelve_bit),
+		cmocka_unit_test(test_excess_axes_stay_pending),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_input_dump.c
+ * @brief Unit tests for the state dump packing
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "commands.h"
+#include "data_event.h"
+#include "input_dump.h"
+
+static input_state_t sample_state(void)
+{
+	input_state_t state;
+
+	(void)memset(&state, 0, sizeof(state));
+	state.keypad_sequence = 12U;
+	state.keys[0] = 0x02U;
+	state.keys[7] = 0x80U;
+	state.encoders[0] = 3;
+	state.encoders[7] = -2;
+	for (uint8_t i = 0U; i < ADC_CHANNELS; i++)
+	{
+		state.axes[i] = (uint16_t)(0x100U * i + i);
+	}
+
+	return state;
+}
+
+static uint16_t unpack_axis(const uint8_t *values, uint8_t index)
+{
+	const uint8_t *p = &values[(index / 2U) * 3U];
+
+	return (0U == (index & 1U)) ? (uint16_t)(((uint16_t)p[0] << 4U) | (p[1] >> 4U))
+	                            : (uint16_t)((((uint16_t)p[1] & 0x0FU) << 8U) | p[2]);
+}
+
+static void test_parts_fit_data_event(void **state)
+{
+	(void)state;
+	assert_int_equal(0x1F, PC_STATE_DUMP_CMD);
+	assert_true(INPUT_DUMP_MAX_PAYLOAD <= MAX_DATA_SIZE);
+}
+
+static void test_key_part_carries_flags_uptime_and_keys(void **state)
+{
+	(void)state;
+	const input_state_t snapshot = sample_state();
+	uint8_t out[INPUT_DUMP_MAX_PAYLOAD];
+
+	assert_int_equal(7U + INPUT_STATE_KEY_BYTES, input_dump_encode(&snapshot, 0x01020304U, 0x5AU, 0U, out));
+	assert_int_equal(0x5AU, out[0]);
+	assert_int_equal(0x04U, out[1]);
+	assert_int_equal(INPUT_DUMP_KEYPAD_SCANNED, out[2]);
+	assert_memory_equal(((const uint8_t[]){0x01U, 0x02U, 0x03U, 0x04U}), &out[3], 4U);
+	assert_int_equal(0x02U, out[7]);
+	assert_int_equal(0x80U, out[14]);
+}
+
+static void test_encoder_part_is_signed_big_endian(void **state)
+{
+	(void)state;
+	const input_state_t snapshot = sample_state();
+	uint8_t out[INPUT_DUMP_MAX_PAYLOAD];
+
+	assert_int_equal(INPUT_DUMP_MAX_PAYLOAD, input_dump_encode(&snapshot, 0U, 1U, 1U, out));
+	assert_int_equal(0x14U, out[1]);
+	assert_int_equal(0x00U, out[2]);
+	assert_int_equal(0x03U, out[3]);
+	assert_int_equal(0xFFU, out[16]);
+	assert_int_equal(0xFEU, out[17]);
+}
+
+static void test_axis_parts_cover_every_channel(void **state)
+{
+	(void)state;
+	const input_state_t snapshot = sample_state();
+	uint8_t out[INPUT_DUMP_MAX_PAYLOAD];
+
+	assert_int_equal(17U, input_dump_encode(&snapshot, 0U, 1U, 2U, out));
+	assert_int_equal(0x24U, out[1]);
+	for (uint8_t i = 0U; i < INPUT_DUMP_AXES_FIRST; i++)
+	{
+		assert_int_equal(snapshot.axes[i], unpack_axis(&out[2], i));
+	}
+
+	assert_int_equal(11U, input_dump_encode(&snapshot, 0U, 1U, 3U, out));
+	assert_int_equal(0x34U, out[1]);
+	for (uint8_t i = 0U; i < (ADC_CHANNELS - INPUT_DUMP_AXES_FIRST); i++)
+	{
+		assert_int_equal(snapshot.axes[INPUT_DUMP_AXES_FIRST + i], unpack_axis(&out[2], i));
+	}
+}
+
+static void test_unknown_part_is_empty(void **state)
+{
+	(void)state;
+	const input_state_t snapshot = sample_state();
+	uint8_t out[INPUT_DUMP_MAX_PAYLOAD];
+
+	assert_int_equal(0U, input_dump_encode(&snapshot, 0U, 1U, INPUT_DUMP_PARTS, out));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_parts_fit_data_event),
+		cmocka_unit_test(test_key_part_carries_flags_uptime_and_keys),
+		cmocka_unit_test(test_encoder_part_is_signed_big_endian),
+		cmocka_unit_test(test_axis_parts_cover_every_channel),
+		cmocka_unit_test(test_unknown_part_is_empty),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file test_input_state.c
+ * @brief Unit tests for the latch-published input state
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <cmocka.h>
+
+#include "input_state.h"
+
+/** Publishes done by the writer thread in the concurrency test. */
+#define STRESS_PUBLISHES 200000U
+
+static int setup(void **state)
+{
+	(void)state;
+	input_state_reset();
+	return 0;
+}
+
+static void test_reset_state_is_empty(void **state)
+{
+	(void)state;
+	input_state_t snapshot;
+	(void)memset(&snapshot, 0xA5, sizeof(snapshot));
+
+	input_state_read(&snapshot);
+
+	assert_int_equal(0U, snapshot.keypad_sequence);
+	assert_int_equal(0U, snapshot.adc_sequence);
+	for (uint8_t i = 0U; i < INPUT_STATE_KEY_BYTES; i++)
+	{
+		assert_int_equal(0U, snapshot.keys[i]);
+	}
+	for (uint8_t i = 0U; i < ADC_CHANNELS; i++)
+	{
+		assert_int_equal(0U, snapshot.axes[i]);
+	}
+}
+
+static void test_key_bitmap_helpers(void **state)
+{
+	(void)state;
+	uint8_t keys[INPUT_STATE_KEY_BYTES] = {0};
+	const int32_t encoders[MAX_NUM_ENCODERS] = {0};
+	input_state_t snapshot;
+
+	input_state_set_key(keys, 0U, 0U, true);
+	input_state_set_key(keys, 2U, 5U, true);
+	input_state_set_key(keys, KEYPAD_ROWS - 1U, KEYPAD_COLUMNS - 1U, true);
+	input_state_set_key(keys, 0U, 0U, false);
+	input_state_publish_keypad(keys, encoders, 1234U);
+	input_state_read(&snapshot);
+
+	assert_false(input_state_key_pressed(&snapshot, 0U, 0U));
+	assert_true(input_state_key_pressed(&snapshot, 2U, 5U));
+	assert_false(input_state_key_pressed(&snapshot, 5U, 2U));
+	assert_true(input_state_key_pressed(&snapshot, KEYPAD_ROWS - 1U, KEYPAD_COLUMNS - 1U));
+	assert_int_equal(1234U, snapshot.keypad_scan_us);
+}
+
+static void test_sections_publish_independently(void **state)
+{
+	(void)state;
+	const uint8_t keys[INPUT_STATE_KEY_BYTES] = {0x01U};
+	int32_t encoders[MAX_NUM_ENCODERS] = {0};
+	uint16_t axes[ADC_CHANNELS] = {0};
+	input_state_t snapshot;
+
+	encoders[1] = -3;
+	axes[4] = 2048U;
+
+	input_state_publish_keypad(keys, encoders, 100U);
+	input_state_publish_keypad(keys, encoders, 200U);
+	input_state_publish_adc(axes, 150U);
+	input_state_read(&snapshot);
+
+	assert_int_equal(2U, snapshot.keypad_sequence);
+	assert_int_equal(200U, snapshot.keypad_scan_us);
+	assert_int_equal(-3, snapshot.encoders[1]);
+	assert_int_equal(1U, snapshot.adc_sequence);
+	assert_int_equal(150U, snapshot.adc_scan_us);
+	assert_int_equal(2048U, snapshot.axes[4]);
+
+	// Later publishes replace the whole section
+	axes[4] = 0U;
+	axes[15] = 7U;
+	input_state_publish_adc(axes, 300U);
+	input_state_read(&snapshot);
+
+	assert_int_equal(2U, snapshot.adc_sequence);
+	assert_int_equal(0U, snapshot.axes[4]);
+	assert_int_equal(7U, snapshot.axes[15]);
+	assert_int_equal(2U, snapshot.keypad_sequence);
+}
+
+/**
+ * @brief Writer thread: every field of each publish carries the same value.
+ */
+static void *stress_writer(void *arg)
+{
+	(void)arg;
+	uint16_t axes[ADC_CHANNELS];
+
+	for (uint32_t n = 1U; n <= STRESS_PUBLISHES; n++)
+	{
+		for (uint8_t i = 0U; i < ADC_CHANNELS; i++)
+		{
+			axes[i] = (uint16_t)n;
+		}
+		input_state_publish_adc(axes, n);
+	}
+
+	return NULL;
+}
+
+static void test_reader_never_sees_torn_state(void **state)
+{
+	(void)state;
+	pthread_t writer;
+	input_state_t snapshot;
+	uint32_t last_sequence = 0U;
+
+	assert_int_equal(0, pthread_create(&writer, NULL, stress_writer, NULL));
+
+	do
+	{
+		input_state_read(&snapshot);
+
+		// A snapshot is one publish: sequence, timestamp and axes agree
+		assert_int_equal(snapshot.adc_sequence, snapshot.adc_scan_us);
+		for (uint8_t i = 0U; i < ADC_CHANNELS; i++)
+		{
+			assert_int_equal((uint16_t)snapshot.adc_sequence, snapshot.axes[i]);
+		}
+		assert_true(snapshot.adc_sequence >= last_sequence);
+		last_sequence = snapshot.adc_sequence;
+	} while (last_sequence < STRESS_PUBLISHES);
+
+	assert_int_equal(0, pthread_join(writer, NULL));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_reset_state_is_empty, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_key_bitmap_helpers, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_sections_publish_independently, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_reader_never_sees_torn_state, setup, NULL),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
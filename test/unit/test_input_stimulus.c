@@ -0,0 +1,426 @@
+/**
+ * @file test_input_stimulus.c
+ * @brief Unit tests for the input stimulus models, and the input pipeline driven by them
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "adc_filter.h"
+#include "direct_input.h"
+#include "input_stimulus.h"
+#include "keypad_matrix.h"
+
+/** Matrix position of the bouncing key. */
+#define TEST_KEY_ROW 2U
+#define TEST_KEY_COLUMN 3U
+
+/**
+ * @brief Build an 8x8 profile with one encoder at row 7, columns 0 and 1.
+ */
+static void make_profile(input_profile_t *profile, uint16_t key_settling_time_ms)
+{
+	(void)memset(profile, 0, sizeof(*profile));
+	profile->config.rows = KEYPAD_ROWS;
+	profile->config.columns = KEYPAD_COLUMNS;
+	profile->config.key_settling_time_ms = key_settling_time_ms;
+	profile->config.num_encoders = 1U;
+	profile->config.encoder_map[0] = (encoder_map_t){.row = 7U, .col = 0U, .enabled = true};
+	profile->encoder_skip[7][0] = true;
+	profile->encoder_skip[7][1] = true;
+}
+
+/**
+ * @brief Feed scan frames of a stimulus to the matrix decoder until @p end_us.
+ *
+ * @return Debounced key changes; the time of the first two is stored in @p change_us.
+ */
+static uint32_t run_frames(keypad_matrix_t *matrix, const stim_matrix_t *wiring, uint64_t end_us, uint64_t change_us[2])
+{
+	uint32_t changes = 0U;
+
+	for (uint64_t t_us = 0U; t_us < end_us; t_us += KEYPAD_SCAN_FRAME_US)
+	{
+		uint32_t frame[KEYPAD_SCAN_FRAME_WORDS];
+		int8_t steps[MAX_NUM_ENCODERS];
+
+		stim_matrix_frame(wiring, t_us, frame);
+		uint64_t changed = keypad_matrix_update(matrix, keypad_matrix_pressed(frame), steps);
+		while (0U != changed)
+		{
+			if (changes < 2U)
+			{
+				change_us[changes] = t_us;
+			}
+			changes++;
+			changed &= changed - 1U;
+		}
+	}
+
+	return changes;
+}
+
+static void test_contact_settles_after_bounce(void **state)
+{
+	(void)state;
+	const stim_contact_t contact = {
+		.press_us = 1000U, .release_us = 50000U, .bounce_us = 4000U, .chatter_us = 100U, .seed = 7U};
+	bool opened_in_bounce = false;
+
+	assert_false(stim_contact_closed(&contact, 999U));
+	// Contacts just touched: the first chatter slot reads closed
+	assert_true(stim_contact_closed(&contact, 1000U));
+	for (uint64_t t_us = 1000U; t_us < 5000U; t_us += 10U)
+	{
+		opened_in_bounce = opened_in_bounce || !stim_contact_closed(&contact, t_us);
+	}
+	assert_true(opened_in_bounce);
+	for (uint64_t t_us = 5000U; t_us < 50000U; t_us += 10U)
+	{
+		assert_true(stim_contact_closed(&contact, t_us));
+	}
+	assert_false(stim_contact_closed(&contact, 50000U));
+	assert_false(stim_contact_closed(&contact, 54000U));
+}
+
+static void test_contact_edges_match_levels(void **state)
+{
+	(void)state;
+	const stim_contact_t contact = {
+		.press_us = 1000U, .release_us = 20000U, .bounce_us = 3000U, .chatter_us = 70U, .seed = 3U};
+	uint64_t previous_us = 0U;
+	uint32_t edges = 0U;
+	bool level = false;
+
+	for (uint64_t edge_us = stim_contact_next_edge(&contact, 0U); UINT64_MAX != edge_us;
+	     edge_us = stim_contact_next_edge(&contact, edge_us))
+	{
+		// Level holds between edges and flips at each one
+		assert_true(edge_us > previous_us);
+		assert_int_equal(level, stim_contact_closed(&contact, edge_us - 1U));
+		level = !level;
+		assert_int_equal(level, stim_contact_closed(&contact, edge_us));
+		previous_us = edge_us;
+		edges++;
+	}
+
+	// Odd edge counts per transition: closed after the press, open after the release
+	assert_true(edges > 2U);
+	assert_int_equal(0U, edges % 2U);
+	assert_false(level);
+	assert_true(previous_us < (20000U + 3000U));
+}
+
+static void test_encoder_edges_follow_speed(void **state)
+{
+	(void)state;
+	const stim_encoder_t clockwise = {
+		.start_us = 0U, .stop_us = UINT64_MAX, .rpm = 60, .detents_per_rev = 24U, .jitter_pct = 0U, .seed = 1U};
+	const stim_encoder_t counter = {
+		.start_us = 0U, .stop_us = 500000U, .rpm = -60, .detents_per_rev = 24U, .jitter_pct = 0U, .seed = 1U};
+
+	// One revolution per second
+	assert_int_equal(24, stim_encoder_detents(&clockwise, 1000000U));
+	assert_int_equal(-12, stim_encoder_detents(&counter, 1000000U));
+	assert_int_equal(0U, stim_encoder_phase(&clockwise, 0U));
+	// Clockwise closes B first, the direction the matrix decoder counts as positive
+	assert_int_equal(2U, stim_encoder_phase(&clockwise, 15000U));
+	assert_int_equal(1U, stim_encoder_phase(&counter, 15000U));
+}
+
+static void test_encoder_jitter_keeps_gray_sequence(void **state)
+{
+	(void)state;
+	const stim_encoder_t encoder = {
+		.start_us = 0U, .stop_us = UINT64_MAX, .rpm = 300, .detents_per_rev = 20U, .jitter_pct = 90U, .seed = 11U};
+	uint8_t previous = stim_encoder_phase(&encoder, 0U);
+	uint32_t changes = 0U;
+
+	for (uint64_t t_us = 1U; t_us < 200000U; t_us++)
+	{
+		const uint8_t phase = stim_encoder_phase(&encoder, t_us);
+		if (phase != previous)
+		{
+			// One channel changes at a time
+			const uint8_t flipped = (uint8_t)(phase ^ previous);
+			assert_true((1U == flipped) || (2U == flipped));
+			changes++;
+		}
+		previous = phase;
+	}
+
+	assert_int_equal(stim_encoder_edges(&encoder, 199999U), changes);
+}
+
+static void test_mux_settles_through_rc(void **state)
+{
+	(void)state;
+	stim_mux_t mux;
+
+	stim_mux_init(&mux, 10000U, 0U, 1U);
+	mux.level[1] = 4000U;
+	stim_mux_select(&mux, 1U, 100U);
+
+	// 1 - 1/e of the step after one time constant, settled after ten
+	assert_int_equal(0U, stim_mux_sample(&mux, 100U));
+	assert_int_equal(2528U, stim_mux_sample(&mux, 110U));
+	assert_int_equal(4000U, stim_mux_sample(&mux, 200U));
+
+	// Switching back discharges from the present node voltage (3999.8 LSB)
+	stim_mux_select(&mux, 0U, 200U);
+	assert_int_equal(1471U, stim_mux_sample(&mux, 210U));
+}
+
+static void test_mux_noise_has_configured_spread(void **state)
+{
+	(void)state;
+	stim_mux_t mux;
+	double sum = 0.0;
+	double sum_squares = 0.0;
+	const uint32_t samples = 4000U;
+
+	stim_mux_init(&mux, 0U, 4U, 5U);
+	mux.level[0] = 2048U;
+	stim_mux_select(&mux, 0U, 0U);
+	for (uint32_t i = 0U; i < samples; i++)
+	{
+		const double reading = (double)stim_mux_sample(&mux, i);
+		sum += reading;
+		sum_squares += reading * reading;
+	}
+
+	const double mean = sum / samples;
+	const double deviation = sqrt((sum_squares / samples) - (mean * mean));
+	assert_true(fabs(mean - 2048.0) < 0.5);
+	assert_true((deviation > 3.5) && (deviation < 4.5));
+}
+
+static void test_keypad_press_latency_by_settling_time(void **state)
+{
+	(void)state;
+	const stim_contact_t key = {
+		.press_us = 10000U, .release_us = 60000U, .bounce_us = 3000U, .chatter_us = 100U, .seed = 42U};
+	stim_matrix_t wiring = {0};
+	const uint16_t settling_ms[] = {1U, 2U, 5U};
+
+	wiring.keys[keypad_matrix_position(TEST_KEY_ROW, TEST_KEY_COLUMN)] = &key;
+
+	for (size_t i = 0U; i < (sizeof(settling_ms) / sizeof(settling_ms[0])); i++)
+	{
+		input_profile_t profile;
+		keypad_matrix_t matrix;
+		uint64_t change_us[2] = {0U, 0U};
+
+		make_profile(&profile, settling_ms[i]);
+		keypad_matrix_reset(&matrix, &profile, KEYPAD_SCAN_FRAME_US);
+		const uint64_t window_us = (uint64_t)matrix.debounce_frames * KEYPAD_SCAN_FRAME_US;
+
+		// One press and one release, however long the contact bounced
+		assert_int_equal(2U, run_frames(&matrix, &wiring, 100000U, change_us));
+		assert_false(0U != (matrix.stable & (1ULL << keypad_matrix_position(TEST_KEY_ROW, TEST_KEY_COLUMN))));
+
+		// Reported once the new level held a full window, no later than the end of the bounce plus a window
+		const uint64_t press_latency_us = change_us[0] - key.press_us;
+		const uint64_t release_latency_us = change_us[1] - key.release_us;
+		assert_true(press_latency_us >= (window_us - KEYPAD_SCAN_FRAME_US));
+		assert_true(press_latency_us <= (key.bounce_us + window_us + KEYPAD_SCAN_FRAME_US));
+		assert_true(release_latency_us >= (window_us - KEYPAD_SCAN_FRAME_US));
+		assert_true(release_latency_us <= (key.bounce_us + window_us + KEYPAD_SCAN_FRAME_US));
+	}
+}
+
+static void test_encoder_missed_detents_by_speed(void **state)
+{
+	(void)state;
+	input_profile_t profile;
+	keypad_matrix_t matrix;
+	stim_matrix_t wiring = {0};
+	uint64_t change_us[2];
+	stim_encoder_t encoder = {
+		.start_us = 0U, .stop_us = UINT64_MAX, .detents_per_rev = 24U, .jitter_pct = 20U, .seed = 9U};
+
+	make_profile(&profile, 2U);
+	wiring.encoders[0] = &encoder;
+	wiring.encoder_map[0] = profile.config.encoder_map[0];
+
+	// Edges far apart compared to the frame period: every detent counted
+	encoder.rpm = 1200;
+	keypad_matrix_reset(&matrix, &profile, KEYPAD_SCAN_FRAME_US);
+	(void)run_frames(&matrix, &wiring, 1000000U, change_us);
+	assert_int_equal(stim_encoder_detents(&encoder, 1000000U - KEYPAD_SCAN_FRAME_US), matrix.detents[0]);
+
+	encoder.rpm = -600;
+	keypad_matrix_reset(&matrix, &profile, KEYPAD_SCAN_FRAME_US);
+	(void)run_frames(&matrix, &wiring, 1000000U, change_us);
+	assert_int_equal(stim_encoder_detents(&encoder, 1000000U - KEYPAD_SCAN_FRAME_US), matrix.detents[0]);
+
+	// Edges closer than a frame: whole quadrature states are skipped and detents lost
+	encoder.rpm = 3000;
+	keypad_matrix_reset(&matrix, &profile, KEYPAD_SCAN_FRAME_US);
+	(void)run_frames(&matrix, &wiring, 1000000U, change_us);
+	assert_true(matrix.detents[0] < stim_encoder_detents(&encoder, 1000000U - KEYPAD_SCAN_FRAME_US));
+}
+
+/**
+ * @brief Scan two axes the way adc_read_task does until @p end_us.
+ *
+ * @return Last value reported for channel 0; the time it was reported is stored in @p reported_us.
+ */
+static uint16_t run_axes(adc_states_t *states, const input_config_t *config, uint64_t end_us, uint64_t *reported_us)
+{
+	while (stim_bench_now_us() < end_us)
+	{
+		for (uint8_t chan = 0U; chan < 2U; chan++)
+		{
+			const uint16_t raw = adc_sample_channel(chan, config->adc_settling_us, config->adc_oversample);
+			const uint16_t filtered = adc_filter_update(states, chan, raw);
+			if (adc_should_emit(states->adc_previous_value[chan], filtered, config->adc_hysteresis))
+			{
+				states->adc_previous_value[chan] = filtered;
+				if (0U == chan)
+				{
+					*reported_us = stim_bench_now_us();
+				}
+			}
+		}
+		stim_bench_advance_us((uint64_t)config->adc_scan_interval_ms * 1000U);
+	}
+
+	return states->adc_previous_value[0];
+}
+
+static void test_adc_axis_lag_with_default_filter(void **state)
+{
+	(void)state;
+	const input_config_t *config = input_default_config();
+	stim_mux_t mux;
+	adc_states_t states;
+	uint64_t reported_us = 0U;
+
+	// 10 kΩ pot into the sample-and-hold: tau 0.5 µs, plus 2 LSB of noise
+	stim_mux_init(&mux, 500U, 2U, 3U);
+	mux.level[0] = 1000U;
+	mux.level[1] = 3000U;
+	adc_filter_reset(&states);
+	stim_bench_attach(&mux, NULL, 0U);
+
+	(void)run_axes(&states, config, 50000U, &reported_us);
+	assert_true(abs((int)states.adc_previous_value[0] - 1000) <= (int)config->adc_hysteresis);
+	assert_true(abs((int)states.adc_previous_value[1] - 3000) <= (int)config->adc_hysteresis);
+
+	// Step the axis and measure how long until it is reported within the deadband
+	const uint64_t step_us = stim_bench_now_us();
+	mux.level[0] = 2000U;
+	const uint16_t reported = run_axes(&states, config, step_us + 50000U, &reported_us);
+	stim_bench_detach();
+
+	const uint64_t scan_us = ((uint64_t)config->adc_scan_interval_ms * 1000U) +
+	                         (2U * (config->adc_settling_us + (config->adc_oversample * STIM_ADC_CONVERSION_US)));
+	assert_true(abs((int)reported - 2000) <= (int)config->adc_hysteresis);
+	assert_true(reported_us > step_us);
+	assert_true((reported_us - step_us) <= ((ADC_NUM_TAPS + 1U) * scan_us));
+}
+
+static void test_adc_short_settling_shows_crosstalk(void **state)
+{
+	(void)state;
+	input_config_t config = *input_default_config();
+	stim_mux_t mux;
+	adc_states_t states;
+	uint64_t reported_us = 0U;
+
+	// High-impedance source: tau 20 µs
+	stim_mux_init(&mux, 20000U, 0U, 3U);
+	mux.level[0] = 0U;
+	mux.level[1] = 4000U;
+
+	adc_filter_reset(&states);
+	stim_bench_attach(&mux, NULL, 0U);
+	(void)run_axes(&states, &config, 20000U, &reported_us);
+	const uint16_t settled = states.adc_previous_value[1];
+
+	config.adc_settling_us = 5U;
+	adc_filter_reset(&states);
+	(void)run_axes(&states, &config, 40000U, &reported_us);
+	const uint16_t rushed = states.adc_previous_value[1];
+	stim_bench_detach();
+
+	// Default settling reads the axis; a few µs leave it pulled towards channel 0
+	assert_true(abs((int)settled - 4000) <= (int)config.adc_hysteresis);
+	assert_true(rushed < (4000U - 1000U));
+}
+
+static void test_direct_input_reports_bouncing_button_once(void **state)
+{
+	(void)state;
+	const stim_contact_t button = {
+		.press_us = 1000U, .release_us = 30000U, .bounce_us = 2000U, .chatter_us = 50U, .seed = 5U};
+	direct_input_state_t input = {0};
+	uint64_t alarm_us = UINT64_MAX;
+	uint64_t reported_us[2] = {0U, 0U};
+	uint32_t reports = 0U;
+	uint64_t t_us = 0U;
+
+	// Deliver each edge as the GPIO interrupt would, and each lockout alarm
+	while (true)
+	{
+		const uint64_t edge_us = stim_contact_next_edge(&button, t_us);
+		bool report = false;
+
+		if ((UINT64_MAX == edge_us) && (UINT64_MAX == alarm_us))
+		{
+			break;
+		}
+		if (alarm_us <= edge_us)
+		{
+			t_us = alarm_us;
+			alarm_us = UINT64_MAX;
+			report = direct_input_lockout_end(&input, stim_contact_closed(&button, t_us), (uint32_t)t_us);
+		}
+		else
+		{
+			t_us = edge_us;
+			report = direct_input_edge(&input, stim_contact_closed(&button, t_us), (uint32_t)t_us);
+		}
+		if (report)
+		{
+			if (reports < 2U)
+			{
+				reported_us[reports] = t_us;
+			}
+			reports++;
+			alarm_us = t_us + DIRECT_INPUT_LOCKOUT_US;
+		}
+	}
+
+	// Press and release each reported on their first edge
+	assert_int_equal(2U, reports);
+	assert_int_equal(button.press_us, reported_us[0]);
+	assert_int_equal(button.release_us, reported_us[1]);
+	assert_false(input.pressed);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_contact_settles_after_bounce),
+		cmocka_unit_test(test_contact_edges_match_levels),
+		cmocka_unit_test(test_encoder_edges_follow_speed),
+		cmocka_unit_test(test_encoder_jitter_keeps_gray_sequence),
+		cmocka_unit_test(test_mux_settles_through_rc),
+		cmocka_unit_test(test_mux_noise_has_configured_spread),
+		cmocka_unit_test(test_keypad_press_latency_by_settling_time),
+		cmocka_unit_test(test_encoder_missed_detents_by_speed),
+		cmocka_unit_test(test_adc_axis_lag_with_default_filter),
+		cmocka_unit_test(test_adc_short_settling_shows_crosstalk),
+		cmocka_unit_test(test_direct_input_reports_bouncing_button_once),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -13,6 +13,7 @@
 #include "error_management.h"
 #include "app_context.h"
 #include "app_inputs.h"
+#include "app_outputs.h"
 
 // -----------------------------------------------------------------------------
 // Queue wrapper state
@@ -261,6 +262,98 @@ static void test_input_is_encoder_position_getter(void **state)
 /**
  * @brief Hysteresis disabled (0): any non-equal value should emit.
  */
+static void test_input_config_set_field_rejects_unknown_and_wide_values(void **state)
+{
+    (void)state;
+
+    input_config_t config = *input_default_config();
+
+    assert_int_equal(INPUT_OK, input_config_set_field(&config, INPUT_FIELD_ADC_HYSTERESIS, 300U));
+    assert_int_equal(300U, config.adc_hysteresis);
+    assert_int_equal(INPUT_OK, input_config_set_field(&config, INPUT_FIELD_ROWS, 4U));
+    assert_int_equal(4U, config.rows);
+    assert_int_equal(INPUT_INVALID_CONFIG, input_config_set_field(&config, INPUT_FIELD_COLUMNS, 0x100U));
+    assert_int_equal(INPUT_INVALID_CONFIG, input_config_set_field(&config, 0xFFU, 1U));
+    assert_int_equal(INPUT_INVALID_CONFIG, input_config_set_field(NULL, INPUT_FIELD_ROWS, 1U));
+}
+
+static void test_input_profile_switch_replaces_encoder_skip(void **state)
+{
+    (void)state;
+
+    static input_profile_t profile;
+
+    assert_int_equal(INPUT_OK, input_init());
+
+    profile.config = *input_default_config();
+    profile.config.num_encoders = 1U;
+    profile.config.encoder_map[0].row = 2U;
+    assert_int_equal(INPUT_OK, input_prepare_profile(&profile));
+    assert_false(input_profile_in_use(&profile));
+
+    assert_int_equal(INPUT_OK, input_set_active_profile(&profile));
+    assert_true(input_profile_in_use(&profile));
+    assert_true(input_is_encoder_position(2U, 0U));
+    assert_false(input_is_encoder_position(7U, 0U));
+    assert_false(input_is_encoder_position(7U, 2U));
+
+    // Invalid profiles are refused before they can be published
+    profile.config.columns = KEYPAD_MAX_COLS + 1U;
+    assert_int_equal(INPUT_INVALID_CONFIG, input_prepare_profile(&profile));
+    assert_int_equal(INPUT_INVALID_CONFIG, input_set_active_profile(NULL));
+
+    // Re-initialising restores the compile-time defaults
+    assert_int_equal(INPUT_OK, input_init());
+    assert_true(input_is_encoder_position(7U, 0U));
+}
+
+static void test_input_report_mode_selection(void **state)
+{
+    (void)state;
+
+    assert_int_equal(INPUT_REPORT_EVENTS, input_report_mode());
+    assert_int_equal(INPUT_OK, input_set_report_mode(INPUT_REPORT_DELTA));
+    assert_int_equal(INPUT_REPORT_DELTA, input_report_mode());
+
+    // Unknown modes leave the selection unchanged
+    assert_int_equal(INPUT_INVALID_CONFIG, input_set_report_mode(0x02U));
+    assert_int_equal(INPUT_REPORT_DELTA, input_report_mode());
+
+    assert_int_equal(INPUT_OK, input_set_report_mode(INPUT_REPORT_EVENTS));
+    assert_int_equal(INPUT_REPORT_EVENTS, input_report_mode());
+}
+
+/**
+ * @brief Direct inputs must sit on GPIOs no other function claims.
+ */
+static void test_direct_input_pins_unassigned(void **state)
+{
+    (void)state;
+    const uint8_t pins[DIRECT_INPUT_COUNT] = DIRECT_INPUT_PINS;
+    const uint32_t used_mask = (1UL << KEYPAD_COL_MUX_A) | (1UL << KEYPAD_COL_MUX_B) |
+                               (1UL << KEYPAD_COL_MUX_C) | (1UL << KEYPAD_COL_MUX_CS) |
+                               (1UL << KEYPAD_ROW_INPUT) | (1UL << KEYPAD_ROW_MUX_A) |
+                               (1UL << KEYPAD_ROW_MUX_B) | (1UL << KEYPAD_ROW_MUX_C) |
+                               (1UL << KEYPAD_ROW_MUX_CS) | (1UL << ADC_MUX_A) |
+                               (1UL << ADC_MUX_B) | (1UL << ADC_MUX_C) | (1UL << ADC_MUX_D) |
+                               (1UL << 26U) | /* ADC input */
+                               (1UL << SPI_MUX_A_PIN) | (1UL << SPI_MUX_B_PIN) |
+                               (1UL << SPI_MUX_C_PIN) | (1UL << SPI_MUX_CS) |
+                               (1UL << PICO_DEFAULT_SPI_RX_PIN) | (1UL << PICO_DEFAULT_SPI_TX_PIN) |
+                               (1UL << PICO_DEFAULT_SPI_SCK_PIN) | (1UL << PWM_PIN) |
+                               (1UL << UART0_TX_PIN) | (1UL << UART0_RX_PIN) |
+                               (1UL << PICO_DEFAULT_LED_PIN);
+    uint32_t direct_mask = 0U;
+
+    for (uint8_t i = 0U; i < DIRECT_INPUT_COUNT; i++)
+    {
+        assert_true(pins[i] < NUM_GPIO);
+        assert_int_equal(0U, used_mask & (1UL << pins[i]));
+        assert_int_equal(0U, direct_mask & (1UL << pins[i]));
+        direct_mask |= (1UL << pins[i]);
+    }
+}
+
 static void test_adc_should_emit_legacy_no_hysteresis(void **state)
 {
     (void)state;
@@ -340,6 +433,10 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_encoder_skip_built_from_default_config, setup, teardown),
         cmocka_unit_test_setup_teardown(test_encoder_non_encoder_positions_not_skipped, setup, teardown),
         cmocka_unit_test_setup_teardown(test_input_is_encoder_position_getter, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_input_config_set_field_rejects_unknown_and_wide_values, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_input_profile_switch_replaces_encoder_skip, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_input_report_mode_selection, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_direct_input_pins_unassigned, setup, teardown),
         cmocka_unit_test_setup_teardown(test_adc_should_emit_legacy_no_hysteresis, setup, teardown),
         cmocka_unit_test_setup_teardown(test_adc_should_emit_symmetric_deadband, setup, teardown),
         cmocka_unit_test_setup_teardown(test_adc_should_emit_handles_range_boundaries, setup, teardown),
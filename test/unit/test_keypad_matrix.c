@@ -0,0 +1,238 @@
+/**
+ * @file test_keypad_matrix.c
+ * @brief Unit tests for the keypad frame debounce, encoder decode and scan table
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "keypad_matrix.h"
+
+/** Debounce frames used by the recorded sequences below. */
+#define TEST_DEBOUNCE_FRAMES 4U
+
+/**
+ * @brief Build an 8x8 profile with the given encoders (all other positions are keys).
+ */
+static void make_profile(input_profile_t *profile, const encoder_map_t *encoders, uint8_t num_encoders)
+{
+	(void)memset(profile, 0, sizeof(*profile));
+	profile->config.rows = KEYPAD_ROWS;
+	profile->config.columns = KEYPAD_COLUMNS;
+	profile->config.key_settling_time_ms = 2U;
+	profile->config.num_encoders = num_encoders;
+	for (uint8_t i = 0U; i < num_encoders; i++)
+	{
+		profile->config.encoder_map[i] = encoders[i];
+		profile->encoder_skip[encoders[i].row][encoders[i].col] = true;
+		profile->encoder_skip[encoders[i].row][encoders[i].col + 1U] = true;
+	}
+}
+
+/**
+ * @brief Feed a pressed-key bitmap the way the PIO would record it (active low).
+ */
+static uint64_t feed(keypad_matrix_t *matrix, uint64_t pressed, int8_t steps[MAX_NUM_ENCODERS])
+{
+	const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS] = {(uint32_t)~pressed, (uint32_t)(~pressed >> 32U)};
+
+	return keypad_matrix_update(matrix, keypad_matrix_pressed(frame), steps);
+}
+
+static void test_frame_bits_follow_key_bitmap_layout(void **state)
+{
+	(void)state;
+	// Row 2, column 5 pressed: everything else reads high
+	const uint32_t frame[KEYPAD_SCAN_FRAME_WORDS] = {0xFFDFFFFFUL, 0xFFFFFFFFUL};
+	uint8_t bitmap[INPUT_STATE_KEY_BYTES] = {0};
+	uint8_t expected[INPUT_STATE_KEY_BYTES] = {0};
+
+	const uint64_t pressed = keypad_matrix_pressed(frame);
+	assert_true(pressed == (1ULL << keypad_matrix_position(2U, 5U)));
+
+	keypad_matrix_to_bytes(pressed, bitmap);
+	input_state_set_key(expected, 2U, 5U, true);
+	assert_memory_equal(expected, bitmap, sizeof(expected));
+}
+
+static void test_press_reported_after_debounce(void **state)
+{
+	(void)state;
+	input_profile_t profile;
+	keypad_matrix_t matrix;
+	int8_t steps[MAX_NUM_ENCODERS];
+	const uint64_t key = 1ULL << keypad_matrix_position(0U, 3U);
+
+	make_profile(&profile, NULL, 0U);
+	keypad_matrix_reset(&matrix, &profile, 1000U);
+	assert_int_equal(TEST_DEBOUNCE_FRAMES, matrix.debounce_frames);
+
+	// Idle frames: nothing moves
+	assert_true(0U == feed(&matrix, 0U, steps));
+
+	for (uint8_t i = 1U; i < TEST_DEBOUNCE_FRAMES; i++)
+	{
+		assert_true(0U == feed(&matrix, key, steps));
+	}
+	assert_true(key == feed(&matrix, key, steps));
+	assert_true(key == matrix.stable);
+
+	// Held: reported once
+	assert_true(0U == feed(&matrix, key, steps));
+
+	for (uint8_t i = 1U; i < TEST_DEBOUNCE_FRAMES; i++)
+	{
+		assert_true(0U == feed(&matrix, 0U, steps));
+	}
+	assert_true(key == feed(&matrix, 0U, steps));
+	assert_true(0U == matrix.stable);
+}
+
+static void test_bounce_restarts_debounce(void **state)
+{
+	(void)state;
+	input_profile_t profile;
+	keypad_matrix_t matrix;
+	int8_t steps[MAX_NUM_ENCODERS];
+	const uint64_t key = 1ULL << keypad_matrix_position(4U, 4U);
+	// Recorded contact bounce, one bitmap per frame, then a clean press
+	const uint64_t frames[] = {key, key, 0U, key, 0U, key, key, key, key};
+
+	make_profile(&profile, NULL, 0U);
+	keypad_matrix_reset(&matrix, &profile, 1000U);
+
+	for (size_t i = 0U; i < (sizeof(frames) / sizeof(frames[0])) - 1U; i++)
+	{
+		assert_true(0U == feed(&matrix, frames[i], steps));
+	}
+	assert_true(key == feed(&matrix, frames[8], steps));
+}
+
+static void test_disabled_positions_ignored(void **state)
+{
+	(void)state;
+	input_profile_t profile;
+	keypad_matrix_t matrix;
+	int8_t steps[MAX_NUM_ENCODERS];
+	const encoder_map_t encoder = {.row = 7U, .col = 0U, .enabled = true};
+
+	make_profile(&profile, &encoder, 1U);
+	profile.config.columns = 6U;
+	keypad_matrix_reset(&matrix, &profile, 1000U);
+
+	// Encoder channels and columns beyond the configured matrix
+	const uint64_t ignored = (1ULL << keypad_matrix_position(7U, 0U)) |
+	                         (1ULL << keypad_matrix_position(7U, 1U)) |
+	                         (1ULL << keypad_matrix_position(0U, 6U)) |
+	                         (1ULL << keypad_matrix_position(3U, 7U));
+	assert_true(0U == (matrix.enabled & ignored));
+
+	for (uint8_t i = 0U; i < (2U * TEST_DEBOUNCE_FRAMES); i++)
+	{
+		assert_true(0U == feed(&matrix, ignored, steps));
+	}
+	assert_true(0U == matrix.stable);
+}
+
+static void test_encoder_detents_from_frames(void **state)
+{
+	(void)state;
+	input_profile_t profile;
+	keypad_matrix_t matrix;
+	int8_t steps[MAX_NUM_ENCODERS];
+	const encoder_map_t encoders[2] = {
+		{.row = 7U, .col = 0U, .enabled = true},
+		{.row = 7U, .col = 2U, .enabled = true},
+	};
+	const uint64_t a = 1ULL << keypad_matrix_position(7U, 2U);
+	const uint64_t b = 1ULL << keypad_matrix_position(7U, 3U);
+	// One detent on encoder 1 with channel B leading: 00 -> 10 -> 11 -> 01 -> 00 (B:A)
+	const uint64_t clockwise[] = {b, a | b, a, 0U};
+	const uint64_t counter_clockwise[] = {a, a | b, b, 0U};
+
+	make_profile(&profile, encoders, 2U);
+	keypad_matrix_reset(&matrix, &profile, 1000U);
+	(void)feed(&matrix, 0U, steps);
+
+	for (size_t i = 0U; i < 3U; i++)
+	{
+		(void)feed(&matrix, clockwise[i], steps);
+		assert_int_equal(0, steps[1]);
+	}
+	(void)feed(&matrix, clockwise[3], steps);
+	assert_int_equal(0, steps[0]);
+	assert_int_equal(1, steps[1]);
+	assert_int_equal(1, matrix.detents[1]);
+
+	for (size_t i = 0U; i < 4U; i++)
+	{
+		(void)feed(&matrix, counter_clockwise[i], steps);
+	}
+	assert_int_equal(-1, steps[1]);
+	assert_int_equal(0, matrix.detents[1]);
+
+	// Encoder channels never show up as keys
+	assert_true(0U == matrix.stable);
+}
+
+static void test_debounce_frames_keep_window(void **state)
+{
+	(void)state;
+
+	// Default: 2 ms settling, two stable samples, 250 µs frames
+	assert_int_equal(16U, keypad_matrix_debounce_frames(2U, KEYPAD_SCAN_FRAME_US));
+	// Partial frames round up
+	assert_int_equal(3U, keypad_matrix_debounce_frames(1U, 900U));
+	assert_int_equal(KEYPAD_MATRIX_MAX_DEBOUNCE_FRAMES, keypad_matrix_debounce_frames(1000U, KEYPAD_SCAN_FRAME_US));
+	assert_int_equal(1U, keypad_matrix_debounce_frames(0U, KEYPAD_SCAN_FRAME_US));
+}
+
+static void test_scan_table_selects_and_timing(void **state)
+{
+	(void)state;
+	uint32_t table[KEYPAD_MATRIX_POSITIONS];
+	const uint32_t select_mask = (1UL << KEYPAD_SCAN_SETTLE_SHIFT) - 1UL;
+	uint32_t cycles = 0U;
+
+	keypad_matrix_build_scan(table, 1U, 1U, KEYPAD_SCAN_FRAME_US);
+
+	// Row 5 (A and C high), column 3 (A and B high), row MUX enable low
+	const uint32_t select = table[keypad_matrix_position(5U, 3U)] & select_mask;
+	assert_int_equal((1UL << KEYPAD_ROW_MUX_A) | (1UL << KEYPAD_ROW_MUX_C) |
+	                 (1UL << KEYPAD_COL_MUX_A) | (1UL << KEYPAD_COL_MUX_B), select << KEYPAD_SCAN_OUT_BASE);
+	assert_int_equal(0U, table[0] & select_mask);
+
+	// Column change: 1 µs; row change adds 1 µs; two cycles of every settle are fixed instructions
+	assert_int_equal(8U, table[keypad_matrix_position(5U, 3U)] >> KEYPAD_SCAN_SETTLE_SHIFT);
+	assert_int_equal(18U, table[keypad_matrix_position(5U, 0U)] >> KEYPAD_SCAN_SETTLE_SHIFT);
+
+	// The idle time at the first position pads the frame to its period
+	for (uint8_t i = 0U; i < KEYPAD_MATRIX_POSITIONS; i++)
+	{
+		cycles += (table[i] >> KEYPAD_SCAN_SETTLE_SHIFT) + KEYPAD_SCAN_FIXED_CYCLES;
+	}
+	assert_int_equal(KEYPAD_SCAN_FRAME_US * KEYPAD_SCAN_CYCLES_PER_US, cycles);
+
+	// A scan longer than the period is not padded
+	keypad_matrix_build_scan(table, 10U, 1U, KEYPAD_SCAN_FRAME_US);
+	assert_int_equal(108U, table[0] >> KEYPAD_SCAN_SETTLE_SHIFT);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_frame_bits_follow_key_bitmap_layout),
+		cmocka_unit_test(test_press_reported_after_debounce),
+		cmocka_unit_test(test_bounce_restarts_debounce),
+		cmocka_unit_test(test_disabled_positions_ignored),
+		cmocka_unit_test(test_encoder_detents_from_frames),
+		cmocka_unit_test(test_debounce_frames_keep_window),
+		cmocka_unit_test(test_scan_table_selects_and_timing),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
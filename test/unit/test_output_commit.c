@@ -0,0 +1,121 @@
+/**
+ * @file test_output_commit.c
+ * @brief Unit tests for output commands staged for a device time
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "commands.h"
+#include "output_commit.h"
+
+static void test_due_commands_commit_together_in_arrival_order(void **state)
+{
+	(void)state;
+	static output_commit_queue_t queue;
+	output_commit_entry_t due[OUTPUT_COMMIT_DEPTH];
+	const uint8_t digits[] = {0x20U, 0x12U, 0x34U, 0x56U, 0x78U, 0xFFU};
+	const uint8_t leds[] = {0x02U, 0x00U, 0x81U};
+	const uint8_t duty[] = {0x80U};
+	uint32_t apply_us = 0U;
+
+	output_commit_queue_init(&queue);
+	assert_false(output_commit_queue_next(&queue, 0U, &apply_us));
+
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0U, 2000U, PC_PWM_CMD, duty, sizeof(duty)));
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0U, 1000U, PC_DPYCTL_CMD, digits, sizeof(digits)));
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0U, 1000U, PC_LEDOUT_CMD, leds, sizeof(leds)));
+
+	assert_true(output_commit_queue_next(&queue, 0U, &apply_us));
+	assert_int_equal(1000U, apply_us);
+	assert_int_equal(0U, output_commit_queue_take_due(&queue, 999U, due));
+
+	// Both commands of the first apply time, as they arrived
+	assert_int_equal(2U, output_commit_queue_take_due(&queue, 1000U, due));
+	assert_int_equal(PC_DPYCTL_CMD, due[0].command);
+	assert_int_equal(sizeof(digits), due[0].length);
+	assert_memory_equal(digits, due[0].payload, sizeof(digits));
+	assert_int_equal(PC_LEDOUT_CMD, due[1].command);
+	assert_memory_equal(leds, due[1].payload, sizeof(leds));
+
+	assert_int_equal(1U, queue.count);
+	assert_true(output_commit_queue_next(&queue, 1000U, &apply_us));
+	assert_int_equal(2000U, apply_us);
+	assert_int_equal(1U, output_commit_queue_take_due(&queue, 2000U, due));
+	assert_int_equal(PC_PWM_CMD, due[0].command);
+	assert_int_equal(3U, queue.committed);
+	assert_int_equal(0U, queue.late);
+	assert_false(output_commit_queue_next(&queue, 2000U, &apply_us));
+}
+
+static void test_stage_rejects_bad_commands(void **state)
+{
+	(void)state;
+	static output_commit_queue_t queue;
+	uint8_t payload[OUTPUT_COMMIT_MAX_PAYLOAD + 1U] = {0};
+
+	output_commit_queue_init(&queue);
+	assert_int_equal(OUTPUT_COMMIT_ERR_INVALID, output_commit_queue_stage(&queue, 0U, 10U, PC_SCENE_CMD, payload, 2U));
+	assert_int_equal(OUTPUT_COMMIT_ERR_INVALID, output_commit_queue_stage(&queue, 0U, 10U, PC_PWM_CMD, payload, 0U));
+	assert_int_equal(OUTPUT_COMMIT_ERR_INVALID, output_commit_queue_stage(&queue, 0U, 10U, PC_PWM_CMD, NULL, 1U));
+	assert_int_equal(OUTPUT_COMMIT_ERR_INVALID,
+	                 output_commit_queue_stage(&queue, 0U, 10U, PC_LEDOUT_CMD, payload, sizeof(payload)));
+	assert_int_equal(OUTPUT_COMMIT_OK,
+	                 output_commit_queue_stage(&queue, 0U, 10U, PC_LEDOUT_CMD, payload, OUTPUT_COMMIT_MAX_PAYLOAD));
+
+	// A stale clock offset must not park an output for long
+	assert_int_equal(OUTPUT_COMMIT_ERR_TOO_FAR,
+	                 output_commit_queue_stage(&queue, 500U, 501U + OUTPUT_COMMIT_MAX_LEAD_US, PC_PWM_CMD, payload, 1U));
+	assert_int_equal(OUTPUT_COMMIT_OK,
+	                 output_commit_queue_stage(&queue, 500U, 500U + OUTPUT_COMMIT_MAX_LEAD_US, PC_PWM_CMD, payload, 1U));
+
+	while (queue.count < (uint8_t)OUTPUT_COMMIT_DEPTH)
+	{
+		assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0U, 20U, PC_PWM_CMD, payload, 1U));
+	}
+	assert_int_equal(OUTPUT_COMMIT_ERR_FULL, output_commit_queue_stage(&queue, 0U, 20U, PC_PWM_CMD, payload, 1U));
+}
+
+static void test_clock_wrap_and_late_commits(void **state)
+{
+	(void)state;
+	static output_commit_queue_t queue;
+	output_commit_entry_t due[OUTPUT_COMMIT_DEPTH];
+	const uint8_t duty[] = {0x10U};
+	uint32_t apply_us = 0U;
+
+	output_commit_queue_init(&queue);
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0xFFFFFF00U, 0x00000100U, PC_PWM_CMD, duty, 1U));
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 0xFFFFFF00U, 0xFFFFFFF0U, PC_PWM_CMD, duty, 1U));
+
+	// The apply time after the wrap is the later one
+	assert_true(output_commit_queue_next(&queue, 0xFFFFFF00U, &apply_us));
+	assert_int_equal(0xFFFFFFF0U, apply_us);
+	assert_int_equal(1U, output_commit_queue_take_due(&queue, 0xFFFFFFF0U, due));
+	assert_int_equal(0U, output_commit_queue_take_due(&queue, 0x000000FFU, due));
+
+	// Taken well after its time: still committed, and counted
+	assert_int_equal(1U, output_commit_queue_take_due(&queue, 0x00000100U + OUTPUT_COMMIT_LATE_US + 1U, due));
+	assert_int_equal(0x00000100U, due[0].apply_us);
+	assert_int_equal(1U, queue.late);
+
+	// Already past when staged: due at once
+	assert_int_equal(OUTPUT_COMMIT_OK, output_commit_queue_stage(&queue, 5000U, 4000U, PC_PWM_CMD, duty, 1U));
+	assert_int_equal(1U, output_commit_queue_take_due(&queue, 5000U, due));
+	assert_int_equal(2U, queue.late);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_due_commands_commit_together_in_arrival_order),
+		cmocka_unit_test(test_stage_rejects_bad_commands),
+		cmocka_unit_test(test_clock_wrap_and_late_commits),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -14,8 +14,11 @@
 #include "semphr.h"
 
 #include "app_outputs.h"
+#include "display_anim.h"
+#include "display_format.h"
 #include "error_management.h"
 #include "hardware/pwm.h"
+#include "timer_wheel.h"
 
 // -----------------------------------------------------------------------------
 // Mock state helpers
@@ -24,11 +27,13 @@
 static BaseType_t mock_take_result = pdTRUE;
 static BaseType_t mock_give_result = pdTRUE;
 static bool mock_create_mutex_should_fail = false;
+static bool mock_driver_init_should_fail = false;
 
 static uint32_t mock_take_calls = 0;
 static uint32_t mock_give_calls = 0;
 static uint32_t mock_tm1639_init_calls = 0;
 static uint32_t mock_tm1637_init_calls = 0;
+static TickType_t mock_tick_count = 0;
 
 static output_result_t mock_set_digits_result = OUTPUT_OK;
 static output_result_t mock_set_leds_result = OUTPUT_OK;
@@ -55,6 +60,17 @@ static bool mock_driver_allocated[MAX_SPI_INTERFACES];
 static char mock_mutex_storage;
 static SemaphoreHandle_t mock_spi_mutex = (SemaphoreHandle_t)&mock_mutex_storage;
 
+/** FIFO standing in for a bus worker queue. */
+typedef struct mock_queue_t {
+	uint8_t items[OUTPUT_BUS_QUEUE_SIZE][32];
+	UBaseType_t item_size;
+	uint8_t head;
+	uint8_t count;
+} mock_queue_t;
+
+static mock_queue_t mock_queues[OUTPUT_SPI_BUS_COUNT];
+static uint8_t mock_queues_created = 0U;
+
 static void clear_recorded_outputs(void)
 {
 	memset(recorded_digits, 0, sizeof(recorded_digits));
@@ -77,6 +93,7 @@ static void reset_mock_state(void)
 	mock_take_result = pdTRUE;
 	mock_give_result = pdTRUE;
 	mock_create_mutex_should_fail = false;
+	mock_driver_init_should_fail = false;
 	mock_set_digits_result = OUTPUT_OK;
 	mock_set_leds_result = OUTPUT_OK;
 	mock_set_display_result = OUTPUT_OK;
@@ -86,6 +103,11 @@ static void reset_mock_state(void)
 
 	memset(mock_driver_pool, 0, sizeof(mock_driver_pool));
 	memset(mock_driver_allocated, 0, sizeof(mock_driver_allocated));
+	for (uint8_t i = 0U; i < (uint8_t)OUTPUT_SPI_BUS_COUNT; i++)
+	{
+		mock_queues[i].head = 0U;
+		mock_queues[i].count = 0U;
+	}
 	clear_recorded_outputs();
 }
 
@@ -135,12 +157,14 @@ static output_result_t mock_driver_set_brightness(output_driver_t *config, uint8
 	return mock_set_brightness_result;
 }
 
-static output_driver_t *initialise_mock_driver(uint8_t chip_id)
+static output_driver_t *initialise_mock_driver(uint8_t chip_id,
+                                              output_result_t (*select_interface)(uint8_t, bool))
 {
 	output_driver_t *driver = &mock_driver_pool[chip_id];
 	memset(driver, 0, sizeof(*driver));
 
 	driver->chip_id = chip_id;
+	driver->select_interface = select_interface;
 	driver->set_digits = mock_driver_set_digits;
 	driver->set_leds = mock_driver_set_leds;
 	driver->set_brightness = mock_driver_set_brightness;
@@ -248,14 +272,52 @@ BaseType_t __wrap_xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToW
 	return mock_take_result;
 }
 
+/** The mock FIFO behind @p queue, or NULL for the bus mutex. */
+static mock_queue_t *mock_queue_of(QueueHandle_t queue)
+{
+	mock_queue_t *found = NULL;
+
+	for (uint8_t i = 0U; i < mock_queues_created; i++)
+	{
+		if ((QueueHandle_t)&mock_queues[i] == queue)
+		{
+			found = &mock_queues[i];
+		}
+	}
+
+	return found;
+}
+
+QueueHandle_t __wrap_xQueueGenericCreate(UBaseType_t length, UBaseType_t item_size, uint8_t queue_type)
+{
+	(void)queue_type;
+	assert_true(length <= OUTPUT_BUS_QUEUE_SIZE);
+	assert_true(item_size <= sizeof(mock_queues[0].items[0]));
+	assert_true(mock_queues_created < (uint8_t)OUTPUT_SPI_BUS_COUNT);
+
+	mock_queues[mock_queues_created].item_size = item_size;
+	return (QueueHandle_t)&mock_queues[mock_queues_created++];
+}
+
 BaseType_t __wrap_xQueueGenericSend(QueueHandle_t xQueue,
                                     const void *pvItemToQueue,
                                     TickType_t xTicksToWait,
                                     const BaseType_t xCopyPosition)
 {
-	(void)pvItemToQueue;
 	(void)xTicksToWait;
 	(void)xCopyPosition;
+	mock_queue_t *queue = mock_queue_of(xQueue);
+
+	if (NULL != queue)
+	{
+		if (queue->count >= OUTPUT_BUS_QUEUE_SIZE)
+		{
+			return pdFALSE;
+		}
+		memcpy(queue->items[(queue->head + queue->count) % OUTPUT_BUS_QUEUE_SIZE], pvItemToQueue, queue->item_size);
+		queue->count++;
+		return pdTRUE;
+	}
 
 	if (xQueue != NULL)
 	{
@@ -265,19 +327,39 @@ BaseType_t __wrap_xQueueGenericSend(QueueHandle_t xQueue,
 	return mock_give_result;
 }
 
+BaseType_t __wrap_xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	(void)xTicksToWait;
+	mock_queue_t *queue = mock_queue_of(xQueue);
+
+	if ((NULL == queue) || (0U == queue->count))
+	{
+		return pdFALSE;
+	}
+
+	memcpy(pvBuffer, queue->items[queue->head], queue->item_size);
+	queue->head = (uint8_t)((queue->head + 1U) % OUTPUT_BUS_QUEUE_SIZE);
+	queue->count--;
+	return pdTRUE;
+}
+
+TickType_t __wrap_xTaskGetTickCountFromISR(void)
+{
+	return mock_tick_count;
+}
+
 output_driver_t *__wrap_tm1639_init(uint8_t chip_id,
                                     output_result_t (*select_interface)(uint8_t, bool),
                                     spi_inst_t *spi,
                                     uint8_t dio_pin,
                                     uint8_t clk_pin)
 {
-	(void)select_interface;
 	(void)spi;
 	(void)dio_pin;
 	(void)clk_pin;
 
 	mock_tm1639_init_calls++;
-	return initialise_mock_driver(chip_id);
+	return mock_driver_init_should_fail ? NULL : initialise_mock_driver(chip_id, select_interface);
 }
 
 output_driver_t *__wrap_tm1637_init(uint8_t chip_id,
@@ -286,19 +368,34 @@ output_driver_t *__wrap_tm1637_init(uint8_t chip_id,
                                     uint8_t dio_pin,
                                     uint8_t clk_pin)
 {
-	(void)select_interface;
 	(void)spi;
 	(void)dio_pin;
 	(void)clk_pin;
 
 	mock_tm1637_init_calls++;
-	return initialise_mock_driver(chip_id);
+	return mock_driver_init_should_fail ? NULL : initialise_mock_driver(chip_id, select_interface);
 }
 
 // -----------------------------------------------------------------------------
 // Test fixtures
 // -----------------------------------------------------------------------------
 
+/** Bank with every fitted slot enabled at the default timing. */
+static void default_bank(output_bank_t *bank)
+{
+	const uint8_t device_config_map[MAX_SPI_INTERFACES] = DEVICE_CONFIG;
+
+	memcpy(bank->device_map, device_config_map, sizeof(bank->device_map));
+	for (uint8_t slot = 0U; slot < MAX_SPI_INTERFACES; slot++)
+	{
+		bank->timing[slot].spi_khz = OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+		bank->timing[slot].select_settle_us = OUTPUT_TIMING_DEFAULT_SETTLE_US;
+		bank->timing[slot].tm1637_half_period_us = OUTPUT_TIMING_DEFAULT_TM1637_US;
+	}
+}
+
+static output_bank_t test_bank;
+
 static int setup(void **state)
 {
 	(void)state;
@@ -316,6 +413,8 @@ static int setup(void **state)
 static int teardown(void **state)
 {
 	(void)state;
+	default_bank(&test_bank);
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&test_bank));
 	return 0;
 }
 
@@ -394,6 +493,26 @@ static void test_device_config_valid_values(void **state)
 	}
 }
 
+static void test_bus_config_valid_values(void **state)
+{
+	(void) state;
+	// Every fitted slot sits on a bus whose pins are all assigned
+	const uint8_t device_config_map[] = DEVICE_CONFIG;
+	const uint8_t bus_config_map[] = OUTPUT_BUS_CONFIG;
+	const uint8_t spi1_pins[] = {SPI1_SCK_PIN, SPI1_TX_PIN, SPI1_MUX_A_PIN, SPI1_MUX_B_PIN, SPI1_MUX_C_PIN, SPI1_MUX_CS};
+
+	assert_int_equal(MAX_SPI_INTERFACES, sizeof(bus_config_map));
+	for (size_t i = 0; i < MAX_SPI_INTERFACES; i++) {
+		assert_true(bus_config_map[i] < OUTPUT_SPI_BUS_COUNT);
+
+		if ((DEVICE_NONE != device_config_map[i]) && (OUTPUT_BUS_SPI1 == bus_config_map[i])) {
+			for (size_t p = 0; p < sizeof(spi1_pins); p++) {
+				assert_true(spi1_pins[p] < NUM_GPIO);
+			}
+		}
+	}
+}
+
 static void test_pin_uniqueness(void **state)
 {
 	(void) state;
@@ -534,6 +653,155 @@ static void test_display_out_succeeds_and_calls_driver(void **state)
 	assert_int_equal(0, statistics_get_counter(OUTPUT_CONTROLLER_ID_ERROR));
 }
 
+static void test_display_out_formats_number(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+
+	statistics_reset_all_counters();
+	clear_recorded_outputs();
+
+	const bool has_display = find_first_display_controller(&controller_id);
+
+	// -12.5: signed, width 5, one decimal, 2-byte value sign-extended
+	const uint8_t payload[5] = {make_display_header(controller_id, DISPLAY_CMD_SET_NUMBER),
+	                            (uint8_t)(4U | DISPLAY_FORMAT_SIGNED),
+	                            1U,
+	                            0xFFU,
+	                            0x83U};
+
+	if (!has_display)
+	{
+		assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(payload, sizeof(payload)));
+		assert_int_equal(0, (int)recorded_set_digits_calls);
+		return;
+	}
+
+	assert_int_equal(OUTPUT_OK, display_out(payload, sizeof(payload)));
+
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	const uint8_t expected_digits[8] = {OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_BLANK,
+	                                    OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_MINUS, 1, 2, 5};
+	assert_memory_equal(expected_digits, recorded_digits, sizeof(expected_digits));
+	assert_int_equal(6, recorded_dot_position);
+
+	// Missing value byte and reserved format bits are rejected before the driver
+	clear_recorded_outputs();
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(payload, 3U));
+	const uint8_t reserved[4] = {payload[0], 0x80U, 0U, 1U};
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(reserved, sizeof(reserved)));
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+	assert_int_equal(2, statistics_get_counter(OUTPUT_INVALID_PARAM_ERROR));
+}
+
+static void test_display_out_rolls_to_target(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+
+	statistics_reset_all_counters();
+	clear_recorded_outputs();
+
+	const bool has_display = find_first_display_controller(&controller_id);
+	const uint8_t header = make_display_header(controller_id, DISPLAY_CMD_SET_TARGET);
+
+	// Width 5, no decimals, jump straight to 250
+	const uint8_t jump[6] = {header, 4U, 0U, 0x00U, 0x00U, 250U};
+	// Roll to 260 at 50 units/s: one unit per refresh period
+	const uint8_t roll[7] = {header, 4U, 0U, 0x80U, 50U, 0x01U, 0x04U};
+
+	if (!has_display)
+	{
+		assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(jump, sizeof(jump)));
+		assert_int_equal(0, (int)recorded_set_digits_calls);
+		return;
+	}
+
+	assert_int_equal(OUTPUT_OK, display_out(jump, sizeof(jump)));
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	const uint8_t expected_jump[8] = {OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_BLANK,
+	                                  OUTPUT_DIGIT_BLANK, OUTPUT_DIGIT_BLANK, 2, 5, 0};
+	assert_memory_equal(expected_jump, recorded_digits, sizeof(expected_jump));
+
+	// Settled slots leave the bus and its lock alone
+	clear_recorded_outputs();
+	assert_int_equal(OUTPUT_OK, output_refresh_displays());
+	assert_int_equal(0, (int)mock_take_calls);
+
+	// First step is written with the command, the refresh task does the rest
+	assert_int_equal(OUTPUT_OK, display_out(roll, sizeof(roll)));
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	assert_int_equal(1, recorded_digits[7]);
+	for (uint8_t i = 0U; i < 9U; i++)
+	{
+		assert_int_equal(OUTPUT_OK, output_refresh_displays());
+	}
+	assert_int_equal(10, (int)recorded_set_digits_calls);
+	assert_int_equal(6, recorded_digits[6]);
+	assert_int_equal(0, recorded_digits[7]);
+
+	clear_recorded_outputs();
+	assert_int_equal(OUTPUT_OK, output_refresh_displays());
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+
+	// Writing digits directly stops a running animation
+	const uint8_t slow[7] = {header, 4U, 0U, 0x80U, 1U, 0x03U, 0xE8U};
+	const uint8_t digits_payload[6] = {make_display_header(controller_id, DISPLAY_CMD_SET_DIGITS),
+	                                   0x12U, 0x34U, 0x56U, 0x78U, 0xFFU};
+	assert_int_equal(OUTPUT_OK, display_out(slow, sizeof(slow)));
+	assert_int_equal(OUTPUT_OK, display_out(digits_payload, sizeof(digits_payload)));
+	clear_recorded_outputs();
+	assert_int_equal(OUTPUT_OK, output_refresh_displays());
+	assert_int_equal(0, (int)mock_take_calls);
+
+	// Missing slew or value bytes are rejected before the driver
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(jump, 5U));
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+	assert_int_equal(1, statistics_get_counter(OUTPUT_INVALID_PARAM_ERROR));
+}
+
+static void test_display_frame_keeps_anim_period(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	const TickType_t period = pdMS_TO_TICKS(DISPLAY_ANIM_PERIOD_MS);
+	TickType_t last_frame = 0U;
+	uint32_t frames = 0U;
+
+	if (!find_first_display_controller(&controller_id))
+	{
+		skip();
+	}
+
+	const uint8_t header = make_display_header(controller_id, DISPLAY_CMD_SET_TARGET);
+	const uint8_t jump[6] = {header, 4U, 0U, 0x00U, 0x00U, 250U};
+	const uint8_t roll[7] = {header, 4U, 0U, 0x80U, 50U, 0x01U, 0x04U};
+
+	assert_int_equal(OUTPUT_OK, display_out(jump, sizeof(jump)));
+	assert_int_equal(OUTPUT_OK, display_out(roll, sizeof(roll)));
+
+	// Each frame restarts the timer while writing the next step: it must not add a period
+	for (uint32_t i = 0U; i < (12U * period); i++)
+	{
+		mock_tick_count++;
+		timer_wheel_tick();
+		if (0U != timer_wheel_dispatch(DISPLAY_REFRESH_TASK))
+		{
+			if (0U != frames)
+			{
+				assert_int_equal(period, mock_tick_count - last_frame);
+			}
+			last_frame = mock_tick_count;
+			frames++;
+		}
+	}
+
+	// Nine steps after the first, plus at most one frame left armed by an earlier roll
+	assert_in_range(frames, 9U, 10U);
+	assert_int_equal(6, recorded_digits[6]);
+	assert_int_equal(0, recorded_digits[7]);
+}
+
 static void test_display_out_driver_error_propagates(void **state)
 {
 	(void)state;
@@ -605,6 +873,52 @@ static void test_display_out_semaphore_failure(void **state)
 	assert_int_equal(0, (int)mock_give_calls);
 }
 
+static void test_bus_lock_is_profiled(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	bus_profile_t profile;
+
+	statistics_reset_all_counters();
+	clear_recorded_outputs();
+	output_bus_profile_reset();
+
+	if (!find_first_display_controller(&controller_id))
+	{
+		skip();
+	}
+
+	const uint8_t slot = (uint8_t)(controller_id - 1U);
+	uint8_t payload[6] = {make_display_header(controller_id, DISPLAY_CMD_SET_DIGITS), 0x12, 0x34, 0x56, 0x78, 0};
+	assert_int_equal(OUTPUT_OK, display_out(payload, sizeof(payload)));
+
+	// Counted under the slot and under the operation
+	assert_true(output_bus_profile(slot, &profile));
+	assert_int_equal(1U, profile.locks);
+	assert_int_equal(0U, profile.contended);
+	assert_int_equal(0U, profile.timeouts);
+	uint32_t holds = 0U;
+	for (uint8_t bucket = 0U; bucket < (uint8_t)BUS_PROFILE_BUCKETS; bucket++)
+	{
+		holds += profile.hold[bucket];
+	}
+	assert_int_equal(1U, holds);
+	assert_true(output_bus_profile(OUTPUT_PROFILE_OP_ENTRY(OUTPUT_BUS_OP_DISPLAY), &profile));
+	assert_int_equal(1U, profile.locks);
+
+	// A take that gives up is a timeout, with no hold
+	mock_take_result = pdFALSE;
+	assert_int_equal(OUTPUT_ERR_SEMAPHORE, display_out(payload, sizeof(payload)));
+	assert_true(output_bus_profile(slot, &profile));
+	assert_int_equal(1U, profile.locks);
+	assert_int_equal(1U, profile.timeouts);
+
+	output_bus_profile_reset();
+	assert_true(output_bus_profile(OUTPUT_PROFILE_OP_ENTRY(OUTPUT_BUS_OP_DISPLAY), &profile));
+	assert_int_equal(0U, profile.locks);
+	assert_false(output_bus_profile(OUTPUT_PROFILE_ENTRIES, &profile));
+}
+
 static void test_display_out_brightness_updates_driver(void **state)
 {
 	(void)state;
@@ -858,6 +1172,267 @@ void __wrap_pwm_set_gpio_level(uint pin, uint16_t level)
 	check_expected(level);
 }
 
+static void test_apply_images_single_lock_and_flush(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	output_slot_image_t images[MAX_SPI_INTERFACES];
+	memset(images, 0, sizeof(images));
+
+	if (!find_first_display_controller(&controller_id))
+	{
+		return;
+	}
+
+	const uint8_t slot = (uint8_t)(controller_id - 1U);
+	const uint8_t expected_digits[8] = {8, 7, 6, 5, 4, 3, 2, 1};
+	memcpy(images[slot].data, expected_digits, sizeof(expected_digits));
+	images[slot].dot_position = 2U;
+	images[slot].brightness = 3U;
+	mock_driver_pool[slot].brightness = 7U;
+
+	assert_int_equal(OUTPUT_OK, output_apply_images(images, (uint8_t)(1U << slot)));
+
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	assert_memory_equal(expected_digits, recorded_digits, sizeof(expected_digits));
+	assert_int_equal(2U, recorded_dot_position);
+	assert_int_equal(1, (int)recorded_set_brightness_calls);
+	assert_int_equal(3U, recorded_brightness);
+	assert_int_equal(1, (int)mock_take_calls);
+	assert_int_equal(1, (int)mock_give_calls);
+}
+
+static void test_apply_images_skips_unchanged_brightness(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	output_slot_image_t images[MAX_SPI_INTERFACES];
+	memset(images, 0, sizeof(images));
+
+	if (!find_first_display_controller(&controller_id))
+	{
+		return;
+	}
+
+	const uint8_t slot = (uint8_t)(controller_id - 1U);
+	images[slot].dot_position = OUTPUT_NO_DECIMAL_POINT;
+	images[slot].brightness = 7U;
+	mock_driver_pool[slot].brightness = 7U;
+
+	assert_int_equal(OUTPUT_OK, output_apply_images(images, (uint8_t)(1U << slot)));
+
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	assert_int_equal(0, (int)recorded_set_brightness_calls);
+}
+
+static void test_apply_images_reports_missing_driver(void **state)
+{
+	(void)state;
+	output_slot_image_t images[MAX_SPI_INTERFACES];
+	memset(images, 0, sizeof(images));
+
+	// Fitted slots whose driver failed to initialise; empty slots are skipped
+	mock_driver_init_should_fail = true;
+	(void)output_init();
+	clear_recorded_outputs();
+	assert_int_equal(OUTPUT_ERR_DISPLAY_OUT, output_apply_images(images, 0xFFU));
+	assert_int_equal(1, (int)mock_take_calls);
+	assert_int_equal(1, (int)mock_give_calls);
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_apply_images(NULL, 0x01U));
+}
+
+static void test_apply_images_semaphore_failure(void **state)
+{
+	(void)state;
+	output_slot_image_t images[MAX_SPI_INTERFACES];
+	memset(images, 0, sizeof(images));
+
+	mock_take_result = pdFALSE;
+
+	assert_int_equal(OUTPUT_ERR_SEMAPHORE, output_apply_images(images, 0x01U));
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+	assert_int_equal(0, (int)mock_give_calls);
+}
+
+static void test_disabled_slot_rejects_updates(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	output_slot_image_t images[MAX_SPI_INTERFACES];
+	memset(images, 0, sizeof(images));
+
+	if (!find_first_display_controller(&controller_id))
+	{
+		return;
+	}
+
+	const uint8_t slot = (uint8_t)(controller_id - 1U);
+	uint8_t payload[6] = {make_display_header(controller_id, DISPLAY_CMD_SET_DIGITS), 0x12, 0x34, 0x56, 0x78, 0x9A};
+
+	default_bank(&test_bank);
+	test_bank.device_map[slot] = DEVICE_NONE;
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&test_bank));
+
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, display_out(payload, sizeof(payload)));
+	assert_int_equal(1, statistics_get_counter(OUTPUT_CONTROLLER_ID_ERROR));
+	assert_int_equal(mock_take_calls, mock_give_calls);
+	assert_int_equal(OUTPUT_OK, output_apply_images(images, (uint8_t)(1U << slot)));
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+	assert_int_equal(DEVICE_NONE, output_slot_device(slot, true));
+	assert_int_not_equal(DEVICE_NONE, output_slot_device(slot, false));
+
+	default_bank(&test_bank);
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&test_bank));
+	assert_int_equal(OUTPUT_OK, display_out(payload, sizeof(payload)));
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+}
+
+static void test_bank_timing_reaches_tm1637_drivers(void **state)
+{
+	(void)state;
+	const uint8_t device_config_map[MAX_SPI_INTERFACES] = DEVICE_CONFIG;
+	static output_bank_t other_bank;
+
+	default_bank(&test_bank);
+	for (uint8_t slot = 0U; slot < MAX_SPI_INTERFACES; slot++)
+	{
+		test_bank.timing[slot].spi_khz = 2000U;
+		test_bank.timing[slot].select_settle_us = 0U;
+		test_bank.timing[slot].tm1637_half_period_us = (uint8_t)(slot + 1U);
+	}
+
+	// One pointer store: no bus is waited for
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&test_bank));
+	assert_int_equal(0, (int)mock_take_calls);
+	assert_true(output_bank_in_use(&test_bank));
+
+	// Picked up when the slot is next selected
+	for (uint8_t slot = 0U; slot < MAX_SPI_INTERFACES; slot++)
+	{
+		output_driver_t *driver = &mock_driver_pool[slot];
+		if (!mock_driver_allocated[slot])
+		{
+			continue;
+		}
+		assert_int_equal(OUTPUT_OK, driver->select_interface(slot, true));
+		assert_int_equal(OUTPUT_OK, driver->select_interface(slot, false));
+
+		const uint8_t expected = device_is_tm1637(device_config_map[slot]) ? (uint8_t)(slot + 1U) : 0U;
+		assert_int_equal(expected, driver->bit_delay_us);
+	}
+
+	// One bad entry rejects the whole bank
+	default_bank(&other_bank);
+	other_bank.timing[0].tm1637_half_period_us = 0U;
+	other_bank.timing[1].tm1637_half_period_us = 99U;
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_set_active_bank(&other_bank));
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_set_active_bank(NULL));
+	assert_true(output_bank_in_use(&test_bank));
+	assert_false(output_bank_in_use(&other_bank));
+
+	// A bank can disable slots but not claim hardware that is not fitted
+	default_bank(&other_bank);
+	other_bank.device_map[MAX_SPI_INTERFACES - 1U] = (uint8_t)(device_config_map[MAX_SPI_INTERFACES - 1U] + 1U);
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_set_active_bank(&other_bank));
+
+	default_bank(&other_bank);
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&other_bank));
+	assert_false(output_bank_in_use(&test_bank));
+
+	other_bank.timing[0].spi_khz = OUTPUT_TIMING_MAX_SPI_KHZ + 1U;
+	assert_false(output_slot_timing_valid(&other_bank.timing[0]));
+	other_bank.timing[0].spi_khz = OUTPUT_TIMING_MIN_SPI_KHZ - 1U;
+	assert_false(output_slot_timing_valid(&other_bank.timing[0]));
+	other_bank.timing[0].spi_khz = OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+	assert_true(output_slot_timing_valid(&other_bank.timing[0]));
+}
+
+static void test_post_runs_on_bus_worker(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	const uint8_t bus_config_map[] = OUTPUT_BUS_CONFIG;
+
+	assert_true(find_first_display_controller(&controller_id));
+	const uint8_t bus = bus_config_map[controller_id - 1U];
+	const uint8_t first[6] = {make_display_header(controller_id, DISPLAY_CMD_SET_DIGITS), 0x12, 0x34, 0x56, 0x78, 0xFF};
+	const uint8_t second[2] = {make_display_header(controller_id, DISPLAY_CMD_SET_BRIGHTNESS), 3U};
+
+	// Posting copies the payload and touches neither the bus nor the driver
+	assert_int_equal(OUTPUT_OK, output_post(OUTPUT_BUS_OP_DISPLAY, first, sizeof(first)));
+	assert_int_equal(OUTPUT_OK, output_post(OUTPUT_BUS_OP_DISPLAY, second, sizeof(second)));
+	assert_int_equal(0, (int)mock_take_calls);
+	assert_int_equal(0, (int)recorded_set_digits_calls);
+	assert_false(output_bus_service((uint8_t)(bus ^ 1U), 0U));
+
+	// The worker applies them one at a time, in order
+	assert_true(output_bus_service(bus, 0U));
+	assert_int_equal(1, (int)recorded_set_digits_calls);
+	assert_int_equal(0, (int)recorded_set_brightness_calls);
+	assert_int_equal(0x01, recorded_digits[0]);
+	assert_true(output_bus_service(bus, 0U));
+	assert_int_equal(1, (int)recorded_set_brightness_calls);
+	assert_int_equal(3, recorded_brightness);
+	assert_int_equal(2, (int)mock_take_calls);
+	assert_int_equal(2, (int)mock_give_calls);
+	assert_false(output_bus_service(bus, 0U));
+}
+
+static void test_post_rejects_bad_payloads(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	const uint8_t bus_config_map[] = OUTPUT_BUS_CONFIG;
+
+	assert_true(find_first_display_controller(&controller_id));
+	const uint8_t bus = bus_config_map[controller_id - 1U];
+	const uint8_t payload[2] = {make_display_header(controller_id, DISPLAY_CMD_SET_BRIGHTNESS), 3U};
+	const uint8_t no_slot[2] = {make_display_header(0U, DISPLAY_CMD_SET_BRIGHTNESS), 3U};
+	const uint8_t led_out_of_range[3] = {MAX_SPI_INTERFACES + 1U, 0U, 0U};
+
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_post(OUTPUT_BUS_OP_DISPLAY, NULL, 2U));
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_post(OUTPUT_BUS_OP_DISPLAY, payload, 0U));
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_post(OUTPUT_BUS_OP_DISPLAY, no_slot, sizeof(no_slot)));
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_post(OUTPUT_BUS_OP_LED, led_out_of_range, sizeof(led_out_of_range)));
+	assert_int_equal(OUTPUT_ERR_INVALID_PARAM, output_post(OUTPUT_BUS_OP_SCENE, payload, sizeof(payload)));
+	assert_int_equal(5, statistics_get_counter(OUTPUT_CONTROLLER_ID_ERROR));
+
+	// A backlogged bus drops the payload instead of blocking the caller
+	for (uint8_t i = 0U; i < (uint8_t)OUTPUT_BUS_QUEUE_SIZE; i++)
+	{
+		assert_int_equal(OUTPUT_OK, output_post(OUTPUT_BUS_OP_DISPLAY, payload, sizeof(payload)));
+	}
+	assert_int_equal(OUTPUT_ERR_QUEUE_FULL, output_post(OUTPUT_BUS_OP_DISPLAY, payload, sizeof(payload)));
+	while (output_bus_service(bus, 0U))
+	{
+	}
+	assert_int_equal((int)OUTPUT_BUS_QUEUE_SIZE, (int)recorded_set_brightness_calls);
+}
+
+static void test_bus_worker_counts_failures(void **state)
+{
+	(void)state;
+	uint8_t controller_id = 1U;
+	const uint8_t bus_config_map[] = OUTPUT_BUS_CONFIG;
+
+	assert_true(find_first_display_controller(&controller_id));
+	const uint8_t bus = bus_config_map[controller_id - 1U];
+	const uint8_t digits[6] = {make_display_header(controller_id, DISPLAY_CMD_SET_DIGITS), 0x12, 0x34, 0x56, 0x78, 0xFF};
+	const uint8_t led_on_display[3] = {controller_id, 0U, 0xFFU};
+
+	mock_set_digits_result = OUTPUT_ERR_DISPLAY_OUT;
+	assert_int_equal(OUTPUT_OK, output_post(OUTPUT_BUS_OP_DISPLAY, digits, sizeof(digits)));
+	assert_int_equal(OUTPUT_OK, output_post(OUTPUT_BUS_OP_LED, led_on_display, sizeof(led_on_display)));
+
+	assert_true(output_bus_service(bus, 0U));
+	assert_int_equal(1, statistics_get_counter(DISPLAY_OUT_ERROR));
+	assert_true(output_bus_service(bus, 0U));
+	assert_int_equal(1, statistics_get_counter(LED_OUT_ERROR));
+	// The LED payload fails its device check before the lock
+	assert_int_equal(1, (int)mock_take_calls);
+	assert_int_equal(1, (int)mock_give_calls);
+}
+
 static void test_set_pwm_duty(void **state)
 {
 	(void) state;
@@ -876,13 +1451,18 @@ int main(void)
 		cmocka_unit_test_setup_teardown(test_max_interfaces_constant, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_device_config_array_size, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_device_config_valid_values, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_bus_config_valid_values, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_pin_uniqueness, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_gpio_count_constant, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_output_init_populates_driver_pool, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_rejects_invalid_payload, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_succeeds_and_calls_driver, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_display_out_formats_number, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_display_out_rolls_to_target, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_display_frame_keeps_anim_period, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_driver_error_propagates, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_semaphore_failure, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_bus_lock_is_profiled, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_brightness_updates_driver, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_brightness_zero_turns_off, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_led_out_rejects_invalid_payload, setup, teardown),
@@ -893,6 +1473,15 @@ int main(void)
 		cmocka_unit_test_setup_teardown(test_display_out_no_double_count_on_early_error, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_led_out_no_give_without_take_on_null, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_display_out_semaphore_failure_returns_correct_error, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_apply_images_single_lock_and_flush, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_apply_images_skips_unchanged_brightness, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_apply_images_reports_missing_driver, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_apply_images_semaphore_failure, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_disabled_slot_rejects_updates, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_bank_timing_reaches_tm1637_drivers, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_post_runs_on_bus_worker, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_post_rejects_bad_payloads, setup, teardown),
+		cmocka_unit_test_setup_teardown(test_bus_worker_counts_failures, setup, teardown),
 		cmocka_unit_test_setup_teardown(test_set_pwm_duty, setup, teardown),
 	};
 
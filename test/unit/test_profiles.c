@@ -0,0 +1,282 @@
+/**
+ * @file test_profiles.c
+ * @brief Unit tests for the configuration profile banks
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#include "app_context.h"
+#include "app_inputs.h"
+#include "app_profiles.h"
+#include "commands.h"
+#include "error_management.h"
+
+static output_bank_t applied_bank;
+static int applied_bank_calls = 0;
+
+QueueHandle_t __wrap_xQueueGenericCreate(UBaseType_t length, UBaseType_t item_size, uint8_t queue_type)
+{
+	(void)length;
+	(void)item_size;
+	(void)queue_type;
+	return (QueueHandle_t)(uintptr_t)0x100U;
+}
+
+void __wrap_vQueueDelete(QueueHandle_t queue)
+{
+	(void)queue;
+}
+
+output_result_t __wrap_output_set_active_bank(const output_bank_t *bank)
+{
+	(void)memcpy(&applied_bank, bank, sizeof(applied_bank));
+	applied_bank_calls++;
+	return OUTPUT_OK;
+}
+
+/** Slots enabled by the last bank handed to the output module. */
+static uint8_t enabled_slots(void)
+{
+	uint8_t mask = 0U;
+
+	for (uint8_t slot = 0U; slot < MAX_SPI_INTERFACES; slot++)
+	{
+		if (DEVICE_NONE != applied_bank.device_map[slot])
+		{
+			mask |= (uint8_t)(1U << slot);
+		}
+	}
+
+	return mask;
+}
+
+/** Output device map with every fitted slot enabled. */
+static void hardware_map(uint8_t map[MAX_SPI_INTERFACES])
+{
+	const uint8_t device_config_map[] = DEVICE_CONFIG;
+	(void)memcpy(map, device_config_map, MAX_SPI_INTERFACES);
+}
+
+static int setup(void **state)
+{
+	(void)state;
+	mock_flash_erase_all();
+	mock_flash_set_safe_execute_result(PICO_OK);
+	statistics_reset_all_counters();
+	app_context_set_data_event_queue(NULL);
+	(void)memset(&applied_bank, 0, sizeof(applied_bank));
+	applied_bank_calls = 0;
+	assert_int_equal(INPUT_OK, input_init());
+	profile_init();
+	return 0;
+}
+
+static void test_config_command_id(void **state)
+{
+	(void)state;
+	assert_int_equal(0x1D, PC_CONFIG_CMD);
+}
+
+static void test_init_without_storage_uses_defaults(void **state)
+{
+	(void)state;
+	uint8_t map[MAX_SPI_INTERFACES];
+	uint8_t expected_mask = 0U;
+
+	hardware_map(map);
+	for (uint8_t slot = 0U; slot < MAX_SPI_INTERFACES; slot++)
+	{
+		if (DEVICE_NONE != map[slot])
+		{
+			expected_mask |= (uint8_t)(1U << slot);
+		}
+	}
+
+	assert_int_equal(0U, profile_active_bank());
+	assert_int_equal(1, applied_bank_calls);
+	assert_int_equal(expected_mask, enabled_slots());
+	// Default encoder map places encoder 0 on row 7, columns 0-1
+	assert_true(input_is_encoder_position(7U, 0U));
+	assert_true(input_is_encoder_position(7U, 1U));
+}
+
+static void test_select_switches_input_profile(void **state)
+{
+	(void)state;
+	const encoder_map_t moved = {.row = 3U, .col = 4U, .enabled = true};
+	const uint8_t select[2] = {PROFILE_CMD_SELECT, 1U};
+
+	assert_int_equal(PROFILE_OK, profile_set_encoder(1U, 0U, &moved));
+	assert_true(input_is_encoder_position(7U, 0U));
+
+	assert_int_equal(PROFILE_OK, profile_process_command(select, sizeof(select)));
+	assert_int_equal(1U, profile_active_bank());
+	assert_false(input_is_encoder_position(7U, 0U));
+	assert_true(input_is_encoder_position(3U, 4U));
+	assert_true(input_is_encoder_position(3U, 5U));
+}
+
+static void test_active_bank_cannot_be_edited(void **state)
+{
+	(void)state;
+	const encoder_map_t mapping = {.row = 0U, .col = 0U, .enabled = false};
+	uint8_t map[MAX_SPI_INTERFACES];
+	hardware_map(map);
+
+	assert_int_equal(PROFILE_ERR_BUSY, profile_set_field(0U, INPUT_FIELD_ROWS, 4U));
+	assert_int_equal(PROFILE_ERR_BUSY, profile_set_encoder(0U, 0U, &mapping));
+	assert_int_equal(PROFILE_ERR_BUSY, profile_set_output_map(0U, map));
+	assert_int_equal(PROFILE_ERR_BUSY, profile_copy(1U, 0U));
+
+	// Once switched away (and no scan holds it) the bank is editable again
+	assert_int_equal(PROFILE_OK, profile_select(2U));
+	assert_int_equal(PROFILE_OK, profile_set_field(0U, INPUT_FIELD_ROWS, 4U));
+}
+
+static void test_invalid_bank_is_not_activated(void **state)
+{
+	(void)state;
+
+	assert_int_equal(PROFILE_OK, profile_set_field(1U, INPUT_FIELD_COLUMNS, KEYPAD_MAX_COLS + 1U));
+	assert_int_equal(PROFILE_ERR_INVALID_CONFIG, profile_select(1U));
+	assert_int_equal(0U, profile_active_bank());
+	assert_true(input_is_encoder_position(7U, 0U));
+
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_select(PROFILE_BANK_COUNT));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_set_field(1U, INPUT_FIELD_ROWS, 0x100U));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_set_field(1U, 0x7FU, 1U));
+}
+
+static void test_output_map_only_disables_slots(void **state)
+{
+	(void)state;
+	uint8_t map[MAX_SPI_INTERFACES];
+	hardware_map(map);
+
+	// A profile cannot claim a device that is not fitted
+	map[MAX_SPI_INTERFACES - 1U] = (uint8_t)(map[MAX_SPI_INTERFACES - 1U] + 1U);
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_set_output_map(1U, map));
+
+	(void)memset(map, DEVICE_NONE, sizeof(map));
+	assert_int_equal(PROFILE_OK, profile_set_output_map(1U, map));
+	assert_int_equal(PROFILE_OK, profile_select(1U));
+	assert_int_equal(0U, enabled_slots());
+}
+
+static void test_slot_timing_applied_with_bank(void **state)
+{
+	(void)state;
+	// Slot 2 at 2 MHz, no settle delay, 1 µs TM1637 half period
+	const uint8_t set_timing[7] = {PROFILE_CMD_SET_TIMING, 1U, 2U, 0x07U, 0xD0U, 0U, 1U};
+	const uint8_t too_fast[7] = {PROFILE_CMD_SET_TIMING, 1U, 2U, 0xFFU, 0xFFU, 0U, 1U};
+	const uint8_t no_half_period[7] = {PROFILE_CMD_SET_TIMING, 1U, 2U, 0x07U, 0xD0U, 0U, 0U};
+	const uint8_t bad_slot[7] = {PROFILE_CMD_SET_TIMING, 1U, MAX_SPI_INTERFACES, 0x07U, 0xD0U, 0U, 1U};
+
+	// Defaults come from the compile-time bus settings
+	assert_int_equal(1, applied_bank_calls);
+	assert_int_equal(OUTPUT_TIMING_DEFAULT_SPI_KHZ, applied_bank.timing[2].spi_khz);
+	assert_int_equal(OUTPUT_TIMING_DEFAULT_SETTLE_US, applied_bank.timing[2].select_settle_us);
+	assert_int_equal(OUTPUT_TIMING_DEFAULT_TM1637_US, applied_bank.timing[2].tm1637_half_period_us);
+
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(too_fast, sizeof(too_fast)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(no_half_period, sizeof(no_half_period)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(bad_slot, sizeof(bad_slot)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(set_timing, sizeof(set_timing) - 1U));
+	assert_int_equal(PROFILE_OK, profile_process_command(set_timing, sizeof(set_timing)));
+
+	// Edits reach the bus only when the bank is activated
+	assert_int_equal(1, applied_bank_calls);
+	assert_int_equal(PROFILE_OK, profile_select(1U));
+	assert_int_equal(2, applied_bank_calls);
+	assert_int_equal(2000U, applied_bank.timing[2].spi_khz);
+	assert_int_equal(0U, applied_bank.timing[2].select_settle_us);
+	assert_int_equal(1U, applied_bank.timing[2].tm1637_half_period_us);
+	assert_int_equal(OUTPUT_TIMING_DEFAULT_SPI_KHZ, applied_bank.timing[3].spi_khz);
+
+	// The active bank's timing cannot change under the bus
+	assert_int_equal(PROFILE_ERR_BUSY, profile_process_command(set_timing, sizeof(set_timing)));
+}
+
+static void test_copy_starts_from_another_bank(void **state)
+{
+	(void)state;
+	const encoder_map_t disabled = {.row = 7U, .col = 0U, .enabled = false};
+
+	assert_int_equal(PROFILE_OK, profile_set_encoder(1U, 0U, &disabled));
+	assert_int_equal(PROFILE_OK, profile_copy(1U, 2U));
+	assert_int_equal(PROFILE_OK, profile_select(2U));
+	assert_false(input_is_encoder_position(7U, 0U));
+	assert_true(input_is_encoder_position(7U, 2U));
+}
+
+static void test_saved_banks_survive_reinit(void **state)
+{
+	(void)state;
+	const uint8_t set_encoders[5] = {PROFILE_CMD_SET_FIELD, 3U, INPUT_FIELD_NUM_ENCODERS, 0x00U, 0x01U};
+	const uint8_t save[1] = {PROFILE_CMD_SAVE};
+
+	assert_int_equal(PROFILE_OK, profile_process_command(set_encoders, sizeof(set_encoders)));
+	assert_int_equal(PROFILE_OK, profile_select(3U));
+	assert_int_equal(PROFILE_OK, profile_process_command(save, sizeof(save)));
+
+	// Unsaved changes are dropped by a reload
+	assert_int_equal(PROFILE_OK, profile_select(0U));
+	assert_int_equal(INPUT_OK, input_init());
+	profile_init();
+
+	assert_int_equal(3U, profile_active_bank());
+	assert_true(input_is_encoder_position(7U, 0U));
+	assert_false(input_is_encoder_position(7U, 2U));
+}
+
+static void test_save_reports_storage_failure(void **state)
+{
+	(void)state;
+	mock_flash_set_safe_execute_result(-1);
+	assert_int_equal(PROFILE_ERR_STORAGE, profile_save());
+	assert_int_equal(1, statistics_get_counter(STORAGE_ERROR));
+}
+
+static void test_malformed_commands_are_rejected(void **state)
+{
+	(void)state;
+	const uint8_t short_select[1] = {PROFILE_CMD_SELECT};
+	const uint8_t short_field[4] = {PROFILE_CMD_SET_FIELD, 1U, INPUT_FIELD_ROWS, 0U};
+	const uint8_t short_outputs[4] = {PROFILE_CMD_SET_OUTPUTS, 1U, 0U, 0U};
+	const uint8_t unknown[2] = {0x0FU, 0U};
+
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(NULL, 2U));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(short_select, 0U));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(short_select, sizeof(short_select)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(short_field, sizeof(short_field)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(short_outputs, sizeof(short_outputs)));
+	assert_int_equal(PROFILE_ERR_INVALID_PARAM, profile_process_command(unknown, sizeof(unknown)));
+	assert_int_equal(0U, profile_active_bank());
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_config_command_id, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_init_without_storage_uses_defaults, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_select_switches_input_profile, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_active_bank_cannot_be_edited, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_invalid_bank_is_not_activated, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_output_map_only_disables_slots, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_slot_timing_applied_with_bank, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_copy_starts_from_another_bank, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_saved_banks_survive_reinit, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_save_reports_storage_failure, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_malformed_commands_are_rejected, setup, NULL),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
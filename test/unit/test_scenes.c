@@ -0,0 +1,249 @@
+/**
+ * @file test_scenes.c
+ * @brief Unit tests for the stored output scenes
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#include "app_outputs.h"
+#include "app_scenes.h"
+#include "commands.h"
+
+static output_slot_image_t applied_images[MAX_SPI_INTERFACES];
+static uint8_t applied_mask = 0U;
+static int apply_calls = 0;
+static output_result_t apply_result = OUTPUT_OK;
+
+output_result_t __wrap_output_apply_images(const output_slot_image_t *images, uint8_t slot_mask)
+{
+	apply_calls++;
+	applied_mask = slot_mask;
+	memcpy(applied_images, images, sizeof(applied_images));
+	return apply_result;
+}
+
+/** Index of the first configured output slot, as a 1-based controller ID. */
+static uint8_t first_controller_id(void)
+{
+	const uint8_t device_config_map[] = DEVICE_CONFIG;
+	uint8_t controller_id = 0U;
+
+	for (uint8_t i = 0U; (i < (uint8_t)MAX_SPI_INTERFACES) && (0U == controller_id); i++)
+	{
+		if (DEVICE_NONE != device_config_map[i])
+		{
+			controller_id = (uint8_t)(i + 1U);
+		}
+	}
+
+	return controller_id;
+}
+
+/** Index of the first empty output slot, as a 1-based controller ID. */
+static uint8_t first_unused_controller_id(void)
+{
+	const uint8_t device_config_map[] = DEVICE_CONFIG;
+	uint8_t controller_id = 0U;
+
+	for (uint8_t i = 0U; (i < (uint8_t)MAX_SPI_INTERFACES) && (0U == controller_id); i++)
+	{
+		if (DEVICE_NONE == device_config_map[i])
+		{
+			controller_id = (uint8_t)(i + 1U);
+		}
+	}
+
+	return controller_id;
+}
+
+/** Bank with @ref DEVICE_CONFIG and default timing, minus the slots in @p disabled_mask. */
+static void build_bank(output_bank_t *bank, uint8_t disabled_mask)
+{
+	const uint8_t device_config_map[] = DEVICE_CONFIG;
+
+	for (uint8_t slot = 0U; slot < (uint8_t)MAX_SPI_INTERFACES; slot++)
+	{
+		bank->device_map[slot] = (0U != (disabled_mask & (1U << slot))) ? DEVICE_NONE : device_config_map[slot];
+		bank->timing[slot].spi_khz = OUTPUT_TIMING_DEFAULT_SPI_KHZ;
+		bank->timing[slot].select_settle_us = OUTPUT_TIMING_DEFAULT_SETTLE_US;
+		bank->timing[slot].tm1637_half_period_us = OUTPUT_TIMING_DEFAULT_TM1637_US;
+	}
+}
+
+static int setup(void **state)
+{
+	(void)state;
+	mock_flash_erase_all();
+	mock_flash_set_safe_execute_result(PICO_OK);
+	memset(applied_images, 0, sizeof(applied_images));
+	applied_mask = 0U;
+	apply_calls = 0;
+	apply_result = OUTPUT_OK;
+	scene_init();
+	return 0;
+}
+
+static void test_scene_command_id(void **state)
+{
+	(void)state;
+	assert_int_equal(0x0E, PC_SCENE_CMD);
+}
+
+static void test_apply_empty_scene_is_rejected(void **state)
+{
+	(void)state;
+	assert_int_equal(SCENE_ERR_EMPTY, scene_apply(0U));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_apply(SCENE_MAX_COUNT));
+	assert_int_equal(0, apply_calls);
+}
+
+static void test_upload_and_apply_scene(void **state)
+{
+	(void)state;
+	const uint8_t controller_id = first_controller_id();
+	assert_int_not_equal(0, controller_id);
+
+	const uint8_t upload[SCENE_UPLOAD_PAYLOAD_SIZE] = {
+		SCENE_CMD_UPLOAD, 2U, controller_id, 5U, 3U,
+		1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U
+	};
+	const uint8_t apply[2] = {SCENE_CMD_APPLY, 2U};
+
+	assert_int_equal(SCENE_OK, scene_process_command(upload, sizeof(upload)));
+	assert_int_equal(SCENE_OK, scene_process_command(apply, sizeof(apply)));
+
+	const uint8_t slot = (uint8_t)(controller_id - 1U);
+	assert_int_equal(1, apply_calls);
+	assert_int_equal((uint8_t)(1U << slot), applied_mask);
+	assert_int_equal(5U, applied_images[slot].brightness);
+	assert_int_equal(3U, applied_images[slot].dot_position);
+	assert_memory_equal(&upload[5], applied_images[slot].data, OUTPUT_IMAGE_SIZE);
+}
+
+static void test_upload_rejects_invalid_slots(void **state)
+{
+	(void)state;
+	output_slot_image_t image = {.dot_position = OUTPUT_NO_DECIMAL_POINT};
+	const uint8_t unused_id = first_unused_controller_id();
+
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(0U, 0U, &image));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(0U, MAX_SPI_INTERFACES + 1U, &image));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(SCENE_MAX_COUNT, first_controller_id(), &image));
+	if (0U != unused_id)
+	{
+		assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(0U, unused_id, &image));
+	}
+
+	image.dot_position = OUTPUT_IMAGE_SIZE;
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(0U, first_controller_id(), &image));
+}
+
+static void test_clear_removes_scene(void **state)
+{
+	(void)state;
+	output_slot_image_t image = {.dot_position = OUTPUT_NO_DECIMAL_POINT};
+	const uint8_t clear[2] = {SCENE_CMD_CLEAR, 1U};
+
+	assert_int_equal(SCENE_OK, scene_store_slot(1U, first_controller_id(), &image));
+	assert_int_equal(SCENE_OK, scene_process_command(clear, sizeof(clear)));
+	assert_int_equal(SCENE_ERR_EMPTY, scene_apply(1U));
+}
+
+static void test_apply_reports_output_failure(void **state)
+{
+	(void)state;
+	output_slot_image_t image = {.dot_position = OUTPUT_NO_DECIMAL_POINT};
+
+	assert_int_equal(SCENE_OK, scene_store_slot(0U, first_controller_id(), &image));
+	apply_result = OUTPUT_ERR_SEMAPHORE;
+	assert_int_equal(SCENE_ERR_OUTPUT, scene_apply(0U));
+}
+
+static void test_saved_scenes_survive_reinit(void **state)
+{
+	(void)state;
+	output_slot_image_t image = {.data = {9U, 8U, 7U}, .dot_position = 1U, .brightness = 4U};
+	const uint8_t save[1] = {SCENE_CMD_SAVE};
+
+	assert_int_equal(SCENE_OK, scene_store_slot(4U, first_controller_id(), &image));
+	assert_int_equal(SCENE_OK, scene_process_command(save, sizeof(save)));
+
+	// Unsaved changes are dropped by a reload
+	assert_int_equal(SCENE_OK, scene_store_slot(5U, first_controller_id(), &image));
+	scene_init();
+
+	assert_int_equal(SCENE_ERR_EMPTY, scene_apply(5U));
+	assert_int_equal(SCENE_OK, scene_apply(4U));
+	assert_int_equal(9U, applied_images[first_controller_id() - 1U].data[0]);
+}
+
+static void test_disabled_slots_are_left_out(void **state)
+{
+	(void)state;
+	output_slot_image_t image = {.dot_position = OUTPUT_NO_DECIMAL_POINT};
+	const uint8_t slot = (uint8_t)(first_controller_id() - 1U);
+	static output_bank_t disabled_bank;
+	static output_bank_t full_bank;
+
+	build_bank(&disabled_bank, (uint8_t)(1U << slot));
+	build_bank(&full_bank, 0U);
+	assert_int_equal(SCENE_OK, scene_store_slot(3U, first_controller_id(), &image));
+
+	// A profile that disables the slot: no upload, and nothing left to apply
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&disabled_bank));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_store_slot(2U, first_controller_id(), &image));
+	assert_int_equal(SCENE_ERR_EMPTY, scene_apply(3U));
+	assert_int_equal(0, apply_calls);
+
+	assert_int_equal(OUTPUT_OK, output_set_active_bank(&full_bank));
+	assert_int_equal(SCENE_OK, scene_apply(3U));
+	assert_int_equal((uint8_t)(1U << slot), applied_mask);
+}
+
+static void test_save_reports_storage_failure(void **state)
+{
+	(void)state;
+	mock_flash_set_safe_execute_result(-1);
+	assert_int_equal(SCENE_ERR_STORAGE, scene_save());
+}
+
+static void test_malformed_commands_are_rejected(void **state)
+{
+	(void)state;
+	const uint8_t short_upload[4] = {SCENE_CMD_UPLOAD, 0U, 1U, 0U};
+	const uint8_t short_apply[1] = {SCENE_CMD_APPLY};
+	const uint8_t unknown[2] = {0x1FU, 0U};
+
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_process_command(NULL, 2U));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_process_command(short_upload, 0U));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_process_command(short_upload, sizeof(short_upload)));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_process_command(short_apply, sizeof(short_apply)));
+	assert_int_equal(SCENE_ERR_INVALID_PARAM, scene_process_command(unknown, sizeof(unknown)));
+	assert_int_equal(0, apply_calls);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_scene_command_id, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_apply_empty_scene_is_rejected, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_upload_and_apply_scene, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_upload_rejects_invalid_slots, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_clear_removes_scene, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_apply_reports_output_failure, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_saved_scenes_survive_reinit, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_disabled_slots_are_left_out, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_save_reports_storage_failure, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_malformed_commands_are_rejected, setup, NULL),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
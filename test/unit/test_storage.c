@@ -0,0 +1,125 @@
+/**
+ * @file test_storage.c
+ * @brief Unit tests for the flash storage records
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#include "app_storage.h"
+#include "error_management.h"
+
+static int setup(void **state)
+{
+	(void)state;
+	mock_flash_erase_all();
+	mock_flash_set_safe_execute_result(PICO_OK);
+	statistics_reset_all_counters();
+	return 0;
+}
+
+static void test_crc32_known_vector(void **state)
+{
+	(void)state;
+	const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+	assert_int_equal(0xCBF43926U, storage_crc32(check, sizeof(check)));
+	assert_int_equal(0U, storage_crc32(check, 0U));
+	assert_int_equal(0U, storage_crc32(NULL, 4U));
+}
+
+static void test_load_from_erased_flash_is_empty(void **state)
+{
+	(void)state;
+	uint8_t data[16];
+	memset(data, 0x5A, sizeof(data));
+
+	assert_int_equal(STORAGE_ERR_EMPTY, storage_load(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+	assert_int_equal(0x5A, data[0]);
+}
+
+static void test_save_then_load_round_trip(void **state)
+{
+	(void)state;
+	uint8_t data[300];
+	uint8_t loaded[300];
+	for (size_t i = 0U; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)(i * 7U);
+	}
+
+	assert_int_equal(STORAGE_OK, storage_save(STORAGE_REGION_SCENES, 3U, data, sizeof(data)));
+	assert_int_equal(STORAGE_OK, storage_load(STORAGE_REGION_SCENES, 3U, loaded, sizeof(loaded)));
+	assert_memory_equal(data, loaded, sizeof(data));
+	assert_int_equal(0, statistics_get_counter(STORAGE_ERROR));
+}
+
+static void test_load_rejects_version_and_length_mismatch(void **state)
+{
+	(void)state;
+	uint8_t data[32] = {1, 2, 3};
+
+	assert_int_equal(STORAGE_OK, storage_save(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+	assert_int_equal(STORAGE_ERR_EMPTY, storage_load(STORAGE_REGION_SCENES, 2U, data, sizeof(data)));
+	assert_int_equal(STORAGE_ERR_EMPTY, storage_load(STORAGE_REGION_SCENES, 1U, data, sizeof(data) - 1U));
+}
+
+static void test_load_rejects_corrupted_payload(void **state)
+{
+	(void)state;
+	uint8_t data[32] = {1, 2, 3};
+	const uint32_t offset = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+
+	assert_int_equal(STORAGE_OK, storage_save(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+
+	// Flip a payload bit behind the header
+	mock_flash_image[offset + sizeof(storage_header_t) + 1U] ^= 0x01U;
+
+	assert_int_equal(STORAGE_ERR_EMPTY, storage_load(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+}
+
+static void test_save_rejects_invalid_parameters(void **state)
+{
+	(void)state;
+	uint8_t data[4] = {0};
+
+	assert_int_equal(STORAGE_ERR_INVALID_PARAM, storage_save(NUM_STORAGE_REGIONS, 1U, data, sizeof(data)));
+	assert_int_equal(STORAGE_ERR_INVALID_PARAM, storage_save(STORAGE_REGION_SCENES, 1U, NULL, sizeof(data)));
+	assert_int_equal(STORAGE_ERR_INVALID_PARAM, storage_save(STORAGE_REGION_SCENES, 1U, data, 0U));
+	assert_int_equal(STORAGE_ERR_INVALID_PARAM, storage_save(STORAGE_REGION_SCENES, 1U, data, FLASH_SECTOR_SIZE));
+	assert_int_equal(0, statistics_get_counter(STORAGE_ERROR));
+}
+
+static void test_save_reports_flash_failure(void **state)
+{
+	(void)state;
+	uint8_t data[8] = {0};
+
+	mock_flash_set_safe_execute_result(-1);
+
+	assert_int_equal(STORAGE_ERR_FLASH, storage_save(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+	assert_int_equal(1, statistics_get_counter(STORAGE_ERROR));
+	assert_int_equal(STORAGE_ERR_EMPTY, storage_load(STORAGE_REGION_SCENES, 1U, data, sizeof(data)));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_crc32_known_vector, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_load_from_erased_flash_is_empty, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_save_then_load_round_trip, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_load_rejects_version_and_length_mismatch, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_load_rejects_corrupted_payload, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_save_rejects_invalid_parameters, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_save_reports_flash_failure, setup, NULL),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_timer_wheel.c
+ * @brief Unit tests for the hierarchical timer wheel
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "timer_wheel.h"
+
+static void expire_noop(timer_wheel_timer_t *timer)
+{
+	(void)timer;
+}
+
+/**
+ * @brief Advance one tick at a time until the timer expires.
+ *
+ * @return Tick at which the owner was flagged, or @p limit when it was not.
+ */
+static uint32_t run_until_expired(timer_wheel_t *wheel, timer_wheel_timer_t *timer, uint32_t limit)
+{
+	uint32_t tick = wheel->now;
+
+	while (tick != limit)
+	{
+		tick++;
+		if (0U != (timer_wheel_advance(wheel, tick) & (1UL << timer->owner)))
+		{
+			break;
+		}
+	}
+
+	return tick;
+}
+
+static void test_timers_expire_on_their_tick_at_every_level(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	// 71 and 8135 land exactly on a level 1 and a level 2 boundary
+	const uint32_t delays[] = {1U, 63U, 64U, 71U, 100U, 4095U, 4096U, 5000U, 8135U, 200000U};
+
+	for (size_t i = 0U; i < (sizeof(delays) / sizeof(delays[0])); i++)
+	{
+		// Start off a level boundary, so cascades happen mid-delay
+		timer_wheel_timer_t timer = {.function = expire_noop, .owner = 2U};
+		timer_wheel_init(&wheel, 12345U);
+		timer_wheel_insert(&wheel, &timer, 12345U + delays[i]);
+
+		assert_int_equal(12345U + delays[i], run_until_expired(&wheel, &timer, 12345U + delays[i] + 10U));
+		assert_ptr_equal(&timer, timer_wheel_pop_expired(&wheel, 2U));
+		assert_false(timer_wheel_is_armed(&timer));
+		assert_null(timer_wheel_pop_expired(&wheel, 2U));
+	}
+}
+
+static void test_far_timer_is_placed_again(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	timer_wheel_timer_t timer = {.function = expire_noop, .owner = 0U};
+	const uint32_t delay = (1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) + 777U;
+
+	timer_wheel_init(&wheel, 0U);
+	timer_wheel_insert(&wheel, &timer, delay);
+	assert_int_equal(delay, run_until_expired(&wheel, &timer, delay + 10U));
+}
+
+static void test_counter_wrap(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	timer_wheel_timer_t timer = {.function = expire_noop, .owner = 1U};
+
+	timer_wheel_init(&wheel, 0xFFFFFF00U);
+	timer_wheel_insert(&wheel, &timer, 0x00000200U);
+	assert_int_equal(0x00000200U, run_until_expired(&wheel, &timer, 0x00000300U));
+}
+
+static void test_cancel_and_move(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	timer_wheel_timer_t first = {.function = expire_noop, .owner = 0U};
+	timer_wheel_timer_t middle = {.function = expire_noop, .owner = 0U};
+	timer_wheel_timer_t last = {.function = expire_noop, .owner = 0U};
+
+	// Three timers in one slot; the middle one leaves the list
+	timer_wheel_init(&wheel, 0U);
+	timer_wheel_insert(&wheel, &first, 10U);
+	timer_wheel_insert(&wheel, &middle, 10U);
+	timer_wheel_insert(&wheel, &last, 10U);
+	assert_true(timer_wheel_remove(&middle));
+	assert_false(timer_wheel_remove(&middle));
+
+	// Inserting an armed timer moves it
+	timer_wheel_insert(&wheel, &last, 20U);
+
+	assert_int_equal(1U, timer_wheel_advance(&wheel, 10U));
+	assert_ptr_equal(&first, timer_wheel_pop_expired(&wheel, 0U));
+	assert_null(timer_wheel_pop_expired(&wheel, 0U));
+
+	// An expired timer can still be cancelled before dispatch
+	assert_int_equal(1U, timer_wheel_advance(&wheel, 20U));
+	assert_true(timer_wheel_remove(&last));
+	assert_null(timer_wheel_pop_expired(&wheel, 0U));
+}
+
+static void test_batches_per_owner(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	static timer_wheel_timer_t timers[200];
+	uint32_t popped[2] = {0U, 0U};
+
+	timer_wheel_init(&wheel, 0U);
+	for (uint32_t i = 0U; i < 200U; i++)
+	{
+		timers[i].function = expire_noop;
+		timers[i].owner = (uint8_t)(i % 2U);
+		timer_wheel_insert(&wheel, &timers[i], 50U + (i % 3U));
+	}
+
+	// A late advance catches up over every missed tick
+	assert_int_equal(0U, timer_wheel_advance(&wheel, 49U));
+	assert_int_equal(3U, timer_wheel_advance(&wheel, 60U));
+	for (uint8_t owner = 0U; owner < 2U; owner++)
+	{
+		while (NULL != timer_wheel_pop_expired(&wheel, owner))
+		{
+			popped[owner]++;
+		}
+	}
+	assert_int_equal(100U, popped[0]);
+	assert_int_equal(100U, popped[1]);
+}
+
+static void test_overdue_timer_expires_next_tick(void **state)
+{
+	(void)state;
+	static timer_wheel_t wheel;
+	timer_wheel_timer_t timer = {.function = expire_noop, .owner = 3U};
+
+	timer_wheel_init(&wheel, 1000U);
+	timer_wheel_insert(&wheel, &timer, 990U);
+	assert_int_equal(990U, timer.expires);
+	assert_int_equal(1UL << 3U, timer_wheel_advance(&wheel, 1001U));
+
+	// Owners outside the wheel are refused
+	timer.owner = (uint8_t)TIMER_WHEEL_OWNERS;
+	(void)timer_wheel_pop_expired(&wheel, 3U);
+	timer_wheel_insert(&wheel, &timer, 1002U);
+	assert_false(timer_wheel_is_armed(&timer));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_timers_expire_on_their_tick_at_every_level),
+		cmocka_unit_test(test_far_timer_is_placed_again),
+		cmocka_unit_test(test_counter_wrap),
+		cmocka_unit_test(test_cancel_and_move),
+		cmocka_unit_test(test_batches_per_owner),
+		cmocka_unit_test(test_overdue_timer_expires_next_tick),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
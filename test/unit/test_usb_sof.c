@@ -0,0 +1,139 @@
+/**
+ * @file test_usb_sof.c
+ * @brief Unit tests for the USB start-of-frame flush timing
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "usb_sof.h"
+
+static int setup(void **state)
+{
+	(void)state;
+	usb_sof_reset();
+	return 0;
+}
+
+static uint32_t total_slack_count(void)
+{
+	uint32_t total = 0U;
+	for (uint8_t i = 0U; i < USB_SOF_SLACK_BUCKETS; i++)
+	{
+		total += usb_sof_slack_count(i);
+	}
+	return total;
+}
+
+static void test_unlocked_flushes_immediately(void **state)
+{
+	(void)state;
+	assert_false(usb_sof_is_locked(1000U));
+	assert_int_equal(0U, usb_sof_flush_delay_us(1000U));
+}
+
+static void test_delay_targets_lead_before_next_sof(void **state)
+{
+	(void)state;
+	const uint32_t flush_point = USB_SOF_PERIOD_US - USB_SOF_FLUSH_LEAD_US;
+
+	usb_sof_on_frame(10000U);
+	assert_true(usb_sof_is_locked(10000U));
+
+	assert_int_equal(flush_point, usb_sof_flush_delay_us(10000U));
+	assert_int_equal(flush_point - 300U, usb_sof_flush_delay_us(10300U));
+	// Inside the lead window: flush now
+	assert_int_equal(0U, usb_sof_flush_delay_us(10000U + flush_point));
+	assert_int_equal(0U, usb_sof_flush_delay_us(10999U));
+	// A late SOF callback keeps the phase from the last one seen
+	assert_int_equal(flush_point - 100U, usb_sof_flush_delay_us(11100U));
+}
+
+static void test_lock_lost_without_sof(void **state)
+{
+	(void)state;
+	usb_sof_on_frame(5000U);
+	assert_true(usb_sof_is_locked(5000U + USB_SOF_LOCK_TIMEOUT_US - 1U));
+	assert_false(usb_sof_is_locked(5000U + USB_SOF_LOCK_TIMEOUT_US));
+	assert_int_equal(0U, usb_sof_flush_delay_us(5000U + USB_SOF_LOCK_TIMEOUT_US + 100U));
+}
+
+static void test_timer_wraparound(void **state)
+{
+	(void)state;
+	const uint32_t sof = 0xFFFFFF00U;
+
+	usb_sof_on_frame(sof);
+	assert_true(usb_sof_is_locked(sof + 0x200U));
+	assert_int_equal(USB_SOF_PERIOD_US - USB_SOF_FLUSH_LEAD_US - 0x200U, usb_sof_flush_delay_us(sof + 0x200U));
+}
+
+static void test_slack_histogram_buckets(void **state)
+{
+	(void)state;
+
+	usb_sof_on_frame(0U);
+
+	// 150 µs before the SOF lands in bucket 1 (128-255 µs)
+	usb_sof_on_flush(850U);
+	usb_sof_on_frame(1000U);
+	assert_int_equal(1U, usb_sof_slack_count(1U));
+
+	// A SOF without a preceding flush records nothing
+	usb_sof_on_frame(2000U);
+	assert_int_equal(1U, total_slack_count());
+
+	// Long slack saturates in the last bucket
+	usb_sof_on_flush(2001U);
+	usb_sof_on_frame(3000U);
+	assert_int_equal(1U, usb_sof_slack_count(USB_SOF_SLACK_BUCKETS - 1U));
+
+	// Several flushes in one frame count once, against the last one
+	usb_sof_on_flush(3100U);
+	usb_sof_on_flush(3990U);
+	usb_sof_on_frame(4000U);
+	assert_int_equal(1U, usb_sof_slack_count(0U));
+	assert_int_equal(3U, total_slack_count());
+}
+
+static void test_slack_ignores_suspended_bus(void **state)
+{
+	(void)state;
+
+	usb_sof_on_flush(0U);
+	usb_sof_on_frame(USB_SOF_LOCK_TIMEOUT_US);
+	assert_int_equal(0U, total_slack_count());
+	assert_int_equal(0U, usb_sof_slack_count(USB_SOF_SLACK_BUCKETS));
+}
+
+static void test_reset_clears_histogram(void **state)
+{
+	(void)state;
+
+	usb_sof_on_frame(0U);
+	usb_sof_on_flush(900U);
+	usb_sof_on_frame(1000U);
+	assert_int_equal(1U, total_slack_count());
+
+	usb_sof_reset();
+	assert_int_equal(0U, total_slack_count());
+	assert_false(usb_sof_is_locked(1000U));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_unlocked_flushes_immediately, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_delay_targets_lead_before_next_sof, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_lock_lost_without_sof, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_timer_wraparound, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_slack_histogram_buckets, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_slack_ignores_suspended_bus, setup, NULL),
+		cmocka_unit_test_setup_teardown(test_reset_clears_histogram, setup, NULL),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}